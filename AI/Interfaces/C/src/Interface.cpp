@@ -199,6 +199,16 @@ sharedLib_t CInterface::LoadSkirmishAILib(const std::string& libFilePath,
 		reportInterfaceFunctionError(libFilePath, funcName);
 	}
 
+	funcName = "handleEvents";
+	skirmishAILibrary->handleEvents
+			= (int (CALLING_CONV_FUNC_POINTER *)(int skirmishAIId,
+			const int* topicIds, const void* const* data, int numEvents))
+			sharedLib_findAddress(sharedLib, funcName.c_str());
+	if (skirmishAILibrary->handleEvents == NULL) {
+		// do nothing: it is permitted that an AI does not export this function,
+		// events are then sent one by one through handleEvent
+	}
+
 	return sharedLib;
 }
 
@@ -238,6 +238,12 @@ int CALLING_CONV proxy_skirmishAI_handleEvent(
 	return java_skirmishAI_handleEvent(skirmishAIId, topicId, data);
 }
 
+int CALLING_CONV proxy_skirmishAI_handleEvents(
+		int skirmishAIId, const int* topicIds, const void* const* data,
+		int numEvents) {
+	return java_skirmishAI_handleEvents(skirmishAIId, topicIds, data, numEvents);
+}
+
 
 EXPORT(const struct SSkirmishAILibrary*) loadSkirmishAILibrary(
 		const char* const shortName,
@@ -256,6 +262,7 @@ EXPORT(const struct SSkirmishAILibrary*) loadSkirmishAILibrary(
 		mySSkirmishAILibrary->init = &proxy_skirmishAI_init;
 		mySSkirmishAILibrary->release = &proxy_skirmishAI_release;
 		mySSkirmishAILibrary->handleEvent = &proxy_skirmishAI_handleEvent;
+		mySSkirmishAILibrary->handleEvents = &proxy_skirmishAI_handleEvents;
 	}
 
 	return mySSkirmishAILibrary;
@@ -1291,3 +1291,22 @@ int java_skirmishAI_handleEvent(int skirmishAIId, int topic, const void* data) {
 
 	return res;
 }
+
+int java_skirmishAI_handleEvents(int skirmishAIId, const int* topics,
+		const void* const* data, int numEvents) {
+
+	int res = 0;
+
+	// attach and restore the engine FPU state once for the whole batch
+	java_establishJavaEnv();
+	JNIEnv* env = java_getJNIEnv();
+	const size_t sai   = skirmishAIId_skirmishAiImpl[skirmishAIId];
+	jobject aiInstance = skirmishAiImpl_instance[sai];
+	int e;
+	for (e = 0; e < numEvents && res == 0; ++e) {
+		res = eventsJniBridge_handleEvent(env, aiInstance, skirmishAIId, topics[e], data[e]);
+	}
+	java_establishSpringEnv();
+
+	return res;
+}
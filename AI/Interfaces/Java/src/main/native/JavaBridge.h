@@ -73,6 +73,10 @@ int java_skirmishAI_release(int teamId);
 
 int java_skirmishAI_handleEvent(int teamId, int topic, const void* data);
 
+/// Delivers the events in order, stopping at the first one that fails
+int java_skirmishAI_handleEvents(int teamId, const int* topics,
+		const void* const* data, int numEvents);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
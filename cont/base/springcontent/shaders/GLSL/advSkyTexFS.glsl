@@ -0,0 +1,61 @@
+#version 120
+
+// regenerates CAdvSky's sky (or, with SKY_DOT3, its dot3 lighting) texture;
+// same math as CAdvSky::UpdateTexPart / UpdateTexPartDot3, one texel per fragment
+
+uniform vec3 lightDir;
+uniform float lightIntensity;
+uniform vec3 skyColor;
+uniform vec3 sunColor;
+
+uniform float skyAngle;
+uniform float domeWidth;
+uniform float domeHeight;
+uniform float texSize;
+
+const float PI = 3.14159265358979;
+
+// [0, 2*PI), see GetRadFromXY
+float GetRadFromXY(float dx, float dy) {
+	float a = atan(dy, dx);
+
+	if (a < 0.0)
+		a += 2.0 * PI;
+
+	return a;
+}
+
+vec3 GetDirFromTexCoord(vec2 tc) {
+	vec2 d = (tc - 0.5) * domeWidth;
+
+	float hdist = length(d);
+	float ang = GetRadFromXY(d.x, d.y) + skyAngle;
+	float fy = asin(min(hdist / 400.0, 1.0));
+
+	return normalize(vec3(hdist * cos(ang), (cos(fy) - domeHeight) * 400.0, hdist * sin(ang)));
+}
+
+void main() {
+	// texel row y holds the direction of texcoord (x, size - 1 - y) / size
+	vec2 texel = floor(gl_FragCoord.xy);
+	vec3 dir = GetDirFromTexCoord(vec2(texel.x, texSize - 1.0 - texel.y) / texSize);
+
+	float sunAng = acos(clamp(dot(dir, lightDir), -1.0, 1.0));
+
+#ifdef SKY_DOT3
+	float sunDist = max(sunAng * 50.0, 0.0001);
+	float sunMod = lightIntensity * (0.3 / sqrt(sunDist) + 3.0 / (1.0 + sunDist));
+
+	gl_FragColor = vec4(
+		lightIntensity * (255.0 - min(255.0, sunDist)) / 255.0, // sun on borders
+		min(1.0, 0.55 + sunMod), // sun light through
+		(203.0 - lightIntensity * (40.0 / (3.0 + sunDist))) / 255.0, // ambient
+		1.0
+	);
+#else
+	float sunDist = sunAng * 70.0;
+	float sunMod = lightIntensity * 12.0 / (12.0 + sunDist);
+
+	gl_FragColor = vec4(min(skyColor + sunColor * sunMod, vec3(1.0)), 1.0);
+#endif
+}
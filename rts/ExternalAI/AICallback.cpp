@@ -126,18 +126,39 @@ CUnit* CAICallback::GetInLosAndRadarUnit(int unitId) const {
 }
 
 
+boost::recursive_mutex CAICallback::engineMutex;
+
 CAICallback::CAICallback(int teamId)
 	: team(teamId)
 	, noMessages(false)
 	, gh(grouphandlers[teamId])
+	, deferNetPackets(false)
 {}
 
+void CAICallback::SendNetPacket(boost::shared_ptr<const netcode::RawPacket> packet)
+{
+	if (deferNetPackets) {
+		deferredNetPackets.push_back(packet);
+	} else {
+		net->Send(packet);
+	}
+}
+
+void CAICallback::FlushNetPackets()
+{
+	for (size_t n = 0; n < deferredNetPackets.size(); n++) {
+		net->Send(deferredNetPackets[n]);
+	}
+
+	deferredNetPackets.clear();
+}
+
 void CAICallback::SendStartPos(bool ready, float3 startPos)
 {
 	if (ready) {
-		net->Send(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_READIED, startPos.x, startPos.y, startPos.z));
+		SendNetPacket(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_READIED, startPos.x, startPos.y, startPos.z));
 	} else {
-		net->Send(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_UPDATED, startPos.x, startPos.y, startPos.z));
+		SendNetPacket(CBaseNetProtocol::Get().SendStartPos(gu->myPlayerNum, team, CPlayer::PLAYER_RDYSTATE_UPDATED, startPos.x, startPos.y, startPos.z));
 	}
 }
 
@@ -187,7 +208,7 @@ bool CAICallback::SendResources(float mAmount, float eAmount, int receivingTeamI
 		eAmount = std::max(0.0f, std::min(eAmount, GetEnergy()));
 		std::vector<short> empty;
 
-		net->Send(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), mAmount, eAmount, empty));
+		SendNetPacket(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), mAmount, eAmount, empty));
 	}
 
 	return ret;
@@ -226,7 +247,7 @@ int CAICallback::SendUnits(const std::vector<int>& unitIds, int receivingTeamId)
 		if (!sentUnitIDs.empty()) {
 			// we ca not use SendShare() here either, since
 			// AIs do not have a notion of "selected units"
-			net->Send(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), 0.0f, 0.0f, sentUnitIDs));
+			SendNetPacket(CBaseNetProtocol::Get().SendAIShare(ubyte(gu->myPlayerNum), skirmishAIHandler.GetCurrentAIID(), ubyte(team), ubyte(receivingTeamId), 0.0f, 0.0f, sentUnitIDs));
 		}
 	}
 
@@ -395,7 +416,7 @@ int CAICallback::GiveOrder(int unitId, Command* c)
 		return -5;
 	}
 
-	net->Send(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), unitId, c->GetID(), c->aiCommandId, c->options, c->params));
+	SendNetPacket(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), unitId, c->GetID(), c->aiCommandId, c->options, c->params.data(), c->params.size()));
 
 	return 0;
 }
@@ -724,22 +745,26 @@ bool CAICallback::IsUnitNeutral(int unitId) {
 
 int CAICallback::InitPath(const float3& start, const float3& end, int pathType, float goalRadius)
 {
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	assert(((size_t)pathType) < moveDefHandler->GetNumMoveDefs());
 	return pathManager->RequestPath(NULL, moveDefHandler->GetMoveDefByPathType(pathType), start, end, goalRadius, false);
 }
 
 float3 CAICallback::GetNextWaypoint(int pathId)
 {
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	return pathManager->NextWayPoint(NULL, pathId, 0, ZeroVector, 0.0f, false);
 }
 
 void CAICallback::FreePath(int pathId)
 {
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	pathManager->DeletePath(pathId);
 }
 
 float CAICallback::GetPathLength(float3 start, float3 end, int pathType, float goalRadius)
 {
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	const int pathID  = InitPath(start, end, pathType, goalRadius);
 	float     pathLen = -1.0f;
 
@@ -803,10 +828,12 @@ float CAICallback::GetPathLength(float3 start, float3 end, int pathType, float g
 }
 
 bool CAICallback::SetPathNodeCost(unsigned int x, unsigned int z, float cost) {
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	return pathManager->SetNodeExtraCost(x, z, cost, false);
 }
 
 float CAICallback::GetPathNodeCost(unsigned int x, unsigned int z) {
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	return pathManager->GetNodeExtraCost(x, z, false);
 }
 
@@ -835,7 +862,7 @@ static int FilterUnitsVector(const std::vector<CUnit*>& units, int* unitIds, int
 
 	return a;
 }
-static int FilterUnitsList(const std::list<CUnit*>& units, int* unitIds, int unitIds_max, bool (*includeUnit)(const CUnit*) = NULL)
+static int FilterUnitsList(const std::vector<CUnit*>& units, int* unitIds, int unitIds_max, bool (*includeUnit)(const CUnit*) = NULL)
 {
 	int a = 0;
 
@@ -844,7 +871,7 @@ static int FilterUnitsList(const std::list<CUnit*>& units, int* unitIds, int uni
 		unitIds_max = MAX_UNITS;
 	}
 
-	std::list<CUnit*>::const_iterator ui;
+	std::vector<CUnit*>::const_iterator ui;
 	for (ui = units.begin(); (ui != units.end()) && (a < unitIds_max); ++ui) {
 		CUnit* u = *ui;
 
@@ -864,7 +891,8 @@ static inline bool unit_IsNeutral(const CUnit* unit) {
 	return unit->IsNeutral();
 }
 
-static int myAllyTeamId = -1;
+// thread-local, AIs may be updated concurrently
+static __thread int myAllyTeamId = -1;
 
 /// You have to set myAllyTeamId before calling this function. NOT thread safe!
 static inline bool unit_IsEnemy(const CUnit* unit) {
@@ -933,6 +961,7 @@ int CAICallback::GetEnemyUnits(int* unitIds, const float3& pos, float radius,
 		int unitIds_max)
 {
 	verify();
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	const std::vector<CUnit*>& units = quadField->GetUnitsExact(pos, radius);
 	myAllyTeamId = teamHandler->AllyTeam(team);
 	return FilterUnitsVector(units, unitIds, unitIds_max, &unit_IsEnemyAndInLos);
@@ -950,6 +979,7 @@ int CAICallback::GetFriendlyUnits(int* unitIds, const float3& pos, float radius,
 		int unitIds_max)
 {
 	verify();
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	const std::vector<CUnit*>& units = quadField->GetUnitsExact(pos, radius);
 	myAllyTeamId = teamHandler->AllyTeam(team);
 	return FilterUnitsVector(units, unitIds, unitIds_max, &unit_IsFriendly);
@@ -966,6 +996,7 @@ int CAICallback::GetNeutralUnits(int* unitIds, int unitIds_max)
 int CAICallback::GetNeutralUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
 {
 	verify();
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	const std::vector<CUnit*>& units = quadField->GetUnitsExact(pos, radius);
 	myAllyTeamId = teamHandler->AllyTeam(team);
 	return FilterUnitsVector(units, unitIds, unitIds_max, &unit_IsNeutralAndInLos);
@@ -1283,6 +1314,7 @@ int CAICallback::GetFeatures(int* featureIds, int featureIds_sizeMax, const floa
 	int featureIds_size = 0;
 
 	verify();
+	boost::recursive_mutex::scoped_lock lock(engineMutex);
 	const std::vector<CFeature*>& ft = quadField->GetFeaturesExact(pos, radius);
 	const int allyteam = teamHandler->AllyTeam(team);
 
@@ -1454,17 +1486,17 @@ int CAICallback::HandleCommand(int commandId, void* data)
 		} break;
 		case AIHCAddMapPointId: {
 			const AIHCAddMapPoint* cmdData = static_cast<AIHCAddMapPoint*>(data);
-			net->Send(CBaseNetProtocol::Get().SendMapDrawPoint(team, (short)cmdData->pos.x, (short)cmdData->pos.z, std::string(cmdData->label), false));
+			SendNetPacket(CBaseNetProtocol::Get().SendMapDrawPoint(team, (short)cmdData->pos.x, (short)cmdData->pos.z, std::string(cmdData->label), false));
 			return 1;
 		} break;
 		case AIHCAddMapLineId: {
 			const AIHCAddMapLine* cmdData = static_cast<AIHCAddMapLine*>(data);
-			net->Send(CBaseNetProtocol::Get().SendMapDrawLine(team, (short)cmdData->posfrom.x, (short)cmdData->posfrom.z, (short)cmdData->posto.x, (short)cmdData->posto.z, false));
+			SendNetPacket(CBaseNetProtocol::Get().SendMapDrawLine(team, (short)cmdData->posfrom.x, (short)cmdData->posfrom.z, (short)cmdData->posto.x, (short)cmdData->posto.z, false));
 			return 1;
 		} break;
 		case AIHCRemoveMapPointId: {
 			const AIHCRemoveMapPoint* cmdData = static_cast<AIHCRemoveMapPoint*>(data);
-			net->Send(CBaseNetProtocol::Get().SendMapErase(team, (short)cmdData->pos.x, (short)cmdData->pos.z));
+			SendNetPacket(CBaseNetProtocol::Get().SendMapErase(team, (short)cmdData->pos.x, (short)cmdData->pos.z));
 			return 1;
 		} break;
 		case AIHCSendStartPosId: {
@@ -1539,7 +1571,7 @@ int CAICallback::HandleCommand(int commandId, void* data)
 		case AIHCPauseId: {
 			AIHCPause* cmdData = static_cast<AIHCPause*>(data);
 
-			net->Send(CBaseNetProtocol::Get().SendPause(gu->myPlayerNum, cmdData->enable));
+			SendNetPacket(CBaseNetProtocol::Get().SendPause(gu->myPlayerNum, cmdData->enable));
 			LOG("Skirmish AI controlling team %i paused the game, reason: %s",
 					team,
 					cmdData->reason != NULL ? cmdData->reason : "UNSPECIFIED");
@@ -10,6 +10,13 @@
 #include <vector>
 #include <map>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+namespace netcode {
+	class RawPacket;
+}
+
 struct Command;
 struct UnitDef;
 struct FeatureDef;
@@ -42,9 +49,26 @@ private:
 	/// Returns the unit if the ID is valid, and the unit is in LOS or Radar
 	CUnit* GetInLosAndRadarUnit(int unitId) const;
 
+	void SendNetPacket(boost::shared_ptr<const netcode::RawPacket> packet);
+
+	bool deferNetPackets;
+	std::vector< boost::shared_ptr<const netcode::RawPacket> > deferredNetPackets;
+
 public:
 	CAICallback(int teamId);
 
+	/**
+	 * Serializes the callbacks that use non-reentrant engine state
+	 * (QuadField queries, path requests, AI commands) while the AIs
+	 * are updated on worker threads.
+	 */
+	static boost::recursive_mutex engineMutex;
+
+	/// while set, packets are buffered until FlushNetPackets is called
+	void SetDeferNetPackets(bool defer) { deferNetPackets = defer; }
+	/// sends the buffered packets, in the order the AI issued them
+	void FlushNetPackets();
+
 	void SendStartPos(bool ready, float3 pos);
 	void SendTextMsg(const char* text, int zone);
 	void SetLastMsgPos(const float3& pos);
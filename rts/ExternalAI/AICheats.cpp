@@ -2,6 +2,7 @@
 
 #include "AICheats.h"
 
+#include "ExternalAI/AICallback.h"
 #include "ExternalAI/SkirmishAIWrapper.h"
 #include "Game/TraceRay.h"
 #include "Sim/Units/Unit.h"
@@ -161,7 +162,7 @@ static int FilterUnitsVector(const std::vector<CUnit*>& units, int* unitIds, int
 
 	return a;
 }
-static int FilterUnitsList(const std::list<CUnit*>& units, int* unitIds, int unitIds_max, bool (*includeUnit)(CUnit*) = NULL)
+static int FilterUnitsList(const std::vector<CUnit*>& units, int* unitIds, int unitIds_max, bool (*includeUnit)(CUnit*) = NULL)
 {
 	int a = 0;
 
@@ -170,7 +171,7 @@ static int FilterUnitsList(const std::list<CUnit*>& units, int* unitIds, int uni
 		unitIds_max = MAX_UNITS;
 	}
 
-	std::list<CUnit*>::const_iterator ui;
+	std::vector<CUnit*>::const_iterator ui;
 	for (ui = units.begin(); (ui != units.end()) && (a < unitIds_max); ++ui) {
 		CUnit* u = *ui;
 
@@ -189,7 +190,8 @@ static inline bool unit_IsNeutral(CUnit* unit) {
 	return unit->IsNeutral();
 }
 
-static int myAllyTeamId = -1;
+// thread-local, AIs may be updated concurrently
+static __thread int myAllyTeamId = -1;
 
 /// You have to set myAllyTeamId before callign this function. NOT thread safe!
 static inline bool unit_IsEnemy(CUnit* unit) {
@@ -206,6 +208,7 @@ int CAICheats::GetEnemyUnits(int* unitIds, int unitIds_max)
 
 int CAICheats::GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
 {
+	boost::recursive_mutex::scoped_lock lock(CAICallback::engineMutex);
 	const std::vector<CUnit*>& units = quadField->GetUnitsExact(pos, radius);
 	myAllyTeamId = teamHandler->AllyTeam(ai->GetTeamId());
 	return FilterUnitsVector(units, unitIds, unitIds_max, &unit_IsEnemy);
@@ -218,6 +221,7 @@ int CAICheats::GetNeutralUnits(int* unitIds, int unitIds_max)
 
 int CAICheats::GetNeutralUnits(int* unitIds, const float3& pos, float radius, int unitIds_max)
 {
+	boost::recursive_mutex::scoped_lock lock(CAICallback::engineMutex);
 	const std::vector<CUnit*>& units = quadField->GetUnitsExact(pos, radius);
 	return FilterUnitsVector(units, unitIds, unitIds_max, &unit_IsNeutral);
 }
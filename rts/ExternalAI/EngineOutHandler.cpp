@@ -22,11 +22,15 @@
 #include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Util.h"
+#include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
 
 #include "System/creg/STL_Map.h"
 
+#include <exception>
+
 CONFIG(int, CatchAIExceptions).defaultValue(1);
+CONFIG(bool, AIThreadedUpdate).defaultValue(false).description("Run the Update event of the local Skirmish AIs concurrently, one AI per worker thread. Their commands are sent after all AIs are done, in AI ID order. Requires AI libraries (and AI interfaces) that do not share state between instances.");
 //CONFIG(bool, AI_UnpauseAfterInit).defaultValue(true);
 
 CR_BIND_DERIVED(CEngineOutHandler, CObject, )
@@ -105,6 +109,11 @@ void CEngineOutHandler::Destroy() {
 	}
 }
 
+CEngineOutHandler::CEngineOutHandler()
+	: threadedUpdate(configHandler->GetBool("AIThreadedUpdate"))
+{
+}
+
 CEngineOutHandler::~CEngineOutHandler() {
 	// id_skirmishAI should be empty already, but this can not hurt
 	for (id_ai_t::iterator ai = id_skirmishAI.begin(); ai != id_skirmishAI.end(); ++ai) {
@@ -154,7 +163,45 @@ void CEngineOutHandler::Update() {
 
 	const int frame = gs->frameNum;
 
-	DO_FOR_SKIRMISH_AIS(Update(frame))
+	if (!threadedUpdate || id_skirmishAI.size() < 2) {
+		DO_FOR_SKIRMISH_AIS(Update(frame))
+		return;
+	}
+
+	// the sim is not touched while the AIs run, so they all see the same
+	// frame state; everything the engine keeps non-reentrant for them is
+	// serialized by CAICallback::engineMutex
+	std::vector<CSkirmishAIWrapper*> ais;
+	std::vector<std::exception_ptr> aiExceptions(id_skirmishAI.size());
+
+	ais.reserve(id_skirmishAI.size());
+
+	for (id_ai_t::iterator ai = id_skirmishAI.begin(); ai != id_skirmishAI.end(); ++ai) {
+		ais.push_back(ai->second);
+		ais.back()->SetDeferCommands(true);
+	}
+
+	for_mt(0, ais.size(), [&](const int i) {
+		try {
+			try {
+				ais[i]->Update(frame);
+			} CATCH_AI_EXCEPTION;
+		} catch (...) {
+			aiExceptions[i] = std::current_exception();
+		}
+	});
+
+	// submit commands in AI ID order, independent of thread timing
+	for (size_t i = 0; i < ais.size(); i++) {
+		ais[i]->SetDeferCommands(false);
+		ais[i]->FlushDeferredCommands();
+	}
+
+	for (size_t i = 0; i < aiExceptions.size(); i++) {
+		if (aiExceptions[i] != NULL) {
+			std::rethrow_exception(aiExceptions[i]);
+		}
+	}
 }
 
 
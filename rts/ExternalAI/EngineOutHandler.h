@@ -25,6 +25,7 @@ void handleAIException(const char* description);
 class CEngineOutHandler : public CObject {
 	CR_DECLARE(CEngineOutHandler);
 
+	CEngineOutHandler();
 	~CEngineOutHandler();
 
 public:
@@ -160,6 +161,9 @@ private:
 	 * There can be multiple Skirmish AIs per team.
 	 */
 	team_ais_t team_skirmishAIs;
+
+	/// if true, Update runs the AIs concurrently (see AIThreadedUpdate)
+	bool threadedUpdate;
 };
 
 #define eoh CEngineOutHandler::GetInstance()
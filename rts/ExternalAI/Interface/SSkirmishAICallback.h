@@ -1185,6 +1185,37 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *getSelectedUnits)(int skirmishAIId, int* unitIds, int unitIds_sizeMax); //$ FETCHER:MULTI:IDs:Unit:unitIds
 
+	/**
+	 * Bulk version of Unit_getPos, for unitIds_size units at once.
+	 * positions_AposF3 has to hold 3 * unitIds_size floats; units that are
+	 * not visible get a zero position, just like with Unit_getPos.
+	 * Returns the number of positions written.
+	 */
+	int               (CALLING_CONV *getUnitsPos)(int skirmishAIId, int* unitIds, int unitIds_size, float* positions_AposF3); //$ ARRAY:positions_AposF3
+
+	/**
+	 * Bulk version of Unit_getVel, with the same layout as getUnitsPos.
+	 */
+	int               (CALLING_CONV *getUnitsVel)(int skirmishAIId, int* unitIds, int unitIds_size, float* velocities_AposF3); //$ ARRAY:velocities_AposF3
+
+	/**
+	 * Bulk version of Unit_getHealth, one value per unit
+	 * (-1 for units whose health is not visible).
+	 */
+	int               (CALLING_CONV *getUnitsHealth)(int skirmishAIId, int* unitIds, int unitIds_size, float* healths); //$ ARRAY:healths
+
+	/**
+	 * Returns the state of all friendly units and all enemy units in radar
+	 * or LOS (all units on the map if cheats are enabled), in one call.
+	 * The data is gathered at most once per frame and cached, so calling this
+	 * repeatedly in the same frame is cheap.
+	 * Per unit, index i of each array is filled: its ID, its UnitDef ID
+	 * (-1 if unknown), its position (3 floats) and its health (-1 if unknown).
+	 * Every output array except unitIds may be NULL.
+	 * If unitIds is NULL, the number of units in the snapshot is returned.
+	 */
+	int               (CALLING_CONV *getUnitsSnapshot)(int skirmishAIId, int* unitIds, int* unitDefIds, float* positions_AposF3, float* healths, int unitIds_sizeMax);
+
 	/**
 	 * Returns the unit's unitdef struct from which you can read all
 	 * the statistics of the unit, do NOT try to change any values in it.
@@ -1695,6 +1726,32 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *Map_getJammerMap)(int skirmishAIId, int* jammerValues, int jammerValues_sizeMax); //$ ARRAY:jammerValues
 
+	/**
+	 * Side length in elmos of one cell of the threat maps.
+	 * A threat map has ceil(width * 8 / cellSize) * ceil(height * 8 / cellSize)
+	 * cells, index 0 is top left, rows first.
+	 */
+	int               (CALLING_CONV *Map_getThreatMapCellSize)(int skirmishAIId);
+
+	/**
+	 * @brief the threat maps, maintained by the engine
+	 * Per cell, about the enemy units this team's ally-team has in LOS:
+	 * - layer 0: their number
+	 * - layer 1: their summed weapon damage per second
+	 * - layer 2: their summed metal cost
+	 *
+	 * @see Map_getThreatMapCellSize()
+	 */
+	int               (CALLING_CONV *Map_getThreatMap)(int skirmishAIId, int layer, float* values, int values_sizeMax); //$ ARRAY:values
+
+	/**
+	 * Same as Map_getThreatMap(), but returns the engine's own array instead
+	 * of copying it (native code relevant only).
+	 * Do NOT modify or delete it; it is only valid during the current frame.
+	 * Returns NULL for an invalid layer.
+	 */
+	const float*      (CALLING_CONV *Map_getThreatMapPointer)(int skirmishAIId, int layer);
+
 	/**
 	 * @brief resource maps
 	 * This map shows the resource density on the map.
@@ -214,6 +214,26 @@ struct SSkirmishAILibrary {
 	 */
 	int (CALLING_CONV *handleEvent)(int skirmishAIId, int topicId,
 			const void* data);
+
+	/**
+	 * Optional batched version of handleEvent().
+	 * If an AI exports this, the engine queues the high-frequency events
+	 * (unit-idle, unit-move-failed, unit- and enemy-damaged, enemy LOS and
+	 * radar changes, weapon-fired and seismic-ping) and delivers them through
+	 * a single call of this function, in the order they happened.
+	 * The queue is delivered before any other event is sent, so the overall
+	 * event order is the same as with handleEvent() alone.
+	 *
+	 * @param skirmishAIId  the AI instance the events are addressed to
+	 * @param topicIds      numEvents topic ids, see handleEvent()
+	 * @param data          numEvents topic specific structs, see handleEvent();
+	 *                      they are only valid for the duration of the call
+	 * @param numEvents     number of events
+	 * @return     0: ok
+	 *          != 0: error
+	 */
+	int (CALLING_CONV *handleEvents)(int skirmishAIId, const int* topicIds,
+			const void* const* data, int numEvents);
 };
 
 #ifdef __cplusplus
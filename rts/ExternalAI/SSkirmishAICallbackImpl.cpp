@@ -35,6 +35,7 @@
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/RadarHandler.h"
 #include "Sim/Misc/TeamHandler.h"
+#include "Sim/Misc/ThreatMap.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h" // for quadField->GetFeaturesExact(pos, radius)
 #include "System/SafeCStrings.h"
@@ -52,6 +53,21 @@ static std::map<int, bool>                 skirmishAIId_cheatingEnabled;
 static std::map<int, bool>                 skirmishAIId_usesCheats;
 static std::map<int, int>                  skirmishAIId_teamId;
 
+/// per-frame cache of the unit state returned by getUnitsSnapshot
+struct UnitsSnapshot {
+	UnitsSnapshot(): frame(-1), cheats(false) {}
+
+	int frame;
+	bool cheats;
+
+	std::vector<int> unitIds;
+	std::vector<int> unitDefIds;
+	std::vector<float> positions;
+	std::vector<float> healths;
+};
+
+static std::map<int, UnitsSnapshot>        skirmishAIId_unitsSnapshot;
+
 static const size_t MARKERS_MAX_SIZE = 16384;
 static std::vector<PointMarker> tmpPointMarkerArr[MAX_SKIRMISH_AIS];
 static std::vector<LineMarker> tmpLineMarkerArr[MAX_SKIRMISH_AIS];
@@ -200,6 +216,9 @@ static int wrapper_HandleCommand(CAICallback* clb, CAICheats* clbCheat,
 EXPORT(int) skirmishAiCallback_Engine_handleCommand(int skirmishAIId, int toId, int commandId,
 		int commandTopic, void* commandData) {
 
+	// see CAICallback::engineMutex
+	boost::recursive_mutex::scoped_lock lock(CAICallback::engineMutex);
+
 	int ret = 0;
 
 	CAICallback* clb = skirmishAIId_callback[skirmishAIId];
@@ -1637,6 +1656,38 @@ EXPORT(int) skirmishAiCallback_Map_getJammerMap(int skirmishAIId,
 	return jammerValues_size;
 }
 
+EXPORT(int) skirmishAiCallback_Map_getThreatMapCellSize(int skirmishAIId) {
+	return CThreatMap::CELL_SIZE;
+}
+
+EXPORT(const float*) skirmishAiCallback_Map_getThreatMapPointer(int skirmishAIId, int layer) {
+
+	if (layer < 0 || layer >= CThreatMap::NUM_LAYERS)
+		return NULL;
+
+	const int allyTeamId = teamHandler->AllyTeam(skirmishAIId_teamId[skirmishAIId]);
+	return threatMap->GetLayer(allyTeamId, layer);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getThreatMap(int skirmishAIId, int layer, float* values, int values_sizeMax) {
+
+	const float* layerValues = skirmishAiCallback_Map_getThreatMapPointer(skirmishAIId, layer);
+
+	if (layerValues == NULL)
+		return -1;
+
+	const int values_sizeReal = threatMap->GetSizeX() * threatMap->GetSizeZ();
+
+	int values_size = values_sizeReal;
+
+	if (values != NULL) {
+		values_size = min(values_sizeReal, values_sizeMax);
+		std::copy(layerValues, layerValues + values_size, values);
+	}
+
+	return values_size;
+}
+
 EXPORT(int) skirmishAiCallback_Map_getResourceMapRaw(
 		int skirmishAIId, int resourceId, short* resources, int resources_sizeMax) {
 
@@ -3346,7 +3397,7 @@ EXPORT(int) skirmishAiCallback_Unit_CurrentCommand_getParams(int skirmishAIId,
 		return -1;
 	}
 
-	const std::vector<float>& ps = q->at(commandId).params;
+	const Command::Params& ps = q->at(commandId).params;
 	const size_t params_sizeReal = ps.size();
 
 	size_t params_size = params_sizeReal;
@@ -3583,7 +3634,7 @@ EXPORT(int) skirmishAiCallback_getTeamUnits(int skirmishAIId, int* unitIds, int
 	int a = 0;
 
 	const int teamId = skirmishAIId_teamId[skirmishAIId];
-	for (std::list<CUnit*>::iterator ui = unitHandler->activeUnits.begin();
+	for (std::vector<CUnit*>::iterator ui = unitHandler->activeUnits.begin();
 			ui != unitHandler->activeUnits.end(); ++ui) {
 		CUnit* u = *ui;
 
@@ -3602,6 +3653,157 @@ EXPORT(int) skirmishAiCallback_getTeamUnits(int skirmishAIId, int* unitIds, int
 	return a;
 }
 
+/**
+ * The bulk fetchers resolve the AI's (cheat-)callback only once and then
+ * go straight through it for every unit, instead of paying the full
+ * C callback dispatch per unit and field.
+ * For internal use only.
+ */
+template<typename Callback>
+static void _intern_getUnitsPos(Callback* clb, const int* unitIds, int unitIds_size, float* positions) {
+	for (int u = 0; u < unitIds_size; u++) {
+		clb->GetUnitPos(unitIds[u]).copyInto(&positions[u * 3]);
+	}
+}
+
+template<typename Callback>
+static void _intern_getUnitsVel(Callback* clb, const int* unitIds, int unitIds_size, float* velocities) {
+	for (int u = 0; u < unitIds_size; u++) {
+		clb->GetUnitVelocity(unitIds[u]).copyInto(&velocities[u * 3]);
+	}
+}
+
+template<typename Callback>
+static void _intern_getUnitsHealth(Callback* clb, const int* unitIds, int unitIds_size, float* healths) {
+	for (int u = 0; u < unitIds_size; u++) {
+		healths[u] = clb->GetUnitHealth(unitIds[u]);
+	}
+}
+
+template<typename Callback>
+static void _intern_getUnitsDefIds(Callback* clb, const int* unitIds, int unitIds_size, int* unitDefIds) {
+	for (int u = 0; u < unitIds_size; u++) {
+		const UnitDef* unitDef = clb->GetUnitDef(unitIds[u]);
+		unitDefIds[u] = ((unitDef != NULL)? unitDef->id: -1);
+	}
+}
+
+EXPORT(int) skirmishAiCallback_getUnitsPos(int skirmishAIId, int* unitIds, int unitIds_size, float* positions_AposF3) {
+
+	if (unitIds == NULL || positions_AposF3 == NULL || unitIds_size <= 0)
+		return 0;
+
+	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
+		_intern_getUnitsPos(skirmishAIId_cheatCallback[skirmishAIId], unitIds, unitIds_size, positions_AposF3);
+	} else {
+		_intern_getUnitsPos(skirmishAIId_callback[skirmishAIId], unitIds, unitIds_size, positions_AposF3);
+	}
+
+	return unitIds_size;
+}
+
+EXPORT(int) skirmishAiCallback_getUnitsVel(int skirmishAIId, int* unitIds, int unitIds_size, float* velocities_AposF3) {
+
+	if (unitIds == NULL || velocities_AposF3 == NULL || unitIds_size <= 0)
+		return 0;
+
+	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
+		_intern_getUnitsVel(skirmishAIId_cheatCallback[skirmishAIId], unitIds, unitIds_size, velocities_AposF3);
+	} else {
+		_intern_getUnitsVel(skirmishAIId_callback[skirmishAIId], unitIds, unitIds_size, velocities_AposF3);
+	}
+
+	return unitIds_size;
+}
+
+EXPORT(int) skirmishAiCallback_getUnitsHealth(int skirmishAIId, int* unitIds, int unitIds_size, float* healths) {
+
+	if (unitIds == NULL || healths == NULL || unitIds_size <= 0)
+		return 0;
+
+	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
+		_intern_getUnitsHealth(skirmishAIId_cheatCallback[skirmishAIId], unitIds, unitIds_size, healths);
+	} else {
+		_intern_getUnitsHealth(skirmishAIId_callback[skirmishAIId], unitIds, unitIds_size, healths);
+	}
+
+	return unitIds_size;
+}
+
+static const UnitsSnapshot& _intern_getUnitsSnapshot(int skirmishAIId) {
+
+	UnitsSnapshot& snapshot = skirmishAIId_unitsSnapshot[skirmishAIId];
+
+	const int frame = skirmishAIId_callback[skirmishAIId]->GetCurrentFrame();
+	const bool cheats = skirmishAiCallback_Cheats_isEnabled(skirmishAIId);
+
+	if (snapshot.frame == frame && snapshot.cheats == cheats)
+		return snapshot;
+
+	snapshot.frame = frame;
+	snapshot.cheats = cheats;
+
+	const int maxUnits = unitHandler->MaxUnits();
+
+	// friendly units first, then the visible enemies
+	snapshot.unitIds.resize(maxUnits * 2);
+
+	int numUnits = 0;
+	numUnits += skirmishAiCallback_getFriendlyUnits(skirmishAIId, &snapshot.unitIds[numUnits], maxUnits);
+	numUnits += skirmishAiCallback_getEnemyUnitsInRadarAndLos(skirmishAIId, &snapshot.unitIds[numUnits], maxUnits);
+
+	snapshot.unitIds.resize(numUnits);
+	snapshot.unitDefIds.resize(numUnits);
+	snapshot.positions.resize(numUnits * 3);
+	snapshot.healths.resize(numUnits);
+
+	if (numUnits == 0)
+		return snapshot;
+
+	if (cheats) {
+		CAICheats* clb = skirmishAIId_cheatCallback[skirmishAIId];
+		_intern_getUnitsDefIds(clb, &snapshot.unitIds[0], numUnits, &snapshot.unitDefIds[0]);
+		_intern_getUnitsPos(clb, &snapshot.unitIds[0], numUnits, &snapshot.positions[0]);
+		_intern_getUnitsHealth(clb, &snapshot.unitIds[0], numUnits, &snapshot.healths[0]);
+	} else {
+		CAICallback* clb = skirmishAIId_callback[skirmishAIId];
+		_intern_getUnitsDefIds(clb, &snapshot.unitIds[0], numUnits, &snapshot.unitDefIds[0]);
+		_intern_getUnitsPos(clb, &snapshot.unitIds[0], numUnits, &snapshot.positions[0]);
+		_intern_getUnitsHealth(clb, &snapshot.unitIds[0], numUnits, &snapshot.healths[0]);
+	}
+
+	return snapshot;
+}
+
+EXPORT(int) skirmishAiCallback_getUnitsSnapshot(int skirmishAIId, int* unitIds, int* unitDefIds, float* positions_AposF3, float* healths, int unitIds_sizeMax) {
+
+	const UnitsSnapshot& snapshot = _intern_getUnitsSnapshot(skirmishAIId);
+	const int unitIds_sizeReal = snapshot.unitIds.size();
+
+	if (unitIds == NULL)
+		return unitIds_sizeReal;
+
+	const int unitIds_size = min(unitIds_sizeReal, unitIds_sizeMax);
+
+	for (int u = 0; u < unitIds_size; u++) {
+		unitIds[u] = snapshot.unitIds[u];
+
+		if (unitDefIds != NULL) {
+			unitDefIds[u] = snapshot.unitDefIds[u];
+		}
+		if (positions_AposF3 != NULL) {
+			positions_AposF3[u * 3 + 0] = snapshot.positions[u * 3 + 0];
+			positions_AposF3[u * 3 + 1] = snapshot.positions[u * 3 + 1];
+			positions_AposF3[u * 3 + 2] = snapshot.positions[u * 3 + 2];
+		}
+		if (healths != NULL) {
+			healths[u] = snapshot.healths[u];
+		}
+	}
+
+	return unitIds_size;
+}
+
 //########### BEGINN FeatureDef
 EXPORT(int) skirmishAiCallback_getFeatureDefs(int skirmishAIId, int* featureDefIds, int featureDefIds_sizeMax) {
 
@@ -3772,6 +3974,7 @@ EXPORT(int) skirmishAiCallback_getFeaturesIn(int skirmishAIId, float* pos_posF3,
 
 	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
 		// cheating
+		boost::recursive_mutex::scoped_lock lock(CAICallback::engineMutex);
 		const std::vector<CFeature*>& fset = quadField->GetFeaturesExact(pos_posF3, radius);
 		const int featureIds_sizeReal = fset.size();
 
@@ -4503,7 +4706,7 @@ EXPORT(int) skirmishAiCallback_Group_OrderPreview_getParams(int skirmishAIId,
 
 	if (!isControlledByLocalPlayer(skirmishAIId)) { return 0; }
 
-	const std::vector<float>& ps = guihandler->GetOrderPreview().params;
+	const Command::Params& ps = guihandler->GetOrderPreview().params;
 	const size_t params_sizeReal = ps.size();
 
 	size_t params_size = params_sizeReal;
@@ -4850,6 +5053,10 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->getNeutralUnitsIn = &skirmishAiCallback_getNeutralUnitsIn;
 	callback->getTeamUnits = &skirmishAiCallback_getTeamUnits;
 	callback->getSelectedUnits = &skirmishAiCallback_getSelectedUnits;
+	callback->getUnitsPos = &skirmishAiCallback_getUnitsPos;
+	callback->getUnitsVel = &skirmishAiCallback_getUnitsVel;
+	callback->getUnitsHealth = &skirmishAiCallback_getUnitsHealth;
+	callback->getUnitsSnapshot = &skirmishAiCallback_getUnitsSnapshot;
 	callback->Unit_getDef = &skirmishAiCallback_Unit_getDef;
 	callback->Unit_getModParams = &skirmishAiCallback_Unit_getModParams;
 	callback->Unit_ModParam_getName = &skirmishAiCallback_Unit_ModParam_getName;
@@ -4955,6 +5162,9 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->Map_getLosMap = &skirmishAiCallback_Map_getLosMap;
 	callback->Map_getRadarMap = &skirmishAiCallback_Map_getRadarMap;
 	callback->Map_getJammerMap = &skirmishAiCallback_Map_getJammerMap;
+	callback->Map_getThreatMapCellSize = &skirmishAiCallback_Map_getThreatMapCellSize;
+	callback->Map_getThreatMap = &skirmishAiCallback_Map_getThreatMap;
+	callback->Map_getThreatMapPointer = &skirmishAiCallback_Map_getThreatMapPointer;
 	callback->Map_getResourceMapRaw = &skirmishAiCallback_Map_getResourceMapRaw;
 	callback->Map_getResourceMapSpotsPositions = &skirmishAiCallback_Map_getResourceMapSpotsPositions;
 	callback->Map_getResourceMapSpotsAverageIncome = &skirmishAiCallback_Map_getResourceMapSpotsAverageIncome;
@@ -5148,6 +5358,9 @@ SSkirmishAICallback* skirmishAiCallback_getInstanceFor(int skirmishAIId, int tea
 	skirmishAIId_cCallback[skirmishAIId]     = callback;
 	skirmishAIId_usesCheats[skirmishAIId]    = false;
 	skirmishAIId_teamId[skirmishAIId]        = teamId;
+	// insert these now, so lookups from concurrently updated AIs never modify the maps
+	skirmishAIId_cheatingEnabled[skirmishAIId] = false;
+	skirmishAIId_unitsSnapshot[skirmishAIId]   = UnitsSnapshot();
 
 	return callback;
 }
@@ -5162,5 +5375,7 @@ void skirmishAiCallback_release(int skirmishAIId) {
 	delete callback;
 
 	skirmishAIId_teamId.erase(skirmishAIId);
+	skirmishAIId_unitsSnapshot.erase(skirmishAIId);
+	skirmishAIId_cheatingEnabled.erase(skirmishAIId);
 }
 
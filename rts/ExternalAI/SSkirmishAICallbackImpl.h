@@ -668,6 +668,14 @@ EXPORT(int              ) skirmishAiCallback_getTeamUnits(int skirmishAIId, int*
 
 EXPORT(int              ) skirmishAiCallback_getSelectedUnits(int skirmishAIId, int* unitIds, int unitIds_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_getUnitsPos(int skirmishAIId, int* unitIds, int unitIds_size, float* positions_AposF3);
+
+EXPORT(int              ) skirmishAiCallback_getUnitsVel(int skirmishAIId, int* unitIds, int unitIds_size, float* velocities_AposF3);
+
+EXPORT(int              ) skirmishAiCallback_getUnitsHealth(int skirmishAIId, int* unitIds, int unitIds_size, float* healths);
+
+EXPORT(int              ) skirmishAiCallback_getUnitsSnapshot(int skirmishAIId, int* unitIds, int* unitDefIds, float* positions_AposF3, float* healths, int unitIds_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Unit_getDef(int skirmishAIId, int unitId);
 
 EXPORT(int              ) skirmishAiCallback_Unit_getModParams(int skirmishAIId, int unitId);
@@ -894,6 +902,12 @@ EXPORT(int              ) skirmishAiCallback_Map_getRadarMap(int skirmishAIId, i
 
 EXPORT(int              ) skirmishAiCallback_Map_getJammerMap(int skirmishAIId, int* jammerValues, int jammerValues_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_Map_getThreatMapCellSize(int skirmishAIId);
+
+EXPORT(int              ) skirmishAiCallback_Map_getThreatMap(int skirmishAIId, int layer, float* values, int values_sizeMax);
+
+EXPORT(const float*     ) skirmishAiCallback_Map_getThreatMapPointer(int skirmishAIId, int layer);
+
 EXPORT(int              ) skirmishAiCallback_Map_getResourceMapRaw(int skirmishAIId, int resourceId, short* resources, int resources_sizeMax);
 
 EXPORT(int              ) skirmishAiCallback_Map_getResourceMapSpotsPositions(int skirmishAIId, int resourceId, float* spots_AposF3, int spots_AposF3_sizeMax);
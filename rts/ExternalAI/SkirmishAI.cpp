@@ -6,9 +6,16 @@
 #include "IAILibraryManager.h"
 #include "SkirmishAILibrary.h"
 #include "SkirmishAIHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 #include "System/Util.h"
 
+#include <algorithm>
+
+CONFIG(float, AIFrameBudget).defaultValue(0.0f).minimumValue(0.0f).description("Milliseconds a Skirmish AI may spend handling the events of one sim-frame before a warning (at most one per minute per AI) is logged; 0 disables the check.");
+
 CSkirmishAI::CSkirmishAI(int skirmishAIId, int teamId, const SkirmishAIKey& key,
 		const SSkirmishAICallback* callback) :
 		skirmishAIId(skirmishAIId),
@@ -17,9 +24,19 @@ CSkirmishAI::CSkirmishAI(int skirmishAIId, int teamId, const SkirmishAIKey& key,
 		timerName("AI t:" + IntToString(teamId) +
 		          " id:" + IntToString(skirmishAIId) +
 		          " " + key.GetShortName() + " " + key.GetVersion()),
+		frameBudget(configHandler->GetFloat("AIFrameBudget")),
+		budgetFrame(-1),
+		budgetFrameTime(spring_notime),
+		budgetEventTimes(NUM_EVENTS + 1, spring_notime),
+		lastBudgetWarning(spring_notime),
 		initOk(false),
 		dieing(false)
 {
+	for (int topic = 0; topic < NUM_EVENTS; topic++) {
+		eventTimerNames.push_back(timerName + " topic:" + IntToString(topic));
+	}
+	eventTimerNames.push_back(timerName + " batch");
+
 	SCOPED_TIMER(timerName.c_str());
 	library = IAILibraryManager::GetInstance()->FetchSkirmishAILibrary(key);
 	if (library == NULL) {
@@ -54,9 +71,76 @@ int CSkirmishAI::HandleEvent(int topic, const void* data) const {
 
 	SCOPED_TIMER(timerName.c_str());
 	if (!dieing || (topic == EVENT_RELEASE)) {
-		return library->HandleEvent(skirmishAIId, topic, data);
+		const int idx = (topic >= 0 && topic < NUM_EVENTS)? topic: NUM_EVENTS;
+		const spring_time t0 = spring_gettime();
+		int ret;
+
+		{
+			ScopedTraceTimer traceTimer(eventTimerNames[idx]);
+			ret = library->HandleEvent(skirmishAIId, topic, data);
+		}
+
+		AddEventTime(topic, spring_gettime() - t0);
+		return ret;
+	} else {
+		// to prevent log error spam, signal: OK
+		return 0;
+	}
+}
+
+int CSkirmishAI::HandleEvents(const int* topics, const void* const* data, int numEvents) const {
+
+	SCOPED_TIMER(timerName.c_str());
+	if (!dieing) {
+		const spring_time t0 = spring_gettime();
+		int ret;
+
+		{
+			ScopedTraceTimer traceTimer(eventTimerNames[NUM_EVENTS]);
+			ret = library->HandleEvents(skirmishAIId, topics, data, numEvents);
+		}
+
+		AddEventTime(-1, spring_gettime() - t0);
+		return ret;
 	} else {
 		// to prevent log error spam, signal: OK
 		return 0;
 	}
 }
+
+bool CSkirmishAI::HasHandleEvents() const {
+	return (library != NULL && library->HasHandleEvents());
+}
+
+void CSkirmishAI::AddEventTime(int topic, spring_time dt) const {
+
+	if (frameBudget <= 0.0f)
+		return;
+
+	if (gs->frameNum != budgetFrame) {
+		const spring_time now = spring_gettime();
+
+		if (budgetFrameTime.toMilliSecsf() > frameBudget && (!lastBudgetWarning.isDuration() || (now - lastBudgetWarning).toMilliSecsf() > 60000.0f)) {
+			const size_t maxIdx = std::max_element(budgetEventTimes.begin(), budgetEventTimes.end()) - budgetEventTimes.begin();
+			const std::string maxName = (maxIdx < NUM_EVENTS)? ("event topic " + IntToString(maxIdx)): "batched events";
+
+			LOG_L(L_WARNING,
+				"[%s] %s: used %.1fms in frame %i (budget %.1fms), most of it (%.1fms) for %s",
+				__FUNCTION__, timerName.c_str(), budgetFrameTime.toMilliSecsf(), budgetFrame, frameBudget,
+				budgetEventTimes[maxIdx].toMilliSecsf(), maxName.c_str()
+			);
+
+			lastBudgetWarning = now;
+		}
+
+		budgetFrame = gs->frameNum;
+		budgetFrameTime = spring_notime;
+
+		std::fill(budgetEventTimes.begin(), budgetEventTimes.end(), spring_notime);
+	}
+
+	const size_t idx = (topic >= 0 && topic < NUM_EVENTS)? topic: NUM_EVENTS;
+
+	budgetFrameTime += dt;
+	budgetEventTimes[idx] += dt;
+}
@@ -4,8 +4,10 @@
 #define SKIRMISH_AI_H
 
 #include "SkirmishAIKey.h"
+#include "System/Misc/SpringTime.h"
 
 #include <string>
+#include <vector>
 
 class CSkirmishAILibrary;
 struct SSkirmishAICallback;
@@ -26,6 +28,13 @@ public:
 	 * CAUTION: takes C AI Interface events, not engine C++ ones!
 	 */
 	int HandleEvent(int topic, const void* data) const;
+	/**
+	 * Delivers numEvents events in one call.
+	 * CAUTION: takes C AI Interface events, not engine C++ ones!
+	 */
+	int HandleEvents(const int* topics, const void* const* data, int numEvents) const;
+	/// true if the AI library takes batched events (handleEvents)
+	bool HasHandleEvents() const;
 
 	/**
 	 * Initialize the AI instance.
@@ -42,12 +51,31 @@ public:
 	 */
 	void Dieing();
 
+private:
+	/**
+	 * Accounts the time spent in the AI for an event to the current frame,
+	 * and warns if the previous frame went over the AIFrameBudget.
+	 * @param topic the event topic, or -1 for a batch
+	 */
+	void AddEventTime(int topic, spring_time dt) const;
+
 private:
 	int skirmishAIId;
 	const SkirmishAIKey key;
 	const CSkirmishAILibrary* library;
 	const SSkirmishAICallback* callback;
 	const std::string timerName;
+	/// trace-event names per topic (the last one for batches)
+	std::vector<std::string> eventTimerNames;
+
+	/// in milliseconds, 0 if disabled
+	float frameBudget;
+
+	mutable int budgetFrame;
+	mutable spring_time budgetFrameTime;
+	mutable std::vector<spring_time> budgetEventTimes;
+	mutable spring_time lastBudgetWarning;
+
 	bool initOk;
 	bool dieing;
 };
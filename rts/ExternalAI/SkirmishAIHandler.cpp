@@ -25,11 +25,14 @@ CR_REG_METADATA(CSkirmishAIHandler, (
 	CR_MEMBER(id_dieReason),
 	CR_MEMBER(id_libKey),
 	CR_MEMBER(gameInitialized),
-	CR_MEMBER(luaAIShortNames),
-	CR_IGNORED(currentAIId)
+	CR_MEMBER(luaAIShortNames)
 ));
 
 
+// per thread, since AIs may be updated concurrently (see CEngineOutHandler::Update)
+static __thread unsigned char currentAIId = MAX_AIS;
+
+
 CSkirmishAIHandler& CSkirmishAIHandler::GetInstance()
 {
 	static CSkirmishAIHandler mySingleton;
@@ -37,7 +40,7 @@ CSkirmishAIHandler& CSkirmishAIHandler::GetInstance()
 }
 
 CSkirmishAIHandler::CSkirmishAIHandler():
-	gameInitialized(false), currentAIId(MAX_AIS)
+	gameInitialized(false)
 {
 }
 
@@ -310,3 +313,13 @@ void CSkirmishAIHandler::CompleteSkirmishAI(const size_t skirmishAIId) {
 		}
 	}
 }
+
+unsigned char CSkirmishAIHandler::GetCurrentAIID() const
+{
+	return currentAIId;
+}
+
+void CSkirmishAIHandler::SetCurrentAIID(unsigned char id)
+{
+	currentAIId = id;
+}
@@ -172,8 +172,9 @@ public:
 
 	const std::set<std::string>& GetLuaAIImplShortNames() const;
 
-	unsigned char GetCurrentAIID() { return currentAIId; }
-	void SetCurrentAIID(unsigned char id) { currentAIId = id; }
+	/// the local AI ID executing on the calling thread, MAX_AIS if none (e.g. LuaUI)
+	unsigned char GetCurrentAIID() const;
+	void SetCurrentAIID(unsigned char id);
 
 private:
 	static bool IsLocalSkirmishAI(const SkirmishAIData& aiData);
@@ -197,8 +198,6 @@ private:
 
 	bool gameInitialized;
 	std::set<std::string> luaAIShortNames;
-	// the current local AI ID that is executing, MAX_AIS if none (e.g. LuaUI)
-	unsigned char currentAIId;
 };
 
 #define skirmishAIHandler CSkirmishAIHandler::GetInstance()
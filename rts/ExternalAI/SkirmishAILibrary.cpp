@@ -106,3 +106,31 @@ int CSkirmishAILibrary::HandleEvent(int skirmishAIId, int topic, const void* dat
 
 	return ret;
 }
+
+int CSkirmishAILibrary::HandleEvents(int skirmishAIId, const int* topics, const void* const* data, int numEvents) const
+{
+	if (sSAI.handleEvents == NULL) {
+		int ret = 0;
+
+		for (int n = 0; n < numEvents && ret == 0; n++) {
+			ret = HandleEvent(skirmishAIId, topics[n], data[n]);
+		}
+
+		return ret;
+	}
+
+	skirmishAIHandler.SetCurrentAIID(skirmishAIId);
+	int ret = sSAI.handleEvents(skirmishAIId, topics, data, numEvents);
+	skirmishAIHandler.SetCurrentAIID(MAX_AIS);
+
+	if (ret != 0) {
+		// event handling failed!
+		const int teamId = skirmishAIHandler.GetSkirmishAI(skirmishAIId)->team;
+		LOG_L(L_WARNING,
+			"AI for team %i (ID: %i) failed handling %i batched events, error: %i",
+			teamId, skirmishAIId, numEvents, ret
+		);
+	}
+
+	return ret;
+}
@@ -33,6 +33,9 @@ public:
 	bool Init(int skirmishAIId, const SSkirmishAICallback* c_callback) const;
 	bool Release(int skirmishAIId) const;
 	int HandleEvent(int skirmishAIId, int topic, const void* data) const;
+	/// delivers numEvents events at once; uses handleEvent if the AI lacks handleEvents
+	int HandleEvents(int skirmishAIId, const int* topics, const void* const* data, int numEvents) const;
+	bool HasHandleEvents() const { return (sSAI.handleEvents != NULL); }
 
 private:
 	SSkirmishAILibrary sSAI;
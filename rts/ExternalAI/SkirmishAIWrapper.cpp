@@ -44,6 +44,9 @@ CR_REG_METADATA(CSkirmishAIWrapper, (
 	CR_IGNORED(cheats),
 	CR_IGNORED(c_callback),
 	CR_IGNORED(info),
+	CR_IGNORED(eventQueue),
+	CR_IGNORED(eventTopics),
+	CR_IGNORED(eventData),
 
 	CR_SERIALIZER(Serialize),
 	CR_POSTLOAD(PostLoad)
@@ -197,7 +200,7 @@ void CSkirmishAIWrapper::Init() {
 	}
 
 	SInitEvent evtData = {skirmishAIId, GetCallback()};
-	int error = ai->HandleEvent(EVENT_INIT, &evtData);
+	int error = HandleEvent(EVENT_INIT, &evtData);
 	if (error != 0) {
 		// init failed
 		LOG_L(L_ERROR, "Failed to handle init event: AI for team %d, error %d",
@@ -219,7 +222,7 @@ void CSkirmishAIWrapper::Release(int reason) {
 
 	if (initialized && !released) {
 		SReleaseEvent evtData = {reason};
-		ai->HandleEvent(EVENT_RELEASE, &evtData);
+		HandleEvent(EVENT_RELEASE, &evtData);
 
 		released = true;
 
@@ -269,7 +272,7 @@ void CSkirmishAIWrapper::Load(std::istream* load_s)
 	tmpFile_s.close();
 
 	SLoadEvent evtData = {tmpFile.c_str()};
-	ai->HandleEvent(EVENT_LOAD, &evtData);
+	HandleEvent(EVENT_LOAD, &evtData);
 
 	FileSystem::DeleteFile(tmpFile);
 }
@@ -279,7 +282,7 @@ void CSkirmishAIWrapper::Save(std::ostream* save_s)
 	const std::string tmpFile = createTempFileName("save", teamId, skirmishAIId);
 
 	SSaveEvent evtData = {tmpFile.c_str()};
-	ai->HandleEvent(EVENT_SAVE, &evtData);
+	HandleEvent(EVENT_SAVE, &evtData);
 
 	if (FileSystem::FileExists(tmpFile)) {
 		std::ifstream tmpFile_s;
@@ -291,115 +294,140 @@ void CSkirmishAIWrapper::Save(std::ostream* save_s)
 }
 
 void CSkirmishAIWrapper::UnitIdle(int unitId) {
-	SUnitIdleEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_UNIT_IDLE, &evtData);
+	QueuedEvent evt;
+	evt.topic = EVENT_UNIT_IDLE;
+	evt.data.unitIdle.unit = unitId;
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::UnitCreated(int unitId, int builderId) {
 	SUnitCreatedEvent evtData = {unitId, builderId};
-	ai->HandleEvent(EVENT_UNIT_CREATED, &evtData);
+	HandleEvent(EVENT_UNIT_CREATED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitFinished(int unitId) {
 	SUnitFinishedEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_UNIT_FINISHED, &evtData);
+	HandleEvent(EVENT_UNIT_FINISHED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitDestroyed(int unitId, int attackerUnitId) {
 
 	SUnitDestroyedEvent evtData = {unitId, attackerUnitId};
-	ai->HandleEvent(EVENT_UNIT_DESTROYED, &evtData);
+	HandleEvent(EVENT_UNIT_DESTROYED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitDamaged(int unitId, int attackerUnitId,
 		float damage, const float3& dir, int weaponDefId, bool paralyzer) {
 
-	SUnitDamagedEvent evtData = {unitId, attackerUnitId, damage,
-			new float[3], weaponDefId, paralyzer};
-	dir.copyInto(evtData.dir_posF3);
-	ai->HandleEvent(EVENT_UNIT_DAMAGED, &evtData);
-	delete [] evtData.dir_posF3;
+	QueuedEvent evt;
+	evt.topic = EVENT_UNIT_DAMAGED;
+	evt.data.unitDamaged.unit = unitId;
+	evt.data.unitDamaged.attacker = attackerUnitId;
+	evt.data.unitDamaged.damage = damage;
+	evt.data.unitDamaged.dir_posF3 = NULL;
+	evt.data.unitDamaged.weaponDefId = weaponDefId;
+	evt.data.unitDamaged.paralyzer = paralyzer;
+	dir.copyInto(evt.vec);
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::UnitMoveFailed(int unitId) {
-	SUnitMoveFailedEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_UNIT_MOVE_FAILED, &evtData);
+	QueuedEvent evt;
+	evt.topic = EVENT_UNIT_MOVE_FAILED;
+	evt.data.unitMoveFailed.unit = unitId;
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::UnitGiven(int unitId, int oldTeam, int newTeam) {
 	SUnitGivenEvent evtData = {unitId, oldTeam, newTeam};
-	ai->HandleEvent(EVENT_UNIT_GIVEN, &evtData);
+	HandleEvent(EVENT_UNIT_GIVEN, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitCaptured(int unitId, int oldTeam, int newTeam) {
 	SUnitCapturedEvent evtData = {unitId, oldTeam, newTeam};
-	ai->HandleEvent(EVENT_UNIT_CAPTURED, &evtData);
+	HandleEvent(EVENT_UNIT_CAPTURED, &evtData);
 }
 
 
 void CSkirmishAIWrapper::EnemyCreated(int unitId) {
 	SEnemyCreatedEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_ENEMY_CREATED, &evtData);
+	HandleEvent(EVENT_ENEMY_CREATED, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyFinished(int unitId) {
 	SEnemyFinishedEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_ENEMY_FINISHED, &evtData);
+	HandleEvent(EVENT_ENEMY_FINISHED, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyEnterLOS(int unitId) {
-	SEnemyEnterLOSEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_ENEMY_ENTER_LOS, &evtData);
+	QueuedEvent evt;
+	evt.topic = EVENT_ENEMY_ENTER_LOS;
+	evt.data.enemyEnterLOS.enemy = unitId;
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveLOS(int unitId) {
-	SEnemyLeaveLOSEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_ENEMY_LEAVE_LOS, &evtData);
+	QueuedEvent evt;
+	evt.topic = EVENT_ENEMY_LEAVE_LOS;
+	evt.data.enemyLeaveLOS.enemy = unitId;
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::EnemyEnterRadar(int unitId) {
-	SEnemyEnterRadarEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_ENEMY_ENTER_RADAR, &evtData);
+	QueuedEvent evt;
+	evt.topic = EVENT_ENEMY_ENTER_RADAR;
+	evt.data.enemyEnterRadar.enemy = unitId;
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveRadar(int unitId) {
-	SEnemyLeaveRadarEvent evtData = {unitId};
-	ai->HandleEvent(EVENT_ENEMY_LEAVE_RADAR, &evtData);
+	QueuedEvent evt;
+	evt.topic = EVENT_ENEMY_LEAVE_RADAR;
+	evt.data.enemyLeaveRadar.enemy = unitId;
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::EnemyDestroyed(int enemyUnitId, int attackerUnitId) {
 	SEnemyDestroyedEvent evtData = {enemyUnitId, attackerUnitId};
-	ai->HandleEvent(EVENT_ENEMY_DESTROYED, &evtData);
+	HandleEvent(EVENT_ENEMY_DESTROYED, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyDamaged(int enemyUnitId, int attackerUnitId,
 		float damage, const float3& dir, int weaponDefId, bool paralyzer) {
 
-	SEnemyDamagedEvent evtData = {enemyUnitId, attackerUnitId, damage,
-			new float[3], weaponDefId, paralyzer};
-	dir.copyInto(evtData.dir_posF3);
-	ai->HandleEvent(EVENT_ENEMY_DAMAGED, &evtData);
-	delete [] evtData.dir_posF3;
+	QueuedEvent evt;
+	evt.topic = EVENT_ENEMY_DAMAGED;
+	evt.data.enemyDamaged.enemy = enemyUnitId;
+	evt.data.enemyDamaged.attacker = attackerUnitId;
+	evt.data.enemyDamaged.damage = damage;
+	evt.data.enemyDamaged.dir_posF3 = NULL;
+	evt.data.enemyDamaged.weaponDefId = weaponDefId;
+	evt.data.enemyDamaged.paralyzer = paralyzer;
+	dir.copyInto(evt.vec);
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::Update(int frame) {
 	SUpdateEvent evtData = {frame};
-	ai->HandleEvent(EVENT_UPDATE, &evtData);
+	HandleEvent(EVENT_UPDATE, &evtData);
 }
 
 void CSkirmishAIWrapper::SendChatMessage(const char* msg, int fromPlayerId) {
 	SMessageEvent evtData = {fromPlayerId, msg};
-	ai->HandleEvent(EVENT_MESSAGE, &evtData);
+	HandleEvent(EVENT_MESSAGE, &evtData);
 }
 
 void CSkirmishAIWrapper::SendLuaMessage(const char* inData, const char** outData) {
 	SLuaMessageEvent evtData = {inData /*outData*/};
-	ai->HandleEvent(EVENT_LUA_MESSAGE, &evtData);
+	HandleEvent(EVENT_LUA_MESSAGE, &evtData);
 }
 
 void CSkirmishAIWrapper::WeaponFired(int unitId, int weaponDefId) {
-	SWeaponFiredEvent evtData = {unitId, weaponDefId};
-	ai->HandleEvent(EVENT_WEAPON_FIRED, &evtData);
+	QueuedEvent evt;
+	evt.topic = EVENT_WEAPON_FIRED;
+	evt.data.weaponFired.unitId = unitId;
+	evt.data.weaponFired.weaponDefId = weaponDefId;
+	QueueEvent(evt);
 }
 
 void CSkirmishAIWrapper::PlayerCommandGiven(
@@ -415,25 +443,85 @@ void CSkirmishAIWrapper::PlayerCommandGiven(
 	}
 
 	SPlayerCommandEvent evtData = {unitIds, static_cast<int>(playerSelectedUnits.size()), cCommandId, playerId};
-	ai->HandleEvent(EVENT_PLAYER_COMMAND, &evtData);
+	HandleEvent(EVENT_PLAYER_COMMAND, &evtData);
 	delete[] unitIds;
 }
 
 void CSkirmishAIWrapper::CommandFinished(int unitId, int commandId, int commandTopicId) {
 	SCommandFinishedEvent evtData = {unitId, commandId, commandTopicId};
-	ai->HandleEvent(EVENT_COMMAND_FINISHED, &evtData);
+	HandleEvent(EVENT_COMMAND_FINISHED, &evtData);
 }
 
 void CSkirmishAIWrapper::SeismicPing(int allyTeam, int unitId,
 		const float3& pos, float strength) {
 
-	SSeismicPingEvent evtData = {new float[3], strength};
-	pos.copyInto(evtData.pos_posF3);
-	ai->HandleEvent(EVENT_SEISMIC_PING, &evtData);
-	delete [] evtData.pos_posF3;
+	QueuedEvent evt;
+	evt.topic = EVENT_SEISMIC_PING;
+	evt.data.seismicPing.pos_posF3 = NULL;
+	evt.data.seismicPing.strength = strength;
+	pos.copyInto(evt.vec);
+	QueueEvent(evt);
 }
 
 
+int CSkirmishAIWrapper::HandleEvent(int topic, const void* data) {
+	FlushEvents();
+	return ai->HandleEvent(topic, data);
+}
+
+void CSkirmishAIWrapper::QueueEvent(const QueuedEvent& event) {
+	eventQueue.push_back(event);
+
+	if (!ai->HasHandleEvents()) {
+		FlushEvents();
+	}
+}
+
+void CSkirmishAIWrapper::FlushEvents() {
+	if (eventQueue.empty())
+		return;
+
+	eventTopics.resize(eventQueue.size());
+	eventData.resize(eventQueue.size());
+
+	for (size_t n = 0; n < eventQueue.size(); n++) {
+		QueuedEvent& evt = eventQueue[n];
+
+		// the queue may have been reallocated since the event was queued
+		switch (evt.topic) {
+			case EVENT_UNIT_DAMAGED:  { evt.data.unitDamaged.dir_posF3  = &evt.vec[0]; } break;
+			case EVENT_ENEMY_DAMAGED: { evt.data.enemyDamaged.dir_posF3 = &evt.vec[0]; } break;
+			case EVENT_SEISMIC_PING:  { evt.data.seismicPing.pos_posF3  = &evt.vec[0]; } break;
+			default: {} break;
+		}
+
+		eventTopics[n] = evt.topic;
+		eventData[n] = &evt.data;
+	}
+
+	// clear first, the AI may cause new events while handling these
+	std::vector<QueuedEvent> events;
+	std::vector<int> topics;
+	std::vector<const void*> data;
+
+	events.swap(eventQueue);
+	topics.swap(eventTopics);
+	data.swap(eventData);
+
+	ai->HandleEvents(&topics[0], &data[0], topics.size());
+
+	// hand the buffers back, keeping their capacity for the next frame
+	if (eventQueue.empty()) {
+		events.clear();
+		topics.clear();
+		data.clear();
+
+		events.swap(eventQueue);
+		topics.swap(eventTopics);
+		data.swap(eventData);
+	}
+}
+
 int CSkirmishAIWrapper::GetTeamId() const {
 	return teamId;
 }
@@ -446,6 +534,18 @@ const SSkirmishAICallback* CSkirmishAIWrapper::GetCallback() const {
 	return c_callback;
 }
 
+void CSkirmishAIWrapper::SetDeferCommands(bool defer) {
+	if (callback != NULL) {
+		callback->SetDeferNetPackets(defer);
+	}
+}
+
+void CSkirmishAIWrapper::FlushDeferredCommands() {
+	if (callback != NULL) {
+		callback->FlushNetPackets();
+	}
+}
+
 void CSkirmishAIWrapper::SetCheatEventsEnabled(bool enable) {
 	cheatEvents = enable;
 }
@@ -6,9 +6,11 @@
 #include "System/Object.h"
 #include "SkirmishAIKey.h"
 #include "System/Platform/SharedLib.h"
+#include "ExternalAI/Interface/AISEvents.h"
 
 #include <map>
 #include <string>
+#include <vector>
 
 class CAICallback;
 class CAICheats;
@@ -75,6 +77,14 @@ public:
 	virtual void SetCheatEventsEnabled(bool enable);
 	virtual bool IsCheatEventsEnabled() const;
 
+	/// delivers all queued events to the AI (see QueueEvent)
+	void FlushEvents();
+
+	/// buffer the AI's outgoing commands instead of sending them immediately
+	void SetDeferCommands(bool defer);
+	/// send the commands buffered since SetDeferCommands(true)
+	void FlushDeferredCommands();
+
 	virtual void Init();
 	void Dieing();
 	/// @see SReleaseEvent in Interface/AISEvents.h
@@ -85,6 +95,37 @@ public:
 private:
 	bool LoadSkirmishAI(bool postLoad);
 
+	/// a high-frequency event, waiting to be sent in a batch
+	struct QueuedEvent {
+		int topic;
+
+		union {
+			SUnitIdleEvent unitIdle;
+			SUnitMoveFailedEvent unitMoveFailed;
+			SUnitDamagedEvent unitDamaged;
+			SEnemyEnterLOSEvent enemyEnterLOS;
+			SEnemyLeaveLOSEvent enemyLeaveLOS;
+			SEnemyEnterRadarEvent enemyEnterRadar;
+			SEnemyLeaveRadarEvent enemyLeaveRadar;
+			SEnemyDamagedEvent enemyDamaged;
+			SWeaponFiredEvent weaponFired;
+			SSeismicPingEvent seismicPing;
+		} data;
+
+		/// storage for dir_posF3 / pos_posF3, pointed to when flushing
+		float vec[3];
+	};
+
+	/**
+	 * Sends an event right away, after flushing the queue so the AI still
+	 * receives all events in order.
+	 */
+	int HandleEvent(int topic, const void* data);
+	/**
+	 * Queues the event if the AI takes batched events, otherwise sends it.
+	 */
+	void QueueEvent(const QueuedEvent& event);
+
 
 	int skirmishAIId;
 	int teamId;
@@ -98,6 +139,10 @@ private:
 	SSkirmishAICallback* c_callback;
 	SkirmishAIKey key;
 	const struct InfoItem* info;
+
+	std::vector<QueuedEvent> eventQueue;
+	std::vector<int> eventTopics;
+	std::vector<const void*> eventData;
 };
 
 #endif // SKIRMISH_AI_WRAPPER_H
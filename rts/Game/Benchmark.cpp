@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <map>
 #include <stdio.h>
 #include "Benchmark.h"
@@ -12,6 +13,10 @@
 #include "Sim/Features/FeatureHandler.h"
 #include "System/TimeProfiler.h"
 
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
 static std::map<float, float> realFPS;
 static std::map<float, float> drawFPS;
 static std::map<int, float>   simFPS;
@@ -20,6 +25,116 @@ static std::map<int, size_t>  features;
 static std::map<int, float>   gameSpeed;
 static std::map<int, float>   luaUsage;
 
+/**
+ * Per-frame timings written to benchmark.json, taken from the profiler's
+ * (cumulative) timers. Subsystems may overlap: e.g. LOS updates and path
+ * requests issued by units are also counted as unit time, and Lua also
+ * includes the unsynced call-ins run between two sim frames.
+ */
+struct BenchmarkSubsystem {
+	const char* name;
+	const char* timers[6];
+};
+
+static const BenchmarkSubsystem subsystems[] = {
+	{"sim",        {"SimFrame", NULL}},
+	{"path",       {"PathManager::Update", NULL}},
+	{"unit",       {"Unit::MoveType::PreUpdateMT", "Unit::MoveType::Update", "Unit::UpdatePieceMatrices", "Unit::Update", "Unit::SlowUpdate", NULL}},
+	{"projectile", {"ProjectileHandler::CheckCollisions", "ProjectileHandler::Update", NULL}},
+	{"los",        {"LOSHandler::MoveUnit", "LOSHandler::UpdatePendingInstances", NULL}},
+	{"lua",        {"Lua", NULL}},
+	{"cob",        {"CobEngine::Tick", "UnitScriptEngine::Tick", NULL}},
+};
+static const size_t numSubsystems = sizeof(subsystems) / sizeof(subsystems[0]);
+
+static std::vector<float> subsystemTimes[numSubsystems]; ///< ms per frame
+static spring_time subsystemTotals[numSubsystems];
+
+
+static spring_time GetSubsystemTotal(const BenchmarkSubsystem& subsystem)
+{
+	spring_time total = spring_notime;
+
+	for (size_t n = 0; subsystem.timers[n] != NULL; n++) {
+		const std::map<std::string, CTimeProfiler::TimeRecord>::const_iterator it = profiler.profile.find(subsystem.timers[n]);
+
+		if (it != profiler.profile.end()) {
+			total += it->second.total;
+		}
+	}
+
+	return total;
+}
+
+/// in KiB, or 0 if not available
+static unsigned long GetPeakRSS()
+{
+#ifndef WIN32
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	#ifdef __APPLE__
+	return (usage.ru_maxrss / 1024); // bytes
+	#else
+	return usage.ru_maxrss;
+	#endif
+#else
+	return 0;
+#endif
+}
+
+static float GetPercentile(std::vector<float> values, float p)
+{
+	if (values.empty())
+		return 0.0f;
+
+	const size_t n = std::min(values.size() - 1, size_t(p * values.size()));
+
+	std::nth_element(values.begin(), values.begin() + n, values.end());
+	return values[n];
+}
+
+static void WriteBenchmarkJSON(const char* fileName)
+{
+	FILE* pFile = fopen(fileName, "w");
+
+	if (pFile == NULL)
+		return;
+
+	fprintf(pFile, "{\n");
+	fprintf(pFile, "\t\"startFrame\": %d,\n", CBenchmark::startFrame);
+	fprintf(pFile, "\t\"endFrame\": %d,\n", CBenchmark::endFrame);
+	fprintf(pFile, "\t\"numFrames\": " _STPF_ ",\n", subsystemTimes[0].size());
+	fprintf(pFile, "\t\"peakRSS_KiB\": %lu,\n", GetPeakRSS());
+	fprintf(pFile, "\t\"subsystems\": {\n");
+
+	for (size_t i = 0; i < numSubsystems; i++) {
+		const std::vector<float>& times = subsystemTimes[i];
+
+		float sum = 0.0f;
+		float max = 0.0f;
+
+		for (size_t n = 0; n < times.size(); n++) {
+			sum += times[n];
+			max = std::max(max, times[n]);
+		}
+
+		fprintf(pFile, "\t\t\"%s\": {\"mean_ms\": %f, \"p50_ms\": %f, \"p99_ms\": %f, \"max_ms\": %f}%s\n",
+			subsystems[i].name,
+			times.empty()? 0.0f: (sum / times.size()),
+			GetPercentile(times, 0.50f),
+			GetPercentile(times, 0.99f),
+			max,
+			(i + 1 < numSubsystems)? ",": "");
+	}
+
+	fprintf(pFile, "\t}\n");
+	fprintf(pFile, "}\n");
+	fclose(pFile);
+}
+
 bool CBenchmark::enabled = false;
 int CBenchmark::startFrame = 0;
 int CBenchmark::endFrame = 5 * 60 * GAME_SPEED;
@@ -59,10 +174,23 @@ CBenchmark::~CBenchmark()
 		}
 	}
 	fclose(pFile);
+
+	WriteBenchmarkJSON("benchmark.json");
 }
 
 void CBenchmark::GameFrame(int gameFrame)
 {
+	// the differences since the last call cover the previous sim frame
+	for (size_t i = 0; i < numSubsystems; i++) {
+		const spring_time total = GetSubsystemTotal(subsystems[i]);
+
+		if (gameFrame > startFrame) {
+			subsystemTimes[i].push_back((total - subsystemTotals[i]).toMilliSecsf());
+		}
+
+		subsystemTotals[i] = total;
+	}
+
 	if (gameFrame == 0 && (startFrame - 45 * GAME_SPEED > 0)) {
 		std::vector<string> cmds;
 		cmds.push_back("@@setmaxspeed 100");
@@ -97,6 +97,7 @@
 #include "Sim/Misc/SideParser.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Misc/TeamHandler.h"
+#include "Sim/Misc/ThreatMap.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/Misc/ResourceHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -135,29 +136,39 @@
 #include "System/Sync/FPUCheck.h"
 #include "System/GlobalConfig.h"
 #include "System/myMath.h"
+#include "System/CRC.h"
 #include "Net/GameServer.h"
 #include "Net/Protocol/NetProtocol.h"
 #include "System/SpringApp.h"
 #include "System/Util.h"
+#include "System/FrameArena.h"
 #include "System/Input/KeyInput.h"
 #include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/VFSHandler.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
 #include "System/Net/PackPacket.h"
 #include "System/Platform/CrashHandler.h"
+#include "System/Platform/Threading.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/SoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/Sync/SyncChecker.h"
 #include "System/Sync/SyncedPrimitiveIO.h"
 #include "System/Sync/SyncTracer.h"
 #include "System/TimeProfiler.h"
 
 #include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include "lib/lua/include/LuaUser.h"
 
 #undef CreateDirectory
@@ -175,7 +186,13 @@ CONFIG(bool, ShowClock).defaultValue(true).description("Displays a clock on the
 CONFIG(bool, ShowSpeed).defaultValue(false).description("Displays current game speed.");
 CONFIG(bool, ShowMTInfo).defaultValue(true);
 CONFIG(float, MTInfoThreshold).defaultValue(1.0f);
+CONFIG(float, ProfileTraceSpikeThreshold).defaultValue(0.0f).minimumValue(0.0f).description("If non-zero, the profiled timers of the last few seconds are written to a Chrome trace-event file whenever a sim-frame takes longer than this many milliseconds (at most once per minute).");
+CONFIG(int, AutoSaveInterval).defaultValue(0).minimumValue(0).description("If non-zero, a snapshot of the game state is taken every this many seconds of game time and written to Saves/AutoSave.ssf on a background thread (requires UseCREGSaveLoad).");
+CONFIG(int, NetFrameJitterBuffer).defaultValue(2).minimumValue(0).description("Number of sim-frames a client keeps queued to absorb network jitter; the consume rate is steered to hold this depth instead of stalling and bursting. Backlogs above a second of frames are still caught up as fast as possible. 0 disables the buffer.");
+CONFIG(int, RejoinCatchUpThreshold).defaultValue(10).minimumValue(0).description("When a client has more than this many seconds of game time queued (e.g. after reconnecting or joining mid-game) it skips the unsynced per-frame work and spends nearly all time simulating until the backlog is gone. 0 disables.");
 CONFIG(int, ShowPlayerInfo).defaultValue(1);
+CONFIG(bool, PreloadModels).defaultValue(true).description("Parse the models of all unit-, feature- and weapon-definitions in parallel while loading, instead of one by one when first needed.");
+CONFIG(bool, DefsCache).defaultValue(false).description("Cache the tables returned by gamedata/defs.lua (keyed by game, map, their options and the engine version) and skip running them when nothing of that changed. Lua table iteration order can differ between cached and freshly parsed defs, so only enable it when all players do.");
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
 CONFIG(bool, LuaModUICtrl).defaultValue(true);
@@ -195,6 +212,10 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(lastSimFrameTime),
 	CR_IGNORED(lastDrawFrameTime),
 	CR_IGNORED(lastFrameTime),
+	CR_IGNORED(lastTraceDumpTime),
+	CR_IGNORED(traceSpikeThreshold),
+	CR_IGNORED(autoSaveInterval),
+	CR_IGNORED(autoSaveThread),
 	CR_IGNORED(updateDeltaSeconds),
 	CR_MEMBER(totalGameTime),
 	CR_MEMBER(userInputPrefix),
@@ -220,10 +241,15 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(inputTextSizeX),
 	CR_IGNORED(inputTextSizeY),
 	CR_IGNORED(skipping),
+	CR_IGNORED(catchingUp),
+	CR_IGNORED(catchUpThreshold),
 	CR_MEMBER(playing),
 	CR_IGNORED(msgProcTimeLeft),
 	CR_IGNORED(consumeSpeed),
 	CR_IGNORED(lastframe),
+	CR_IGNORED(netFrameBufferTarget),
+	CR_IGNORED(netFrameBufferDepth),
+	CR_IGNORED(netFrameBufferAvgDepth),
 
 	CR_POSTLOAD(PostLoad)
 ));
@@ -331,18 +357,26 @@ CGame::CGame(const std::string& mapName, const std::string& modName, ILoadSaveHa
 	, lastSimFrameTime(spring_gettime())
 	, lastDrawFrameTime(spring_gettime())
 	, lastFrameTime(spring_gettime())
+	, lastTraceDumpTime(spring_notime)
 	, lastReceivedNetPacketTime(spring_gettime())
 	, lastSimFrameNetPacketTime(spring_gettime())
 	, updateDeltaSeconds(0.0f)
 	, totalGameTime(0)
+	, autoSaveInterval(0)
+	, autoSaveThread(NULL)
 	, hideInterface(false)
 	, noSpectatorChat(false)
 	, skipping(false)
+	, catchingUp(false)
+	, catchUpThreshold(0)
 	, playing(false)
 	, chatting(false)
 	, msgProcTimeLeft(0.0f)
 	, consumeSpeed(1.0f)
 	, lastframe(spring_gettime())
+	, netFrameBufferTarget(0)
+	, netFrameBufferDepth(0)
+	, netFrameBufferAvgDepth(0.0f)
 	, skipStartFrame(0)
 	, skipEndFrame(0)
 	, skipTotalFrames(0)
@@ -373,6 +407,15 @@ CGame::CGame(const std::string& mapName, const std::string& modName, ILoadSaveHa
 	showClock = configHandler->GetBool("ShowClock");
 	showSpeed = configHandler->GetBool("ShowSpeed");
 	showMTInfo = configHandler->GetBool("ShowMTInfo");
+	traceSpikeThreshold = configHandler->GetFloat("ProfileTraceSpikeThreshold");
+	autoSaveInterval = configHandler->GetInt("AutoSaveInterval");
+	netFrameBufferTarget = configHandler->GetInt("NetFrameJitterBuffer");
+	catchUpThreshold = configHandler->GetInt("RejoinCatchUpThreshold");
+
+	if (autoSaveInterval > 0 && !configHandler->GetBool("UseCREGSaveLoad")) {
+		LOG_L(L_WARNING, "[%s] AutoSaveInterval requires UseCREGSaveLoad, autosaving disabled", __FUNCTION__);
+		autoSaveInterval = 0;
+	}
 	GML::EnableCallChainWarnings(!!showMTInfo);
 	mtInfoThreshold = configHandler->GetFloat("MTInfoThreshold");
 	mtInfoCtrl = 0;
@@ -413,6 +456,12 @@ CGame::~CGame()
 
 	ENTER_SYNCED_CODE();
 
+	if (autoSaveThread != NULL) {
+		autoSaveThread->join();
+		delete autoSaveThread;
+		autoSaveThread = NULL;
+	}
+
 	CEndGameBox::Destroy();
 	CLoadScreen::DeleteInstance(); // make sure to halt loading, otherwise crash :)
 	CColorMap::DeleteColormaps();
@@ -478,6 +527,7 @@ CGame::~CGame()
 	SafeDelete(ground);
 	SafeDelete(smoothGround);
 	SafeDelete(groundBlockingObjectMap);
+	SafeDelete(threatMap);
 	SafeDelete(radarHandler);
 	SafeDelete(losHandler);
 	SafeDelete(mapDamage);
@@ -511,15 +561,56 @@ CGame::~CGame()
 }
 
 
+/**
+ * Runs a load step concurrently with the ones that follow it; the step
+ * must not touch anything those use (no Lua, no GL, no loadscreen) and
+ * is waited for by Join, at the latest when going out of scope.
+ */
+class CBackgroundLoadStep
+{
+public:
+	CBackgroundLoadStep(): thread(NULL) {}
+	~CBackgroundLoadStep() { Join(); }
+
+	void Start(void (*func)()) {
+		assert(thread == NULL);
+		thread = new boost::thread(func);
+	}
+	void Join() {
+		if (thread == NULL)
+			return;
+
+		thread->join();
+		delete thread;
+		thread = NULL;
+	}
+
+private:
+	boost::thread* thread;
+};
+
+static void CreateSmoothGround()
+{
+	Threading::SetThreadName("smoothmesh");
+	smoothGround = new SmoothHeightMesh(ground, float3::maxxpos, float3::maxzpos, SQUARE_SIZE * 2, SQUARE_SIZE * 40);
+}
+
 void CGame::LoadGame(const std::string& mapName)
 {
 	GML::ThreadNumber(GML_LOAD_THREAD_NUM);
 	Threading::SetThreadName("loading");
 
 	Watchdog::RegisterThread(WDT_LOAD);
+
+	// the smooth mesh only depends on the heightmap, so it is built
+	// while the (Lua-bound, single-threaded) defs are being parsed
+	CBackgroundLoadStep smoothGroundStep;
+
 	if (!gu->globalQuit) LoadMap(mapName);
+	if (!gu->globalQuit) smoothGroundStep.Start(CreateSmoothGround);
 	if (!gu->globalQuit) LoadDefs();
 	if (!gu->globalQuit) PreLoadSimulation();
+	smoothGroundStep.Join();
 	if (!gu->globalQuit) PreLoadRendering();
 	if (!gu->globalQuit) PostLoadSimulation();
 	if (!gu->globalQuit) PostLoadRendering();
@@ -562,6 +653,28 @@ void CGame::LoadMap(const std::string& mapName)
 }
 
 
+static std::string GetDefsCacheFileName()
+{
+	// anything that can change what defs.lua returns
+	CRC crc;
+	crc << archiveScanner->GetArchiveCompleteChecksum(archiveScanner->ArchiveFromName(gameSetup->modName));
+	crc << archiveScanner->GetArchiveCompleteChecksum(archiveScanner->ArchiveFromName(gameSetup->mapName));
+	crc.Update(SpringVersion::GetSync().data(), SpringVersion::GetSync().size());
+
+	const std::map<std::string, std::string>* options[2] = {&gameSetup->GetModOptionsCont(), &gameSetup->GetMapOptionsCont()};
+
+	for (int n = 0; n < 2; n++) {
+		for (std::map<std::string, std::string>::const_iterator it = options[n]->begin(); it != options[n]->end(); ++it) {
+			crc.Update(it->first.data(), it->first.size());
+			crc.Update(it->second.data(), it->second.size());
+		}
+		crc << n;
+	}
+
+	return (FileSystem::GetCacheDir() + "/defs/" + IntToString(crc.GetDigest(), "%08x") + ".luacache");
+}
+
+
 void CGame::LoadDefs()
 {
 	ENTER_SYNCED_CODE();
@@ -582,10 +695,17 @@ void CGame::LoadDefs()
 		defsParser->AddFunc("GetMapOptions", LuaSyncedRead::GetMapOptions);
 		defsParser->EndTable();
 
+		const bool useCache = configHandler->GetBool("DefsCache");
+		const std::string cacheFile = useCache? GetDefsCacheFileName(): "";
+		const bool cacheHit = useCache && defsParser->LoadCache(dataDirsAccess.LocateFile(cacheFile));
+
 		// run the parser
-		if (!defsParser->Execute()) {
+		if (!cacheHit && !defsParser->Execute()) {
 			throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
 		}
+		if (useCache) {
+			LOG("[Game::%s] defs cache %s (%s)", __FUNCTION__, cacheHit? "hit": "miss", cacheFile.c_str());
+		}
 		const LuaTable root = defsParser->GetRoot();
 		if (!root.IsValid()) {
 			throw content_error("Error loading gamedata definitions");
@@ -607,6 +727,10 @@ void CGame::LoadDefs()
 		if (!root.SubTable("MoveDefs").IsValid()) {
 			throw content_error("Error loading MoveDefs");
 		}
+
+		if (useCache && !cacheHit && FileSystem::CreateDirectory(FileSystem::GetCacheDir() + "/defs/")) {
+			defsParser->SaveCache(dataDirsAccess.LocateFile(cacheFile, FileQueryFlags::WRITE));
+		}
 	}
 
 	{
@@ -624,8 +748,10 @@ void CGame::PreLoadSimulation()
 {
 	ENTER_SYNCED_CODE();
 
-	loadscreen->SetLoadMessage("Creating Smooth Height Mesh");
-	smoothGround = new SmoothHeightMesh(ground, float3::maxxpos, float3::maxzpos, SQUARE_SIZE * 2, SQUARE_SIZE * 40);
+	// smoothGround is created concurrently with LoadDefs, see LoadGame
+
+	// runs in the background until Lua or an AI first asks for the spots
+	resourceHandler->GetResourceMapAnalyzer(resourceHandler->GetMetalId());
 
 	loadscreen->SetLoadMessage("Creating QuadField & CEGs");
 	moveDefHandler = new MoveDefHandler(defsParser);
@@ -634,6 +760,28 @@ void CGame::PreLoadSimulation()
 	explGenHandler = new CExplosionGeneratorHandler();
 }
 
+static void PreloadDefModels()
+{
+	std::vector<std::string> modelNames;
+
+	for (unsigned int n = 0; n < unitDefHandler->unitDefs.size(); n++) {
+		if (unitDefHandler->unitDefs[n] != NULL) {
+			modelNames.push_back(unitDefHandler->unitDefs[n]->modelName);
+		}
+	}
+	for (unsigned int n = 0; n < weaponDefHandler->weaponDefs.size(); n++) {
+		modelNames.push_back(weaponDefHandler->weaponDefs[n].visuals.modelName);
+	}
+
+	const std::map<std::string, const FeatureDef*>& featureDefs = featureHandler->GetFeatureDefs();
+
+	for (std::map<std::string, const FeatureDef*>::const_iterator it = featureDefs.begin(); it != featureDefs.end(); ++it) {
+		modelNames.push_back(it->second->modelName);
+	}
+
+	modelParser->PreloadModels(modelNames);
+}
+
 void CGame::PostLoadSimulation()
 {
 	loadscreen->SetLoadMessage("Loading Weapon Definitions");
@@ -649,8 +797,15 @@ void CGame::PostLoadSimulation()
 	loadscreen->SetLoadMessage("Loading Feature Definitions");
 	featureHandler = new CFeatureHandler(defsParser);
 
+	if (configHandler->GetBool("PreloadModels")) {
+		ScopedOnceTimer timer("Game::PostLoadSimulation (Models)");
+		loadscreen->SetLoadMessage("Loading Models");
+		PreloadDefModels();
+	}
+
 	losHandler = new CLosHandler();
 	radarHandler = new CRadarHandler(false);
+	threatMap = new CThreatMap();
 
 	mapDamage = IMapDamage::GetMapDamage();
 	pathManager = IPathManager::GetInstance(modInfo.pathFinderSystem);
@@ -676,6 +831,12 @@ void CGame::PostLoadSimulation()
 
 void CGame::PreLoadRendering()
 {
+	// decompress model and texture files concurrently ahead of their
+	// (serial) parsing; whatever remains unread is dropped in LoadFinalize
+	loadscreen->SetLoadMessage("Prefetching Models & Textures");
+	vfsHandler->PrefetchDir("objects3d/");
+	vfsHandler->PrefetchDir("unittextures/");
+
 	//! these need to be loaded before featureHandler
 	//! (maps with features have their models loaded at startup)
 	modelParser = new C3DModelLoader();
@@ -809,6 +970,7 @@ void CGame::LoadFinalize()
 	pathManager->UpdateFull(); // mapfeatures are not in written pathcaches, so we need to repath those & other stuff done by Lua
 
 	loadscreen->SetLoadMessage("Finalizing");
+	vfsHandler->DropPrefetchedFiles();
 
 	if (CBenchmark::enabled) {
 		static CBenchmark benchmark;
@@ -1085,6 +1247,7 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 		worldDrawer->Update();
 		CNamedTextures::Update();
 		modelParser->Update();
+		texturehandlerS3O->Update();
 
 		if (newSimFrame) {
 			projectileDrawer->UpdateTextures();
@@ -1570,7 +1733,7 @@ void CGame::SimFrame() {
 	tracefile << "New frame:" << gs->frameNum << " " << gs->GetRandSeed() << "\n";
 #endif
 
-	if (!skipping) {
+	if (!skipping && !catchingUp) {
 		// everything here is unsynced and should ideally moved to Game::Update()
 		infoConsole->Update();
 		waitCommandsAI.Update();
@@ -1589,28 +1752,64 @@ void CGame::SimFrame() {
 	// everything from here is simulation
 	{
 		SCOPED_TIMER("EventHandler::GameFrame");
+		SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_LUA);
 		eventHandler.GameFrame(gs->frameNum);
 	}
-	SCOPED_TIMER("SimFrame");
-	helper->Update();
-	mapDamage->Update();
-	pathManager->Update();
-	unitHandler->Update();
-	projectileHandler->Update();
-	featureHandler->Update();
-	GCobEngine.Tick(33);
-	GUnitScriptEngine.Tick(33);
-	wind.Update();
-	losHandler->Update();
-	interceptHandler.Update(false);
-
-	teamHandler->GameFrame(gs->frameNum);
-	playerHandler->GameFrame(gs->frameNum);
+	{
+		SCOPED_TIMER("SimFrame");
+		helper->Update();
+		mapDamage->Update();
+		smoothGround->Update();
+		{
+			SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_PATH);
+			pathManager->Update();
+		}
+		{
+			SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_UNITS);
+			unitHandler->Update();
+		}
+		{
+			SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_PROJECTILES);
+			projectileHandler->Update();
+		}
+		{
+			SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_FEATURES);
+			featureHandler->Update();
+		}
+		{
+			SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_UNITS);
+			GCobEngine.Tick(33);
+			GUnitScriptEngine.Tick(33);
+		}
+		wind.Update();
+		{
+			SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_LOS);
+			losHandler->Update();
+		}
+		interceptHandler.Update(false);
+
+		{
+			SCOPED_SYNC_SUBSYSTEM(SUBSYSTEM_TEAMS);
+			teamHandler->GameFrame(gs->frameNum);
+			playerHandler->GameFrame(gs->frameNum);
+		}
+
+		// hand back all frame_allocator temporaries of this frame
+		CFrameArena::ResetAll();
+	}
 
 	lastSimFrameTime = spring_gettime();
 	gu->avgSimFrameTime = mix(gu->avgSimFrameTime, (lastSimFrameTime - lastFrameTime).toMilliSecsf(), 0.05f);
 	gu->avgSimFrameTime = std::max(gu->avgSimFrameTime, 0.001f);
 
+	if (traceSpikeThreshold > 0.0f && (lastSimFrameTime - lastFrameTime).toMilliSecsf() > traceSpikeThreshold) {
+		// spikes tend to come in bursts, one trace per minute is plenty
+		if (lastTraceDumpTime <= spring_notime || (lastSimFrameTime - lastTraceDumpTime).toSecsi() >= 60) {
+			profiler.DumpTrace("SimFrameSpike-[" + IntToString(gs->frameNum) + "].json", 3000.0f);
+			lastTraceDumpTime = lastSimFrameTime;
+		}
+	}
+
 	#ifdef HEADLESS
 	{
 		const float msecMaxSimFrameTime = 1000.0f / (GAME_SPEED * gs->wantedSpeedFactor);
@@ -1627,6 +1826,10 @@ void CGame::SimFrame() {
 	// usefull for desync-debugging enter (enter instead of -1 start & end frame of the range you want to debug)
 	DumpState(-1, -1, 1);
 
+	if (autoSaveInterval > 0 && (gs->frameNum % (autoSaveInterval * GAME_SPEED)) == 0) {
+		AutoSaveGame();
+	}
+
 	LEAVE_SYNCED_CODE();
 }
 
@@ -2143,6 +2346,51 @@ void CGame::SaveGame(const std::string& filename, bool overwrite)
 }
 
 
+static void WriteAutoSave(const std::string& filePath, boost::shared_ptr<std::string> data)
+{
+	Threading::SetThreadName("autosave");
+
+	if (!CCregLoadSaveHandler::WriteSaveFile(filePath, *data)) {
+		LOG_L(L_ERROR, "[%s] unable to write autosave file \"%s\"", __FUNCTION__, filePath.c_str());
+	}
+}
+
+void CGame::AutoSaveGame()
+{
+	if (autoSaveThread != NULL) {
+		// the disk is slower than the interval, drop this snapshot
+		if (!autoSaveThread->timed_join(boost::posix_time::seconds(0))) {
+			LOG_L(L_WARNING, "[%s] previous autosave still being written, skipping frame %d", __FUNCTION__, gs->frameNum);
+			return;
+		}
+
+		delete autoSaveThread;
+		autoSaveThread = NULL;
+	}
+
+	if (!FileSystem::CreateDirectory("Saves"))
+		return;
+
+	// only taking the snapshot stalls the sim, writing the
+	// (possibly large) buffer to disk happens on another thread
+	boost::shared_ptr<std::string> data(new std::string());
+
+	{
+		SCOPED_TIMER("Game::AutoSave");
+
+		CCregLoadSaveHandler ls;
+		ls.mapName = gameSetup->mapName;
+		ls.modName = gameSetup->modName;
+
+		if (!ls.SaveGameToBuffer(*data))
+			return;
+	}
+
+	const std::string filePath = dataDirsAccess.LocateFile("Saves/AutoSave.ssf", FileQueryFlags::WRITE);
+	autoSaveThread = new boost::thread(boost::bind(&WriteAutoSave, filePath, data));
+}
+
+
 void CGame::ReloadGame()
 {
 	if (saveFile) {
@@ -24,6 +24,9 @@ class IUnsyncedActionExecutor;
 class ChatMessage;
 class SkirmishAIData;
 class CWorldDrawer;
+namespace boost {
+	class thread;
+}
 
 
 class CGame : public CGameController
@@ -97,6 +100,8 @@ public:
 
 	void ReloadGame();
 	void SaveGame(const std::string& filename, bool overwrite);
+	/// snapshots the game state and writes it to Saves/AutoSave.ssf in the background
+	void AutoSaveGame();
 
 	void ResizeEvent();
 	void SetupRenderingParams();
@@ -132,6 +137,7 @@ private:
 	void SendClientProcUsage();
 	void ClientReadNet();
 	void UpdateConsumeSpeed();
+	int CountQueuedNetFrames(int maxCount) const;
 	void SimFrame();
 	void StartPlaying();
 	bool Update();
@@ -153,6 +159,7 @@ public:
 	spring_time lastSimFrameTime;
 	spring_time lastDrawFrameTime;
 	spring_time lastFrameTime;
+	spring_time lastTraceDumpTime;
 	spring_time lastReceivedNetPacketTime;
 	spring_time lastSimFrameNetPacketTime;
 
@@ -173,6 +180,12 @@ public:
 	int showMTInfo;
 	float mtInfoThreshold;
 	int mtInfoCtrl;
+	/// sim-frames slower than this (in ms) trigger an automatic trace dump, 0 disables
+	float traceSpikeThreshold;
+	/// seconds of game time between two autosave snapshots, 0 disables
+	int autoSaveInterval;
+	/// writes the last autosave snapshot to disk
+	boost::thread* autoSaveThread;
 
 	/// Prevents spectator msgs from being seen by players
 	bool noSpectatorChat;
@@ -183,6 +196,10 @@ public:
 	float inputTextSizeX;
 	float inputTextSizeY;
 	bool skipping;
+	/// replaying a large backlog of frames (rejoin), unsynced per-frame work is skipped
+	bool catchingUp;
+	/// backlog (in seconds of game time) that makes a client enter catch-up, 0 disables
+	int catchUpThreshold;
 	bool playing;
 	bool chatting;
 	std::string userInputPrefix;
@@ -195,6 +212,10 @@ public:
 	float consumeSpeed;    ///< How fast we should eat NETMSG_NEWFRAMEs.
 	spring_time lastframe; ///< time of previous ClientReadNet() call.
 
+	int netFrameBufferTarget;     ///< NETMSG_NEWFRAMEs to keep queued against jitter, 0 disables
+	int netFrameBufferDepth;      ///< NETMSG_NEWFRAMEs queued at the last ClientReadNet() call
+	float netFrameBufferAvgDepth; ///< smoothed netFrameBufferDepth
+
 	int skipStartFrame;
 	int skipEndFrame;
 	int skipTotalFrames;
@@ -40,6 +40,7 @@
 #include "System/myMath.h"
 #include "System/Sound/SoundChannels.h"
 #include "System/Sync/SyncTracer.h"
+#include "System/ThreadPool.h"
 
 #define NUM_WAITING_DAMAGE_LISTS 128
 #define PLAY_SOUNDS 1
@@ -51,7 +52,7 @@
 CGameHelper* helper;
 
 
-CGameHelper::CGameHelper()
+CGameHelper::CGameHelper(): batchExplosions(false)
 {
 	stdExplosionGenerator = new CStdExplosionGenerator();
 	waitingDamageLists.resize(NUM_WAITING_DAMAGE_LISTS);
@@ -226,6 +227,45 @@ void CGameHelper::DamageObjectsInExplosionRadius(
 	cache.Reset(oldNumUnits, oldNumFeatures);
 }
 
+void CGameHelper::FlushExplosionBatch()
+{
+	// explosions triggered while flushing (by units or
+	// features dying) are applied immediately, as usual
+	batchExplosions = false;
+
+	if (queuedExplosions.empty())
+		return;
+
+	if (explosionCandidates.size() < queuedExplosions.size())
+		explosionCandidates.resize(queuedExplosions.size());
+
+	// read-only; objects killed by an earlier queued explosion
+	// are still gathered, but CUnit::DoDamage ignores them and
+	// they are not deleted before this function returns
+	for_mt(0, queuedExplosions.size(), [&](const int i) {
+		streflop::streflop_init<streflop::Simple>();
+
+		const QueuedExplosion& qe = queuedExplosions[i];
+		ExplosionCandidates& ec = explosionCandidates[i];
+
+		quadField->GetUnitsAndFeaturesColVolMT(qe.pos, qe.radius, ec.quads, ec.units, ec.features);
+	});
+
+	for (unsigned int i = 0; i < queuedExplosions.size(); i++) {
+		const QueuedExplosion& qe = queuedExplosions[i];
+		const ExplosionCandidates& ec = explosionCandidates[i];
+
+		for (unsigned int n = 0; n < ec.units.size(); n++) {
+			DoExplosionDamage(ec.units[n], qe.owner, qe.pos, qe.radius, qe.speed, qe.edgeEffect, qe.ignoreOwner, qe.damages, qe.weaponDefID, qe.projectileID);
+		}
+		for (unsigned int n = 0; n < ec.features.size(); n++) {
+			DoExplosionDamage(ec.features[n], qe.pos, qe.radius, qe.edgeEffect, qe.damages, qe.weaponDefID, qe.projectileID);
+		}
+	}
+
+	queuedExplosions.clear();
+}
+
 void CGameHelper::Explosion(const ExplosionParams& params) {
 	const float3 expDir = params.dir;
 	const float3 expPos = params.pos;
@@ -282,7 +322,22 @@ void CGameHelper::Explosion(const ExplosionParams& params) {
 			);
 		}
 	} else {
-		DamageObjectsInExplosionRadius(params, expPos, damageAOE, weaponDefID);
+		if (batchExplosions) {
+			QueuedExplosion qe;
+			qe.pos = expPos;
+			qe.radius = damageAOE;
+			qe.speed = params.explosionSpeed;
+			qe.edgeEffect = params.edgeEffectiveness;
+			qe.damages = damages;
+			qe.owner = params.owner;
+			qe.weaponDefID = weaponDefID;
+			qe.projectileID = params.projectileID;
+			qe.ignoreOwner = params.ignoreOwner;
+
+			queuedExplosions.push_back(qe);
+		} else {
+			DamageObjectsInExplosionRadius(params, expPos, damageAOE, weaponDefID);
+		}
 
 		// deform the map if the explosion was above-ground
 		// (but had large enough radius to touch the ground)
@@ -369,8 +424,8 @@ static inline void QueryUnits(TFilter filter, TQuery& query)
 			if (!filter.Team(t)) {
 				continue;
 			}
-			std::list<CUnit*>::const_iterator ui;
-			const std::list<CUnit*>& allyTeamUnits = quad.teamUnits[t];
+			std::vector<CUnit*>::const_iterator ui;
+			const std::vector<CUnit*>& allyTeamUnits = quad.teamUnits[t];
 			for (ui = allyTeamUnits.begin(); ui != allyTeamUnits.end(); ++ui) {
 				if ((*ui)->tempNum != tempNum) {
 					(*ui)->tempNum = tempNum;
@@ -638,7 +693,7 @@ namespace {
 static int tempTargetUnits[MAX_UNITS] = {0};
 static int targetTempNum = 2;
 
-void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, std::multimap<float, CUnit*>& targets)
+void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, WeaponTargetVec& targets)
 {
 	const CUnit* attacker = weapon->owner;
 	const float radius    = weapon->range;
@@ -656,21 +711,38 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* last
 
 	const int tempNum = targetTempNum++;
 
+	// the allyteams whose units can be targeted are the same for every quad
+	int enemyAllyTeams[MAX_TEAMS];
+	int numEnemyAllyTeams = 0;
+
+	for (int t = 0; t < teamHandler->ActiveAllyTeams(); ++t) {
+		if (!teamHandler->Ally(attacker->allyteam, t)) {
+			enemyAllyTeams[numEnemyAllyTeams++] = t;
+		}
+	}
+
 	typedef std::vector<int>::const_iterator VectorIt;
-	typedef std::list<CUnit*>::const_iterator ListIt;
+	typedef std::vector<CUnit*>::const_iterator ListIt;
 
 	for (VectorIt qi = quads.begin(); qi != quads.end(); ++qi) {
-		for (int t = 0; t < teamHandler->ActiveAllyTeams(); ++t) {
-			if (teamHandler->Ally(attacker->allyteam, t)) {
-				continue;
-			}
+		const CQuadField::Quad& quad = quadField->GetQuad(*qi);
 
-			const std::list<CUnit*>& allyTeamUnits = quadField->GetQuad(*qi).teamUnits[t];
+		for (int n = 0; n < numEnemyAllyTeams; ++n) {
+			const std::vector<CUnit*>& allyTeamUnits = quad.teamUnits[enemyAllyTeams[n]];
 
 			for (ListIt ui = allyTeamUnits.begin(); ui != allyTeamUnits.end(); ++ui) {
 				CUnit* targetUnit = *ui;
 				float targetPriority = 1.0f;
 
+				// units spanning several quads are only evaluated once; all
+				// checks below depend on the unit alone, so doing this first
+				// does not change which ones are rejected
+				if (tempTargetUnits[targetUnit->id] == tempNum) {
+					continue;
+				}
+
+				tempTargetUnits[targetUnit->id] = tempNum;
+
 				if (!(targetUnit->category & weapon->onlyTargetCategory)) {
 					continue;
 				}
@@ -681,11 +753,6 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* last
 					if (targetUnit->pos.y < ground->GetHeightReal(targetUnit->pos.x, targetUnit->pos.z))
 						continue;
 				}
-				if (tempTargetUnits[targetUnit->id] == tempNum) {
-					continue;
-				}
-
-				tempTargetUnits[targetUnit->id] = tempNum;
 
 				if (targetUnit->IsUnderWater() && !weaponDef->waterweapon) {
 					continue;
@@ -753,7 +820,7 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* last
 					}
 				}
 
-				targets.insert(std::pair<float, CUnit*>(targetPriority, targetUnit));
+				targets.push_back(WeaponTarget(targetPriority, targets.size(), targetUnit));
 			}
 		}
 	}
@@ -762,8 +829,8 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* last
 	{
 		tracefile << "[GenerateWeaponTargets] attackerID, attackRadius: " << attacker->id << ", " << radius << " ";
 
-		for (std::multimap<float, CUnit*>::const_iterator ti = targets.begin(); ti != targets.end(); ++ti)
-			tracefile << "\tpriority: " << (ti->first) <<  ", targetID: " << (ti->second)->id <<  " ";
+		for (WeaponTargetVec::const_iterator ti = targets.begin(); ti != targets.end(); ++ti)
+			tracefile << "\tpriority: " << (ti->priority) <<  ", targetID: " << (ti->unit)->id <<  " ";
 
 		tracefile << "\n";
 	}
@@ -1271,8 +1338,8 @@ Command CGameHelper::GetBuildCommand(const float3& pos, const float3& dir) {
 
 	CCommandQueue::iterator ci;
 
-	const std::list<CUnit*>& units = unitHandler->activeUnits;
-	      std::list<CUnit*>::const_iterator ui;
+	const std::vector<CUnit*>& units = unitHandler->activeUnits;
+	      std::vector<CUnit*>::const_iterator ui;
 
 	for (ui = units.begin(); ui != units.end(); ++ui) {
 		const CUnit* unit = *ui;
@@ -8,6 +8,7 @@
 #include "Sim/Units/CommandAI/Command.h"
 #include "System/float3.h"
 #include "System/type2.h"
+#include "System/FrameArena.h"
 #include "System/MemPool.h"
 
 #include <list>
@@ -41,6 +42,23 @@ public:
 	};
 
 
+	struct WeaponTarget {
+		WeaponTarget(float p, unsigned int i, CUnit* u): priority(p), index(i), unit(u) {}
+
+		// lower priority is better; ties resolve in generation order
+		// (same ordering as the std::multimap this used to live in)
+		bool operator > (const WeaponTarget& t) const {
+			return ((priority > t.priority) || (priority == t.priority && index > t.index));
+		}
+
+		float priority;
+		unsigned int index;
+		CUnit* unit;
+	};
+
+	// rebuilt for every AutoTarget call, lives in the frame arena
+	typedef std::vector<WeaponTarget, frame_allocator<WeaponTarget> > WeaponTargetVec;
+
 	struct ExplosionParams {
 		const float3& pos;
 		const float3& dir;
@@ -117,7 +135,8 @@ public:
 	 */
 	static float3 ClosestBuildSite(int team, const UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0);
 
-	static void GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, std::multimap<float, CUnit*>& targets);
+	/// fills <targets> in generation order, callers sort or heapify it
+	static void GenerateWeaponTargets(const CWeapon* weapon, const CUnit* lastTargetUnit, WeaponTargetVec& targets);
 
 	void Update();
 
@@ -146,6 +165,11 @@ public:
 	void DamageObjectsInExplosionRadius(const ExplosionParams& params, const float3& expPos, const float expRad, const int weaponDefID);
 	void Explosion(const ExplosionParams& params);
 
+	/// while batching, the area-damage of Explosion() is queued instead of applied
+	void BeginExplosionBatch() { batchExplosions = true; }
+	/// gathers the objects of all queued explosions and damages them in queue order
+	void FlushExplosionBatch();
+
 private:
 	CStdExplosionGenerator* stdExplosionGenerator;
 
@@ -212,7 +236,34 @@ private:
 		unsigned int numFeatures;
 	};
 
+	struct QueuedExplosion {
+		float3 pos;
+		float radius;
+		float speed;
+		float edgeEffect;
+
+		DamageArray damages;
+		CUnit* owner;
+
+		int weaponDefID;
+		int projectileID;
+
+		bool ignoreOwner;
+	};
+
+	struct ExplosionCandidates {
+		std::vector<int> quads;
+		std::vector<CUnit*> units;
+		std::vector<CFeature*> features;
+	};
+
 	std::vector< std::list<WaitingDamage*> > waitingDamageLists;
+
+	std::vector<QueuedExplosion> queuedExplosions;
+	// one per queued explosion, kept around to reuse their capacity
+	std::vector<ExplosionCandidates> explosionCandidates;
+
+	bool batchExplosions;
 };
 
 extern CGameHelper* helper;
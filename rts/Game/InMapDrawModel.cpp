@@ -145,6 +145,7 @@ bool CInMapDrawModel::AddPoint(const float3& constPos, const std::string& label,
 	const int quad = int(pos.z * QUAD_SCALE) * drawQuadsX +
 	                 int(pos.x * QUAD_SCALE);
 	drawQuads[quad].points.push_back(point);
+	drawQuads[quad].revision++;
 
 	numPoints++;
 
@@ -178,6 +179,7 @@ bool CInMapDrawModel::AddLine(const float3& constPos1, const float3& constPos2,
 	const int quad = int(pos1.z * QUAD_SCALE) * drawQuadsX +
 	                 int(pos1.x * QUAD_SCALE);
 	drawQuads[quad].lines.push_back(line);
+	drawQuads[quad].revision++;
 
 	numLines++;
 
@@ -219,6 +221,7 @@ void CInMapDrawModel::EraseNear(const float3& constPos, int playerID)
 				if (pi->GetPos().SqDistance2D(pos) < (radius*radius) && (pi->IsBySpectator() == sender->spectator)) {
 					pi = dq->points.erase(pi);
 					numPoints--;
+					dq->revision++;
 				} else {
 					++pi;
 				}
@@ -229,6 +232,7 @@ void CInMapDrawModel::EraseNear(const float3& constPos, int playerID)
 				if (li->GetPos1().SqDistance2D(pos) < (radius*radius) && (li->IsBySpectator() == sender->spectator)) {
 					li = dq->lines.erase(li);
 					numLines--;
+					dq->revision++;
 				} else {
 					++li;
 				}
@@ -243,6 +247,7 @@ void CInMapDrawModel::EraseAll()
 	for (size_t n = 0; n < drawQuads.size(); n++) {
 		drawQuads[n].points.clear();
 		drawQuads[n].lines.clear();
+		drawQuads[n].revision++;
 	}
 	numPoints = 0;
 	numLines = 0;
@@ -130,8 +130,13 @@ public:
 	 */
 	struct DrawQuad {
 		CR_DECLARE_STRUCT(DrawQuad);
+		DrawQuad(): revision(0) {}
+
 		std::list<CInMapDrawModel::MapPoint> points;
 		std::list<CInMapDrawModel::MapLine> lines;
+
+		/// bumped whenever points or lines change, lets the view cache per quad
+		unsigned int revision;
 	};
 
 	int GetDrawQuadX() const { return drawQuadsX; }
@@ -18,6 +18,8 @@
 #include "Sim/Units/UnitDef.h"
 #include "Net/Protocol/NetProtocol.h"
 
+#include <algorithm>
+
 const int CMDPARAM_MOVE_X = 0;
 const int CMDPARAM_MOVE_Y = 1;
 const int CMDPARAM_MOVE_Z = 2;
@@ -340,56 +342,44 @@ void CSelectedUnitsHandlerAI::MakeFrontMove(Command* c,int player)
 	if(numColumns==0)
 		numColumns=1;
 
-	std::multimap<float,int> orderedUnits;
-	CreateUnitOrder(orderedUnits,player);
+	std::vector< std::pair<float, int> > orderedUnits;
+	CreateUnitOrder(orderedUnits, player);
 
-	std::multimap<float, std::vector<int> > sortUnits;
+	// units of the current row, grouped by value (ascending)
+	std::vector< std::pair<float, std::vector<int> > > rowGroups;
 	std::vector<std::pair<int,Command> > frontcmds;
-	for (std::multimap<float,int>::iterator oi = orderedUnits.begin(); oi != orderedUnits.end();){
+	std::vector<int> rowUnits;
+	size_t numRowGroups = 0;
+
+	frontcmds.reserve(orderedUnits.size());
+	rowUnits.reserve(orderedUnits.size());
+
+	for (size_t n = 0; n < orderedUnits.size(); ) {
 		bool newline;
-		nextPos = MoveToPos(oi->second, nextPos, sd, c, &frontcmds, &newline);
+		nextPos = MoveToPos(orderedUnits[n].second, nextPos, sd, c, &frontcmds, &newline);
+
 		// mix units in each row to avoid weak flanks consisting solely of e.g. artillery units
-		std::multimap<float, std::vector<int> >::iterator si = sortUnits.find(oi->first);
-		if(si == sortUnits.end())
-			si = sortUnits.insert(std::pair<float, std::vector<int> >(oi->first, std::vector<int>()));
-		si->second.push_back(oi->second);
-		++oi;
-
-		if(oi != orderedUnits.end())
-			MoveToPos(oi->second, nextPos, sd, c, NULL, &newline);
-
-		if(oi == orderedUnits.end() || newline) {
-			std::vector<std::vector<int>*> sortUnitsVector;
-			for (std::multimap<float, std::vector<int> >::iterator ui = sortUnits.begin(); ui!=sortUnits.end(); ++ui) {
-				sortUnitsVector.push_back(&(*ui).second);
-			}
+		// (orderedUnits is sorted, so a new value can only follow the last group's)
+		if (numRowGroups == 0 || rowGroups[numRowGroups - 1].first != orderedUnits[n].first) {
+			if (numRowGroups == rowGroups.size())
+				rowGroups.push_back(std::pair<float, std::vector<int> >());
+
+			rowGroups[numRowGroups].first = orderedUnits[n].first;
+			rowGroups[numRowGroups].second.clear();
+			numRowGroups++;
+		}
+		rowGroups[numRowGroups - 1].second.push_back(orderedUnits[n].second);
+		++n;
 
-			std::vector<int> randunits;
-			int sz = sortUnitsVector.size();
-			std::vector<int> sortPos(sz, 0);
-			for (std::vector<std::pair<int,Command> >::iterator fi = frontcmds.begin(); fi != frontcmds.end(); ++fi) {
-				int bestpos = 0;
-				float bestval = 1.0f;
-				for (int i = 0; i < sz; ++i) {
-					const int n = sortUnitsVector[i]->size();
-					const int k = sortPos[i];
-					if (k < n) {
-						const float val = (0.5f + k) / (float)n;
-						if (val < bestval) {
-							bestval = val;
-							bestpos = i;
-						}
-					}
-				}
-				int pos = sortPos[bestpos];
-				randunits.push_back((*sortUnitsVector[bestpos])[pos]);
-				sortPos[bestpos] = pos + 1;
-			}
-			sortUnits.clear();
+		if (n != orderedUnits.size())
+			MoveToPos(orderedUnits[n].second, nextPos, sd, c, NULL, &newline);
 
-			int i = 0;
-			for (std::vector<std::pair<int,Command> >::iterator fi = frontcmds.begin(); fi != frontcmds.end(); ++fi) {
-				unitHandler->units[randunits[i++]]->commandAI->GiveCommand(fi->second, false);
+		if (n == orderedUnits.size() || newline) {
+			MixRowUnits(rowGroups, numRowGroups, frontcmds.size(), rowUnits);
+			numRowGroups = 0;
+
+			for (size_t i = 0; i < frontcmds.size(); ++i) {
+				unitHandler->units[rowUnits[i]]->commandAI->GiveCommand(frontcmds[i].second, false);
 			}
 			frontcmds.clear();
 		}
@@ -397,9 +387,66 @@ void CSelectedUnitsHandlerAI::MakeFrontMove(Command* c,int player)
 }
 
 
-void CSelectedUnitsHandlerAI::CreateUnitOrder(std::multimap<float,int>& out,int player)
+struct RowSlot {
+	// min-heap order; equal values go to the lowest group index first
+	bool operator<(const RowSlot& rs) const {
+		return ((val > rs.val) || (val == rs.val && group > rs.group));
+	}
+	float val;
+	int group;
+};
+
+void CSelectedUnitsHandlerAI::MixRowUnits(
+	const std::vector< std::pair<float, std::vector<int> > >& groups,
+	size_t numGroups,
+	size_t numUnits,
+	std::vector<int>& out
+) {
+	// repeatedly takes the next unit from the group that is
+	// proportionally the least used so far ((0.5 + k) / n);
+	// a heap keyed on that fraction makes this O(n log k)
+	// instead of scanning all k groups for each of n slots
+	std::vector<RowSlot> heap;
+	std::vector<size_t> groupPos(numGroups, 0);
+
+	heap.reserve(numGroups);
+	out.clear();
+
+	for (size_t i = 0; i < numGroups; ++i) {
+		const RowSlot rs = {0.5f / (float)groups[i].second.size(), int(i)};
+		heap.push_back(rs);
+	}
+	std::make_heap(heap.begin(), heap.end());
+
+	while (!heap.empty() && out.size() < numUnits) {
+		std::pop_heap(heap.begin(), heap.end());
+
+		RowSlot& rs = heap.back();
+		const std::vector<int>& units = groups[rs.group].second;
+		const size_t k = groupPos[rs.group]++;
+
+		out.push_back(units[k]);
+
+		if ((k + 1) < units.size()) {
+			rs.val = (0.5f + (k + 1)) / (float)units.size();
+			std::push_heap(heap.begin(), heap.end());
+		} else {
+			heap.pop_back();
+		}
+	}
+}
+
+
+static bool UnitOrderCmp(const std::pair<float, int>& a, const std::pair<float, int>& b)
+{
+	return (a.first < b.first);
+}
+
+void CSelectedUnitsHandlerAI::CreateUnitOrder(std::vector< std::pair<float, int> >& out, int player)
 {
 	const vector<int>& netUnits = selectedUnitsHandler.netSelected[player];
+	out.clear();
+	out.reserve(netUnits.size());
 	for (vector<int>::const_iterator ui = netUnits.begin(); ui != netUnits.end(); ++ui) {
 		const CUnit* unit = unitHandler->units[*ui];
 		if (unit) {
@@ -410,9 +457,12 @@ void CSelectedUnitsHandlerAI::CreateUnitOrder(std::multimap<float,int>& out,int
 				range = 2000;
 			}
 			const float value = ((ud->metal * 60) + ud->energy) / unit->unitDef->health * range;
-			out.insert(std::pair<float, int>(value, *ui));
+			out.push_back(std::pair<float, int>(value, *ui));
 		}
 	}
+
+	// stable, so units of equal value keep their selection order
+	std::stable_sort(out.begin(), out.end(), UnitOrderCmp);
 }
 
 
@@ -5,8 +5,8 @@
 
 #include "Sim/Units/CommandAI/Command.h"
 #include "System/float3.h"
-#include <map>
 #include <set>
+#include <vector>
 
 class CUnit;
 
@@ -33,7 +33,8 @@ public:
 private:
 	void CalculateGroupData(int player, bool queueing);
 	void MakeFrontMove(Command* c, int player);
-	void CreateUnitOrder(std::multimap<float, int>& out, int player);
+	void CreateUnitOrder(std::vector< std::pair<float, int> >& out, int player);
+	void MixRowUnits(const std::vector< std::pair<float, std::vector<int> > >& groups, size_t numGroups, size_t numUnits, std::vector<int>& out);
 	float3 MoveToPos(int unit, float3 nextCornerPos, float3 dir, Command* command, std::vector<std::pair<int, Command> >* frontcmds, bool* newline);
 	void AddUnitSetMaxSpeedCommand(CUnit* unit, unsigned char options);
 	void AddGroupSetMaxSpeedCommand(CUnit* unit, unsigned char options);
@@ -41,6 +41,7 @@
 #include <SDL_mouse.h>
 #include <SDL_keysym.h>
 #include <map>
+#include <boost/unordered_set.hpp>
 
 
 #define PLAY_SOUNDS 1
@@ -103,13 +104,31 @@ CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailab
 	int commandPage = 1000;
 	int foundGroup = -2;
 	int foundGroup2 = -2;
-	map<int, int> states;
+
+	// first occurrence (in selection order) of every command id, split
+	// into the set that is shown first and the rest; only pointers are
+	// gathered here so each description is copied once at the end
+	std::vector<const CommandDescription*> firstSet;
+	std::vector<const CommandDescription*> secondSet;
+	boost::unordered_set<int> addedIDs;
+
+	const bool multiSelect = (selectedUnits.size() > 1);
 
 	for (CUnitSet::const_iterator ui = selectedUnits.begin(); ui != selectedUnits.end(); ++ui) {
 		const std::vector<CommandDescription>* c = &((*ui)->commandAI->GetPossibleCommands());
 		std::vector<CommandDescription>::const_iterator ci;
 		for (ci = c->begin(); ci != c->end(); ++ci) {
-			states[ci->id] = ci->disabled ? 2 : 1;
+			if (ci->showUnique && multiSelect) {
+				continue;
+			}
+			if (!addedIDs.insert(ci->id).second) {
+				continue;
+			}
+			if ((ci->id < 0) == buildIconsFirst) {
+				firstSet.push_back(&(*ci));
+			} else {
+				secondSet.push_back(&(*ci));
+			}
 		}
 		if ((*ui)->commandAI->lastSelectedCommandPage < commandPage) {
 			commandPage = (*ui)->commandAI->lastSelectedCommandPage;
@@ -130,65 +149,17 @@ CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailab
 		}
 	}
 
-	std::vector<CommandDescription> groupCommands;
-
-	std::vector<CommandDescription> commands ;
-	// load the first set (separating build and non-build commands)
-	for (CUnitSet::const_iterator ui = selectedUnits.begin(); ui != selectedUnits.end(); ++ui) {
-		const std::vector<CommandDescription>* c = &((*ui)->commandAI->GetPossibleCommands());
-		std::vector<CommandDescription>::const_iterator ci;
-		for (ci = c->begin(); ci != c->end(); ++ci) {
-			if (buildIconsFirst) {
-				if (ci->id >= 0) { continue; }
-			} else {
-				if (ci->id < 0)  { continue; }
-			}
-			if (ci->showUnique && selectedUnits.size() > 1) {
-				continue;
-			}
-			if (states[ci->id] > 0) {
-				commands.push_back(*ci);
-				states[ci->id] = 0;
-			}
-		}
-	}
+	AvailableCommandsStruct ac;
+	ac.commandPage = commandPage;
+	ac.commands.reserve(firstSet.size() + secondSet.size());
 
-	if (!buildIconsFirst && !gs->noHelperAIs) {
-		std::vector<CommandDescription>::const_iterator ci;
-		for(ci = groupCommands.begin(); ci != groupCommands.end(); ++ci) {
-			commands.push_back(*ci);
-		}
+	for (size_t i = 0; i < firstSet.size(); i++) {
+		ac.commands.push_back(*firstSet[i]);
 	}
-
-	// load the second set (all those that have not already been included)
-	for (CUnitSet::const_iterator ui = selectedUnits.begin(); ui != selectedUnits.end(); ++ui) {
-		std::vector<CommandDescription>* c = &(*ui)->commandAI->GetPossibleCommands();
-		std::vector<CommandDescription>::const_iterator ci;
-		for (ci = c->begin(); ci != c->end(); ++ci) {
-			if (buildIconsFirst) {
-				if (ci->id < 0)  { continue; }
-			} else {
-				if (ci->id >= 0) { continue; }
-			}
-			if (ci->showUnique && selectedUnits.size() > 1) {
-				continue;
-			}
-			if (states[ci->id] > 0) {
-				commands.push_back(*ci);
-				states[ci->id] = 0;
-			}
-		}
-	}
-	if (buildIconsFirst && !gs->noHelperAIs) {
-		std::vector<CommandDescription>::const_iterator ci;
-		for (ci = groupCommands.begin(); ci != groupCommands.end(); ++ci) {
-			commands.push_back(*ci);
-		}
+	for (size_t i = 0; i < secondSet.size(); i++) {
+		ac.commands.push_back(*secondSet[i]);
 	}
 
-	AvailableCommandsStruct ac;
-	ac.commandPage = commandPage;
-	ac.commands = commands;
 	return ac;
 }
 
@@ -933,7 +904,7 @@ void CSelectedUnitsHandler::SendCommand(const Command& c)
 		selectionChanged = false;
 	}
 
-	net->Send(CBaseNetProtocol::Get().SendCommand(gu->myPlayerNum, c.GetID(), c.options, c.params));
+	net->Send(CBaseNetProtocol::Get().SendCommand(gu->myPlayerNum, c.GetID(), c.options, c.params.data(), c.params.size()));
 }
 
 
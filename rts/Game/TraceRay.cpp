@@ -10,6 +10,7 @@
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GeometricObjects.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/RadarHandler.h"
@@ -188,6 +189,9 @@ float TraceRay(
 
 		quadField->GetQuadsOnRay(start, dir, length, begQuad, endQuad);
 
+		// objects overlapping several quads on the ray are only tested once
+		const int tempNum = gs->tempNum++;
+
 		// locally point somewhere non-NULL; we cannot pass hitColQuery
 		// to DetectHit directly because each call resets it internally
 		if (hitColQuery == NULL)
@@ -198,9 +202,14 @@ float TraceRay(
 			for (int* quadPtr = begQuad; quadPtr != endQuad; ++quadPtr) {
 				const CQuadField::Quad& quad = quadField->GetQuad(*quadPtr);
 
-				for (std::list<CFeature*>::const_iterator ui = quad.features.begin(); ui != quad.features.end(); ++ui) {
+				for (std::vector<CFeature*>::const_iterator ui = quad.features.begin(); ui != quad.features.end(); ++ui) {
 					CFeature* f = *ui;
 
+					if (f->tempNum == tempNum)
+						continue;
+
+					f->tempNum = tempNum;
+
 					// NOTE:
 					//     if f is non-blocking, ProjectileHandler will not test
 					//     for collisions with projectiles so we can skip it here
@@ -226,11 +235,16 @@ float TraceRay(
 			for (int* quadPtr = begQuad; quadPtr != endQuad; ++quadPtr) {
 				const CQuadField::Quad& quad = quadField->GetQuad(*quadPtr);
 
-				for (std::list<CUnit*>::const_iterator ui = quad.units.begin(); ui != quad.units.end(); ++ui) {
+				for (std::vector<CUnit*>::const_iterator ui = quad.units.begin(); ui != quad.units.end(); ++ui) {
 					CUnit* u = *ui;
 
 					if (u == owner)
 						continue;
+					if (u->tempNum == tempNum)
+						continue;
+
+					u->tempNum = tempNum;
+
 					if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 						continue;
 					if (ignoreAllies && u->allyteam == owner->allyteam)
@@ -314,8 +328,8 @@ float GuiTraceRay(
 
 	quadField->GetQuadsOnRay(start, dir, length, begQuad, endQuad);
 
-	std::list<CUnit*>::const_iterator ui;
-	std::list<CFeature*>::const_iterator fi;
+	std::vector<CUnit*>::const_iterator ui;
+	std::vector<CFeature*>::const_iterator fi;
 
 	CollisionQuery cq;
 
@@ -439,8 +453,8 @@ bool TestCone(
 		const CQuadField::Quad& quad = quadField->GetQuad(*quadPtr);
 
 		if (!ignoreAllies) {
-			const std::list<CUnit*>& units = quad.teamUnits[allyteam];
-			      std::list<CUnit*>::const_iterator unitsIt;
+			const std::vector<CUnit*>& units = quad.teamUnits[allyteam];
+			      std::vector<CUnit*>::const_iterator unitsIt;
 
 			for (unitsIt = units.begin(); unitsIt != units.end(); ++unitsIt) {
 				const CUnit* u = *unitsIt;
@@ -456,8 +470,8 @@ bool TestCone(
 		}
 
 		if (!ignoreNeutrals) {
-			const std::list<CUnit*>& units = quad.units;
-			      std::list<CUnit*>::const_iterator unitsIt;
+			const std::vector<CUnit*>& units = quad.units;
+			      std::vector<CUnit*>::const_iterator unitsIt;
 
 			for (unitsIt = units.begin(); unitsIt != units.end(); ++unitsIt) {
 				const CUnit* u = *unitsIt;
@@ -475,8 +489,8 @@ bool TestCone(
 		}
 
 		if (!ignoreFeatures) {
-			const std::list<CFeature*>& features = quad.features;
-			      std::list<CFeature*>::const_iterator featuresIt;
+			const std::vector<CFeature*>& features = quad.features;
+			      std::vector<CFeature*>::const_iterator featuresIt;
 
 			for (featuresIt = features.begin(); featuresIt != features.end(); ++featuresIt) {
 				const CFeature* f = *featuresIt;
@@ -525,8 +539,8 @@ bool TestTrajectoryCone(
 
 		// friendly units in this quad
 		if (!ignoreAllies) {
-			const std::list<CUnit*>& units = quad.teamUnits[allyteam];
-			      std::list<CUnit*>::const_iterator unitsIt;
+			const std::vector<CUnit*>& units = quad.teamUnits[allyteam];
+			      std::vector<CUnit*>::const_iterator unitsIt;
 
 			for (unitsIt = units.begin(); unitsIt != units.end(); ++unitsIt) {
 				const CUnit* u = *unitsIt;
@@ -544,8 +558,8 @@ bool TestTrajectoryCone(
 
 		// neutral units in this quad
 		if (!ignoreNeutrals) {
-			const std::list<CUnit*>& units = quad.units;
-			      std::list<CUnit*>::const_iterator unitsIt;
+			const std::vector<CUnit*>& units = quad.units;
+			      std::vector<CUnit*>::const_iterator unitsIt;
 
 			for (unitsIt = units.begin(); unitsIt != units.end(); ++unitsIt) {
 				const CUnit* u = *unitsIt;
@@ -564,8 +578,8 @@ bool TestTrajectoryCone(
 
 		// features in this quad
 		if (!ignoreFeatures) {
-			const std::list<CFeature*>& features = quad.features;
-			      std::list<CFeature*>::const_iterator featuresIt;
+			const std::vector<CFeature*>& features = quad.features;
+			      std::vector<CFeature*>::const_iterator featuresIt;
 
 			for (featuresIt = features.begin(); featuresIt != features.end(); ++featuresIt) {
 				const CFeature* f = *featuresIt;
@@ -554,17 +554,18 @@ void CGuiHandler::LayoutIcons(bool useSelectionPage)
 	GML_RECMUTEX_LOCK(gui); // LayoutIcons
 
 	// get the commands to process
-	CSelectedUnitsHandler::AvailableCommandsStruct ac;
-	ac = selectedUnitsHandler.GetAvailableCommands();
+	CSelectedUnitsHandler::AvailableCommandsStruct ac = selectedUnitsHandler.GetAvailableCommands();
 	ConvertCommands(ac.commands);
 
-	std::vector<CommandDescription> hidden;
+	std::vector<const CommandDescription*> hidden;
 	std::vector<CommandDescription>::const_iterator cdi;
 
 	// separate the visible/hidden icons
+	commands.reserve(ac.commands.size() + 2);
+
 	for (cdi = ac.commands.begin(); cdi != ac.commands.end(); ++cdi){
 		if (cdi->hidden) {
-			hidden.push_back(*cdi);
+			hidden.push_back(&(*cdi));
 		} else {
 			commands.push_back(*cdi);
 		}
@@ -649,8 +650,8 @@ void CGuiHandler::LayoutIcons(bool useSelectionPage)
 	}
 
 	// append the hidden commands
-	for (cdi = hidden.begin(); cdi != hidden.end(); ++cdi) {
-		commands.push_back(*cdi);
+	for (size_t i = 0; i < hidden.size(); i++) {
+		commands.push_back(*hidden[i]);
 	}
 
 	// try to setup the old command state
@@ -671,9 +672,9 @@ bool CGuiHandler::LayoutCustomIcons(bool useSelectionPage)
 	}
 
 	// get the commands to process
-	CSelectedUnitsHandler::AvailableCommandsStruct ac;
-	ac = selectedUnitsHandler.GetAvailableCommands();
-	std::vector<CommandDescription> cmds = ac.commands;
+	CSelectedUnitsHandler::AvailableCommandsStruct ac = selectedUnitsHandler.GetAvailableCommands();
+	std::vector<CommandDescription> cmds;
+	cmds.swap(ac.commands);
 	if (!cmds.empty()) {
 		ConvertCommands(cmds);
 		AppendPrevAndNext(cmds);
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <fstream>
 #include <SDL_keysym.h>
 
@@ -15,6 +16,7 @@
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/UnitTypes/Building.h"
@@ -30,10 +32,6 @@ CSelectionKeyHandler::CSelectionKeyHandler()
 {
 }
 
-CSelectionKeyHandler::~CSelectionKeyHandler()
-{
-}
-
 std::string CSelectionKeyHandler::ReadToken(std::string& str)
 {
 	std::string ret;
@@ -91,6 +89,14 @@ namespace
 		 */
 		virtual bool ShouldIncludeUnit(const CUnit* unit) const = 0;
 
+		/**
+		 * Filters for which only the UnitDef matters return true here and
+		 * implement ShouldIncludeDef, so a selection can be gathered from
+		 * CUnitHandler::unitsByDefs instead of by testing every unit.
+		 */
+		virtual bool IsDefFilter() const { return false; }
+		virtual bool ShouldIncludeDef(const UnitDef* def) const { return true; }
+
 		/// Number of arguments this filter has.
 		const int numArgs;
 
@@ -113,17 +119,29 @@ namespace
 #define DECLARE_FILTER(name, condition) \
 	DECLARE_FILTER_EX(name, 0, condition, ,)
 
-	DECLARE_FILTER(Builder, unit->unitDef->buildSpeed > 0);
+#define DECLARE_DEF_FILTER_EX(name, args, condition, extra, init) \
+	struct name ## _Filter : public Filter { \
+		name ## _Filter() : Filter(#name, args) { init; } \
+		bool IsDefFilter() const { return true; } \
+		bool ShouldIncludeDef(const UnitDef* def) const { return condition; } \
+		bool ShouldIncludeUnit(const CUnit* unit) const { return ShouldIncludeDef(unit->unitDef); } \
+		extra \
+	} name ## _filter_instance; \
+
+#define DECLARE_DEF_FILTER(name, condition) \
+	DECLARE_DEF_FILTER_EX(name, 0, condition, ,)
+
+	DECLARE_DEF_FILTER(Builder, def->buildSpeed > 0);
 	DECLARE_FILTER(Building, dynamic_cast<const CBuilding*>(unit) != NULL);
-	DECLARE_FILTER(Transport, unit->unitDef->transportCapacity > 0);
-	DECLARE_FILTER(Aircraft, unit->unitDef->canfly);
+	DECLARE_DEF_FILTER(Transport, def->transportCapacity > 0);
+	DECLARE_DEF_FILTER(Aircraft, def->canfly);
 	DECLARE_FILTER(Weapons, !unit->weapons.empty());
 	DECLARE_FILTER(Idle, unit->commandAI->commandQue.empty());
 	DECLARE_FILTER(Waiting, !unit->commandAI->commandQue.empty() &&
 	               (unit->commandAI->commandQue.front().GetID() == CMD_WAIT));
 	DECLARE_FILTER(InHotkeyGroup, unit->group != NULL);
 	DECLARE_FILTER(Radar, unit->radarRadius || unit->sonarRadius || unit->jammerRadius);
-	DECLARE_FILTER(ManualFireUnit, unit->unitDef->canManualFire);
+	DECLARE_DEF_FILTER(ManualFireUnit, def->canManualFire);
 
 	DECLARE_FILTER_EX(WeaponRange, 1, unit->maxRange > minRange,
 		float minRange;
@@ -149,7 +167,7 @@ namespace
 		minHealth=0.0f;
 	);
 
-	DECLARE_FILTER_EX(InPrevSel, 0, prevTypes.find(unit->unitDef->id) != prevTypes.end(),
+	DECLARE_DEF_FILTER_EX(InPrevSel, 0, prevTypes.find(def->id) != prevTypes.end(),
 		std::set<int> prevTypes;
 		void Prepare() {
 			prevTypes.clear();
@@ -160,7 +178,7 @@ namespace
 		},
 	);
 
-	DECLARE_FILTER_EX(NameContain, 1, unit->unitDef->humanName.find(name) != std::string::npos,
+	DECLARE_DEF_FILTER_EX(NameContain, 1, def->humanName.find(name) != std::string::npos,
 		std::string name;
 		void SetParam(int index, const std::string& value) {
 			name = value;
@@ -203,6 +221,8 @@ namespace
 		wantedValue=0.0f;
 	);
 
+#undef DECLARE_DEF_FILTER_EX
+#undef DECLARE_DEF_FILTER
 #undef DECLARE_FILTER_EX
 #undef DECLARE_FILTER
 #undef STRTOF
@@ -210,92 +230,94 @@ namespace
 
 
 
-void CSelectionKeyHandler::DoSelection(std::string selectString)
+struct CSelectionKeyHandler::Query
 {
-	GML_RECMUTEX_LOCK(sel); // DoSelection
+	enum Source {
+		SOURCE_INVALID,
+		SOURCE_ALL_MAP,
+		SOURCE_VISIBLE,
+		SOURCE_FROM_MOUSE,
+		SOURCE_FROM_MOUSE_C,
+		SOURCE_PREV_SELECTION,
+	};
+	enum Conclusion {
+		CONCLUSION_NONE,
+		CONCLUSION_SELECT_ALL,
+		CONCLUSION_SELECT_ONE,
+		CONCLUSION_SELECT_NUM,
+		CONCLUSION_SELECT_PART,
+	};
 
-	std::list<CUnit*> selection;
+	struct Step {
+		Filter* filter;
+		bool negate;
+		std::vector<std::string> params;
+	};
 
-//	guicontroller->AddText(selectString.c_str());
-	std::string s=ReadToken(selectString);
+	Query()
+		: source(SOURCE_INVALID)
+		, sourceArg(0.0f)
+		, numDefSteps(0)
+		, clearSelection(false)
+		, conclusion(CONCLUSION_NONE)
+		, conclusionArg(0.0f)
+	{}
+
+	Source source;
+	float sourceArg;
+
+	std::vector<Step> steps;
+	/// number of leading steps that only test the UnitDef
+	unsigned int numDefSteps;
+
+	bool clearSelection;
+	Conclusion conclusion;
+	float conclusionArg;
+};
 
-	if(s=="AllMap"){
-		if (!gu->spectatingFullSelect) {
-			// team units
-			CUnitSet* tu=&teamHandler->Team(gu->myTeam)->units;
-			for(CUnitSet::iterator ui=tu->begin();ui!=tu->end();++ui){
-				selection.push_back(*ui);
-			}
-		} else {
-			// all units
-			std::list<CUnit*>* au=&unitHandler->activeUnits;
-			for (std::list<CUnit*>::iterator ui=au->begin();ui!=au->end();++ui){
-				selection.push_back(*ui);
-			}
-		}
-	} else if(s=="Visible"){
-		if (!gu->spectatingFullSelect) {
-			// team units in viewport
-			CUnitSet* tu=&teamHandler->Team(gu->myTeam)->units;
-			for (CUnitSet::iterator ui=tu->begin();ui!=tu->end();++ui){
-				if (camera->InView((*ui)->midPos,(*ui)->radius)){
-					selection.push_back(*ui);
-				}
-			}
-		} else {
-		  // all units in viewport
-			std::list<CUnit*>* au=&unitHandler->activeUnits;
-			for (std::list<CUnit*>::iterator ui=au->begin();ui!=au->end();++ui){
-				if (camera->InView((*ui)->midPos,(*ui)->radius)){
-					selection.push_back(*ui);
-				}
-			}
-		}
-	} else if(s=="FromMouse" || s=="FromMouseC"){
+
+CSelectionKeyHandler::~CSelectionKeyHandler()
+{
+	for (std::map<std::string, Query*>::iterator it = queries.begin(); it != queries.end(); ++it) {
+		delete it->second;
+	}
+}
+
+
+const CSelectionKeyHandler::Query& CSelectionKeyHandler::GetQuery(const std::string& selectString)
+{
+	std::map<std::string, Query*>::iterator it = queries.find(selectString);
+
+	if (it != queries.end())
+		return *(it->second);
+
+	Query* query = new Query();
+	CompileQuery(selectString, *query);
+
+	queries[selectString] = query;
+	return *query;
+}
+
+
+void CSelectionKeyHandler::CompileQuery(std::string selectString, Query& query)
+{
+	std::string s = ReadToken(selectString);
+
+	if (s == "AllMap") {
+		query.source = Query::SOURCE_ALL_MAP;
+	} else if (s == "Visible") {
+		query.source = Query::SOURCE_VISIBLE;
+	} else if (s == "FromMouse" || s == "FromMouseC") {
 		// FromMouse uses distance from a point on the ground,
 		// so essentially a selection sphere.
 		// FromMouseC uses a cylinder shaped volume for selection,
 		// so the heights of the units do not matter.
-		const bool cylindrical = (s == "FromMouseC");
-		ReadDelimiter(selectString);
-		float maxDist=atof(ReadToken(selectString).c_str());
-
-		float dist = ground->LineGroundCol(camera->GetPos(), camera->GetPos() + mouse->dir * 8000, false);
-		float3 mp=camera->GetPos()+mouse->dir*dist;
-		if (cylindrical) {
-			mp.y = 0;
-		}
+		query.source = (s == "FromMouseC")? Query::SOURCE_FROM_MOUSE_C: Query::SOURCE_FROM_MOUSE;
 
-		if (!gu->spectatingFullSelect) {
-		  // team units in mouse range
-			CUnitSet* tu=&teamHandler->Team(gu->myTeam)->units;
-			for(CUnitSet::iterator ui=tu->begin();ui!=tu->end();++ui){
-				float3 up = (*ui)->pos;
-				if (cylindrical) {
-					up.y = 0;
-				}
-				if(mp.SqDistance(up) < Square(maxDist)){
-					selection.push_back(*ui);
-				}
-			}
-		} else {
-		  // all units in mouse range
-			std::list<CUnit*>* au=&unitHandler->activeUnits;
-			for(std::list<CUnit*>::iterator ui=au->begin();ui!=au->end();++ui){
-				float3 up = (*ui)->pos;
-				if (cylindrical) {
-					up.y = 0;
-				}
-				if(mp.SqDistance(up)<Square(maxDist)){
-					selection.push_back(*ui);
-				}
-			}
-		}
-	} else if(s=="PrevSelection"){
-		CUnitSet* su=&selectedUnitsHandler.selectedUnits;
-		for(CUnitSet::iterator ui=su->begin();ui!=su->end();++ui){
-			selection.push_back(*ui);
-		}
+		ReadDelimiter(selectString);
+		query.sourceArg = atof(ReadToken(selectString).c_str());
+	} else if (s == "PrevSelection") {
+		query.source = Query::SOURCE_PREV_SELECTION;
 	} else {
 		LOG_L(L_WARNING, "Unknown source token %s", s.c_str());
 		return;
@@ -303,133 +325,284 @@ void CSelectionKeyHandler::DoSelection(std::string selectString)
 
 	ReadDelimiter(selectString);
 
-	while(true){
-		std::string s=ReadDelimiter(selectString);
-		if(s=="+")
+	bool onlyDefSteps = true;
+
+	while (true) {
+		s = ReadDelimiter(selectString);
+		if (s == "+")
 			break;
 
-		s=ReadToken(selectString);
+		s = ReadToken(selectString);
 
-		bool _not=false;
+		Query::Step step;
+		step.negate = false;
 
-		if(s=="Not"){
-			_not=true;
+		if (s == "Not") {
+			step.negate = true;
 			ReadDelimiter(selectString);
-			s=ReadToken(selectString);
+			s = ReadToken(selectString);
 		}
 
 		Filter::Map& filters = Filter::all();
 		Filter::Map::iterator f = filters.find(s);
 
-		if (f != filters.end()) {
-			f->second->Prepare();
-			for (int i = 0; i < f->second->numArgs; ++i) {
-				ReadDelimiter(selectString);
-				f->second->SetParam(i, ReadToken(selectString));
-			}
-			std::list<CUnit*>::iterator ui = selection.begin();
-			while (ui != selection.end()) {
-				if (f->second->ShouldIncludeUnit(*ui) ^ _not) {
-					++ui;
-				}
-				else {
-					std::list<CUnit*>::iterator prev = ui++;
-					selection.erase(prev);
-				}
-			}
-		}
-		else {
+		if (f == filters.end()) {
 			LOG_L(L_WARNING, "Unknown token in filter %s", s.c_str());
+			query.source = Query::SOURCE_INVALID;
 			return;
 		}
+
+		step.filter = f->second;
+
+		for (int i = 0; i < step.filter->numArgs; ++i) {
+			ReadDelimiter(selectString);
+			step.params.push_back(ReadToken(selectString));
+		}
+
+		onlyDefSteps = (onlyDefSteps && step.filter->IsDefFilter());
+		query.numDefSteps += onlyDefSteps;
+		query.steps.push_back(step);
 	}
 
 	ReadDelimiter(selectString);
-	s=ReadToken(selectString);
+	s = ReadToken(selectString);
 
-	if(s=="ClearSelection"){
-		selectedUnitsHandler.ClearSelected();
+	if (s == "ClearSelection") {
+		query.clearSelection = true;
 
 		ReadDelimiter(selectString);
-		s=ReadToken(selectString);
+		s = ReadToken(selectString);
 	}
 
-	if(s=="SelectAll"){
-		for (std::list<CUnit*>::iterator ui=selection.begin();ui!=selection.end();++ui)
-			selectedUnitsHandler.AddUnit(*ui);
-	} else if(s=="SelectOne"){
-		if(selection.empty())
-			return;
-		if(++selectNumber>=selection.size())
-			selectNumber=0;
+	if (s == "SelectAll") {
+		query.conclusion = Query::CONCLUSION_SELECT_ALL;
+	} else if (s == "SelectOne") {
+		query.conclusion = Query::CONCLUSION_SELECT_ONE;
+	} else if (s == "SelectNum") {
+		query.conclusion = Query::CONCLUSION_SELECT_NUM;
 
-		CUnit* sel = NULL;
-		int a=0;
-		for (std::list<CUnit*>::iterator ui=selection.begin();ui!=selection.end() && a<=selectNumber;++ui,++a)
-			sel=*ui;
+		ReadDelimiter(selectString);
+		query.conclusionArg = atoi(ReadToken(selectString).c_str());
+	} else if (s == "SelectPart") {
+		query.conclusion = Query::CONCLUSION_SELECT_PART;
 
-		if (sel == NULL)
-			return;
+		ReadDelimiter(selectString);
+		query.conclusionArg = atof(ReadToken(selectString).c_str()) * 0.01f; // convert from percent
+	} else {
+		LOG_L(L_WARNING, "Unknown token in conclusion %s", s.c_str());
+	}
+}
 
-		selectedUnitsHandler.AddUnit(sel);
-		camHandler->CameraTransition(0.8f);
-		if(camHandler->GetCurrentControllerNum() != 0){
-			camHandler->GetCurrentController().SetPos(sel->pos);
-		} else {	//fps camera
 
-			if(camera->rot.x>-1)
-				camera->rot.x=-1;
+static void ConfigureFilterStep(Filter* filter, const std::vector<std::string>& params)
+{
+	filter->Prepare();
 
-			float3 wantedCamDir;
-			wantedCamDir.x=(float)(math::sin(camera->rot.y)*math::cos(camera->rot.x));
-			wantedCamDir.y=(float)(math::sin(camera->rot.x));
-			wantedCamDir.z=(float)(math::cos(camera->rot.y)*math::cos(camera->rot.x));
-			wantedCamDir.ANormalize();
+	for (unsigned int i = 0; i < params.size(); ++i) {
+		filter->SetParam(i, params[i]);
+	}
+}
 
-			camHandler->GetCurrentController().SetPos(sel->pos - wantedCamDir*800);
-		}
-	} else if(s=="SelectNum"){
-		ReadDelimiter(selectString);
-		int num=atoi(ReadToken(selectString).c_str());
+static bool CompareUnitIDs(const CUnit* a, const CUnit* b) { return (a->id < b->id); }
 
-		if(selection.empty())
-			return;
 
-		if(selectNumber>=selection.size())
-			selectNumber=0;
+void CSelectionKeyHandler::DoSelection(std::string selectString)
+{
+	GML_RECMUTEX_LOCK(sel); // DoSelection
 
-		std::list<CUnit*>::iterator ui=selection.begin();
-		for (int a=0;a<selectNumber;++a)
-			++ui;
-		for (int a=0;a<num;++ui,++a){
-			if(ui==selection.end())
-				ui=selection.begin();
-			selectedUnitsHandler.AddUnit(*ui);
-		}
+	const Query& query = GetQuery(selectString);
 
-		selectNumber+=num;
-	} else if(s=="SelectPart"){
-		ReadDelimiter(selectString);
-		float part=atof(ReadToken(selectString).c_str())*0.01f;//convert from percent
-		int num=(int)(selection.size()*part);
+	if (query.source == Query::SOURCE_INVALID)
+		return;
 
-		if(selection.empty())
-			return;
+	std::vector<CUnit*> selection;
+	unsigned int firstStep = 0;
+
+	switch (query.source) {
+		case Query::SOURCE_ALL_MAP: {
+			if (query.numDefSteps > 0) {
+				// evaluate the leading UnitDef-only filters once per
+				// def and gather the matching units by type; sorting
+				// restores the order of the per-team unit sets
+				const std::vector<UnitDef*>& unitDefs = unitDefHandler->unitDefs;
+				std::vector<bool> defMask(unitDefs.size(), true);
+
+				for (; firstStep < query.numDefSteps; ++firstStep) {
+					const Query::Step& step = query.steps[firstStep];
+
+					ConfigureFilterStep(step.filter, step.params);
+
+					for (unsigned int d = 1; d < unitDefs.size(); ++d) {
+						defMask[d] = defMask[d] && (step.filter->ShouldIncludeDef(unitDefs[d]) ^ step.negate);
+					}
+				}
+
+				for (int t = 0; t < teamHandler->ActiveTeams(); ++t) {
+					if (!gu->spectatingFullSelect && t != gu->myTeam)
+						continue;
+
+					for (unsigned int d = 1; d < unitDefs.size(); ++d) {
+						if (!defMask[d])
+							continue;
+
+						const CUnitSet& units = unitHandler->unitsByDefs[t][d];
+						selection.insert(selection.end(), units.begin(), units.end());
+					}
+				}
+
+				std::sort(selection.begin(), selection.end(), CompareUnitIDs);
+			} else if (!gu->spectatingFullSelect) {
+				// team units
+				const CUnitSet& tu = teamHandler->Team(gu->myTeam)->units;
+				selection.assign(tu.begin(), tu.end());
+			} else {
+				// all units
+				const std::vector<CUnit*>& au = unitHandler->activeUnits;
+				selection.assign(au.begin(), au.end());
+			}
+		} break;
+
+		case Query::SOURCE_VISIBLE: {
+			if (!gu->spectatingFullSelect) {
+				// team units in viewport
+				const CUnitSet& tu = teamHandler->Team(gu->myTeam)->units;
+				for (CUnitSet::const_iterator ui = tu.begin(); ui != tu.end(); ++ui) {
+					if (camera->InView((*ui)->midPos, (*ui)->radius)) {
+						selection.push_back(*ui);
+					}
+				}
+			} else {
+				// all units in viewport
+				const std::vector<CUnit*>& au = unitHandler->activeUnits;
+				for (std::vector<CUnit*>::const_iterator ui = au.begin(); ui != au.end(); ++ui) {
+					if (camera->InView((*ui)->midPos, (*ui)->radius)) {
+						selection.push_back(*ui);
+					}
+				}
+			}
+		} break;
 
-		if(selectNumber>=selection.size())
-			selectNumber=0;
+		case Query::SOURCE_FROM_MOUSE:
+		case Query::SOURCE_FROM_MOUSE_C: {
+			const bool cylindrical = (query.source == Query::SOURCE_FROM_MOUSE_C);
+			const float maxDist = query.sourceArg;
 
-		std::list<CUnit*>::iterator ui = selection.begin();
-		for (int a = 0; a < selectNumber; ++a)
-			++ui;
-		for(int a=0;a<num;++ui,++a){
-			if(ui==selection.end())
-				ui=selection.begin();
-			selectedUnitsHandler.AddUnit(*ui);
+			float dist = ground->LineGroundCol(camera->GetPos(), camera->GetPos() + mouse->dir * 8000, false);
+			float3 mp = camera->GetPos() + mouse->dir * dist;
+			if (cylindrical) {
+				mp.y = 0;
+			}
+
+			if (!gu->spectatingFullSelect) {
+				// team units in mouse range
+				const CUnitSet& tu = teamHandler->Team(gu->myTeam)->units;
+				for (CUnitSet::const_iterator ui = tu.begin(); ui != tu.end(); ++ui) {
+					float3 up = (*ui)->pos;
+					if (cylindrical) {
+						up.y = 0;
+					}
+					if (mp.SqDistance(up) < Square(maxDist)) {
+						selection.push_back(*ui);
+					}
+				}
+			} else {
+				// all units in mouse range
+				const std::vector<CUnit*>& au = unitHandler->activeUnits;
+				for (std::vector<CUnit*>::const_iterator ui = au.begin(); ui != au.end(); ++ui) {
+					float3 up = (*ui)->pos;
+					if (cylindrical) {
+						up.y = 0;
+					}
+					if (mp.SqDistance(up) < Square(maxDist)) {
+						selection.push_back(*ui);
+					}
+				}
+			}
+		} break;
+
+		case Query::SOURCE_PREV_SELECTION: {
+			const CUnitSet& su = selectedUnitsHandler.selectedUnits;
+			selection.assign(su.begin(), su.end());
+		} break;
+
+		default: {
+		} break;
+	}
+
+	for (unsigned int n = firstStep; n < query.steps.size(); ++n) {
+		const Query::Step& step = query.steps[n];
+
+		ConfigureFilterStep(step.filter, step.params);
+
+		// stable in-place removal of the units that do not pass
+		unsigned int numKept = 0;
+
+		for (unsigned int i = 0; i < selection.size(); ++i) {
+			if (step.filter->ShouldIncludeUnit(selection[i]) ^ step.negate) {
+				selection[numKept++] = selection[i];
+			}
 		}
 
-		selectNumber+=num;
-	} else {
-		LOG_L(L_WARNING, "Unknown token in conclusion %s", s.c_str());
+		selection.resize(numKept);
+	}
+
+	if (query.clearSelection) {
+		selectedUnitsHandler.ClearSelected();
+	}
+
+	switch (query.conclusion) {
+		case Query::CONCLUSION_SELECT_ALL: {
+			for (unsigned int i = 0; i < selection.size(); ++i)
+				selectedUnitsHandler.AddUnit(selection[i]);
+		} break;
+
+		case Query::CONCLUSION_SELECT_ONE: {
+			if (selection.empty())
+				return;
+			if (++selectNumber >= selection.size())
+				selectNumber = 0;
+
+			CUnit* sel = selection[selectNumber];
+
+			selectedUnitsHandler.AddUnit(sel);
+			camHandler->CameraTransition(0.8f);
+			if (camHandler->GetCurrentControllerNum() != 0) {
+				camHandler->GetCurrentController().SetPos(sel->pos);
+			} else {	//fps camera
+
+				if (camera->rot.x > -1)
+					camera->rot.x = -1;
+
+				float3 wantedCamDir;
+				wantedCamDir.x = (float)(math::sin(camera->rot.y) * math::cos(camera->rot.x));
+				wantedCamDir.y = (float)(math::sin(camera->rot.x));
+				wantedCamDir.z = (float)(math::cos(camera->rot.y) * math::cos(camera->rot.x));
+				wantedCamDir.ANormalize();
+
+				camHandler->GetCurrentController().SetPos(sel->pos - wantedCamDir * 800);
+			}
+		} break;
+
+		case Query::CONCLUSION_SELECT_NUM:
+		case Query::CONCLUSION_SELECT_PART: {
+			if (selection.empty())
+				return;
+
+			const int num = (query.conclusion == Query::CONCLUSION_SELECT_NUM)?
+				int(query.conclusionArg):
+				int(selection.size() * query.conclusionArg);
+
+			if (selectNumber >= selection.size())
+				selectNumber = 0;
+
+			for (int a = 0; a < num; ++a) {
+				selectedUnitsHandler.AddUnit(selection[(selectNumber + a) % selection.size()]);
+			}
+
+			selectNumber += num;
+		} break;
+
+		default: {
+		} break;
 	}
 }
@@ -4,6 +4,8 @@
 #define SELECTION_KEY_HANDLER_H
 
 #include "InputReceiver.h"
+#include <map>
+#include <string>
 #include <vector>
 
 class CSelectionKeyHandler : public CInputReceiver
@@ -15,6 +17,12 @@ public:
 	void DoSelection(std::string selectString);
 
 private:
+	struct Query;
+
+	/// parses selectString once, later calls with the same string reuse the result
+	const Query& GetQuery(const std::string& selectString);
+	static void CompileQuery(std::string selectString, Query& query);
+
 	/**
 	 * Removes and returns the first part of the string.
 	 * Using the first of the encountered delimitters: '_', '+', end-of-string
@@ -28,6 +36,9 @@ private:
 
 	/// used to go through all possible units when selecting only a few
 	int selectNumber;
+
+	/// compiled selection strings (hotkeys use a small fixed set of them)
+	std::map<std::string, Query*> queries;
 };
 
 extern CSelectionKeyHandler* selectionKeys;
@@ -52,6 +52,7 @@
 #include "Rendering/VerticalSync.h"
 #include "Lua/LuaOpenGL.h"
 #include "Lua/LuaUI.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Units/Scripts/UnitScript.h"
 #include "Sim/Units/Groups/GroupHandler.h"
@@ -74,6 +75,7 @@
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "System/GlobalConfig.h"
+#include "System/MemPool.h"
 #include "Net/Protocol/NetProtocol.h"
 #include "System/Input/KeyInput.h"
 #include "System/FileSystem/SimpleParser.h"
@@ -81,6 +83,7 @@
 #include "System/Sound/SoundChannels.h"
 #include "System/Sync/DumpState.h"
 #include "System/Util.h"
+#include "lib/lua/include/LuaUser.h"
 
 #include <SDL_events.h>
 
@@ -408,7 +411,7 @@ public:
 class RoamActionExecutor : public IUnsyncedActionExecutor {
 public:
 	RoamActionExecutor() : IUnsyncedActionExecutor("roam",
-			"Disables/Enables ROAM mesh rendering: 0=off, 1=on") {}
+			"Disables/Enables ROAM mesh rendering: 0=off, 1=on, 2=chunked (static VBO) mesh") {}
 
 	bool Execute(const UnsyncedAction& action) const {
 		CSMFGroundDrawer* smfGD = dynamic_cast<CSMFGroundDrawer*>(readMap->GetGroundDrawer());
@@ -3108,15 +3111,21 @@ class DebugInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugInfoActionExecutor() : IUnsyncedActionExecutor("DebugInfo",
 			"Print debug info to the chat/log-file about either:"
-			" sound, profiling") {}
+			" sound, profiling, memory") {}
 
 	bool Execute(const UnsyncedAction& action) const {
 		if (action.GetArgs() == "sound") {
 			sound->PrintDebugInfo();
 		} else if (action.GetArgs() == "profiling") {
 			profiler.PrintProfilingInfo();
+		} else if (action.GetArgs() == "memory") {
+			SLuaInfo luaInfo = {0, 0};
+			spring_lua_alloc_get_stats(&luaInfo);
+
+			CMemPool::PrintStats();
+			LOG("%20s %12dKB (%d states)", "lua", luaInfo.allocedBytes / 1024, luaInfo.numStates);
 		} else {
-			LOG_L(L_WARNING, "Give either of these as argument: sound, profiling");
+			LOG_L(L_WARNING, "Give either of these as argument: sound, profiling, memory");
 		}
 		return true;
 	}
@@ -3124,6 +3133,28 @@ public:
 
 
 
+/// /DumpTrace [milliseconds]
+class DumpTraceActionExecutor : public IUnsyncedActionExecutor {
+public:
+	DumpTraceActionExecutor() : IUnsyncedActionExecutor("DumpTrace",
+			"Writes the profiled timers of the last N (default 5000) milliseconds"
+			" to a Chrome trace-event file (chrome://tracing, Perfetto)") {}
+
+	bool Execute(const UnsyncedAction& action) const {
+		const float msecs = action.GetArgs().empty()? 5000.0f: atof(action.GetArgs().c_str());
+
+		if (msecs <= 0.0f) {
+			LOG_L(L_WARNING, "/%s: wrong syntax", GetCommand().c_str());
+			return true;
+		}
+
+		profiler.DumpTrace("ProfilerTrace-[" + IntToString(gs->frameNum) + "].json", msecs);
+		return true;
+	}
+};
+
+
+
 class RedirectToSyncedActionExecutor : public IUnsyncedActionExecutor {
 public:
 	RedirectToSyncedActionExecutor(const std::string& command)
@@ -3456,6 +3487,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors() {
 	AddActionExecutor(new ReloadGameActionExecutor());
 	AddActionExecutor(new ReloadShadersActionExecutor());
 	AddActionExecutor(new DebugInfoActionExecutor());
+	AddActionExecutor(new DumpTraceActionExecutor());
 
 	// XXX are these redirects really required?
 	AddActionExecutor(new RedirectToSyncedActionExecutor("ATM"));
@@ -52,6 +52,11 @@ bool LuaFeatureDefs::PushEntries(lua_State* L)
 		InitParamMap();
 	}
 
+	// shared by all proxies, maps each parameter name to its DataElement
+	const int defsTable = lua_gettop(L);
+	LuaUtils::PushParamKeyTable(L, paramMap);
+	const int keyTable = lua_gettop(L);
+
 	const map<string, const FeatureDef*>& featureDefs = featureHandler->GetFeatureDefs();
 	map<string, const FeatureDef*>::const_iterator fdIt;
 	for (fdIt = featureDefs.begin(); fdIt != featureDefs.end(); ++fdIt) {
@@ -66,7 +71,8 @@ bool LuaFeatureDefs::PushEntries(lua_State* L)
 
 				HSTR_PUSH(L, "__index");
 				lua_pushlightuserdata(L, (void*)fd);
-				lua_pushcclosure(L, FeatureDefIndex, 1);
+				lua_pushvalue(L, keyTable);
+				lua_pushcclosure(L, FeatureDefIndex, 2);
 				lua_rawset(L, -3); // closure
 
 				HSTR_PUSH(L, "__newindex");
@@ -91,9 +97,11 @@ bool LuaFeatureDefs::PushEntries(lua_State* L)
 		lua_pushcfunction(L, Next);
 		lua_rawset(L, -3);
 
-		lua_rawset(L, -3); // proxy table into FeatureDefs
+		lua_rawset(L, defsTable); // proxy table into FeatureDefs
 	}
 
+	lua_pop(L, 1); // keyTable
+
 	return true;
 }
 
@@ -151,24 +159,17 @@ bool LuaFeatureDefs::IsDefaultParam(const string& word)
 
 static int FeatureDefIndex(lua_State* L)
 {
-	// not a default value
-	if (!lua_isstring(L, 2)) {
-		lua_rawget(L, 1);
-		return 1;
-	}
-
-	const char* name = lua_tostring(L, 2);
-	ParamMap::const_iterator it = paramMap.find(name);
+	const DataElement* elemPtr = LuaUtils::GetParamElement(L, lua_upvalueindex(2), 2);
 
 	// not a default value
-	if (it == paramMap.end()) {
+	if (elemPtr == NULL) {
 		lua_rawget(L, 1);
 		return 1;
 	}
 
 	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
 	const FeatureDef* fd = static_cast<const FeatureDef*>(userData);
-	const DataElement& elem = it->second;
+	const DataElement& elem = *elemPtr;
 	const char* p = ((const char*)fd) + elem.offset;
 	switch (elem.type) {
 		case READONLY_TYPE: {
@@ -195,7 +196,7 @@ static int FeatureDefIndex(lua_State* L)
 			return elem.func(L, p);
 		}
 		case ERROR_TYPE: {
-			LOG_L(L_ERROR, "[%s] ERROR_TYPE for key \"%s\" in FeatureDefs __index", __FUNCTION__, name);
+			LOG_L(L_ERROR, "[%s] ERROR_TYPE for key \"%s\" in FeatureDefs __index", __FUNCTION__, lua_tostring(L, 2));
 			lua_pushnil(L);
 			return 1;
 		}
@@ -47,6 +47,18 @@
 
 #include <string>
 
+CONFIG(float, LuaGarbageCollectionFrameTime)
+	.defaultValue(16.0f)
+	.minimumValue(0.0f)
+	.description("Draw frame time (in milliseconds) the incremental Lua garbage collection tries to keep to, it only uses what is left of this after drawing")
+;
+
+CONFIG(int, LuaMemoryCap)
+	.defaultValue(0)
+	.minimumValue(0)
+	.description("Megabytes of heap above which a Lua handle's garbage collection runs a full cycle regardless of frame time (0 = no cap)")
+;
+
 bool CLuaHandle::devMode = false;
 bool CLuaHandle::modUICtrl = true;
 bool CLuaHandle::useDualStates = false;
@@ -72,6 +84,10 @@ CLuaHandle::CLuaHandle(const string& _name, int _order, bool _userMode)
 	, userMode   (_userMode)
 	, killMe     (false)
 	, callinErrors(0)
+	, callInCount(0)
+	, callInBudget(0)
+	, gcMemoryCap(configHandler->GetInt("LuaMemoryCap"))
+	, gcFrameTime(configHandler->GetFloat("LuaGarbageCollectionFrameTime"))
 {
 	UpdateThreading();
 
@@ -282,15 +298,15 @@ void CLuaHandle::DelayRecvFromSynced(lua_State* srcState, int args) {
 		lua_pop(srcState, 1);
 	}
 
-	LuaUtils::ShallowBackup(ddmp.data, srcState, args);
-
 	GML_STDMUTEX_LOCK(scall);
 
 	delayedCallsFromSynced.push_back(DelayDataDump());
 
+	// the arguments are only plain values, appending them to one shared
+	// buffer avoids allocating per message (and per string argument)
 	DelayDataDump& ddb = delayedCallsFromSynced.back();
-	ddb.data.swap(ddmp.data);
 	ddb.dump.swap(ddmp.dump);
+	ddb.numPackedArgs = LuaUtils::ShallowBackup(delayedCallsFromSyncedArgs, srcState, args);
 	ddb.xcall = false;
 }
 
@@ -331,6 +347,7 @@ bool CLuaHandle::ExecuteCallsFromSynced(bool forced) {
 	GML_THRMUTEX_LOCK(obj, GML_DRAW); // ExecuteCallsFromSynced
 
 	std::vector<DelayDataDump> drfs;
+	std::vector<char> drfsArgs;
 	{
 		GML_STDMUTEX_LOCK(scall); // ExecuteCallsFromSynced
 
@@ -338,8 +355,11 @@ bool CLuaHandle::ExecuteCallsFromSynced(bool forced) {
 			return false;
 
 		delayedCallsFromSynced.swap(drfs);
+		delayedCallsFromSyncedArgs.swap(drfsArgs);
 	}
 
+	size_t drfsArgsPos = 0;
+
 	GML_THRMUTEX_LOCK(unit, GML_DRAW); // ExecuteCallsFromSynced
 	GML_THRMUTEX_LOCK(feat, GML_DRAW); // ExecuteCallsFromSynced
 //	GML_THRMUTEX_LOCK(proj, GML_DRAW); // ExecuteCallsFromSynced
@@ -371,9 +391,9 @@ bool CLuaHandle::ExecuteCallsFromSynced(bool forced) {
 				lua_pop(L, 2);
 			}
 
-			int ddsize = ddp.data.size();
+			const int ddsize = ddp.numPackedArgs;
 			if (ddsize > 0) {
-				LuaUtils::ShallowRestore(ddp.data, L);
+				LuaUtils::ShallowRestore(drfsArgs, drfsArgsPos, ddsize, L);
 				luaL_checkstack(L, 2, __FUNCTION__);
 				RecvFromSynced(L, ddsize);
 			}
@@ -401,6 +421,17 @@ bool CLuaHandle::ExecuteCallsFromSynced(bool forced) {
 			}
 		}
 	}
+
+	{
+		// hand the drained buffer back, so its capacity is reused
+		GML_STDMUTEX_LOCK(scall); // ExecuteCallsFromSynced
+
+		if (delayedCallsFromSyncedArgs.empty()) {
+			drfsArgs.clear();
+			delayedCallsFromSyncedArgs.swap(drfsArgs);
+		}
+	}
+
 	return true;
 }
 
@@ -441,6 +472,7 @@ int CLuaHandle::RunCallInTraceback(
 			, popErrFunc(_popErrFunc)
 		{
 			handle->SetRunning(state, true);
+			handle->callInCount++;
 
 			GLMatrixStateTracker& matTracker = GetLuaContextData(state)->glMatrixTracker;
 			MatrixStateData prevMatState = matTracker.PushMatrixState();
@@ -515,11 +547,69 @@ int CLuaHandle::RunCallInTraceback(
 		int error;
 	};
 
-	// TODO: use closure so we do not need to copy args
-	ScopedLuaCall call(this, L, hs, inArgs, outArgs, errFuncIndex, popErrorFunc);
-	call.CheckFixStack(tracebackMsg);
+	if (hs == NULL) {
+		// TODO: use closure so we do not need to copy args
+		ScopedLuaCall call(this, L, hs, inArgs, outArgs, errFuncIndex, popErrorFunc);
+		call.CheckFixStack(tracebackMsg);
+
+		return (call.GetError());
+	}
+
+	CallInStats& stats = callInStats[hs];
+
+	if (stats.calls == 0 && stats.skipped == 0) {
+		const std::string& callInName = hs->GetString();
+
+		stats.traceName = GetName() + "::" + callInName;
+		stats.skippable = (callInName == "Update" || callInName.compare(0, 4, "Draw") == 0);
+	}
+
+	const spring_time startTime = spring_gettime();
+
+	if (stats.skippable && outArgs == 0 && !CheckCallInBudget(startTime)) {
+		// drop the function and its arguments as if it had run
+		lua_pop(L, inArgs + 1);
+		stats.skipped++;
+		return 0;
+	}
+
+	const int startHeap = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+	int error = 0;
+
+	{
+		ScopedTraceTimer traceTimer(stats.traceName);
+
+		// TODO: use closure so we do not need to copy args
+		ScopedLuaCall call(this, L, hs, inArgs, outArgs, errFuncIndex, popErrorFunc);
+		call.CheckFixStack(tracebackMsg);
+
+		error = call.GetError();
+	}
+
+	const int endHeap = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+	const spring_time callTime = spring_gettime() - startTime;
 
-	return (call.GetError());
+	stats.time += callTime;
+	stats.calls++;
+	stats.allocBytes += std::max(0, endHeap - startHeap);
+
+	budgetPeriodTime += callTime;
+
+	return error;
+}
+
+
+bool CLuaHandle::CheckCallInBudget(const spring_time now)
+{
+	if (callInBudget <= 0 || GetHandleSynced(GetActiveState()))
+		return true;
+
+	if ((now - budgetPeriodStart) >= spring_secs(1)) {
+		budgetPeriodStart = now;
+		budgetPeriodTime = spring_notime;
+	}
+
+	return (budgetPeriodTime < spring_msecs(callInBudget));
 }
 
 
@@ -674,6 +764,9 @@ void CLuaHandle::GameFrame(int frameNum)
 
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
+	// deliver the previous frame's batched events first
+	FlushUnitDamagedBatch(L, traceBack.GetErrFuncIdx());
+
 	static const LuaHashString cmdStr("GameFrame");
 	if (!cmdStr.GetGlobalFunc(L)) {
 		return; // the call is not defined
@@ -1035,6 +1128,30 @@ void CLuaHandle::UnitDamaged(
 	luaL_checkstack(L, 11, __FUNCTION__);
 
 	static const LuaHashString cmdStr(__FUNCTION__);
+	static const LuaHashString batchStr("UnitDamagedBatch");
+
+	if (batchStr.GetGlobalFunc(L)) {
+		lua_pop(L, 1);
+
+		const bool fullRead = GetHandleFullRead(L);
+		const bool haveAttacker = (fullRead && attacker != NULL);
+
+		const UnitDamagedBatchEntry entry = {
+			unit->id,
+			unit->unitDef->id,
+			unit->team,
+			damage,
+			paralyzer,
+			fullRead? weaponDefID: -1,
+			fullRead? projectileID: -1,
+			haveAttacker? attacker->id: -1,
+			haveAttacker? attacker->unitDef->id: -1,
+			haveAttacker? attacker->team: -1,
+		};
+
+		unitDamagedBatch.push_back(entry);
+	}
+
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	if (!cmdStr.GetGlobalFunc(L))
@@ -1066,6 +1183,79 @@ void CLuaHandle::UnitDamaged(
 }
 
 
+void CLuaHandle::FlushUnitDamagedBatch(lua_State* L, int errFuncIndex)
+{
+	if (unitDamagedBatch.empty())
+		return;
+
+	static const LuaHashString cmdStr("UnitDamagedBatch");
+
+	if (!cmdStr.GetGlobalFunc(L)) {
+		// got removed since the events were queued
+		unitDamagedBatch.clear();
+		return;
+	}
+
+	luaL_checkstack(L, 12, __FUNCTION__);
+
+	const int numEntries = unitDamagedBatch.size();
+
+	// one array per UnitDamaged argument, all of length <numEntries>
+	#define PUSH_BATCH_ARRAY(member, pushFunc)              \
+		lua_createtable(L, numEntries, 0);                  \
+		for (int n = 0; n < numEntries; n++) {              \
+			pushFunc(L, unitDamagedBatch[n].member);        \
+			lua_rawseti(L, -2, n + 1);                      \
+		}
+
+	lua_pushnumber(L, numEntries);
+	PUSH_BATCH_ARRAY(unitID, lua_pushnumber)
+	PUSH_BATCH_ARRAY(unitDefID, lua_pushnumber)
+	PUSH_BATCH_ARRAY(unitTeam, lua_pushnumber)
+	PUSH_BATCH_ARRAY(damage, lua_pushnumber)
+	PUSH_BATCH_ARRAY(paralyzer, lua_pushboolean)
+	PUSH_BATCH_ARRAY(weaponDefID, lua_pushnumber)
+	PUSH_BATCH_ARRAY(projectileID, lua_pushnumber)
+	PUSH_BATCH_ARRAY(attackerID, lua_pushnumber)
+	PUSH_BATCH_ARRAY(attackerDefID, lua_pushnumber)
+	PUSH_BATCH_ARRAY(attackerTeam, lua_pushnumber)
+
+	#undef PUSH_BATCH_ARRAY
+
+	// cleared before the call, it might cause new damage events
+	unitDamagedBatch.clear();
+
+	// call the routine
+	RunCallInTraceback(cmdStr, 11, 0, errFuncIndex, false);
+}
+
+
+void CLuaHandle::UpdateEventRegistration(lua_State* L, const string& name)
+{
+	if (name == "UnitDamagedBatch" || name == "UnitDamaged" || name == "GameFrame") {
+		const bool batched = HasCallIn(L, "UnitDamagedBatch");
+
+		if (batched || HasCallIn(L, "UnitDamaged")) {
+			eventHandler.InsertEvent(this, "UnitDamaged");
+		} else {
+			eventHandler.RemoveEvent(this, "UnitDamaged");
+		}
+		if (batched || HasCallIn(L, "GameFrame")) {
+			eventHandler.InsertEvent(this, "GameFrame");
+		} else {
+			eventHandler.RemoveEvent(this, "GameFrame");
+		}
+		return;
+	}
+
+	if (HasCallIn(L, name)) {
+		eventHandler.InsertEvent(this, name);
+	} else {
+		eventHandler.RemoveEvent(this, name);
+	}
+}
+
+
 void CLuaHandle::UnitExperience(const CUnit* unit, float oldExperience)
 {
 	LUA_UNIT_BATCH_PUSH(, LuaUnitExperienceEvent(unit, oldExperience))
@@ -2877,22 +3067,33 @@ void CLuaHandle::CollectGarbage()
 	SELECT_LUA_STATE();
 	lua_gc(L, LUA_GCSTOP, 0); // don't collect garbage outside of this function
 
-	//TODO make configureable?
 	const int memUsageInMB = lua_gc(L, LUA_GCCOUNT, 0) / 1024;
 	const float TIME_PER_MB = 0.02f + 0.08f * smoothstep(25, 100, memUsageInMB); // alloced Mem 25MB: 20microsec  100MB: 100microsec (30x per second)
-	const float maxRuntime = TIME_PER_MB * memUsageInMB;
-	const spring_time endTime = spring_gettime() + spring_msecs(maxRuntime);
 
-	// Collect Garbage till time runs out
+	// stay within what drawing leaves of the frame, but always make some progress
+	const float frameSlack = std::max(gcFrameTime - gu->avgDrawFrameTime, 0.05f);
+	const float maxRuntime = std::min(TIME_PER_MB * memUsageInMB, frameSlack);
+
+	const bool overCap = (gcMemoryCap > 0 && memUsageInMB >= gcMemoryCap);
+	const spring_time startTime = spring_gettime();
+	const spring_time endTime = startTime + spring_msecs(maxRuntime);
+
+	// Collect Garbage till time runs out (or the cycle is done when over the cap)
 	SetRunning(L, true);
 		do {
+			gcStats.steps++;
+
 			if (lua_gc(L, LUA_GCSTEP, 2)) {
-				SetRunning(L, false);
-				return;
+				gcStats.cycles++;
+				gcStats.forcedCycles += overCap;
+				break;
 			}
-		} while(spring_gettime() < endTime);
+		} while (overCap || spring_gettime() < endTime);
 	SetRunning(L, false);
 
+	gcStats.lastTime = spring_gettime() - startTime;
+	gcStats.totalTime += gcStats.lastTime;
+
 	//LOG("%s GC not finished in time %.3fms %iMB", GetName().c_str(), (spring_gettime() - endTime).toMilliSecsf() + maxRuntime, memUsageInMB);
 }
 
@@ -2915,6 +3116,8 @@ bool CLuaHandle::AddBasicCalls(lua_State *L)
 		HSTR_PUSH_CFUNC(L, "GetGlobal",       CallOutGetGlobal);
 		HSTR_PUSH_CFUNC(L, "GetRegistry",     CallOutGetRegistry);
 		HSTR_PUSH_CFUNC(L, "GetCallInList",   CallOutGetCallInList);
+		HSTR_PUSH_CFUNC(L, "GetCallInStats",  CallOutGetCallInStats);
+		HSTR_PUSH_CFUNC(L, "GetGCStats",      CallOutGetGCStats);
 		// special team constants
 		HSTR_PUSH_NUMBER(L, "NO_ACCESS_TEAM",  CEventClient::NoAccessTeam);
 		HSTR_PUSH_NUMBER(L, "ALL_ACCESS_TEAM", CEventClient::AllAccessTeam);
@@ -3025,6 +3228,63 @@ int CLuaHandle::CallOutGetCallInList(lua_State* L)
 		}
 		lua_rawset(L, -3);
 	}
+
+	// not an event of its own, see UpdateEventRegistration
+	lua_pushliteral(L, "UnitDamagedBatch");
+	lua_newtable(L); {
+		lua_pushliteral(L, "unsynced");
+		lua_pushboolean(L, false);
+		lua_rawset(L, -3);
+		lua_pushliteral(L, "controller");
+		lua_pushboolean(L, false);
+		lua_rawset(L, -3);
+	}
+	lua_rawset(L, -3);
+	return 1;
+}
+
+
+int CLuaHandle::CallOutGetCallInStats(lua_State* L)
+{
+	// timings differ between clients
+	if (GetHandleSynced(L))
+		return 0;
+
+	const CLuaHandle* lh = GetHandle(L);
+	const std::map<const LuaHashString*, CallInStats>& stats = lh->GetCallInStats();
+
+	lua_createtable(L, 0, stats.size());
+
+	for (std::map<const LuaHashString*, CallInStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+		lua_pushsstring(L, it->first->GetString());
+		lua_createtable(L, 0, 4); {
+			LuaPushNamedNumber(L, "time",       it->second.time.toMilliSecsf());
+			LuaPushNamedNumber(L, "calls",      it->second.calls);
+			LuaPushNamedNumber(L, "skipped",    it->second.skipped);
+			LuaPushNamedNumber(L, "allocBytes", it->second.allocBytes);
+		}
+		lua_rawset(L, -3);
+	}
+
+	return 1;
+}
+
+
+int CLuaHandle::CallOutGetGCStats(lua_State* L)
+{
+	// timings differ between clients
+	if (GetHandleSynced(L))
+		return 0;
+
+	const GCStats& stats = GetHandle(L)->GetGCStats();
+
+	lua_createtable(L, 0, 6);
+	LuaPushNamedNumber(L, "lastTime",     stats.lastTime.toMilliSecsf());
+	LuaPushNamedNumber(L, "totalTime",    stats.totalTime.toMilliSecsf());
+	LuaPushNamedNumber(L, "steps",        stats.steps);
+	LuaPushNamedNumber(L, "cycles",       stats.cycles);
+	LuaPushNamedNumber(L, "forcedCycles", stats.forcedCycles);
+	LuaPushNamedNumber(L, "memKiB",       lua_gc(L, LUA_GCCOUNT, 0));
 	return 1;
 }
 
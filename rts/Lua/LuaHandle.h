@@ -10,9 +10,11 @@
 #include "LuaContextData.h"
 #include "LuaUtils.h"
 #include "System/Platform/Threading.h"
+#include "System/Misc/SpringTime.h"
 
 #include <string>
 #include <vector>
+#include <map>
 #include <set>
 using std::string;
 using std::vector;
@@ -38,6 +40,7 @@ struct SRectangle;
 struct LuaHashString;
 struct lua_State;
 class LuaRBOs;
+class LuaVBOs;
 class LuaFBOs;
 class LuaTextures;
 class LuaShaders;
@@ -107,7 +110,7 @@ class CLuaHandle : public CEventClient
 //FIXME		LuaArrays& GetArrays(const lua_State* L = NULL) { return GET_CONTEXT_DATA(arrays); }
 		LuaShaders& GetShaders(const lua_State* L = NULL) { return GET_CONTEXT_DATA(shaders); }
 		LuaTextures& GetTextures(const lua_State* L = NULL) { return GET_CONTEXT_DATA(textures); }
-//FIXME		LuaVBOs& GetVBOs(const lua_State* L = NULL) { return GET_CONTEXT_DATA(vbos); }
+		LuaVBOs& GetVBOs(const lua_State* L = NULL) { return GET_CONTEXT_DATA(vbos); }
 		LuaFBOs& GetFBOs(const lua_State* L = NULL) { return GET_CONTEXT_DATA(fbos); }
 		LuaRBOs& GetRBOs(const lua_State* L = NULL) { return GET_CONTEXT_DATA(rbos); }
 		CLuaDisplayLists& GetDisplayLists(const lua_State* L = NULL) { return GET_CONTEXT_DATA(displayLists); }
@@ -121,6 +124,9 @@ class CLuaHandle : public CEventClient
 				// ask our derived instance
 				if (HasCallIn(L, name))
 					return true;
+				// UnitDamagedBatch is fed by UnitDamaged and flushed by GameFrame
+				if ((name == "UnitDamaged" || name == "GameFrame") && HasCallIn(L, "UnitDamagedBatch"))
+					return true;
 			}
 			END_ITERATE_LUA_STATES();
 			return false;
@@ -276,8 +282,11 @@ class CLuaHandle : public CEventClient
 		}
 
 		struct DelayDataDump {
-			std::vector<LuaUtils::ShallowDataDump> data;
+			DelayDataDump(): numPackedArgs(0), xcall(false) {}
+
+			std::vector<LuaUtils::ShallowDataDump> data; // xcall only
 			std::vector<LuaUtils::DataDump> dump;
+			int numPackedArgs; // RecvFromSynced arguments in delayedCallsFromSyncedArgs
 			bool xcall;
 		};
 
@@ -287,6 +296,8 @@ class CLuaHandle : public CEventClient
 		void RecvFromSim(int args);
 		void DelayRecvFromSynced(lua_State* srcState, int args);
 		std::vector<DelayDataDump> delayedCallsFromSynced;
+		/// packed arguments of all delayed RecvFromSynced calls, in call order
+		std::vector<char> delayedCallsFromSyncedArgs;
 		static int SendToUnsynced(lua_State* L);
 
 		void UpdateThreading();
@@ -311,6 +322,10 @@ class CLuaHandle : public CEventClient
 		bool RunCallIn(const LuaHashString& hs, int inArgs, int outArgs);
 		bool RunCallInUnsynced(const LuaHashString& hs, int inArgs, int outArgs);
 
+		/// (un)registers us for the event(s) feeding the (changed) call-in <name>
+		void UpdateEventRegistration(lua_State* L, const string& name);
+		void FlushUnitDamagedBatch(lua_State* L, int errFuncIndex);
+
 		void LosCallIn(const LuaHashString& hs, const CUnit* unit, int allyTeam);
 		void UnitCallIn(const LuaHashString& hs, const CUnit* unit);
 		bool PushUnsyncedCallIn(lua_State* L, const LuaHashString& hs);
@@ -359,6 +374,82 @@ class CLuaHandle : public CEventClient
 		vector<bool> watchWeaponDefs; // for the Explosion call-in
 
 		int callinErrors;
+		/// bumped whenever Lua code is run through RunCallInTraceback
+		unsigned int callInCount;
+
+		/// one UnitDamaged event, as queued for the UnitDamagedBatch call-in
+		struct UnitDamagedBatchEntry {
+			int unitID;
+			int unitDefID;
+			int unitTeam;
+			float damage;
+			bool paralyzer;
+			int weaponDefID;
+			int projectileID;
+			int attackerID; ///< -1 (as are its def and team) if there is none
+			int attackerDefID;
+			int attackerTeam;
+		};
+
+		std::vector<UnitDamagedBatchEntry> unitDamagedBatch;
+
+	public:
+		/// cumulative cost of one call-in of this handle
+		struct CallInStats {
+			CallInStats(): calls(0), skipped(0), allocBytes(0), skippable(false) {}
+
+			spring_time time; ///< inclusive of nested call-ins
+			unsigned int calls;
+			unsigned int skipped; ///< because the handle was over budget
+			boost::uint64_t allocBytes; ///< Lua heap growth (GC is stopped while running)
+
+			std::string traceName;
+			bool skippable;
+		};
+
+		/// keyed by the call-in's (static) name object
+		const std::map<const LuaHashString*, CallInStats>& GetCallInStats() const { return callInStats; }
+
+		/**
+		 * Skippable (drawing and Update) call-ins are not run for the rest
+		 * of the current second once all call-ins together have used up
+		 * this many milliseconds in it; 0 disables the budget. Only honored
+		 * for unsynced handles.
+		 */
+		void SetCallInBudget(int msecsPerSec) { callInBudget = msecsPerSec; }
+
+		/// cost of the incremental garbage collection run by CollectGarbage
+		struct GCStats {
+			GCStats(): steps(0), cycles(0), forcedCycles(0) {}
+
+			spring_time lastTime; ///< of the most recent CollectGarbage
+			spring_time totalTime;
+			unsigned int steps;
+			unsigned int cycles;
+			unsigned int forcedCycles; ///< full cycles run because of the memory cap
+		};
+
+		const GCStats& GetGCStats() const { return gcStats; }
+
+		/**
+		 * Above this many megabytes of Lua heap CollectGarbage ignores the
+		 * frame-time slack and completes a full cycle; 0 disables the cap.
+		 */
+		void SetMemoryCap(int megaBytes) { gcMemoryCap = megaBytes; }
+
+	protected:
+		bool CheckCallInBudget(const spring_time now);
+
+		std::map<const LuaHashString*, CallInStats> callInStats;
+
+		int callInBudget;
+		spring_time budgetPeriodStart;
+		spring_time budgetPeriodTime;
+
+		GCStats gcStats;
+
+		int gcMemoryCap;
+		float gcFrameTime;
 
 	public: // EventBatch
 		void ExecuteUnitEventBatch();
@@ -387,6 +478,8 @@ class CLuaHandle : public CEventClient
 		static int CallOutGetGlobal(lua_State* L);
 		static int CallOutGetRegistry(lua_State* L);
 		static int CallOutGetCallInList(lua_State* L);
+		static int CallOutGetCallInStats(lua_State* L);
+		static int CallOutGetGCStats(lua_State* L);
 		static int CallOutSyncedUpdateCallIn(lua_State* L);
 		static int CallOutUnsyncedUpdateCallIn(lua_State* L);
 
@@ -394,7 +487,7 @@ class CLuaHandle : public CEventClient
 //FIXME		static LuaArrays& GetActiveArrays(lua_State* L)   { return GET_HANDLE_CONTEXT_DATA(arrays); }
 		static inline LuaShaders& GetActiveShaders(lua_State* L)  { return GET_HANDLE_CONTEXT_DATA(shaders); }
 		static inline LuaTextures& GetActiveTextures(lua_State* L) { return GET_HANDLE_CONTEXT_DATA(textures); }
-//FIXME		static LuaVBOs& GetActiveVBOs(lua_State* L)     { return GET_HANDLE_CONTEXT_DATA(vbos); }
+		static inline LuaVBOs& GetActiveVBOs(lua_State* L)     { return GET_HANDLE_CONTEXT_DATA(vbos); }
 		static inline LuaFBOs& GetActiveFBOs(lua_State* L) { return GET_HANDLE_CONTEXT_DATA(fbos); }
 		static inline LuaRBOs& GetActiveRBOs(lua_State* L)     { return GET_HANDLE_CONTEXT_DATA(rbos); }
 		static inline CLuaDisplayLists& GetActiveDisplayLists(lua_State* L) { return GET_HANDLE_CONTEXT_DATA(displayLists); }
@@ -640,11 +640,7 @@ bool CLuaHandleSynced::SyncedUpdateCallIn(lua_State* L, const string& name)
 	    eventHandler.IsUnsynced(name)) {
 		return false;
 	}
-	if (HasCallIn(L, name)) {
-		eventHandler.InsertEvent(this, name);
-	} else {
-		eventHandler.RemoveEvent(this, name);
-	}
+	UpdateEventRegistration(L, name);
 	return true;
 }
 
@@ -655,11 +651,7 @@ bool CLuaHandleSynced::UnsyncedUpdateCallIn(lua_State* L, const string& name)
 		if (!eventHandler.IsUnsynced(name))
 			return false;
 
-		if (HasCallIn(L, name)) {
-			eventHandler.InsertEvent(this, name);
-		} else {
-			eventHandler.RemoveEvent(this, name);
-		}
+		UpdateEventRegistration(L, name);
 	}
 
 	SetupUnsyncedFunction(L, name.c_str());
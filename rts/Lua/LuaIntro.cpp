@@ -388,11 +388,7 @@ bool CLuaIntro::UnsyncedUpdateCallIn(lua_State *L, const string& name)
 		return false;
 	}
 
-	if (HasCallIn(L, name)) {
-		eventHandler.InsertEvent(this, name);
-	} else {
-		eventHandler.RemoveEvent(this, name);
-	}
+	UpdateEventRegistration(L, name);
 
 	return true;
 }
@@ -6,8 +6,11 @@
 #include "LuaInclude.h"
 
 #include "LuaHandle.h"
+#include "LuaUtils.h"
 #include "Map/MetalMap.h"
 #include "Map/ReadMap.h"
+#include "Sim/Misc/ResourceHandler.h"
+#include "Sim/Misc/ResourceMapAnalyzer.h"
 
 /******************************************************************************/
 /******************************************************************************/
@@ -22,6 +25,7 @@ bool LuaMetalMap::PushReadEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetMetalMapSize);
 	REGISTER_LUA_CFUNC(GetMetalAmount);
 	REGISTER_LUA_CFUNC(GetMetalExtraction);
+	REGISTER_LUA_CFUNC(GetMetalSpots);
 
 	return true;
 }
@@ -73,6 +77,28 @@ int LuaMetalMap::GetMetalExtraction(lua_State* L)
 	return 1;
 }
 
+int LuaMetalMap::GetMetalSpots(lua_State* L)
+{
+	const CResourceMapAnalyzer* rma = resourceHandler->GetResourceMapAnalyzer(resourceHandler->GetMetalId());
+	const std::vector<float3>& spots = rma->GetSpots();
+
+	// the same extractor spots the engine hands to skirmish AIs,
+	// each covers a circle of radius <extractorRadius> (elmos)
+	lua_createtable(L, spots.size(), 0);
+
+	for (size_t i = 0; i < spots.size(); i++) {
+		lua_createtable(L, 0, 4);
+		LuaPushNamedNumber(L, "x", spots[i].x);
+		LuaPushNamedNumber(L, "z", spots[i].z);
+		LuaPushNamedNumber(L, "worth", spots[i].y);
+		LuaPushNamedNumber(L, "radius", rma->GetExtractorRadius());
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_pushnumber(L, rma->GetAverageIncome());
+	return 2;
+}
+
 
 
 
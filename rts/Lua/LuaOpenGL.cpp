@@ -24,7 +24,7 @@
 #include "LuaHashString.h"
 #include "LuaShaders.h"
 #include "LuaTextures.h"
-//FIXME#include "LuaVBOs.h"
+#include "LuaVBOs.h"
 #include "LuaFBOs.h"
 #include "LuaRBOs.h"
 #include "LuaFonts.h"
@@ -206,6 +206,7 @@ bool LuaOpenGL::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(CreateTexture);
 	REGISTER_LUA_CFUNC(DeleteTexture);
 	REGISTER_LUA_CFUNC(TextureInfo);
+	REGISTER_LUA_CFUNC(GetTextureMemUsage);
 	REGISTER_LUA_CFUNC(CopyToTexture);
 	if (GLEW_EXT_framebuffer_object) {
 		// FIXME: obsolete
@@ -310,7 +311,7 @@ bool LuaOpenGL::PushEntries(lua_State* L)
 
 	LuaFonts::PushEntries(L);
 
-//FIXME		LuaVBOs::PushEntries(L);
+	LuaVBOs::PushEntries(L);
 
 	return true;
 }
@@ -1433,7 +1434,7 @@ int LuaOpenGL::UnitPiece(lua_State* L)
 	}
 	LocalModelPiece* localPiece = localModel->pieces[piece];
 
-	glCallList(localPiece->dispListID);
+	localPiece->original->DrawGeometry();
 
 	return 0;
 }
@@ -3217,6 +3218,16 @@ int LuaOpenGL::TextureInfo(lua_State* L)
 }
 
 
+int LuaOpenGL::GetTextureMemUsage(lua_State* L)
+{
+	// estimates, in KB, for the textures created by this handle
+	const LuaTextures& textures = CLuaHandle::GetActiveTextures(L);
+	lua_pushnumber(L, textures.GetUsedBytes() / 1024);
+	lua_pushnumber(L, textures.GetPooledBytes() / 1024);
+	return 2;
+}
+
+
 int LuaOpenGL::CopyToTexture(lua_State* L)
 {
 	CheckDrawingEnabled(L, __FUNCTION__);
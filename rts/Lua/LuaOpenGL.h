@@ -176,6 +176,7 @@ class LuaOpenGL {
 		static int DeleteTexture(lua_State* L);
 		static int DeleteTextureFBO(lua_State* L);
 		static int TextureInfo(lua_State* L);
+		static int GetTextureMemUsage(lua_State* L);
 		static int CopyToTexture(lua_State* L);
 		static int RenderToTexture(lua_State* L);
 		static int GenerateMipmap(lua_State* L);
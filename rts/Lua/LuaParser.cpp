@@ -4,8 +4,12 @@
 #include "LuaParser.h"
 
 #include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <limits.h>
+#include <boost/cstdint.hpp>
 #include <boost/regex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 
 #include "lib/streflop/streflop_cond.h"
 
@@ -27,6 +31,7 @@
 #include "System/Util.h"
 
 LuaParser* LuaParser::currentParser = NULL;
+static boost::recursive_mutex executeMutex;
 
 
 /******************************************************************************/
@@ -193,16 +198,20 @@ bool LuaParser::Execute()
 		return false;
 	}
 
-	currentParser = this;
-
 	{
+		// currentParser is shared by all instances, some
+		// of which (model metadata) are run on worker threads
+		boost::recursive_mutex::scoped_lock lock(executeMutex);
+
+		currentParser = this;
+
 		// do not signal floating point exceptions in user Lua code
 		ScopedDisableFpuExceptions fe;
 
 		error = lua_pcall(L, 0, 1, 0);
-	}
 
-	currentParser = NULL;
+		currentParser = NULL;
+	}
 
 	if (error != 0) {
 		errorLog = lua_tostring(L, -1);
@@ -235,6 +244,219 @@ bool LuaParser::Execute()
 }
 
 
+/******************************************************************************/
+//
+//  Root table cache
+//
+
+static const char luaCacheMagic[] = "SpringLuaCache1";
+static const int luaCacheMaxDepth = 64; // also catches cyclic tables
+
+enum {
+	LUACACHE_FALSE  = 0,
+	LUACACHE_TRUE   = 1,
+	LUACACHE_NUMBER = 2,
+	LUACACHE_STRING = 3,
+	LUACACHE_TABLE  = 4,
+};
+
+static void WriteCacheData(string& buf, const void* data, size_t size)
+{
+	buf.append(static_cast<const char*>(data), size);
+}
+
+static bool WriteCacheValue(lua_State* L, int index, string& buf, int depth)
+{
+	switch (lua_type(L, index)) {
+		case LUA_TBOOLEAN: {
+			buf += char(lua_toboolean(L, index)? LUACACHE_TRUE: LUACACHE_FALSE);
+			return true;
+		}
+		case LUA_TNUMBER: {
+			const lua_Number value = lua_tonumber(L, index);
+			buf += char(LUACACHE_NUMBER);
+			WriteCacheData(buf, &value, sizeof(value));
+			return true;
+		}
+		case LUA_TSTRING: {
+			size_t len = 0;
+			const char* str = lua_tolstring(L, index, &len);
+			const boost::uint32_t size = len;
+			buf += char(LUACACHE_STRING);
+			WriteCacheData(buf, &size, sizeof(size));
+			WriteCacheData(buf, str, len);
+			return true;
+		}
+		case LUA_TTABLE: {
+			if (depth >= luaCacheMaxDepth || !lua_checkstack(L, 3))
+				return false;
+
+			const int table = (index > 0)? index: (lua_gettop(L) + index + 1);
+			const boost::uint32_t arraySize = lua_objlen(L, table);
+			boost::uint32_t numPairs = 0;
+
+			buf += char(LUACACHE_TABLE);
+			WriteCacheData(buf, &arraySize, sizeof(arraySize));
+
+			// patched once the table was written
+			const size_t numPairsPos = buf.size();
+			WriteCacheData(buf, &numPairs, sizeof(numPairs));
+
+			for (lua_pushnil(L); lua_next(L, table) != 0; lua_pop(L, 1)) {
+				if (!WriteCacheValue(L, -2, buf, depth + 1) || !WriteCacheValue(L, -1, buf, depth + 1)) {
+					lua_pop(L, 2);
+					return false;
+				}
+				numPairs++;
+			}
+
+			memcpy(&buf[numPairsPos], &numPairs, sizeof(numPairs));
+			return true;
+		}
+		default: {
+			// functions, userdata, etc.
+			return false;
+		}
+	}
+}
+
+template<typename T>
+static bool ReadCacheData(const char*& pos, const char* end, T& data)
+{
+	if ((end - pos) < sizeof(T))
+		return false;
+
+	memcpy(&data, pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+static bool ReadCacheValue(lua_State* L, const char*& pos, const char* end, int depth)
+{
+	if (pos >= end)
+		return false;
+
+	switch (*(pos++)) {
+		case LUACACHE_FALSE: {
+			lua_pushboolean(L, false);
+			return true;
+		}
+		case LUACACHE_TRUE: {
+			lua_pushboolean(L, true);
+			return true;
+		}
+		case LUACACHE_NUMBER: {
+			lua_Number value;
+			if (!ReadCacheData(pos, end, value))
+				return false;
+
+			lua_pushnumber(L, value);
+			return true;
+		}
+		case LUACACHE_STRING: {
+			boost::uint32_t size;
+			if (!ReadCacheData(pos, end, size) || (end - pos) < size)
+				return false;
+
+			lua_pushlstring(L, pos, size);
+			pos += size;
+			return true;
+		}
+		case LUACACHE_TABLE: {
+			boost::uint32_t arraySize;
+			boost::uint32_t numPairs;
+			if (depth >= luaCacheMaxDepth || !lua_checkstack(L, 3))
+				return false;
+			if (!ReadCacheData(pos, end, arraySize) || !ReadCacheData(pos, end, numPairs))
+				return false;
+
+			// arrays with holes can have a larger length than element count
+			arraySize = std::min(arraySize, numPairs);
+
+			lua_createtable(L, arraySize, numPairs - arraySize);
+
+			for (boost::uint32_t n = 0; n < numPairs; n++) {
+				if (!ReadCacheValue(L, pos, end, depth + 1))
+					return false;
+				if (!ReadCacheValue(L, pos, end, depth + 1))
+					return false;
+
+				lua_rawset(L, -3);
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool LuaParser::SaveCache(const string& cacheFile)
+{
+	if (!IsValid() || (rootRef == LUA_NOREF))
+		return false;
+
+	string buf(luaCacheMagic, sizeof(luaCacheMagic));
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, rootRef);
+	const bool serialized = WriteCacheValue(L, -1, buf, 0);
+	lua_pop(L, 1);
+
+	if (!serialized) {
+		LOG_L(L_WARNING, "[LuaParser::%s] %s can not be cached (non-data values or too deeply nested)", __FUNCTION__, fileName.c_str());
+		return false;
+	}
+
+	std::ofstream file(cacheFile.c_str(), std::ios::out | std::ios::binary);
+
+	if (!file.good())
+		return false;
+
+	file.write(buf.data(), buf.size());
+	return file.good();
+}
+
+
+bool LuaParser::LoadCache(const string& cacheFile)
+{
+	if (!IsValid())
+		return false;
+
+	std::ifstream file(cacheFile.c_str(), std::ios::in | std::ios::binary);
+
+	if (!file.good())
+		return false;
+
+	const string buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (buf.size() < sizeof(luaCacheMagic) || memcmp(buf.data(), luaCacheMagic, sizeof(luaCacheMagic)) != 0)
+		return false;
+
+	const char* pos = buf.data() + sizeof(luaCacheMagic);
+	const char* end = buf.data() + buf.size();
+
+	const int top = lua_gettop(L);
+
+	if (!ReadCacheValue(L, pos, end, 0) || !lua_istable(L, -1) || pos != end) {
+		LOG_L(L_WARNING, "[LuaParser::%s] corrupt cache %s", __FUNCTION__, cacheFile.c_str());
+		lua_settop(L, top);
+		return false;
+	}
+
+	// as if Execute had run (the cached table already is lower-cased)
+	assert(initDepth == 0);
+	initDepth = -1;
+
+	rootRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+	lua_settop(L, 0);
+
+	valid = true;
+
+	return true;
+}
+
+
 void LuaParser::AddTable(LuaTable* tbl)
 {
 	tables.insert(tbl);
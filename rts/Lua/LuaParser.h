@@ -131,6 +131,15 @@ class LuaParser {
 
 		bool Execute();
 
+		/**
+		 * Binary snapshot of the root table (booleans, numbers, strings and
+		 * tables only), so an unchanged file need not be executed again.
+		 * LoadCache replaces Execute, both take real (not VFS) paths and
+		 * return false if the cache can not be written or read.
+		 */
+		bool SaveCache(const string& cacheFile);
+		bool LoadCache(const string& cacheFile);
+
 		bool IsValid() const { return (L != NULL); }
 
 		LuaTable GetRoot();
@@ -56,6 +56,7 @@ bool LuaPathFinder::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetPathNodeCosts);
 	REGISTER_LUA_CFUNC(SetPathNodeCost);
 	REGISTER_LUA_CFUNC(GetPathNodeCost);
+	REGISTER_LUA_CFUNC(GetPathCacheStats);
 
 	return true;
 }
@@ -368,5 +369,21 @@ int LuaPathFinder::GetPathNodeCost(lua_State* L)
 	return 1;
 }
 
+int LuaPathFinder::GetPathCacheStats(lua_State* L)
+{
+	const PathCacheStats stats = pathManager->GetPathCacheStats(CLuaHandle::GetHandleSynced(L));
+
+	lua_createtable(L, 0, 8);
+	LuaPushNamedNumber(L, "hits",           stats.numHits);
+	LuaPushNamedNumber(L, "misses",         stats.numMisses);
+	LuaPushNamedNumber(L, "evictions",      stats.numEvictions);
+	LuaPushNamedNumber(L, "expirations",    stats.numExpirations);
+	LuaPushNamedNumber(L, "hashCollisions", stats.numHashCollisions);
+	LuaPushNamedNumber(L, "numItems",       stats.numItems);
+	LuaPushNamedNumber(L, "memUsage",       stats.memUsage);
+	LuaPushNamedNumber(L, "memBudget",      stats.memBudget);
+	return 1;
+}
+
 /******************************************************************************/
 /******************************************************************************/
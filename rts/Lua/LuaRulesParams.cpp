@@ -8,5 +8,7 @@ CR_BIND(Param,);
 CR_REG_METADATA(Param, (
 	CR_MEMBER(los),
 	CR_MEMBER(valueInt),
-	CR_MEMBER(valueString)
+	CR_MEMBER(valueString),
+	CR_MEMBER(name),
+	CR_MEMBER(lastChange)
 ));
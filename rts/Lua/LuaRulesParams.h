@@ -28,11 +28,16 @@ namespace LuaRulesParams
 	struct Param {
 		CR_DECLARE_STRUCT(Param);
 
-		Param() : los(RULESPARAMLOS_PRIVATE),valueInt(0.0f) {};
+		Param() : los(RULESPARAMLOS_PRIVATE),valueInt(0.0f),lastChange(-1) {};
 
 		int   los;
 		float valueInt;
 		std::string valueString;
+
+		//! key under which the param is stored in the HashMap (avoids reverse lookups)
+		std::string name;
+		//! gs->frameNum of the last set that changed value or los
+		int lastChange;
 	};
 
 	typedef std::vector<Param>         Params;
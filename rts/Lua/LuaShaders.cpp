@@ -12,6 +12,8 @@
 
 #include "Game/Camera.h"
 #include "Rendering/ShadowHandler.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "System/CRC.h"
 #include "System/Log/ILog.h"
 #include "System/Util.h"
 
@@ -389,6 +391,27 @@ static void ApplyGeometryParameters(lua_State* L, int table, GLuint prog)
 }
 
 
+static unsigned int GetSourceHash(const vector<string>& defs, const vector<string>& vertSrcs, const vector<string>& fragSrcs)
+{
+	const vector<string>* srcs[3] = {&defs, &vertSrcs, &fragSrcs};
+
+	CRC crc;
+
+	for (unsigned int n = 0; n < 3; n++) {
+		for (unsigned int i = 0; i < srcs[n]->size(); i++) {
+			crc.Update((*srcs[n])[i].data(), (*srcs[n])[i].size());
+		}
+
+		// vertex and fragment parts both get the definitions
+		// prepended, keep them apart by their separate counts
+		crc << n;
+		crc << (unsigned int) srcs[n]->size();
+	}
+
+	return crc.GetDigest();
+}
+
+
 int LuaShaders::CreateShader(lua_State* L)
 {
 	const int args = lua_gettop(L);
@@ -413,6 +436,27 @@ int LuaShaders::CreateShader(lua_State* L)
 	if (vertSrcs.empty() && fragSrcs.empty() && geomSrcs.empty())
 		return 0;
 
+	// geometry-shader parameters come from the table and are baked into
+	// the binary, so only cache programs that do not have such a stage
+	const bool useBinary = (geomSrcs.empty() && shaderHandler->UseProgramBinaries());
+	const unsigned int srcHash = useBinary? GetSourceHash(shdrDefs, vertSrcs, fragSrcs): 0;
+
+	if (useBinary) {
+		const GLuint prog = glCreateProgram();
+
+		if (shaderHandler->LoadProgramBinary(prog, srcHash)) {
+			Program p;
+			p.id = prog;
+
+			ParseUniformSetupTables(L, 1, prog);
+
+			lua_pushnumber(L, CLuaHandle::GetActiveShaders(L).AddProgram(p));
+			return 1;
+		}
+
+		glDeleteProgram(prog);
+	}
+
 	bool success;
 	const GLuint vertObj = CompileObject(L, shdrDefs, vertSrcs, GL_VERTEX_SHADER, success);
 
@@ -453,6 +497,9 @@ int LuaShaders::CreateShader(lua_State* L)
 		p.objects.push_back(Object(fragObj, GL_FRAGMENT_SHADER));
 	}
 
+	if (useBinary)
+		shaderHandler->PrepareProgramBinary(prog);
+
 	glLinkProgram(prog);
 
 	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
@@ -470,6 +517,9 @@ int LuaShaders::CreateShader(lua_State* L)
 		return 0;
 	}
 
+	if (useBinary)
+		shaderHandler->SaveProgramBinary(prog, srcHash);
+
 	// Allows setting up uniforms when drawing is disabled
 	// (much more convenient for sampler uniforms, and static
 	//  configuration values)
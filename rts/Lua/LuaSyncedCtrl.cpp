@@ -32,12 +32,14 @@
 #include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/DamageArray.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Misc/Team.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/MoveTypes/AAirMoveType.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/Projectile.h"
@@ -859,6 +861,7 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 			pIndex = params.size();
 			paramsMap[pName] = pIndex;
 			params.push_back(LuaRulesParams::Param());
+			params.back().name = pName;
 		}
 	}
 	else {
@@ -873,13 +876,20 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	}
 
 	LuaRulesParams::Param& param = params[pIndex];
+	const int oldLos = param.los;
+	bool changed = (param.lastChange < 0);
 
 	//! set the value of the parameter
 	if (lua_isnumber(L, valIndex)) {
-		param.valueInt = lua_tofloat(L, valIndex);
+		const float value = lua_tofloat(L, valIndex);
+		changed |= (value != param.valueInt) || !param.valueString.empty();
+		param.valueInt = value;
 		param.valueString.resize(0);
 	} else {
-		param.valueString = lua_tostring(L, valIndex);
+		size_t len = 0;
+		const char* str = lua_tolstring(L, valIndex, &len);
+		changed |= (param.valueString.size() != len) || (param.valueString.compare(0, len, str, len) != 0);
+		param.valueString.assign(str, len);
 	}
 
 	//! set the los checking of the parameter
@@ -920,6 +930,12 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 		param.los = luaL_optint(L, losIndex, param.los);
 	}
 
+	//! re-setting the same value is common, only real changes count
+	//! for Get*RulesParams(..., sinceFrame)
+	if (changed || param.los != oldLos) {
+		param.lastChange = gs->frameNum;
+	}
+
 	return;
 }
 
@@ -2023,7 +2039,7 @@ int LuaSyncedCtrl::SetUnitPieceCollisionVolumeData(lua_State* L)
 	if (unit == NULL)
 		return 0;
 
-	const LocalModel* localModel = unit->localModel;
+	LocalModel* localModel = unit->localModel;
 	const unsigned int pieceIndex = luaL_checkint(L, 2);
 
 	if (pieceIndex >= localModel->pieces.size())
@@ -2041,6 +2057,9 @@ int LuaSyncedCtrl::SetUnitPieceCollisionVolumeData(lua_State* L)
 	// piece volumes are not allowed to use discrete hit-testing
 	vol->InitShape(scales, offset, vType, CollisionVolume::COLVOL_HITTEST_CONT, pAxis);
 	vol->SetIgnoreHits(!luaL_checkboolean(L, 3));
+
+	lmp->CollisionVolumeChanged();
+	localModel->PieceUpdated(pieceIndex);
 	return 0;
 }
 
@@ -3512,6 +3531,7 @@ int LuaSyncedCtrl::SetMapSquareTerrainType(lua_State* L)
 	const int ntt = luaL_checkint(L, 3);
 
 	readMap->GetTypeMapSynced()[tz * gs->hmapx + tx] = std::max(0, std::min(ntt, (CMapInfo::NUM_TERRAIN_TYPES - 1)));
+	CMoveMath::UpdateSpeedModTables(tx, tz, tx, tz);
 	pathManager->TerrainChange(hx, hz,  hx + 1, hz + 1,  TERRAINCHANGE_SQUARE_TYPEMAP_INDEX);
 
 	lua_pushnumber(L, ott);
@@ -3561,6 +3581,7 @@ int LuaSyncedCtrl::SetTerrainTypeData(lua_State* L)
 	for (int tx = 0; tx < gs->hmapx; tx++) {
 		for (int tz = 0; tz < gs->hmapy; tz++) {
 			if (typeMap[tz * gs->hmapx + tx] == tti) {
+				CMoveMath::UpdateSpeedModTables(tx, tz, tx, tz);
 				pathManager->TerrainChange((tx << 1), (tz << 1),  (tx << 1) + 1, (tz << 1) + 1,  TERRAINCHANGE_TYPEMAP_SPEED_VALUES);
 			}
 		}
@@ -32,6 +32,7 @@
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
+#include "Sim/Misc/ThreatMap.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/MoveTypes/StrafeAirMoveType.h"
 #include "Sim/MoveTypes/GroundMoveType.h"
@@ -212,6 +213,9 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitDirection);
 	REGISTER_LUA_CFUNC(GetUnitHeading);
 	REGISTER_LUA_CFUNC(GetUnitVelocity);
+	REGISTER_LUA_CFUNC(GetUnitsPositions);
+	REGISTER_LUA_CFUNC(GetUnitsVelocities);
+	REGISTER_LUA_CFUNC(GetUnitsHealth);
 	REGISTER_LUA_CFUNC(GetUnitBuildFacing);
 	REGISTER_LUA_CFUNC(GetUnitIsBuilding);
 	REGISTER_LUA_CFUNC(GetUnitCurrentBuildPower);
@@ -301,6 +305,8 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(IsPosInLos);
 	REGISTER_LUA_CFUNC(IsPosInRadar);
 	REGISTER_LUA_CFUNC(IsPosInAirLos);
+	REGISTER_LUA_CFUNC(GetThreatMapValue);
+	REGISTER_LUA_CFUNC(GetThreatMap);
 	REGISTER_LUA_CFUNC(GetClosestValidPosition);
 
 	REGISTER_LUA_CFUNC(GetUnitPieceMap);
@@ -663,34 +669,43 @@ static inline void CheckNoArgs(lua_State* L, const char* funcName)
 
 /******************************************************************************/
 
+/**
+ * With sinceFrame >= 0 only params changed after that frame are pushed,
+ * and nothing at all if there are none. The indices are stable (params
+ * are never removed), so they can be cached and used in place of names.
+ */
 static int PushRulesParams(lua_State* L, const char* caller,
                           const LuaRulesParams::Params& params,
-                          const LuaRulesParams::HashMap& paramsMap,
-                          const int losStatus)
+                          const int losStatus,
+                          const int sinceFrame = -1)
 {
-	lua_newtable(L);
 	const int pCount = (int)params.size();
+
+	if (sinceFrame >= 0) {
+		int i = 0;
+		for (; i < pCount; i++) {
+			if ((params[i].los & losStatus) && (params[i].lastChange > sinceFrame))
+				break;
+		}
+		if (i == pCount)
+			return 0;
+	}
+
+	lua_newtable(L);
 	for (int i = 0; i < pCount; i++) {
 		const LuaRulesParams::Param& param = params[i];
 		if (!(param.los & losStatus))
 			continue;
+		if ((sinceFrame >= 0) && (param.lastChange <= sinceFrame))
+			continue;
 
 		lua_pushnumber(L, i + 1);
 		lua_newtable(L);
 
-		LuaRulesParams::HashMap::const_iterator it;
-		string name = "";
-		for (it = paramsMap.begin(); it != paramsMap.end(); ++it) {
-			if (it->second == i) {
-				name = it->first;
-				break;
-			}
-		}
-
 		if (!param.valueString.empty()) {
-			LuaPushNamedString(L, name, param.valueString);
+			LuaPushNamedString(L, param.name, param.valueString);
 		} else {
-			LuaPushNamedNumber(L, name, param.valueInt);
+			LuaPushNamedNumber(L, param.name, param.valueInt);
 		}
 		lua_rawset(L, -3);
 	}
@@ -868,13 +883,12 @@ int LuaSyncedRead::GetWind(lua_State* L)
 
 int LuaSyncedRead::GetGameRulesParams(lua_State* L)
 {
-	const LuaRulesParams::Params&  params    = CLuaHandleSynced::GetGameParams();
-	const LuaRulesParams::HashMap& paramsMap = CLuaHandleSynced::GetGameParamsMap();
+	const LuaRulesParams::Params& params = CLuaHandleSynced::GetGameParams();
 
 	//! always readable for all
 	const int losMask = LuaRulesParams::RULESPARAMLOS_PRIVATE_MASK;
 
-	return PushRulesParams(L, __FUNCTION__, params, paramsMap, losMask);
+	return PushRulesParams(L, __FUNCTION__, params, losMask, luaL_optint(L, 1, -1));
 }
 
 
@@ -1269,10 +1283,9 @@ int LuaSyncedRead::GetTeamRulesParams(lua_State* L)
 		losMask |= LuaRulesParams::RULESPARAMLOS_ALLIED_MASK;
 	}
 
-	const LuaRulesParams::Params&  params    = team->modParams;
-	const LuaRulesParams::HashMap& paramsMap = team->modParamsMap;
+	const LuaRulesParams::Params& params = team->modParams;
 
-	return PushRulesParams(L, __FUNCTION__, params, paramsMap, losMask);
+	return PushRulesParams(L, __FUNCTION__, params, losMask, luaL_optint(L, 2, -1));
 }
 
 
@@ -1317,8 +1330,7 @@ int LuaSyncedRead::GetTeamStatsHistory(lua_State* L)
 		return 1;
 	}
 
-	const std::list<CTeam::Statistics>& teamStats = team->statHistory;
-	std::list<CTeam::Statistics>::const_iterator it = teamStats.begin();
+	const std::deque<CTeam::Statistics>& teamStats = team->statHistory;
 	const int statCount = teamStats.size();
 
 	int start = 0;
@@ -1333,13 +1345,11 @@ int LuaSyncedRead::GetTeamStatsHistory(lua_State* L)
 		end = max(0, min(statCount - 1, end));
 	}
 
-	std::advance(it, start);
-
 	lua_newtable(L);
 	if (statCount > 0) {
 		int count = 1;
-		for (int i = start; i <= end; ++i, ++it) {
-			const CTeam::Statistics& stats = *it;
+		for (int i = start; i <= end; ++i) {
+			const CTeam::Statistics& stats = teamStats[i];
 			lua_newtable(L); {
 				if (i+1 == teamStats.size()) {
 					//! the `stats.frame` var indicates the frame when a new entry needs to get added,
@@ -1564,6 +1574,42 @@ int LuaSyncedRead::ArePlayersAllied(lua_State* L)
 }
 
 
+/******************************************************************************/
+/******************************************************************************/
+//
+//  Result tables
+//
+//  Queries that are polled every frame can be given a table to (re)fill
+//  instead of creating a new one per call, which keeps Lua's GC quiet.
+//
+
+static inline void PushResultTable(lua_State* L, int index, int sizeHint)
+{
+	if (lua_istable(L, index)) {
+		lua_pushvalue(L, index);
+	} else {
+		lua_createtable(L, sizeHint, 0);
+	}
+}
+
+
+/// nils out whatever a reused table (on top of the stack) held beyond <count>
+static void ClearResultTableTail(lua_State* L, int count)
+{
+	for (int i = count + 1; ; i++) {
+		lua_rawgeti(L, -1, i);
+		const bool isNil = lua_isnil(L, -1);
+		lua_pop(L, 1);
+
+		if (isNil)
+			break;
+
+		lua_pushnil(L);
+		lua_rawseti(L, -2, i);
+	}
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 //
@@ -1572,17 +1618,16 @@ int LuaSyncedRead::ArePlayersAllied(lua_State* L)
 
 int LuaSyncedRead::GetAllUnits(lua_State* L)
 {
-	CheckNoArgs(L, __FUNCTION__);
 	int count = 1;
-	std::list<CUnit*>::const_iterator uit;
+	std::vector<CUnit*>::const_iterator uit;
 	if (CLuaHandle::GetHandleFullRead(L)) {
-		lua_createtable(L, unitHandler->activeUnits.size(), 0);
+		PushResultTable(L, 1, unitHandler->activeUnits.size());
 		for (uit = unitHandler->activeUnits.begin(); uit != unitHandler->activeUnits.end(); ++uit) {
 			lua_pushnumber(L, (*uit)->id);
 			lua_rawseti(L, -2, count++);
 		}
 	} else {
-		lua_newtable(L);
+		PushResultTable(L, 1, 0);
 		for (uit = unitHandler->activeUnits.begin(); uit != unitHandler->activeUnits.end(); ++uit) {
 			if (IsUnitVisible(L, *uit)) {
 				lua_pushnumber(L, (*uit)->id);
@@ -1591,6 +1636,7 @@ int LuaSyncedRead::GetAllUnits(lua_State* L)
 		}
 	}
 
+	ClearResultTableTail(L, count - 1);
 	return 1;
 }
 
@@ -2049,7 +2095,7 @@ int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 	vector<CUnit*>::const_iterator it;
 	const vector<CUnit*> &units = quadField->GetUnitsExact(mins, maxs);
 
-	lua_newtable(L);
+	PushResultTable(L, 6, units.size());
 	int count = 0;
 
 	if (allegiance >= 0) {
@@ -2073,6 +2119,7 @@ int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 		LOOP_UNIT_CONTAINER(VISIBLE_TEST, RECTANGLE_TEST);
 	}
 
+	ClearResultTableTail(L, count);
 	return 1;
 }
 
@@ -2152,7 +2199,7 @@ int LuaSyncedRead::GetUnitsInCylinder(lua_State* L)
 	vector<CUnit*>::const_iterator it;
 	const vector<CUnit*> &units = quadField->GetUnitsExact(mins, maxs);
 
-	lua_newtable(L);
+	PushResultTable(L, 5, units.size());
 	int count = 0;
 
 	if (allegiance >= 0) {
@@ -2176,6 +2223,7 @@ int LuaSyncedRead::GetUnitsInCylinder(lua_State* L)
 		LOOP_UNIT_CONTAINER(VISIBLE_TEST, CYLINDER_TEST);
 	}
 
+	ClearResultTableTail(L, count);
 	return 1;
 }
 
@@ -3019,6 +3067,118 @@ int LuaSyncedRead::GetUnitVelocity(lua_State* L)
 }
 
 
+/******************************************************************************/
+//
+//  Bulk unit attribute queries: one flat array with <stride> values per
+//  unitID of the input array (by input order), units that can not be read
+//  have their values set to false.
+//
+
+typedef bool (*BulkUnitGetter)(lua_State* L, const CUnit* unit, float* values);
+
+static int GetUnitsBulk(lua_State* L, int stride, BulkUnitGetter getter)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const int numUnits = lua_objlen(L, 1);
+	float values[8];
+
+	assert(stride <= 8);
+	PushResultTable(L, 2, numUnits * stride);
+
+	for (int n = 0; n < numUnits; n++) {
+		lua_rawgeti(L, 1, n + 1);
+		const CUnit* unit = ParseRawUnit(L, NULL, -1);
+		lua_pop(L, 1);
+
+		const bool valid = (unit != NULL && getter(L, unit, values));
+
+		for (int k = 0; k < stride; k++) {
+			if (valid) {
+				lua_pushnumber(L, values[k]);
+			} else {
+				lua_pushboolean(L, false);
+			}
+			lua_rawseti(L, -2, n * stride + k + 1);
+		}
+	}
+
+	ClearResultTableTail(L, numUnits * stride);
+	return 1;
+}
+
+
+static bool GetBulkUnitPosition(lua_State* L, const CUnit* unit, float* values)
+{
+	if (!IsUnitVisible(L, unit))
+		return false;
+
+	float3 pos = unit->pos;
+
+	if (!IsAllyUnit(L, unit)) {
+		pos += unit->GetErrorPos(CLuaHandle::GetHandleReadAllyTeam(L));
+		pos -= unit->midPos;
+	}
+
+	values[0] = pos.x;
+	values[1] = pos.y;
+	values[2] = pos.z;
+	return true;
+}
+
+static bool GetBulkUnitVelocity(lua_State* L, const CUnit* unit, float* values)
+{
+	if (!IsUnitInLos(L, unit))
+		return false;
+
+	values[0] = unit->speed.x;
+	values[1] = unit->speed.y;
+	values[2] = unit->speed.z;
+	values[3] = unit->speed.w;
+	return true;
+}
+
+static bool GetBulkUnitHealth(lua_State* L, const CUnit* unit, float* values)
+{
+	if (!IsUnitInLos(L, unit))
+		return false;
+
+	const UnitDef* ud = unit->unitDef;
+	const bool enemyUnit = IsEnemyUnit(L, unit);
+
+	if (ud->hideDamage && enemyUnit)
+		return false;
+
+	const float scale = (!enemyUnit || (ud->decoyDef == NULL))? 1.0f: (ud->decoyDef->health / ud->health);
+
+	values[0] = scale * unit->health;
+	values[1] = scale * unit->maxHealth;
+	values[2] = scale * unit->paralyzeDamage;
+	values[3] = unit->captureProgress;
+	values[4] = unit->buildProgress;
+	return true;
+}
+
+
+int LuaSyncedRead::GetUnitsPositions(lua_State* L)
+{
+	// x, y, z (base-position, see GetUnitPosition)
+	return (GetUnitsBulk(L, 3, GetBulkUnitPosition));
+}
+
+int LuaSyncedRead::GetUnitsVelocities(lua_State* L)
+{
+	// x, y, z, speed (see GetUnitVelocity)
+	return (GetUnitsBulk(L, 4, GetBulkUnitVelocity));
+}
+
+int LuaSyncedRead::GetUnitsHealth(lua_State* L)
+{
+	// health, maxHealth, paralyzeDamage, captureProgress, buildProgress (see GetUnitHealth)
+	return (GetUnitsBulk(L, 5, GetBulkUnitHealth));
+}
+
+
 int LuaSyncedRead::GetUnitBuildFacing(lua_State* L)
 {
 	CUnit* unit = ParseInLosUnit(L, __FUNCTION__, 1);
@@ -4267,10 +4427,9 @@ int LuaSyncedRead::GetUnitRulesParams(lua_State* L)
 		losMask |= LuaRulesParams::RULESPARAMLOS_INRADAR_MASK;
 	}
 
-	const LuaRulesParams::Params&  params    = unit->modParams;
-	const LuaRulesParams::HashMap& paramsMap = unit->modParamsMap;
+	const LuaRulesParams::Params& params = unit->modParams;
 
-	return PushRulesParams(L, __FUNCTION__, params, paramsMap, losMask);
+	return PushRulesParams(L, __FUNCTION__, params, losMask, luaL_optint(L, 2, -1));
 }
 
 
@@ -5185,6 +5344,57 @@ int LuaSyncedRead::IsPosInAirLos(lua_State* L)
 }
 
 
+static int GetThreatMapAllyTeam(lua_State* L, int arg)
+{
+	const int allyTeamID = GetEffectiveLosAllyTeam(L, arg);
+
+	if (allyTeamID < 0) {
+		luaL_error(L, "Invalid allyTeam");
+	}
+	return allyTeamID;
+}
+
+int LuaSyncedRead::GetThreatMapValue(lua_State* L)
+{
+	const float3 pos(luaL_checkfloat(L, 1), 0.0f, luaL_checkfloat(L, 2));
+
+	const int layer = luaL_checkint(L, 3);
+	const int allyTeamID = GetThreatMapAllyTeam(L, 4);
+
+	if (layer < 0 || layer >= CThreatMap::NUM_LAYERS) {
+		luaL_error(L, "Invalid threat-map layer");
+	}
+
+	lua_pushnumber(L, threatMap->GetLayer(allyTeamID, layer)[threatMap->GetCell(pos)]);
+	return 1;
+}
+
+int LuaSyncedRead::GetThreatMap(lua_State* L)
+{
+	const int layer = luaL_checkint(L, 1);
+	const int allyTeamID = GetThreatMapAllyTeam(L, 2);
+
+	if (layer < 0 || layer >= CThreatMap::NUM_LAYERS) {
+		luaL_error(L, "Invalid threat-map layer");
+	}
+
+	const int numCells = threatMap->GetSizeX() * threatMap->GetSizeZ();
+	const float* values = threatMap->GetLayer(allyTeamID, layer);
+
+	lua_pushnumber(L, threatMap->GetSizeX());
+	lua_pushnumber(L, threatMap->GetSizeZ());
+	lua_pushnumber(L, CThreatMap::CELL_SIZE);
+	lua_createtable(L, numCells, 0);
+
+	for (int i = 0; i < numCells; i++) {
+		lua_pushnumber(L, values[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 4;
+}
+
+
 /******************************************************************************/
 
 int LuaSyncedRead::GetClosestValidPosition(lua_State* L)
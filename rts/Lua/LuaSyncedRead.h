@@ -119,6 +119,9 @@ class LuaSyncedRead {
 		static int GetUnitDirection(lua_State* L);
 		static int GetUnitHeading(lua_State* L);
 		static int GetUnitVelocity(lua_State* L);
+		static int GetUnitsPositions(lua_State* L);
+		static int GetUnitsVelocities(lua_State* L);
+		static int GetUnitsHealth(lua_State* L);
 		static int GetUnitBuildFacing(lua_State* L);
 		static int GetUnitIsBuilding(lua_State* L);
 		static int GetUnitCurrentBuildPower(lua_State* L);
@@ -214,6 +217,8 @@ class LuaSyncedRead {
 		static int IsPosInLos(lua_State* L);
 		static int IsPosInRadar(lua_State* L);
 		static int IsPosInAirLos(lua_State* L);
+		static int GetThreatMapValue(lua_State* L);
+		static int GetThreatMap(lua_State* L);
 		static int GetClosestValidPosition(lua_State* L);
 
 		static int GetUnitPieceMap(lua_State* L);
@@ -3,8 +3,14 @@
 
 #include "LuaTextures.h"
 
+#include "System/Config/ConfigHandler.h"
 #include "System/Util.h"
 
+#include <algorithm>
+
+CONFIG(int, LuaTexturePoolSize).defaultValue(64).minimumValue(0)
+	.description("Megabytes of VRAM each Lua handle may keep in deleted textures to hand them back out to gl.CreateTexture calls with the same size and format.");
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -12,54 +18,45 @@
 LuaTextures::LuaTextures()
 {
 	lastCode = 0;
+	usedBytes = 0;
+	pooledBytes = 0;
+	maxPooledBytes = std::max(0, configHandler->GetInt("LuaTexturePoolSize")) * 1024 * 1024;
 }
 
 
 LuaTextures::~LuaTextures()
 {
-	map<string, Texture>::iterator it;
-	for (it = textures.begin(); it != textures.end(); ++it) {
-		const Texture& tex = it->second;
-		glDeleteTextures(1, &tex.id);
-		if (GLEW_EXT_framebuffer_object) {
-			glDeleteFramebuffersEXT(1, &tex.fbo);
-			glDeleteRenderbuffersEXT(1, &tex.fboDepth);
-		}
-	}
-	textures.clear();
+	FreeAll();
 }
 
 
-string LuaTextures::Create(const Texture& tex)
-{	
-	GLint currentBinding;
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentBinding);
-
-	GLuint texID;
-	glGenTextures(1, &texID);
-	glBindTexture(tex.target, texID);
-
-	GLenum dataFormat = GL_RGBA;
-	GLenum dataType   = GL_UNSIGNED_BYTE;
-	if ((tex.format == GL_DEPTH_COMPONENT) ||
-	    (tex.format == GL_DEPTH_COMPONENT16) ||
-	    (tex.format == GL_DEPTH_COMPONENT24) ||
-	    (tex.format == GL_DEPTH_COMPONENT32)) {
-		dataFormat = GL_DEPTH_COMPONENT;
-		dataType = GL_FLOAT;
+size_t LuaTextures::GetTextureBytes(const Texture& tex)
+{
+	size_t bpp = 4;
+
+	switch (tex.format) {
+		case GL_ALPHA8:
+		case GL_LUMINANCE8:
+		case GL_INTENSITY8: { bpp =  1; } break;
+		case GL_DEPTH_COMPONENT16:
+		case GL_LUMINANCE8_ALPHA8: { bpp =  2; } break;
+		case GL_RGBA16:
+		case GL_RGBA16F_ARB: { bpp =  8; } break;
+		case GL_RGB32F_ARB:
+		case GL_RGBA32F_ARB: { bpp = 16; } break;
+		default: {} break;
 	}
 
-	glClearErrors();
-	glTexImage2D(tex.target, 0, tex.format,
-	             tex.xsize, tex.ysize, tex.border,
-	             dataFormat, dataType, NULL);
-	const GLenum err = glGetError();
-	if (err != GL_NO_ERROR) {
-		glDeleteTextures(1, &texID);
-		glBindTexture(GL_TEXTURE_2D, currentBinding);
-		return string("");
-	}
+	const size_t xsize = tex.xsize + tex.border * 2;
+	const size_t ysize = tex.ysize + tex.border * 2;
 
+	// the depth renderbuffer is always GL_DEPTH_COMPONENT24
+	return (xsize * ysize * bpp + ((tex.fboDepth != 0)? (tex.xsize * tex.ysize * 4): 0));
+}
+
+
+void LuaTextures::ApplyParams(const Texture& tex)
+{
 	glTexParameteri(tex.target, GL_TEXTURE_WRAP_S, tex.wrap_s);
 	glTexParameteri(tex.target, GL_TEXTURE_WRAP_T, tex.wrap_t);
 	glTexParameteri(tex.target, GL_TEXTURE_WRAP_R, tex.wrap_r);
@@ -67,64 +64,186 @@ string LuaTextures::Create(const Texture& tex)
 	glTexParameteri(tex.target, GL_TEXTURE_MAG_FILTER, tex.mag_filter);
 	glTexParameteri(tex.target, GL_TEXTURE_COMPARE_MODE_ARB, GL_NONE);
 
-	if ((tex.aniso != 0.0f) && GLEW_EXT_texture_filter_anisotropic) {
+	if (GLEW_EXT_texture_filter_anisotropic) {
 		static GLfloat maxAniso = -1.0f;
 		if (maxAniso == -1.0f) {
 			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAniso);
 		}
+		// a recycled texture might still have the anisotropy of its previous user
 		const GLfloat aniso = std::max(1.0f, std::min(maxAniso, tex.aniso));
 		glTexParameterf(tex.target, GL_TEXTURE_MAX_ANISOTROPY_EXT, aniso);
 	}
+}
+
+
+void LuaTextures::Delete(const Texture& tex)
+{
+	glDeleteTextures(1, &tex.id);
+	if (GLEW_EXT_framebuffer_object) {
+		glDeleteFramebuffersEXT(1, &tex.fbo);
+		glDeleteRenderbuffersEXT(1, &tex.fboDepth);
+	}
+}
+
+
+bool LuaTextures::ReuseFromPool(Texture& tex)
+{
+	std::list<Texture>::iterator it;
 
-	glBindTexture(GL_TEXTURE_2D, currentBinding); // revert the current binding
+	for (it = pool.begin(); it != pool.end(); ++it) {
+		const Texture& p = *it;
 
-	GLuint fbo = 0;
-	GLuint fboDepth = 0;
+		if (p.target != tex.target || p.format != tex.format)
+			continue;
+		if (p.xsize != tex.xsize || p.ysize != tex.ysize || p.border != tex.border)
+			continue;
+		// FBO and depth buffer are kept attached while pooled
+		if ((p.fbo != 0) != (tex.fbo != 0) || (p.fboDepth != 0) != (tex.fboDepth != 0))
+			continue;
 
-	if (tex.fbo != 0) {
-		if (!GLEW_EXT_framebuffer_object) {
+		tex.id = p.id;
+		tex.fbo = p.fbo;
+		tex.fboDepth = p.fboDepth;
+
+		pooledBytes -= GetTextureBytes(p);
+		pool.erase(it);
+
+		GLint currentBinding;
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentBinding);
+		glBindTexture(tex.target, tex.id);
+		ApplyParams(tex);
+		glBindTexture(GL_TEXTURE_2D, currentBinding);
+		return true;
+	}
+
+	return false;
+}
+
+
+void LuaTextures::AddToPool(const Texture& tex)
+{
+	const size_t texBytes = GetTextureBytes(tex);
+
+	if (texBytes > maxPooledBytes) {
+		Delete(tex);
+		return;
+	}
+
+	pool.push_front(tex);
+	pooledBytes += texBytes;
+
+	// evict the least recently freed ones
+	while (pooledBytes > maxPooledBytes) {
+		pooledBytes -= GetTextureBytes(pool.back());
+		Delete(pool.back());
+		pool.pop_back();
+	}
+}
+
+
+void LuaTextures::FreePool()
+{
+	std::list<Texture>::const_iterator it;
+	for (it = pool.begin(); it != pool.end(); ++it) {
+		Delete(*it);
+	}
+	pool.clear();
+	pooledBytes = 0;
+}
+
+
+string LuaTextures::Create(const Texture& tex)
+{
+	Texture newTex = tex;
+
+	if (!ReuseFromPool(newTex)) {
+		newTex.id = 0;
+		newTex.fbo = 0;
+		newTex.fboDepth = 0;
+	}
+
+	if (newTex.id == 0) {
+		GLint currentBinding;
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentBinding);
+
+		GLuint texID;
+		glGenTextures(1, &texID);
+		glBindTexture(tex.target, texID);
+
+		GLenum dataFormat = GL_RGBA;
+		GLenum dataType   = GL_UNSIGNED_BYTE;
+		if ((tex.format == GL_DEPTH_COMPONENT) ||
+		    (tex.format == GL_DEPTH_COMPONENT16) ||
+		    (tex.format == GL_DEPTH_COMPONENT24) ||
+		    (tex.format == GL_DEPTH_COMPONENT32)) {
+			dataFormat = GL_DEPTH_COMPONENT;
+			dataType = GL_FLOAT;
+		}
+
+		glClearErrors();
+		glTexImage2D(tex.target, 0, tex.format,
+		             tex.xsize, tex.ysize, tex.border,
+		             dataFormat, dataType, NULL);
+		const GLenum err = glGetError();
+		if (err != GL_NO_ERROR) {
 			glDeleteTextures(1, &texID);
+			glBindTexture(GL_TEXTURE_2D, currentBinding);
 			return string("");
 		}
-		GLint currentFBO;
-		glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &currentFBO);
-
-		glGenFramebuffersEXT(1, &fbo);
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
-
-		if (tex.fboDepth != 0) {
-			glGenRenderbuffersEXT(1, &fboDepth);
-			glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, fboDepth);
-			glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24,
-			                         tex.xsize, tex.ysize);
-			glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT,
-			                             GL_RENDERBUFFER_EXT, fboDepth);
-		}
 
-		glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT,
-		                          tex.target, texID, 0);
+		ApplyParams(tex);
+
+		glBindTexture(GL_TEXTURE_2D, currentBinding); // revert the current binding
+
+		GLuint fbo = 0;
+		GLuint fboDepth = 0;
+
+		if (tex.fbo != 0) {
+			if (!GLEW_EXT_framebuffer_object) {
+				glDeleteTextures(1, &texID);
+				return string("");
+			}
+			GLint currentFBO;
+			glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &currentFBO);
+
+			glGenFramebuffersEXT(1, &fbo);
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+
+			if (tex.fboDepth != 0) {
+				glGenRenderbuffersEXT(1, &fboDepth);
+				glBindRenderbufferEXT(GL_RENDERBUFFER_EXT, fboDepth);
+				glRenderbufferStorageEXT(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24,
+				                         tex.xsize, tex.ysize);
+				glFramebufferRenderbufferEXT(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT,
+				                             GL_RENDERBUFFER_EXT, fboDepth);
+			}
+
+			glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT,
+			                          tex.target, texID, 0);
+
+			const GLenum status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
+			if (status != GL_FRAMEBUFFER_COMPLETE_EXT) {
+				glDeleteTextures(1, &texID);
+				glDeleteFramebuffersEXT(1, &fbo);
+				glDeleteRenderbuffersEXT(1, &fboDepth);
+				glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, currentFBO);
+				return string("");
+			}
 
-		const GLenum status = glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
-		if (status != GL_FRAMEBUFFER_COMPLETE_EXT) {
-			glDeleteTextures(1, &texID);
-			glDeleteFramebuffersEXT(1, &fbo);
-			glDeleteRenderbuffersEXT(1, &fboDepth);
 			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, currentFBO);
-			return string("");
 		}
 
-		glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, currentFBO);
+		newTex.id = texID;
+		newTex.fbo = fbo;
+		newTex.fboDepth = fboDepth;
 	}
 
 	lastCode++;
 	char buf[64];
 	SNPRINTF(buf, sizeof(buf), "%c%i", prefix, lastCode);
-	Texture newTex = tex;
-	newTex.id = texID;
 	newTex.name = buf;
-	newTex.fbo = fbo;
-	newTex.fboDepth = fboDepth;
 	textures[newTex.name] = newTex;
+	usedBytes += GetTextureBytes(newTex);
 
 	return newTex.name;
 }
@@ -147,11 +266,8 @@ bool LuaTextures::Free(const string& name)
 	map<string, Texture>::iterator it = textures.find(name);
 	if (it != textures.end()) {
 		const Texture& tex = it->second;
-		glDeleteTextures(1, &tex.id);
-		if (GLEW_EXT_framebuffer_object) {
-			glDeleteFramebuffersEXT(1, &tex.fbo);
-			glDeleteRenderbuffersEXT(1, &tex.fboDepth);
-		}
+		usedBytes -= GetTextureBytes(tex);
+		AddToPool(tex);
 		textures.erase(it);
 		return true;
 	}
@@ -169,10 +285,12 @@ bool LuaTextures::FreeFBO(const string& name)
 		return false;
 	}
 	Texture& tex = it->second;
+	usedBytes -= GetTextureBytes(tex);
 	glDeleteFramebuffersEXT(1, &tex.fbo);
 	glDeleteRenderbuffersEXT(1, &tex.fboDepth);
 	tex.fbo = 0;
 	tex.fboDepth = 0;
+	usedBytes += GetTextureBytes(tex);
 	return true;
 }
 
@@ -181,14 +299,12 @@ void LuaTextures::FreeAll()
 {
 	map<string, Texture>::iterator it;
 	for (it = textures.begin(); it != textures.end(); ++it) {
-		const Texture& tex = it->second;
-		glDeleteTextures(1, &tex.id);
-		if (GLEW_EXT_framebuffer_object) {
-			glDeleteFramebuffersEXT(1, &tex.fbo);
-			glDeleteRenderbuffersEXT(1, &tex.fboDepth);
-		}
+		Delete(it->second);
 	}
 	textures.clear();
+	usedBytes = 0;
+
+	FreePool();
 }
 
 
@@ -5,6 +5,7 @@
 
 #include <string>
 #include <map>
+#include <list>
 using std::string;
 using std::map;
 
@@ -60,9 +61,37 @@ class LuaTextures {
 		void FreeAll();
 		const Texture* GetInfo(const string& name) const;
 
+		/// estimated VRAM held by live textures (including their FBO depth buffers)
+		size_t GetUsedBytes() const { return usedBytes; }
+		/// estimated VRAM held by freed textures kept for reuse
+		size_t GetPooledBytes() const { return pooledBytes; }
+
+		static size_t GetTextureBytes(const Texture& tex);
+
+	private:
+		/// recreates nothing, only re-applies the sampling state of tex
+		static void ApplyParams(const Texture& tex);
+		static void Delete(const Texture& tex);
+
+		bool ReuseFromPool(Texture& tex);
+		void AddToPool(const Texture& tex);
+		void FreePool();
+
 	private:
 		int lastCode;
 		map<string, Texture> textures;
+
+		/**
+		 * Freed textures of this Lua handle, most recently used first.
+		 * Widgets that recreate their render targets on every resize or
+		 * effect toggle get the same GL objects back instead of making
+		 * the driver allocate (and fragment) VRAM each time.
+		 */
+		std::list<Texture> pool;
+
+		size_t usedBytes;
+		size_t pooledBytes;
+		size_t maxPooledBytes;
 };
 
 
@@ -63,6 +63,12 @@ CONFIG(bool, LuaSocketEnabled)
 	.readOnly(true)
 ;
 
+CONFIG(int, LuaUICallInBudget)
+	.defaultValue(0)
+	.minimumValue(0)
+	.description("Milliseconds per second LuaUI may spend in call-ins before its Update and Draw* call-ins are skipped for the rest of that second (0 = unlimited)")
+;
+
 using std::max;
 
 
@@ -129,6 +135,7 @@ CLuaUI::CLuaUI()
 	}
 
 	UpdateTeams();
+	SetCallInBudget(configHandler->GetInt("LuaUICallInBudget"));
 
 	haveShockFront = false;
 	shockFrontMinArea  = 0.0f;
@@ -305,11 +312,7 @@ bool CLuaUI::UnsyncedUpdateCallIn(lua_State *L, const string& name)
 		return false;
 	}
 
-	if (HasCallIn(L, name)) {
-		eventHandler.InsertEvent(this, name);
-	} else {
-		eventHandler.RemoveEvent(this, name);
-	}
+	UpdateEventRegistration(L, name);
 
 	UpdateUnsyncedXCalls(L);
 
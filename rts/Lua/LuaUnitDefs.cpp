@@ -83,6 +83,11 @@ bool LuaUnitDefs::PushEntries(lua_State* L)
 	  InitParamMap();
 	}
 
+	// shared by all proxies, maps each parameter name to its DataElement
+	const int defsTable = lua_gettop(L);
+	LuaUtils::PushParamKeyTable(L, paramMap);
+	const int keyTable = lua_gettop(L);
+
 	const map<string, int>& udMap = unitDefHandler->unitDefIDsByName;
 	map<string, int>::const_iterator udIt;
 	for (udIt = udMap.begin(); udIt != udMap.end(); ++udIt) {
@@ -97,7 +102,8 @@ bool LuaUnitDefs::PushEntries(lua_State* L)
 
 				HSTR_PUSH(L, "__index");
 				lua_pushlightuserdata(L, (void*)ud);
-				lua_pushcclosure(L, UnitDefIndex, 1);
+				lua_pushvalue(L, keyTable);
+				lua_pushcclosure(L, UnitDefIndex, 2);
 				lua_rawset(L, -3); // closure
 
 				HSTR_PUSH(L, "__newindex");
@@ -122,9 +128,11 @@ bool LuaUnitDefs::PushEntries(lua_State* L)
 		lua_pushcfunction(L, Next);
 		lua_rawset(L, -3);
 
-		lua_rawset(L, -3); // proxy table into UnitDefs
+		lua_rawset(L, defsTable); // proxy table into UnitDefs
 	}
 
+	lua_pop(L, 1); // keyTable
+
 	return true;
 }
 
@@ -142,24 +150,17 @@ bool LuaUnitDefs::IsDefaultParam(const string& word)
 
 static int UnitDefIndex(lua_State* L)
 {
+	const DataElement* elemPtr = LuaUtils::GetParamElement(L, lua_upvalueindex(2), 2);
+
 	// not a default value
-	if (!lua_isstring(L, 2)) {
+	if (elemPtr == NULL) {
 		lua_rawget(L, 1);
 		return 1;
 	}
 
-	const char* name = lua_tostring(L, 2);
-	ParamMap::const_iterator it = paramMap.find(name);
-
-	// not a default value
-	if (it == paramMap.end()) {
-	  lua_rawget(L, 1);
-	  return 1;
-	}
-
 	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
 	const UnitDef* ud = static_cast<const UnitDef*>(userData);
-	const DataElement& elem = it->second;
+	const DataElement& elem = *elemPtr;
 	const char* p = ((const char*)ud) + elem.offset;
 	switch (elem.type) {
 		case READONLY_TYPE: {
@@ -186,7 +187,7 @@ static int UnitDefIndex(lua_State* L)
 			return elem.func(L, p);
 		}
 		case ERROR_TYPE: {
-			LOG_L(L_ERROR, "[%s] ERROR_TYPE for key \"%s\" in UnitDefs __index", __FUNCTION__, name);
+			LOG_L(L_ERROR, "[%s] ERROR_TYPE for key \"%s\" in UnitDefs __index", __FUNCTION__, lua_tostring(L, 2));
 			lua_pushnil(L);
 			return 1;
 		}
@@ -40,6 +40,7 @@
 #include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/UnitTypes/TransportUnit.h"
@@ -56,12 +57,14 @@
 #include "System/Log/DefaultFilter.h"
 #include "System/Sound/SoundChannels.h"
 #include "System/Misc/SpringTime.h"
+#include "System/TimeProfiler.h"
 
 #if !defined(HEADLESS) && !defined(NO_SOUND)
 	#include "System/Sound/EFX.h"
 	#include "System/Sound/EFXPresets.h"
 #endif
 
+#include <algorithm>
 #include <set>
 #include <list>
 #include <cctype>
@@ -89,6 +92,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetFrameTimeOffset);
 	REGISTER_LUA_CFUNC(GetLastUpdateSeconds);
 	REGISTER_LUA_CFUNC(GetHasLag);
+	REGISTER_LUA_CFUNC(GetNetFrameBuffer);
 
 	REGISTER_LUA_CFUNC(GetViewGeometry);
 	REGISTER_LUA_CFUNC(GetWindowGeometry);
@@ -133,6 +137,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetSelectedUnitsCount);
 
 	REGISTER_LUA_CFUNC(IsGUIHidden);
+	REGISTER_LUA_CFUNC(IsCatchingUp);
 	REGISTER_LUA_CFUNC(HaveShadows);
 	REGISTER_LUA_CFUNC(HaveAdvShading);
 	REGISTER_LUA_CFUNC(GetWaterMode);
@@ -158,6 +163,8 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	// moved from LuaUI
 
 	REGISTER_LUA_CFUNC(GetFPS);
+	REGISTER_LUA_CFUNC(GetProfilerTimers);
+	REGISTER_LUA_CFUNC(GetEngineCounters);
 
 	REGISTER_LUA_CFUNC(GetActiveCommand);
 	REGISTER_LUA_CFUNC(GetDefaultCommand);
@@ -447,6 +454,19 @@ int LuaUnsyncedRead::GetHasLag(lua_State* L)
 	return 1;
 }
 
+int LuaUnsyncedRead::GetNetFrameBuffer(lua_State* L)
+{
+	CheckNoArgs(L, __FUNCTION__);
+
+	if (game == NULL)
+		return 0;
+
+	lua_pushnumber(L, game->netFrameBufferDepth);
+	lua_pushnumber(L, game->netFrameBufferTarget);
+	lua_pushnumber(L, game->netFrameBufferAvgDepth);
+	return 3;
+}
+
 int LuaUnsyncedRead::IsAABBInView(lua_State* L)
 {
 	float3 mins = float3(luaL_checkfloat(L, 1),
@@ -671,9 +691,9 @@ enum UnitAllegiance {
 
 
 // never instantiated directly
-template<class T> class CWorldObjectQuadDrawer: public CReadMap::IQuadDrawer {
+template<class T, class L = std::vector<T*> > class CWorldObjectQuadDrawer: public CReadMap::IQuadDrawer {
 public:
-	typedef std::list<T*> ObjectList;
+	typedef L ObjectList;
 	typedef std::vector< const ObjectList* > ObjectVector;
 
 	void Reset() {
@@ -725,7 +745,7 @@ public:
 	}
 };
 
-class CVisProjectileQuadDrawer: public CWorldObjectQuadDrawer<CProjectile> {
+class CVisProjectileQuadDrawer: public CWorldObjectQuadDrawer<CProjectile, std::list<CProjectile*> > {
 public:
 	void DrawQuad(int x, int y) {
 		const CQuadField::Quad& q = quadField->GetQuadAt(x, y);
@@ -738,6 +758,124 @@ public:
 
 
 
+/**
+ * Quad-grid visibility results shared by all GetVisible{Units,Features}
+ * calls made with the same camera during one draw frame (widgets make
+ * dozens of them per frame with different filters). Holds sorted and
+ * de-duplicated IDs rather than pointers, objects deleted since the grid
+ * was walked are skipped.
+ */
+struct VisibleObjectCache {
+	VisibleObjectCache()
+		: drawFrame(-1u)
+		, simFrame(-1)
+		, cam(NULL)
+		, numQuadObjects(0)
+		, scanAll(false)
+	{}
+
+	bool IsCurrent(const CCamera* c) const {
+		if (drawFrame != globalRendering->drawFrame || simFrame != gs->frameNum)
+			return false;
+
+		return (cam == c && camPos == c->GetPos() && camDir == c->forward);
+	}
+
+	void SetCurrent(const CCamera* c) {
+		drawFrame = globalRendering->drawFrame;
+		simFrame = gs->frameNum;
+		cam = c;
+		camPos = c->GetPos();
+		camDir = c->forward;
+	}
+
+	template<class QuadDrawer> void SetObjects(QuadDrawer& quadIter, unsigned int numActiveObjects) {
+		numQuadObjects = quadIter.GetObjectCount();
+
+		// if we see nearly all objects, it is just faster to
+		// check them all, instead of doing slow duplication checks
+		//
+		// FIXME? one-third != "nearly all"
+		//
+		scanAll = (numQuadObjects > numActiveObjects / 3);
+		objectIDs.clear();
+
+		if (scanAll)
+			return;
+
+		typename QuadDrawer::ObjectVector::const_iterator listIt;
+		typename QuadDrawer::ObjectList::const_iterator objIt;
+
+		// objects can exist in multiple quads, so we still need to do a duplication check
+		for (listIt = quadIter.GetObjectLists().begin(); listIt != quadIter.GetObjectLists().end(); ++listIt) {
+			for (objIt = (*listIt)->begin(); objIt != (*listIt)->end(); ++objIt) {
+				objectIDs.push_back((*objIt)->id);
+			}
+		}
+
+		std::sort(objectIDs.begin(), objectIDs.end());
+		objectIDs.erase(std::unique(objectIDs.begin(), objectIDs.end()), objectIDs.end());
+	}
+
+	unsigned int drawFrame;
+	int simFrame;
+
+	const CCamera* cam;
+	float3 camPos;
+	float3 camDir;
+
+	unsigned int numQuadObjects;
+
+	/// if true, objectIDs is empty and all objects should be checked
+	bool scanAll;
+	std::vector<int> objectIDs;
+};
+
+static VisibleObjectCache visUnitCache;
+static VisibleObjectCache visFeatureCache;
+
+
+static inline bool IsVisibleUnit(const CUnit* unit, int allyTeamID, bool noIcons, float testRadius, bool fixedRadius)
+{
+	if (unit->noDraw)
+		return false;
+
+	if (allyTeamID >= 0 && !(unit->losStatus[allyTeamID] & LOS_INLOS))
+		return false;
+
+	if (noIcons) {
+		const float sqDist = (unit->pos - camera->GetPos()).SqLength();
+		const float iconDistSqrMult = unit->unitDef->iconType->GetDistanceSqr();
+		const float realIconLength = unitDrawer->iconLength * iconDistSqrMult;
+
+		if (sqDist > realIconLength)
+			return false;
+	}
+
+	return (camera->InView(unit->midPos, testRadius + (unit->drawRadius * !fixedRadius)));
+}
+
+static inline bool IsVisibleFeature(const CFeature* f, int allyTeamID, bool noIcons, bool noGeos, float testRadius, bool fixedRadius)
+{
+	if (noGeos && f->def->geoThermal)
+		return false;
+
+	if (noIcons) {
+		const float sqDist = (f->pos - camera->GetPos()).SqLength2D();
+		const float farLength = f->sqRadius * unitDrawer->unitDrawDist * unitDrawer->unitDrawDist;
+
+		if (sqDist >= farLength) {
+			return false;
+		}
+	}
+
+	if (!gu->spectatingFullView && !f->IsInLosForAllyTeam(allyTeamID))
+		return false;
+
+	return (camera->InView(f->midPos, testRadius + (f->drawRadius * !fixedRadius)));
+}
+
+
 int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 {
 	// arg 1 - teamID
@@ -772,7 +910,6 @@ int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 	const bool noIcons = !luaL_optboolean(L, 3, true);
 
 	float testRadius = WORLDOBJECT_DEFAULT_DRAWRADIUS;
-	const float iconLength = unitDrawer->iconLength;
 
 	if (lua_israwnumber(L, 2)) {
 		testRadius = lua_tofloat(L, 2);
@@ -780,92 +917,62 @@ int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 		testRadius = std::max(testRadius, -testRadius);
 	}
 
-	vector<const CUnitSet*> unitSets;
-	vector<const CUnitSet*>::const_iterator setIt;
-
-	static CUnitSet visQuadUnits;
-	static CVisUnitQuadDrawer unitQuadIter;
-
-	unsigned int count = 0;
+	if (!visUnitCache.IsCurrent(camera)) {
+		static CVisUnitQuadDrawer unitQuadIter;
 
-	{
 		GML_RECMUTEX_LOCK(quad); // GetVisibleUnits
 
 		unitQuadIter.Reset();
 		readMap->GridVisibility(camera, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE, 1e9, &unitQuadIter, INT_MAX);
 
-		lua_createtable(L, unitQuadIter.GetObjectCount(), 0);
+		visUnitCache.SetCurrent(camera);
+		visUnitCache.SetObjects(unitQuadIter, unitHandler->activeUnits.size());
+	}
 
-		// setup the list of unit sets
-		//
-		// if we see nearly all features, it is just faster to
-		// check them all, instead of doing slow duplication checks
-		//
-		// FIXME? one-third != "nearly all"
-		//
-		if (unitQuadIter.GetObjectCount() > unitHandler->activeUnits.size() / 3) {
-			if (teamID >= 0) {
-				unitSets.push_back(&teamHandler->Team(teamID)->units);
-			} else {
-				for (int t = 0; t < teamHandler->ActiveTeams(); t++) {
-					if ((teamID == AllUnits) ||
-						((teamID == AllyUnits)  && (allyTeamID == teamHandler->AllyTeam(t))) ||
-						((teamID == EnemyUnits) && (allyTeamID != teamHandler->AllyTeam(t))))
-					{
-						unitSets.push_back(&teamHandler->Team(t)->units);
-					}
-				}
-			}
-		} else {
-			// objects can exist in multiple quads, so we still need to do a duplication check
-			visQuadUnits.clear();
+	lua_createtable(L, visUnitCache.numQuadObjects, 0);
+
+	unsigned int count = 0;
+
+	if (visUnitCache.scanAll) {
+		for (int t = 0; t < teamHandler->ActiveTeams(); t++) {
+			if ((teamID >= 0) && (teamID != t))
+				continue;
+			if ((teamID == AllyUnits)  && (allyTeamID != teamHandler->AllyTeam(t)))
+				continue;
+			if ((teamID == EnemyUnits) && (allyTeamID == teamHandler->AllyTeam(t)))
+				continue;
 
-			const CVisUnitQuadDrawer::ObjectVector& visUnits = unitQuadIter.GetObjectLists();
+			const CUnitSet& unitSet = teamHandler->Team(t)->units;
 
-			CVisUnitQuadDrawer::ObjectVector::const_iterator visUnitLists;
-			CVisUnitQuadDrawer::ObjectList::const_iterator unitIt;
+			for (CUnitSet::const_iterator unitIt = unitSet.begin(); unitIt != unitSet.end(); ++unitIt) {
+				const CUnit* unit = *unitIt;
 
-			for (visUnitLists = visUnits.begin(); visUnitLists != visUnits.end(); ++visUnitLists) {
-				for (unitIt = (*visUnitLists)->begin(); unitIt != (*visUnitLists)->end(); ++unitIt) {
-					CUnit* unit = *unitIt;
+				if (!IsVisibleUnit(unit, allyTeamID, noIcons, testRadius, fixedRadius))
+					continue;
 
-					if ((teamID == AllUnits) ||
-						((teamID >= 0) && (teamID == unit->team)) ||
-						((teamID == AllyUnits)  && (allyTeamID == unit->allyteam)) ||
-						((teamID == EnemyUnits) && (allyTeamID != unit->allyteam)))
-					{
-						visQuadUnits.insert(unit);
-					}
-				}
+				// add the unit
+				count++;
+				lua_pushnumber(L, unit->id);
+				lua_rawseti(L, -2, count);
 			}
-			unitSets.push_back(&visQuadUnits);
 		}
-	}
-
-	for (setIt = unitSets.begin(); setIt != unitSets.end(); ++setIt) {
-		const CUnitSet* unitSet = *setIt;
-
-		CUnitSet::const_iterator unitIt;
+	} else {
+		const std::vector<int>& unitIDs = visUnitCache.objectIDs;
 
-		for (unitIt = unitSet->begin(); unitIt != unitSet->end(); ++unitIt) {
-			const CUnit* unit = *unitIt;
+		for (unsigned int n = 0; n < unitIDs.size(); n++) {
+			const CUnit* unit = unitHandler->GetUnit(unitIDs[n]);
 
-			if (unit->noDraw)
+			if (unit == NULL)
 				continue;
 
-			if (allyTeamID >= 0 && !(unit->losStatus[allyTeamID] & LOS_INLOS))
+			if ((teamID >= 0) && (teamID != unit->team))
+				continue;
+			if ((teamID == AllyUnits)  && (allyTeamID != unit->allyteam))
+				continue;
+			if ((teamID == EnemyUnits) && (allyTeamID == unit->allyteam))
 				continue;
 
-			if (noIcons) {
-				const float sqDist = (unit->pos - camera->GetPos()).SqLength();
-				const float iconDistSqrMult = unit->unitDef->iconType->GetDistanceSqr();
-				const float realIconLength = iconLength * iconDistSqrMult;
-
-				if (sqDist > realIconLength)
-					continue;
-			}
-
-			if (!camera->InView(unit->midPos, testRadius + (unit->drawRadius * !fixedRadius)))
+			if (!IsVisibleUnit(unit, allyTeamID, noIcons, testRadius, fixedRadius))
 				continue;
 
 			// add the unit
@@ -898,7 +1005,6 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 
 	// arg 2 - feature radius
 	bool fixedRadius = false;
-	bool scanAll = false;
 
 	float testRadius = WORLDOBJECT_DEFAULT_DRAWRADIUS;
 
@@ -911,70 +1017,53 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 	const bool noIcons = !luaL_optboolean(L, 3, true);
 	const bool noGeos = !luaL_optboolean(L, 4, true);
 
-	static CFeatureSet visQuadFeatures;
-	static CVisFeatureQuadDrawer featureQuadIter;
+	if (!visFeatureCache.IsCurrent(camera)) {
+		static CVisFeatureQuadDrawer featureQuadIter;
 
-	unsigned int count = 0;
-
-	{
 		GML_RECMUTEX_LOCK(quad); // GetVisibleFeatures
 
 		featureQuadIter.Reset();
 		readMap->GridVisibility(camera, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE, 3000.0f * 2.0f, &featureQuadIter, INT_MAX);
 
-		lua_createtable(L, featureQuadIter.GetObjectCount(), 0);
-
-		// setup the list of features
-		//
-		// if we see nearly all features, it is just faster to
-		// check them all, instead of doing slow duplication checks
-		//
-		// FIXME? one-third != "nearly all"
-		//
-		if (!(scanAll = (featureQuadIter.GetObjectCount() > featureHandler->GetActiveFeatures().size() / 3))) {
-			visQuadFeatures.clear();
-
-			const CVisFeatureQuadDrawer::ObjectVector& visFeatures = featureQuadIter.GetObjectLists();
-
-			CVisFeatureQuadDrawer::ObjectVector::const_iterator featureListIt;
-			CVisFeatureQuadDrawer::ObjectList::const_iterator featureIt;
-
-			// features can exist in multiple quads, so we need to do a duplication check
-			for (featureListIt = visFeatures.begin(); featureListIt != visFeatures.end(); ++featureListIt) {
-				for (featureIt = (*featureListIt)->begin(); featureIt != (*featureListIt)->end(); ++featureIt) {
-					visQuadFeatures.insert(*featureIt);
-				}
-			}
-		}
+		visFeatureCache.SetCurrent(camera);
+		visFeatureCache.SetObjects(featureQuadIter, featureHandler->GetActiveFeatures().size());
 	}
 
-	const CFeatureSet& featureSet = (scanAll) ? featureHandler->GetActiveFeatures() : visQuadFeatures;
+	lua_createtable(L, visFeatureCache.numQuadObjects, 0);
 
-	for (CFeatureSet::const_iterator featureIt = featureSet.begin(); featureIt != featureSet.end(); ++featureIt) {
-		const CFeature& f = **featureIt;
+	unsigned int count = 0;
 
-		if (noGeos && f.def->geoThermal)
-			continue;
+	if (visFeatureCache.scanAll) {
+		const CFeatureSet& featureSet = featureHandler->GetActiveFeatures();
 
-		if (noIcons) {
-			const float sqDist = (f.pos - camera->GetPos()).SqLength2D();
-			const float farLength = f.sqRadius * unitDrawer->unitDrawDist * unitDrawer->unitDrawDist;
+		for (CFeatureSet::const_iterator featureIt = featureSet.begin(); featureIt != featureSet.end(); ++featureIt) {
+			const CFeature* f = *featureIt;
 
-			if (sqDist >= farLength) {
+			if (!IsVisibleFeature(f, allyTeamID, noIcons, noGeos, testRadius, fixedRadius))
 				continue;
-			}
+
+			// add the feature
+			count++;
+			lua_pushnumber(L, f->id);
+			lua_rawseti(L, -2, count);
 		}
+	} else {
+		const std::vector<int>& featureIDs = visFeatureCache.objectIDs;
 
-		if (!gu->spectatingFullView && !f.IsInLosForAllyTeam(allyTeamID))
-			continue;
+		for (unsigned int n = 0; n < featureIDs.size(); n++) {
+			const CFeature* f = featureHandler->GetFeature(featureIDs[n]);
 
-		if (!camera->InView(f.midPos, testRadius + (f.drawRadius * !fixedRadius)))
-			continue;
+			if (f == NULL)
+				continue;
 
-		// add the unit
-		count++;
-		lua_pushnumber(L, f.id);
-		lua_rawseti(L, -2, count);
+			if (!IsVisibleFeature(f, allyTeamID, noIcons, noGeos, testRadius, fixedRadius))
+				continue;
+
+			// add the feature
+			count++;
+			lua_pushnumber(L, f->id);
+			lua_rawseti(L, -2, count);
+		}
 	}
 
 	return 1;
@@ -1219,6 +1308,17 @@ int LuaUnsyncedRead::IsGUIHidden(lua_State* L)
 }
 
 
+int LuaUnsyncedRead::IsCatchingUp(lua_State* L)
+{
+	CheckNoArgs(L, __FUNCTION__);
+	if (game == NULL) {
+		return 0;
+	}
+	lua_pushboolean(L, game->catchingUp);
+	return 1;
+}
+
+
 int LuaUnsyncedRead::HaveShadows(lua_State* L)
 {
 	CheckNoArgs(L, __FUNCTION__);
@@ -1772,6 +1872,47 @@ int LuaUnsyncedRead::GetFPS(lua_State* L)
 }
 
 
+int LuaUnsyncedRead::GetProfilerTimers(lua_State* L)
+{
+	CheckNoArgs(L, __FUNCTION__);
+
+	// the same figures as the /debug profile view
+	static std::vector<CTimeProfiler::TimerStats> stats;
+	profiler.GetTimerStats(stats);
+
+	lua_createtable(L, stats.size(), 0);
+
+	for (size_t n = 0; n < stats.size(); n++) {
+		lua_createtable(L, 0, 4);
+		HSTR_PUSH_STRING(L, "name",    stats[n].name);
+		HSTR_PUSH_NUMBER(L, "total",   stats[n].total);
+		HSTR_PUSH_NUMBER(L, "percent", stats[n].percent);
+		HSTR_PUSH_NUMBER(L, "peak",    stats[n].peak);
+		lua_rawseti(L, -2, n + 1);
+	}
+
+	return 1;
+}
+
+
+int LuaUnsyncedRead::GetEngineCounters(lua_State* L)
+{
+	CheckNoArgs(L, __FUNCTION__);
+
+	lua_createtable(L, 0, 9);
+	HSTR_PUSH_NUMBER(L, "units",               unitHandler->activeUnits.size());
+	HSTR_PUSH_NUMBER(L, "features",            featureHandler->GetActiveFeatures().size());
+	HSTR_PUSH_NUMBER(L, "syncedProjectiles",   projectileHandler->syncedProjectiles.size());
+	HSTR_PUSH_NUMBER(L, "unsyncedProjectiles", projectileHandler->unsyncedProjectiles.size());
+	HSTR_PUSH_NUMBER(L, "simFrame",            gs->frameNum);
+	HSTR_PUSH_NUMBER(L, "drawFrame",           globalRendering->drawFrame);
+	HSTR_PUSH_NUMBER(L, "lastFrameTime",       globalRendering->lastFrameTime);
+	HSTR_PUSH_NUMBER(L, "netBytesSent",        (net != NULL)? net->GetDataSent(): 0);
+	HSTR_PUSH_NUMBER(L, "netBytesReceived",    (net != NULL)? net->GetDataReceived(): 0);
+	return 1;
+}
+
+
 /******************************************************************************/
 
 int LuaUnsyncedRead::GetActiveCommand(lua_State* L)
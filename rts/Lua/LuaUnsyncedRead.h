@@ -21,6 +21,7 @@ class LuaUnsyncedRead {
 		static int GetFrameTimeOffset(lua_State* L);
 		static int GetLastUpdateSeconds(lua_State* L);
 		static int GetHasLag(lua_State* L);
+		static int GetNetFrameBuffer(lua_State* L);
 
 		static int GetViewGeometry(lua_State* L);
 		static int GetWindowGeometry(lua_State* L);
@@ -65,6 +66,7 @@ class LuaUnsyncedRead {
 		static int GetSelectedUnitsCount(lua_State* L);
 
 		static int IsGUIHidden(lua_State* L);
+		static int IsCatchingUp(lua_State* L);
 		static int HaveShadows(lua_State* L);
 		static int HaveAdvShading(lua_State* L);
 		static int GetWaterMode(lua_State* L);
@@ -89,6 +91,8 @@ class LuaUnsyncedRead {
 
 		// moved from LuaUI
 		static int GetFPS(lua_State* L);
+		static int GetProfilerTimers(lua_State* L);
+		static int GetEngineCounters(lua_State* L);
 
 		static int GetMouseState(lua_State* L);
 		static int GetMouseCursor(lua_State* L);
@@ -322,6 +322,92 @@ int LuaUtils::ShallowRestore(const std::vector<LuaUtils::ShallowDataDump> &backu
 	return count;
 }
 
+int LuaUtils::ShallowBackup(std::vector<char>& buffer, lua_State* src, int count) {
+	const int srcTop = lua_gettop(src);
+	if (srcTop < count)
+		return 0;
+
+	const int startIndex = (srcTop - count + 1);
+	const int endIndex   = srcTop;
+
+	for (int i = startIndex; i <= endIndex; ++i) {
+		const int type = lua_type(src, i);
+		const size_t pos = buffer.size();
+
+		switch (type) {
+			case LUA_TBOOLEAN: {
+				buffer.resize(pos + 2);
+				buffer[pos + 1] = lua_toboolean(src, i);
+				break;
+			}
+			case LUA_TNUMBER: {
+				const lua_Number num = lua_tonumber(src, i);
+				buffer.resize(pos + 1 + sizeof(num));
+				memcpy(&buffer[pos + 1], &num, sizeof(num));
+				break;
+			}
+			case LUA_TSTRING: {
+				size_t len = 0;
+				const char* data = lua_tolstring(src, i, &len);
+				const boost::uint32_t len32 = len;
+				buffer.resize(pos + 1 + sizeof(len32) + len);
+				memcpy(&buffer[pos + 1], &len32, sizeof(len32));
+				memcpy(&buffer[pos + 1 + sizeof(len32)], data, len);
+				break;
+			}
+			case LUA_TNIL: {
+				buffer.resize(pos + 1);
+				break;
+			}
+			default: {
+				LOG_L(L_WARNING, "ShallowBackup: Invalid type for argument %d", i);
+				buffer.resize(pos + 1);
+				break; // nil
+			}
+		}
+
+		buffer[pos] = (type == LUA_TBOOLEAN || type == LUA_TNUMBER || type == LUA_TSTRING)? type: LUA_TNIL;
+	}
+
+	return count;
+}
+
+
+int LuaUtils::ShallowRestore(const std::vector<char>& buffer, size_t& pos, int count, lua_State* dst) {
+	lua_checkstack(dst, count);
+
+	for (int d = 0; d < count; ++d) {
+		switch (buffer[pos++]) {
+			case LUA_TBOOLEAN: {
+				lua_pushboolean(dst, buffer[pos++]);
+				break;
+			}
+			case LUA_TNUMBER: {
+				lua_Number num;
+				memcpy(&num, &buffer[pos], sizeof(num));
+				lua_pushnumber(dst, num);
+				pos += sizeof(num);
+				break;
+			}
+			case LUA_TSTRING: {
+				boost::uint32_t len;
+				memcpy(&len, &buffer[pos], sizeof(len));
+				pos += sizeof(len);
+				// no intermediate std::string, pushed straight from the buffer
+				lua_pushlstring(dst, (len > 0)? &buffer[pos]: "", len);
+				pos += len;
+				break;
+			}
+			default: {
+				lua_pushnil(dst);
+				break;
+			}
+		}
+	}
+
+	return count;
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -786,6 +872,36 @@ int LuaUtils::ParseFacing(lua_State* L, const char* caller, int index)
 /******************************************************************************/
 
 
+void LuaUtils::PushParamKeyTable(lua_State* L, const ParamMap& paramMap)
+{
+	lua_createtable(L, 0, paramMap.size());
+
+	// the map is static and never changes after its creation,
+	// so pointers to its elements stay valid
+	for (ParamMap::const_iterator it = paramMap.begin(); it != paramMap.end(); ++it) {
+		lua_pushsstring(L, it->first);
+		lua_pushlightuserdata(L, const_cast<DataElement*>(&it->second));
+		lua_rawset(L, -3);
+	}
+}
+
+
+const DataElement* LuaUtils::GetParamElement(lua_State* L, int keyTableIndex, int keyIndex)
+{
+	// all internal parameters use strings as keys
+	if (lua_type(L, keyIndex) != LUA_TSTRING)
+		return NULL;
+
+	lua_pushvalue(L, keyIndex);
+	lua_rawget(L, keyTableIndex);
+
+	const DataElement* elem = static_cast<const DataElement*>(lua_touserdata(L, -1));
+
+	lua_pop(L, 1);
+	return elem;
+}
+
+
 int LuaUtils::Next(const ParamMap& paramMap, lua_State* L)
 {
 	luaL_checktype(L, 1, LUA_TTABLE);
@@ -59,6 +59,11 @@ class LuaUtils {
 
 		static int ShallowRestore(const std::vector<ShallowDataDump> &backup, lua_State* dst);
 
+		/// appends the top <count> values of <src> (nil, boolean, number, string) in binary form
+		static int ShallowBackup(std::vector<char>& buffer, lua_State* src, int count);
+		/// pushes <count> values packed by ShallowBackup, starting at buffer[pos]; advances pos
+		static int ShallowRestore(const std::vector<char>& buffer, size_t& pos, int count, lua_State* dst);
+
 		static int CopyData(lua_State* dst, lua_State* src, int count);
 
 		static void PushCurrentFuncEnv(lua_State* L, const char* caller);
@@ -93,6 +98,11 @@ class LuaUtils {
 		// (helper for the Next() iteration routine)
 		static int Next(const ParamMap& paramMap, lua_State* L);
 
+		// from LuaFeatureDefs.cpp / LuaUnitDefs.cpp / LuaWeaponDefs.cpp
+		// (name lookups through the interned Lua strings instead of the ParamMap)
+		static void PushParamKeyTable(lua_State* L, const ParamMap& paramMap);
+		static const DataElement* GetParamElement(lua_State* L, int keyTableIndex, int keyIndex);
+
 		// from LuaParser.cpp / LuaUnsyncedCtrl.cpp
 		// (implementation copied from lua/src/lib/lbaselib.c)
 		static int Echo(lua_State* L);
@@ -0,0 +1,392 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+
+#include "LuaVBOs.h"
+
+#include "LuaInclude.h"
+
+#include "LuaHandle.h"
+#include "LuaHashString.h"
+#include "LuaOpenGL.h"
+#include "LuaUtils.h"
+
+#include "Rendering/GL/VBO.h"
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+inline void CheckDrawingEnabled(lua_State* L, const char* caller)
+{
+	if (!LuaOpenGL::IsDrawingEnabled(L)) {
+		luaL_error(L, "%s(): OpenGL calls can only be used in Draw() "
+		              "call-ins, or while creating display lists", caller);
+	}
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+LuaVBOs::LuaVBOs()
+{
+}
+
+
+LuaVBOs::~LuaVBOs()
+{
+	set<Batch*>::const_iterator it;
+	for (it = batches.begin(); it != batches.end(); ++it) {
+		delete *it;
+	}
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+bool LuaVBOs::PushEntries(lua_State* L)
+{
+	CreateMetatable(L);
+
+#define REGISTER_LUA_CFUNC(x) \
+	lua_pushstring(L, #x);      \
+	lua_pushcfunction(L, x);    \
+	lua_rawset(L, -3)
+
+	REGISTER_LUA_CFUNC(CreateVertexBatch);
+	REGISTER_LUA_CFUNC(DeleteVertexBatch);
+	REGISTER_LUA_CFUNC(ClearVertexBatch);
+	REGISTER_LUA_CFUNC(VertexBatchAppend);
+	REGISTER_LUA_CFUNC(VertexBatchRect);
+	REGISTER_LUA_CFUNC(DrawVertexBatch);
+
+	return true;
+}
+
+
+bool LuaVBOs::CreateMetatable(lua_State* L)
+{
+	luaL_newmetatable(L, "VertexBatch");
+	HSTR_PUSH_CFUNC(L, "__gc",        meta_gc);
+	HSTR_PUSH_CFUNC(L, "__index",     meta_index);
+	HSTR_PUSH_CFUNC(L, "__newindex",  meta_newindex);
+	lua_pop(L, 1);
+	return true;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+LuaVBOs::Batch::Batch(GLenum _primType)
+	: primType(_primType)
+	, vbo(new VBO(GL_ARRAY_BUFFER))
+	, dirty(false)
+{
+	curTxcd[0] = 0.0f; curTxcd[1] = 0.0f;
+	curNorm[0] = 0.0f; curNorm[1] = 1.0f; curNorm[2] = 0.0f;
+	curColor[0] = 1.0f; curColor[1] = 1.0f; curColor[2] = 1.0f; curColor[3] = 1.0f;
+}
+
+
+LuaVBOs::Batch::~Batch()
+{
+	delete vbo;
+}
+
+
+void LuaVBOs::Batch::AddVertex(const float* vert)
+{
+	verts.insert(verts.end(), vert, vert + 3);
+	verts.insert(verts.end(), curTxcd, curTxcd + 2);
+	verts.insert(verts.end(), curNorm, curNorm + 3);
+	verts.insert(verts.end(), curColor, curColor + 4);
+	dirty = true;
+}
+
+
+void LuaVBOs::Batch::Draw()
+{
+	if (verts.empty()) {
+		return;
+	}
+
+	vbo->Bind(GL_ARRAY_BUFFER);
+
+	if (dirty) {
+		vbo->Resize(verts.size() * sizeof(float), GL_STATIC_DRAW, &verts[0]);
+		dirty = false;
+	}
+
+	const float* ptr = reinterpret_cast<const float*>(vbo->GetPtr());
+	const GLsizei stride = STRIDE * sizeof(float);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	glVertexPointer(3, GL_FLOAT, stride, ptr + VERT_OFS);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + TXCD_OFS);
+	glNormalPointer(GL_FLOAT, stride, ptr + NORM_OFS);
+	glColorPointer(4, GL_FLOAT, stride, ptr + COLOR_OFS);
+
+	glDrawArrays(primType, 0, NumVertices());
+
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	vbo->Unbind();
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+LuaVBOs::Batch* LuaVBOs::CheckBatch(lua_State* L, int index)
+{
+	Batch** batch = static_cast<Batch**>(luaL_checkudata(L, index, "VertexBatch"));
+	if (*batch == NULL) {
+		luaL_error(L, "invalid (deleted) VertexBatch");
+	}
+	return *batch;
+}
+
+
+void LuaVBOs::FreeBatch(lua_State* L, int index)
+{
+	Batch** batch = static_cast<Batch**>(luaL_checkudata(L, index, "VertexBatch"));
+	if (*batch == NULL) {
+		return;
+	}
+
+	CLuaHandle::GetActiveVBOs(L).batches.erase(*batch);
+	delete *batch;
+	*batch = NULL;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaVBOs::meta_gc(lua_State* L)
+{
+	FreeBatch(L, 1);
+	return 0;
+}
+
+
+int LuaVBOs::meta_index(lua_State* L)
+{
+	const Batch* batch = *static_cast<Batch**>(luaL_checkudata(L, 1, "VertexBatch"));
+	const string key = luaL_checkstring(L, 2);
+	if (key == "valid") {
+		lua_pushboolean(L, batch != NULL);
+		return 1;
+	}
+	if (batch == NULL) {
+		return 0;
+	}
+	if (key == "type") {
+		lua_pushnumber(L, batch->primType);
+	}
+	else if (key == "vertices") {
+		lua_pushnumber(L, batch->NumVertices());
+	}
+	else {
+		return 0;
+	}
+	return 1;
+}
+
+
+int LuaVBOs::meta_newindex(lua_State* L)
+{
+	return 0;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaVBOs::CreateVertexBatch(lua_State* L)
+{
+	const GLenum primType = (GLenum)luaL_checkint(L, 1);
+
+	Batch** batchPtr = static_cast<Batch**>(lua_newuserdata(L, sizeof(Batch*)));
+	*batchPtr = new Batch(primType);
+
+	luaL_getmetatable(L, "VertexBatch");
+	lua_setmetatable(L, -2);
+
+	CLuaHandle::GetActiveVBOs(L).batches.insert(*batchPtr);
+	return 1;
+}
+
+
+int LuaVBOs::DeleteVertexBatch(lua_State* L)
+{
+	if (lua_isnil(L, 1)) {
+		return 0;
+	}
+	FreeBatch(L, 1);
+	return 0;
+}
+
+
+int LuaVBOs::ClearVertexBatch(lua_State* L)
+{
+	Batch* batch = CheckBatch(L, 1);
+	batch->verts.clear();
+	batch->dirty = true;
+	return 0;
+}
+
+
+int LuaVBOs::VertexBatchAppend(lua_State* L)
+{
+	Batch* batch = CheckBatch(L, 1);
+
+	if (!lua_istable(L, 2)) {
+		luaL_error(L, "Incorrect arguments to gl.VertexBatchAppend(batch, elements[])");
+	}
+
+	// same vertex tables as gl.Shape; attributes that are
+	// not given are taken over from the previous vertex
+	const int table = 2;
+	for (int i = 1; ; i++) {
+		lua_rawgeti(L, table, i);
+		if (!lua_istable(L, -1)) {
+			if (!lua_isnil(L, -1)) {
+				luaL_error(L, "VertexBatchAppend: bad vertex data, not a table");
+			}
+			lua_pop(L, 1);
+			break;
+		}
+
+		const int vertex = lua_gettop(L);
+		float vert[3] = {0.0f, 0.0f, 0.0f};
+		bool hasVert = false;
+
+		for (lua_pushnil(L); lua_next(L, vertex) != 0; lua_pop(L, 1)) {
+			if (!lua_istable(L, -1) || !lua_israwstring(L, -2)) {
+				luaL_error(L, "VertexBatchAppend: bad vertex data row");
+			}
+
+			const string key = lua_tostring(L, -2);
+
+			if ((key == "v") || (key == "vertex")) {
+				if (LuaUtils::ParseFloatArray(L, -1, vert, 3) < 2) {
+					luaL_error(L, "VertexBatchAppend: bad vertex array");
+				}
+				hasVert = true;
+			}
+			else if ((key == "n") || (key == "normal")) {
+				if (LuaUtils::ParseFloatArray(L, -1, batch->curNorm, 3) != 3) {
+					luaL_error(L, "VertexBatchAppend: bad normal array");
+				}
+			}
+			else if ((key == "t") || (key == "texcoord")) {
+				if (LuaUtils::ParseFloatArray(L, -1, batch->curTxcd, 2) != 2) {
+					luaL_error(L, "VertexBatchAppend: bad texcoord array");
+				}
+			}
+			else if ((key == "c") || (key == "color")) {
+				batch->curColor[0] = 1.0f; batch->curColor[1] = 1.0f;
+				batch->curColor[2] = 1.0f; batch->curColor[3] = 1.0f;
+				LuaUtils::ParseFloatArray(L, -1, batch->curColor, 4);
+			}
+		}
+
+		if (!hasVert) {
+			luaL_error(L, "VertexBatchAppend: bad vertex data, no vertex");
+		}
+
+		batch->AddVertex(vert);
+		lua_pop(L, 1);
+	}
+
+	return 0;
+}
+
+
+int LuaVBOs::VertexBatchRect(lua_State* L)
+{
+	Batch* batch = CheckBatch(L, 1);
+
+	const int args = lua_gettop(L); // number of arguments
+
+	const float x1 = luaL_checkfloat(L, 2);
+	const float y1 = luaL_checkfloat(L, 3);
+	const float x2 = luaL_checkfloat(L, 4);
+	const float y2 = luaL_checkfloat(L, 5);
+
+	// same defaults as gl.TexRect
+	float s1 = 0.0f;
+	float t1 = 1.0f;
+	float s2 = 1.0f;
+	float t2 = 0.0f;
+
+	if (args <= 7) {
+		if ((args >= 6) && luaL_optboolean(L, 6, false)) {
+			s1 = 1.0f;
+			s2 = 0.0f;
+		}
+		if ((args >= 7) && luaL_optboolean(L, 7, false)) {
+			t1 = 0.0f;
+			t2 = 1.0f;
+		}
+	} else {
+		s1 = luaL_checkfloat(L, 6);
+		t1 = luaL_checkfloat(L, 7);
+		s2 = luaL_checkfloat(L, 8);
+		t2 = luaL_checkfloat(L, 9);
+	}
+
+	const float verts[4][5] = {
+		{x1, y1, 0.0f, s1, t1},
+		{x2, y1, 0.0f, s2, t1},
+		{x2, y2, 0.0f, s2, t2},
+		{x1, y2, 0.0f, s1, t2},
+	};
+
+	static const int quadIndices[] = {0, 1, 2, 3};
+	static const int triIndices[] = {0, 1, 2, 0, 2, 3};
+
+	const int* indices = NULL;
+	int numIndices = 0;
+
+	switch (batch->primType) {
+		case GL_QUADS:     { indices = quadIndices; numIndices = 4; } break;
+		case GL_TRIANGLES: { indices = triIndices;  numIndices = 6; } break;
+		default: {
+			luaL_error(L, "VertexBatchRect: batch type must be GL.QUADS or GL.TRIANGLES");
+		} break;
+	}
+
+	for (int i = 0; i < numIndices; i++) {
+		const float* v = verts[indices[i]];
+		batch->curTxcd[0] = v[3];
+		batch->curTxcd[1] = v[4];
+		batch->AddVertex(v);
+	}
+
+	return 0;
+}
+
+
+int LuaVBOs::DrawVertexBatch(lua_State* L)
+{
+	CheckDrawingEnabled(L, __FUNCTION__);
+
+	Batch* batch = CheckBatch(L, 1);
+	batch->Draw();
+	return 0;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
@@ -0,0 +1,87 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_VBOS_H
+#define LUA_VBOS_H
+
+#include <set>
+#include <vector>
+using std::set;
+using std::vector;
+
+#include "Rendering/GL/myGL.h"
+
+
+struct lua_State;
+class VBO;
+
+
+/**
+ * Retained vertex batches for Lua, an alternative to gl.Shape and friends
+ * for geometry that is drawn every frame: vertices are appended once (in
+ * the same format as gl.Shape) and stored interleaved in a VBO, so drawing
+ * is a single glDrawArrays call instead of one Lua->GL call per vertex.
+ */
+class LuaVBOs {
+	public:
+		LuaVBOs();
+		~LuaVBOs();
+
+		static bool PushEntries(lua_State* L);
+
+	public:
+		struct Batch {
+			// interleaved layout of one vertex: pos3, txcd2, norm3, color4
+			enum {
+				VERT_OFS  = 0,
+				TXCD_OFS  = 3,
+				NORM_OFS  = 5,
+				COLOR_OFS = 8,
+				STRIDE    = 12,
+			};
+
+			Batch(GLenum primType);
+			~Batch();
+
+			void AddVertex(const float* vert);
+			void Draw();
+
+			unsigned int NumVertices() const { return (verts.size() / STRIDE); }
+
+			GLenum primType;
+
+			// the attributes of the next vertex, like GL's current state
+			float curTxcd[2];
+			float curNorm[3];
+			float curColor[4];
+
+			vector<float> verts;
+			VBO* vbo;
+
+			// true if <verts> changed since the last upload
+			bool dirty;
+		};
+
+	private:
+		set<Batch*> batches;
+
+	private: // helpers
+		static bool CreateMetatable(lua_State* L);
+		static Batch* CheckBatch(lua_State* L, int index);
+		static void FreeBatch(lua_State* L, int index);
+
+	private: // metatable methods
+		static int meta_gc(lua_State* L);
+		static int meta_index(lua_State* L);
+		static int meta_newindex(lua_State* L);
+
+	private:
+		static int CreateVertexBatch(lua_State* L);
+		static int DeleteVertexBatch(lua_State* L);
+		static int ClearVertexBatch(lua_State* L);
+		static int VertexBatchAppend(lua_State* L);
+		static int VertexBatchRect(lua_State* L);
+		static int DrawVertexBatch(lua_State* L);
+};
+
+
+#endif /* LUA_VBOS_H */
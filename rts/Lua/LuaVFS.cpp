@@ -18,11 +18,16 @@
 #include "System/FileSystem/VFSHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Util.h"
+#include "System/Platform/Threading.h"
 
 #include <set>
 #include <list>
+#include <deque>
 #include <cctype>
 #include <limits.h>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 
 using std::min;
 
@@ -83,6 +88,7 @@ bool LuaVFS::PushUnsynced(lua_State* L)
 
 	HSTR_PUSH_CFUNC(L, "Include",		UnsyncInclude);
 	HSTR_PUSH_CFUNC(L, "LoadFile",		UnsyncLoadFile);
+	HSTR_PUSH_CFUNC(L, "LoadFileAsync",	LoadFileAsync);
 	HSTR_PUSH_CFUNC(L, "FileExists",	UnsyncFileExists);
 	HSTR_PUSH_CFUNC(L, "DirList",		UnsyncDirList);
 	HSTR_PUSH_CFUNC(L, "SubDirs",		UnsyncSubDirs);
@@ -92,6 +98,7 @@ bool LuaVFS::PushUnsynced(lua_State* L)
 
 	HSTR_PUSH_CFUNC(L, "ZlibCompress", ZlibCompress);
 
+	CreateAsyncLoadMetatable(L);
 	return true;
 }
 
@@ -247,6 +254,192 @@ int LuaVFS::UnsyncLoadFile(lua_State* L)
 }
 
 
+/******************************************************************************/
+
+/**
+ * Reads (and decompresses) files requested through VFS.LoadFileAsync on a
+ * background thread, so big widget assets do not stall the calling frame.
+ * Requests are shared with their Lua handles; a request whose handle was
+ * garbage-collected before its turn is dropped without being read.
+ */
+namespace {
+	struct AsyncLoadRequest {
+		AsyncLoadRequest(): done(false), success(false) {}
+
+		string filename;
+		string modes;
+		string data;
+
+		bool done;
+		bool success;
+	};
+
+	typedef boost::shared_ptr<AsyncLoadRequest> AsyncLoadRequestPtr;
+
+	class CAsyncFileLoader {
+	public:
+		CAsyncFileLoader(): thread(NULL), stop(false) {}
+		~CAsyncFileLoader() {
+			{
+				boost::mutex::scoped_lock lock(mutex);
+				stop = true;
+				cond.notify_one();
+			}
+
+			if (thread != NULL) {
+				thread->join();
+				delete thread;
+			}
+		}
+
+		void Queue(const AsyncLoadRequestPtr& req) {
+			boost::mutex::scoped_lock lock(mutex);
+
+			if (thread == NULL)
+				thread = new boost::thread(boost::bind(&CAsyncFileLoader::ThreadFunc, this));
+
+			queue.push_back(req);
+			cond.notify_one();
+		}
+
+		bool IsDone(const AsyncLoadRequest& req) {
+			boost::mutex::scoped_lock lock(mutex);
+			return req.done;
+		}
+
+		/// held around every load; taken by code that replaces or extends the VFS
+		boost::recursive_mutex vfsMutex;
+
+	private:
+		void ThreadFunc() {
+			Threading::SetThreadName("vfs-loader");
+
+			while (true) {
+				AsyncLoadRequestPtr req;
+
+				{
+					boost::mutex::scoped_lock lock(mutex);
+
+					while (queue.empty() && !stop)
+						cond.wait(lock);
+
+					if (stop)
+						return;
+
+					req = queue.front();
+					queue.pop_front();
+				}
+
+				// nobody is interested in the result anymore
+				if (req.unique())
+					continue;
+
+				string data;
+				bool success = false;
+
+				{
+					boost::recursive_mutex::scoped_lock lock(vfsMutex);
+					success = LoadFileWithModes(req->filename, data, req->modes);
+				}
+
+				boost::mutex::scoped_lock lock(mutex);
+
+				req->data.swap(data);
+				req->success = success;
+				req->done = true;
+			}
+		}
+
+	private:
+		boost::thread* thread;
+		boost::mutex mutex;
+		boost::condition_variable cond;
+
+		std::deque<AsyncLoadRequestPtr> queue;
+
+		bool stop;
+	};
+
+	static CAsyncFileLoader asyncFileLoader;
+}
+
+
+static AsyncLoadRequestPtr& ToAsyncLoad(lua_State* L)
+{
+	return *static_cast<AsyncLoadRequestPtr*>(luaL_checkudata(L, 1, "VFSAsyncLoad"));
+}
+
+
+bool LuaVFS::CreateAsyncLoadMetatable(lua_State* L)
+{
+	luaL_newmetatable(L, "VFSAsyncLoad");
+
+	// metatable.__index = metatable
+	lua_pushvalue(L, -1);
+	lua_setfield(L, -2, "__index");
+
+	HSTR_PUSH_CFUNC(L, "__gc", AsyncLoadGC);
+	HSTR_PUSH_CFUNC(L, "done", AsyncLoadDone);
+	HSTR_PUSH_CFUNC(L, "data", AsyncLoadData);
+
+	lua_pop(L, 1);
+	return true;
+}
+
+
+/**
+ * VFS.LoadFileAsync(filename [, modes]) -> request
+ *
+ * request:done() returns true once the file was read (or found missing),
+ * request:data() then returns its contents (nil if it could not be read).
+ * Unsynced only.
+ */
+int LuaVFS::LoadFileAsync(lua_State* L)
+{
+	const string filename = luaL_checkstring(L, 1);
+	const string modes = GetModes(L, 2, false);
+
+	AsyncLoadRequestPtr req(new AsyncLoadRequest());
+	req->filename = filename;
+	req->modes = modes;
+
+	void* udata = lua_newuserdata(L, sizeof(AsyncLoadRequestPtr));
+	new (udata) AsyncLoadRequestPtr(req);
+
+	luaL_getmetatable(L, "VFSAsyncLoad");
+	lua_setmetatable(L, -2);
+
+	asyncFileLoader.Queue(req);
+	return 1;
+}
+
+
+int LuaVFS::AsyncLoadGC(lua_State* L)
+{
+	ToAsyncLoad(L).~AsyncLoadRequestPtr();
+	return 0;
+}
+
+
+int LuaVFS::AsyncLoadDone(lua_State* L)
+{
+	lua_pushboolean(L, asyncFileLoader.IsDone(*ToAsyncLoad(L)));
+	return 1;
+}
+
+
+int LuaVFS::AsyncLoadData(lua_State* L)
+{
+	const AsyncLoadRequestPtr& req = ToAsyncLoad(L);
+
+	if (!asyncFileLoader.IsDone(*req) || !req->success)
+		return 0;
+
+	lua_pushsstring(L, req->data);
+	return 1;
+}
+
+
 /******************************************************************************/
 
 int LuaVFS::FileExists(lua_State* L, bool synced)
@@ -365,6 +558,9 @@ int LuaVFS::UseArchive(lua_State* L)
 		return 0;
 	}
 
+	// async loads must not see the temporary handler
+	boost::recursive_mutex::scoped_lock lock(asyncFileLoader.vfsMutex);
+
 	CVFSHandler* oldHandler = vfsHandler;
 	vfsHandler = new CVFSHandler;
 	vfsHandler->AddArchive(filename, false);
@@ -421,6 +617,8 @@ int LuaVFS::MapArchive(lua_State* L)
 			return 0;
 		}
 	}
+	boost::recursive_mutex::scoped_lock lock(asyncFileLoader.vfsMutex);
+
 	if (!vfsHandler->AddArchive(filename, false))
 	{
 		std::ostringstream buf;
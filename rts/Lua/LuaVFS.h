@@ -37,6 +37,12 @@ class LuaVFS {
 		static int UnsyncDirList(lua_State* L);
 		static int UnsyncSubDirs(lua_State* L);
 
+		static int LoadFileAsync(lua_State* L); ///< unsynced only
+		static bool CreateAsyncLoadMetatable(lua_State* L);
+		static int AsyncLoadGC(lua_State* L);
+		static int AsyncLoadDone(lua_State* L);
+		static int AsyncLoadData(lua_State* L);
+
 		static int UseArchive(lua_State* L); ///< temporary
 
 		static int CompressFolder(lua_State* L);
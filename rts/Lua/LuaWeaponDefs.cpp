@@ -62,6 +62,11 @@ bool LuaWeaponDefs::PushEntries(lua_State* L)
 	  InitParamMap();
 	}
 
+	// shared by all proxies, maps each parameter name to its DataElement
+	const int defsTable = lua_gettop(L);
+	LuaUtils::PushParamKeyTable(L, paramMap);
+	const int keyTable = lua_gettop(L);
+
 	const map<string, int>& weaponMap = weaponDefHandler->weaponID;
 	map<string, int>::const_iterator wit;
 	for (wit = weaponMap.begin(); wit != weaponMap.end(); ++wit) {
@@ -76,7 +81,8 @@ bool LuaWeaponDefs::PushEntries(lua_State* L)
 
 				HSTR_PUSH(L, "__index");
 				lua_pushlightuserdata(L, (void*)wd);
-				lua_pushcclosure(L, WeaponDefIndex, 1);
+				lua_pushvalue(L, keyTable);
+				lua_pushcclosure(L, WeaponDefIndex, 2);
 				lua_rawset(L, -3); // closure
 
 				HSTR_PUSH(L, "__newindex");
@@ -101,9 +107,11 @@ bool LuaWeaponDefs::PushEntries(lua_State* L)
 		lua_pushcfunction(L, Next);
 		lua_rawset(L, -3);
 
-		lua_rawset(L, -3); // proxy table into WeaponDefs
+		lua_rawset(L, defsTable); // proxy table into WeaponDefs
 	}
 
+	lua_pop(L, 1); // keyTable
+
 	return true;
 }
 
@@ -112,24 +120,17 @@ bool LuaWeaponDefs::PushEntries(lua_State* L)
 
 static int WeaponDefIndex(lua_State* L)
 {
-	// not a default value
-	if (!lua_isstring(L, 2)) {
-		lua_rawget(L, 1);
-		return 1;
-	}
-
-	const char* name = lua_tostring(L, 2);
-	ParamMap::const_iterator it = paramMap.find(name);
+	const DataElement* elemPtr = LuaUtils::GetParamElement(L, lua_upvalueindex(2), 2);
 
 	// not a default value
-	if (it == paramMap.end()) {
+	if (elemPtr == NULL) {
 		lua_rawget(L, 1);
 		return 1;
 	}
 
 	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
 	const WeaponDef* wd = static_cast<const WeaponDef*>(userData);
-	const DataElement& elem = it->second;
+	const DataElement& elem = *elemPtr;
 	const char* p = ((const char*)wd) + elem.offset;
 	switch (elem.type) {
 		case READONLY_TYPE: {
@@ -156,7 +157,7 @@ static int WeaponDefIndex(lua_State* L)
 			return elem.func(L, p);
 		}
 		case ERROR_TYPE: {
-			LOG_L(L_ERROR, "[%s] ERROR_TYPE for key \"%s\" in WeaponDefs __index", __FUNCTION__, name);
+			LOG_L(L_ERROR, "[%s] ERROR_TYPE for key \"%s\" in WeaponDefs __index", __FUNCTION__, lua_tostring(L, 2));
 			lua_pushnil(L);
 			return 1;
 		}
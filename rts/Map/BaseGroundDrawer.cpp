@@ -316,7 +316,7 @@ bool CBaseGroundDrawer::UpdateExtraTexture(unsigned int texDrawMode)
 			case drawMetal: {
 				const CMetalMap* metalMap = readMap->metalMap;
 
-				const unsigned short* myAirLos        = &losHandler->airLosMaps[gu->myAllyTeam].front();
+				const unsigned short* myAirLos        = losHandler->airLosMaps[gu->myAllyTeam].GetData();
 				const unsigned  char* extraTex        = metalMap->GetDistributionMap();
 				const unsigned  char* extraTexPal     = metalMap->GetTexturePalette();
 				const          float* extractDepthMap = metalMap->GetExtractionMap();
@@ -377,13 +377,13 @@ bool CBaseGroundDrawer::UpdateExtraTexture(unsigned int texDrawMode)
 			}
 
 			case drawLos: {
-				const unsigned short* myLos         = &losHandler->losMaps[gu->myAllyTeam].front();
-				const unsigned short* myAirLos      = &losHandler->airLosMaps[gu->myAllyTeam].front();
-				const unsigned short* myRadar       = &radarHandler->radarMaps[gu->myAllyTeam].front();
-				const unsigned short* myJammer      = &radarHandler->jammerMaps[gu->myAllyTeam].front();
+				const unsigned short* myLos         = losHandler->losMaps[gu->myAllyTeam].GetData();
+				const unsigned short* myAirLos      = losHandler->airLosMaps[gu->myAllyTeam].GetData();
+				const unsigned short* myRadar       = radarHandler->radarMaps[gu->myAllyTeam].GetData();
+				const unsigned short* myJammer      = radarHandler->jammerMaps[gu->myAllyTeam].GetData();
 			#ifdef SONAR_JAMMER_MAPS
-				const unsigned short* mySonar       = &radarHandler->sonarMaps[gu->myAllyTeam].front();
-				const unsigned short* mySonarJammer = &radarHandler->sonarJammerMaps[gu->myAllyTeam].front();
+				const unsigned short* mySonar       = radarHandler->sonarMaps[gu->myAllyTeam].GetData();
+				const unsigned short* mySonarJammer = radarHandler->sonarJammerMaps[gu->myAllyTeam].GetData();
 			#endif
 
 				const int lowRes = highResInfoTexWanted ? 0 : -1;
@@ -256,10 +256,12 @@ void CBasicMapDamage::Update()
 			}
 		}
 		if (e->ttl == 0) {
-			RecalcArea(x1 - 2, x2 + 2, y1 - 2, y2 + 2);
+			dirtyRects.push_back(SRectangle(x1 - 2, y1 - 2, x2 + 2 + 1, y2 + 2 + 1));
 		}
 	}
 
+	RecalcDirtyAreas();
+
 	while (!explosions.empty() && explosions.front()->ttl == 0) {
 		delete explosions.front();
 		explosions.pop_front();
@@ -268,6 +270,22 @@ void CBasicMapDamage::Update()
 	UpdateLos();
 }
 
+void CBasicMapDamage::RecalcDirtyAreas()
+{
+	if (dirtyRects.empty())
+		return;
+
+	// merges adjacent and splits overlapping rectangles, the
+	// result covers the same squares without any duplicates
+	dirtyRects.Optimize();
+
+	for (CRectangleOptimizer::iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it) {
+		RecalcArea(it->x1, it->x2 - 1, it->z1, it->z2 - 1);
+	}
+
+	dirtyRects.clear();
+}
+
 void CBasicMapDamage::UpdateLos()
 {
 	const int updateSpeed = (int) (relosSize * 0.01f) + 1;
@@ -278,9 +296,9 @@ void CBasicMapDamage::UpdateLos()
 		}
 
 		RelosSquare* rs = &relosQue.front();
-		const std::list<CUnit*>& units = quadField->GetQuadAt(rs->x, rs->y).units;
+		const std::vector<CUnit*>& units = quadField->GetQuadAt(rs->x, rs->y).units;
 
-		std::list<CUnit*>::const_iterator ui;
+		std::vector<CUnit*>::const_iterator ui;
 		for (ui = units.begin(); ui != units.end(); ++ui) {
 			relosUnits.push_back((*ui)->id);
 		}
@@ -4,6 +4,7 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Misc/RectangleOptimizer.h"
 
 #include <deque>
 #include <vector>
@@ -22,6 +23,7 @@ public:
 
 private:
 	void UpdateLos();
+	void RecalcDirtyAreas();
 
 	struct ExploBuilding {
 		/**
@@ -46,6 +48,14 @@ private:
 
 	std::deque<Explo*> explosions;
 
+	/**
+	 * Areas of explosions that expired during the current Update, stored
+	 * with exclusive upper bounds. Overlapping craters are coalesced so
+	 * every square is recalculated (and every consumer notified) at most
+	 * once per frame.
+	 */
+	CRectangleOptimizer dirtyRects;
+
 	struct RelosSquare {
 		int x;
 		int y;
@@ -14,7 +14,9 @@
 #undef far // avoid collision with windef.h
 #undef near
 
-static inline float InterpolateHeight(float x, float y, const float* heightmap)
+// map dimensions are passed in so that batch loops can keep them in registers
+// (stores into their output arrays could otherwise alias gs)
+static inline float InterpolateHeight(float x, float y, const float* heightmap, const float maxx, const float maxz, const int mapxp1)
 {
 	// NOTE:
 	// This isn't a bilinear interpolation. Instead it interpolates
@@ -32,31 +34,31 @@ static inline float InterpolateHeight(float x, float y, const float* heightmap)
 	//    |/        |
 	// BL ---------- BR
 
-	x = Clamp(x, 0.f, float3::maxxpos) / SQUARE_SIZE;
-	y = Clamp(y, 0.f, float3::maxzpos) / SQUARE_SIZE;
+	x = Clamp(x, 0.f, maxx) / SQUARE_SIZE;
+	y = Clamp(y, 0.f, maxz) / SQUARE_SIZE;
 
 	const int isx = x;
 	const int isy = y;
 	const float dx = x - isx;
 	const float dy = y - isy;
-	const int hs = isx + isy * gs->mapxp1;
+	const int hs = isx + isy * mapxp1;
 
 	float h = 0.0f;
 
 	if (dx + dy < 1.0f) {
 		// top-left triangle
-		const float h00 = heightmap[hs                 ];
-		const float h10 = heightmap[hs + 1             ];
-		const float h01 = heightmap[hs     + gs->mapxp1];
+		const float h00 = heightmap[hs              ];
+		const float h10 = heightmap[hs + 1          ];
+		const float h01 = heightmap[hs     + mapxp1];
 		const float xdif = (dx) * (h10 - h00);
 		const float ydif = (dy) * (h01 - h00);
 
 		h = h00 + xdif + ydif;
 	} else {
 		// bottom-right triangle
-		const float h10 = heightmap[hs + 1             ];
-		const float h11 = heightmap[hs + 1 + gs->mapxp1];
-		const float h01 = heightmap[hs     + gs->mapxp1];
+		const float h10 = heightmap[hs + 1          ];
+		const float h11 = heightmap[hs + 1 + mapxp1];
+		const float h01 = heightmap[hs     + mapxp1];
 		const float xdif = (1.0f - dx) * (h01 - h11);
 		const float ydif = (1.0f - dy) * (h10 - h11);
 
@@ -66,6 +68,11 @@ static inline float InterpolateHeight(float x, float y, const float* heightmap)
 	return h;
 }
 
+static inline float InterpolateHeight(float x, float y, const float* heightmap)
+{
+	return InterpolateHeight(x, y, heightmap, float3::maxxpos, float3::maxzpos, gs->mapxp1);
+}
+
 
 static inline float LineGroundSquareCol(
 	const float* heightmap,
@@ -403,6 +410,27 @@ float CGround::GetHeightReal(float x, float y, bool synced) const
 	return InterpolateHeight(x, y, readMap->GetSharedCornerHeightMap(synced));
 }
 
+void CGround::GetHeightsReal(const float3* pos, unsigned int n, float* heights, bool synced) const
+{
+	const float* heightMap = readMap->GetSharedCornerHeightMap(synced);
+	const float maxx = float3::maxxpos;
+	const float maxz = float3::maxzpos;
+	const int mapxp1 = gs->mapxp1;
+
+	for (unsigned int i = 0; i < n; i++) {
+		heights[i] = InterpolateHeight(pos[i].x, pos[i].z, heightMap, maxx, maxz, mapxp1);
+	}
+}
+
+void CGround::GetHeightsAboveWater(const float3* pos, unsigned int n, float* heights, bool synced) const
+{
+	GetHeightsReal(pos, n, heights, synced);
+
+	for (unsigned int i = 0; i < n; i++) {
+		heights[i] = std::max(0.0f, heights[i]);
+	}
+}
+
 float CGround::GetOrigHeight(float x, float y) const
 {
 	return InterpolateHeight(x, y, readMap->GetOriginalHeightMapSynced());
@@ -418,6 +446,21 @@ const float3& CGround::GetNormal(float x, float z, bool synced) const
 	return normalMap[xsquare + zsquare * gs->mapx];
 }
 
+void CGround::GetNormals(const float3* pos, unsigned int n, float3* normals, bool synced) const
+{
+	const float3* normalMap = readMap->GetSharedCenterNormals(synced);
+	const int mapx = gs->mapx;
+	const int mapxm1 = gs->mapxm1;
+	const int mapym1 = gs->mapym1;
+
+	for (unsigned int i = 0; i < n; i++) {
+		const int xsquare = Clamp(int(pos[i].x) / SQUARE_SIZE, 0, mapxm1);
+		const int zsquare = Clamp(int(pos[i].z) / SQUARE_SIZE, 0, mapym1);
+
+		normals[i] = normalMap[xsquare + zsquare * mapx];
+	}
+}
+
 const float3& CGround::GetNormalAboveWater(const float3& p, bool synced) const
 {
 	if (GetHeightReal(p.x, p.z, synced) <= 0.0f)
@@ -24,9 +24,16 @@ public:
 	float GetHeightReal(float x, float y, bool synced = true) const;
 	float GetOrigHeight(float x, float y) const;
 
+	/// batch versions of GetHeightReal and GetHeightAboveWater: heights[i] is
+	/// the height at (pos[i].x, pos[i].z), bit-identical to the per-point call
+	void GetHeightsReal(const float3* pos, unsigned int n, float* heights, bool synced = true) const;
+	void GetHeightsAboveWater(const float3* pos, unsigned int n, float* heights, bool synced = true) const;
+
 	float GetSlope(float x, float y, bool synced = true) const;
 	const float3& GetNormal(float x, float y, bool synced = true) const;
 	const float3& GetNormalAboveWater(const float3& p, bool synced = true) const;
+	/// batch version of GetNormal
+	void GetNormals(const float3* pos, unsigned int n, float3* normals, bool synced = true) const;
 	float3 GetSmoothNormal(float x, float y, bool synced = true) const;
 
 	float LineGroundCol(float3 from, float3 to, bool synced = true) const;
@@ -18,6 +18,7 @@ HeightMapTexture::HeightMapTexture()
 	texID = 0;
 	xSize = 0;
 	ySize = 0;
+	curPBO = 0;
 
 	eventHandler.AddClient(this);
 	Init();
@@ -70,6 +71,8 @@ void HeightMapTexture::Init()
 
 void HeightMapTexture::Kill()
 {
+	pendingUpdates.clear();
+
 	glDeleteTextures(1, &texID);
 	texID = 0;
 	xSize = 0;
@@ -82,30 +85,73 @@ void HeightMapTexture::UnsyncedHeightMapUpdate(const SRectangle& rect)
 	if (texID == 0) {
 		return;
 	}
+
+	pendingUpdates.push_back(rect);
+}
+
+
+void HeightMapTexture::UploadPendingUpdates()
+{
+	if (pendingUpdates.empty()) {
+		return;
+	}
+
+	pendingUpdates.Optimize();
+
+	int numFloats = 0;
+
+	for (CRectangleOptimizer::iterator it = pendingUpdates.begin(); it != pendingUpdates.end(); ++it) {
+		numFloats += (it->x2 - it->x1 + 1) * (it->z2 - it->z1 + 1);
+	}
+
 	const float* heightMap = readMap->GetCornerHeightMapUnsynced();
 
-	const int sizeX = rect.x2 - rect.x1 + 1;
-	const int sizeZ = rect.z2 - rect.z1 + 1;
+	PBO& pbo = pbos[curPBO];
+	curPBO = (curPBO + 1) % NUM_PBOS;
 
 	pbo.Bind();
-	pbo.Resize(sizeX * sizeZ * sizeof(float));
+
+	// keep the storage around, it is reused NUM_PBOS uploads from now
+	if (pbo.GetSize() < (numFloats * sizeof(float))) {
+		pbo.Resize(numFloats * sizeof(float));
+	}
 
 	{
-		float* buf = (float*) pbo.MapBuffer();
+		float* buf = (float*) pbo.MapBuffer(0, numFloats * sizeof(float));
 
-		for (int z = 0; z < sizeZ; z++) {
-			const void* src = heightMap + rect.x1 + (z + rect.z1) * xSize;
-			      void* dst = buf + z * sizeX;
+		for (CRectangleOptimizer::iterator it = pendingUpdates.begin(); it != pendingUpdates.end(); ++it) {
+			const int sizeX = it->x2 - it->x1 + 1;
+			const int sizeZ = it->z2 - it->z1 + 1;
 
-			memcpy(dst, src, sizeX * sizeof(float));
+			for (int z = 0; z < sizeZ; z++) {
+				const void* src = heightMap + it->x1 + (z + it->z1) * xSize;
+				      void* dst = buf + z * sizeX;
+
+				memcpy(dst, src, sizeX * sizeof(float));
+			}
+
+			buf += (sizeX * sizeZ);
 		}
 	}
 
 	pbo.UnmapBuffer();
 
 	glBindTexture(GL_TEXTURE_2D, texID);
-	glTexSubImage2D(GL_TEXTURE_2D, 0,
-		rect.x1, rect.z1, sizeX, sizeZ,
-		GL_LUMINANCE, GL_FLOAT, pbo.GetPtr());
-	pbo.Unbind();
+
+	int offset = 0;
+
+	for (CRectangleOptimizer::iterator it = pendingUpdates.begin(); it != pendingUpdates.end(); ++it) {
+		const int sizeX = it->x2 - it->x1 + 1;
+		const int sizeZ = it->z2 - it->z1 + 1;
+
+		glTexSubImage2D(GL_TEXTURE_2D, 0,
+			it->x1, it->z1, sizeX, sizeZ,
+			GL_LUMINANCE, GL_FLOAT, pbo.GetPtr(offset * sizeof(float)));
+
+		offset += (sizeX * sizeZ);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	pbo.Unbind(false);
+	pendingUpdates.clear();
 }
@@ -6,7 +6,13 @@
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/PBO.h"
 #include "System/EventClient.h"
+#include "System/Misc/RectangleOptimizer.h"
 
+/**
+ * Corner heightmap as a float texture. Changed rectangles are collected
+ * and only uploaded (all of them through one PBO of a small ring) when
+ * the texture is asked for, so nothing is transferred while no one uses it.
+ */
 class HeightMapTexture : public CEventClient
 {
 	public:
@@ -23,7 +29,7 @@ class HeightMapTexture : public CEventClient
 		HeightMapTexture();
 		~HeightMapTexture();
 
-		GLuint GetTextureID() const { return texID; }
+		GLuint GetTextureID() { UploadPendingUpdates(); return texID; }
 
 		int GetSizeX() const { return xSize; }
 		int GetSizeY() const { return ySize; }
@@ -31,11 +37,20 @@ class HeightMapTexture : public CEventClient
 	private:
 		void Init();
 		void Kill();
+		void UploadPendingUpdates();
+
+		// a PBO is only written again NUM_PBOS uploads later, by which
+		// time the GPU is done reading it and mapping it does not stall
+		static const int NUM_PBOS = 3;
 
 		GLuint texID;
 		int xSize;
 		int ySize;
-		PBO pbo;
+
+		PBO pbos[NUM_PBOS];
+		int curPBO;
+
+		CRectangleOptimizer pendingUpdates;
 };
 
 extern HeightMapTexture* heightMapTexture;
@@ -25,6 +25,8 @@
 #ifdef USE_UNSYNCED_HEIGHTMAP
 #include "Game/GlobalUnsynced.h"
 #include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/SmoothHeightMesh.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #endif
 
 //////////////////////////////////////////////////////////////////////
@@ -331,6 +333,13 @@ void CReadMap::UpdateHeightMapSynced(SRectangle rect, bool initialize)
 	UpdateFaceNormals(rect, initialize);
 	UpdateSlopemap(rect, initialize); // must happen after UpdateFaceNormals()!
 
+	// same half-resolution range as UpdateSlopemap (no-op during initialization)
+	CMoveMath::UpdateSpeedModTables((rect.x1 / 2) - 1, (rect.z1 / 2) - 1, (rect.x2 / 2) + 1, (rect.z2 / 2) + 1);
+
+	// the smooth mesh does not exist yet during initialization
+	if (smoothGround != NULL)
+		smoothGround->UpdateSmoothMesh(rect);
+
 #ifdef USE_UNSYNCED_HEIGHTMAP
 	// push the unsynced update
 	if (initialize) {
@@ -365,7 +374,7 @@ void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize)
 {
 	const float* heightmapSynced = GetCornerHeightMapSynced();
 
-	for (int y = rect.z1; y <= rect.z2; y++) {
+	for_mt(rect.z1, rect.z2 + 1, [&](const int y) {
 		for (int x = rect.x1; x <= rect.x2; x++) {
 			const int idxTL = (y    ) * gs->mapxp1 + x;
 			const int idxTR = (y    ) * gs->mapxp1 + x + 1;
@@ -379,7 +388,7 @@ void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize)
 				heightmapSynced[idxBR];
 			centerHeightMap[y * gs->mapx + x] = height * 0.25f;
 		}
-	}
+	});
 }
 
 
@@ -393,7 +402,8 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 		const int sy = (rect.z1 >> i) & (~1);
 		const int ey = (rect.z2 >> i);
 
-		for (int y = sy; y < ey; y += 2) {
+		// levels depend on each other, rows within a level do not
+		for_mt(sy, ey, 2, [&](const int y) {
 			for (int x = sx; x < ex; x += 2) {
 				const float height =
 					mipPointerHeightMaps[i][(x    ) + (y    ) * hmapx] +
@@ -402,7 +412,7 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 					mipPointerHeightMaps[i][(x + 1) + (y + 1) * hmapx];
 				mipPointerHeightMaps[i + 1][(x / 2) + (y / 2) * hmapx / 2] = height * 0.25f;
 			}
-		}
+		});
 	}
 }
 
@@ -483,7 +493,7 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 	const int sy = std::max(0, (rect.z1 / 2) - 1);
 	const int ey = std::min(gs->hmapy - 1, (rect.z2 / 2) + 1);
 
-	for (int y = sy; y <= ey; y++) {
+	for_mt(sy, ey + 1, [&](const int y) {
 		for (int x = sx; x <= ex; x++) {
 			const int idx0 = (y*2    ) * (gs->mapx) + x*2;
 			const int idx1 = (y*2 + 1) * (gs->mapx) + x*2;
@@ -514,7 +524,7 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 
 			slopeMap[y * gs->hmapx + x] = 1.0f - slope;
 		}
-	}
+	});
 }
 
 
@@ -0,0 +1,374 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ChunkedMeshDrawer.h"
+#include "Game/Camera.h"
+#include "Map/ReadMap.h"
+#include "Map/SMF/SMFReadMap.h"
+#include "Map/SMF/SMFGroundDrawer.h"
+#include "Rendering/GlobalRendering.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "System/EventHandler.h"
+#include "System/myMath.h"
+#include "System/Rectangle.h"
+#include "System/TimeProfiler.h"
+
+#include <algorithm>
+
+
+static const int NUM_GRID_VERTICES = (CChunkedMeshDrawer::PATCH_SIZE + 1) * (CChunkedMeshDrawer::PATCH_SIZE + 1);
+static const int NUM_EDGE_VERTICES = (CChunkedMeshDrawer::PATCH_SIZE + 1);
+static const int NUM_PATCH_VERTICES = NUM_GRID_VERTICES + 4 * NUM_EDGE_VERTICES;
+
+// half the diagonal of a patch, in elmos
+static const float PATCH_RADIUS = CChunkedMeshDrawer::PATCH_SIZE * SQUARE_SIZE * 0.7071f;
+
+
+static inline int GridVertex(int x, int z) {
+	return (z * (CChunkedMeshDrawer::PATCH_SIZE + 1) + x);
+}
+
+static inline int EdgeVertex(int edge, int i) {
+	const int ps = CChunkedMeshDrawer::PATCH_SIZE;
+
+	switch (edge) {
+		case 0: { return GridVertex( 0,  i); } break;
+		case 1: { return GridVertex(ps,  i); } break;
+		case 2: { return GridVertex( i,  0); } break;
+		case 3: { return GridVertex( i, ps); } break;
+	}
+
+	return 0;
+}
+
+static inline int SkirtVertex(int edge, int i) {
+	return (NUM_GRID_VERTICES + edge * NUM_EDGE_VERTICES + i);
+}
+
+
+
+CChunkedMeshDrawer::CChunkedMeshDrawer(CSMFReadMap* rm, CSMFGroundDrawer* gd)
+	: CEventClient("[CChunkedMeshDrawer]", 271990, false)
+	, smfReadMap(rm)
+	, smfGroundDrawer(gd)
+	, indexBuffer(0)
+{
+	eventHandler.AddClient(this);
+
+	numPatchesX = gs->mapx / PATCH_SIZE;
+	numPatchesY = gs->mapy / PATCH_SIZE;
+
+	patches.resize(numPatchesX * numPatchesY);
+
+	InitIndexBuffer();
+
+	for (int pz = 0; pz < numPatchesY; ++pz) {
+		for (int px = 0; px < numPatchesX; ++px) {
+			UpdatePatchVertices(px, pz, 0, 0, PATCH_SIZE, PATCH_SIZE);
+		}
+	}
+}
+
+CChunkedMeshDrawer::~CChunkedMeshDrawer()
+{
+	for (std::vector<MeshPatch>::iterator it = patches.begin(); it != patches.end(); ++it) {
+		glDeleteBuffersARB(1, &it->vertexBuffer);
+	}
+
+	glDeleteBuffersARB(1, &indexBuffer);
+}
+
+
+
+void CChunkedMeshDrawer::InitIndexBuffer()
+{
+	std::vector<GLushort> indices;
+
+	for (int lod = 0; lod < NUM_LODS; ++lod) {
+		const int step = 1 << lod;
+
+		LodIndexRanges& ranges = lodRanges[lod];
+		ranges.grid.start = indices.size();
+
+		// two front-facing (seen from above) triangles per grid cell
+		for (int z = 0; z < PATCH_SIZE; z += step) {
+			for (int x = 0; x < PATCH_SIZE; x += step) {
+				const GLushort v00 = GridVertex(x,        z       );
+				const GLushort v10 = GridVertex(x + step, z       );
+				const GLushort v01 = GridVertex(x,        z + step);
+				const GLushort v11 = GridVertex(x + step, z + step);
+
+				indices.push_back(v00); indices.push_back(v01); indices.push_back(v10);
+				indices.push_back(v10); indices.push_back(v01); indices.push_back(v11);
+			}
+		}
+
+		ranges.grid.count = indices.size() - ranges.grid.start;
+
+		// skirt quads hang down from each edge and face away from the patch
+		for (int edge = 0; edge < NUM_EDGES; ++edge) {
+			const bool flip = (edge == EDGE_RIGHT || edge == EDGE_TOP);
+
+			ranges.skirts[edge].start = indices.size();
+
+			for (int i = 0; i < PATCH_SIZE; i += step) {
+				const GLushort e0 = EdgeVertex(edge, i);
+				const GLushort e1 = EdgeVertex(edge, i + step);
+				const GLushort k0 = SkirtVertex(edge, i);
+				const GLushort k1 = SkirtVertex(edge, i + step);
+
+				if (flip) {
+					indices.push_back(e0); indices.push_back(e1); indices.push_back(k0);
+					indices.push_back(e1); indices.push_back(k1); indices.push_back(k0);
+				} else {
+					indices.push_back(e0); indices.push_back(k0); indices.push_back(e1);
+					indices.push_back(e1); indices.push_back(k0); indices.push_back(k1);
+				}
+			}
+
+			ranges.skirts[edge].count = indices.size() - ranges.skirts[edge].start;
+		}
+	}
+
+	glGenBuffersARB(1, &indexBuffer);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indexBuffer);
+	glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indices.size() * sizeof(GLushort), &indices[0], GL_STATIC_DRAW_ARB);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+}
+
+
+/**
+ * Updates the heights of the patch-local vertex rectangle [x1,x2]x[z1,z2]
+ * and re-uploads only those rows (plus the skirts) to the patch's VBO
+ */
+void CChunkedMeshDrawer::UpdatePatchVertices(int px, int pz, int x1, int z1, int x2, int z2)
+{
+	MeshPatch& patch = patches[pz * numPatchesX + px];
+
+	const float* hm = readMap->GetCornerHeightMapUnsynced();
+
+	const int wx = px * PATCH_SIZE;
+	const int wz = pz * PATCH_SIZE;
+
+	const bool init = patch.vertices.empty();
+
+	if (init) {
+		patch.vertices.resize(NUM_PATCH_VERTICES);
+
+		x1 = 0; x2 = PATCH_SIZE;
+		z1 = 0; z2 = PATCH_SIZE;
+	}
+
+	for (int z = z1; z <= z2; z++) {
+		for (int x = x1; x <= x2; x++) {
+			patch.vertices[GridVertex(x, z)] = float3((wx + x) * SQUARE_SIZE, hm[(wz + z) * gs->mapxp1 + (wx + x)], (wz + z) * SQUARE_SIZE);
+		}
+	}
+
+	float minHeight = patch.vertices[0].y;
+	float maxHeight = patch.vertices[0].y;
+
+	for (int i = 0; i < NUM_GRID_VERTICES; i++) {
+		minHeight = std::min(minHeight, patch.vertices[i].y);
+		maxHeight = std::max(maxHeight, patch.vertices[i].y);
+	}
+
+	// no level can be off by more than the patch's height range,
+	// so skirts of that depth always cover the cracks along edges
+	const float skirtDepth = (maxHeight - minHeight) + SQUARE_SIZE;
+
+	for (int edge = 0; edge < NUM_EDGES; ++edge) {
+		for (int i = 0; i <= PATCH_SIZE; i++) {
+			patch.vertices[SkirtVertex(edge, i)] = patch.vertices[EdgeVertex(edge, i)] - (UpVector * skirtDepth);
+		}
+	}
+
+	patch.minHeight = minHeight - skirtDepth;
+	patch.maxHeight = maxHeight;
+
+	UpdatePatchErrors(patch);
+
+	if (init) {
+		glGenBuffersARB(1, &patch.vertexBuffer);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, patch.vertexBuffer);
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB, NUM_PATCH_VERTICES * sizeof(float3), &patch.vertices[0], GL_STATIC_DRAW_ARB);
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+		return;
+	}
+
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, patch.vertexBuffer);
+
+	for (int z = z1; z <= z2; z++) {
+		glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, GridVertex(x1, z) * sizeof(float3), (x2 - x1 + 1) * sizeof(float3), &patch.vertices[GridVertex(x1, z)]);
+	}
+
+	glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, NUM_GRID_VERTICES * sizeof(float3), 4 * NUM_EDGE_VERTICES * sizeof(float3), &patch.vertices[NUM_GRID_VERTICES]);
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+}
+
+/**
+ * For each level, finds the largest distance between a full-resolution
+ * vertex and the coarse triangle covering it
+ */
+void CChunkedMeshDrawer::UpdatePatchErrors(MeshPatch& patch)
+{
+	patch.lodErrors[0] = 0.0f;
+
+	for (int lod = 1; lod < NUM_LODS; ++lod) {
+		const int step = 1 << lod;
+		const float invStep = 1.0f / step;
+
+		float maxError = patch.lodErrors[lod - 1];
+
+		for (int z = 0; z <= PATCH_SIZE; z++) {
+			const int cz = std::min((z / step) * step, PATCH_SIZE - step);
+			const float fz = (z - cz) * invStep;
+
+			for (int x = 0; x <= PATCH_SIZE; x++) {
+				const int cx = std::min((x / step) * step, PATCH_SIZE - step);
+				const float fx = (x - cx) * invStep;
+
+				const float h00 = patch.vertices[GridVertex(cx,        cz       )].y;
+				const float h10 = patch.vertices[GridVertex(cx + step, cz       )].y;
+				const float h01 = patch.vertices[GridVertex(cx,        cz + step)].y;
+				const float h11 = patch.vertices[GridVertex(cx + step, cz + step)].y;
+
+				// cells are split along the (x+1,z)-(x,z+1) diagonal
+				const float h = ((fx + fz) <= 1.0f)?
+					(h00 + fx * (h10 - h00) + fz * (h01 - h00)):
+					(h11 + (1.0f - fx) * (h01 - h11) + (1.0f - fz) * (h10 - h11));
+
+				maxError = std::max(maxError, math::fabs(patch.vertices[GridVertex(x, z)].y - h));
+			}
+		}
+
+		patch.lodErrors[lod] = maxError;
+	}
+}
+
+
+int CChunkedMeshDrawer::SelectPatchLod(const MeshPatch& patch, int px, int pz, const CCamera* cam) const
+{
+	const float3 center(
+		(px * PATCH_SIZE + PATCH_SIZE / 2) * SQUARE_SIZE,
+		(patch.minHeight + patch.maxHeight) * 0.5f,
+		(pz * PATCH_SIZE + PATCH_SIZE / 2) * SQUARE_SIZE
+	);
+
+	const float dist = std::max(cam->GetPos().distance(center) - PATCH_RADIUS, 1.0f);
+	const float screenScale = (globalRendering->viewSizeY * 0.5f) / (cam->GetTanHalfFov() * dist);
+
+	// tolerated on-screen error in pixels, 1.5px at the default detail
+	const float maxPixelError = 90.0f / std::max(smfGroundDrawer->GetGroundDetail(), 1);
+
+	for (int lod = NUM_LODS - 1; lod > 0; --lod) {
+		if ((patch.lodErrors[lod] * screenScale) <= maxPixelError) {
+			return lod;
+		}
+	}
+
+	return 0;
+}
+
+bool CChunkedMeshDrawer::DrawSkirt(int px, int pz, int edge) const
+{
+	int nx = px;
+	int nz = pz;
+
+	switch (edge) {
+		case EDGE_LEFT:   { nx -= 1; } break;
+		case EDGE_RIGHT:  { nx += 1; } break;
+		case EDGE_TOP:    { nz -= 1; } break;
+		case EDGE_BOTTOM: { nz += 1; } break;
+	}
+
+	// map edges are covered by the border
+	if (nx < 0 || nx >= numPatchesX) return false;
+	if (nz < 0 || nz >= numPatchesY) return false;
+
+	// equal levels share all edge vertices, so there is no crack
+	return (patches[nz * numPatchesX + nx].lod != patches[pz * numPatchesX + px].lod);
+}
+
+
+
+void CChunkedMeshDrawer::Update()
+{
+	SCOPED_TIMER("ChunkedMesh::Update");
+
+	for (int pz = 0; pz < numPatchesY; ++pz) {
+		for (int px = 0; px < numPatchesX; ++px) {
+			MeshPatch& patch = patches[pz * numPatchesX + px];
+			patch.lod = SelectPatchLod(patch, px, pz, cam2);
+		}
+	}
+}
+
+void CChunkedMeshDrawer::DrawMesh(const DrawPass::e& drawPass)
+{
+	const bool inShadowPass = (drawPass == DrawPass::Shadow);
+	const CCamera* cam = (inShadowPass)? camera: cam2;
+
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, indexBuffer);
+	glEnableClientState(GL_VERTEX_ARRAY);
+
+	for (int pz = 0; pz < numPatchesY; ++pz) {
+		for (int px = 0; px < numPatchesX; ++px) {
+			const MeshPatch& patch = patches[pz * numPatchesX + px];
+
+			const float3 mins(( px      * PATCH_SIZE) * SQUARE_SIZE, patch.minHeight, ( pz      * PATCH_SIZE) * SQUARE_SIZE);
+			const float3 maxs(((px + 1) * PATCH_SIZE) * SQUARE_SIZE, patch.maxHeight, ((pz + 1) * PATCH_SIZE) * SQUARE_SIZE);
+
+			if (!cam->InView(mins, maxs))
+				continue;
+
+			if (!inShadowPass)
+				smfGroundDrawer->SetupBigSquare(px, pz);
+
+			const LodIndexRanges& ranges = lodRanges[patch.lod];
+
+			glBindBufferARB(GL_ARRAY_BUFFER_ARB, patch.vertexBuffer);
+			glVertexPointer(3, GL_FLOAT, 0, 0);
+			glDrawRangeElements(GL_TRIANGLES, 0, NUM_PATCH_VERTICES - 1, ranges.grid.count, GL_UNSIGNED_SHORT, (GLvoid*) (ranges.grid.start * sizeof(GLushort)));
+
+			for (int edge = 0; edge < NUM_EDGES; ++edge) {
+				if (!DrawSkirt(px, pz, edge))
+					continue;
+
+				glDrawRangeElements(GL_TRIANGLES, 0, NUM_PATCH_VERTICES - 1, ranges.skirts[edge].count, GL_UNSIGNED_SHORT, (GLvoid*) (ranges.skirts[edge].start * sizeof(GLushort)));
+			}
+		}
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+}
+
+
+
+void CChunkedMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect)
+{
+	// patches share their edge vertices, so an update on an edge hits both
+	const int pxs = std::max(0, std::min(numPatchesX - 1, (rect.x1 - 1) / PATCH_SIZE));
+	const int pxe = std::max(0, std::min(numPatchesX - 1,  rect.x2      / PATCH_SIZE));
+	const int pzs = std::max(0, std::min(numPatchesY - 1, (rect.z1 - 1) / PATCH_SIZE));
+	const int pze = std::max(0, std::min(numPatchesY - 1,  rect.z2      / PATCH_SIZE));
+
+	for (int pz = pzs; pz <= pze; ++pz) {
+		for (int px = pxs; px <= pxe; ++px) {
+			const int wx = px * PATCH_SIZE;
+			const int wz = pz * PATCH_SIZE;
+
+			const int x1 = std::max(rect.x1 - wx, 0);
+			const int z1 = std::max(rect.z1 - wz, 0);
+			const int x2 = std::min(rect.x2 - wx, int(PATCH_SIZE));
+			const int z2 = std::min(rect.z2 - wz, int(PATCH_SIZE));
+
+			if (x1 > x2 || z1 > z2)
+				continue;
+
+			UpdatePatchVertices(px, pz, x1, z1, x2, z2);
+		}
+	}
+}
@@ -0,0 +1,114 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _CHUNKED_MESH_DRAWER_H_
+#define _CHUNKED_MESH_DRAWER_H_
+
+#include "Map/SMF/IMeshDrawer.h"
+#include "Rendering/GL/myGL.h"
+#include "System/EventClient.h"
+#include "System/float3.h"
+#include <vector>
+
+
+class CCamera;
+class CSMFReadMap;
+class CSMFGroundDrawer;
+
+
+/**
+ * Map mesh drawer implementation using static chunked LOD
+ *
+ * Every patch keeps all its vertices (with heights) in a VBO that is only
+ * touched by UnsyncedHeightMapUpdate, and all patches share one index
+ * buffer holding a regular grid per LOD level. Per frame the CPU merely
+ * picks a level for each patch from its precomputed geometric error. The
+ * cracks between patches of different levels are hidden by skirts.
+ */
+class CChunkedMeshDrawer : public IMeshDrawer, public CEventClient
+{
+public:
+	// CEventClient interface
+	bool WantsEvent(const std::string& eventName) {
+		return (eventName == "UnsyncedHeightMapUpdate");
+	}
+	bool GetFullRead() const { return true; }
+	int  GetReadAllyTeam() const { return AllAccessTeam; }
+
+	void UnsyncedHeightMapUpdate(const SRectangle& rect);
+
+public:
+	CChunkedMeshDrawer(CSMFReadMap* rm, CSMFGroundDrawer* gd);
+	~CChunkedMeshDrawer();
+
+	void Update();
+
+	void DrawMesh(const DrawPass::e& drawPass);
+	void DrawBorderMesh(const DrawPass::e& drawPass) {}
+
+	static bool IsSupported() { return GLEW_ARB_vertex_buffer_object; }
+
+public:
+	// heightmap squares per patch side, same as a big texture square
+	static const int PATCH_SIZE = 128;
+	// grid steps 1, 2, ..., 64
+	static const int NUM_LODS = 7;
+
+private:
+	enum {
+		EDGE_LEFT   = 0, // x = 0
+		EDGE_RIGHT  = 1, // x = PATCH_SIZE
+		EDGE_TOP    = 2, // z = 0
+		EDGE_BOTTOM = 3, // z = PATCH_SIZE
+		NUM_EDGES   = 4,
+	};
+
+	struct IndexRange {
+		unsigned int start;
+		unsigned int count;
+	};
+
+	struct LodIndexRanges {
+		IndexRange grid;
+		IndexRange skirts[NUM_EDGES];
+	};
+
+	struct MeshPatch {
+		MeshPatch()
+			: vertexBuffer(0)
+			, lod(0)
+			, minHeight(0.0f)
+			, maxHeight(0.0f)
+		{}
+
+		std::vector<float3> vertices;
+		GLuint vertexBuffer;
+
+		float lodErrors[NUM_LODS]; //< max. height error (in elmos) at each level
+
+		int lod;
+
+		float minHeight; //< includes the skirts
+		float maxHeight;
+	};
+
+private:
+	void InitIndexBuffer();
+	void UpdatePatchVertices(int px, int pz, int x1, int z1, int x2, int z2);
+	void UpdatePatchErrors(MeshPatch& patch);
+	int SelectPatchLod(const MeshPatch& patch, int px, int pz, const CCamera* cam) const;
+	bool DrawSkirt(int px, int pz, int edge) const;
+
+private:
+	CSMFReadMap* smfReadMap;
+	CSMFGroundDrawer* smfGroundDrawer;
+
+	int numPatchesX;
+	int numPatchesY;
+
+	std::vector<MeshPatch> patches;
+
+	GLuint indexBuffer;
+	LodIndexRanges lodRanges[NUM_LODS];
+};
+
+#endif // _CHUNKED_MESH_DRAWER_H_
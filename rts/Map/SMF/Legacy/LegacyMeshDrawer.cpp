@@ -104,13 +104,13 @@ bool CLegacyMeshDrawer::BigTexSquareRowVisible(const CCamera* cam, int bty) cons
 
 
 
-void CLegacyMeshDrawer::FindRange(const CCamera* cam, int& xs, int& xe, int y, int lod)
-{
+void CLegacyMeshDrawer::FindRange(
+	const std::vector<CCamera::FrustumLine>& negSides,
+	const std::vector<CCamera::FrustumLine>& posSides,
+	int& xs, int& xe, int y, int lod
+) {
 	int xt0, xt1;
 
-	const std::vector<CCamera::FrustumLine> negSides = cam->GetNegFrustumSides();
-	const std::vector<CCamera::FrustumLine> posSides = cam->GetPosFrustumSides();
-
 	std::vector<CCamera::FrustumLine>::const_iterator fli;
 
 	for (fli = negSides.begin(); fli != negSides.end(); ++fli) {
@@ -161,6 +161,8 @@ void CLegacyMeshDrawer::DoDrawGroundRow(const CCamera* cam, int bty)
 	//! only process the necessary big squares in the x direction
 	const int bigSquareSizeY = bty * smfReadMap->bigSquareSize;
 
+	// copied once per row (the camera hands out copies for GML) and
+	// shared by all FindRange calls below, which run once per sub-row
 	const std::vector<CCamera::FrustumLine> negSides = cam->GetNegFrustumSides();
 	const std::vector<CCamera::FrustumLine> posSides = cam->GetPosFrustumSides();
 
@@ -253,7 +255,7 @@ void CLegacyMeshDrawer::DoDrawGroundRow(const CCamera* cam, int bty)
 				int xs = xstart;
 				int xe = xend;
 
-				FindRange(cam2, /*inout*/ xs, /*inout*/ xe, y, lod);
+				FindRange(negSides, posSides, /*inout*/ xs, /*inout*/ xe, y, lod);
 
 				// If FindRange modifies (xs, xe) to a (less then) empty range,
 				// continue to the next row.
@@ -484,7 +486,7 @@ void CLegacyMeshDrawer::DoDrawGroundRow(const CCamera* cam, int bty)
 				y = maxly;
 				int xs = std::max(xstart - lod, mintx);
 				int xe = std::min(xend + lod,   maxtx);
-				FindRange(cam2, xs, xe, y, lod);
+				FindRange(negSides, posSides, xs, xe, y, lod);
 
 				if (xs < xe) {
 					x = xs;
@@ -522,7 +524,7 @@ void CLegacyMeshDrawer::DoDrawGroundRow(const CCamera* cam, int bty)
 				y = minly - lod;
 				int xs = std::max(xstart - lod, mintx);
 				int xe = std::min(xend + lod,   maxtx);
-				FindRange(cam2, xs, xe, y, lod);
+				FindRange(negSides, posSides, xs, xe, y, lod);
 
 				if (xs < xe) {
 					x = xs;
@@ -3,12 +3,13 @@
 #ifndef _LEGACY_MESH_DRAWER_H_
 #define _LEGACY_MESH_DRAWER_H_
 
+#include "Game/Camera.h"
 #include "Map/SMF/IMeshDrawer.h"
 #include "System/float3.h"
 
+#include <vector>
 
 class CVertexArray;
-class CCamera;
 class CSMFReadMap;
 class CSMFGroundDrawer;
 
@@ -31,7 +32,11 @@ public:
 private:
 	void UpdateLODParams(const DrawPass::e& drawPass);
 
-	void FindRange(const CCamera* cam, int& xs, int& xe, int y, int lod);
+	void FindRange(
+		const std::vector<CCamera::FrustumLine>& negSides,
+		const std::vector<CCamera::FrustumLine>& posSides,
+		int& xs, int& xe, int y, int lod
+	);
 	inline bool BigTexSquareRowVisible(const CCamera* cam, int) const;
 
 	inline void DrawVertexAQ(CVertexArray* ma, int x, int y);
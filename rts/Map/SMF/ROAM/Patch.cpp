@@ -81,6 +81,12 @@ void CTriNodePool::ResetAll()
 }
 
 
+bool CTriNodePool::CanGrow()
+{
+	return (poolSize < MAX_POOL_SIZE);
+}
+
+
 CTriNodePool* CTriNodePool::GetPool()
 {
 	const size_t th_id = ThreadPool::GetThreadNum();
@@ -137,6 +143,7 @@ Patch::Patch()
 	, m_WorldY(-1)
 	//, minHeight(FLT_MAX)
 	//, maxHeight(FLT_MIN)
+	, uploadedRenderMode(0)
 	, vboVerticesUploaded(false)
 	, triList(0)
 	, vertexBuffer(0)
@@ -225,6 +232,8 @@ void Patch::UpdateHeightMap(const SRectangle& rect)
 
 	VBOUploadVertices();
 	m_isDirty = true;
+	// display lists contain the vertices, recompile them
+	uploadedRenderMode = 0;
 }
 
 
@@ -395,9 +404,15 @@ void Patch::RecursRender(TriTreeNode* const tri, const int2 left, const int2 rig
 
 void Patch::GenerateIndices()
 {
+	// double-buffered: keeps the capacity of both vectors and lets
+	// Upload skip patches whose tessellation did not change
+	lastIndices.swap(indices);
 	indices.clear();
 	RecursRender(&m_BaseLeft,  int2(0, PATCH_SIZE), int2(PATCH_SIZE, 0), int2(0, 0)                  );
 	RecursRender(&m_BaseRight, int2(PATCH_SIZE, 0), int2(0, PATCH_SIZE), int2(PATCH_SIZE, PATCH_SIZE));
+
+	if (indices != lastIndices)
+		uploadedRenderMode = 0;
 }
 
 
@@ -635,6 +650,11 @@ void Patch::GenerateBorderIndices(CVertexArray* va)
 
 void Patch::Upload()
 {
+	if (uploadedRenderMode == renderMode)
+		return;
+
+	uploadedRenderMode = renderMode;
+
 	switch (renderMode) {
 		case DL:
 			glNewList(triList, GL_COMPILE);
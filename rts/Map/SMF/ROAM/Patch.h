@@ -68,6 +68,7 @@ public:
 	static void InitPools(const size_t newPoolSize = POOL_SIZE);
 	static void FreePools();
 	static void ResetAll();
+	static bool CanGrow();
 	inline static CTriNodePool* GetPool();
 
 public:
@@ -175,6 +176,9 @@ protected:
 
 	std::vector<float> vertices; // Why yes, this IS a mind bogglingly wasteful thing to do: TODO: remove this for both the Displaylist and the VBO implementations (only really needed for vertexarrays)
 	std::vector<unsigned int> indices;
+	std::vector<unsigned int> lastIndices; //< indices of the previous tessellation, i.e. those in the GL buffers
+
+	int uploadedRenderMode; //< mode the GL buffers were filled for, 0 if they are stale
 
 	bool vboVerticesUploaded;
 
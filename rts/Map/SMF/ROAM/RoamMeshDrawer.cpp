@@ -111,7 +111,9 @@ void CRoamMeshDrawer::Update()
 
 	{
 		SCOPED_TIMER("ROAM::ComputeVariance");
-		for (int i = 0; i < (numPatchesX * numPatchesY); ++i) { //FIXME multithread?
+		std::vector<Patch*> dirtyPatches;
+
+		for (int i = 0; i < (numPatchesX * numPatchesY); ++i) {
 			Patch& p = roamPatches[i];
 		#if (RETESSELLATE_MODE == 2)
 			if (p.IsVisible()) {
@@ -121,7 +123,7 @@ void CRoamMeshDrawer::Update()
 				}
 				if (p.IsDirty()) {
 					//FIXME don't retessellate on small heightmap changes?
-					p.ComputeVariance();
+					dirtyPatches.push_back(&p);
 					retessellate = true;
 				}
 			} else {
@@ -134,11 +136,16 @@ void CRoamMeshDrawer::Update()
 			}
 			if (p.IsVisible() && p.IsDirty()) {
 				//FIXME don't retessellate on small heightmap changes?
-				p.ComputeVariance();
+				dirtyPatches.push_back(&p);
 				retessellate = true;
 			}
 		#endif
 		}
+
+		// variance trees only depend on the patch's own heightmap area
+		for_mt(0, dirtyPatches.size(), [&](const int i){
+			dirtyPatches[i]->ComputeVariance();
+		});
 	}
 
 	// Further conditions that can cause a retessellation
@@ -156,8 +163,12 @@ void CRoamMeshDrawer::Update()
 		{ SCOPED_TIMER("ROAM::Tessellate");
 			//FIXME this tessellates with current camera + viewRadius
 			//  so it doesn't retessellate patches that are e.g. only vis. in the shadow frustum
-			Reset();
-			retessellateAgain = Tessellate(cam->GetPos(), smfGroundDrawer->GetGroundDetail());
+			// Reset grows the node pools if the last pass ran out of them,
+			// so retry right away instead of drawing a partial mesh
+			do {
+				Reset();
+				retessellateAgain = Tessellate(cam->GetPos(), smfGroundDrawer->GetGroundDetail());
+			} while (retessellateAgain && CTriNodePool::CanGrow());
 		}
 
 		{ SCOPED_TIMER("ROAM::GenerateIndexArray");
@@ -170,6 +181,7 @@ void CRoamMeshDrawer::Update()
 		}
 
 		{ SCOPED_TIMER("ROAM::Upload");
+			// only patches whose indices changed are re-uploaded
 			for (std::vector<Patch>::iterator it = roamPatches.begin(); it != roamPatches.end(); ++it) {
 				if (it->IsVisible()) {
 					it->Upload();
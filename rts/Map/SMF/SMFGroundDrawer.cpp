@@ -7,6 +7,7 @@
 #include "Game/Camera.h"
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
+#include "Map/SMF/Chunked/ChunkedMeshDrawer.h"
 #include "Map/SMF/Legacy/LegacyMeshDrawer.h"
 #include "Map/SMF/ROAM/RoamMeshDrawer.h"
 #include "Rendering/GlobalRendering.h"
@@ -39,6 +40,10 @@ CONFIG(int, ROAM)
 	.minimumValue(0)
 	.maximumValue(Patch::VA)
 	.description("Use ROAM for terrain mesh rendering. 0:=disable ROAM, 1=VBO mode, 2=DL mode, 3=VA mode");
+CONFIG(bool, ChunkedTerrainMesh)
+	.defaultValue(false)
+	.safemodeValue(false)
+	.description("Render the terrain from static per-patch VBOs with precomputed detail levels, which needs no per-frame mesh generation on the CPU. Takes precedence over ROAM.");
 
 
 CSMFGroundDrawer::CSMFGroundDrawer(CSMFReadMap* rm)
@@ -46,7 +51,11 @@ CSMFGroundDrawer::CSMFGroundDrawer(CSMFReadMap* rm)
 	, meshDrawer(NULL)
 {
 	groundTextures = new CSMFGroundTextures(smfMap);
-	meshDrawer = SwitchMeshDrawer((!!configHandler->GetInt("ROAM")) ? SMF_MESHDRAWER_ROAM : SMF_MESHDRAWER_LEGACY);
+	if (configHandler->GetBool("ChunkedTerrainMesh")) {
+		meshDrawer = SwitchMeshDrawer(SMF_MESHDRAWER_CHUNKED);
+	} else {
+		meshDrawer = SwitchMeshDrawer((!!configHandler->GetInt("ROAM")) ? SMF_MESHDRAWER_ROAM : SMF_MESHDRAWER_LEGACY);
+	}
 
 	smfRenderStateSSP = ISMFRenderState::GetInstance(globalRendering->haveARB, globalRendering->haveGLSL);
 	smfRenderStateFFP = ISMFRenderState::GetInstance(                   false,                     false);
@@ -95,6 +104,8 @@ CSMFGroundDrawer::~CSMFGroundDrawer()
 	// if ROAM _was_ enabled, the configvar is written in CRoamMeshDrawer's dtor
 	if (dynamic_cast<CRoamMeshDrawer*>(meshDrawer) == NULL)
 		configHandler->Set("ROAM", 0);
+
+	configHandler->Set("ChunkedTerrainMesh", dynamic_cast<CChunkedMeshDrawer*>(meshDrawer) != NULL);
 	configHandler->Set("GroundDetail", groundDetail);
 
 	smfRenderStateSSP->Kill(); ISMFRenderState::FreeInstance(smfRenderStateSSP);
@@ -113,7 +124,12 @@ CSMFGroundDrawer::~CSMFGroundDrawer()
 
 IMeshDrawer* CSMFGroundDrawer::SwitchMeshDrawer(int mode)
 {
-	const int curMode = (dynamic_cast<CRoamMeshDrawer*>(meshDrawer) ? SMF_MESHDRAWER_ROAM : SMF_MESHDRAWER_LEGACY);
+	int curMode = SMF_MESHDRAWER_LEGACY;
+
+	if (dynamic_cast<CRoamMeshDrawer*>(meshDrawer) != NULL)
+		curMode = SMF_MESHDRAWER_ROAM;
+	if (dynamic_cast<CChunkedMeshDrawer*>(meshDrawer) != NULL)
+		curMode = SMF_MESHDRAWER_CHUNKED;
 
 	// mode == -1: toggle modes
 	if (mode < 0) {
@@ -121,6 +137,11 @@ IMeshDrawer* CSMFGroundDrawer::SwitchMeshDrawer(int mode)
 		mode %= SMF_MESHDRAWER_LAST;
 	}
 
+	if (mode == SMF_MESHDRAWER_CHUNKED && !CChunkedMeshDrawer::IsSupported()) {
+		LOG_L(L_WARNING, "Chunked Mesh Rendering requires VBOs, using ROAM instead");
+		mode = SMF_MESHDRAWER_ROAM;
+	}
+
 	if ((curMode == mode) && (meshDrawer != NULL))
 		return meshDrawer;
 
@@ -131,6 +152,10 @@ IMeshDrawer* CSMFGroundDrawer::SwitchMeshDrawer(int mode)
 			LOG("Switching to Legacy Mesh Rendering");
 			meshDrawer = new CLegacyMeshDrawer(smfMap, this);
 			break;
+		case SMF_MESHDRAWER_CHUNKED:
+			LOG("Switching to Chunked Mesh Rendering");
+			meshDrawer = new CChunkedMeshDrawer(smfMap, this);
+			break;
 		default:
 			LOG("Switching to ROAM Mesh Rendering");
 			meshDrawer = new CRoamMeshDrawer(smfMap, this);
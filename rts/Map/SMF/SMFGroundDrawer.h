@@ -15,6 +15,7 @@ struct ISMFRenderState;
 enum {
 	SMF_MESHDRAWER_LEGACY = 0,
 	SMF_MESHDRAWER_ROAM,
+	SMF_MESHDRAWER_CHUNKED,
 	SMF_MESHDRAWER_LAST,
 };
 
@@ -1,9 +1,11 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #if defined(USE_LIBSQUISH) && !defined(HEADLESS)
 	#include "lib/squish/squish.h"
 	#include "lib/rg-etc1/rg_etc1.h"
@@ -20,6 +22,7 @@
 #include "Game/GameSetup.h"
 #include "Game/LoadScreen.h"
 #include "System/Exceptions.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FastMath.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
@@ -29,6 +32,16 @@
 
 using std::sprintf;
 
+CONFIG(int, GroundTextureMemoryBudget)
+	.defaultValue(128)
+	.minimumValue(0)
+	.maximumValue(2047)
+	.description("Maximum amount of video memory (in MB) used by the SMF ground textures, 0 means no limit. Squares that went out of view longest ago are reduced to their lowest detail first when the budget is reached.");
+CONFIG(int, GroundTextureUploadsPerFrame)
+	.defaultValue(8)
+	.minimumValue(1)
+	.description("Maximum number of SMF ground texture squares whose detail level is raised per frame.");
+
 #define LOG_SECTION_SMF_GROUND_TEXTURES "CSMFGroundTextures"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_SMF_GROUND_TEXTURES)
 
@@ -39,7 +52,11 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_SMF_GROUND_TEXTURES)
 #define LOG_SECTION_CURRENT LOG_SECTION_SMF_GROUND_TEXTURES
 
 
-CSMFGroundTextures::CSMFGroundTextures(CSMFReadMap* rm): smfMap(rm)
+CSMFGroundTextures::CSMFGroundTextures(CSMFReadMap* rm)
+	: smfMap(rm)
+	, usedTexMemory(0)
+	, maxTexMemory(configHandler->GetInt("GroundTextureMemoryBudget") * 1024 * 1024)
+	, maxSquareUploads(configHandler->GetInt("GroundTextureUploadsPerFrame"))
 {
 	LoadTiles(smfMap->GetFile());
 	LoadSquareTextures(3);
@@ -179,6 +196,7 @@ void CSMFGroundTextures::LoadSquareTextures(const int mipLevel)
 			square->texLevel       = 0;
 			square->textureID      = 0;
 			square->lastBoundFrame = 1;
+			square->lastViewFrame  = 0;
 			square->luaTexture     = false;
 
 			// start at the lowest mip-level
@@ -278,6 +296,12 @@ bool CSMFGroundTextures::RecompressTiles(bool canRecompress)
 }
 #endif
 
+int CSMFGroundTextures::GetSquareMemory(int level) const
+{
+	// DXT1 and ETC1 both store 8 bytes per 4x4 block
+	return (((smfMap->bigTexSize >> level) * (smfMap->bigTexSize >> level)) / 2);
+}
+
 inline bool CSMFGroundTextures::TexSquareInView(int btx, int bty) const
 {
 	static const float* hm = readMap->GetCornerHeightMapUnsynced();
@@ -302,6 +326,8 @@ void CSMFGroundTextures::DrawUpdate()
 	const float vsySq = globalRendering->viewSizeY * globalRendering->viewSizeY;
 	const float vdiag = fastmath::apxsqrt(vsxSq + vsySq);
 
+	squareRequests.clear();
+
 	for (int y = 0; y < smfMap->numBigTexY; ++y) {
 		float dz = cam2->GetPos().z - (y * smfMap->bigSquareSize * SQUARE_SIZE);
 		dz -= (SQUARE_SIZE << 6);
@@ -319,12 +345,13 @@ void CSMFGroundTextures::DrawUpdate()
 				if ((square->texLevel < 3) && (globalRendering->drawFrame - square->lastBoundFrame > 120)) {
 					// `unload` texture (load lowest mip-map) if
 					// the square wasn't visible for 120 vframes
-					glDeleteTextures(1, &square->textureID);
 					LoadSquareTexture(x, y, 3);
 				}
 				continue;
 			}
 
+			square->lastViewFrame = globalRendering->drawFrame;
+
 			float dx = cam2->GetPos().x - (x * smfMap->bigSquareSize * SQUARE_SIZE);
 			dx -= (SQUARE_SIZE << 6);
 			dx = std::max(0.0f, float(math::fabs(dx) - (SQUARE_SIZE << 6)));
@@ -375,12 +402,117 @@ void CSMFGroundTextures::DrawUpdate()
 			if (stretchFactors[y * smfMap->numBigTexX + x] > 16000 && wantedLevel > 0)
 				wantedLevel--;
 
-			if (square->texLevel != wantedLevel) {
-				glDeleteTextures(1, &square->textureID);
-				LoadSquareTexture(x, y, wantedLevel);
+			if (square->texLevel != wantedLevel || square->textureID == 0) {
+				const SquareRequest req = {x, y, wantedLevel, dist};
+				squareRequests.push_back(req);
 			}
 		}
 	}
+
+	LoadSquareRequests();
+}
+
+void CSMFGroundTextures::LoadSquareRequests()
+{
+	if (squareRequests.empty())
+		return;
+
+	// coarser levels free memory and are cheap to upload, do those first;
+	// otherwise refine the squares closest to the camera first
+	std::sort(squareRequests.begin(), squareRequests.end(), [&](const SquareRequest& a, const SquareRequest& b) {
+		const bool ca = (a.level >= int(squares[a.y * smfMap->numBigTexX + a.x].texLevel));
+		const bool cb = (b.level >= int(squares[b.y * smfMap->numBigTexX + b.x].texLevel));
+
+		if (ca != cb)
+			return ca;
+
+		return (a.dist < b.dist);
+	});
+
+	unsigned int numRequests = 0;
+	unsigned int numUploads = 0;
+
+	// usage if every request accepted so far had already been uploaded
+	int projTexMemory = usedTexMemory;
+
+	for (unsigned int n = 0; n < squareRequests.size(); n++) {
+		SquareRequest& req = squareRequests[n];
+		const GroundSquare& square = squares[req.y * smfMap->numBigTexX + req.x];
+		const int curMemory = (square.textureID != 0)? GetSquareMemory(square.texLevel): 0;
+
+		if (GetSquareMemory(req.level) > curMemory) {
+			if (numUploads >= maxSquareUploads)
+				continue;
+
+			if (maxTexMemory != 0) {
+				const int overBudget = projTexMemory + GetSquareMemory(req.level) - curMemory - maxTexMemory;
+
+				if (overBudget > 0)
+					projTexMemory -= FreeSquareMemory(overBudget);
+
+				// settle for the finest level that still fits
+				while (req.level < 3 && (projTexMemory + GetSquareMemory(req.level) - curMemory) > maxTexMemory) {
+					req.level++;
+				}
+
+				if (req.level == square.texLevel && square.textureID != 0)
+					continue;
+			}
+
+			numUploads++;
+		}
+
+		projTexMemory += (GetSquareMemory(req.level) - curMemory);
+		squareRequests[numRequests++] = req;
+	}
+
+	squareRequests.resize(numRequests);
+	squareBuffers.resize(std::max(squareBuffers.size(), squareRequests.size()));
+
+	// the tile data is immutable after loading, so all squares can be
+	// assembled concurrently; only the texture uploads need the GL thread
+	for_mt(0, squareRequests.size(), [&](const int i) {
+		const SquareRequest& req = squareRequests[i];
+
+		squareBuffers[i].resize(GetSquareMemory(req.level) / sizeof(GLint));
+		ExtractSquareTiles(req.x, req.y, req.level, &squareBuffers[i][0]);
+	});
+
+	for (unsigned int n = 0; n < squareRequests.size(); n++) {
+		LoadSquareTexture(squareRequests[n].x, squareRequests[n].y, squareRequests[n].level, &squareBuffers[n][0]);
+	}
+}
+
+int CSMFGroundTextures::FreeSquareMemory(int numBytes)
+{
+	std::vector<int> candidates;
+
+	for (unsigned int i = 0; i < squares.size(); i++) {
+		const GroundSquare& square = squares[i];
+
+		if (square.luaTexture || square.textureID == 0 || square.texLevel >= 3)
+			continue;
+		if (square.lastViewFrame == globalRendering->drawFrame)
+			continue;
+
+		candidates.push_back(i);
+	}
+
+	// least recently drawn squares go first
+	std::sort(candidates.begin(), candidates.end(), [&](const int a, const int b) {
+		return (squares[a].lastBoundFrame < squares[b].lastBoundFrame);
+	});
+
+	int numFreed = 0;
+
+	for (unsigned int n = 0; n < candidates.size() && numFreed < numBytes; n++) {
+		const int i = candidates[n];
+
+		numFreed += (GetSquareMemory(squares[i].texLevel) - GetSquareMemory(3));
+		LoadSquareTexture(i % smfMap->numBigTexX, i / smfMap->numBigTexX, 3);
+	}
+
+	return numFreed;
 }
 
 
@@ -392,9 +524,10 @@ bool CSMFGroundTextures::SetSquareLuaTexture(int texSquareX, int texSquareY, int
 	GroundSquare* square = &squares[texSquareY * smfMap->numBigTexX + texSquareX];
 
 	if (texID != 0) {
-		if (!square->luaTexture) {
+		if (!square->luaTexture && square->textureID != 0) {
 			// only delete textures managed by us
 			glDeleteTextures(1, &square->textureID);
+			usedTexMemory -= GetSquareMemory(square->texLevel);
 		}
 
 		square->textureID = texID;
@@ -477,7 +610,7 @@ void CSMFGroundTextures::ExtractSquareTiles(
 	}
 }
 
-void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
+void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level, const GLint* tileBuf)
 {
 	static const GLenum ttarget = GL_TEXTURE_2D;
 
@@ -485,11 +618,24 @@ void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
 	const int numSqBytes = (mipSqSize * mipSqSize) / 2;
 
 	GroundSquare* square = &squares[y * smfMap->numBigTexX + x];
+
+	if (square->textureID != 0) {
+		glDeleteTextures(1, &square->textureID);
+		usedTexMemory -= GetSquareMemory(square->texLevel);
+	}
+
 	square->texLevel = level;
+	usedTexMemory += numSqBytes;
 
 	pbo.Bind();
 	pbo.Resize(numSqBytes);
-	ExtractSquareTiles(x, y, level, (GLint*) pbo.MapBuffer());
+
+	if (tileBuf != NULL) {
+		memcpy(pbo.MapBuffer(), tileBuf, numSqBytes);
+	} else {
+		ExtractSquareTiles(x, y, level, (GLint*) pbo.MapBuffer());
+	}
+
 	pbo.UnmapBuffer();
 
 	glGenTextures(1, &square->textureID);
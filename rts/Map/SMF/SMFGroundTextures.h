@@ -26,7 +26,10 @@ protected:
 	void ConvolveHeightMap(const int mapWidth, const int mipLevel);
 	bool RecompressTiles(bool canRecompress);
 	void ExtractSquareTiles(const int texSquareX, const int texSquareY, const int mipLevel, GLint* tileBuf) const;
-	void LoadSquareTexture(int x, int y, int level);
+	void LoadSquareTexture(int x, int y, int level, const GLint* tileBuf = NULL);
+	void LoadSquareRequests();
+	int FreeSquareMemory(int numBytes);
+	int GetSquareMemory(int level) const;
 
 	inline bool TexSquareInView(int, int) const;
 
@@ -37,10 +40,21 @@ private:
 		unsigned int texLevel;
 		unsigned int textureID;
 		unsigned int lastBoundFrame;
+		unsigned int lastViewFrame;
 		bool luaTexture;
 	};
 
+	// a visible square whose texture should be reloaded at <level>
+	struct SquareRequest {
+		int x;
+		int y;
+		int level;
+		float dist;
+	};
+
 	std::vector<GroundSquare> squares;
+	std::vector<SquareRequest> squareRequests;
+	std::vector< std::vector<GLint> > squareBuffers;
 
 	std::vector<int> tileMap;
 	std::vector<char> tiles;
@@ -54,6 +68,11 @@ private:
 	PBO pbo;
 
 	int tileTexFormat;
+
+	// bytes of VRAM held by non-Lua square textures, and its limit (0 = none)
+	int usedTexMemory;
+	int maxTexMemory;
+	unsigned int maxSquareUploads;
 };
 
 #endif // _BF_GROUND_TEXTURES_H_
@@ -4,6 +4,7 @@
 #include "SMFMapFile.h"
 #include "Map/ReadMap.h"
 #include "System/Exceptions.h"
+#include "System/ThreadPool.h"
 
 #include <cassert>
 #include <cstring>
@@ -79,12 +80,14 @@ void CSMFMapFile::ReadHeightmap(float* sHeightMap, float* uHeightMap, float base
 	ifs.Seek(header.heightmapPtr);
 	ifs.Read(temphm, hmx * hmy * 2);
 
-	for (int y = 0; y < hmx * hmy; ++y) {
-		const float h = base + swabWord(temphm[y]) * mod;
+	for_mt(0, hmy, [&](const int y) {
+		for (int i = y * hmx; i < (y + 1) * hmx; ++i) {
+			const float h = base + swabWord(temphm[i]) * mod;
 
-		if (sHeightMap != NULL) { sHeightMap[y] = h; }
-		if (uHeightMap != NULL) { uHeightMap[y] = h; }
-	}
+			if (sHeightMap != NULL) { sHeightMap[i] = h; }
+			if (uHeightMap != NULL) { uHeightMap[i] = h; }
+		}
+	});
 
 	delete[] temphm;
 }
@@ -515,31 +515,35 @@ void CSMFReadMap::UpdateShadingTexture(const SRectangle& update)
 	{
 		// texture space is [0 .. gs->mapxm1] x [0 .. gs->mapym1]
 
-		// enlarge rect by 1pixel in all directions (cause we use center normals and not corner ones)
+		// a heightmap update over corners (x1, y1) - (x2, y2) changes the
+		// center heights and normals of squares (x1 - 1, y1 - 1) - (x2, y2)
 		const int x1 = std::max(update.x1 - 1,          0);
 		const int y1 = std::max(update.y1 - 1,          0);
-		const int x2 = std::min(update.x2 + 1, gs->mapxm1);
-		const int y2 = std::min(update.y2 + 1, gs->mapym1);
+		const int x2 = std::min(update.x2    , gs->mapxm1);
+		const int y2 = std::min(update.y2    , gs->mapym1);
 
 		const int xsize = (x2 - x1) + 1; // +1 cause we iterate:
 		const int ysize = (y2 - y1) + 1; // x1 <= xi <= x2  (not!  x1 <= xi < x2)
 
+		if (xsize <= 0 || ysize <= 0)
+			return;
+
 		//TODO switch to PBO?
 		std::vector<unsigned char> pixels(xsize * ysize * 4, 0.0f);
 
 		for_mt(0, ysize, [&](const int y) {
-			const int idx1 = (y + y1) * gs->mapx + x1;
-			const int idx2 = (y + y1) * gs->mapx + x2;
-			UpdateShadingTexPart(idx1, idx2, &pixels[y * xsize * 4]);
+			UpdateShadingTexPart(y + y1, x1, x2, &pixels[y * xsize * 4]);
 		});
 
 		// check if we were in a dynamic sun issued shadingTex update
-		// and our updaterect was already updated (buffered, not send to the GPU yet!)
-		// if so update it in that buffer, too
-		if (shadingTexUpdateProgress > (y1 * gs->mapx + x1)) {
-			for (int y = 0; y < ysize; ++y) {
-				const int idx = (y + y1) * gs->mapx + x1;
-				memcpy(&shadingTexBuffer[idx * 4] , &pixels[y * xsize * 4], xsize);
+		// and some rows of our updaterect were already updated there
+		// (buffered, not send to the GPU yet!); if so patch them too,
+		// the remaining rows will be computed from the new normals
+		if (shadingTexUpdateProgress > y1) {
+			const int ymax = std::min(y2, shadingTexUpdateProgress - 1);
+
+			for (int y = y1; y <= ymax; ++y) {
+				memcpy(&shadingTexBuffer[(y * gs->mapx + x1) * 4], &pixels[(y - y1) * xsize * 4], xsize * 4);
 			}
 		}
 
@@ -550,36 +554,39 @@ void CSMFReadMap::UpdateShadingTexture(const SRectangle& update)
 }
 
 
-const float CSMFReadMap::GetCenterHeightUnsynced(const int x, const int y) const
+void CSMFReadMap::UpdateShadingTexPart(int y, int x1, int x2, unsigned char* dst) const
 {
-	static const float* hm = GetCornerHeightMapUnsynced();
+	const float*  hmT = GetCornerHeightMapUnsynced() + (y    ) * gs->mapxp1;
+	const float*  hmB = GetCornerHeightMapUnsynced() + (y + 1) * gs->mapxp1;
+	const float3* cnm = &centerNormalsUnsynced[y * gs->mapx];
 
-	float h = hm[(y    ) * gs->mapxp1 + (x    )] +
-	          hm[(y    ) * gs->mapxp1 + (x + 1)] +
-	          hm[(y + 1) * gs->mapxp1 + (x    )] +
-	          hm[(y + 1) * gs->mapxp1 + (x + 1)];
+	// fetched once per row rather than per square
+	const float3& lightDir = sky->GetLight()->GetLightDir();
+	const float3& ambientColor = mapInfo->light.groundAmbientColor;
+	const float3& sunColor = mapInfo->light.groundSunColor;
 
-	return h * 0.25f;
-}
+	static const int maxWaterColorIdx = int(sizeof(waterHeightColors) / 4) - 1;
 
+	for (int x = x1; x <= x2; ++x) {
+		const int i = x - x1;
 
-void CSMFReadMap::UpdateShadingTexPart(int idx1, int idx2, unsigned char* dst) const
-{
-	for (int idx = idx1; idx <= idx2; ++idx) {
-		const int i = idx - idx1;
-		const int xi = idx % gs->mapx;
-		const int yi = idx / gs->mapx;
+		const float height = (hmT[x] + hmT[x + 1] + hmB[x] + hmB[x + 1]) * 0.25f;
+		const float sunCoeff = Clamp(lightDir.dot(cnm[x]), 0.0f, 1.0f);
+
+		float3 light = (ambientColor + sunColor * sunCoeff) * CGlobalRendering::SMF_INTENSITY_MULT;
 
-		const float height = GetCenterHeightUnsynced(xi, yi);
+		light.x = std::min(light.x, 1.0f);
+		light.y = std::min(light.y, 1.0f);
+		light.z = std::min(light.z, 1.0f);
 
 		if (height < 0.0f) {
 			// Underwater
-			const int clampedHeight = std::min((int)(-height), int(sizeof(waterHeightColors) / 4) - 1);
-			float lightIntensity = std::min((DiffuseSunCoeff(xi, yi) + 0.2f) * 2.0f, 1.0f);
+			const int clampedHeight = std::min((int)(-height), maxWaterColorIdx);
+			float lightIntensity = std::min((sunCoeff + 0.2f) * 2.0f, 1.0f);
 
 			if (height > -10.0f) {
 				const float wc = -height * 0.1f;
-				const float3 lightColor = GetLightValue(xi, yi) * (1.0f - wc) * 255.0f;
+				const float3 lightColor = light * (1.0f - wc) * 255.0f;
 
 				lightIntensity *= wc;
 
@@ -594,7 +601,7 @@ void CSMFReadMap::UpdateShadingTexPart(int idx1, int idx2, unsigned char* dst) c
 			dst[i * 4 + 3] = EncodeHeight(height);
 		} else {
 			// Above water
-			const float3& light = GetLightValue(xi, yi) * 255.0f;
+			light *= 255.0f;
 			dst[i * 4 + 0] = (unsigned char) light.x;
 			dst[i * 4 + 1] = (unsigned char) light.y;
 			dst[i * 4 + 2] = (unsigned char) light.z;
@@ -604,28 +611,6 @@ void CSMFReadMap::UpdateShadingTexPart(int idx1, int idx2, unsigned char* dst) c
 }
 
 
-float CSMFReadMap::DiffuseSunCoeff(const int x, const int y) const
-{
-	const float3& N = centerNormalsUnsynced[y * gs->mapx + x];
-	const float3& L = sky->GetLight()->GetLightDir();
-	return Clamp(L.dot(N), 0.0f, 1.0f);
-}
-
-
-float3 CSMFReadMap::GetLightValue(const int x, const int y) const
-{
-	float3 light =
-		mapInfo->light.groundAmbientColor +
-		mapInfo->light.groundSunColor * DiffuseSunCoeff(x, y);
-	light *= CGlobalRendering::SMF_INTENSITY_MULT;
-
-	for (int a = 0; a < 3; ++a) {
-		light[a] = std::min(light[a], 1.0f);
-	}
-
-	return light;
-}
-
 void CSMFReadMap::SunChanged(const float3& sunDir)
 {
 	if (shadingTexUpdateProgress < 0) {
@@ -641,18 +626,19 @@ void CSMFReadMap::UpdateShadingTexture()
 {
 	static const int xsize = gs->mapx;
 	static const int ysize = gs->mapy;
-	static const int pixels = xsize * ysize;
 
 	// with GLSL, the shading texture has very limited use (minimap etc) so we reduce the updaterate
 	//FIXME replace with a real check if glsl is used in terrain rendering!
 	//FIXME make configurable? or even FPS depending?
 	const int update_rate = (globalRendering->haveGLSL ? 64*64 : 64*128);
+	const int update_rows = std::max(1, update_rate / xsize);
 
+	// progress is counted in rows
 	if (shadingTexUpdateProgress < 0) {
 		return;
 	}
 
-	if (shadingTexUpdateProgress >= pixels) {
+	if (shadingTexUpdateProgress >= ysize) {
 		if (shadingTexUpdateNeeded) {
 			shadingTexUpdateProgress = 0;
 			shadingTexUpdateNeeded   = false;
@@ -666,15 +652,14 @@ void CSMFReadMap::UpdateShadingTexture()
 		return;
 	}
 
-	const int idx1 = shadingTexUpdateProgress;
-	const int idx2 = std::min(idx1 + update_rate, pixels - 1);
+	const int y1 = shadingTexUpdateProgress;
+	const int y2 = std::min(y1 + update_rows, ysize);
 
-	for_mt(idx1, idx2+1, 1025, [&](const int idx){
-		const int idx3 = std::min(idx2, idx + 1024);
-		UpdateShadingTexPart(idx, idx3, &shadingTexBuffer[idx * 4]);
+	for_mt(y1, y2, [&](const int y) {
+		UpdateShadingTexPart(y, 0, xsize - 1, &shadingTexBuffer[y * xsize * 4]);
 	});
 
-	shadingTexUpdateProgress += update_rate;
+	shadingTexUpdateProgress = y2;
 }
 
 
@@ -85,13 +85,9 @@ private:
 	void UpdateNormalTexture(const SRectangle& update);
 	void UpdateShadingTexture(const SRectangle& update);
 
-	inline void UpdateShadingTexPart(int idx1, int idx2, unsigned char* dst) const;
+	/// shades squares (x1, y) - (x2, y) into dst (RGBA)
+	inline void UpdateShadingTexPart(int y, int x1, int x2, unsigned char* dst) const;
 	inline CBaseGroundDrawer* GetGroundDrawer();
-
-	inline const float GetCenterHeightUnsynced(const int x, const int y) const;
-
-	inline float DiffuseSunCoeff(const int x, const int y) const;
-	inline float3 GetLightValue(const int x, const int y) const;
 	void ParseSMD(std::string filename);
 
 public:
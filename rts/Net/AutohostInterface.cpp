@@ -7,6 +7,8 @@
 #include "System/Net/Socket.h"
 
 #include <string.h>
+#include <algorithm>
+#include <cassert>
 #include <vector>
 #include <boost/cstdint.hpp>
 
@@ -87,6 +89,19 @@ enum EVENT
 	 */
 	GAME_LUAMSG = 20,
 
+	/**
+	 * @brief periodic server health report, see the AutohostTelemetryInterval setting
+	 *
+	 * (uint16_t msgsize, int32_t frame, float speed,
+	 *  float[4] update-time percentiles (50/90/99/max, ms),
+	 *  int32_t queued-frames, uint32_t peak-memory (KiB), uchar numplayers,
+	 *  numplayers * (uchar playernumber, int32_t ping, float cpu,
+	 *                uint32_t sent (bytes/s), uint32_t received (bytes/s),
+	 *                uint32_t queued-packets))
+	 * all values in host byte order
+	 */
+	SERVER_TELEMETRY = 21,
+
 	/**
 	 * @brief team statistics
 	 * @see CTeam::Statistics for a reference of how to read them
@@ -308,6 +323,46 @@ void AutohostInterface::Warning(const std::string& message)
 	}
 }
 
+void AutohostInterface::SendTelemetry(const Telemetry& telemetry)
+{
+	if (!autohost.is_open())
+		return;
+
+	static const unsigned int headerSize = 1 + sizeof(boost::uint16_t) + sizeof(boost::int32_t) + sizeof(float) * 5 + sizeof(boost::int32_t) + sizeof(boost::uint32_t) + 1;
+	static const unsigned int playerSize = 1 + sizeof(boost::int32_t) + sizeof(float) + sizeof(boost::uint32_t) * 3;
+
+	const unsigned int numPlayers = std::min(telemetry.players.size(), size_t(255));
+	const boost::uint16_t msgsize = headerSize + numPlayers * playerSize;
+
+	std::vector<boost::uint8_t> buffer(msgsize);
+	unsigned int pos = 0;
+
+	#define APPEND(x) memcpy(&buffer[pos], &(x), sizeof(x)); pos += sizeof(x)
+	buffer[pos++] = SERVER_TELEMETRY;
+	APPEND(msgsize);
+	APPEND(telemetry.frameNum);
+	APPEND(telemetry.speed);
+	APPEND(telemetry.updateTimes);
+	APPEND(telemetry.queuedFrames);
+	APPEND(telemetry.peakMemory);
+	buffer[pos++] = numPlayers;
+
+	for (unsigned int n = 0; n < numPlayers; n++) {
+		const TelemetryPlayer& p = telemetry.players[n];
+
+		buffer[pos++] = p.playerNum;
+		APPEND(p.ping);
+		APPEND(p.cpuUsage);
+		APPEND(p.sentRate);
+		APPEND(p.recvRate);
+		APPEND(p.packetQueue);
+	}
+	#undef APPEND
+
+	assert(pos == msgsize);
+	Send(boost::asio::buffer(buffer));
+}
+
 void AutohostInterface::SendLuaMsg(const boost::uint8_t* msg, size_t msgSize)
 {
 	if (autohost.is_open()) {
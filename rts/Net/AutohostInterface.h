@@ -4,6 +4,7 @@
 #define AUTOHOST_INTERFACE_H
 
 #include <string>
+#include <vector>
 #include <boost/cstdint.hpp>
 #include <boost/asio/ip/udp.hpp>
 
@@ -46,6 +47,33 @@ public:
 	void Message(const std::string& message);
 	void Warning(const std::string& message);
 
+	struct TelemetryPlayer {
+		uchar playerNum;
+		/// server frames since its last response
+		boost::int32_t ping;
+		/// as reported by the client (NETMSG_CPU_USAGE)
+		float cpuUsage;
+		/// bytes per second since the previous telemetry message
+		boost::uint32_t sentRate;
+		boost::uint32_t recvRate;
+		/// packets waiting to be processed on the link
+		boost::uint32_t packetQueue;
+	};
+
+	struct Telemetry {
+		boost::int32_t frameNum;
+		float speed;
+		/// duration of the server's update steps in ms: 50th, 90th, 99th percentile and max
+		float updateTimes[4];
+		/// largest ping over all ingame players, in frames
+		boost::int32_t queuedFrames;
+		/// peak resident memory in KiB, 0 if unknown
+		boost::uint32_t peakMemory;
+		std::vector<TelemetryPlayer> players;
+	};
+
+	void SendTelemetry(const Telemetry& telemetry);
+
 	void SendLuaMsg(const boost::uint8_t* msg, size_t msgSize);
 	void Send(const boost::uint8_t* msg, size_t msgSize);
 
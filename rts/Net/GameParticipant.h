@@ -53,6 +53,7 @@ public:
 
 #ifdef SYNCCHECK
 	std::map<int, unsigned> syncResponse; // syncResponse[frameNum] = checksum
+	std::map<int, std::vector<unsigned> > syncSubsystems; // syncSubsystems[frameNum] = checksum per CSyncChecker::Subsystem
 #endif
 };
 
@@ -6,6 +6,9 @@
 
 #include <stdarg.h>
 #include <ctime>
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
 #include <boost/bind.hpp>
 #include <boost/format.hpp>
 #include <boost/version.hpp>
@@ -13,6 +16,7 @@
 #include <boost/ptr_container/ptr_map.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/thread.hpp>
+#include <zlib.h>
 #include <deque>
 #if defined DEDICATED || defined DEBUG
 	#include <iostream>
@@ -53,19 +57,21 @@
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Net/LocalConnection.h"
+#include "System/Net/ProtocolDef.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/errorhandler.h"
 #include "System/Platform/Threading.h"
+#include "System/Sync/SyncChecker.h"
 
 #ifndef DEDICATED
 #include "lib/luasocket/src/restrictions.h"
 #endif
 
 #define ALLOW_DEMO_GODMODE
-#define PKTCACHE_VECSIZE 1000
+#define PKTCACHE_BLOCKSIZE 1000
 
 using netcode::RawPacket;
 
@@ -82,8 +88,18 @@ CONFIG(bool, ServerRecordDemos).defaultValue(true);
 CONFIG(bool, ServerRecordDemos).defaultValue(false);
 #endif
 CONFIG(std::string, AutohostIP).defaultValue("127.0.0.1");
+CONFIG(int, AutohostTelemetryInterval).defaultValue(0).minimumValue(0)
+	.description("Milliseconds between two server health reports sent to the autohost, 0 to disable them.");
+CONFIG(bool, ServerBundleFrameMessages).defaultValue(true)
+	.description("Relay all messages of a sim frame to each network client in one go, together with the frame message.");
+
+
 
+/// bytes of held back broadcasts after which they are sent without waiting for the next frame
+const unsigned MAX_FRAME_BUNDLE_SIZE = 32 * 1024;
 
+/// milliseconds broadcasts are held back at most when no frame message is created
+const int MAX_FRAME_BUNDLE_DELAY = 1000 / GAME_SPEED;
 
 /// frames until a syncchech will time out and a warning is given out
 const unsigned SYNCCHECK_TIMEOUT = 300;
@@ -136,8 +152,15 @@ CGameServer::CGameServer(const std::string& hostIP, int hostPort, const GameData
 	serverStartTime = spring_gettime();
 	lastUpdate = serverStartTime;
 	lastPlayerInfo = serverStartTime;
+	lastTelemetry = serverStartTime;
+	telemetryInterval = spring_msecs(configHandler->GetInt("AutohostTelemetryInterval"));
 	syncErrorFrame = 0;
 	syncWarningFrame = 0;
+	syncSubsystemErrorFrame = 0;
+	syncRequestFrame = -1;
+	frameBundleSize = 0;
+	frameBundleStart = spring_notime;
+	bundleFrameMessages = configHandler->GetBool("ServerBundleFrameMessages");
 	serverFrameNum = 0;
 	timeLeft = 0;
 	modGameTime = 0.0f;
@@ -377,6 +400,16 @@ void CGameServer::SkipTo(int targetFrameNum)
 	if (serverFrameNum >= targetFrameNum) { return; }
 	if (demoReader == NULL) { return; }
 
+	if (targetFrameNum > demoReader->GetNumFrames()) {
+		// skipping past the end would consume the whole demo
+		// and end the game, stop at its last frame instead
+		targetFrameNum = std::max(serverFrameNum, demoReader->GetNumFrames());
+
+		Message(str(format("Demo only has %d frames, skipping to the last one") %targetFrameNum));
+
+		if (serverFrameNum >= targetFrameNum) { return; }
+	}
+
 	CommandMessage startMsg(str(format("skip start %d") %targetFrameNum), SERVER_PLAYER);
 	CommandMessage endMsg("skip end", SERVER_PLAYER);
 	Broadcast(boost::shared_ptr<const netcode::RawPacket>(startMsg.Pack()));
@@ -602,8 +635,21 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 
 void CGameServer::Broadcast(boost::shared_ptr<const netcode::RawPacket> packet)
 {
-	for (size_t p = 0; p < players.size(); ++p)
-		players[p].SendData(packet);
+	if (bundleFrameMessages && gameHasStarted) {
+		if (frameBundle.empty())
+			frameBundleStart = spring_gettime();
+
+		frameBundle.push_back(packet);
+		frameBundleSize += packet->length;
+
+		// RawPacket streams are sent in one piece, keep them reasonably small
+		if (frameBundleSize >= MAX_FRAME_BUNDLE_SIZE)
+			FlushFrameBundle();
+	} else {
+		for (size_t p = 0; p < players.size(); ++p)
+			players[p].SendData(packet);
+	}
+
 	if (canReconnect || bypassScriptPasswordCheck || !gameHasStarted)
 		AddToPacketCache(packet);
 
@@ -612,6 +658,47 @@ void CGameServer::Broadcast(boost::shared_ptr<const netcode::RawPacket> packet)
 	}
 }
 
+void CGameServer::FlushFrameBundle()
+{
+	if (frameBundle.empty())
+		return;
+
+	boost::shared_ptr<const RawPacket> stream;
+
+	if (frameBundle.size() > 1) {
+		RawPacket* buf = new RawPacket(frameBundleSize);
+		unsigned int pos = 0;
+
+		for (size_t i = 0; i < frameBundle.size(); ++i) {
+			memcpy(buf->data + pos, frameBundle[i]->data, frameBundle[i]->length);
+			pos += frameBundle[i]->length;
+		}
+
+		stream.reset(buf);
+	}
+
+	for (size_t p = 0; p < players.size(); ++p) {
+		GameParticipant& player = players[p];
+
+		if (!player.link)
+			continue;
+
+		// the receiver splits the stream up again, so clients see the same
+		// messages in the same order as without bundling (and as the demo)
+		if (stream && player.link->AcceptsMessageStreams()) {
+			player.SendData(stream);
+			continue;
+		}
+
+		for (size_t i = 0; i < frameBundle.size(); ++i) {
+			player.SendData(frameBundle[i]);
+		}
+	}
+
+	frameBundle.clear();
+	frameBundleSize = 0;
+}
+
 void CGameServer::Message(const std::string& message, bool broadcast)
 {
 	if (broadcast) {
@@ -632,6 +719,92 @@ void CGameServer::PrivateMessage(int playerNum, const std::string& message) {
 	players[playerNum].SendData(CBaseNetProtocol::Get().SendSystemMessage(SERVER_PLAYER, message));
 }
 
+void CGameServer::CheckSyncSubsystems(int frameNum)
+{
+#ifdef SYNCCHECK
+	// the subsystem checksums of the local client are authoritative,
+	// otherwise those reported by the most players for this frame
+	const std::vector<unsigned>* correctChecksums = NULL;
+
+	if (hasLocalClient) {
+		const std::map<int, std::vector<unsigned> >& lcs = players[localClientNumber].syncSubsystems;
+		const std::map<int, std::vector<unsigned> >::const_iterator it = lcs.find(frameNum);
+
+		if (it != lcs.end())
+			correctChecksums = &it->second;
+	} else {
+		unsigned maxCount = 0;
+
+		for (size_t a = 0; a < players.size(); ++a) {
+			const std::map<int, std::vector<unsigned> >::const_iterator it = players[a].syncSubsystems.find(frameNum);
+
+			if (!players[a].link || it == players[a].syncSubsystems.end())
+				continue;
+
+			unsigned count = 0;
+
+			for (size_t b = 0; b < players.size(); ++b) {
+				const std::map<int, std::vector<unsigned> >::const_iterator jt = players[b].syncSubsystems.find(frameNum);
+
+				if (players[b].link && jt != players[b].syncSubsystems.end() && jt->second == it->second)
+					count++;
+			}
+
+			if (count > maxCount) {
+				maxCount = count;
+				correctChecksums = &it->second;
+			}
+		}
+	}
+
+	if (correctChecksums == NULL)
+		return;
+
+	// an earlier frame (the answer to a NETMSG_SYNCREQUEST) narrows it down further
+	if (!syncSubsystemErrorFrame || (frameNum < syncSubsystemErrorFrame) || (frameNum - syncSubsystemErrorFrame > static_cast<int>(SYNCCHECK_MSG_TIMEOUT))) {
+		for (size_t a = 0; a < players.size(); ++a) {
+			const std::map<int, std::vector<unsigned> >::const_iterator it = players[a].syncSubsystems.find(frameNum);
+
+			if (!players[a].link || it == players[a].syncSubsystems.end())
+				continue;
+			if (it->second == *correctChecksums)
+				continue;
+
+			std::string subsystems;
+
+			for (size_t s = 0; s < it->second.size() && s < correctChecksums->size(); ++s) {
+				if (it->second[s] == (*correctChecksums)[s])
+					continue;
+
+				if (!subsystems.empty())
+					subsystems += ", ";
+
+				subsystems += CSyncChecker::GetSubsystemName(s);
+			}
+
+			syncSubsystemErrorFrame = frameNum;
+			Message(str(format(SyncSubsystemError) %players[a].name %frameNum %subsystems));
+		}
+	}
+
+	// forget frames for which no more responses are accepted; answers
+	// to the last NETMSG_SYNCREQUEST are kept since they may come late
+	for (size_t a = 0; a < players.size(); ++a) {
+		std::map<int, std::vector<unsigned> >& pss = players[a].syncSubsystems;
+		std::map<int, std::vector<unsigned> >::iterator it = pss.begin();
+		std::map<int, std::vector<unsigned> >::iterator end = pss.lower_bound(serverFrameNum - static_cast<int>(SYNCCHECK_TIMEOUT));
+
+		while (it != end) {
+			if (it->first == syncRequestFrame) {
+				++it;
+			} else {
+				pss.erase(it++);
+			}
+		}
+	}
+#endif
+}
+
 void CGameServer::CheckSync()
 {
 #ifdef SYNCCHECK
@@ -737,6 +910,17 @@ void CGameServer::CheckSync()
 				isPaused = true;
 				Broadcast(CBaseNetProtocol::Get().SendSdCheckrequest(serverFrameNum));
 #endif
+				// subsystem checksums are only sent once per second, ask
+				// everyone for those of the exact frame that diverged
+				if (!demoReader && (*f % GAME_SPEED) != 0 && *f != syncRequestFrame) {
+					syncRequestFrame = *f;
+
+					for (size_t a = 0; a < players.size(); ++a) {
+						if (players[a].link)
+							players[a].SendData(CBaseNetProtocol::Get().SendSyncRequest(*f));
+					}
+				}
+
 				// For each group, output a message with list of player names in it.
 				// TODO this should be linked to the resync system so it can roundrobin
 				// the resync checksum request packets to multiple clients in the same group.
@@ -821,11 +1005,20 @@ void CGameServer::Update()
 		}
 	}
 
+	if (hostif && telemetryInterval > spring_notime && lastTelemetry < (spring_gettime() - telemetryInterval)) {
+		SendTelemetry();
+	}
+
 	if (!gameHasStarted)
 		CheckForGameStart();
 	else if (serverFrameNum > 0 || demoReader)
 		CreateNewFrame(true, false);
 
+	// no frame message for a while (paused, slow game speed), do not
+	// hold back chat and other relayed messages any longer
+	if (!frameBundle.empty() && (spring_gettime() - frameBundleStart) > spring_msecs(MAX_FRAME_BUNDLE_DELAY))
+		FlushFrameBundle();
+
 	if (hostif) {
 		std::string msg = hostif->GetChatMessage();
 
@@ -862,6 +1055,87 @@ void CGameServer::Update()
 
 
 
+/// in KiB, or 0 if not available
+static unsigned int GetPeakRSS()
+{
+#ifndef WIN32
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	#ifdef __APPLE__
+	return (usage.ru_maxrss / 1024); // bytes
+	#else
+	return usage.ru_maxrss;
+	#endif
+#else
+	return 0;
+#endif
+}
+
+void CGameServer::SendTelemetry()
+{
+	const spring_time now = spring_gettime();
+	const float elapsedSecs = std::max(spring_tomsecs(now - lastTelemetry) * 0.001f, 0.001f);
+
+	lastTelemetry = now;
+
+	AutohostInterface::Telemetry telemetry;
+	telemetry.frameNum = serverFrameNum;
+	telemetry.speed = internalSpeed;
+	telemetry.queuedFrames = 0;
+	telemetry.peakMemory = GetPeakRSS();
+
+	// nearest-rank percentiles
+	std::sort(updateTimes.begin(), updateTimes.end());
+
+	for (unsigned int n = 0; n < 4; n++) {
+		static const float ranks[4] = {0.5f, 0.9f, 0.99f, 1.0f};
+
+		if (updateTimes.empty()) {
+			telemetry.updateTimes[n] = 0.0f;
+		} else {
+			telemetry.updateTimes[n] = updateTimes[std::min(size_t(ranks[n] * updateTimes.size()), updateTimes.size() - 1)];
+		}
+	}
+
+	updateTimes.clear();
+	telemetryLinkData.resize(players.size(), std::make_pair(0u, 0u));
+
+	for (size_t a = 0; a < players.size(); ++a) {
+		const GameParticipant& player = players[a];
+
+		if (!player.link) {
+			telemetryLinkData[a] = std::make_pair(0u, 0u);
+			continue;
+		}
+
+		const unsigned int dataSent = player.link->GetDataSent();
+		const unsigned int dataRecv = player.link->GetDataReceived();
+
+		// a reconnect starts counting from zero again
+		const unsigned int prevSent = (dataSent >= telemetryLinkData[a].first )? telemetryLinkData[a].first : 0;
+		const unsigned int prevRecv = (dataRecv >= telemetryLinkData[a].second)? telemetryLinkData[a].second: 0;
+
+		telemetryLinkData[a] = std::make_pair(dataSent, dataRecv);
+
+		AutohostInterface::TelemetryPlayer tp;
+		tp.playerNum = a;
+		tp.ping = (player.myState == GameParticipant::INGAME)? (serverFrameNum - player.lastFrameResponse): 0;
+		tp.cpuUsage = player.cpuUsage;
+		tp.sentRate = (dataSent - prevSent) / elapsedSecs;
+		tp.recvRate = (dataRecv - prevRecv) / elapsedSecs;
+		tp.packetQueue = player.link->GetPacketQueueSize();
+
+		telemetry.queuedFrames = std::max(telemetry.queuedFrames, tp.ping);
+		telemetry.players.push_back(tp);
+	}
+
+	hostif->SendTelemetry(telemetry);
+}
+
+
 void CGameServer::LagProtection()
 {
 	std::vector<float> cpu;
@@ -1288,6 +1562,37 @@ void CGameServer::ProcessPacket(const unsigned playerNum, boost::shared_ptr<cons
 #endif
 		} break;
 
+		case NETMSG_SYNCSUBSYSTEMS: {
+#ifdef SYNCCHECK
+			try {
+				netcode::UnpackPacket pckt(packet, 1);
+
+				unsigned char totalSize; pckt >> totalSize;
+				unsigned char playerNum; pckt >> playerNum;
+				          int  frameNum; pckt >> frameNum;
+
+				const unsigned fixedSize = (3 * sizeof(unsigned char)) + sizeof(int);
+
+				if (totalSize < fixedSize || ((totalSize - fixedSize) % sizeof(unsigned)) != 0)
+					throw netcode::UnpackPacketException("invalid size");
+				if (playerNum != a)
+					throw netcode::UnpackPacketException("invalid player number");
+
+				std::vector<unsigned> checksums((totalSize - fixedSize) / sizeof(unsigned));
+				pckt >> checksums;
+
+				// too old to still be compared against the others
+				if (frameNum < serverFrameNum - static_cast<int>(SYNCCHECK_TIMEOUT) && frameNum != syncRequestFrame)
+					break;
+
+				players[a].syncSubsystems[frameNum] = checksums;
+				CheckSyncSubsystems(frameNum);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(str(format("Player %d sent invalid SyncSubsystems: %s") %a %ex.what()));
+			}
+#endif
+		} break;
+
 		case NETMSG_SHARE:
 			if (inbuf[1] != a) {
 				Message(str(format(WrongPlayer) %msgCode %a %(unsigned)inbuf[1]));
@@ -1967,7 +2272,7 @@ void CGameServer::StartGame(bool forced)
 	gameHasStarted = true;
 	startTime = gameTime;
 	if (!canReconnect && !bypassScriptPasswordCheck)
-		packetCache.clear(); // free memory
+		ClearPacketCache(); // free memory
 
 	if (UDPNet && !canReconnect && !bypassScriptPasswordCheck)
 		UDPNet->SetAcceptingConnections(false); // do not accept new connections
@@ -2312,6 +2617,7 @@ void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 	if (demoReader) {
 		CheckSync();
 		SendDemoData(-1);
+		FlushFrameBundle();
 		return;
 	}
 
@@ -2372,6 +2678,9 @@ void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 #endif
 		}
 	}
+
+	// the frame message(s) go out together with everything relayed before
+	FlushFrameBundle();
 }
 
 void CGameServer::UpdateSpeedControl(int speedCtrl) {
@@ -2409,13 +2718,20 @@ void CGameServer::UpdateLoop()
 				UDPNet->Update();
 
 			Threading::RecursiveScopedLock scoped_lock(gameServerMutex);
+			const spring_time updateStart = spring_gettime();
+
 			ServerReadNet();
 			Update();
+
+			if (hostif && telemetryInterval > spring_notime) {
+				updateTimes.push_back((spring_gettime() - updateStart).toMilliSecsf());
+			}
 		}
 
 		if (hostif)
 			hostif->SendQuit();
 		Broadcast(CBaseNetProtocol::Get().SendQuit("Server shutdown"));
+		FlushFrameBundle();
 
 		// flush the quit messages to reduce ugly network error messages on the client side
 		spring_sleep(spring_msecs(1000)); // this is to make sure the Flush has any effect at all (we don't want a forced flush)
@@ -2625,14 +2941,16 @@ unsigned CGameServer::BindConnection(std::string name, const std::string& passwd
 		return newPlayerNumber;
 	}
 
+	// held back broadcasts are in the packet cache already, they must not
+	// reach the new link a second time
+	FlushFrameBundle();
+
 	newPlayer.Connected(link, isLocal);
 	newPlayer.SendData(boost::shared_ptr<const RawPacket>(gameData->Pack()));
 	newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)newPlayerNumber));
 
 	// after gamedata and playerNum, the player can start loading
-	for (std::list< std::vector<boost::shared_ptr<const netcode::RawPacket> > >::const_iterator lit = packetCache.begin(); lit != packetCache.end(); ++lit)
-		for (std::vector<boost::shared_ptr<const netcode::RawPacket> >::const_iterator vit = lit->begin(); vit != lit->end(); ++vit)
-			newPlayer.SendData(*vit); // throw at him all stuff he missed until now
+	SendPacketCache(newPlayer); // throw at him all stuff he missed until now
 
 	if (!demoReader || setup->demoName.empty()) { // gamesetup from demo?
 		if (!newPlayer.spectator) {
@@ -2718,9 +3036,83 @@ void CGameServer::FreeSkirmishAIId(const unsigned char skirmishAIId) {
 }
 
 void CGameServer::AddToPacketCache(boost::shared_ptr<const netcode::RawPacket> &pckt) {
-	if (packetCache.empty() || packetCache.back().size() >= PKTCACHE_VECSIZE) {
-		packetCache.push_back(std::vector<boost::shared_ptr<const netcode::RawPacket> >());
-		packetCache.back().reserve(PKTCACHE_VECSIZE);
+	if (packetCache.empty())
+		packetCache.reserve(PKTCACHE_BLOCKSIZE);
+
+	packetCache.push_back(pckt);
+
+	if (packetCache.size() >= PKTCACHE_BLOCKSIZE)
+		CompressPacketCache();
+}
+
+void CGameServer::CompressPacketCache() {
+	std::vector<boost::uint8_t> stream;
+
+	for (size_t i = 0; i < packetCache.size(); ++i) {
+		stream.insert(stream.end(), packetCache[i]->data, packetCache[i]->data + packetCache[i]->length);
+	}
+
+	packetCacheBlocks.push_back(PacketCacheBlock());
+	PacketCacheBlock& block = packetCacheBlocks.back();
+
+	unsigned long bufSize = compressBound(stream.size());
+	block.data.resize(bufSize);
+	block.rawSize = stream.size();
+
+	const int error = compress2(&block.data[0], &bufSize, &stream[0], stream.size(), Z_BEST_SPEED);
+	assert(error == Z_OK);
+
+	block.data.resize(bufSize);
+	// the reallocation is worth it, blocks are kept for the whole game
+	std::vector<boost::uint8_t>(block.data).swap(block.data);
+
+	// keeps its capacity for the next block
+	packetCache.clear();
+}
+
+void CGameServer::ClearPacketCache() {
+	std::vector<PacketCacheBlock>().swap(packetCacheBlocks);
+	std::vector<boost::shared_ptr<const netcode::RawPacket> >().swap(packetCache);
+}
+
+void CGameServer::SendPacketCache(GameParticipant& player) const {
+	// a local connection delivers every RawPacket as exactly one message,
+	// so blocks can only be handed over as a whole to network links
+	const bool sendStreams = (player.link != NULL && player.link->AcceptsMessageStreams());
+	const netcode::ProtocolDef* proto = netcode::ProtocolDef::GetInstance();
+
+	std::vector<boost::uint8_t> stream;
+
+	for (std::vector<PacketCacheBlock>::const_iterator bit = packetCacheBlocks.begin(); bit != packetCacheBlocks.end(); ++bit) {
+		unsigned long rawSize = bit->rawSize;
+		stream.resize(rawSize);
+
+		if (uncompress(&stream[0], &rawSize, &bit->data[0], bit->data.size()) != Z_OK || rawSize != bit->rawSize) {
+			// can not happen unless we are out of memory
+			LOG_L(L_ERROR, "[%s] failed to decompress packet-cache block", __FUNCTION__);
+			continue;
+		}
+
+		if (sendStreams) {
+			player.SendData(boost::shared_ptr<const RawPacket>(new RawPacket(&stream[0], rawSize)));
+			continue;
+		}
+
+		for (unsigned int pos = 0; pos < rawSize; ) {
+			const int length = proto->PacketLength(&stream[pos], rawSize - pos);
+
+			// blocks only ever contain complete, valid messages
+			if (!proto->IsValidLength(length, rawSize - pos)) {
+				LOG_L(L_ERROR, "[%s] corrupt packet-cache block", __FUNCTION__);
+				break;
+			}
+
+			player.SendData(boost::shared_ptr<const RawPacket>(new RawPacket(&stream[pos], length)));
+			pos += length;
+		}
+	}
+
+	for (std::vector<boost::shared_ptr<const netcode::RawPacket> >::const_iterator pit = packetCache.begin(); pit != packetCache.end(); ++pit) {
+		player.SendData(*pit);
 	}
-	packetCache.back().push_back(pckt);
 }
@@ -4,6 +4,7 @@
 #define _GAME_SERVER_H
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/cstdint.hpp>
 #include <string>
 #include <map>
 #include <deque>
@@ -92,6 +93,8 @@ public:
 	void UpdateSpeedControl(int speedCtrl);
 	static std::string SpeedControlToString(int speedCtrl);
 
+	const CGameSetup* GetGameSetup() const { return setup.get(); }
+
 	const boost::scoped_ptr<CDemoReader>& GetDemoReader() const { return demoReader; }
 	const boost::scoped_ptr<CDemoRecorder>& GetDemoRecorder() const { return demoRecorder; }
 
@@ -129,9 +132,11 @@ private:
 	void Update();
 	void ProcessPacket(const unsigned playerNum, boost::shared_ptr<const netcode::RawPacket> packet);
 	void CheckSync();
+	void CheckSyncSubsystems(int frameNum);
 	void ServerReadNet();
 
 	void LagProtection();
+	void SendTelemetry();
 
 	/** @brief Generate a unique game identifier and send it to all clients. */
 	void GenerateAndSendGameID();
@@ -142,6 +147,8 @@ private:
 	bool SendDemoData(int targetFrameNum);
 
 	void Broadcast(boost::shared_ptr<const netcode::RawPacket> packet);
+	/// sends the broadcasts held back since the last frame message
+	void FlushFrameBundle();
 
 	/**
 	 * @brief skip frames
@@ -155,6 +162,10 @@ private:
 	void PrivateMessage(int playerNum, const std::string& message);
 
 	void AddToPacketCache(boost::shared_ptr<const netcode::RawPacket>& pckt);
+	void CompressPacketCache();
+	void ClearPacketCache();
+	/// send all cached packets, in bulk if the link supports message streams
+	void SendPacketCache(GameParticipant& player) const;
 
 	bool AdjustPlayerNumber(netcode::RawPacket* buf, int pos, int val = -1);
 	void UpdatePlayerNumberMap();
@@ -175,6 +186,13 @@ private:
 	spring_time lastTick;
 	float timeLeft;
 	spring_time lastPlayerInfo;
+	spring_time lastTelemetry;
+	/// zero if no telemetry is sent to the autohost
+	spring_time telemetryInterval;
+	/// durations of ServerReadNet + Update since lastTelemetry, in ms
+	std::vector<float> updateTimes;
+	/// per player link, bytes sent and received at lastTelemetry
+	std::vector< std::pair<unsigned int, unsigned int> > telemetryLinkData;
 	spring_time lastUpdate;
 	float modGameTime;
 	float gameTime;
@@ -228,7 +246,28 @@ private:
 	bool allowSpecDraw;
 	bool bypassScriptPasswordCheck;
 	bool whiteListAdditionalPlayers;
-	std::list< std::vector<boost::shared_ptr<const netcode::RawPacket> > > packetCache;
+
+	/**
+	 * Broadcast packets replayed to late joiners. Every PKTCACHE_BLOCKSIZE
+	 * packets are concatenated and zlib-compressed into one block; only the
+	 * newest (incomplete) block is kept as individual packets.
+	 */
+	struct PacketCacheBlock {
+		std::vector<boost::uint8_t> data; ///< compressed message stream
+		unsigned int rawSize;
+	};
+	std::vector<PacketCacheBlock> packetCacheBlocks;
+	std::vector<boost::shared_ptr<const netcode::RawPacket> > packetCache;
+
+	/**
+	 * Broadcasts of the current sim frame, sent out together with its frame
+	 * message as one message stream per network link (see FlushFrameBundle)
+	 * so the packet rate per client does not grow with the players' APM.
+	 */
+	std::vector<boost::shared_ptr<const netcode::RawPacket> > frameBundle;
+	unsigned int frameBundleSize; ///< bytes in frameBundle
+	spring_time frameBundleStart; ///< when the first packet of frameBundle was queued
+	bool bundleFrameMessages;
 
 	/////////////////// sync stuff ///////////////////
 #ifdef SYNCCHECK
@@ -236,6 +275,8 @@ private:
 #endif
 	int syncErrorFrame;
 	int syncWarningFrame;
+	int syncSubsystemErrorFrame;
+	int syncRequestFrame; ///< last frame for which NETMSG_SYNCREQUEST was sent
 
 	///////////////// internal stuff //////////////////
 	void InternalSpeedChange(float newSpeed);
@@ -33,6 +33,7 @@
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/Sound/ISound.h"
+#include "System/Sync/SyncChecker.h"
 
 #include <boost/cstdint.hpp>
 
@@ -110,11 +111,46 @@ void CGame::UpdateConsumeSpeed()
 		}
 	}
 
+	if (catchUpThreshold > 0) {
+		if (!catchingUp && numUnconsumedFrames > (catchUpThreshold * GAME_SPEED)) {
+			catchingUp = true;
+			LOG("[%s] catching up on %d queued frames", __FUNCTION__, numUnconsumedFrames);
+		} else if (catchingUp && numUnconsumedFrames <= GAME_SPEED) {
+			catchingUp = false;
+			LOG("[%s] caught up at frame %d", __FUNCTION__, gs->frameNum);
+		}
+	}
+
+	// with the jitter buffer ClientReadNet steers the rate itself unless
+	// we have fallen so far behind that catching up is more important
+	if (netFrameBufferTarget > 0 && numUnconsumedFrames <= (netFrameBufferTarget + GAME_SPEED))
+		return;
+
 	consumeSpeed = GAME_SPEED * gs->speedFactor + (numUnconsumedFrames / 2);
 	msgProcTimeLeft = 0.0f;
 }
 
 
+int CGame::CountQueuedNetFrames(int maxCount) const
+{
+	boost::shared_ptr<const netcode::RawPacket> packet;
+	int numFrames = 0;
+	unsigned ahead = 0;
+
+	while (numFrames < maxCount && (packet = net->Peek(ahead++))) {
+		switch (packet->data[0]) {
+			case NETMSG_NEWFRAME:
+			case NETMSG_KEYFRAME:
+				++numFrames;
+			default:
+				break;
+		}
+	}
+
+	return numFrames;
+}
+
+
 void CGame::ClientReadNet()
 {
 	// compute new msgProcTimeLeft to "smooth" out SimFrame() calls
@@ -124,8 +160,30 @@ void CGame::ClientReadNet()
 		if (skipping) {
 			msgProcTimeLeft = 0.01f;
 		} else {
-			msgProcTimeLeft -= float(msgProcTimeLeft > 1.0f);
-			msgProcTimeLeft += consumeSpeed * (currentFrame - lastframe).toSecsf();
+			const float deltaSecs = (currentFrame - lastframe).toSecsf();
+			const int maxBufferDepth = netFrameBufferTarget + GAME_SPEED;
+
+			if (netFrameBufferTarget > 0) {
+				netFrameBufferDepth = CountQueuedNetFrames(maxBufferDepth + 1);
+				netFrameBufferAvgDepth = mix(netFrameBufferAvgDepth, float(netFrameBufferDepth), 0.1f);
+			}
+
+			if (netFrameBufferTarget > 0 && netFrameBufferDepth <= maxBufferDepth) {
+				// play slightly slower while the buffer is below its target depth and
+				// slightly faster above it, so a late packet is absorbed by the frames
+				// queued in front of it instead of stalling and then bursting
+				const float depthError = (netFrameBufferAvgDepth - netFrameBufferTarget) / netFrameBufferTarget;
+
+				consumeSpeed = GAME_SPEED * gs->speedFactor * Clamp(1.0f + depthError * 0.5f, 0.5f, 2.0f);
+
+				const float frameBudget = consumeSpeed * deltaSecs;
+
+				// do not bank time while starved, otherwise it is spent all at once
+				msgProcTimeLeft = std::min(msgProcTimeLeft + frameBudget, std::max(1.0f, frameBudget) + 1.0f);
+			} else {
+				msgProcTimeLeft -= float(msgProcTimeLeft > 1.0f);
+				msgProcTimeLeft += consumeSpeed * deltaSecs;
+			}
 		}
 
 		lastframe = currentFrame;
@@ -143,7 +201,8 @@ void CGame::ClientReadNet()
 	const float maxSimFPS    = (1.0f - gu->reconnectSimDrawBalance) * 1000.0f / std::max(0.01f, gu->avgSimFrameTime);
 	const float minDrawFPS   =         gu->reconnectSimDrawBalance  * 1000.0f / std::max(0.01f, gu->avgDrawFrameTime);
 	const float simDrawRatio = maxSimFPS / minDrawFPS;
-	const float msgProcTimeLimit = (GML::SimEnabled() && GML::MultiThreadSim()) ? (1000.0f / gu->minFPS) :
+	// while catching up only draw as often as needed to keep the window responsive
+	const float msgProcTimeLimit = ((GML::SimEnabled() && GML::MultiThreadSim()) || catchingUp) ? (1000.0f / gu->minFPS) :
 		Clamp(simDrawRatio * gu->avgSimFrameTime, 5.0f, 1000.0f / gu->minFPS);
 
 	const spring_time msgProcEndTime = spring_gettime() + spring_msecs(msgProcTimeLimit);
@@ -439,6 +498,18 @@ void CGame::ClientReadNet()
 				ASSERT_SYNCED(gs->frameNum);
 				ASSERT_SYNCED(CSyncChecker::GetChecksum());
 				net->Send(CBaseNetProtocol::Get().SendSyncResponse(gu->myPlayerNum, gs->frameNum, CSyncChecker::GetChecksum()));
+				CSyncChecker::RecordFrame(gs->frameNum);
+
+				if ((gs->frameNum % GAME_SPEED) == 0) {
+					// once per second, lets the server tell which part of the sim diverged
+					std::vector<unsigned int> checksums(CSyncChecker::SUBSYSTEM_COUNT);
+
+					for (unsigned int n = 0; n < checksums.size(); n++) {
+						checksums[n] = CSyncChecker::GetSubsystemChecksum(n);
+					}
+
+					net->Send(CBaseNetProtocol::Get().SendSyncSubsystems(gu->myPlayerNum, gs->frameNum, checksums));
+				}
 
 				if ((gs->frameNum & 4095) == 0) {
 					// reset checksum every 4096 frames =~ 2.5 minutes
@@ -452,6 +523,22 @@ void CGame::ClientReadNet()
 				}
 			} break;
 
+			case NETMSG_SYNCREQUEST: {
+#ifdef SYNCCHECK
+				// the server saw the total checksums diverge at this frame
+				const int frameNum = *(int*)(inbuf + 1);
+
+				std::vector<unsigned int> checksums(CSyncChecker::SUBSYSTEM_COUNT);
+
+				if (CSyncChecker::GetFrameChecksums(frameNum, &checksums[0])) {
+					net->Send(CBaseNetProtocol::Get().SendSyncSubsystems(gu->myPlayerNum, frameNum, checksums));
+				} else {
+					LOG_L(L_WARNING, "[%s] frame %d is no longer in the sync history", __FUNCTION__, frameNum);
+				}
+#endif
+				AddTraffic(-1, packetCode, dataLength);
+			} break;
+
 			case NETMSG_SYNCRESPONSE: {
 #if (defined(SYNCCHECK))
 				if (gameServer != NULL && gameServer->GetDemoReader() != NULL) {
@@ -1115,7 +1202,7 @@ void CGame::ClientReadNet()
 
 					// stop attacks against former foe
 					if (allied) {
-						for (std::list<CUnit*>::iterator it = unitHandler->activeUnits.begin();
+						for (std::vector<CUnit*>::iterator it = unitHandler->activeUnits.begin();
 								it != unitHandler->activeUnits.end();
 								++it) {
 							if (teamHandler->Ally((*it)->allyteam, whichAllyTeam)) {
@@ -85,11 +85,14 @@ PacketType CBaseNetProtocol::SendPathCheckSum(uchar myPlayerNum, boost::uint32_t
 }
 
 
-PacketType CBaseNetProtocol::SendCommand(uchar myPlayerNum, int id, uchar options, const std::vector<float>& params)
+PacketType CBaseNetProtocol::SendCommand(uchar myPlayerNum, int id, uchar options, const float* params, unsigned int numParams)
 {
-	unsigned size = 9 + params.size() * sizeof(float);
+	unsigned size = 9 + numParams * sizeof(float);
 	PackPacket* packet = new PackPacket(size, NETMSG_COMMAND);
-	*packet << static_cast<unsigned short>(size) << myPlayerNum << id << options << params;
+	*packet << static_cast<unsigned short>(size) << myPlayerNum << id << options;
+	for (unsigned int i = 0; i < numParams; ++i) {
+		*packet << params[i];
+	}
 	return PacketType(packet);
 }
 
@@ -111,10 +114,10 @@ PacketType CBaseNetProtocol::SendPause(uchar myPlayerNum, uchar bPaused)
 
 
 
-PacketType CBaseNetProtocol::SendAICommand(uchar myPlayerNum, unsigned char aiID, short unitID, int id, int aiCommandId, uchar options, const std::vector<float>& params)
+PacketType CBaseNetProtocol::SendAICommand(uchar myPlayerNum, unsigned char aiID, short unitID, int id, int aiCommandId, uchar options, const float* params, unsigned int numParams)
 {
 	int cmdTypeId = NETMSG_AICOMMAND;
-	unsigned size = 12 + (params.size() * sizeof(float));
+	unsigned size = 12 + (numParams * sizeof(float));
 	if (aiCommandId != -1) {
 		cmdTypeId = NETMSG_AICOMMAND_TRACKED;
 		size += 4;
@@ -124,7 +127,9 @@ PacketType CBaseNetProtocol::SendAICommand(uchar myPlayerNum, unsigned char aiID
 	if (cmdTypeId == NETMSG_AICOMMAND_TRACKED) {
 		*packet << aiCommandId;
 	}
-	*packet << params;
+	for (unsigned int i = 0; i < numParams; ++i) {
+		*packet << params[i];
+	}
 	return PacketType(packet);
 }
 
@@ -259,6 +264,21 @@ PacketType CBaseNetProtocol::SendSyncResponse(uchar myPlayerNum, int frameNum, u
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendSyncSubsystems(uchar myPlayerNum, int frameNum, const std::vector<uint>& checksums)
+{
+	const unsigned size = (3 * sizeof(uchar)) + sizeof(int) + (checksums.size() * sizeof(uint));
+	PackPacket* packet = new PackPacket(size, NETMSG_SYNCSUBSYSTEMS);
+	*packet << static_cast<uchar>(size) << myPlayerNum << frameNum << checksums;
+	return PacketType(packet);
+}
+
+PacketType CBaseNetProtocol::SendSyncRequest(int frameNum)
+{
+	PackPacket* packet = new PackPacket(5, NETMSG_SYNCREQUEST);
+	*packet << frameNum;
+	return PacketType(packet);
+}
+
 PacketType CBaseNetProtocol::SendSystemMessage(uchar myPlayerNum, std::string message)
 {
 	if (message.size() > 65000)
@@ -470,6 +490,8 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_GAMEOVER, -1);
 	proto->AddType(NETMSG_MAPDRAW, -1);
 	proto->AddType(NETMSG_SYNCRESPONSE, 10);
+	proto->AddType(NETMSG_SYNCSUBSYSTEMS, -1);
+	proto->AddType(NETMSG_SYNCREQUEST, 5);
 	proto->AddType(NETMSG_SYSTEMMSG, -2);
 	proto->AddType(NETMSG_STARTPOS, 16);
 	proto->AddType(NETMSG_PLAYERINFO, 10);
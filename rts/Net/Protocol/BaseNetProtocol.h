@@ -71,8 +71,10 @@ enum NETMSG {
 	                              // uchar messageSize = 12, myPlayerNum, command = MapDrawAction::NET_LINE; short x1, z1, x2, z2;
 	                              // /*messageSize*/   uchar myPlayerNum, command = MapDrawAction::NET_POINT; short x, z; std::string label;
 	NETMSG_SYNCRESPONSE     = 33, // uchar myPlayerNum; int frameNum; uint checksum;
+	NETMSG_SYNCSUBSYSTEMS   = 34, // uchar messageSize, myPlayerNum; int frameNum; std::vector<uint> checksums (one per CSyncChecker::Subsystem)
 	NETMSG_SYSTEMMSG        = 35, // uchar myPlayerNum, std::string message;
 	NETMSG_STARTPOS         = 36, // uchar myPlayerNum, uchar myTeam, ready /*0: not ready, 1: ready, 2: don't update readiness*/; float x, y, z;
+	NETMSG_SYNCREQUEST      = 37, // int frameNum;  (server asks for the NETMSG_SYNCSUBSYSTEMS of an earlier frame)
 	NETMSG_PLAYERINFO       = 38, // uchar myPlayerNum; float cpuUsage; int ping /*in frames*/;
 	NETMSG_PLAYERLEFT       = 39, // uchar myPlayerNum, bIntended /*0: lost connection, 1: left, 2: forced (kicked) */;
 
@@ -152,11 +154,11 @@ public:
 	PacketType SendRandSeed(uint randSeed);
 	PacketType SendGameID(const uchar* buf);
 	PacketType SendPathCheckSum(uchar myPlayerNum, boost::uint32_t checksum);
-	PacketType SendCommand(uchar myPlayerNum, int id, uchar options, const std::vector<float>& params);
+	PacketType SendCommand(uchar myPlayerNum, int id, uchar options, const float* params, unsigned int numParams);
 	PacketType SendSelect(uchar myPlayerNum, const std::vector<short>& selectedUnitIDs);
 	PacketType SendPause(uchar myPlayerNum, uchar bPaused);
 
-	PacketType SendAICommand(uchar myPlayerNum, unsigned char aiID, short unitID, int id, int aiCommandId, uchar options, const std::vector<float>& params);
+	PacketType SendAICommand(uchar myPlayerNum, unsigned char aiID, short unitID, int id, int aiCommandId, uchar options, const float* params, unsigned int numParams);
 	PacketType SendAIShare(uchar myPlayerNum, unsigned char aiID, uchar sourceTeam, uchar destTeam, float metal, float energy, const std::vector<short>& unitIDs);
 
 	PacketType SendUserSpeed(uchar myPlayerNum, float userSpeed);
@@ -175,6 +177,8 @@ public:
 	PacketType SendMapDrawLine(uchar myPlayerNum, short x1, short z1, short x2, short z2, bool);
 	PacketType SendMapDrawPoint(uchar myPlayerNum, short x, short z, const std::string& label, bool);
 	PacketType SendSyncResponse(uchar myPlayerNum, int frameNum, uint checksum);
+	PacketType SendSyncSubsystems(uchar myPlayerNum, int frameNum, const std::vector<uint>& checksums);
+	PacketType SendSyncRequest(int frameNum);
 	PacketType SendSystemMessage(uchar myPlayerNum, std::string message);
 	PacketType SendStartPos(uchar myPlayerNum, uchar teamNum, uchar readyState, float x, float y, float z);
 	PacketType SendPlayerInfo(uchar myPlayerNum, float cpuUsage, int ping);
@@ -89,6 +89,16 @@ std::string CNetProtocol::ConnectionStr() const
 	return serverConn->GetFullAddress();
 }
 
+unsigned int CNetProtocol::GetDataSent() const
+{
+	return ((serverConn != NULL)? serverConn->GetDataSent(): 0);
+}
+
+unsigned int CNetProtocol::GetDataReceived() const
+{
+	return ((serverConn != NULL)? serverConn->GetDataReceived(): 0);
+}
+
 boost::shared_ptr<const netcode::RawPacket> CNetProtocol::Peek(unsigned ahead) const
 {
 	GML_STDMUTEX_LOCK(net); // Peek
@@ -52,6 +52,10 @@ public:
 
 	std::string ConnectionStr() const;
 
+	/// bytes exchanged with the server so far
+	unsigned int GetDataSent() const;
+	unsigned int GetDataReceived() const;
+
 	/**
 	 * @brief Take a look at the messages in the recieve buffer (read-only)
 	 * @return A RawPacket holding the data, or 0 if no data
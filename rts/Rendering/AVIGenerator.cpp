@@ -5,6 +5,7 @@
 
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VBO.h"
 #include "Game/GameVersion.h"
 #include "System/Log/ILog.h"
 #include "System/SpringApp.h"
@@ -88,7 +89,7 @@ CAVIGenerator::CAVIGenerator(const std::string& fileName, int videoSizeX, int vi
 							errorMsg("Ok"),
 							quitAVIgen(false),
 							AVIThread(0),
-							readBuf(NULL),
+							numReadFrames(0),
 							m_lFrame(0),
 							m_pAVIFile(NULL),
 							m_pStream(NULL),
@@ -106,6 +107,10 @@ CAVIGenerator::CAVIGenerator(const std::string& fileName, int videoSizeX, int vi
 	bitmapInfo.biSizeImage = videoSizeX * videoSizeY * 3;
 	bitmapInfo.biCompression = BI_RGB;
 
+	for (int i = 0; i < NUM_READ_PBOS; i++) {
+		readPBOs[i] = NULL;
+	}
+
 	if (!initVFW()) {
 		quitAVIgen = true;
 	}
@@ -137,8 +142,10 @@ CAVIGenerator::~CAVIGenerator() {
 		delete [] tmp;
 	}
 
-	delete [] readBuf;
-	readBuf = 0;
+	for (int i = 0; i < NUM_READ_PBOS; i++) {
+		delete readPBOs[i];
+		readPBOs[i] = NULL;
+	}
 
 
 	ReleaseAVICompressionEngine();
@@ -151,7 +158,6 @@ CAVIGenerator::~CAVIGenerator() {
 	assert(m_pStreamCompressed == NULL);
 	assert(freeImageBuffers.empty());
 	assert(imageBuffers.empty());
-	assert(readBuf == NULL);
 }
 
 
@@ -344,6 +350,13 @@ bool CAVIGenerator::InitEngine() {
 		freeImageBuffers.push_back(tmpBuf);
 	}
 
+	for (int i = 0; i < NUM_READ_PBOS; i++) {
+		readPBOs[i] = new VBO(GL_PIXEL_PACK_BUFFER);
+		readPBOs[i]->Bind(GL_PIXEL_PACK_BUFFER);
+		readPBOs[i]->Resize(bitmapInfo.biSizeImage, GL_STREAM_READ);
+		readPBOs[i]->Unbind();
+	}
+
 	HWND mainWindow = FindWindow(NULL, ("Spring " + SpringVersion::GetFull()).c_str());
 	if (globalRendering->fullScreen) {
 		ShowWindow(mainWindow, SW_SHOWMINNOACTIVE);
@@ -379,25 +392,57 @@ HRESULT CAVIGenerator::AddFrame(unsigned char* pixelData){
 
 bool CAVIGenerator::readOpenglPixelDataThreaded() {
 
-	while (true) {
+	// start reading back this frame, with PBOs the copy runs asynchronously
+	VBO* readPBO = readPBOs[numReadFrames % NUM_READ_PBOS];
+	readPBO->Bind(GL_PIXEL_PACK_BUFFER);
+	glReadPixels(0, 0, bitmapInfo.biWidth, bitmapInfo.biHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, readPBO->GetPtr());
+	readPBO->Unbind();
+
+	// the oldest frame in the ring (read NUM_READ_PBOS - 1 calls
+	// ago) should be done by now, hand that one to the encoder
+	if ((++numReadFrames) < NUM_READ_PBOS) {
+		return !quitAVIgen;
+	}
+
+	unsigned char* frameBuf = NULL;
+
+	{
 		boost::mutex::scoped_lock lock(AVIMutex);
+
+		while (!quitAVIgen && freeImageBuffers.empty()) {
+			AVICondition.wait(lock);
+		}
 		if (quitAVIgen) {
 			return false;
-		} else if (readBuf != NULL) {
-			imageBuffers.push_back(readBuf);
-			readBuf = NULL;
-			AVICondition.notify_all();
 		}
-		if (freeImageBuffers.empty()) {
-			AVICondition.wait(lock);
+
+		frameBuf = freeImageBuffers.front();
+		freeImageBuffers.pop_front();
+	}
+
+	VBO* donePBO = readPBOs[numReadFrames % NUM_READ_PBOS];
+	donePBO->Bind(GL_PIXEL_PACK_BUFFER);
+	const GLubyte* pixels = donePBO->MapBuffer(GL_MAP_READ_BIT);
+
+	if (pixels != NULL) {
+		memcpy(frameBuf, pixels, bitmapInfo.biSizeImage);
+	}
+
+	donePBO->UnmapBuffer();
+	donePBO->Unbind();
+
+	{
+		boost::mutex::scoped_lock lock(AVIMutex);
+
+		if (pixels != NULL) {
+			imageBuffers.push_back(frameBuf);
 		} else {
-			readBuf = freeImageBuffers.front();
-			freeImageBuffers.pop_front();
-			break;
+			freeImageBuffers.push_back(frameBuf);
 		}
+
+		AVICondition.notify_all();
 	}
 
-	glReadPixels(0, 0, bitmapInfo.biWidth, bitmapInfo.biHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, readBuf);
 	return true;
 }
 
@@ -16,6 +16,7 @@
 #include <string>
 #include <list>
 
+class VBO;
 
 class CAVIGenerator : boost::noncopyable {
 public:
@@ -55,7 +56,12 @@ private:
 	std::list<unsigned char*> freeImageBuffers;
 	std::list<unsigned char*> imageBuffers;
 
-	unsigned char* readBuf;
+	/// frames are read back asynchronously through a ring of PBOs and
+	/// handed to the encoder (NUM_READ_PBOS - 1) frames later
+	static const int NUM_READ_PBOS = 3;
+
+	VBO* readPBOs[NUM_READ_PBOS];
+	unsigned int numReadFrames;
 
 
 
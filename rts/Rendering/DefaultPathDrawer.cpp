@@ -269,10 +269,17 @@ void DefaultPathDrawer::UpdateExtraTexture(int extraTex, int starty, int endy, i
 					const unsigned int hx = tx << 1;
 					const unsigned int hy = ty << 1;
 
+					const unsigned int nodeIdx[3] = {
+						hy * gs->mapx + hx,
+						(hy / medResBlockSize) * medResBlocksX + (hx / medResBlockSize),
+						(hy / lowResBlockSize) * lowResBlocksX + (hx / lowResBlockSize),
+					};
+
+					// nodes not touched by the most recent search hold stale costs
 					float gCost[3] = {
-						maxResStates.gCost[hy * gs->mapx + hx],
-						medResStates.gCost[(hy / medResBlockSize) * medResBlocksX + (hx / medResBlockSize)],
-						lowResStates.gCost[(hy / lowResBlockSize) * lowResBlocksX + (hx / lowResBlockSize)],
+						maxResStates.IsNodeCurrent(nodeIdx[0])? maxResStates.gCost[nodeIdx[0]]: PATHCOST_INFINITY,
+						medResStates.IsNodeCurrent(nodeIdx[1])? medResStates.gCost[nodeIdx[1]]: PATHCOST_INFINITY,
+						lowResStates.IsNodeCurrent(nodeIdx[2])? lowResStates.gCost[nodeIdx[2]]: PATHCOST_INFINITY,
 					};
 
 					if (math::isinf(gCost[0])) { gCost[0] = gCostMax[0]; }
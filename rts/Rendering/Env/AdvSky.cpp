@@ -7,10 +7,13 @@
 #include "Map/MapInfo.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/VertexArray.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Shaders/Shader.h"
 #include "Rendering/Textures/Bitmap.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Exceptions.h"
+#include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 #include "System/Matrix44f.h"
 #include "System/myMath.h"
@@ -35,6 +38,9 @@ CAdvSky::CAdvSky()
 	, sunTex(0)
 	, sunFlareTex(0)
 	, skyTexUpdateIter(0)
+	, skyTexShader(NULL)
+	, skyDot3TexShader(NULL)
+	, gpuSkyTextures(false)
 	, skyDomeList(0)
 	, sunFlareList(0)
 	, skyAngle(0.0f)
@@ -89,9 +95,60 @@ CAdvSky::CAdvSky()
 
 	cloudFP = LoadFragmentProgram("ARB/clouds.fp");
 
+	// the initial textures are still made on the CPU by CreateClouds
+	gpuSkyTextures = InitSkyTexShaders();
+
 	CreateSkyDomeList();
 }
 
+bool CAdvSky::InitSkyTexShaders()
+{
+	if (!globalRendering->haveGLSL)
+		return false;
+
+	skyTexShader = shaderHandler->CreateProgramObject("[AdvSky]", "SkyTexShader", false);
+	skyTexShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/advSkyTexFS.glsl", "", GL_FRAGMENT_SHADER));
+	skyTexShader->Link();
+
+	skyDot3TexShader = shaderHandler->CreateProgramObject("[AdvSky]", "SkyDot3TexShader", false);
+	skyDot3TexShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/advSkyTexFS.glsl", "#define SKY_DOT3\n", GL_FRAGMENT_SHADER));
+	skyDot3TexShader->Link();
+
+	Shader::IProgramObject* shaders[] = {skyTexShader, skyDot3TexShader};
+
+	for (int n = 0; n < 2; n++) {
+		Shader::IProgramObject* shader = shaders[n];
+
+		if (!shader->IsValid()) {
+			LOG_L(L_WARNING, "[AdvSky] sky-texture shader error, using CPU fallback: %s", (shader->GetLog()).c_str());
+			return false;
+		}
+
+		shader->SetUniformLocation("lightDir");       // idx 0
+		shader->SetUniformLocation("lightIntensity"); // idx 1
+		shader->SetUniformLocation("skyColor");       // idx 2
+		shader->SetUniformLocation("sunColor");       // idx 3
+		shader->SetUniformLocation("skyAngle");       // idx 4
+		shader->SetUniformLocation("domeWidth");      // idx 5
+		shader->SetUniformLocation("domeHeight");     // idx 6
+		shader->SetUniformLocation("texSize");        // idx 7
+	}
+
+	skyTexFBO.reloadOnAltTab = true;
+	skyTexFBO.Bind();
+	skyTexFBO.AttachTexture(skyTex);
+	const bool skyTexStatus = skyTexFBO.CheckStatus("ADVSKY");
+
+	skyDot3TexFBO.reloadOnAltTab = true;
+	skyDot3TexFBO.Bind();
+	skyDot3TexFBO.AttachTexture(skyDot3Tex);
+	const bool skyDot3TexStatus = skyDot3TexFBO.CheckStatus("ADVSKY");
+
+	FBO::Unbind();
+
+	return (skyTexStatus && skyDot3TexStatus);
+}
+
 void CAdvSky::CreateSkyDomeList()
 {
 	glGetError();
@@ -185,6 +242,7 @@ CAdvSky::~CAdvSky()
 	delete[] cloudTexMem;
 
 	glSafeDeleteProgram( cloudFP );
+	shaderHandler->ReleaseProgramObjects("[AdvSky]");
 
 	delmat3<int>(randMatrix);
 	delmat2<int>(rawClouds);
@@ -849,7 +907,69 @@ void CAdvSky::UpdateSkyDir() {
 	skyAngle = GetRadFromXY(skydir2.x, skydir2.z) + PI / 2.0f;
 }
 
+void CAdvSky::RenderSkyTexture(Shader::IProgramObject* shader, FBO& texFBO, int texSize)
+{
+	const float3& lightDir = skyLight->GetLightDir();
+
+	texFBO.Bind();
+
+	glViewport(0, 0, texSize, texSize);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, 1, 0, 1, -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glPushAttrib(GL_ENABLE_BIT);
+	glDisable(GL_BLEND);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_FOG);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_TEXTURE_2D);
+
+	shader->Enable();
+	shader->SetUniform3f(0, lightDir.x, lightDir.y, lightDir.z);
+	shader->SetUniform1f(1, skyLight->GetLightIntensity());
+	shader->SetUniform3f(2, skyColor.x, skyColor.y, skyColor.z);
+	shader->SetUniform3f(3, sunColor.x, sunColor.y, sunColor.z);
+	shader->SetUniform1f(4, skyAngle);
+	shader->SetUniform1f(5, domeWidth);
+	shader->SetUniform1f(6, domeheight);
+	shader->SetUniform1f(7, texSize);
+
+	CVertexArray* va = GetVertexArray();
+	va->Initialize();
+	va->CheckInitSize(4 * VA_SIZE_0);
+	va->AddVertexQ0(0.0f, 0.0f, 0.0f);
+	va->AddVertexQ0(1.0f, 0.0f, 0.0f);
+	va->AddVertexQ0(1.0f, 1.0f, 0.0f);
+	va->AddVertexQ0(0.0f, 1.0f, 0.0f);
+	va->DrawArray0(GL_QUADS);
+
+	shader->Disable();
+
+	glPopAttrib();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+
+	glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
+	FBO::Unbind();
+}
+
 void CAdvSky::UpdateSkyTexture() {
+	if (gpuSkyTextures) {
+		// regenerating both textures in full is cheaper on the GPU
+		// than making and uploading a single row on the CPU
+		RenderSkyTexture(skyTexShader, skyTexFBO, 512);
+		RenderSkyTexture(skyDot3TexShader, skyDot3TexFBO, 256);
+		return;
+	}
+
 	const int mod = skyTexUpdateIter % 3;
 
 	if (mod <= 1) {
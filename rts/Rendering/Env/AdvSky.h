@@ -7,6 +7,10 @@
 #include "Rendering/GL/FBO.h"
 #include "ISky.h"
 
+namespace Shader {
+	struct IProgramObject;
+}
+
 class CAdvSky : public ISky
 {
 public:
@@ -37,6 +41,8 @@ private:
 	float GetTexCoordFromDir(const float3& dir);
 	float3 GetCoord(int x, int y);
 	void CreateDetailTex();
+	bool InitSkyTexShaders();
+	void RenderSkyTexture(Shader::IProgramObject* shader, FBO& texFBO, int texSize);
 
 protected:
 	FBO fbo;
@@ -64,6 +70,13 @@ protected:
 	unsigned char (* skytexpart)[4];
 	unsigned int skyTexUpdateIter;
 
+	/// renders skyTex and skyDot3Tex (if valid) instead of UpdateTexPart*
+	Shader::IProgramObject* skyTexShader;
+	Shader::IProgramObject* skyDot3TexShader;
+	FBO skyTexFBO;
+	FBO skyDot3TexFBO;
+	bool gpuSkyTextures;
+
 	unsigned int skyDomeList;
 	unsigned int sunFlareList;
 
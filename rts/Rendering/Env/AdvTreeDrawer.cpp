@@ -308,6 +308,26 @@ void CAdvTreeDrawer::DrawTreeVertexFar(CVertexArray* va, const float3& pos, cons
 	SetArrayQ(va, TEX_LEAF_END_X1   + dx, TEX_LEAF_START_Y4 + dy, base);
 }
 
+bool CAdvTreeDrawer::TreeSquareInView(const TreeSquareStruct* tss, int x, int y) {
+	if (tss->trees.empty())
+		return false;
+
+	const float treeSquareSize = SQUARE_SIZE * TREE_SQUARE_SIZE;
+
+	const float3 mins(
+		x * treeSquareSize - HALF_MAX_TREE_HEIGHT,
+		tss->minHeight,
+		y * treeSquareSize - HALF_MAX_TREE_HEIGHT
+	);
+	const float3 maxs(
+		(x + 1) * treeSquareSize + HALF_MAX_TREE_HEIGHT,
+		tss->maxHeight + MAX_TREE_HEIGHT,
+		(y + 1) * treeSquareSize + HALF_MAX_TREE_HEIGHT
+	);
+
+	return camera->InView(mins, maxs);
+}
+
 
 
 
@@ -338,6 +358,11 @@ void CAdvTreeSquareDrawer::DrawQuad(int x, int y)
 		// skip the closest squares
 		return;
 	}
+	if (!CAdvTreeDrawer::TreeSquareInView(tss, x, y)) {
+		// empty or outside the frustum; keeps its lists
+		// until the garbage collection catches up
+		return;
+	}
 
 	float3 dif;
 		dif.x = camera->GetPos().x - ((x * SQUARE_SIZE * TREE_SQUARE_SIZE) + (SQUARE_SIZE * TREE_SQUARE_SIZE / 2));
@@ -564,6 +589,11 @@ void CAdvTreeDrawer::Draw(float treeDistance, bool drawReflection)
 		for (TreeSquareStruct* pTSS = trees + (ystart * treesX); pTSS <= trees + (yend * treesX); pTSS += treesX) {
 			for (TreeSquareStruct* tss = pTSS + xstart; tss <= (pTSS + xend); ++tss) {
 				tss->lastSeen = gs->frameNum;
+
+				// test the whole square before looking at single trees
+				if (!TreeSquareInView(tss, (tss - trees) % treesX, (tss - trees) / treesX))
+					continue;
+
 				va->EnlargeArrays(12 * tss->trees.size(), 0, VA_SIZE_T); //!alloc room for all tree vertexes
 
 				for (std::map<int, TreeStruct>::iterator ti = tss->trees.begin(); ti != tss->trees.end(); ++ti) {
@@ -606,6 +636,7 @@ void CAdvTreeDrawer::Draw(float treeDistance, bool drawReflection)
 						glAlphaFunc(GL_GREATER, 0.5f);
 
 						// save for second pass
+						pFT->id = f->id;
 						pFT->pos = ts->pos;
 						pFT->deltaY = dy;
 						pFT->type = type;
@@ -780,6 +811,8 @@ void CAdvTreeSquareShadowPassDrawer::DrawQuad(int x, int y)
 		// skip the closest squares
 		return;
 	}
+	if (tss->trees.empty())
+		return;
 
 	float3 dif;
 		dif.x = camera->GetPos().x - ((x * SQUARE_SIZE * TREE_SQUARE_SIZE) + (SQUARE_SIZE * TREE_SQUARE_SIZE / 2));
@@ -1118,7 +1151,18 @@ void CAdvTreeDrawer::AddTree(int treeID, int treeType, const float3& pos, float
 		((int)pos.x) / (treeSquareSize) +
 		((int)pos.z) / (treeSquareSize) * treesX;
 
-	trees[treeSquareIdx].trees[treeID] = ts;
+	TreeSquareStruct* tss = &trees[treeSquareIdx];
+
+	if (tss->trees.empty()) {
+		tss->minHeight = pos.y;
+		tss->maxHeight = pos.y;
+	} else {
+		// deleted trees do not shrink the range, it stays conservative
+		tss->minHeight = std::min(tss->minHeight, pos.y);
+		tss->maxHeight = std::max(tss->maxHeight, pos.y);
+	}
+
+	tss->trees[treeID] = ts;
 	ResetPos(pos);
 }
 
@@ -38,6 +38,8 @@ public:
 	static void DrawTreeVertexMid(CVertexArray* va, const float3& pos, float dx, float dy, bool enlarge = true);
 	static void DrawTreeVertexFar(CVertexArray* va, const float3& pos, const float3& swd, float dx, float dy, bool enlarge = true);
 
+	static bool TreeSquareInView(const TreeSquareStruct* tss, int x, int y);
+
 	struct FadeTree {
 		int id;
 		int type;
@@ -54,6 +54,7 @@ CONFIG(bool, BumpWaterShoreWaves).defaultValue(true).safemodeValue(false).descri
 CONFIG(bool, BumpWaterEndlessOcean).defaultValue(true).description("Sets whether Bumpmapped water will be drawn beyond the map edge.");
 CONFIG(bool, BumpWaterDynamicWaves).defaultValue(true);
 CONFIG(bool, BumpWaterUseUniforms).defaultValue(false);
+CONFIG(int, BumpWaterReflectionFrameSkip).defaultValue(0).minimumValue(0).description("Number of frames the reflection of Bumpmapped water may be reused while the camera does not move (0 updates it every frame).");
 CONFIG(bool, BumpWaterOcclusionQuery).defaultValue(false); //FIXME doesn't work as expected (it's slower than w/o), needs fixing
 
 
@@ -188,6 +189,8 @@ CBumpWater::CBumpWater()
 	               && ((readMap->HasVisibleWater()) || (mapInfo->water.forceRendering));
 	dynWaves     = (configHandler->GetBool("BumpWaterDynamicWaves")) && (mapInfo->water.numTiles > 1);
 	useUniforms  = (configHandler->GetBool("BumpWaterUseUniforms"));
+	reflectionFrameSkip = configHandler->GetInt("BumpWaterReflectionFrameSkip");
+	reflectionFramesSkipped = 0;
 
 	refractTexture = 0;
 	reflectTexture = 0;
@@ -585,6 +588,11 @@ CBumpWater::CBumpWater()
 	if (refraction > 1) {
 		drawSolid = true;
 	}
+
+	waterPatchesX = (gs->mapx + WATER_PATCH_SIZE - 1) / WATER_PATCH_SIZE;
+	waterPatchesY = (gs->mapy + WATER_PATCH_SIZE - 1) / WATER_PATCH_SIZE;
+	waterPatchMinHeights.resize(waterPatchesX * waterPatchesY, 0.0f);
+	UpdateWaterPatches(SRectangle(0, 0, gs->mapx, gs->mapy));
 }
 
 
@@ -740,10 +748,24 @@ void CBumpWater::UpdateWater(CGame* game)
 	}
 #endif
 
+	// neither pass is needed if all water is out of view; the
+	// reflection pass redraws the whole scene, so it can also be
+	// reused for a few frames as long as the camera stands still
+	if (!IsWaterInView())
+		return;
+
+	const bool updateReflection = ((reflection > 0) && !SkipReflectionUpdate());
+
 	glPushAttrib(GL_FOG_BIT);
-	if (refraction > 1) DrawRefraction(game);
-	if (reflection > 0) DrawReflection(game);
-	if (reflection || refraction) {
+	if (refraction > 1) {
+		SCOPED_TIMER("BumpWater::UpdateWater (Refraction)");
+		DrawRefraction(game);
+	}
+	if (updateReflection) {
+		SCOPED_TIMER("BumpWater::UpdateWater (Reflection)");
+		DrawReflection(game);
+	}
+	if (updateReflection || (refraction > 1)) {
 		FBO::Unbind();
 		glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
 	}
@@ -773,8 +795,92 @@ CBumpWater::CoastAtlasRect::CoastAtlasRect(const SRectangle& rect)
 	isCoastline = true;
 }
 
+void CBumpWater::UpdateWaterPatches(const SRectangle& rect)
+{
+	const float* hm = readMap->GetCornerHeightMapUnsynced();
+
+	const int px1 = std::max(rect.x1, 0) / WATER_PATCH_SIZE;
+	const int pz1 = std::max(rect.y1, 0) / WATER_PATCH_SIZE;
+	const int px2 = std::min(rect.x2, gs->mapx - 1) / WATER_PATCH_SIZE;
+	const int pz2 = std::min(rect.y2, gs->mapy - 1) / WATER_PATCH_SIZE;
+
+	for (int pz = pz1; pz <= pz2; pz++) {
+		for (int px = px1; px <= px2; px++) {
+			const int x1 = px * WATER_PATCH_SIZE, x2 = std::min(x1 + WATER_PATCH_SIZE, gs->mapx);
+			const int z1 = pz * WATER_PATCH_SIZE, z2 = std::min(z1 + WATER_PATCH_SIZE, gs->mapy);
+
+			float minHeight = hm[z1 * gs->mapxp1 + x1];
+
+			for (int z = z1; z <= z2; z++) {
+				for (int x = x1; x <= x2; x++) {
+					minHeight = std::min(minHeight, hm[z * gs->mapxp1 + x]);
+				}
+			}
+
+			waterPatchMinHeights[pz * waterPatchesX + px] = minHeight;
+		}
+	}
+}
+
+bool CBumpWater::IsWaterInView() const
+{
+	if (mapInfo->water.forceRendering)
+		return true;
+
+	// waves and the surface offset can lift the plane slightly
+	const float waterMaxY = 10.0f;
+	const float patchSize = WATER_PATCH_SIZE * SQUARE_SIZE;
+
+	for (int pz = 0; pz < waterPatchesY; pz++) {
+		for (int px = 0; px < waterPatchesX; px++) {
+			const float minHeight = waterPatchMinHeights[pz * waterPatchesX + px];
+
+			if (minHeight >= 0.0f)
+				continue;
+
+			const float3 mins(px * patchSize, minHeight, pz * patchSize);
+			const float3 maxs(mins.x + patchSize, waterMaxY, mins.z + patchSize);
+
+			if (camera->InView(mins, maxs))
+				return true;
+		}
+	}
+
+	if (!endlessOcean)
+		return false;
+
+	// the ocean outside the map extends far beyond every edge
+	const float mapX = gs->mapx * SQUARE_SIZE;
+	const float mapZ = gs->mapy * SQUARE_SIZE;
+	const float rim = std::max(mapX, mapZ) * 4.0f;
+
+	if (camera->InView(float3(-rim, 0.0f, -rim), float3(mapX + rim, waterMaxY, 0.0f))) return true; // north
+	if (camera->InView(float3(-rim, 0.0f, mapZ), float3(mapX + rim, waterMaxY, mapZ + rim))) return true; // south
+	if (camera->InView(float3(-rim, 0.0f, 0.0f), float3(0.0f, waterMaxY, mapZ))) return true; // west
+	if (camera->InView(float3(mapX, 0.0f, 0.0f), float3(mapX + rim, waterMaxY, mapZ))) return true; // east
+
+	return false;
+}
+
+bool CBumpWater::SkipReflectionUpdate()
+{
+	const bool camMoved = (camera->GetPos() != reflectionCamPos) || (camera->forward != reflectionCamDir);
+
+	if (camMoved || (reflectionFramesSkipped >= reflectionFrameSkip)) {
+		reflectionCamPos = camera->GetPos();
+		reflectionCamDir = camera->forward;
+		reflectionFramesSkipped = 0;
+		return false;
+	}
+
+	reflectionFramesSkipped++;
+	return true;
+}
+
 void CBumpWater::UnsyncedHeightMapUpdate(const SRectangle& rect)
 {
+	UpdateWaterPatches(rect);
+
 	if (!shoreWaves || !readMap->HasVisibleWater())
 		return;
 
@@ -20,7 +20,7 @@ class CBumpWater : public IWater, public CEventClient
 public:
 	//! CEventClient interface
 	bool WantsEvent(const std::string& eventName) {
-		return shoreWaves && (eventName == "UnsyncedHeightMapUpdate");
+		return (eventName == "UnsyncedHeightMapUpdate");
 	}
 	bool GetFullRead() const { return true; }
 	int GetReadAllyTeam() const { return AllAccessTeam; }
@@ -68,6 +68,23 @@ private:
 
 	void UnsyncedHeightMapUpdate(const SRectangle& rect);
 
+private:
+	//! heightmap squares per side of a water-visibility patch
+	static const int WATER_PATCH_SIZE = 64;
+
+	void UpdateWaterPatches(const SRectangle& rect);
+	bool IsWaterInView() const;
+	bool SkipReflectionUpdate();
+
+	int waterPatchesX;
+	int waterPatchesY;
+	std::vector<float> waterPatchMinHeights; ///< lowest corner height per patch, water is visible where < 0
+
+	int reflectionFrameSkip; ///< max. frames the reflection is reused while the camera stands still
+	int reflectionFramesSkipped;
+	float3 reflectionCamPos;
+	float3 reflectionCamDir;
+
 private:
 	//! user options
 	char  reflection;   ///< 0:=off, 1:=don't render the terrain, 2:=render everything+terrain
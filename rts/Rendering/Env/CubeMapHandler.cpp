@@ -18,6 +18,9 @@ CONFIG(int, CubeTexSizeReflection).defaultValue(128).minimumValue(1);
 
 static char cameraMemBuf[sizeof(CCamera)];
 
+// view direction per face, in GL_TEXTURE_CUBE_MAP_{POSITIVE,NEGATIVE}_{X,Y,Z} order
+static const float3 faceDirs[6] = {RgtVector, -RgtVector, UpVector, -UpVector, FwdVector, -FwdVector};
+
 CubeMapHandler* cubeMapHandler = NULL;
 
 CubeMapHandler::CubeMapHandler() {
@@ -29,6 +32,7 @@ CubeMapHandler::CubeMapHandler() {
 	specTexSize = 0;
 
 	currReflectionFace = 0;
+	numSkyReflectionFaces = 0;
 	specularTexIter = 0;
 	mapSkyReflections = false;
 
@@ -129,48 +133,28 @@ void CubeMapHandler::UpdateReflectionTexture()
 	if (!unitDrawer->UseAdvShading())
 		return;
 
-	switch (currReflectionFace++) {
-		case 0: {
-			reflectionCubeFBO.Bind();
-			CreateReflectionFace(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z_ARB, -FwdVector, false);
-			CreateReflectionFace(GL_TEXTURE_CUBE_MAP_POSITIVE_Y_ARB,   UpVector, false);
-
-			if (mapSkyReflections) {
-				CreateReflectionFace(GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB,  RgtVector, true);
-				CreateReflectionFace(GL_TEXTURE_CUBE_MAP_NEGATIVE_X_ARB, -RgtVector, true);
-			}
-		} break;
-		case 1: {} break;
-		case 2: {} break;
-		case 3: {
-			reflectionCubeFBO.Bind();
-			CreateReflectionFace(GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB,  RgtVector, false);
-			CreateReflectionFace(GL_TEXTURE_CUBE_MAP_NEGATIVE_X_ARB, -RgtVector, false);
-
-			if (mapSkyReflections) {
-				CreateReflectionFace(GL_TEXTURE_CUBE_MAP_POSITIVE_Y_ARB,  UpVector, true);
-				CreateReflectionFace(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y_ARB, -UpVector, true);
-			}
-		} break;
-		case 4: {} break;
-		case 5: {} break;
-		case 6: {
-			reflectionCubeFBO.Bind();
-			CreateReflectionFace(GL_TEXTURE_CUBE_MAP_POSITIVE_Z_ARB, FwdVector, false);
-			CreateReflectionFace(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y_ARB, -UpVector, false);
-
-			if (mapSkyReflections) {
-				CreateReflectionFace(GL_TEXTURE_CUBE_MAP_POSITIVE_Z_ARB,  FwdVector, true);
-				CreateReflectionFace(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z_ARB, -FwdVector, true);
-			}
-		} break;
-		case 7: {} break;
-		case 8: {
-			currReflectionFace = 0;
-		} break;
-		default: {
-			currReflectionFace = 0;
-		} break;
+	// one face per call, so the cost of a (full ground) reflection pass
+	// is spread evenly instead of drawing two to four faces every third
+	// frame; the sky-only faces can only change with a dynamic sun, so
+	// otherwise each of them is drawn just once
+	for (unsigned int n = 0; n < 2; n++) {
+		const unsigned int face = currReflectionFace >> 1;
+		const bool skyOnly = ((currReflectionFace & 1) != 0);
+
+		currReflectionFace = (currReflectionFace + 1) % 12;
+
+		if (skyOnly) {
+			if (!mapSkyReflections)
+				continue;
+			if (numSkyReflectionFaces >= 6 && !sky->GetLight()->IsDynamic())
+				continue;
+
+			numSkyReflectionFaces += 1;
+		}
+
+		reflectionCubeFBO.Bind();
+		CreateReflectionFace(GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB + face, faceDirs[face], skyOnly);
+		break;
 	}
 }
 
@@ -35,6 +35,7 @@ private:
 	unsigned int specTexSize;
 
 	unsigned int currReflectionFace;
+	unsigned int numSkyReflectionFaces;
 	unsigned int specularTexIter;
 	bool mapSkyReflections;
 
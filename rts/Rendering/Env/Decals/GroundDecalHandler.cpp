@@ -208,8 +208,19 @@ static inline void AddQuadVertices(CVertexArray* va, int x, float* yv, int z, co
 	#undef HEIGHT2WORLD
 }
 
+// appends the cached (already height- and alpha-updated) quads of
+// a single decal to the per-texture batch drawn with one call
+static inline void AppendQuadVertices(CVertexArray* dst, const CVertexArray* src)
+{
+	const unsigned int numFloats = src->drawIndex();
+
+	dst->EnlargeArrays(numFloats / VA_SIZE_TC, 0, VA_SIZE_TC);
+	std::copy(src->drawArray, src->drawArray + numFloats, dst->drawArrayPos);
+	dst->drawArrayPos += numFloats;
+}
+
 
-inline void CGroundDecalHandler::DrawObjectDecal(SolidObjectGroundDecal* decal)
+inline void CGroundDecalHandler::DrawObjectDecal(SolidObjectGroundDecal* decal, CVertexArray* va)
 {
 	// TODO: do we want LOS-checks for decals?
 	if (!camera->InView(decal->pos, decal->radius))
@@ -311,15 +322,15 @@ inline void CGroundDecalHandler::DrawObjectDecal(SolidObjectGroundDecal* decal)
 			decal->va->drawArray[i + 1] = h;
 			decal->va->drawArray[i + 5] = c;
 		}
-
-		decal->va->DrawArrayTC(GL_QUADS);
 	}
 
+	AppendQuadVertices(va, decal->va);
+
 	#undef HEIGHT
 }
 
 
-inline void CGroundDecalHandler::DrawGroundScar(CGroundDecalHandler::Scar* scar, bool fade)
+inline void CGroundDecalHandler::DrawGroundScar(CGroundDecalHandler::Scar* scar, bool fade, CVertexArray* va)
 {
 	// TODO: do we want LOS-checks for decals?
 	if (!camera->InView(scar->pos, scar->radius + 16))
@@ -397,9 +408,9 @@ inline void CGroundDecalHandler::DrawGroundScar(CGroundDecalHandler::Scar* scar,
 				scar->va->drawArray[i + 5] = *reinterpret_cast<float*>(color);
 			}
 		}
-
-		scar->va->DrawArrayTC(GL_QUADS);
 	}
+
+	AppendQuadVertices(va, scar->va);
 }
 
 
@@ -495,10 +506,15 @@ void CGroundDecalHandler::DrawObjectDecals() {
 			GatherDecalsForType(decalType);
 		}
 
+		CVertexArray* va = GetVertexArray();
+		va->Initialize();
+
 		for (unsigned int k = 0; k < decalsToDraw.size(); k++) {
-			DrawObjectDecal(decalsToDraw[k]);
+			DrawObjectDecal(decalsToDraw[k], va);
 		}
 
+		va->DrawArrayTC(GL_QUADS);
+
 		// glBindTexture(GL_TEXTURE_2D, 0);
 	}
 }
@@ -689,7 +705,11 @@ void CGroundDecalHandler::AddScars() {
 }
 
 void CGroundDecalHandler::DrawScars() {
-	// create and draw the 16x16 quads for each ground scar
+	// all scars share one texture (atlas), so their 16x16
+	// quads are gathered and submitted in a single batch
+	CVertexArray* va = GetVertexArray();
+	va->Initialize();
+
 	for (std::list<Scar*>::iterator si = scars.begin(); si != scars.end(); ) {
 		Scar* scar = *si;
 
@@ -699,9 +719,11 @@ void CGroundDecalHandler::DrawScars() {
 			continue;
 		}
 
-		DrawGroundScar(scar, groundScarAlphaFade);
+		DrawGroundScar(scar, groundScarAlphaFade, va);
 		++si;
 	}
+
+	va->DrawArrayTC(GL_QUADS);
 }
 
 
@@ -270,8 +270,8 @@ private:
 	int scarFieldX;
 	int scarFieldY;
 
-	void DrawObjectDecal(SolidObjectGroundDecal* decal);
-	void DrawGroundScar(Scar* scar, bool fade);
+	void DrawObjectDecal(SolidObjectGroundDecal* decal, CVertexArray* va);
+	void DrawGroundScar(Scar* scar, bool fade, CVertexArray* va);
 
 	int OverlapSize(Scar* s1, Scar* s2);
 	void TestOverlaps(Scar* scar);
@@ -25,6 +25,7 @@
 #include "System/bitops.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
+#include "System/TimeProfiler.h"
 
 #define LOG_SECTION_DYN_WATER "DynWater"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_DYN_WATER)
@@ -408,8 +409,14 @@ void CDynWater::UpdateWater(CGame* game)
 	glDepthMask(1);
 
 	glPushAttrib(GL_FOG_BIT);
-	DrawRefraction(game);
-	DrawReflection(game);
+	{
+		SCOPED_TIMER("DynWater::UpdateWater (Refraction)");
+		DrawRefraction(game);
+	}
+	{
+		SCOPED_TIMER("DynWater::UpdateWater (Reflection)");
+		DrawReflection(game);
+	}
 	FBO::Unbind();
 	glPopAttrib();
 }
@@ -13,6 +13,7 @@
 #include "Rendering/Env/ISky.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/FBO.h"
+#include "Rendering/GL/VBO.h"
 #include "Rendering/GL/VertexArray.h"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
@@ -85,11 +86,6 @@ CGrassDrawer::CGrassDrawer()
 
 	for (int y = 0; y < 32; y++) {
 		for (int x = 0; x < 32; x++) {
-			grass[y * 32 + x].va = 0;
-			grass[y * 32 + x].lastSeen = 0;
-			grass[y * 32 + x].pos = ZeroVector;
-			grass[y * 32 + x].square = 0;
-
 			nearGrass[y * 32 + x].square = -1;
 		}
 	}
@@ -127,11 +123,8 @@ CGrassDrawer::~CGrassDrawer()
 	if (grassOff)
 		return;
 
-	for (int y = 0; y < 32; y++) {
-		for (int x = 0; x < 32; x++) {
-			if (grass[y * 32 + x].va)
-				delete grass[y * 32 + x].va;
-		}
+	for (int n = 0; n < 32 * 32; n++) {
+		FreeGrassBlock(&grass[n]);
 	}
 
 	delete[] grassMap;
@@ -246,12 +239,17 @@ void CGrassBlockDrawer::DrawQuad(int x, int y)
 	CGrassDrawer::NearGrassStruct* nearGrass = gd->nearGrass;
 
 	if (abs(x - cx) <= gd->detailedBlocks && abs(y - cy) <= gd->detailedBlocks) {
+		const CGrassDrawer::GrassStruct* gb = gd->GetGrassBlock(x, y);
+
+		if (!camera->InView(gb->mins, gb->maxs))
+			return;
+
 		//! blocks close to the camera
 		for (int y2 = y * grassBlockSize; y2 < (y + 1) * grassBlockSize; ++y2) {
 			for (int x2 = x * grassBlockSize; x2 < (x + 1) * grassBlockSize; ++x2) {
 				if (gd->grassMap[y2 * gs->mapx / grassSquareSize + x2]) {
-					float3 squarePos((x2 + 0.5f) * gSSsq, 0.0f, (y2 + 0.5f) * gSSsq);
-						squarePos.y = ground->GetHeightReal(squarePos.x, squarePos.z, false);
+					const int sqIdx = (y2 - y * grassBlockSize) * grassBlockSize + (x2 - x * grassBlockSize);
+					const float3 squarePos((x2 + 0.5f) * gSSsq, gb->squareHeights[sqIdx], (y2 + 0.5f) * gSSsq);
 
 					const float sqdist = (camera->GetPos() - squarePos).SqLength();
 
@@ -259,23 +257,15 @@ void CGrassBlockDrawer::DrawQuad(int x, int y)
 
 					if (sqdist < (maxDetailedDist * maxDetailedDist)) {
 						//! close grass, draw directly
-						rng.Seed(y2 * 1025 + x2);
+						if (ng->square != y2 * 2048 + x2) {
+							const float3 v = squarePos - camera->GetPos();
+							ng->rotation = GetHeadingFromVector(v.x, v.z) * 180.0f / 32768 + 180; //FIXME make more random
+							ng->square = y2 * 2048 + x2;
+						}
 
 						for (int a = 0; a < gd->numTurfs; a++) {
-							const float dx = (x2 + rng.RandFloat()) * gSSsq;
-							const float dy = (y2 + rng.RandFloat()) * gSSsq;
-
-							float3 pos(dx, ground->GetHeightReal(dx, dy, false), dy);
-								pos.y -= ground->GetSlope(dx, dy, false) * 10.0f + 0.03f;
-
-							if (ng->square != y2 * 2048 + x2) {
-								const float3 v = squarePos - camera->GetPos();
-								ng->rotation = GetHeadingFromVector(v.x, v.z) * 180.0f / 32768 + 180; //FIXME make more random
-								ng->square = y2 * 2048 + x2;
-							}
-
 							glPushMatrix();
-							glTranslatef3(pos);
+							glTranslatef3(gb->turfs[sqIdx * gd->numTurfs + a]);
 							glRotatef(ng->rotation, 0.0f, 1.0f, 0.0f);
 							glCallList(gd->grassDL);
 							glPopMatrix();
@@ -300,56 +290,118 @@ void CGrassBlockDrawer::DrawQuad(int x, int y)
 	const float dist = dif.SqLength2D();
 
 	if (dist < Square(gd->maxGrassDist)) {
-		const int curSquare = y * gd->blocksX + x;
-		const int curModSquare = (y & 31) * 32 + (x & 31);
+		const CGrassDrawer::GrassStruct* gb = gd->GetGrassBlock(x, y);
 
-		CGrassDrawer::GrassStruct* grass = gd->grass + curModSquare;
-		grass->lastSeen = gs->frameNum;
+		if (!camera->InView(gb->mins, gb->maxs))
+			return;
 
-		if (grass->square != curSquare) {
-			grass->square = curSquare;
+		CGrassDrawer::InviewGrass ig;
+			ig.num = (y & 31) * 32 + (x & 31);
+			ig.dist = dif.Length2D();
+		inviewGrass.push_back(ig);
+	}
+}
 
-			delete grass->va;
-			grass->va = NULL;
-		}
 
-		if (!grass->va) {
-			grass->va = new CVertexArray;
-			grass->pos = float3((x + 0.5f) * bMSsq, ground->GetHeightReal((x + 0.5f) * bMSsq, (y + 0.5f) * bMSsq, false), (y + 0.5f) * bMSsq);
+CGrassDrawer::GrassStruct* CGrassDrawer::GetGrassBlock(int x, int y)
+{
+	const int curSquare = y * blocksX + x;
 
-			CVertexArray* va = grass->va;
-			va->Initialize();
+	GrassStruct* gb = &grass[(y & 31) * 32 + (x & 31)];
+	gb->lastSeen = gs->frameNum;
 
-			for (int y2 = y * grassBlockSize; y2 < (y + 1) * grassBlockSize; ++y2) {
-				for (int x2 = x * grassBlockSize; x2 < (x + 1) * grassBlockSize; ++x2) {
-					if (gd->grassMap[y2 * gs->mapx / grassSquareSize + x2]) {
-						rng.Seed(y2 * 1025 + x2);
+	if (gb->square != curSquare) {
+		gb->square = curSquare;
+		FreeGrassBlock(gb);
+	}
 
-						for (int a = 0; a < gd->numTurfs; a++) {
-							const float dx = (x2 + rng.RandFloat()) * gSSsq;
-							const float dy = (y2 + rng.RandFloat()) * gSSsq;
-							const float col = 1.0f;
+	if (!gb->turfs.empty())
+		return gb;
 
-							float3 pos(dx, ground->GetHeightReal(dx, dy, false) + 0.5f, dy);
-								pos.y -= (ground->GetSlope(dx, dy, false) * 10.0f + 0.03f);
+	// the ground lookups are only done once per block instead of
+	// every frame; all LODs read their turf positions from here
+	gb->turfs.resize(grassBlockSize * grassBlockSize * numTurfs);
+	gb->squareHeights.resize(grassBlockSize * grassBlockSize);
 
-							va->AddVertexTN(pos, 0.0f,         0.0f, float3(-partTurfSize, -partTurfSize, col));
-							va->AddVertexTN(pos, 1.0f / 16.0f, 0.0f, float3( partTurfSize, -partTurfSize, col));
-							va->AddVertexTN(pos, 1.0f / 16.0f, 1.0f, float3( partTurfSize,  partTurfSize, col));
-							va->AddVertexTN(pos, 0.0f,         1.0f, float3(-partTurfSize,  partTurfSize, col));
-						}
-					}
-				}
+	gb->mins = float3(x * bMSsq - partTurfSize, 1e9f, y * bMSsq - partTurfSize);
+	gb->maxs = float3((x + 1) * bMSsq + partTurfSize, -1e9f, (y + 1) * bMSsq + partTurfSize);
+
+	for (int y2 = y * grassBlockSize; y2 < (y + 1) * grassBlockSize; ++y2) {
+		for (int x2 = x * grassBlockSize; x2 < (x + 1) * grassBlockSize; ++x2) {
+			const int sqIdx = (y2 - y * grassBlockSize) * grassBlockSize + (x2 - x * grassBlockSize);
+
+			gb->squareHeights[sqIdx] = ground->GetHeightReal((x2 + 0.5f) * gSSsq, (y2 + 0.5f) * gSSsq, false);
+
+			rng.Seed(y2 * 1025 + x2);
+
+			for (int a = 0; a < numTurfs; a++) {
+				const float dx = (x2 + rng.RandFloat()) * gSSsq;
+				const float dy = (y2 + rng.RandFloat()) * gSSsq;
+
+				float3& pos = gb->turfs[sqIdx * numTurfs + a];
+					pos = float3(dx, ground->GetHeightReal(dx, dy, false), dy);
+					pos.y -= (ground->GetSlope(dx, dy, false) * 10.0f + 0.03f);
+
+				gb->mins.y = std::min(gb->mins.y, pos.y);
+				gb->maxs.y = std::max(gb->maxs.y, pos.y);
 			}
 		}
+	}
 
-		CGrassDrawer::InviewGrass ig;
-			ig.num = curModSquare;
-			ig.dist = dif.Length2D();
-		inviewGrass.push_back(ig);
+	gb->maxs.y += std::max(mapInfo->grass.bladeHeight * 2.0f, partTurfSize) + 0.5f;
+	return gb;
+}
+
+
+void CGrassDrawer::CreateFarBillboards(GrassStruct* gb)
+{
+	const int x = gb->square % blocksX;
+	const int y = gb->square / blocksX;
+	const float col = 1.0f;
+
+	CVertexArray* va = GetVertexArray();
+	va->Initialize();
+	va->EnlargeArrays(gb->turfs.size() * 4, 0, VA_SIZE_TN);
+
+	for (int y2 = y * grassBlockSize; y2 < (y + 1) * grassBlockSize; ++y2) {
+		for (int x2 = x * grassBlockSize; x2 < (x + 1) * grassBlockSize; ++x2) {
+			if (!grassMap[y2 * gs->mapx / grassSquareSize + x2])
+				continue;
+
+			const int sqIdx = (y2 - y * grassBlockSize) * grassBlockSize + (x2 - x * grassBlockSize);
+
+			for (int a = 0; a < numTurfs; a++) {
+				const float3 pos = gb->turfs[sqIdx * numTurfs + a] + float3(0.0f, 0.5f, 0.0f);
+
+				va->AddVertexQTN(pos,         0.0f, 0.0f, float3(-partTurfSize, -partTurfSize, col));
+				va->AddVertexQTN(pos, 1.0f / 16.0f, 0.0f, float3( partTurfSize, -partTurfSize, col));
+				va->AddVertexQTN(pos, 1.0f / 16.0f, 1.0f, float3( partTurfSize,  partTurfSize, col));
+				va->AddVertexQTN(pos,         0.0f, 1.0f, float3(-partTurfSize,  partTurfSize, col));
+			}
+		}
 	}
+
+	if (gb->vbo == NULL)
+		gb->vbo = new VBO();
+
+	gb->numVerts = va->drawIndex() / VA_SIZE_TN;
+	gb->vbo->Bind(GL_ARRAY_BUFFER);
+	gb->vbo->Resize(va->drawIndex() * sizeof(float), GL_STATIC_DRAW, va->drawArray);
+	gb->vbo->Unbind();
+}
+
+
+void CGrassDrawer::FreeGrassBlock(GrassStruct* gb)
+{
+	delete gb->vbo;
+	gb->vbo = NULL;
+	gb->numVerts = 0;
+
+	std::vector<float3>().swap(gb->turfs);
+	std::vector<float>().swap(gb->squareHeights);
 }
 
+
 void CGrassDrawer::SetupGlStateNear()
 {
 	CBaseGroundDrawer* gd = readMap->GetGroundDrawer();
@@ -621,15 +673,38 @@ void CGrassDrawer::ResetGlStateFar()
 
 void CGrassDrawer::DrawFarBillboards(const std::vector<CGrassDrawer::InviewGrass>& inviewGrass)
 {
+	const unsigned int stride = sizeof(float) * VA_SIZE_TN;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+
 	for (std::vector<CGrassDrawer::InviewGrass>::const_iterator gi = inviewGrass.begin(); gi != inviewGrass.end(); ++gi) {
+		GrassStruct* gb = &grass[(*gi).num];
+
+		if (gb->vbo == NULL)
+			CreateFarBillboards(gb);
+		if (gb->numVerts == 0)
+			continue;
+
 		if ((*gi).dist + 128 < maxGrassDist) {
 			glColor4f(0.62f, 0.62f, 0.62f, 1.0f);
 		} else {
 			glColor4f(0.62f, 0.62f, 0.62f, 1.0f - ((*gi).dist + 128 - maxGrassDist) / 128.0f);
 		}
 
-		grass[(*gi).num].va->DrawArrayTN(GL_QUADS);
+		// static per-block buffer, nothing is re-sent to the GPU here
+		gb->vbo->Bind(GL_ARRAY_BUFFER);
+		glVertexPointer(3, GL_FLOAT, stride, gb->vbo->GetPtr(0));
+		glTexCoordPointer(2, GL_FLOAT, stride, gb->vbo->GetPtr(sizeof(float) * 3));
+		glNormalPointer(GL_FLOAT, stride, gb->vbo->GetPtr(sizeof(float) * 5));
+		glDrawArrays(GL_QUADS, 0, gb->numVerts);
+		gb->vbo->Unbind();
 	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
 }
 
 
@@ -643,16 +718,16 @@ void CGrassDrawer::DrawNearBillboards(const std::vector<InviewNearGrass>& inview
 		const int x = (*gi).x;
 		const int y = (*gi).y;
 
-		rng.Seed(y * 1025 + x);
+		// the block was fetched by CGrassBlockDrawer this frame
+		const int bx = x / grassBlockSize;
+		const int by = y / grassBlockSize;
+		const int sqIdx = (y - by * grassBlockSize) * grassBlockSize + (x - bx * grassBlockSize);
+		const GrassStruct& gb = grass[(by & 31) * 32 + (bx & 31)];
 
 		for (int a = 0; a < numTurfs; a++) {
-			const float dx = (x + rng.RandFloat()) * gSSsq;
-			const float dy = (y + rng.RandFloat()) * gSSsq;
+			const float3 pos = gb.turfs[sqIdx * numTurfs + a] + float3(0.0f, 0.5f, 0.0f);
 			const float col = 1.0f;
 
-			float3 pos(dx, ground->GetHeightReal(dx, dy, false) + 0.5f, dy);
-				pos.y -= (ground->GetSlope(dx, dy, false) * 10.0f + 0.03f);
-
 			va->AddVertexQTN(pos,         0.0f, 0.0f, float3(-partTurfSize, -partTurfSize, col));
 			va->AddVertexQTN(pos, 1.0f / 16.0f, 0.0f, float3( partTurfSize, -partTurfSize, col));
 			va->AddVertexQTN(pos, 1.0f / 16.0f, 1.0f, float3( partTurfSize,  partTurfSize, col));
@@ -760,22 +835,19 @@ void CGrassDrawer::GarbageCollect()
 
 	if (startClean > endClean) {
 		for (GrassStruct* pGS = grass + startClean; pGS < grass + 32 * 32; ++pGS) {
-			if ((pGS->lastSeen < gs->frameNum - 50) && pGS->va) {
-				delete pGS->va;
-				pGS->va = 0;
+			if ((pGS->lastSeen < gs->frameNum - 50) && !pGS->turfs.empty()) {
+				FreeGrassBlock(pGS);
 			}
 		}
 		for (GrassStruct* pGS = grass; pGS < grass + endClean; ++pGS) {
-			if ((pGS->lastSeen < gs->frameNum - 50) && pGS->va) {
-				delete pGS->va;
-				pGS->va = 0;
+			if ((pGS->lastSeen < gs->frameNum - 50) && !pGS->turfs.empty()) {
+				FreeGrassBlock(pGS);
 			}
 		}
 	} else {
 		for (GrassStruct* pGS = grass + startClean; pGS < grass + endClean; ++pGS) {
-			if ((pGS->lastSeen < gs->frameNum - 50) && pGS->va) {
-				delete pGS->va;
-				pGS->va = 0;
+			if ((pGS->lastSeen < gs->frameNum - 50) && !pGS->turfs.empty()) {
+				FreeGrassBlock(pGS);
 			}
 		}
 	}
@@ -795,11 +867,7 @@ void CGrassDrawer::ResetPos(const float3& pos)
 		(int(pos.z / bMSsq) & 31) * 32 +
 		(int(pos.x / bMSsq) & 31);
 
-	if (grass[idx].va) {
-		delete grass[idx].va;
-		grass[idx].va = 0;
-	}
-
+	FreeGrassBlock(&grass[idx]);
 	grass[idx].square = -1;
 }
 
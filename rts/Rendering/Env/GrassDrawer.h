@@ -10,7 +10,7 @@ namespace Shader {
 	struct IProgramObject;
 }
 
-class CVertexArray;
+class VBO;
 class CGrassDrawer
 {
 public:
@@ -33,10 +33,21 @@ public:
 		float dist;
 	};
 	struct GrassStruct {
-		CVertexArray* va;
+		GrassStruct(): vbo(NULL), numVerts(0), lastSeen(0), square(-1) {}
+
+		VBO* vbo;      //< far-billboard quads, uploaded once per block
+		int numVerts;
 		int lastSeen;
 		int square;
-		float3 pos;
+
+		//! turf positions of all grass squares in this block,
+		//! (grassBlockSize * grassBlockSize) * numTurfs entries
+		std::vector<float3> turfs;
+		std::vector<float> squareHeights;
+
+		//! bounds (including blade height) for frustum culling
+		float3 mins;
+		float3 maxs;
 	};
 	struct NearGrassStruct {
 		float rotation;
@@ -64,6 +75,10 @@ protected:
 	void DrawNearBillboards(const std::vector<InviewNearGrass>& inviewNearGrass);
 	void GarbageCollect();
 
+	GrassStruct* GetGrassBlock(int x, int y);
+	void CreateFarBillboards(GrassStruct* gb);
+	void FreeGrassBlock(GrassStruct* gb);
+
 	GrassStruct grass[32 * 32];
 	NearGrassStruct nearGrass[32 * 32];
 
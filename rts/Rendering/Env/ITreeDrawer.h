@@ -64,6 +64,8 @@ public:
 			, farDispList(0)
 			, lastSeen(0)
 			, lastSeenFar(0)
+			, minHeight(0.0f)
+			, maxHeight(0.0f)
 		{}
 
 		unsigned int dispList;
@@ -72,6 +74,11 @@ public:
 		int lastSeen;
 		int lastSeenFar;
 
+		// ground-height range of the trees in this square, only
+		// valid while <trees> is non-empty (used for culling)
+		float minHeight;
+		float maxHeight;
+
 		float3 viewVector;
 		std::map<int, TreeStruct> trees;
 	};
@@ -15,6 +15,7 @@
 #include "Rendering/Models/WorldObjectModelRenderer.h"
 #include "Sim/Objects/SolidObject.h"
 #include "System/myMath.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/bitops.h"
 
@@ -31,24 +32,33 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_FAR_TEXTURE_HANDLER)
 #define LOG_SECTION_CURRENT LOG_SECTION_FAR_TEXTURE_HANDLER
 
 
+CONFIG(int, FarTextureCreationsPerFrame).defaultValue(4).minimumValue(1)
+	.description("Maximum number of new far-textures (impostors) rendered per frame; units waiting for theirs are not drawn at far distance in the meantime.");
+
 CFarTextureHandler* farTextureHandler = NULL;
 
 const int CFarTextureHandler::iconSizeX = 32;
 const int CFarTextureHandler::iconSizeY = 32;
 const int CFarTextureHandler::numOrientations = 8;
+const int CFarTextureHandler::maxPages = 16;
 
 CFarTextureHandler::CFarTextureHandler()
 {
-	farTextureID = 0;
 	usedFarTextures = 0;
 
+	numCreations = 0;
+	maxCreationsPerFrame = configHandler->GetInt("FarTextureCreationsPerFrame");
+	creationFrame = 0;
+
 	// ATI supports 16K textures, which might be a bit too much
 	// for this purpose,so we limit it to 4K
 	const int maxTexSize = std::min(globalRendering->maxTextureSize, 4096);
 
+	// pages are not resized, so pick a height that
+	// fits a reasonable number (128) of models each
 	texSizeX = maxTexSize;
-	texSizeY = std::max(iconSizeY, 4 * numOrientations * iconSizeX * iconSizeY / texSizeX); // minimum space for 4 icons
-	texSizeY = next_power_of_2(texSizeY);
+	texSizeY = std::max(iconSizeY, 128 * numOrientations * iconSizeX * iconSizeY / texSizeX);
+	texSizeY = std::min(int(next_power_of_2(texSizeY)), maxTexSize);
 
 	if (SpringVersion::IsHeadless())
 		return;
@@ -58,21 +68,10 @@ CFarTextureHandler::CFarTextureHandler()
 		return;
 	}
 
-	glGenTextures(1, &farTextureID);
-	glBindTexture(GL_TEXTURE_2D, farTextureID);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texSizeX, texSizeY, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
-
+	// every page has the same size, so one depth buffer serves them all
 	fbo.Bind();
-	fbo.AttachTexture(farTextureID);
-	const bool status = fbo.CheckStatus("FARTEXTURE");
-	if (status) {
-		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
-	}
+	fbo.CreateRenderBuffer(GL_DEPTH_ATTACHMENT_EXT, GL_DEPTH_COMPONENT16, texSizeX, texSizeY);
+	CheckAddPage();
 	fbo.Unbind();
 
 	fbo.reloadOnAltTab = true;
@@ -81,17 +80,19 @@ CFarTextureHandler::CFarTextureHandler()
 
 CFarTextureHandler::~CFarTextureHandler()
 {
-	glDeleteTextures(1, &farTextureID);
+	for (size_t n = 0; n < farTexturePages.size(); n++) {
+		glDeleteTextures(1, &farTexturePages[n]);
+	}
 	queuedForRender.clear();
 }
 
 
 /**
- * @brief Returns the (row, column) pair of a FarTexture in the TextureAtlas.
+ * @brief Returns the (row, column) pair of a FarTexture in its atlas page.
  */
 int2 CFarTextureHandler::GetTextureCoordsInt(const int farTextureNum, const int orientation) const
 {
-	const int texnum = (farTextureNum * numOrientations) + orientation;
+	const int texnum = ((farTextureNum % IconsPerPage()) * numOrientations) + orientation;
 
 	const int row = texnum / (texSizeX / iconSizeX);
 	const int col = texnum - row * (texSizeX / iconSizeX);
@@ -100,19 +101,15 @@ int2 CFarTextureHandler::GetTextureCoordsInt(const int farTextureNum, const int
 
 
 /**
- * @brief Returns the TexCoords of a FarTexture in the TextureAtlas.
+ * @brief Returns the TexCoords of a FarTexture in its atlas page.
  */
 float2 CFarTextureHandler::GetTextureCoords(const int farTextureNum, const int orientation) const
 {
-	float2 texcoords;
+	const int2 pos = GetTextureCoordsInt(farTextureNum, orientation);
 
-	const int texnum = (farTextureNum * numOrientations) + orientation;
-
-	const int row = texnum / (texSizeX / iconSizeX);
-	const int col = texnum - row * (texSizeX / iconSizeX);
-
-	texcoords.x = (float(iconSizeX) / texSizeX) * col;
-	texcoords.y = (float(iconSizeY) / texSizeY) * row;
+	float2 texcoords;
+	texcoords.x = (float(iconSizeX) / texSizeX) * pos.x;
+	texcoords.y = (float(iconSizeY) / texSizeY) * pos.y;
 
 	return texcoords;
 }
@@ -129,35 +126,19 @@ bool CFarTextureHandler::HaveFarIcon(const CSolidObject* obj) const
 
 
 /**
- * @brief Really create the far texture for the given model.
+ * @brief Renders the far textures of all objects in queuedForCreation.
+ *
+ * The FBO and unit-drawing state are set up once for the whole batch.
  */
-void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
+void CFarTextureHandler::CreateFarTextures()
 {
-	const S3DModel* model = obj->model;
-
-	// make space in the std::vectors
-	if (obj->team >= (int)cache.size()) {
-		cache.resize(obj->team + 1);
-	}
-	if (model->id >= (int)cache[obj->team].size()) {
-		cache[obj->team].resize(model->id + 1, 0);
-	}
-
-	cache[obj->team][model->id] = -1;
-
-	// enough free space in the atlas?
-	if (!CheckResizeAtlas()) {
-		return;
-	}
-
 	// NOTE:
 	//    the icons are RTT'ed using a snapshot of the
 	//    current state (advModelShading, sunDir, etc)
 	//    and will not track later state-changes
 
 	fbo.Bind();
-	fbo.CreateRenderBuffer(GL_DEPTH_ATTACHMENT_EXT, GL_DEPTH_COMPONENT16, texSizeX, texSizeY);
-	fbo.CheckStatus("FARTEXTURE");
+	fbo.AttachTexture(farTexturePages.back());
 
 	glPushAttrib(GL_ALL_ATTRIB_BITS);
 	glDisable(GL_BLEND);
@@ -170,6 +151,50 @@ void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
 	glFogf(GL_FOG_DENSITY, 1.0f);
 
 	unitDrawer->SetupForUnitDrawing(false);
+
+	for (size_t n = 0; n < queuedForCreation.size(); n++) {
+		// the same (team, model) pair can be queued more than once
+		if (HaveFarIcon(queuedForCreation[n]))
+			continue;
+
+		CreateFarTexture(queuedForCreation[n]);
+	}
+
+	unitDrawer->CleanUpUnitDrawing(false);
+
+	// glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
+	glPopAttrib();
+
+	fbo.Unbind();
+
+	queuedForCreation.clear();
+}
+
+
+/**
+ * @brief Really create the far texture for the given model.
+ *
+ * Expects the state set up by CreateFarTextures.
+ */
+void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
+{
+	const S3DModel* model = obj->model;
+
+	// make space in the std::vectors
+	if (obj->team >= (int)cache.size()) {
+		cache.resize(obj->team + 1);
+	}
+	if (model->id >= (int)cache[obj->team].size()) {
+		cache[obj->team].resize(model->id + 1, 0);
+	}
+
+	cache[obj->team][model->id] = -1;
+
+	// enough free space in the atlas?
+	if (!CheckAddPage()) {
+		return;
+	}
+
 	unitDrawer->GetOpaqueModelRenderer(model->type)->PushRenderState();
 	unitDrawer->SetTeamColour(obj->team);
 
@@ -222,15 +247,9 @@ void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
 	glPopMatrix();
 
 	unitDrawer->GetOpaqueModelRenderer(model->type)->PopRenderState();
-	unitDrawer->CleanUpUnitDrawing(false);
-
-	// glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
-	glPopAttrib();
-
-	fbo.Detach(GL_DEPTH_ATTACHMENT_EXT);
-	fbo.Unbind();
 
 	cache[obj->team][model->id] = ++usedFarTextures;
+	numCreations += 1;
 }
 
 
@@ -238,10 +257,6 @@ void CFarTextureHandler::DrawFarTexture(const CSolidObject* obj, CVertexArray* v
 {
 	const int farTextureNum = cache[obj->team][obj->model->id];
 
-	// not found in the atlas
-	if (farTextureNum <= 0)
-		return;
-
 	const float3 interPos = obj->drawPos + UpVector * obj->model->height * 0.5f;
 
 	// indicates the orientation to draw
@@ -280,17 +295,34 @@ void CFarTextureHandler::Draw()
 		return;
 	}
 
-	if (!fbo.IsValid()) {
+	if (!fbo.IsValid() || farTexturePages.empty()) {
 		queuedForRender.clear();
 		return;
 	}
 
-	// create new far-icons
+	// Draw() runs for units and features, both share the per-frame budget
+	if (creationFrame != globalRendering->drawFrame) {
+		creationFrame = globalRendering->drawFrame;
+		numCreations = 0;
+	}
+
+	// create new far-icons, but spread them over frames
 	for (GML_VECTOR<const CSolidObject*>::iterator it = queuedForRender.begin(); it != queuedForRender.end(); ++it) {
 		const CSolidObject* obj = *it;
-		if (!HaveFarIcon(obj)) {
-			CreateFarTexture(obj);
-		}
+
+		if (HaveFarIcon(obj))
+			continue;
+		// do not bake the placeholder into the icon
+		if (obj->model->type != MODELTYPE_3DO && texturehandlerS3O->IsS3oTexPending(obj->model->textureType))
+			continue;
+		if ((numCreations + queuedForCreation.size()) >= maxCreationsPerFrame)
+			break;
+
+		queuedForCreation.push_back(obj);
+	}
+
+	if (!queuedForCreation.empty()) {
+		CreateFarTextures();
 	}
 
 	// render current queued far icons on the screen
@@ -299,20 +331,40 @@ void CFarTextureHandler::Draw()
 		glAlphaFunc(GL_GREATER, 0.5f);
 		glActiveTexture(GL_TEXTURE0);
 		glEnable(GL_TEXTURE_2D);
-		glBindTexture(GL_TEXTURE_2D, farTextureID);
 		glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 		glNormal3fv((const GLfloat*) &unitDrawer->camNorm.x);
 
 		ISky::SetupFog();
 
-		CVertexArray* va = GetVertexArray();
-		va->Initialize();
-		va->EnlargeArrays(queuedForRender.size() * 4, 0, VA_SIZE_T);
-		for (GML_VECTOR<const CSolidObject*>::iterator it = queuedForRender.begin(); it != queuedForRender.end(); ++it) {
-			DrawFarTexture(*it, va);
+		const int iconsPerPage = IconsPerPage();
+
+		// one batch per page, objects without (finished) icon are skipped
+		for (int page = 0; page < farTexturePages.size(); page++) {
+			CVertexArray* va = GetVertexArray();
+			va->Initialize();
+			va->EnlargeArrays(queuedForRender.size() * 4, 0, VA_SIZE_T);
+
+			for (GML_VECTOR<const CSolidObject*>::iterator it = queuedForRender.begin(); it != queuedForRender.end(); ++it) {
+				if (!HaveFarIcon(*it))
+					continue;
+
+				const int farTextureNum = cache[(*it)->team][(*it)->model->id];
+
+				if (farTextureNum <= 0)
+					continue;
+				if (((farTextureNum - 1) / iconsPerPage) != page)
+					continue;
+
+				DrawFarTexture(*it, va);
+			}
+
+			if (va->drawIndex() == 0)
+				continue;
+
+			glBindTexture(GL_TEXTURE_2D, farTexturePages[page]);
+			va->DrawArrayT(GL_QUADS);
 		}
 
-		va->DrawArrayT(GL_QUADS);
 		glDisable(GL_ALPHA_TEST);
 	}
 
@@ -321,52 +373,38 @@ void CFarTextureHandler::Draw()
 
 
 
-bool CFarTextureHandler::CheckResizeAtlas()
+bool CFarTextureHandler::CheckAddPage()
 {
-	const unsigned int maxSprites = ((texSizeX / iconSizeX) * (texSizeY / iconSizeY) / numOrientations) - 1;
-
-	if (usedFarTextures + 1 <= maxSprites)
+	if (usedFarTextures < (farTexturePages.size() * IconsPerPage()))
 		return true;
 
-	const int oldTexSizeY = texSizeY;
-
-	if (globalRendering->supportNPOTs) {
-		texSizeY += std::max(iconSizeY,  4 * numOrientations * iconSizeX * iconSizeY / texSizeX); // make space for minimum 4 additional icons
-	} else {
-		texSizeY <<= 1;
-	}
-
-	if (texSizeY > globalRendering->maxTextureSize) {
-		LOG_L(L_DEBUG, "Out of farTextures"); 
-		texSizeY = oldTexSizeY;
+	if (farTexturePages.size() >= maxPages) {
+		LOG_L(L_DEBUG, "Out of farTextures");
 		return false;
 	}
 
-	unsigned char* oldPixels = new unsigned char[texSizeX*texSizeY*4];
+	// filled pages stay as they are, so unlike resizing
+	// the atlas no pixels need to be read back or copied
+	GLuint farTextureID;
+	glGenTextures(1, &farTextureID);
 	glBindTexture(GL_TEXTURE_2D, farTextureID);
-	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, oldPixels); //TODO use the FBO?
-	memset(oldPixels + texSizeX*oldTexSizeY*4, 0, texSizeX*(texSizeY - oldTexSizeY)*4);
-
-	GLuint newFarTextureID;
-	glGenTextures(1, &newFarTextureID);
-	glBindTexture(GL_TEXTURE_2D, newFarTextureID);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texSizeX, texSizeY, 0, GL_RGBA, GL_UNSIGNED_BYTE, oldPixels);
-	delete[] oldPixels;
-
-	fbo.Bind();
-	fbo.DetachAll();
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texSizeX, texSizeY, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
 
-	glDeleteTextures(1, &farTextureID);
-	farTextureID = newFarTextureID;
+	farTexturePages.push_back(farTextureID);
 
+	// the FBO is bound by our callers
 	fbo.AttachTexture(farTextureID);
-	fbo.CheckStatus("FARTEXTURE");
-	fbo.Unbind();
+
+	if (fbo.CheckStatus("FARTEXTURE")) {
+		glPushAttrib(GL_COLOR_BUFFER_BIT);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glPopAttrib();
+	}
 
 	return true;
 }
-
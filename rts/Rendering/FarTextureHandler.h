@@ -24,25 +24,37 @@ public:
 	void Draw();
 
 private:
+	/// size of one atlas page
 	int texSizeX;
 	int texSizeY;
 
 	static const int iconSizeX;
 	static const int iconSizeY;
 	static const int numOrientations;
+	static const int maxPages;
 
 	GML_VECTOR<const CSolidObject*> queuedForRender;
+	std::vector<const CSolidObject*> queuedForCreation;
 	std::vector< std::vector<int> > cache;
 
 	FBO fbo;
-	unsigned int farTextureID;
+	/// the atlas grows by whole pages, filled pages are never touched again
+	std::vector<unsigned int> farTexturePages;
 	unsigned int usedFarTextures;
 
+	/// icons created so far during <creationFrame>
+	unsigned int numCreations;
+	unsigned int maxCreationsPerFrame;
+	unsigned int creationFrame;
+
+	unsigned int IconsPerPage() const { return ((texSizeX / iconSizeX) * (texSizeY / iconSizeY) / numOrientations); }
+
 	bool HaveFarIcon(const CSolidObject* obj) const;
-	bool CheckResizeAtlas();
+	bool CheckAddPage();
 	float2 GetTextureCoords(const int farTextureNum, const int orientation) const;
 	void DrawFarTexture(const CSolidObject* obj, CVertexArray*);
 	int2 GetTextureCoordsInt(const int farTextureNum, const int orientation) const;
+	void CreateFarTextures();
 	void CreateFarTexture(const CSolidObject* obj);
 };
 
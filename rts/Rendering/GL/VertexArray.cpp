@@ -3,6 +3,19 @@
 #include <cstring>
 
 #include "VertexArray.h"
+#include "VBO.h"
+#include "System/Config/ConfigHandler.h"
+
+CONFIG(bool, StreamVertexArrays).defaultValue(true).safemodeValue(false).description("Draw vertex arrays from a shared streaming VBO instead of client memory.");
+
+// small arrays (most GUI quads) are cheaper to draw from client memory
+static const unsigned int STREAM_MIN_SIZE    = 4 * 1024;
+static const unsigned int STREAM_BUFFER_SIZE = 8 * 1024 * 1024;
+
+//! ring buffer shared by all vertex arrays, orphaned whenever it wraps around
+static VBO* streamBuffer = NULL;
+static unsigned int streamOffset = 0;
+static int streamState = -1; //< -1: uninitialized, 0: disabled, 1: enabled
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -186,6 +199,62 @@ void CVertexArray::DrawArraysCallback(const GLenum mode, const unsigned int stri
 
 
 
+const float* CVertexArray::UploadDrawArray()
+{
+#if defined(USE_GML)
+	// render-threads would have to share the ring buffer
+	return drawArray;
+#else
+	if (streamState < 0) {
+		streamState = (configHandler->GetBool("StreamVertexArrays") && VBO::IsVBOSupported())? 1: 0;
+
+		if (streamState == 1) {
+			streamBuffer = new VBO(GL_ARRAY_BUFFER);
+		}
+	}
+
+	const unsigned int size = drawIndex() * sizeof(float);
+
+	if (streamState == 0 || size < STREAM_MIN_SIZE || size > STREAM_BUFFER_SIZE)
+		return drawArray;
+
+	streamBuffer->Bind(GL_ARRAY_BUFFER);
+
+	if ((streamOffset + size) > streamBuffer->GetSize()) {
+		// the driver keeps the old storage alive for draws still in flight,
+		// so the unsynchronized writes below never touch memory being read
+		streamBuffer->Resize(STREAM_BUFFER_SIZE, GL_STREAM_DRAW);
+		streamOffset = 0;
+	}
+
+	GLubyte* mem = streamBuffer->MapBuffer(streamOffset, size, GL_WRITE_ONLY);
+
+	if (mem == NULL) {
+		streamBuffer->UnmapBuffer();
+		streamBuffer->Unbind();
+		return drawArray;
+	}
+
+	memcpy(mem, drawArray, size);
+	streamBuffer->UnmapBuffer();
+
+	const float* ptr = reinterpret_cast<const float*>(streamBuffer->GetPtr(streamOffset));
+
+	// keep every upload 64-byte aligned
+	streamOffset += ((size + 63) & ~63);
+	return ptr;
+#endif
+}
+
+void CVertexArray::ReleaseDrawArray(const float* ptr)
+{
+	if (ptr != drawArray) {
+		streamBuffer->Unbind();
+	}
+}
+
+
+
 //////////////////////////////////////////////////////////////////////
 // 
 //////////////////////////////////////////////////////////////////////
@@ -196,9 +265,11 @@ void CVertexArray::DrawArray0(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
+	glVertexPointer(3, GL_FLOAT, stride, ptr);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
@@ -208,9 +279,11 @@ void CVertexArray::DrawArray2d0(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
+	glVertexPointer(2, GL_FLOAT, stride, ptr);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
@@ -220,11 +293,13 @@ void CVertexArray::DrawArrayN(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, ptr);
+	glNormalPointer(GL_FLOAT, stride, ptr + 3);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
@@ -236,11 +311,13 @@ void CVertexArray::DrawArrayC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, ptr);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, ptr + 3);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
 }
@@ -252,11 +329,13 @@ void CVertexArray::DrawArrayT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, ptr);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 3);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -268,11 +347,13 @@ void CVertexArray::DrawArray2dT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
+	glVertexPointer(2, GL_FLOAT, stride, ptr);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 2);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -284,13 +365,15 @@ void CVertexArray::DrawArray2dTC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 4);
+	glVertexPointer(2, GL_FLOAT, stride, ptr);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 2);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, ptr + 4);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
@@ -303,11 +386,13 @@ void CVertexArray::DrawArray2dT(const int drawType, StripCallback callback, void
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
+	glVertexPointer(2, GL_FLOAT, stride, ptr);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 2);
 	DrawArraysCallback(drawType, stride, callback, data);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -319,16 +404,18 @@ void CVertexArray::DrawArrayT2(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, ptr);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 3);
 
 	glClientActiveTextureARB(GL_TEXTURE1_ARB);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 5);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 5);
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glClientActiveTextureARB(GL_TEXTURE0_ARB);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glClientActiveTextureARB(GL_TEXTURE1_ARB);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glClientActiveTextureARB(GL_TEXTURE0_ARB);
@@ -344,14 +431,16 @@ void CVertexArray::DrawArrayTN(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, ptr);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 3);
+	glNormalPointer(GL_FLOAT, stride, ptr + 5);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -364,6 +453,7 @@ void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 
 	#define SET_ENABLE_ACTIVE_TEX(texUnit)            \
 		glClientActiveTexture(texUnit);               \
@@ -375,15 +465,16 @@ void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE0); glTexCoordPointer(2, GL_FLOAT, stride, drawArray +  3);
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE1); glTexCoordPointer(2, GL_FLOAT, stride, drawArray +  3); // FIXME? (format-specific)
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE5); glTexCoordPointer(3, GL_FLOAT, stride, drawArray +  8);
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE6); glTexCoordPointer(3, GL_FLOAT, stride, drawArray + 11);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE0); glTexCoordPointer(2, GL_FLOAT, stride, ptr +  3);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE1); glTexCoordPointer(2, GL_FLOAT, stride, ptr +  3); // FIXME? (format-specific)
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE5); glTexCoordPointer(3, GL_FLOAT, stride, ptr +  8);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE6); glTexCoordPointer(3, GL_FLOAT, stride, ptr + 11);
 
-	glVertexPointer(3, GL_FLOAT, stride, drawArray + 0);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, ptr + 0);
+	glNormalPointer(GL_FLOAT, stride, ptr + 5);
 
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 
 	SET_DISABLE_ACTIVE_TEX(GL_TEXTURE6);
 	SET_DISABLE_ACTIVE_TEX(GL_TEXTURE5);
@@ -404,13 +495,15 @@ void CVertexArray::DrawArrayTC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* ptr = UploadDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, ptr);
+	glTexCoordPointer(2, GL_FLOAT, stride, ptr + 3);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, ptr + 5);
 	DrawArrays(drawType, stride);
+	ReleaseDrawArray(ptr);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
@@ -93,6 +93,14 @@ public:
 
 protected:
 	void DrawArrays(const GLenum mode, const unsigned int stride);
+
+	/**
+	 * Copies the vertex data into the shared streaming VBO (if enabled
+	 * and worth it) and binds that; returns the pointer to pass to the
+	 * gl*Pointer functions, which is <drawArray> when not streaming.
+	 */
+	const float* UploadDrawArray();
+	void ReleaseDrawArray(const float* ptr);
 	void DrawArraysCallback(const GLenum mode, const unsigned int stride, StripCallback callback, void* data);
 	inline void CheckEnlargeDrawArray();
 	void EnlargeStripArray();
@@ -20,6 +20,7 @@ CONFIG(int, AtiHacks).defaultValue(-1).minimumValue(-1).maximumValue(1).descript
 CONFIG(bool, DualScreenMode).defaultValue(false).description("Sets whether to split the screen in half, with one half for minimap and one for main screen. Right side is for minimap unless DualScreenMiniMapOnLeft is set.");
 CONFIG(bool, DualScreenMiniMapOnLeft).defaultValue(false).description("When set, will make the left half of the screen the minimap when DualScreenMode is set.");
 CONFIG(bool, TeamNanoSpray).defaultValue(true);
+CONFIG(bool, InterpolateDrawPos).defaultValue(false).description("Draw units and projectiles between their last two simulated positions instead of extrapolating them along their speed. Smoother at high framerates, but shows everything one sim frame late.");
 
 /**
  * @brief global rendering
@@ -71,6 +72,7 @@ CR_REG_METADATA(CGlobalRendering, (
 
 	CR_IGNORED(maxTextureSize),
 	CR_IGNORED(teamNanospray),
+	CR_IGNORED(interpolateDrawPos),
 	CR_IGNORED(active),
 	CR_IGNORED(compressTextures),
 	CR_IGNORED(haveATI),
@@ -142,6 +144,7 @@ CGlobalRendering::CGlobalRendering()
 	, drawdebugtraceray(false)
 
 	, teamNanospray(true)
+	, interpolateDrawPos(false)
 	, active(true)
 	, compressTextures(false)
 	, haveATI(false)
@@ -292,6 +295,7 @@ void CGlobalRendering::PostInit() {
 	);
 
 	teamNanospray = configHandler->GetBool("TeamNanoSpray");
+	interpolateDrawPos = configHandler->GetBool("InterpolateDrawPos");
 }
 
 void CGlobalRendering::SetFullScreen(bool configFullScreen, bool cmdLineWindowed, bool cmdLineFullScreen)
@@ -155,6 +155,13 @@ public:
 	 */
 	bool teamNanospray;
 
+	/**
+	 * Draw units and projectiles between their previous and current sim
+	 * positions instead of extrapolating along their speed (no overshoot
+	 * on turns and stops, but everything is shown one sim frame late)
+	 */
+	bool interpolateDrawPos;
+
 
 	/**
 	 * @brief active video
@@ -8,6 +8,7 @@
 #include "Rendering/GlobalRendering.h"
 
 #include "Game/Camera.h"
+#include "Game/GlobalUnsynced.h"
 #include "Game/InMapDrawModel.h"
 #include "Map/ReadMap.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -111,24 +112,67 @@ struct InMapDraw_QuadDrawer: public CReadMap::IQuadDrawer
 {
 	CVertexArray* pointsVa;
 	CVertexArray* linesVa;
-	std::vector<const CInMapDrawModel::MapPoint*>* visibleLabels;
+	std::vector<CInMapDrawView::QuadCache>* quadCaches;
+	std::vector<const CInMapDrawView::CachedMark*>* visibleLabels;
+
+	/// mutual alliance of each allyteam with ours, the rest of the
+	/// IsLocalPlayerAllowedToSee() test is folded into <drawAll>
+	std::vector<bool> alliedWith;
+	bool drawAll;
 
 	void DrawQuad(int x, int y);
 
 private:
-	void DrawPoint(const CInMapDrawModel::MapPoint* point) const;
-	void DrawLine(const CInMapDrawModel::MapLine* line) const;
+	bool IsVisible(const CInMapDrawView::CachedMark& mark) const;
+	void UpdateCache(CInMapDrawView::QuadCache& qc, const CInMapDrawModel::DrawQuad* dq) const;
+
+	void DrawPoint(const CInMapDrawView::CachedMark& point) const;
+	void DrawLine(const CInMapDrawView::CachedMark& line) const;
 };
 
-void InMapDraw_QuadDrawer::DrawPoint(const CInMapDrawModel::MapPoint* point) const
+bool InMapDraw_QuadDrawer::IsVisible(const CInMapDrawView::CachedMark& mark) const
+{
+	return (drawAll || (!mark.spectator && alliedWith[teamHandler->AllyTeam(mark.teamID)]));
+}
+
+void InMapDraw_QuadDrawer::UpdateCache(CInMapDrawView::QuadCache& qc, const CInMapDrawModel::DrawQuad* dq) const
 {
-	const float3& pos = point->GetPos();
+	if (qc.revision == dq->revision)
+		return;
+
+	qc.revision = dq->revision;
+	qc.points.clear();
+	qc.lines.clear();
+	qc.points.reserve(dq->points.size());
+	qc.lines.reserve(dq->lines.size());
+
+	for (std::list<CInMapDrawModel::MapPoint>::const_iterator pi = dq->points.begin(); pi != dq->points.end(); ++pi) {
+		const CInMapDrawView::CachedMark mark = {
+			pi->GetPos(), pi->GetPos(),
+			pi->GetTeamID(), pi->IsBySpectator(),
+			pi->GetLabel().empty()? NULL: &pi->GetLabel()
+		};
+		qc.points.push_back(mark);
+	}
+	for (std::list<CInMapDrawModel::MapLine>::const_iterator li = dq->lines.begin(); li != dq->lines.end(); ++li) {
+		const CInMapDrawView::CachedMark mark = {
+			li->GetPos1(), li->GetPos2(),
+			li->GetTeamID(), li->IsBySpectator(),
+			NULL
+		};
+		qc.lines.push_back(mark);
+	}
+}
+
+void InMapDraw_QuadDrawer::DrawPoint(const CInMapDrawView::CachedMark& point) const
+{
+	const float3& pos = point.pos1;
 	const float3 dif = (pos - camera->GetPos()).ANormalize();
 	const float3 dir1 = (dif.cross(UpVector)).ANormalize();
 	const float3 dir2 = (dif.cross(dir1));
 
 
-	const unsigned char* color = point->IsBySpectator() ? color4::white : teamHandler->Team(point->GetTeamID())->color;
+	const unsigned char* color = point.spectator ? color4::white : teamHandler->Team(point.teamID)->color;
 	const unsigned char col[4] = {
 		color[0],
 		color[1],
@@ -155,35 +199,38 @@ void InMapDraw_QuadDrawer::DrawPoint(const CInMapDrawModel::MapPoint* point) con
 	pointsVa->AddVertexQTC(pos2 + dir1 * size - dir2 * size, 0.00f, 1, col);
 	pointsVa->AddVertexQTC(pos2 - dir1 * size - dir2 * size, 0.00f, 0, col);
 
-	if (!point->GetLabel().empty()) {
-		visibleLabels->push_back(point);
+	if (point.label != NULL) {
+		visibleLabels->push_back(&point);
 	}
 }
 
-void InMapDraw_QuadDrawer::DrawLine(const CInMapDrawModel::MapLine* line) const
+void InMapDraw_QuadDrawer::DrawLine(const CInMapDrawView::CachedMark& line) const
 {
-	const unsigned char* color = line->IsBySpectator() ? color4::white : teamHandler->Team(line->GetTeamID())->color;
-	linesVa->AddVertexQC(line->GetPos1() - (line->GetPos1() - camera->GetPos()).ANormalize() * 26, color);
-	linesVa->AddVertexQC(line->GetPos2() - (line->GetPos2() - camera->GetPos()).ANormalize() * 26, color);
+	const unsigned char* color = line.spectator ? color4::white : teamHandler->Team(line.teamID)->color;
+	linesVa->AddVertexQC(line.pos1 - (line.pos1 - camera->GetPos()).ANormalize() * 26, color);
+	linesVa->AddVertexQC(line.pos2 - (line.pos2 - camera->GetPos()).ANormalize() * 26, color);
 }
 
 void InMapDraw_QuadDrawer::DrawQuad(int x, int y)
 {
 	const CInMapDrawModel::DrawQuad* dq = inMapDrawerModel->GetDrawQuad(x, y);
 
-	pointsVa->EnlargeArrays(dq->points.size() * 12, 0, VA_SIZE_TC);
+	CInMapDrawView::QuadCache& qc = (*quadCaches)[y * inMapDrawerModel->GetDrawQuadX() + x];
+	UpdateCache(qc, dq);
+
+	pointsVa->EnlargeArrays(qc.points.size() * 12, 0, VA_SIZE_TC);
 	//! draw point markers
-	for (std::list<CInMapDrawModel::MapPoint>::const_iterator pi = dq->points.begin(); pi != dq->points.end(); ++pi) {
-		if (pi->IsLocalPlayerAllowedToSee(inMapDrawerModel)) {
-			DrawPoint(&*pi);
+	for (size_t n = 0; n < qc.points.size(); n++) {
+		if (IsVisible(qc.points[n])) {
+			DrawPoint(qc.points[n]);
 		}
 	}
 
-	linesVa->EnlargeArrays(dq->lines.size() * 2, 0, VA_SIZE_C);
+	linesVa->EnlargeArrays(qc.lines.size() * 2, 0, VA_SIZE_C);
 	//! draw line markers
-	for (std::list<CInMapDrawModel::MapLine>::const_iterator li = dq->lines.begin(); li != dq->lines.end(); ++li) {
-		if (li->IsLocalPlayerAllowedToSee(inMapDrawerModel)) {
-			DrawLine(&*li);
+	for (size_t n = 0; n < qc.lines.size(); n++) {
+		if (IsVisible(qc.lines[n])) {
+			DrawLine(qc.lines[n]);
 		}
 	}
 }
@@ -199,10 +246,19 @@ void CInMapDrawView::Draw()
 	CVertexArray* linesVa = GetVertexArray();
 	linesVa->Initialize();
 
+	quadCaches.resize(inMapDrawerModel->GetDrawQuadX() * inMapDrawerModel->GetDrawQuadY());
+
 	InMapDraw_QuadDrawer drawer;
 	drawer.linesVa = linesVa;
 	drawer.pointsVa = pointsVa;
+	drawer.quadCaches = &quadCaches;
 	drawer.visibleLabels = &visibleLabels;
+	drawer.drawAll = (gu->spectating || inMapDrawerModel->GetAllMarksVisible());
+	drawer.alliedWith.resize(teamHandler->ActiveAllyTeams());
+
+	for (int a = 0; a < teamHandler->ActiveAllyTeams(); a++) {
+		drawer.alliedWith[a] = (teamHandler->Ally(gu->myAllyTeam, a) && teamHandler->Ally(a, gu->myAllyTeam));
+	}
 
 	glDepthMask(0);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -229,20 +285,55 @@ void CInMapDrawView::Draw()
 	pointsVa->DrawArrayTC(GL_QUADS); //! draw point markers
 
 	if (!visibleLabels.empty()) {
-		font->SetColors(); //! default
+		DrawLabels();
+		visibleLabels.clear();
+	}
 
-		//! draw point labels
-		for (std::vector<const CInMapDrawModel::MapPoint*>::const_iterator pi = visibleLabels.begin(); pi != visibleLabels.end(); ++pi) {
-			float3 pos = (*pi)->GetPos();
-			pos.y += 111.0f;
+	glDepthMask(1);
+}
 
-			const unsigned char* color = (*pi)->IsBySpectator() ? color4::white : teamHandler->Team((*pi)->GetTeamID())->color;
-			font->SetTextColor(color[0]/255.0f, color[1]/255.0f, color[2]/255.0f, 1.0f); //FIXME (overload!)
-			font->glWorldPrint(pos, 26.0f, (*pi)->GetLabel());
-		}
 
-		visibleLabels.clear();
+void CInMapDrawView::DrawLabels()
+{
+	// glWorldPrint() would flush the font once per label; instead project
+	// them to the screen and print all in one batch, scaled so they keep
+	// the size a 26 elmo high billboard would have at their distance
+	const float3& camPos = camera->GetPos();
+	const float3& camDir = camera->forward;
+	const float pixelsPerElmo = (globalRendering->viewSizeY * 0.5f) / camera->GetTanHalfFov();
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	gluOrtho2D(0.0f, 1.0f, 0.0f, 1.0f);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	font->Begin(false, true);
+
+	for (std::vector<const CachedMark*>::const_iterator pi = visibleLabels.begin(); pi != visibleLabels.end(); ++pi) {
+		float3 pos = (*pi)->pos1;
+		pos.y += 111.0f;
+
+		const float depth = (pos - camPos).dot(camDir);
+
+		if (depth <= 0.0f)
+			continue;
+
+		const float3 winPos = camera->CalcWindowCoordinates(pos);
+		const float x = (winPos.x - globalRendering->viewPosX) * globalRendering->pixelX;
+		const float y = (winPos.y                            ) * globalRendering->pixelY;
+
+		const unsigned char* color = (*pi)->spectator ? color4::white : teamHandler->Team((*pi)->teamID)->color;
+		font->SetTextColor(color[0]/255.0f, color[1]/255.0f, color[2]/255.0f, 1.0f); //FIXME (overload!)
+		font->glPrint(x, y, 26.0f * pixelsPerElmo / depth, FONT_DESCENDER | FONT_CENTER | FONT_OUTLINE | FONT_NORM, *(*pi)->label);
 	}
 
-	glDepthMask(1);
+	font->End();
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
 }
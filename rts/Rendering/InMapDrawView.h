@@ -23,10 +23,31 @@ public:
 
 	void Draw();
 
+	struct CachedMark {
+		float3 pos1;
+		float3 pos2; ///< lines only
+		int teamID;
+		bool spectator;
+		const std::string* label; ///< points only, NULL if there is none
+	};
+
+	/// contiguous copy of a DrawQuad's marks, rebuilt when its revision changes
+	struct QuadCache {
+		QuadCache(): revision(-1u) {}
+
+		unsigned int revision;
+		std::vector<CachedMark> points;
+		std::vector<CachedMark> lines;
+	};
+
+private:
+	void DrawLabels();
+
 private:
 	unsigned int texture;
 
-	std::vector<const CInMapDrawModel::MapPoint*> visibleLabels;
+	std::vector<QuadCache> quadCaches;
+	std::vector<const CachedMark*> visibleLabels;
 };
 
 extern CInMapDrawView* inMapDrawerView;
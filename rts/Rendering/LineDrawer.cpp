@@ -21,8 +21,6 @@ CLineDrawer::CLineDrawer()
 	, lastColor(NULL)
 	, stippleTimer(0.0f)
 {
-	lines.reserve(32);
-	stippled.reserve(32);
 }
 
 
@@ -48,11 +46,30 @@ void CLineDrawer::SetupLineStipple()
 }
 
 
+void CLineDrawer::DrawBatch(const LineBatch& batch)
+{
+	if (!batch.segVerts.empty()) {
+		glColorPointer(4, GL_FLOAT, 0, &batch.segColors[0]);
+		glVertexPointer(3, GL_FLOAT, 0, &batch.segVerts[0]);
+		glDrawArrays(GL_LINES, 0, batch.segVerts.size() / 3);
+	}
+
+	if (!batch.stripVerts.empty()) {
+		glColorPointer(4, GL_FLOAT, 0, &batch.stripColors[0]);
+		glVertexPointer(3, GL_FLOAT, 0, &batch.stripVerts[0]);
+
+		for (size_t i = 0; i < batch.stripFirsts.size(); ++i) {
+			glDrawArrays(GL_LINE_STRIP, batch.stripFirsts[i], batch.stripCounts[i]);
+		}
+	}
+}
+
+
 void CLineDrawer::DrawAll()
 {
-	if (lines.empty() && stippled.empty())
+	if (lines.Empty() && stippled.Empty())
 		return;
-	
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
 
@@ -60,25 +77,11 @@ void CLineDrawer::DrawAll()
 	glDisable(GL_DEPTH_TEST);
 	glDisable(GL_LINE_STIPPLE);
 
-	for (int i = 0; i<lines.size(); ++i) {
-		int size = lines[i].verts.size();
-		if(size > 0) {
-			glColorPointer(4, GL_FLOAT, 0, &lines[i].colors[0]);
-			glVertexPointer(3, GL_FLOAT, 0, &lines[i].verts[0]);
-			glDrawArrays(lines[i].type, 0, size/3);
-		}
-	}
+	DrawBatch(lines);
 
-	if (!stippled.empty()) {
+	if (!stippled.Empty()) {
 		glEnable(GL_LINE_STIPPLE);
-		for (int i = 0; i<stippled.size(); ++i) {
-			int size = stippled[i].verts.size();
-			if(size > 0) {
-				glColorPointer(4, GL_FLOAT, 0, &stippled[i].colors[0]);
-				glVertexPointer(3, GL_FLOAT, 0, &stippled[i].verts[0]);
-				glDrawArrays(stippled[i].type, 0, size/3);
-			}
-		}
+		DrawBatch(stippled);
 		glDisable(GL_LINE_STIPPLE);
 	}
 
@@ -86,6 +89,6 @@ void CLineDrawer::DrawAll()
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glEnable(GL_DEPTH_TEST);
 
-	lines.clear();
-	stippled.clear();
+	lines.Clear();
+	stippled.Clear();
 }
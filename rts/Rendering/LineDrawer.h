@@ -45,15 +45,47 @@ class CLineDrawer {
 		
 		float stippleTimer;
 
-		// queue all lines and draw them in one go later
-		struct LinePair {
-			GLenum type;
-			std::vector<GLfloat> verts;
-			std::vector<GLfloat> colors;
+		/**
+		 * Queues all lines and draws them in one go later. Unstippled
+		 * paths are stored as independent segments so that each batch
+		 * needs only a single draw call; stippled strips stay strips
+		 * (the pattern would restart at every segment otherwise), but
+		 * share one vertex array. The buffers are reused every frame.
+		 */
+		struct LineBatch {
+			void Clear() {
+				segVerts.clear();
+				segColors.clear();
+				stripVerts.clear();
+				stripColors.clear();
+				stripFirsts.clear();
+				stripCounts.clear();
+			}
+			bool Empty() const { return (segVerts.empty() && stripVerts.empty()); }
+
+			std::vector<GLfloat> segVerts;
+			std::vector<GLfloat> segColors;
+
+			std::vector<GLfloat> stripVerts;
+			std::vector<GLfloat> stripColors;
+			std::vector<GLint> stripFirsts;
+			std::vector<GLsizei> stripCounts;
 		};
 
-		std::vector<LinePair> lines;
-		std::vector<LinePair> stippled;
+		static void AddVertex(std::vector<GLfloat>& verts, std::vector<GLfloat>& colors, const float3& pos, const float* color, float alpha) {
+			verts.push_back(pos.x);
+			verts.push_back(pos.y);
+			verts.push_back(pos.z);
+			colors.push_back(color[0]);
+			colors.push_back(color[1]);
+			colors.push_back(color[2]);
+			colors.push_back(alpha);
+		}
+
+		static void DrawBatch(const LineBatch& batch);
+
+		LineBatch lines;
+		LineBatch stippled;
 };
 
 
@@ -90,28 +122,14 @@ inline void CLineDrawer::Break(const float3& endPos, const float* color)
 
 inline void CLineDrawer::Restart()
 {
-	LinePair *ptr;
-	if (lineStipple) {
-		stippled.push_back(LinePair());
-		ptr = &stippled.back();
-	} else {
-		lines.push_back(LinePair());
-		ptr = &lines.back();
-	}
-	LinePair& p = *ptr;
-
-	if (!useColorRestarts)	 {
-		p.type = GL_LINE_STRIP;
-		p.colors.push_back(lastColor[0]);
-		p.colors.push_back(lastColor[1]);
-		p.colors.push_back(lastColor[2]);
-		p.colors.push_back(lastColor[3]);
-		p.verts.push_back(lastPos[0]);
-		p.verts.push_back(lastPos[1]);
-		p.verts.push_back(lastPos[2]);
-	} else {
-		p.type = GL_LINES;
-	}
+	// segments need no restart, only stippled strips do
+	if (!lineStipple || useColorRestarts)
+		return;
+
+	stippled.stripFirsts.push_back(stippled.stripVerts.size() / 3);
+	stippled.stripCounts.push_back(1);
+
+	AddVertex(stippled.stripVerts, stippled.stripColors, lastPos, lastColor, lastColor[3]);
 }
 
 
@@ -140,45 +158,28 @@ inline void CLineDrawer::StartPath(const float3& pos, const float* color)
 
 inline void CLineDrawer::DrawLine(const float3& endPos, const float* color)
 {
-	LinePair *ptr;
-	if (lineStipple) {
-		ptr = &stippled.back();
-	} else {
-		ptr = &lines.back();
-	}
-	LinePair& p = *ptr;
+	LineBatch& b = lineStipple? stippled: lines;
 
 	if (!useColorRestarts) {
-		p.colors.push_back(color[0]);
-		p.colors.push_back(color[1]);
-		p.colors.push_back(color[2]);
-		p.colors.push_back(color[3]);
-		p.verts.push_back(endPos.x);
-		p.verts.push_back(endPos.y);
-		p.verts.push_back(endPos.z);
+		if (lineStipple) {
+			if (b.stripCounts.empty())
+				Restart();
+
+			AddVertex(b.stripVerts, b.stripColors, endPos, color, color[3]);
+			b.stripCounts.back() += 1;
+		} else {
+			// same colors a GL_LINE_STRIP would interpolate between
+			AddVertex(b.segVerts, b.segColors, lastPos, lastColor, lastColor[3]);
+			AddVertex(b.segVerts, b.segColors, endPos, color, color[3]);
+		}
 	} else {
 		if (useRestartColor) {
-			p.colors.push_back(restartColor[0]);
-			p.colors.push_back(restartColor[1]);
-			p.colors.push_back(restartColor[2]);
-			p.colors.push_back(restartColor[3]);
+			AddVertex(b.segVerts, b.segColors, lastPos, restartColor, restartColor[3]);
 		} else {
-			p.colors.push_back(color[0]);
-			p.colors.push_back(color[1]);
-			p.colors.push_back(color[2]);
-			p.colors.push_back(color[3] * restartAlpha);
+			AddVertex(b.segVerts, b.segColors, lastPos, color, color[3] * restartAlpha);
 		}
-		p.verts.push_back(lastPos.x);
-		p.verts.push_back(lastPos.y);
-		p.verts.push_back(lastPos.z);
-
-		p.colors.push_back(color[0]);
-		p.colors.push_back(color[1]);
-		p.colors.push_back(color[2]);
-		p.colors.push_back(color[3]);
-		p.verts.push_back(endPos.x);
-		p.verts.push_back(endPos.y);
-		p.verts.push_back(endPos.z);
+
+		AddVertex(b.segVerts, b.segColors, endPos, color, color[3]);
 	}
 
 	lastPos = endPos;
@@ -22,8 +22,13 @@ CR_REG_METADATA(LocalModelPiece, (
 	CR_MEMBER(pieceSpaceMat),
 	CR_MEMBER(modelSpaceMat),
 	CR_MEMBER(colvol),
+	CR_MEMBER(volBoundsCenter),
+	CR_MEMBER(treeBoundsCenter),
+	CR_MEMBER(volBoundsRadius),
+	CR_MEMBER(treeBoundsRadius),
 	CR_MEMBER(numUpdatesSynced),
 	CR_MEMBER(lastMatrixUpdate),
+	CR_MEMBER(dirtyChildren),
 	CR_MEMBER(scriptSetVisible),
 	CR_MEMBER(identityTransform),
 	CR_MEMBER(lmodelPieceIndex),
@@ -82,6 +87,11 @@ S3DModelPiece::S3DModelPiece()
 	, maxs(DEF_MAX_SIZE)
 	, rotAxisSigns(-OnesVector)
 	, dispListID(0)
+	, geomIndices(&vboIndices)
+	, geomAttributes(&vboAttributes)
+	, indexOffset(0)
+	, vertexOffset(0)
+	, sharedGeometry(false)
 {
 }
 
@@ -102,6 +112,45 @@ unsigned int S3DModelPiece::CreateDrawForList() const
 	return dlistID;
 }
 
+void S3DModelPiece::UploadSharedGeometryVBOs()
+{
+	std::vector<unsigned char> attribs;
+	std::vector<unsigned int> indices;
+
+	std::vector<S3DModelPiece*> pieces;
+	std::vector<S3DModelPiece*> stack(1, this);
+
+	while (!stack.empty()) {
+		S3DModelPiece* p = stack.back();
+		stack.pop_back();
+
+		if (p->AppendGeometry(attribs, indices))
+			pieces.push_back(p);
+
+		stack.insert(stack.end(), p->children.begin(), p->children.end());
+	}
+
+	if (pieces.empty())
+		return;
+
+	if (!attribs.empty()) {
+		vboAttributes.Bind(GL_ARRAY_BUFFER);
+		vboAttributes.Resize(attribs.size(), GL_STATIC_DRAW, &attribs[0]);
+		vboAttributes.Unbind();
+	}
+	if (!indices.empty()) {
+		vboIndices.Bind(GL_ELEMENT_ARRAY_BUFFER);
+		vboIndices.Resize(indices.size() * sizeof(unsigned int), GL_STATIC_DRAW, &indices[0]);
+		vboIndices.Unbind();
+	}
+
+	for (unsigned int n = 0; n < pieces.size(); n++) {
+		pieces[n]->geomIndices = &vboIndices;
+		pieces[n]->geomAttributes = &vboAttributes;
+		pieces[n]->sharedGeometry = true;
+	}
+}
+
 void S3DModelPiece::DrawStatic() const
 {
 	CMatrix44f mat;
@@ -113,7 +162,7 @@ void S3DModelPiece::DrawStatic() const
 	glMultMatrixf(mat);
 
 	if (hasGeometryData)
-		glCallList(dispListID);
+		DrawGeometry();
 
 	for (unsigned int n = 0; n < children.size(); n++) {
 		children[n]->DrawStatic();
@@ -122,6 +171,17 @@ void S3DModelPiece::DrawStatic() const
 	glPopMatrix();
 }
 
+void S3DModelPiece::DrawGeometry() const
+{
+	// pieces have no list if ModelDisplayLists is disabled,
+	// DrawForList then draws straight from the piece's VBOs
+	if (dispListID != 0) {
+		glCallList(dispListID);
+	} else {
+		DrawForList();
+	}
+}
+
 
 
 /** ****************************************************************************************************
@@ -188,8 +248,14 @@ LocalModelPiece* LocalModel::CreateLocalModelPieces(const S3DModelPiece* mpParen
 LocalModelPiece::LocalModelPiece(const S3DModelPiece* piece)
 	: colvol(new CollisionVolume(piece->GetCollisionVolume()))
 
+	, volBoundsCenter(ZeroVector)
+	, treeBoundsCenter(ZeroVector)
+	, volBoundsRadius(-1.0f)
+	, treeBoundsRadius(-1.0f)
+
 	, numUpdatesSynced(1)
 	, lastMatrixUpdate(0)
+	, dirtyChildren(true)
 
 	, scriptSetVisible(piece->HasGeometryData())
 	, identityTransform(true)
@@ -235,11 +301,54 @@ void LocalModelPiece::UpdateMatricesRec(bool updateChildMatrices)
 		if (parent != NULL) {
 			modelSpaceMat >>= parent->modelSpaceMat;
 		}
+	} else {
+		// neither this piece nor its ancestors changed; only
+		// descend if some piece further down has been moved
+		if (!dirtyChildren)
+			return;
 	}
 
+	dirtyChildren = false;
+
 	for (unsigned int i = 0; i < children.size(); i++) {
 		children[i]->UpdateMatricesRec(updateChildMatrices);
 	}
+
+	// something in this subtree moved, refit its bounds bottom-up
+	UpdateBounds();
+}
+
+void LocalModelPiece::UpdateBounds()
+{
+	// largest scale factor along any axis of the model-space transform
+	const float maxScaleSq = std::max(modelSpaceMat.GetX().SqLength(), std::max(modelSpaceMat.GetY().SqLength(), modelSpaceMat.GetZ().SqLength()));
+
+	volBoundsCenter = modelSpaceMat.Mul(colvol->GetOffsets());
+	volBoundsRadius = colvol->GetBoundingRadius() * math::sqrt(maxScaleSq);
+
+	treeBoundsCenter = volBoundsCenter;
+	treeBoundsRadius = volBoundsRadius;
+
+	// not the tightest sphere, but cheap and conservative
+	for (unsigned int i = 0; i < children.size(); i++) {
+		const LocalModelPiece* c = children[i];
+
+		if (c->treeBoundsRadius < 0.0f) {
+			treeBoundsRadius = -1.0f; break;
+		}
+
+		treeBoundsRadius = std::max(treeBoundsRadius, treeBoundsCenter.distance(c->treeBoundsCenter) + c->treeBoundsRadius);
+	}
+}
+
+void LocalModelPiece::CollisionVolumeChanged()
+{
+	// bounds of this piece and all above it are stale until the next refit
+	for (LocalModelPiece* p = this; p != NULL; p = p->parent) {
+		p->treeBoundsRadius = -1.0f;
+	}
+
+	SetDirty();
 }
 
 
@@ -251,7 +360,7 @@ void LocalModelPiece::Draw() const
 
 	glPushMatrix();
 	glMultMatrixf(modelSpaceMat);
-	glCallList(dispListID);
+	original->DrawGeometry();
 	glPopMatrix();
 }
 
@@ -262,7 +371,14 @@ void LocalModelPiece::DrawLOD(unsigned int lod) const
 
 	glPushMatrix();
 	glMultMatrixf(modelSpaceMat);
-	glCallList(lodDispLists[lod]);
+
+	// the default LOD "list" is the piece itself (see LuaUnitRendering::SetPieceList)
+	if (lodDispLists[lod] == dispListID) {
+		original->DrawGeometry();
+	} else {
+		glCallList(lodDispLists[lod]);
+	}
+
 	glPopMatrix();
 }
 
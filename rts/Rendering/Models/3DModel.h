@@ -52,6 +52,14 @@ struct S3DModelPiece {
 	virtual unsigned int CreateDrawForList() const;
 	virtual void UploadGeometryVBOs() {}
 
+	/**
+	 * Packs the geometry of this piece and of all pieces below it into this
+	 * piece's VBOs, which are then shared by the whole (sub)tree with one
+	 * vertex and index range per piece. Only called for the root piece;
+	 * pieces that do not implement AppendGeometry keep their own VBOs.
+	 */
+	void UploadSharedGeometryVBOs();
+
 	virtual unsigned int GetVertexCount() const { return 0; }
 	virtual unsigned int GetNormalCount() const { return 0; }
 	virtual unsigned int GetTxCoorCount() const { return 0; }
@@ -103,6 +111,8 @@ struct S3DModelPiece {
 
 	// draw piece and children statically (ie. without script-transforms)
 	void DrawStatic() const;
+	// draw only this piece's geometry, via its display list if it has one
+	void DrawGeometry() const;
 
 	void SetCollisionVolume(CollisionVolume* cv) { colvol = cv; }
 	const CollisionVolume* GetCollisionVolume() const { return colvol; }
@@ -123,6 +133,9 @@ struct S3DModelPiece {
 protected:
 	virtual void DrawForList() const = 0;
 
+	/// appends vertices and (rebased) indices for UploadSharedGeometryVBOs, false if unsupported
+	virtual bool AppendGeometry(std::vector<unsigned char>& attribs, std::vector<unsigned int>& indices) { return false; }
+
 public:
 	std::string name;
 	std::string parentName;
@@ -151,6 +164,15 @@ protected:
 
 	VBO vboIndices;
 	VBO vboAttributes;
+
+	// the buffers DrawForList reads from; the root's VBOs if shared
+	const VBO* geomIndices;
+	const VBO* geomAttributes;
+
+	unsigned int indexOffset;  ///< first index of this piece in geomIndices
+	unsigned int vertexOffset; ///< first vertex of this piece in geomAttributes
+
+	bool sharedGeometry;
 };
 
 
@@ -244,8 +266,8 @@ struct LocalModelPiece
 	bool GetEmitDirPos(float3& pos, float3& dir) const;
 	float3 GetAbsolutePos() const;
 
-	void SetPosition(const float3& p) { pos = p; ++numUpdatesSynced; }
-	void SetRotation(const float3& r) { rot = r; ++numUpdatesSynced; }
+	void SetPosition(const float3& p) { pos = p; SetDirty(); }
+	void SetRotation(const float3& r) { rot = r; SetDirty(); }
 	void SetDirection(const float3& d) { dir = d; } // unused
 
 	const float3& GetPosition() const { return pos; }
@@ -258,6 +280,28 @@ struct LocalModelPiece
 	const CollisionVolume* GetCollisionVolume() const { return colvol; }
 	      CollisionVolume* GetCollisionVolume()       { return colvol; }
 
+	/// must be called after changing the shape of <colvol> outside of UpdateMatricesRec
+	void CollisionVolumeChanged();
+
+	/// model-space bounding sphere of this piece's collision volume
+	const float3& GetVolumeBoundsCenter() const { return volBoundsCenter; }
+	float GetVolumeBoundsRadius() const { return volBoundsRadius; }
+	/// model-space bounding sphere of the volumes of this piece and every piece below it,
+	/// refit by UpdateMatricesRec; the radius is negative while it is not known
+	const float3& GetTreeBoundsCenter() const { return treeBoundsCenter; }
+	float GetTreeBoundsRadius() const { return treeBoundsRadius; }
+
+private:
+	void UpdateBounds();
+	void SetDirty() {
+		++numUpdatesSynced;
+
+		// flag the path to the root so UpdateMatricesRec can skip clean subtrees
+		for (LocalModelPiece* p = parent; p != NULL && !p->dirtyChildren; p = p->parent) {
+			p->dirtyChildren = true;
+		}
+	}
+
 private:
 	float3 pos; // translation relative to parent LMP, *INITIALLY* equal to original->offset
 	float3 rot; // orientation relative to parent LMP, in radians (updated by scripts)
@@ -268,9 +312,16 @@ private:
 
 	CollisionVolume* colvol;
 
+	float3 volBoundsCenter;
+	float3 treeBoundsCenter;
+	float volBoundsRadius;
+	float treeBoundsRadius;
+
 	unsigned numUpdatesSynced; // triggers UpdateMatrix (via UpdateMatricesRec) if != lastMatrixUpdate
 	unsigned lastMatrixUpdate;
 
+	bool dirtyChildren; // true IFF any piece in the subtree below this one needs a matrix update
+
 public:
 	bool scriptSetVisible;  // TODO: add (visibility) maxradius!
 	bool identityTransform; // true IFF pieceSpaceMat (!) equals identity
@@ -280,7 +331,7 @@ public:
 	unsigned int dispListID;
 
 	const S3DModelPiece* original;
-	const LocalModelPiece* parent;
+	LocalModelPiece* parent;
 
 	std::vector<LocalModelPiece*> children;
 	std::vector<unsigned int> lodDispLists;
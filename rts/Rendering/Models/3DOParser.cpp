@@ -397,40 +397,34 @@ void C3DOParser::SimStreamRead(void* buf, int length)
 
 
 
-void S3DOPiece::DrawForList() const
-{
-	if (!hasGeometryData)
-		return;
+struct S3DOVertexTN {
+	S3DOVertexTN(const float3& p, float tx, float ty, const float3& n): pos(p), tx(tx), ty(ty), normal(n) {}
+
+	// same layout as CVertexArray::AddVertexTN
+	float3 pos;
+	float tx, ty;
+	float3 normal;
+};
 
-	// note: do not use more than two VA's
-	// via GetVertexArray(), it wraps around
-	CVertexArray* va1 = GetVertexArray();
-	CVertexArray* va2 = GetVertexArray();
-	va1->Initialize();
-	va2->Initialize();
+// collects the quads of <piece> followed by its triangles (also returned separately)
+static void GetPieceVertices(const S3DOPiece* piece, std::vector<S3DOVertexTN>& quadVerts, std::vector<S3DOVertexTN>& triVerts)
+{
+	const std::vector<S3DOVertex>& vertices = piece->vertices;
+	const std::vector<S3DOPrimitive>& prims = piece->prims;
 
 	for (std::vector<S3DOPrimitive>::const_iterator ps = prims.begin(); ps != prims.end(); ++ps) {
 		C3DOTextureHandler::UnitTexture* tex = ps->texture;
 
 		if (ps->numVertex == 4) {
-			va1->AddVertexTN(vertices[ps->vertices[0]].pos, tex->xstart, tex->ystart, ps->vnormals[0]);
-			va1->AddVertexTN(vertices[ps->vertices[1]].pos, tex->xend,   tex->ystart, ps->vnormals[1]);
-			va1->AddVertexTN(vertices[ps->vertices[2]].pos, tex->xend,   tex->yend,   ps->vnormals[2]);
-			va1->AddVertexTN(vertices[ps->vertices[3]].pos, tex->xstart, tex->yend,   ps->vnormals[3]);
+			quadVerts.push_back(S3DOVertexTN(vertices[ps->vertices[0]].pos, tex->xstart, tex->ystart, ps->vnormals[0]));
+			quadVerts.push_back(S3DOVertexTN(vertices[ps->vertices[1]].pos, tex->xend,   tex->ystart, ps->vnormals[1]));
+			quadVerts.push_back(S3DOVertexTN(vertices[ps->vertices[2]].pos, tex->xend,   tex->yend,   ps->vnormals[2]));
+			quadVerts.push_back(S3DOVertexTN(vertices[ps->vertices[3]].pos, tex->xstart, tex->yend,   ps->vnormals[3]));
 		} else if (ps->numVertex == 3) {
-			va2->AddVertexTN(vertices[ps->vertices[0]].pos, tex->xstart, tex->ystart, ps->vnormals[0]);
-			va2->AddVertexTN(vertices[ps->vertices[1]].pos, tex->xend,   tex->ystart, ps->vnormals[1]);
-			va2->AddVertexTN(vertices[ps->vertices[2]].pos, tex->xend,   tex->yend,   ps->vnormals[2]);
+			triVerts.push_back(S3DOVertexTN(vertices[ps->vertices[0]].pos, tex->xstart, tex->ystart, ps->vnormals[0]));
+			triVerts.push_back(S3DOVertexTN(vertices[ps->vertices[1]].pos, tex->xend,   tex->ystart, ps->vnormals[1]));
+			triVerts.push_back(S3DOVertexTN(vertices[ps->vertices[2]].pos, tex->xend,   tex->yend,   ps->vnormals[2]));
 		} else {
-			/*glBegin(GL_TRIANGLE_FAN);
-			glNormalf3(ps->primNormal);
-			glTexCoord2f(tex->xstart, tex->ystart);
-
-			for (std::vector<int>::const_iterator fi = ps->vertices.begin(); fi != ps->vertices.end(); ++fi) {
-				glVertexf3(vertices[(*fi)].pos);
-			}
-			glEnd();*/
-
 			//workaround: split fan into triangles to workaround a bug in Mesa drivers with fans, dlists & glbegin..glend
 			if (ps->vertices.size() >= 3) {
 				std::vector<int>::const_iterator fi = ps->vertices.begin();
@@ -438,20 +432,87 @@ void S3DOPiece::DrawForList() const
 				const float3* edge2 = &(vertices[*fi].pos); ++fi;
 				for (; fi != ps->vertices.end(); ++fi) {
 					const float3* edge3 = &(vertices[*fi].pos);
-					va2->AddVertexTN(*edge1, tex->xstart, tex->ystart, ps->primNormal);
-					va2->AddVertexTN(*edge2, tex->xstart, tex->ystart, ps->primNormal);
-					va2->AddVertexTN(*edge3, tex->xstart, tex->ystart, ps->primNormal);
+					triVerts.push_back(S3DOVertexTN(*edge1, tex->xstart, tex->ystart, ps->primNormal));
+					triVerts.push_back(S3DOVertexTN(*edge2, tex->xstart, tex->ystart, ps->primNormal));
+					triVerts.push_back(S3DOVertexTN(*edge3, tex->xstart, tex->ystart, ps->primNormal));
 					edge2 = edge3;
 				}
 			}
 		}
 	}
 
-	va1->DrawArrayTN(GL_QUADS);
+	quadVerts.insert(quadVerts.end(), triVerts.begin(), triVerts.end());
+}
+
+bool S3DOPiece::AppendGeometry(std::vector<unsigned char>& attribs, std::vector<unsigned int>& indices)
+{
+	if (!hasGeometryData)
+		return false;
+
+	std::vector<S3DOVertexTN> quadVerts;
+	std::vector<S3DOVertexTN> triVerts;
+
+	GetPieceVertices(this, quadVerts, triVerts);
 
-	if (va2->drawIndex() != 0) {
-		va2->DrawArrayTN(GL_TRIANGLES);
+	numQuadVerts = quadVerts.size() - triVerts.size();
+	numTriVerts = triVerts.size();
+	vertexOffset = attribs.size() / sizeof(S3DOVertexTN);
+
+	if (!quadVerts.empty()) {
+		const unsigned char* data = reinterpret_cast<const unsigned char*>(&quadVerts[0]);
+		attribs.insert(attribs.end(), data, data + quadVerts.size() * sizeof(S3DOVertexTN));
 	}
+
+	return true;
+}
+
+void S3DOPiece::UploadGeometryVBOs()
+{
+	if (!hasGeometryData || sharedGeometry)
+		return;
+
+	std::vector<S3DOVertexTN> quadVerts;
+	std::vector<S3DOVertexTN> triVerts;
+
+	GetPieceVertices(this, quadVerts, triVerts);
+
+	numQuadVerts = quadVerts.size() - triVerts.size();
+	numTriVerts = triVerts.size();
+
+	if (quadVerts.empty())
+		return;
+
+	vboAttributes.Bind(GL_ARRAY_BUFFER);
+	vboAttributes.Resize(quadVerts.size() * sizeof(S3DOVertexTN), GL_STATIC_DRAW, &quadVerts[0]);
+	vboAttributes.Unbind();
+}
+
+void S3DOPiece::DrawForList() const
+{
+	if (!hasGeometryData)
+		return;
+	if ((numQuadVerts + numTriVerts) == 0)
+		return;
+
+	geomAttributes->Bind(GL_ARRAY_BUFFER);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, sizeof(S3DOVertexTN), geomAttributes->GetPtr(offsetof(S3DOVertexTN, pos)));
+
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(S3DOVertexTN), geomAttributes->GetPtr(offsetof(S3DOVertexTN, tx)));
+
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glNormalPointer(GL_FLOAT, sizeof(S3DOVertexTN), geomAttributes->GetPtr(offsetof(S3DOVertexTN, normal)));
+
+		if (numQuadVerts != 0)
+			glDrawArrays(GL_QUADS, vertexOffset, numQuadVerts);
+		if (numTriVerts != 0)
+			glDrawArrays(GL_TRIANGLES, vertexOffset + numQuadVerts, numTriVerts);
+
+		glDisableClientState(GL_VERTEX_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_NORMAL_ARRAY);
+	geomAttributes->Unbind();
 }
 
 void S3DOPiece::SetMinMaxExtends()
@@ -36,10 +36,12 @@ struct S3DOPrimitive {
 };
 
 struct S3DOPiece: public S3DModelPiece {
-	S3DOPiece(): radius(0.0f) {
+	S3DOPiece(): radius(0.0f), numQuadVerts(0), numTriVerts(0) {
 	}
 
 	void DrawForList() const;
+	void UploadGeometryVBOs();
+	bool AppendGeometry(std::vector<unsigned char>& attribs, std::vector<unsigned int>& indices);
 	void SetMinMaxExtends();
 	unsigned int GetVertexCount() const { return vertices.size(); }
 	const float3& GetVertexPos(const int idx) const { return vertices[idx].pos; }
@@ -70,6 +72,11 @@ struct S3DOPiece: public S3DModelPiece {
 	std::vector<S3DOPrimitive> prims;
 	float radius;
 	float3 relMidPos;
+
+private:
+	// geomAttributes holds the quads followed by the triangles
+	unsigned int numQuadVerts;
+	unsigned int numTriVerts;
 };
 
 class C3DOParser: public IModelParser
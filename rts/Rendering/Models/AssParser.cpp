@@ -24,7 +24,6 @@
 #include "lib/assimp/include/assimp/postprocess.h"
 #include "lib/assimp/include/assimp/Importer.hpp"
 #include "lib/assimp/include/assimp/DefaultLogger.hpp"
-#include "Rendering/Textures/S3OTextureHandler.h"
 #ifndef BITMAP_NO_OPENGL
 	#include "Rendering/GL/myGL.h"
 #endif
@@ -135,6 +134,23 @@ public:
 
 
 
+CAssParser::CAssParser()
+	: maxIndices(1024)
+	, maxVertices(1024)
+{
+	// Create a logger for debugging model loading issues
+	Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
+	Assimp::DefaultLogger::get()->attachStream(new AssLogStream(), ASS_LOGGING_OPTIONS);
+
+#ifndef BITMAP_NO_OPENGL
+	// queried here since Load can run on threads without a GL context
+	// FIXME returns non-optimal data, at best compute it ourselves (pre-TL cache size!)
+	glGetIntegerv(GL_MAX_ELEMENTS_INDICES,  &maxIndices);
+	glGetIntegerv(GL_MAX_ELEMENTS_VERTICES, &maxVertices);
+#endif
+}
+
+
 S3DModel* CAssParser::Load(const std::string& modelFilePath)
 {
 	LOG_S(LOG_SECTION_MODEL, "Loading model: %s", modelFilePath.c_str());
@@ -170,26 +186,15 @@ S3DModel* CAssParser::Load(const std::string& modelFilePath)
 	// Create a model importer instance
 	Assimp::Importer importer;
 
-	// Create a logger for debugging model loading issues
-	Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
-	Assimp::DefaultLogger::get()->attachStream(new AssLogStream(), ASS_LOGGING_OPTIONS);
-
 	// Give the importer an IO class that handles Spring's VFS
 	importer.SetIOHandler(new AssVFSSystem());
 	// Speed-up processing by skipping things we don't need
 	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, ASS_IMPORTER_OPTIONS);
 
 #ifndef BITMAP_NO_OPENGL
-	{
-		// Optimize VBO-Mesh sizes/ranges
-		GLint maxIndices  = 1024;
-		GLint maxVertices = 1024;
-		// FIXME returns non-optimal data, at best compute it ourselves (pre-TL cache size!)
-		glGetIntegerv(GL_MAX_ELEMENTS_INDICES,  &maxIndices);
-		glGetIntegerv(GL_MAX_ELEMENTS_VERTICES, &maxVertices);
-		importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
-		importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
-	}
+	// Optimize VBO-Mesh sizes/ranges
+	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
+	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
 #endif
 
 	// Read the model file to build a scene object
@@ -217,8 +222,7 @@ S3DModel* CAssParser::Load(const std::string& modelFilePath)
 
 	// Load textures
 	FindTextures(model, scene, modelTable, modelPath, modelName);
-	LOG_S(LOG_SECTION_MODEL, "Loading textures. Tex1: '%s' Tex2: '%s'", model->tex1.c_str(), model->tex2.c_str());
-	texturehandlerS3O->LoadS3OTexture(model);
+	LOG_S(LOG_SECTION_MODEL, "Found textures. Tex1: '%s' Tex2: '%s'", model->tex1.c_str(), model->tex2.c_str());
 
 	// Load all pieces in the model
 	LOG_S(LOG_SECTION_MODEL, "Loading pieces from root node '%s'", scene->mRootNode->mName.data);
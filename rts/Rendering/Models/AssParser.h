@@ -62,6 +62,8 @@ public:
 class CAssParser: public IModelParser
 {
 public:
+	CAssParser();
+
 	S3DModel* Load(const std::string& modelFileName);
 	ModelType GetType() const { return MODELTYPE_ASS; }
 
@@ -77,6 +79,9 @@ private:
 	static void CalculateModelProperties(S3DModel* model, const LuaTable& pieceTable);
 	static void FindTextures(S3DModel* model, const aiScene* scene, const LuaTable& pieceTable, const std::string& modelPath, const std::string& modelName);
 	static bool SetModelRadiusAndHeight(S3DModel* model, const SAssPiece* piece, const aiNode* pieceNode, const LuaTable& pieceTable);
+
+	int maxIndices;
+	int maxVertices;
 };
 
 #endif /* ASS_PARSER_H */
@@ -11,17 +11,22 @@
 #include "S3OParser.h"
 #include "OBJParser.h"
 #include "AssParser.h"
+#include "Rendering/Textures/S3OTextureHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Util.h"
 #include "System/Log/ILog.h"
 #include "System/Exceptions.h"
+#include "System/ThreadPool.h"
 #include "lib/gml/gml_base.h"
 #include "lib/assimp/include/assimp/Importer.hpp"
 
 C3DModelLoader* modelParser = NULL;
 
+CONFIG(bool, ModelDisplayLists).defaultValue(true).description("Compile model pieces into display lists. If disabled, pieces are drawn directly from their vertex buffers, which is faster with drivers that emulate display lists poorly (e.g. core-profile ones).");
+
 
 static inline S3DModelPiece* ModelTypeToModelPiece(const ModelType& type) {
 	if (type == MODELTYPE_3DO) { return (new S3DOPiece()); }
@@ -74,6 +79,9 @@ static void RegisterAssimpModelFormats(C3DModelLoader::FormatMap& formats) {
 
 
 C3DModelLoader::C3DModelLoader()
+	// with deferred list creation (GML) a zero list ID means "not ready yet",
+	// pieces might then get drawn before their VBOs were uploaded
+	: useDisplayLists(configHandler->GetBool("ModelDisplayLists") || (GML::SimEnabled() && !GML::ShareLists()))
 {
 	// file-extension should be lowercase
 	formats["3do"] = MODELTYPE_3DO;
@@ -193,7 +201,6 @@ S3DModel* C3DModelLoader::Load3DModel(std::string modelName)
 
 	// search in cache first
 	ModelMap::iterator ci;
-	FormatMap::iterator fi;
 
 	if ((ci = cache.find(modelName)) != cache.end()) {
 		return models[ci->second];
@@ -205,24 +212,108 @@ S3DModel* C3DModelLoader::Load3DModel(std::string modelName)
 		return models[ci->second];
 	}
 
-
 	// not found in cache, create the model and cache it
-	const std::string& fileExt = StringToLower(FileSystem::GetExtension(modelPath));
-
-	if ((fi = formats.find(fileExt)) != formats.end()) {
-		IModelParser* p = parsers[fi->second];
-		S3DModel* model = NULL;
-		S3DModelPiece* root = NULL;
-
-		try {
-			model = p->Load(modelPath);
-		} catch (const content_error& ex) {
-			LOG_L(L_WARNING, "could not load model \"%s\" (reason: %s)", modelName.c_str(), ex.what());
-			goto dummy;
+	std::string loadError;
+	S3DModel* model = ParseModel(modelPath, loadError);
+
+	return (FinalizeModel(model, modelName, modelPath, loadError));
+}
+
+
+void C3DModelLoader::PreloadModels(const std::vector<std::string>& modelNames)
+{
+	GML_RECMUTEX_LOCK(model); // PreloadModels
+
+	std::vector<std::string> names;
+	std::vector<std::string> paths;
+	std::set<std::string> uniquePaths;
+
+	for (std::vector<std::string>::const_iterator it = modelNames.begin(); it != modelNames.end(); ++it) {
+		const std::string& modelName = StringToLower(*it);
+
+		if (modelName.empty() || cache.find(modelName) != cache.end())
+			continue;
+
+		const std::string& modelPath = FindModelPath(modelName);
+
+		if (cache.find(modelPath) != cache.end())
+			continue;
+		if (!uniquePaths.insert(modelPath).second)
+			continue;
+
+		names.push_back(modelName);
+		paths.push_back(modelPath);
+	}
+
+	std::vector<S3DModel*> parsedModels(paths.size(), NULL);
+	std::vector<std::string> loadErrors(paths.size());
+	std::vector<int> parallelModels;
+
+	parallelModels.reserve(paths.size());
+
+	for (unsigned int n = 0; n < paths.size(); n++) {
+		const FormatMap::const_iterator fi = formats.find(StringToLower(FileSystem::GetExtension(paths[n])));
+
+		// the 3DO parser keeps its current file in members
+		if (fi != formats.end() && fi->second == MODELTYPE_3DO) {
+			parsedModels[n] = ParseModel(paths[n], loadErrors[n]);
+		} else {
+			parallelModels.push_back(n);
 		}
+	}
 
-		if ((root = model->GetRootPiece()) != NULL) {
-			CreateLists(root);
+	for_mt(0, parallelModels.size(), [&](const int i) {
+		const int n = parallelModels[i];
+		parsedModels[n] = ParseModel(paths[n], loadErrors[n]);
+	});
+
+	std::vector<const S3DModel*> texturedModels;
+
+	for (unsigned int n = 0; n < paths.size(); n++) {
+		if (parsedModels[n] != NULL && parsedModels[n]->type != MODELTYPE_3DO) {
+			texturedModels.push_back(parsedModels[n]);
+		}
+	}
+
+	// decode their textures in parallel too, FinalizeModel then finds them
+	texturehandlerS3O->PreloadS3OTextures(texturedModels);
+
+	for (unsigned int n = 0; n < paths.size(); n++) {
+		FinalizeModel(parsedModels[n], names[n], paths[n], loadErrors[n]);
+	}
+
+	LOG("[%s] loaded %u models (%u in parallel)", __FUNCTION__, (unsigned int) paths.size(), (unsigned int) parallelModels.size());
+}
+
+
+S3DModel* C3DModelLoader::ParseModel(const std::string& modelPath, std::string& loadError) const
+{
+	const FormatMap::const_iterator fi = formats.find(StringToLower(FileSystem::GetExtension(modelPath)));
+
+	// unknown format, leaves loadError empty
+	if (fi == formats.end())
+		return NULL;
+
+	try {
+		return (parsers.find(fi->second)->second->Load(modelPath));
+	} catch (const content_error& ex) {
+		loadError = ex.what();
+	}
+
+	return NULL;
+}
+
+
+S3DModel* C3DModelLoader::FinalizeModel(S3DModel* model, const std::string& modelName, const std::string& modelPath, const std::string& loadError)
+{
+	if (model != NULL) {
+		// needs GL, hence not done by the parsers
+		if (model->type != MODELTYPE_3DO) {
+			texturehandlerS3O->LoadS3OTexture(model);
+		}
+
+		if (model->GetRootPiece() != NULL) {
+			CreateLists(model->GetRootPiece());
 		}
 
 		AddModelToCache(model, modelName, modelPath);
@@ -230,11 +321,14 @@ S3DModel* C3DModelLoader::Load3DModel(std::string modelName)
 		return model;
 	}
 
-	LOG_L(L_ERROR, "could not find a parser for model \"%s\" (unknown format?)", modelName.c_str());
+	if (loadError.empty()) {
+		LOG_L(L_ERROR, "could not find a parser for model \"%s\" (unknown format?)", modelName.c_str());
+	} else {
+		LOG_L(L_WARNING, "could not load model \"%s\" (reason: %s)", modelName.c_str(), loadError.c_str());
+	}
 
-dummy:
 	// crash-dummy
-	S3DModel* model = new S3DModel();
+	model = new S3DModel();
 	model->type = MODELTYPE_3DO;
 	model->numPieces = 1;
 	// give it one dummy piece
@@ -314,9 +408,13 @@ void C3DModelLoader::DeleteLocalModel(LocalModel* localModel)
 
 void C3DModelLoader::CreateListsNow(S3DModelPiece* o)
 {
+	// pack the whole model first so its pieces share one pair of buffers
+	if (o->parent == NULL)
+		o->UploadSharedGeometryVBOs();
+
 	o->UploadGeometryVBOs();
 
-	const unsigned int dlistID = o->CreateDrawForList();
+	const unsigned int dlistID = useDisplayLists? o->CreateDrawForList(): 0;
 
 	for (unsigned int n = 0; n < o->GetChildCount(); n++) {
 		CreateListsNow(o->GetChild(n));
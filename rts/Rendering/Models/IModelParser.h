@@ -6,6 +6,7 @@
 #include <map>
 #include <string>
 #include <list>
+#include <vector>
 
 #include "System/Matrix44f.h"
 #include "3DModel.h"
@@ -32,11 +33,22 @@ public:
 	std::string FindModelPath(std::string name) const;
 	S3DModel* Load3DModel(std::string modelName);
 
+	/**
+	 * Loads all given (not yet cached) models at once, parsing them in
+	 * parallel; textures and display lists are still created serially by
+	 * the calling thread.
+	 */
+	void PreloadModels(const std::vector<std::string>& modelNames);
+
 	typedef std::map<std::string, unsigned int> ModelMap; // "armflash.3do" --> id
 	typedef std::map<std::string, unsigned int> FormatMap; // "3do" --> MODELTYPE_3DO
 	typedef std::map<unsigned int, IModelParser*> ParserMap; // MODELTYPE_3DO --> parser
 
 private:
+	/// thread-safe for all but 3DO models, returns NULL on failure
+	S3DModel* ParseModel(const std::string& modelPath, std::string& loadError) const;
+	S3DModel* FinalizeModel(S3DModel* model, const std::string& modelName, const std::string& modelPath, const std::string& loadError);
+
 	void AddModelToCache(S3DModel* model, const std::string& modelName, const std::string& modelPath);
 	void CreateLists(S3DModelPiece* o);
 	void CreateListsNow(S3DModelPiece* o);
@@ -50,6 +62,9 @@ private:
 
 	std::list<LocalModel*> fixLocalModels;
 	std::list<LocalModel*> deleteLocalModels;
+
+	/// if false, pieces get no display lists and draw from their VBOs
+	bool useDisplayLists;
 };
 
 extern C3DModelLoader* modelParser;
@@ -6,7 +6,6 @@
 
 #include "Lua/LuaParser.h"
 #include "Rendering/GL/VertexArray.h"
-#include "Rendering/Textures/S3OTextureHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
@@ -62,9 +61,6 @@ S3DModel* COBJParser::Load(const std::string& modelFileName)
 		model->mins = DEF_MIN_SIZE;
 		model->maxs = DEF_MAX_SIZE;
 
-	// basic S3O-style texturing
-	texturehandlerS3O->LoadS3OTexture(model);
-
 	std::string modelData;
 	modelFile.LoadStringData(modelData);
 
@@ -8,7 +8,6 @@
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GlobalRendering.h"
-#include "Rendering/Textures/S3OTextureHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "System/Exceptions.h"
@@ -38,7 +37,6 @@ S3DModel* CS3OParser::Load(const std::string& name)
 		model->tex2 = (char*) &fileBuf[header.texture2];
 		model->mins = DEF_MIN_SIZE;
 		model->maxs = DEF_MAX_SIZE;
-	texturehandlerS3O->LoadS3OTexture(model);
 
 	SS3OPiece* rootPiece = LoadPiece(model, NULL, fileBuf, header.rootPiece);
 
@@ -131,9 +129,32 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned ch
 
 
 
+bool SS3OPiece::AppendGeometry(std::vector<unsigned char>& attribs, std::vector<unsigned int>& indices)
+{
+	if (!hasGeometryData || vertices.empty())
+		return false;
+
+	vertexOffset = attribs.size() / sizeof(SS3OVertex);
+	indexOffset = indices.size();
+
+	const unsigned char* data = reinterpret_cast<const unsigned char*>(&vertices[0]);
+	attribs.insert(attribs.end(), data, data + vertices.size() * sizeof(SS3OVertex));
+
+	indices.reserve(indices.size() + vertexDrawIndices.size());
+
+	for (unsigned int n = 0; n < vertexDrawIndices.size(); n++) {
+		const unsigned int idx = vertexDrawIndices[n];
+
+		// keep the strip restart index as is
+		indices.push_back((idx == -1U)? idx: (idx + vertexOffset));
+	}
+
+	return true;
+}
+
 void SS3OPiece::UploadGeometryVBOs()
 {
-	if (!hasGeometryData)
+	if (!hasGeometryData || sharedGeometry)
 		return;
 
 	//FIXME share 1 VBO for ALL models
@@ -155,34 +176,40 @@ void SS3OPiece::DrawForList() const
 	if (!hasGeometryData)
 		return;
 	
-	vboAttributes.Bind(GL_ARRAY_BUFFER);
+	// indices are rebased to the start of the (possibly shared) buffer
+	geomAttributes->Bind(GL_ARRAY_BUFFER);
 		glEnableClientState(GL_VERTEX_ARRAY);
-		glVertexPointer(3, GL_FLOAT, sizeof(SS3OVertex), vboAttributes.GetPtr(offsetof(SS3OVertex, pos)));
+		glVertexPointer(3, GL_FLOAT, sizeof(SS3OVertex), geomAttributes->GetPtr(offsetof(SS3OVertex, pos)));
 
 		glEnableClientState(GL_NORMAL_ARRAY);
-		glNormalPointer(GL_FLOAT, sizeof(SS3OVertex), vboAttributes.GetPtr(offsetof(SS3OVertex, normal)));
+		glNormalPointer(GL_FLOAT, sizeof(SS3OVertex), geomAttributes->GetPtr(offsetof(SS3OVertex, normal)));
 
 		glClientActiveTexture(GL_TEXTURE0);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(SS3OVertex), vboAttributes.GetPtr(offsetof(SS3OVertex, texCoord)));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(SS3OVertex), geomAttributes->GetPtr(offsetof(SS3OVertex, texCoord)));
 
 		glClientActiveTexture(GL_TEXTURE1);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(SS3OVertex), vboAttributes.GetPtr(offsetof(SS3OVertex, texCoord)));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(SS3OVertex), geomAttributes->GetPtr(offsetof(SS3OVertex, texCoord)));
 
 		glClientActiveTexture(GL_TEXTURE5);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(3, GL_FLOAT, sizeof(SS3OVertex), vboAttributes.GetPtr(offsetof(SS3OVertex, sTangent)));
+		glTexCoordPointer(3, GL_FLOAT, sizeof(SS3OVertex), geomAttributes->GetPtr(offsetof(SS3OVertex, sTangent)));
 
 		glClientActiveTexture(GL_TEXTURE6);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(3, GL_FLOAT, sizeof(SS3OVertex), vboAttributes.GetPtr(offsetof(SS3OVertex, tTangent)));
-	vboAttributes.Unbind();
+		glTexCoordPointer(3, GL_FLOAT, sizeof(SS3OVertex), geomAttributes->GetPtr(offsetof(SS3OVertex, tTangent)));
+	geomAttributes->Unbind();
+
+	const GLuint minIndex = vertexOffset;
+	const GLuint maxIndex = vertexOffset + vertices.size() - 1;
+
+	geomIndices->Bind(GL_ELEMENT_ARRAY_BUFFER);
+	const GLvoid* indexPtr = geomIndices->GetPtr(indexOffset * sizeof(unsigned int));
 
-	vboIndices.Bind(GL_ELEMENT_ARRAY_BUFFER);
 	switch (primType) {
 		case S3O_PRIMTYPE_TRIANGLES: {
-			glDrawRangeElements(GL_TRIANGLES, 0, vertices.size() - 1, vertexDrawIndices.size(), GL_UNSIGNED_INT, vboIndices.GetPtr());
+			glDrawRangeElements(GL_TRIANGLES, minIndex, maxIndex, vertexDrawIndices.size(), GL_UNSIGNED_INT, indexPtr);
 		} break;
 		case S3O_PRIMTYPE_TRIANGLE_STRIP: {
 			#ifdef GLEW_NV_primitive_restart
@@ -193,7 +220,7 @@ void SS3OPiece::DrawForList() const
 			}
 			#endif
 
-			glDrawRangeElements(GL_TRIANGLE_STRIP, 0, vertices.size() - 1, vertexDrawIndices.size(), GL_UNSIGNED_INT, vboIndices.GetPtr());
+			glDrawRangeElements(GL_TRIANGLE_STRIP, minIndex, maxIndex, vertexDrawIndices.size(), GL_UNSIGNED_INT, indexPtr);
 
 			#ifdef GLEW_NV_primitive_restart
 			if (globalRendering->supportRestartPrimitive) {
@@ -202,10 +229,10 @@ void SS3OPiece::DrawForList() const
 			#endif
 		} break;
 		case S3O_PRIMTYPE_QUADS: {
-			glDrawRangeElements(GL_QUADS, 0, vertices.size() - 1, vertexDrawIndices.size(), GL_UNSIGNED_INT, vboIndices.GetPtr());
+			glDrawRangeElements(GL_QUADS, minIndex, maxIndex, vertexDrawIndices.size(), GL_UNSIGNED_INT, indexPtr);
 		} break;
 	}
-	vboIndices.Unbind();
+	geomIndices->Unbind();
 
 	glClientActiveTexture(GL_TEXTURE6);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -27,6 +27,7 @@ struct SS3OPiece: public S3DModelPiece {
 	}
 
 	void UploadGeometryVBOs();
+	bool AppendGeometry(std::vector<unsigned char>& attribs, std::vector<unsigned int>& indices);
 	void DrawForList() const;
 
 	void SetVertexCount(unsigned int n) { vertices.resize(n); }
@@ -174,19 +174,44 @@ void IWorldObjectModelRenderer::SwapFeatures()
 	std::swap(numFeatures, numFeaturesSave);
 }
 
+bool IWorldObjectModelRenderer::AddToProjectileBin(std::vector<CProjectile*>& bin, CProjectile* p)
+{
+	if (p->drawBinIndex < bin.size() && bin[p->drawBinIndex] == p)
+		return false;
+
+	p->drawBinIndex = bin.size();
+	bin.push_back(p);
+	return true;
+}
+
+bool IWorldObjectModelRenderer::DelFromProjectileBin(std::vector<CProjectile*>& bin, CProjectile* p)
+{
+	const unsigned int idx = p->drawBinIndex;
+
+	if (idx >= bin.size() || bin[idx] != p)
+		return false;
+
+	bin[idx] = bin.back();
+	bin[idx]->drawBinIndex = idx;
+	bin.pop_back();
+
+	p->drawBinIndex = -1u;
+	return true;
+}
+
 void IWorldObjectModelRenderer::AddProjectile(const CProjectile* p)
 {
 	if (projectiles.find(TEX_TYPE(p)) == projectiles.end()) {
 		projectiles[TEX_TYPE(p)] = ProjectileSet();
 	}
 
-	if(projectiles[TEX_TYPE(p)].insert(const_cast<CProjectile*>(p)).second)
+	if (AddToProjectileBin(projectiles[TEX_TYPE(p)], const_cast<CProjectile*>(p)))
 		numProjectiles += 1;
 }
 
 void IWorldObjectModelRenderer::DelProjectile(const CProjectile* p)
 {
-	if(projectiles[TEX_TYPE(p)].erase(const_cast<CProjectile*>(p)))
+	if (DelFromProjectileBin(projectiles[TEX_TYPE(p)], const_cast<CProjectile*>(p)))
 		numProjectiles -= 1;
 
 	if (projectiles[TEX_TYPE(p)].empty()) {
@@ -8,6 +8,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include "Rendering/Models/3DModel.h"
 
@@ -39,6 +40,12 @@ public:
 	virtual void AddProjectile(const CProjectile*);
 	virtual void DelProjectile(const CProjectile*);
 
+	// projectiles are created and destroyed far more often than units or
+	// features, so their bins are vectors with O(1) swap-removal (indexed
+	// by CProjectile::drawBinIndex) rather than sets
+	static bool AddToProjectileBin(std::vector<CProjectile*>& bin, CProjectile* p);
+	static bool DelFromProjectileBin(std::vector<CProjectile*>& bin, CProjectile* p);
+
 	int GetNumUnits() const { return numUnits; }
 	int GetNumFeatures() const { return numFeatures; }
 	int GetNumProjectiles() const { return numProjectiles; }
@@ -48,8 +55,8 @@ protected:
 	typedef std::set<CUnit*>::const_iterator       UnitSetIt;
 	typedef std::map<CFeature*, float>                 FeatureSet;
 	typedef std::map<CFeature*, float>::const_iterator FeatureSetIt;
-	typedef std::set<CProjectile*>                 ProjectileSet;
-	typedef std::set<CProjectile*>::const_iterator ProjectileSetIt;
+	typedef std::vector<CProjectile*>                 ProjectileSet;
+	typedef std::vector<CProjectile*>::const_iterator ProjectileSetIt;
 
 	// textureType ==> modelSet
 	typedef std::map<int, UnitSet>                       UnitRenderBin;
@@ -9,6 +9,7 @@
 #include "Lua/LuaParser.h"
 #include "Lua/LuaRules.h"
 #include "Map/MapInfo.h"
+#include "Rendering/Colors.h"
 #include "Rendering/GroundFlash.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/ShadowHandler.h"
@@ -22,6 +23,7 @@
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "Rendering/Textures/TextureAtlas.h"
 #include "Rendering/Models/WorldObjectModelRenderer.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
@@ -35,8 +37,11 @@
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
+#include "System/myMath.h"
 #include "System/Util.h"
 
+#include <algorithm>
+
 
 
 CProjectileDrawer* projectileDrawer = NULL;
@@ -406,7 +411,7 @@ void CProjectileDrawer::LoadWeaponTextures() {
 
 void CProjectileDrawer::DrawProjectiles(int modelType, int numFlyingPieces, int* drawnPieces, bool drawReflection, bool drawRefraction)
 {
-	typedef std::set<CProjectile*> ProjectileSet;
+	typedef std::vector<CProjectile*> ProjectileSet;
 	typedef std::map<int, ProjectileSet> ProjectileBin;
 	//typedef ProjectileSet::iterator ProjectileSetIt;
 	typedef ProjectileBin::iterator ProjectileBinIt;
@@ -424,9 +429,9 @@ void CProjectileDrawer::DrawProjectiles(int modelType, int numFlyingPieces, int*
 	DrawFlyingPieces(modelType, numFlyingPieces, drawnPieces);
 }
 
-void CProjectileDrawer::DrawProjectilesSet(std::set<CProjectile*>& projectiles, bool drawReflection, bool drawRefraction)
+void CProjectileDrawer::DrawProjectilesSet(std::vector<CProjectile*>& projectiles, bool drawReflection, bool drawRefraction)
 {
-	for (std::set<CProjectile*>::iterator setIt = projectiles.begin(); setIt != projectiles.end(); ++setIt) {
+	for (std::vector<CProjectile*>::iterator setIt = projectiles.begin(); setIt != projectiles.end(); ++setIt) {
 		DrawProjectile(*setIt, drawReflection, drawRefraction);
 	}
 }
@@ -435,10 +440,24 @@ void CProjectileDrawer::DrawProjectile(CProjectile* pro, bool drawReflection, bo
 {
 	const CUnit* owner = pro->owner();
 
+	// number of sim frames since the projectile was last moved
+	float timeInterp = globalRendering->timeOffset;
+
 	if (GML::SimEnabled()) {
-		pro->drawPos = pro->pos + (pro->speed * (spring_tomsecs(globalRendering->lastFrameStart)*1.0f - pro->lastProjUpdate*1.0f) * globalRendering->weightedSpeedFactor);
+		timeInterp = (spring_tomsecs(globalRendering->lastFrameStart)*1.0f - pro->lastProjUpdate*1.0f) * globalRendering->weightedSpeedFactor;
+	}
+
+	if (globalRendering->interpolateDrawPos) {
+		// see CUnitDrawer::UpdateUnitDrawPos
+		const float3 frameDelta = pro->pos - pro->preFramePos;
+
+		if (frameDelta.SqLength() <= (pro->speed.SqLength() * 4.0f + 1.0f)) {
+			pro->drawPos = pro->preFramePos + frameDelta * Clamp(timeInterp, 0.0f, 1.0f);
+		} else {
+			pro->drawPos = pro->pos;
+		}
 	} else {
-		pro->drawPos = pro->pos + (pro->speed * globalRendering->timeOffset);
+		pro->drawPos = pro->pos + (pro->speed * timeInterp);
 	}
 
 	const bool visible = (gu->spectatingFullView || losHandler->InLos(pro, gu->myAllyTeam) || (owner && teamHandler->Ally(owner->allyteam, gu->myAllyTeam)));
@@ -468,14 +487,14 @@ void CProjectileDrawer::DrawProjectile(CProjectile* pro, bool drawReflection, bo
 	DrawProjectileModel(pro, false);
 
 	pro->tempdist = pro->pos.dot(camera->forward);
-	zSortedProjectiles.insert(pro);
+	zSortedProjectiles.push_back(pro);
 }
 
 
 
 void CProjectileDrawer::DrawProjectilesShadow(int modelType)
 {
-	typedef std::map<int, std::set<CProjectile*> > ProjectileBin;
+	typedef std::map<int, std::vector<CProjectile*> > ProjectileBin;
 	typedef ProjectileBin::iterator ProjectileBinIt;
 
 	ProjectileBin& projectileBin = modelRenderers[modelType]->GetProjectileBinMutable();
@@ -485,9 +504,9 @@ void CProjectileDrawer::DrawProjectilesShadow(int modelType)
 	}
 }
 
-void CProjectileDrawer::DrawProjectilesSetShadow(std::set<CProjectile*>& projectiles)
+void CProjectileDrawer::DrawProjectilesSetShadow(std::vector<CProjectile*>& projectiles)
 {
-	for (std::set<CProjectile*>::iterator setIt = projectiles.begin(); setIt != projectiles.end(); ++setIt) {
+	for (std::vector<CProjectile*>::iterator setIt = projectiles.begin(); setIt != projectiles.end(); ++setIt) {
 		DrawProjectileShadow(*setIt);
 	}
 }
@@ -519,8 +538,8 @@ void CProjectileDrawer::DrawProjectilesMiniMap()
 {
 	GML_RECMUTEX_LOCK(proj); // DrawProjectilesMiniMap
 
-	typedef std::set<CProjectile*> ProjectileSet;
-	typedef std::set<CProjectile*>::const_iterator ProjectileSetIt;
+	typedef std::vector<CProjectile*> ProjectileSet;
+	typedef std::vector<CProjectile*>::const_iterator ProjectileSetIt;
 	typedef std::map<int, ProjectileSet> ProjectileBin;
 	typedef std::map<int, ProjectileSet>::const_iterator ProjectileBinIt;
 
@@ -565,7 +584,7 @@ void CProjectileDrawer::DrawProjectilesMiniMap()
 		points->Initialize();
 		points->EnlargeArrays(renderProjectiles.size(), 0, VA_SIZE_C);
 
-		for (std::set<CProjectile*>::iterator it = renderProjectiles.begin(); it != renderProjectiles.end(); ++it) {
+		for (std::vector<CProjectile*>::iterator it = renderProjectiles.begin(); it != renderProjectiles.end(); ++it) {
 			CProjectile* p = *it;
 
 			const CUnit* owner = p->owner();
@@ -578,6 +597,71 @@ void CProjectileDrawer::DrawProjectilesMiniMap()
 		lines->DrawArrayC(GL_LINES);
 		points->DrawArrayC(GL_POINTS);
 	}
+
+	DrawNanoParticlesMiniMap();
+}
+
+void CProjectileDrawer::DrawNanoParticles(bool drawReflection, bool drawRefraction)
+{
+	GML_STDMUTEX_LOCK(rpiece); // DrawNanoParticles
+
+	const std::vector<NanoParticle>& particles = projectileHandler->nanoParticles;
+
+	if (particles.empty())
+		return;
+
+	const float drawRadius = 3.0f;
+	const float3 dx = camera->right * drawRadius;
+	const float3 dy = camera->up * drawRadius;
+
+	CVertexArray* va = CProjectile::va;
+	va->EnlargeArrays(particles.size() * 4, 0, VA_SIZE_TC);
+
+	for (std::vector<NanoParticle>::const_iterator it = particles.begin(); it != particles.end(); ++it) {
+		const NanoParticle& p = *it;
+		// particles move by <speed> once per frame, starting with their creation frame
+		const float3 pos = p.startPos + p.speed * ((gs->frameNum - p.creationFrame + 1) + globalRendering->timeOffset);
+
+		if (!gu->spectatingFullView && !losHandler->InLos(pos, gu->myAllyTeam))
+			continue;
+		if (!camera->InView(pos, drawRadius))
+			continue;
+		if (drawReflection && pos.y < -drawRadius)
+			continue;
+		if (drawRefraction && pos.y > drawRadius)
+			continue;
+
+		va->AddVertexQTC(pos - dx - dy, gfxtex->xstart, gfxtex->ystart, p.color);
+		va->AddVertexQTC(pos + dx - dy, gfxtex->xend,   gfxtex->ystart, p.color);
+		va->AddVertexQTC(pos + dx + dy, gfxtex->xend,   gfxtex->yend,   p.color);
+		va->AddVertexQTC(pos - dx + dy, gfxtex->xstart, gfxtex->yend,   p.color);
+
+		CProjectile::inArray = true;
+	}
+}
+
+void CProjectileDrawer::DrawNanoParticlesMiniMap()
+{
+	GML_STDMUTEX_LOCK(rpiece); // DrawNanoParticlesMiniMap
+
+	const std::vector<NanoParticle>& particles = projectileHandler->nanoParticles;
+
+	if (particles.empty())
+		return;
+
+	CVertexArray* points = GetVertexArray();
+	points->Initialize();
+	points->EnlargeArrays(particles.size(), 0, VA_SIZE_C);
+
+	for (std::vector<NanoParticle>::const_iterator it = particles.begin(); it != particles.end(); ++it) {
+		const float3 pos = it->startPos + it->speed * (gs->frameNum - it->creationFrame + 1);
+
+		if (gu->spectatingFullView || losHandler->InLos(pos, gu->myAllyTeam)) {
+			points->AddVertexQC(pos, color4::green);
+		}
+	}
+
+	points->DrawArrayC(GL_POINTS);
 }
 
 void CProjectileDrawer::DrawFlyingPieces(int modelType, int numFlyingPieces, int* drawnPieces)
@@ -659,10 +743,17 @@ void CProjectileDrawer::Draw(bool drawReflection, bool drawRefraction) {
 		CProjectile::va = GetVertexArray();
 		CProjectile::va->Initialize();
 
+		// a single sort of the plain vector is much cheaper than
+		// keeping a tree ordered (and allocating a node for each
+		// projectile) while they are being collected
+		std::sort(zSortedProjectiles.begin(), zSortedProjectiles.end(), ProjectileDistanceComparator());
+
 		// draw the particle effects
-		for (std::set<CProjectile*, ProjectileDistanceComparator>::iterator it = zSortedProjectiles.begin(); it != zSortedProjectiles.end(); ++it) {
+		for (std::vector<CProjectile*>::iterator it = zSortedProjectiles.begin(); it != zSortedProjectiles.end(); ++it) {
 			(*it)->Draw();
 		}
+
+		DrawNanoParticles(drawReflection, drawRefraction);
 	}
 
 	glEnable(GL_BLEND);
@@ -678,9 +769,8 @@ void CProjectileDrawer::Draw(bool drawReflection, bool drawRefraction) {
 		glEnable(GL_ALPHA_TEST);
 		glDepthMask(GL_FALSE);
 
-		// note: nano-particles (CGfxProjectile instances) also
-		// contribute to the count, but have their own creation
-		// cutoff
+		// note: nano-particles also contribute to the count,
+		// but have their own creation cutoff
 		projectileHandler->currentParticles += CProjectile::DrawArray();
 	}
 
@@ -780,7 +870,9 @@ bool CProjectileDrawer::DrawProjectileModel(const CProjectile* p, bool shadowPas
 			glRotatef(pp->spinAngle, pp->spinVec.x, pp->spinVec.y, pp->spinVec.z);
 
 			if (!(/*p->luaDraw &&*/ luaRules != NULL && luaRules->DrawProjectile(p))) {
-				glCallList(pp->dispList);
+				if (pp->omp != NULL) {
+					pp->omp->DrawGeometry();
+				}
 			}
 		glPopMatrix();
 
@@ -994,7 +1086,7 @@ void CProjectileDrawer::RenderProjectileCreated(const CProjectile* p)
 	if (p->model) {
 		modelRenderers[MDL_TYPE(p)]->AddProjectile(p);
 	} else {
-		renderProjectiles.insert(const_cast<CProjectile*>(p));
+		IWorldObjectModelRenderer::AddToProjectileBin(renderProjectiles, const_cast<CProjectile*>(p));
 	}
 }
 
@@ -1003,6 +1095,6 @@ void CProjectileDrawer::RenderProjectileDestroyed(const CProjectile* const p)
 	if (p->model) {
 		modelRenderers[MDL_TYPE(p)]->DelProjectile(p);
 	} else {
-		renderProjectiles.erase(const_cast<CProjectile*>(p));
+		IWorldObjectModelRenderer::DelFromProjectileBin(renderProjectiles, const_cast<CProjectile*>(p));
 	}
 }
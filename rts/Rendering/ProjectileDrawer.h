@@ -6,6 +6,7 @@
 #include "Rendering/GL/myGL.h"
 #include <list>
 #include <set>
+#include <vector>
 
 #include "lib/gml/ThreadSafeContainers.h"
 #include "Rendering/GL/FBO.h"
@@ -104,12 +105,14 @@ private:
 	void ParseAtlasTextures(const bool, const LuaTable&, std::set<std::string>&, CTextureAtlas*);
 
 	void DrawProjectiles(int modelType, int numFlyingPieces, int* drawnPieces, bool drawReflection, bool drawRefraction);
-	void DrawProjectilesSet(std::set<CProjectile*>& projectiles, bool drawReflection, bool drawRefraction);
+	void DrawProjectilesSet(std::vector<CProjectile*>& projectiles, bool drawReflection, bool drawRefraction);
 	void DrawProjectile(CProjectile* projectile, bool drawReflection, bool drawRefraction);
 	void DrawProjectilesShadow(int modelType);
 	void DrawProjectileShadow(CProjectile* projectile);
-	void DrawProjectilesSetShadow(std::set<CProjectile*>& projectiles);
+	void DrawProjectilesSetShadow(std::vector<CProjectile*>& projectiles);
 	void DrawFlyingPieces(int modelType, int numFlyingPieces, int* drawnPieces);
+	void DrawNanoParticles(bool drawReflection, bool drawRefraction);
+	void DrawNanoParticlesMiniMap();
 
 	void UpdatePerlin();
 	void GenerateNoiseTex(unsigned int tex, int size);
@@ -120,16 +123,17 @@ private:
 	int perlinTexObjects;
 	bool drawPerlinTex;
 
-	/// projectiles without a model
-	std::set<CProjectile*> renderProjectiles;
+	/// projectiles without a model, see IWorldObjectModelRenderer::AddToProjectileBin
+	std::vector<CProjectile*> renderProjectiles;
 	/// projectiles with a model
 	std::vector<IWorldObjectModelRenderer*> modelRenderers;
 
 	/**
-	 * z-sorted set of all projectiles; used to
-	 * render particle effects in back-to-front order
+	 * all projectiles that passed the visibility tests this frame; sorted
+	 * (once, after they are all collected) with ProjectileDistanceComparator
+	 * to render particle effects in back-to-front order
 	 */
-	std::set<CProjectile*, ProjectileDistanceComparator> zSortedProjectiles;
+	std::vector<CProjectile*> zSortedProjectiles;
 };
 
 extern CProjectileDrawer* projectileDrawer;
@@ -2,12 +2,15 @@
 
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/Shaders/GLSLCopyState.h"
+#include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GlobalRendering.h"
+#include "System/CRC.h"
 #include "System/Util.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
 #include <algorithm>
+#include <cstring>
 
 
 #define LOG_SECTION_SHADER "Shader"
@@ -179,6 +182,15 @@ namespace Shader {
 		};
 		const GLint lengths[7] = {-1, -1, -1, -1, -1, -1, -1};
 
+		CRC crc;
+		crc << type;
+
+		for (unsigned int n = 0; n < 7; n++) {
+			crc.Update(sources[n], strlen(sources[n]));
+		}
+
+		srcHash = crc.GetDigest();
+
 		if (objID == 0)
 			objID = glCreateShader(type);
 
@@ -391,6 +403,22 @@ namespace Shader {
 		if (!glIsProgram(objID))
 			return;
 
+		CRC crc;
+
+		for (SOVecConstIt it = shaderObjs.begin(); it != shaderObjs.end(); ++it) {
+			if ((*it)->IsValid()) {
+				crc << (*it)->GetSrcHash();
+			}
+		}
+
+		const unsigned int srcHash = crc.GetDigest();
+
+		if (shaderHandler->LoadProgramBinary(objID, srcHash)) {
+			valid = true;
+			return;
+		}
+
+		shaderHandler->PrepareProgramBinary(objID);
 		glLinkProgram(objID);
 
 		valid = glslIsValid(objID);
@@ -398,6 +426,8 @@ namespace Shader {
 
 		if (!IsValid()) {
 			LOG_L(L_WARNING, "[GLSL-PO::%s] program-object name: %s, link-log:\n%s\n", __FUNCTION__, name.c_str(), log.c_str());
+		} else {
+			shaderHandler->SaveProgramBinary(objID, srcHash);
 		}
 	}
 
@@ -29,7 +29,7 @@ namespace Shader {
 	struct IShaderObject {
 	public:
 		IShaderObject(unsigned int shType, const std::string& shSrcFile, const std::string& shSrcDefs = ""):
-			objID(0), type(shType), valid(false), srcFile(shSrcFile), rawDefStrs(shSrcDefs) {
+			objID(0), type(shType), srcHash(0), valid(false), srcFile(shSrcFile), rawDefStrs(shSrcDefs) {
 		}
 
 		virtual ~IShaderObject() {}
@@ -38,6 +38,8 @@ namespace Shader {
 		virtual void Release() {}
 		unsigned int GetObjID() const { return objID; }
 		unsigned int GetType() const { return type; }
+		/// checksum of the complete source (definitions included) last compiled
+		unsigned int GetSrcHash() const { return srcHash; }
 		bool IsValid() const { return valid; }
 		const std::string& GetLog() const { return log; }
 
@@ -46,6 +48,7 @@ namespace Shader {
 	protected:
 		unsigned int objID;
 		unsigned int type;
+		unsigned int srcHash;
 
 		bool valid;
 
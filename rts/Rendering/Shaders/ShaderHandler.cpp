@@ -4,10 +4,55 @@
 
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/GlobalRendering.h"
+#include "System/CRC.h"
 #include "System/Log/ILog.h"
 #include "System/Util.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 
+#include <boost/cstdint.hpp>
 #include <cassert>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+CONFIG(bool, ShaderCache).defaultValue(true).description("Store linked GLSL programs in the cache directory (keyed by their sources and the graphics driver) and load them from there on later runs instead of linking them again. Needs GL_ARB_get_program_binary.");
+
+
+struct ProgramBinaryHeader {
+	char magic[8];
+	boost::uint32_t srcHash;
+	boost::uint32_t format;
+	boost::uint32_t length;
+};
+
+static const char PROGRAM_BINARY_MAGIC[8] = {'S', 'P', 'R', 'G', 'P', 'B', '0', '1'};
+
+static std::string GetProgramBinaryDir()
+{
+	return (FileSystem::GetCacheDir() + "/shaders/");
+}
+
+static std::string GetProgramBinaryFileName(unsigned int srcHash)
+{
+	// a driver update can change (or invalidate) the binary format
+	const GLenum glStrings[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+
+	CRC crc;
+	crc << srcHash;
+
+	for (unsigned int n = 0; n < 3; n++) {
+		const char* str = (const char*) glGetString(glStrings[n]);
+
+		if (str != NULL) {
+			crc.Update(str, strlen(str));
+		}
+	}
+
+	return (GetProgramBinaryDir() + IntToString(crc.GetDigest(), "%08x") + ".bin");
+}
 
 
 CShaderHandler* CShaderHandler::GetInstance() {
@@ -129,3 +174,99 @@ Shader::IShaderObject* CShaderHandler::CreateShaderObject(const std::string& soN
 	so->Compile(true);
 	return so;
 }
+
+
+
+bool CShaderHandler::UseProgramBinaries() const {
+#if !defined(HEADLESS) && defined(GL_ARB_get_program_binary)
+	return (GLEW_ARB_get_program_binary && configHandler->GetBool("ShaderCache"));
+#else
+	return false;
+#endif
+}
+
+void CShaderHandler::PrepareProgramBinary(unsigned int progID) const {
+#if !defined(HEADLESS) && defined(GL_ARB_get_program_binary)
+	if (!UseProgramBinaries())
+		return;
+
+	glProgramParameteri(progID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+}
+
+bool CShaderHandler::LoadProgramBinary(unsigned int progID, unsigned int srcHash) const {
+#if !defined(HEADLESS) && defined(GL_ARB_get_program_binary)
+	if (!UseProgramBinaries())
+		return false;
+
+	std::ifstream file(dataDirsAccess.LocateFile(GetProgramBinaryFileName(srcHash)).c_str(), std::ios::in | std::ios::binary);
+
+	if (!file.good())
+		return false;
+
+	ProgramBinaryHeader header;
+	std::vector<char> binary;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+	if (memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) != 0)
+		return false;
+	if (header.srcHash != srcHash || header.length == 0)
+		return false;
+
+	binary.resize(header.length);
+
+	if (!file.read(&binary[0], binary.size()))
+		return false;
+
+	// on failure the program is left unlinked and the caller links it
+	// from its attached shader objects as if there were no cache entry
+	GLint linked = GL_FALSE;
+
+	glProgramBinary(progID, header.format, &binary[0], binary.size());
+	glGetProgramiv(progID, GL_LINK_STATUS, &linked);
+
+	return (linked == GL_TRUE);
+#else
+	return false;
+#endif
+}
+
+void CShaderHandler::SaveProgramBinary(unsigned int progID, unsigned int srcHash) const {
+#if !defined(HEADLESS) && defined(GL_ARB_get_program_binary)
+	if (!UseProgramBinaries())
+		return;
+
+	GLint length = 0;
+	GLenum format = 0;
+
+	glGetProgramiv(progID, GL_PROGRAM_BINARY_LENGTH, &length);
+
+	if (length <= 0)
+		return;
+
+	std::vector<char> binary(length);
+	glGetProgramBinary(progID, length, &length, &format, &binary[0]);
+
+	if (length <= 0)
+		return;
+	if (!FileSystem::CreateDirectory(GetProgramBinaryDir()))
+		return;
+
+	const std::string fileName = dataDirsAccess.LocateFile(GetProgramBinaryFileName(srcHash), FileQueryFlags::WRITE);
+	std::ofstream file(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+	ProgramBinaryHeader header;
+	memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+	header.srcHash = srcHash;
+	header.format = format;
+	header.length = length;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(&binary[0], length);
+
+	if (!file.good()) {
+		LOG_L(L_WARNING, "[%s] could not write program binary \"%s\"", __FUNCTION__, fileName.c_str());
+	}
+#endif
+}
@@ -25,6 +25,20 @@ public:
 	 */
 	Shader::IShaderObject* CreateShaderObject(const std::string& soName, const std::string& soDefs, int soType);
 
+	/**
+	 * Binary cache for linked GLSL programs (GL_ARB_get_program_binary).
+	 * @param srcHash must cover every source and definition that went
+	 *        into the program; the GL driver strings are added here
+	 * PrepareProgramBinary must be called before a program is linked
+	 * for SaveProgramBinary to be able to retrieve it afterwards, and
+	 * LoadProgramBinary returns true only if the program ended up being
+	 * successfully linked from the cached binary.
+	 */
+	bool UseProgramBinaries() const;
+	void PrepareProgramBinary(unsigned int progID) const;
+	bool LoadProgramBinary(unsigned int progID, unsigned int srcHash) const;
+	void SaveProgramBinary(unsigned int progID, unsigned int srcHash) const;
+
 private:
 	typedef std::map<std::string, Shader::IProgramObject*> ProgramObjMap;
 	typedef std::map<std::string, Shader::IProgramObject*>::iterator ProgramObjMapIt;
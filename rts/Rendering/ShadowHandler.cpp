@@ -1,10 +1,12 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <cfloat>
+#include <cstring>
 
 #include "ShadowHandler.h"
 #include "Game/Camera.h"
 #include "Game/GameVersion.h"
+#include "Game/GlobalUnsynced.h"
 #include "Map/BaseGroundDrawer.h"
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
@@ -19,6 +21,7 @@
 #include "Rendering/GL/VertexArray.h"
 #include "Rendering/Models/ModelDrawer.h"
 #include "Rendering/Shaders/ShaderHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Matrix44f.h"
@@ -30,6 +33,7 @@
 CONFIG(int, Shadows).defaultValue(2).minimumValue(0).description("Sets whether shadows are rendered.\n0:=off, 1:=full, 2:=fast (skip terrain)"); //FIXME document bitmask
 CONFIG(int, ShadowMapSize).defaultValue(CShadowHandler::DEF_SHADOWMAP_SIZE).minimumValue(32).description("Sets the resolution of shadows. Higher numbers increase quality at the cost of performance.");
 CONFIG(int, ShadowProjectionMode).defaultValue(CShadowHandler::SHADOWPROMODE_CAM_CENTER);
+CONFIG(bool, ShadowStaticCache).defaultValue(false).description("Keep the shadow depth of terrain and features in a separate cached layer that is only redrawn when they, the sun or the camera view change (or each sim-frame when not spectating with full view).");
 
 CShadowHandler* shadowHandler = NULL;
 
@@ -37,6 +41,20 @@ bool CShadowHandler::shadowsSupported = false;
 bool CShadowHandler::firstInit = true;
 
 
+CShadowHandler::CShadowHandler()
+	: CEventClient("[CShadowHandler]", 314159, false)
+{
+	eventHandler.AddClient(this);
+	Init();
+}
+
+CShadowHandler::~CShadowHandler()
+{
+	Kill();
+	eventHandler.RemoveClient(this);
+}
+
+
 void CShadowHandler::Reload(const char* argv)
 {
 	int nextShadowConfig = (shadowConfig + 1) & 0xF;
@@ -70,6 +88,11 @@ void CShadowHandler::Init()
 
 	shadowTexture = 0;
 	dummyColorTexture = 0;
+	staticShadowTexture = 0;
+
+	staticCacheEnabled = false;
+	staticCacheValid = false;
+	staticCacheFrame = -1;
 
 	if (!tmpFirstInit && !shadowsSupported) {
 		return;
@@ -133,6 +156,19 @@ void CShadowHandler::Init()
 		return;
 	}
 
+	if (configHandler->GetBool("ShadowStaticCache")) {
+		if (!(staticCacheEnabled = InitStaticCacheTarget())) {
+			LOG_L(L_WARNING, "[%s] failed to initialize static-caster shadow cache", __FUNCTION__);
+
+			staticFb.Bind();
+			staticFb.DetachAll();
+			staticFb.Unbind();
+
+			glDeleteTextures(1, &staticShadowTexture);
+			staticShadowTexture = 0;
+		}
+	}
+
 	LoadShadowGenShaderProgs();
 }
 
@@ -150,8 +186,18 @@ void CShadowHandler::FreeTextures() {
 		fb.Unbind();
 	}
 
-	glDeleteTextures(1, &shadowTexture    ); shadowTexture     = 0;
-	glDeleteTextures(1, &dummyColorTexture); dummyColorTexture = 0;
+	if (staticFb.IsValid()) {
+		staticFb.Bind();
+		staticFb.DetachAll();
+		staticFb.Unbind();
+	}
+
+	glDeleteTextures(1, &shadowTexture      ); shadowTexture       = 0;
+	glDeleteTextures(1, &dummyColorTexture  ); dummyColorTexture   = 0;
+	glDeleteTextures(1, &staticShadowTexture); staticShadowTexture = 0;
+
+	staticCacheEnabled = false;
+	staticCacheValid = false;
 }
 
 
@@ -319,6 +365,67 @@ bool CShadowHandler::WorkaroundUnsupportedFboRenderTargets()
 }
 
 
+bool CShadowHandler::InitStaticCacheTarget()
+{
+	if (!GLEW_EXT_framebuffer_blit || !staticFb.IsValid())
+		return false;
+
+	// blitting depth requires both attachments to have the same format
+	GLint texFormat = GL_DEPTH_COMPONENT32;
+
+	glBindTexture(GL_TEXTURE_2D, shadowTexture);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &texFormat);
+
+	glGenTextures(1, &staticShadowTexture);
+	glBindTexture(GL_TEXTURE_2D, staticShadowTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, texFormat, shadowMapSize, shadowMapSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	staticFb.Bind();
+	staticFb.AttachTexture(staticShadowTexture, GL_TEXTURE_2D, GL_DEPTH_ATTACHMENT_EXT);
+
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	const bool status = staticFb.CheckStatus("SHADOW-STATIC");
+	staticFb.Unbind();
+	return status;
+}
+
+void CShadowHandler::UpdateStaticCacheState()
+{
+	if (!staticCacheEnabled)
+		return;
+
+	// features are drawn based on the LOS state of our allyteam,
+	// which can change (without events) on every simulation frame
+	const int cacheFrame = (gu->spectatingFullView)? 0: gs->frameNum;
+
+	// the terrain mesh and visible-feature set depend on the camera
+	staticCacheValid &= (staticCacheFrame == cacheFrame);
+	staticCacheValid &= (memcmp(staticShadowMatrix.m, shadowMatrix.m, sizeof(shadowMatrix.m)) == 0);
+	staticCacheValid &= (memcmp(staticViewProjMatrix.m, camera->GetViewProjectionMatrix().m, sizeof(staticViewProjMatrix.m)) == 0);
+
+	staticCacheFrame = cacheFrame;
+	staticShadowMatrix = shadowMatrix;
+	staticViewProjMatrix = camera->GetViewProjectionMatrix();
+}
+
+void CShadowHandler::CopyShadowDepth(GLuint srcFboId, GLuint dstFboId)
+{
+	glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, srcFboId);
+	glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, dstFboId);
+	glBlitFramebufferEXT(
+		0, 0, shadowMapSize, shadowMapSize,
+		0, 0, shadowMapSize, shadowMapSize,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	fb.Bind();
+}
+
+
 void CShadowHandler::DrawShadowPasses()
 {
 	inShadowPass = true;
@@ -326,6 +433,27 @@ void CShadowHandler::DrawShadowPasses()
 	glPushAttrib(GL_POLYGON_BIT | GL_ENABLE_BIT);
 		glEnable(GL_CULL_FACE);
 
+		if (staticCacheEnabled) {
+			if (!staticCacheValid) {
+				DrawStaticShadowPasses();
+				CopyShadowDepth(fb.fboId, staticFb.fboId);
+				staticCacheValid = true;
+			} else {
+				CopyShadowDepth(staticFb.fboId, fb.fboId);
+			}
+
+			DrawDynamicShadowPasses();
+		} else {
+			DrawDynamicShadowPasses();
+			DrawStaticShadowPasses();
+		}
+	glPopAttrib();
+
+	inShadowPass = false;
+}
+
+void CShadowHandler::DrawDynamicShadowPasses()
+{
 		glCullFace(GL_BACK);
 			eventHandler.DrawWorldShadow();
 
@@ -340,8 +468,14 @@ void CShadowHandler::DrawShadowPasses()
 			if ((shadowGenBits & SHADOWGEN_BIT_MODEL) != 0) {
 				unitDrawer->DrawShadowPass();
 				modelDrawer->Draw();
-				featureDrawer->DrawShadowPass();
 			}
+}
+
+void CShadowHandler::DrawStaticShadowPasses()
+{
+		glCullFace(GL_BACK);
+			if ((shadowGenBits & SHADOWGEN_BIT_MODEL) != 0)
+				featureDrawer->DrawShadowPass();
 
 		glCullFace(GL_FRONT);
 			// cull front-faces during the terrain shadow pass: sun direction
@@ -351,9 +485,6 @@ void CShadowHandler::DrawShadowPasses()
 			// to prevent overdraw in such low-angle passes)
 			if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0)
 				readMap->GetGroundDrawer()->DrawShadowPass();
-	glPopAttrib();
-
-	inShadowPass = false;
 }
 
 void CShadowHandler::SetShadowMapSizeFactors()
@@ -469,6 +600,8 @@ void CShadowHandler::CreateShadows()
 
 	glLoadMatrixf(shadowMatrix.m);
 
+	UpdateStaticCacheState();
+
 	// set the shadow-parameter registers
 	// NOTE: so long as any part of Spring rendering still uses
 	// ARB programs at run-time, these lines can not be removed
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "Rendering/GL/FBO.h"
+#include "System/EventClient.h"
 #include "System/float4.h"
 #include "System/Matrix44f.h"
 
@@ -14,11 +15,28 @@ namespace Shader {
 };
 
 class CCamera;
-class CShadowHandler
+class CShadowHandler : public CEventClient
 {
 public:
-	CShadowHandler() { Init(); }
-	~CShadowHandler() { Kill(); }
+	// CEventClient interface; these invalidate the static-caster cache
+	bool WantsEvent(const std::string& eventName) {
+		return
+			(eventName == "UnsyncedHeightMapUpdate") ||
+			(eventName == "FeatureCreated") ||
+			(eventName == "FeatureDestroyed") ||
+			(eventName == "FeatureMoved");
+	}
+	bool GetFullRead() const { return true; }
+	int GetReadAllyTeam() const { return AllAccessTeam; }
+
+	void UnsyncedHeightMapUpdate(const SRectangle& rect) { staticCacheValid = false; }
+	void FeatureCreated(const CFeature* feature) { staticCacheValid = false; }
+	void FeatureDestroyed(const CFeature* feature) { staticCacheValid = false; }
+	void FeatureMoved(const CFeature* feature) { staticCacheValid = false; }
+
+public:
+	CShadowHandler();
+	~CShadowHandler();
 
 	void Reload(const char* argv);
 	void CreateShadows();
@@ -63,7 +81,12 @@ private:
 
 	bool InitDepthTarget();
 	bool WorkaroundUnsupportedFboRenderTargets();
+	bool InitStaticCacheTarget();
+	void UpdateStaticCacheState();
 	void DrawShadowPasses();
+	void DrawStaticShadowPasses();
+	void DrawDynamicShadowPasses();
+	void CopyShadowDepth(GLuint srcFboId, GLuint dstFboId);
 	void LoadShadowGenShaderProgs();
 	void SetShadowMapSizeFactors();
 	float GetShadowProjectionRadius(CCamera*, float3&, const float3&) const;
@@ -78,6 +101,7 @@ public:
 
 	unsigned int shadowTexture;
 	unsigned int dummyColorTexture;
+	unsigned int staticShadowTexture;
 
 	static bool shadowsSupported;
 
@@ -94,6 +118,17 @@ public:
 private:
 	FBO fb;
 
+	/// holds the depth of terrain and features; reused as long as
+	/// neither they nor the shadow projection or camera view change
+	FBO staticFb;
+
+	bool staticCacheEnabled;
+	bool staticCacheValid;
+	int staticCacheFrame;
+
+	CMatrix44f staticShadowMatrix;
+	CMatrix44f staticViewProjMatrix;
+
 	static bool firstInit;
 
 	/// these project geometry into light-space
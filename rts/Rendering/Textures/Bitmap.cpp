@@ -7,7 +7,9 @@
 #include <IL/il.h>
 //#include <IL/ilu.h>
 #include <SDL_video.h>
+#include <boost/cstdint.hpp>
 #include <boost/thread.hpp>
+#include <vector>
 
 #ifndef BITMAP_NO_OPENGL
 	#include "Rendering/GL/myGL.h"
@@ -20,6 +22,7 @@
 #include "System/ScopedFPUSettings.h"
 #include "System/Log/ILog.h"
 #include "System/ThreadPool.h"
+#include "System/type2.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileHandler.h"
@@ -520,26 +523,29 @@ const unsigned int CBitmap::CreateDDSTexture(unsigned int texID, bool mipmaps) c
 void CBitmap::CreateAlpha(unsigned char red, unsigned char green, unsigned char blue)
 {
 	float3 aCol;
-	for(int a=0; a < 3; ++a) {
-		int cCol = 0;
-		int numCounted = 0;
-		for (int y=0; y < ysize; ++y) {
-			for (int x=0; x < xsize; ++x) {
-				const int index = (y*xsize + x) * 4;
-				if ((mem[index + 3] != 0) &&
-					!(
-						(mem[index + 0] == red) &&
-						(mem[index + 1] == green) &&
-						(mem[index + 2] == blue)
-					))
-				{
-					cCol += mem[index + a];
-					++numCounted;
-				}
+	boost::int64_t cCol[3] = {0, 0, 0};
+	int numCounted = 0;
+
+	for (int y=0; y < ysize; ++y) {
+		for (int x=0; x < xsize; ++x) {
+			const int index = (y*xsize + x) * 4;
+			if ((mem[index + 3] != 0) &&
+				!(
+					(mem[index + 0] == red) &&
+					(mem[index + 1] == green) &&
+					(mem[index + 2] == blue)
+				))
+			{
+				cCol[0] += mem[index + 0];
+				cCol[1] += mem[index + 1];
+				cCol[2] += mem[index + 2];
+				++numCounted;
 			}
 		}
-		if (numCounted != 0) {
-			aCol[a] = cCol / 255.0f / numCounted;
+	}
+	if (numCounted != 0) {
+		for (int a=0; a < 3; ++a) {
+			aCol[a] = cCol[a] / 255.0f / numCounted;
 		}
 	}
 
@@ -572,61 +578,82 @@ void CBitmap::Renormalize(float3 newCol)
 {
 	float3 aCol;
 	float3 colorDif;
-	for (int a=0; a < 3; ++a) {
-		int cCol = 0;
-		int numCounted = 0;
-		for (int y=0; y < ysize; ++y) {
-			for (int x=0; x < xsize;++x) {
-				const unsigned int index = (y*xsize + x) * 4;
-				if (mem[index + 3] != 0) {
-					cCol += mem[index + a];
-					++numCounted;
-				}
+	boost::int64_t cCol[3] = {0, 0, 0};
+	int numCounted = 0;
+
+	for (int y=0; y < ysize; ++y) {
+		for (int x=0; x < xsize;++x) {
+			const unsigned int index = (y*xsize + x) * 4;
+			if (mem[index + 3] != 0) {
+				cCol[0] += mem[index + 0];
+				cCol[1] += mem[index + 1];
+				cCol[2] += mem[index + 2];
+				++numCounted;
 			}
 		}
-		aCol[a] = cCol / 255.0f / numCounted;
-		cCol /= xsize*ysize;
-		colorDif[a] = newCol[a] - aCol[a];
 	}
 	for (int a=0; a < 3; ++a) {
-		for (int y=0; y < ysize; ++y) {
-			for (int x=0; x < xsize; ++x) {
-				const unsigned int index = (y*xsize + x) * 4;
-				float nc = float(mem[index + a]) / 255.0f + colorDif[a];
-				mem[index + a] = (unsigned char) (std::min(255.f, std::max(0.0f, nc*255)));
+		aCol[a] = cCol[a] / 255.0f / numCounted;
+		colorDif[a] = newCol[a] - aCol[a];
+	}
+
+	for_mt(0, ysize, [&](const int y) {
+		unsigned char* row = mem + (y * xsize) * 4;
+
+		for (int x=0; x < xsize; ++x) {
+			for (int a=0; a < 3; ++a) {
+				const float nc = float(row[x * 4 + a]) / 255.0f + colorDif[a];
+				row[x * 4 + a] = (unsigned char) (std::min(255.f, std::max(0.0f, nc*255)));
 			}
 		}
-	}
+	});
 }
 
 
-inline static void kernelBlur(CBitmap* dst, const unsigned char* src, int x, int y, int channel, float weight)
+/**
+ * Blurs one row of <src> into <dst>; the 3x3 kernel is clamped at the
+ * image borders and its terms are summed in the same order as ever so
+ * the result does not depend on how the rows are split among threads.
+ */
+static void kernelBlurRow(CBitmap* dst, const unsigned char* src, int y, float weight)
 {
-	float fragment = 0.0f;
+	const int xsize = dst->xsize;
+	const int channels = dst->channels;
+	const int stride = xsize * channels;
 
-	const int pos = (x + y * dst->xsize) * dst->channels + channel;
+	const unsigned char* rows[3] = {
+		src + std::max(y - 1,              0) * stride,
+		src + (y                             ) * stride,
+		src + std::min(y + 1, dst->ysize - 1) * stride,
+	};
 
-	for (int i=0; i < 9; ++i) {
-		int yoffset = (i / 3) - 1;
-		int xoffset = (i - (yoffset + 1) * 3) - 1;
+	const float centerWeight = weight * blurkernel[4];
 
-		const int tx = x + xoffset;
-		const int ty = y + yoffset;
-		if ((tx < 0) || (tx >= dst->xsize)) {
-			xoffset = 0;
-		}
-		if ((ty < 0) || (ty >= dst->ysize)) {
-			yoffset = 0;
-		}
-		int offset = (xoffset + yoffset * dst->xsize) * dst->channels;
-		if (i == 4) {
-			fragment += weight * blurkernel[i] * src[pos + offset];
-		} else {
-			fragment += blurkernel[i] * src[pos + offset];
+	unsigned char* out = dst->mem + y * stride;
+
+	for (int x=0; x < xsize; x++) {
+		const int cols[3] = {
+			std::max(x - 1,         0) * channels,
+			(x                       ) * channels,
+			std::min(x + 1, xsize - 1) * channels,
+		};
+
+		for (int j=0; j < channels; j++) {
+			float fragment = 0.0f;
+
+			for (int i=0; i < 9; ++i) {
+				const unsigned char s = rows[i / 3][cols[i % 3] + j];
+
+				if (i == 4) {
+					fragment += centerWeight * s;
+				} else {
+					fragment += blurkernel[i] * s;
+				}
+			}
+
+			out[x * channels + j] = (unsigned char)std::min(255.0f,std::max(0.0f, fragment ));
 		}
 	}
-
-	dst->mem[pos] = (unsigned char)std::min(255.0f,std::max(0.0f, fragment ));
 }
 
 
@@ -644,11 +671,7 @@ void CBitmap::Blur(int iterations, float weight)
 	for (int i=0; i < iterations; ++i){
 		{
 			for_mt(0, ysize, [&](const int y) {
-				for (int x=0; x < xsize; x++) {
-					for (int j=0; j < channels; j++) {
-						kernelBlur(dst, src->mem, x, y, j, weight);
-					}
-				}
+				kernelBlurRow(dst, src->mem, y, weight);
 			});
 		}
 		std::swap(src, dst);
@@ -743,23 +766,34 @@ CBitmap CBitmap::CreateRescaled(int newx, int newy) const
 	const float dx = (float) xsize / newx;
 	const float dy = (float) ysize / newy;
 
+	// source spans [s, e) of each destination column and row; found
+	// by accumulating the step like before, then filled in parallel
+	std::vector<int2> xspans(newx);
+	std::vector<int2> yspans(newy);
+
+	float cx = 0;
+	for (int x=0; x < newx; ++x) {
+		const int sx = (int) cx;
+		cx += dx;
+		const int ex = (int) cx;
+		xspans[x] = int2(sx, (ex == sx)? sx + 1: ex);
+	}
+
 	float cy = 0;
 	for (int y=0; y < newy; ++y) {
 		const int sy = (int) cy;
 		cy += dy;
-		int ey = (int) cy;
-		if (ey == sy) {
-			ey = sy+1;
-		}
+		const int ey = (int) cy;
+		yspans[y] = int2(sy, (ey == sy)? sy + 1: ey);
+	}
+
+	for_mt(0, newy, [&](const int y) {
+		const int sy = yspans[y].x;
+		const int ey = yspans[y].y;
 
-		float cx = 0;
 		for (int x=0; x < newx; ++x) {
-			const int sx = (int) cx;
-			cx += dx;
-			int ex = (int) cx;
-			if (ex == sx) {
-				ex = sx + 1;
-			}
+			const int sx = xspans[x].x;
+			const int ex = xspans[x].y;
 
 			int r=0, g=0, b=0, a=0;
 			for (int y2 = sy; y2 < ey; ++y2) {
@@ -778,7 +812,7 @@ CBitmap CBitmap::CreateRescaled(int newx, int newy) const
 			bm.mem[index + 2] = b / denom;
 			bm.mem[index + 3] = a / denom;
 		}
-	}
+	});
 
 	return bm;
 }
@@ -789,7 +823,7 @@ void CBitmap::InvertColors()
 	if (type != BitmapTypeStandardRGBA) {
 		return;
 	}
-	for (int y = 0; y < ysize; ++y) {
+	for_mt(0, ysize, [&](const int y) {
 		for (int x = 0; x < xsize; ++x) {
 			const int base = ((y * xsize) + x) * 4;
 			mem[base + 0] = 0xFF - mem[base + 0];
@@ -797,7 +831,7 @@ void CBitmap::InvertColors()
 			mem[base + 2] = 0xFF - mem[base + 2];
 			// do not invert alpha
 		}
-	}
+	});
 }
 
 
@@ -818,7 +852,7 @@ void CBitmap::GrayScale()
 	if (type != BitmapTypeStandardRGBA) {
 		return;
 	}
-	for (int y = 0; y < ysize; ++y) {
+	for_mt(0, ysize, [&](const int y) {
 		for (int x = 0; x < xsize; ++x) {
 			const int base = ((y * xsize) + x) * 4;
 			const float illum =
@@ -831,7 +865,7 @@ void CBitmap::GrayScale()
 			mem[base + 1] = cval;
 			mem[base + 2] = cval;
 		}
-	}
+	});
 }
 
 static ILubyte TintByte(ILubyte value, float tint)
@@ -847,7 +881,7 @@ void CBitmap::Tint(const float tint[3])
 	if (type != BitmapTypeStandardRGBA) {
 		return;
 	}
-	for (int y = 0; y < ysize; y++) {
+	for_mt(0, ysize, [&](const int y) {
 		for (int x = 0; x < xsize; x++) {
 			const int base = ((y * xsize) + x) * 4;
 			mem[base + 0] = TintByte(mem[base + 0], tint[0]);
@@ -855,7 +889,7 @@ void CBitmap::Tint(const float tint[3])
 			mem[base + 2] = TintByte(mem[base + 2], tint[2]);
 			// don't touch the alpha channel
 		}
-	}
+	});
 }
 
 
@@ -2,22 +2,39 @@
 
 
 #include "S3OTextureHandler.h"
+#include "Game/Game.h"
 
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/UnitDrawer.h"
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Textures/Bitmap.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/CRC.h"
+#include "System/ThreadPool.h"
+#include "System/bitops.h"
 #include "System/Util.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
 
+#if defined(USE_LIBSQUISH) && !defined(HEADLESS)
+	#include "lib/squish/squish.h"
+	#define S3O_TEXTURE_COMPRESSION
+#endif
+
 #include <algorithm>
 #include <cctype>
+#include <fstream>
 #include <set>
 #include <sstream>
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
 
 #define LOG_SECTION_TEXTURE "Texture"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_TEXTURE)
@@ -30,6 +47,258 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_TEXTURE)
 // The first contains diffuse color (RGB) and teamcolor (A)
 // The second contains glow (R), reflectivity (G) and 1-bit Alpha (A).
 
+CONFIG(bool, CompressS3OTextures)
+	.defaultValue(false)
+	.description("Keep S3O model textures DXT5-compressed in video memory (a quarter of the size), compressing them on all cores while loading and caching the results on disk.");
+
+CONFIG(int, S3OTextureReduction)
+	.defaultValue(0)
+	.minimumValue(0)
+	.maximumValue(4)
+	.description("Halve the resolution of S3O model textures this many times, for video cards with little memory.");
+CONFIG(bool, AsyncS3OTextureLoading)
+	.defaultValue(true)
+	.description("Decode the textures of models first used mid-game on a background thread instead of stalling the frame; such models are drawn plain grey until the textures are uploaded a few frames later.");
+
+static const char dxtCacheMagic[] = "S3OTexDXT5";
+
+static std::string GetDXTCacheDir() {
+	return (FileSystem::GetCacheDir() + "/s3otex/");
+}
+
+
+/// the data of one texture, ready to upload
+struct TexData {
+	TexData(): xsize(0), ysize(0) {}
+
+	CBitmap bitmap;
+
+	// compressed mip-chain, bitmap is unused if non-empty
+	std::vector< std::vector<boost::uint8_t> > dxtLevels;
+	int xsize;
+	int ysize;
+};
+
+struct CS3OTextureHandler::TexLoad {
+	TexData tex1;
+	TexData tex2;
+};
+
+
+static bool LoadTexBitmap(CBitmap& bitmap, const std::string& fileName)
+{
+	return (bitmap.Load(fileName) || bitmap.Load("unittextures/" + fileName));
+}
+
+
+#ifdef S3O_TEXTURE_COMPRESSION
+static std::string GetDXTCacheFile(const std::string& fileName, bool invertAlpha, bool invertYAxis, int reduction)
+{
+	CFileHandler file(fileName);
+	std::vector<boost::uint8_t> fileData(file.FileSize());
+
+	if (fileData.empty() || file.Read(&fileData[0], fileData.size()) != int(fileData.size()))
+		return "";
+
+	CRC crc;
+	crc.Update(&fileData[0], fileData.size());
+	crc << int(invertAlpha) << int(invertYAxis) << reduction;
+
+	return (GetDXTCacheDir() + IntToString(crc.GetDigest(), "%08x") + ".dxt5");
+}
+
+static bool ReadDXTCache(const std::string& cacheFile, TexData& tex)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(cacheFile).c_str(), std::ios::in | std::ios::binary);
+	char magic[sizeof(dxtCacheMagic)];
+	boost::uint32_t header[3]; // xsize, ysize, numLevels
+
+	if (!file.read(magic, sizeof(magic)) || memcmp(magic, dxtCacheMagic, sizeof(magic)) != 0)
+		return false;
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) || header[2] == 0 || header[2] > 32)
+		return false;
+
+	tex.dxtLevels.resize(header[2]);
+
+	for (unsigned int n = 0; n < header[2]; n++) {
+		boost::uint32_t levelSize = 0;
+
+		if (!file.read(reinterpret_cast<char*>(&levelSize), sizeof(levelSize)) || levelSize == 0)
+			return false;
+
+		tex.dxtLevels[n].resize(levelSize);
+
+		if (!file.read(reinterpret_cast<char*>(&tex.dxtLevels[n][0]), levelSize))
+			return false;
+	}
+
+	tex.xsize = header[0];
+	tex.ysize = header[1];
+	return true;
+}
+
+static void WriteDXTCache(const std::string& cacheFile, const TexData& tex)
+{
+	std::ofstream file(dataDirsAccess.LocateFile(cacheFile, FileQueryFlags::WRITE).c_str(), std::ios::out | std::ios::binary);
+	const boost::uint32_t header[3] = {boost::uint32_t(tex.xsize), boost::uint32_t(tex.ysize), boost::uint32_t(tex.dxtLevels.size())};
+
+	file.write(dxtCacheMagic, sizeof(dxtCacheMagic));
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	for (unsigned int n = 0; n < tex.dxtLevels.size(); n++) {
+		const boost::uint32_t levelSize = tex.dxtLevels[n].size();
+
+		file.write(reinterpret_cast<const char*>(&levelSize), sizeof(levelSize));
+		file.write(reinterpret_cast<const char*>(&tex.dxtLevels[n][0]), levelSize);
+	}
+}
+
+static void CompressTexData(TexData& tex)
+{
+	static const int squishFlags = squish::kDxt5 | squish::kColourRangeFit;
+
+	CBitmap level = tex.bitmap;
+
+	tex.xsize = level.xsize;
+	tex.ysize = level.ysize;
+
+	// CPU-side mip-chain, the driver can not build one for compressed data
+	while (true) {
+		tex.dxtLevels.push_back(std::vector<boost::uint8_t>(squish::GetStorageRequirements(level.xsize, level.ysize, squishFlags)));
+		squish::CompressImage(level.mem, level.xsize, level.ysize, &tex.dxtLevels.back()[0], squishFlags);
+
+		if (level.xsize == 1 && level.ysize == 1)
+			break;
+
+		level = level.CreateRescaled(std::max(1, level.xsize >> 1), std::max(1, level.ysize >> 1));
+	}
+
+	// no longer needed
+	tex.bitmap = CBitmap();
+}
+#endif
+
+
+static void DecodeTexData(
+	TexData& tex,
+	const std::string& fileName,
+	const std::string& modelName,
+	bool isTex1,
+	bool invertAlpha,
+	bool invertYAxis,
+	bool compress,
+	int reduction
+) {
+#ifdef S3O_TEXTURE_COMPRESSION
+	std::string cacheFile;
+
+	if (compress && !fileName.empty()) {
+		// DDS files are already compressed
+		if (FileSystem::GetExtension(fileName) != "dds") {
+			if (CFileHandler::FileExists(fileName, SPRING_VFS_ZIP)) {
+				cacheFile = GetDXTCacheFile(fileName, invertAlpha, invertYAxis, reduction);
+			} else if (CFileHandler::FileExists("unittextures/" + fileName, SPRING_VFS_ZIP)) {
+				cacheFile = GetDXTCacheFile("unittextures/" + fileName, invertAlpha, invertYAxis, reduction);
+			}
+		}
+
+		if (!cacheFile.empty() && ReadDXTCache(cacheFile, tex))
+			return;
+
+		tex.dxtLevels.clear();
+	}
+#endif
+
+	if (!LoadTexBitmap(tex.bitmap, fileName)) {
+		// No error checking for tex2... other code relies on an empty texture
+		// being generated if it couldn't be loaded.
+		// Also many map features specify a tex2 but don't ship it with the map,
+		// so throwing here would cause maps to break.
+		if (isTex1) {
+			LOG_L(L_WARNING, "[%s] could not load texture \"%s\" from model \"%s\"",
+					__FUNCTION__, fileName.c_str(), modelName.c_str());
+		}
+
+		// file not found (or headless build), use a single pixel
+		// (set to red for tex1 so the unit is visible)
+		tex.bitmap.channels = 4;
+		tex.bitmap.Alloc(1, 1);
+		tex.bitmap.mem[0] = isTex1? 255: 0; // self-illum for tex2
+		tex.bitmap.mem[1] =   0; // spec+refl for tex2
+		tex.bitmap.mem[2] =   0; // unused for tex2
+		tex.bitmap.mem[3] = 255; // team-color / transparency
+		return;
+	}
+
+	if (tex.bitmap.type != CBitmap::BitmapTypeStandardRGBA)
+		return;
+
+	if (isTex1 && invertAlpha)
+		tex.bitmap.InvertAlpha();
+	if (invertYAxis)
+		tex.bitmap.ReverseYAxis();
+
+	for (int n = 0; n < reduction && tex.bitmap.xsize > 4 && tex.bitmap.ysize > 4; n++) {
+		tex.bitmap = tex.bitmap.CreateRescaled(tex.bitmap.xsize >> 1, tex.bitmap.ysize >> 1);
+	}
+
+#ifdef S3O_TEXTURE_COMPRESSION
+	const bool powerOfTwo = (tex.bitmap.xsize == next_power_of_2(tex.bitmap.xsize) && tex.bitmap.ysize == next_power_of_2(tex.bitmap.ysize));
+
+	if (!compress || !powerOfTwo)
+		return;
+
+	CompressTexData(tex);
+
+	if (!cacheFile.empty()) {
+		WriteDXTCache(cacheFile, tex);
+	}
+#endif
+}
+
+
+static GLuint CreateTexture(const TexData& tex, unsigned int& xsize, unsigned int& ysize)
+{
+	if (tex.dxtLevels.empty()) {
+		xsize = tex.bitmap.xsize;
+		ysize = tex.bitmap.ysize;
+		return tex.bitmap.CreateTexture(true);
+	}
+
+	GLuint texID = 0;
+
+	xsize = tex.xsize;
+	ysize = tex.ysize;
+
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+	for (unsigned int n = 0; n < tex.dxtLevels.size(); n++) {
+		const int levelX = std::max(1, tex.xsize >> n);
+		const int levelY = std::max(1, tex.ysize >> n);
+
+		glCompressedTexImage2D(GL_TEXTURE_2D, n, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, levelX, levelY, 0, tex.dxtLevels[n].size(), &tex.dxtLevels[n][0]);
+	}
+
+	return texID;
+}
+
+static GLuint CreatePlaceholderTexture(unsigned char r, unsigned char g, unsigned char b)
+{
+	CBitmap bitmap;
+	bitmap.channels = 4;
+	bitmap.Alloc(1, 1);
+	bitmap.mem[0] = r;
+	bitmap.mem[1] = g;
+	bitmap.mem[2] = b;
+	bitmap.mem[3] = 255;
+	return bitmap.CreateTexture(false);
+}
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -37,7 +306,22 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_TEXTURE)
 CS3OTextureHandler* texturehandlerS3O = NULL;
 
 CS3OTextureHandler::CS3OTextureHandler()
+	: compressTextures(false)
+	, textureReduction(configHandler->GetInt("S3OTextureReduction"))
+	, asyncLoading(configHandler->GetBool("AsyncS3OTextureLoading"))
+	, stopAsyncLoading(false)
+	, asyncLoadThread(NULL)
+	, placeholderTex1(0)
+	, placeholderTex2(0)
 {
+#ifdef S3O_TEXTURE_COMPRESSION
+	compressTextures = (configHandler->GetBool("CompressS3OTextures") && GLEW_EXT_texture_compression_s3tc);
+
+	if (compressTextures && !FileSystem::CreateDirectory(GetDXTCacheDir())) {
+		LOG_L(L_WARNING, "[%s] could not create the texture cache directory", __FUNCTION__);
+	}
+#endif
+
 	s3oTextures.push_back(new S3oTex());
 	s3oTextures.push_back(new S3oTex());
 	if (GML::SimEnabled() && GML::ShareLists())
@@ -46,11 +330,35 @@ CS3OTextureHandler::CS3OTextureHandler()
 
 CS3OTextureHandler::~CS3OTextureHandler()
 {
+	if (asyncLoadThread != NULL) {
+		{
+			boost::mutex::scoped_lock lock(asyncLoadMutex);
+			stopAsyncLoading = true;
+		}
+
+		asyncLoadCond.notify_all();
+		asyncLoadThread->join();
+		delete asyncLoadThread;
+	}
+
+	for (unsigned int n = 0; n < queuedLoads.size(); n++) {
+		delete queuedLoads[n].texLoad;
+	}
+	for (unsigned int n = 0; n < decodedLoads.size(); n++) {
+		delete decodedLoads[n].texLoad;
+	}
+
 	for (int i = 0; i < s3oTextures.size(); ++i){
-		glDeleteTextures(1, &s3oTextures[i]->tex1);
-		glDeleteTextures(1, &s3oTextures[i]->tex2);
+		// the placeholders are shared, deleted below
+		if (s3oTextures[i]->tex1 != placeholderTex1)
+			glDeleteTextures(1, &s3oTextures[i]->tex1);
+		if (s3oTextures[i]->tex2 != placeholderTex2)
+			glDeleteTextures(1, &s3oTextures[i]->tex2);
 		delete s3oTextures[i];
 	}
+
+	glDeleteTextures(1, &placeholderTex1);
+	glDeleteTextures(1, &placeholderTex2);
 }
 
 void CS3OTextureHandler::LoadS3OTexture(S3DModel* model) {
@@ -73,54 +381,93 @@ int CS3OTextureHandler::LoadS3OTextureNow(const S3DModel* model)
 		return s3oTextureNames[totalName];
 	}
 
-	CBitmap tex1bm;
-	CBitmap tex2bm;
-	S3oTex* tex = new S3oTex();
+	// decoding a texture takes much longer than uploading it, do not let
+	// the first unit of a new type stall the game for that
+	if (asyncLoading && game != NULL && game->finishedLoading)
+		return (QueueS3OTextures(totalName, model));
 
-	if (!tex1bm.Load(model->tex1)) {
-		if (!tex1bm.Load("unittextures/" + model->tex1)) {
-			LOG_L(L_WARNING, "[%s] could not load texture \"%s\" from model \"%s\"",
-					__FUNCTION__, model->tex1.c_str(), model->name.c_str());
-
-			// file not found (or headless build), set single pixel to red so unit is visible
-			tex1bm.channels = 4;
-			tex1bm.Alloc(1, 1);
-			tex1bm.mem[0] = 255;
-			tex1bm.mem[1] =   0;
-			tex1bm.mem[2] =   0;
-			tex1bm.mem[3] = 255; // team-color
-		}
+	TexLoad texLoad;
+	DecodeS3OTextures(model, texLoad);
+
+	return (InsertS3OTextures(totalName, texLoad));
+}
+
+
+void CS3OTextureHandler::PreloadS3OTextures(const std::vector<const S3DModel*>& models)
+{
+	GML_RECMUTEX_LOCK(model); // PreloadS3OTextures
+
+	// textures are created later by the draw-thread then, see LoadS3OTexture
+	if (GML::SimEnabled() && !GML::ShareLists() && GML::IsSimThread())
+		return;
+
+	std::vector<const S3DModel*> loadModels;
+	std::vector<std::string> loadNames;
+	std::set<std::string> uniqueNames;
+
+	for (unsigned int n = 0; n < models.size(); n++) {
+		const string totalName = models[n]->tex1 + models[n]->tex2;
+
+		if (s3oTextureNames.find(totalName) != s3oTextureNames.end())
+			continue;
+		if (!uniqueNames.insert(totalName).second)
+			continue;
+
+		loadModels.push_back(models[n]);
+		loadNames.push_back(totalName);
 	}
 
-	// No error checking here... other code relies on an empty texture
-	// being generated if it couldn't be loaded.
-	// Also many map features specify a tex2 but don't ship it with the map,
-	// so throwing here would cause maps to break.
-	if (!tex2bm.Load(model->tex2)) {
-		if (!tex2bm.Load("unittextures/" + model->tex2)) {
-			tex2bm.channels = 4;
-			tex2bm.Alloc(1, 1);
-			tex2bm.mem[0] =   0; // self-illum
-			tex2bm.mem[1] =   0; // spec+refl
-			tex2bm.mem[2] =   0; // unused
-			tex2bm.mem[3] = 255; // transparency
-		}
+	std::vector<TexLoad> texLoads(loadModels.size());
+
+	for_mt(0, loadModels.size(), [&](const int i) {
+		DecodeS3OTextures(loadModels[i], texLoads[i]);
+	});
+
+	for (unsigned int n = 0; n < loadModels.size(); n++) {
+		InsertS3OTextures(loadNames[n], texLoads[n]);
 	}
+}
+
+
+void CS3OTextureHandler::DecodeS3OTextures(const S3DModel* model, TexLoad& texLoad) const
+{
+	DecodeTexData(texLoad.tex1, model->tex1, model->name, true,  model->invertTexAlpha, model->invertTexYAxis, compressTextures, textureReduction);
+	DecodeTexData(texLoad.tex2, model->tex2, model->name, false, model->invertTexAlpha, model->invertTexYAxis, compressTextures, textureReduction);
+}
+
+
+int CS3OTextureHandler::InsertS3OTextures(const std::string& totalName, const TexLoad& texLoad)
+{
+	S3oTex* tex = new S3oTex();
+
+	tex->num  = s3oTextures.size();
+	tex->tex1 = CreateTexture(texLoad.tex1, tex->tex1SizeX, tex->tex1SizeY);
+	tex->tex2 = CreateTexture(texLoad.tex2, tex->tex2SizeX, tex->tex2SizeY);
 
-	if (model->invertTexAlpha)
-		tex1bm.InvertAlpha();
-	if (model->invertTexYAxis) {
-		tex1bm.ReverseYAxis();
-		tex2bm.ReverseYAxis();
+	s3oTextures.push_back(tex);
+	s3oTextureNames[totalName] = tex->num;
+
+	if (GML::SimEnabled() && GML::ShareLists() && !GML::IsSimThread())
+		DoUpdateDraw();
+
+	return tex->num;
+}
+
+
+int CS3OTextureHandler::QueueS3OTextures(const std::string& totalName, const S3DModel* model)
+{
+	if (placeholderTex1 == 0) {
+		placeholderTex1 = CreatePlaceholderTexture(128, 128, 128);
+		placeholderTex2 = CreatePlaceholderTexture(0, 0, 0);
 	}
 
-	tex->num       = s3oTextures.size();
-	tex->tex1      = tex1bm.CreateTexture(true);
-	tex->tex1SizeX = tex1bm.xsize;
-	tex->tex1SizeY = tex1bm.ysize;
-	tex->tex2      = tex2bm.CreateTexture(true);
-	tex->tex2SizeX = tex2bm.xsize;
-	tex->tex2SizeY = tex2bm.ysize;
+	S3oTex* tex = new S3oTex();
+
+	tex->num  = s3oTextures.size();
+	tex->tex1 = placeholderTex1;
+	tex->tex2 = placeholderTex2;
+	tex->tex1SizeX = tex->tex1SizeY = 1;
+	tex->tex2SizeX = tex->tex2SizeY = 1;
 
 	s3oTextures.push_back(tex);
 	s3oTextureNames[totalName] = tex->num;
@@ -128,9 +475,74 @@ int CS3OTextureHandler::LoadS3OTextureNow(const S3DModel* model)
 	if (GML::SimEnabled() && GML::ShareLists() && !GML::IsSimThread())
 		DoUpdateDraw();
 
+	const AsyncLoad load = {tex->num, model, new TexLoad()};
+
+	{
+		boost::mutex::scoped_lock lock(asyncLoadMutex);
+		queuedLoads.push_back(load);
+	}
+
+	if (asyncLoadThread == NULL)
+		asyncLoadThread = new boost::thread(boost::bind(&CS3OTextureHandler::AsyncLoadThreadFunc, this));
+
+	asyncLoadCond.notify_one();
 	return tex->num;
 }
 
+void CS3OTextureHandler::AsyncLoadThreadFunc()
+{
+	Threading::SetThreadName("s3otex-loader");
+
+	while (true) {
+		AsyncLoad load;
+
+		{
+			boost::mutex::scoped_lock lock(asyncLoadMutex);
+
+			while (queuedLoads.empty() && !stopAsyncLoading)
+				asyncLoadCond.wait(lock);
+
+			if (stopAsyncLoading)
+				return;
+
+			load = queuedLoads.front();
+			queuedLoads.pop_front();
+		}
+
+		DecodeS3OTextures(load.model, *load.texLoad);
+
+		{
+			boost::mutex::scoped_lock lock(asyncLoadMutex);
+			decodedLoads.push_back(load);
+		}
+	}
+}
+
+void CS3OTextureHandler::Update()
+{
+	std::vector<AsyncLoad> loads;
+
+	{
+		boost::mutex::scoped_lock lock(asyncLoadMutex);
+
+		if (decodedLoads.empty())
+			return;
+
+		loads.swap(decodedLoads);
+	}
+
+	GML_RECMUTEX_LOCK(model); // Update
+
+	for (unsigned int n = 0; n < loads.size(); n++) {
+		S3oTex* tex = s3oTextures[loads[n].num];
+
+		tex->tex1 = CreateTexture(loads[n].texLoad->tex1, tex->tex1SizeX, tex->tex1SizeY);
+		tex->tex2 = CreateTexture(loads[n].texLoad->tex2, tex->tex2SizeX, tex->tex2SizeY);
+
+		delete loads[n].texLoad;
+	}
+}
+
 
 inline void DoSetS3oTexture(int num, std::vector<CS3OTextureHandler::S3oTex*>& s3oTex) {
 	if (shadowHandler->inShadowPass) {
@@ -3,12 +3,19 @@
 #ifndef S3O_TEXTURE_HANDLER_H
 #define S3O_TEXTURE_HANDLER_H
 
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include "Rendering/GL/myGL.h"
 #include "System/Platform/Threading.h"
 
+namespace boost {
+	class thread;
+}
+
 struct TexFile;
 struct S3DModel;
 
@@ -32,7 +39,35 @@ public:
 	int LoadS3OTextureNow(const S3DModel* model);
 	void SetS3oTexture(int num);
 
+	/**
+	 * Decodes (and compresses, see CompressS3OTextures) the textures of
+	 * all given models in parallel, then uploads them; LoadS3OTexture
+	 * finds them cached afterwards.
+	 */
+	void PreloadS3OTextures(const std::vector<const S3DModel*>& models);
+
+	/**
+	 * Uploads the textures the async loader has finished decoding since
+	 * the last call, needs to run every draw frame (in the GL thread).
+	 */
+	void Update();
+
 private:
+	struct TexLoad;
+	struct AsyncLoad {
+		int num;
+		const S3DModel* model;
+		TexLoad* texLoad;
+	};
+
+	/// decodes AsyncLoad's queued by LoadS3OTextureNow mid-game
+	void AsyncLoadThreadFunc();
+	int QueueS3OTextures(const std::string& totalName, const S3DModel* model);
+
+	/// thread-safe, no GL calls
+	void DecodeS3OTextures(const S3DModel* model, TexLoad& texLoad) const;
+	int InsertS3OTextures(const std::string& totalName, const TexLoad& texLoad);
+
 	inline void DoUpdateDraw() {
 		if (GML::SimEnabled() && GML::ShareLists()) {
 			while (s3oTexturesDraw.size() < s3oTextures.size())
@@ -62,10 +97,33 @@ public:
 
 	void UpdateDraw();
 
+	/// true while the textures of <num> are still being decoded (see Update)
+	bool IsS3oTexPending(int num) {
+		const S3oTex* tex = GetS3oTex(num);
+		return (tex != NULL && placeholderTex1 != 0 && tex->tex1 == placeholderTex1);
+	}
+
 private:
 	std::map<std::string, int> s3oTextureNames;
 	std::vector<S3oTex *> s3oTextures;
 	std::vector<S3oTex *> s3oTexturesDraw;
+
+	bool compressTextures;
+	int textureReduction;
+
+	bool asyncLoading;
+	bool stopAsyncLoading;
+
+	boost::thread* asyncLoadThread;
+	boost::mutex asyncLoadMutex;
+	boost::condition_variable asyncLoadCond;
+
+	std::deque<AsyncLoad> queuedLoads;   ///< waiting for the thread
+	std::vector<AsyncLoad> decodedLoads; ///< waiting for Update
+
+	/// bound to models whose textures are still being decoded
+	GLuint placeholderTex1;
+	GLuint placeholderTex2;
 };
 
 extern CS3OTextureHandler* texturehandlerS3O;
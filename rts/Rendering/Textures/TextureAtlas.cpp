@@ -9,13 +9,20 @@
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/PBO.h"
+#include "System/CRC.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/ThreadPool.h"
 #include "System/Util.h"
 #include "System/Exceptions.h"
 
+#include <boost/cstdint.hpp>
 #include <list>
 #include <cstring>
+#include <fstream>
 
 CR_BIND(AtlasedTexture, );
 CR_REG_METADATA(AtlasedTexture,
@@ -28,11 +35,20 @@ CR_REG_METADATA(GroundFXTexture,
 // texture spacing in the atlas (in pixels)
 #define TEXMARGIN 2
 
+static const char atlasCacheMagic[] = "TexAtlas1";
+
+static std::string GetAtlasCacheDir() {
+	return (FileSystem::GetCacheDir() + "/atlas/");
+}
+
 bool CTextureAtlas::debug;
 
 CTextureAtlas::CTextureAtlas(unsigned int allocType)
 	: atlasAllocator(NULL)
 	, atlasTexID(0)
+	, allocType(allocType)
+	, atlasSize(0, 0)
+	, maxMipMaps(0)
 	, initialized(false)
 	, freeTexture(true)
 {
@@ -85,7 +101,7 @@ int CTextureAtlas::AddTexFromFile(std::string name, std::string file)
 {
 	StringToLowerInPlace(name);
 
-	// if the file is already loaded, use that instead
+	// if the file is already queued, use that instead
 	std::string lcFile = StringToLower(file);
 	std::map<std::string, MemTex*>::iterator it = files.find(lcFile);
 	if (it != files.end()) {
@@ -94,81 +110,129 @@ int CTextureAtlas::AddTexFromFile(std::string name, std::string file)
 		return 1;
 	}
 
+	// decoding is deferred to Finalize, which can skip it entirely
+	MemTex* memtex = new MemTex;
+	memtex->file = file;
+	memtex->xsize = 0;
+	memtex->ysize = 0;
+	memtex->texType = RGBA32;
+	memtex->data = NULL;
+	memtex->names.push_back(name);
+	memtextures.push_back(memtex);
 
-	CBitmap bitmap;
-	if (!bitmap.Load(file)) {
-		throw content_error("Could not load texture from file " + file);
-	}
+	files[lcFile] = memtex;
+	return 1;
+}
 
-	if (bitmap.type != CBitmap::BitmapTypeStandardRGBA) {
-		// only suport RGBA for now
-		throw content_error("Unsupported bitmap format in file " + file);
-	}
+void CTextureAtlas::LoadFileTextures()
+{
+	for (std::vector<MemTex*>::iterator it = memtextures.begin(); it != memtextures.end(); ++it) {
+		MemTex* memtex = *it;
+
+		if (memtex->file.empty())
+			continue;
+
+		CBitmap bitmap;
+		if (!bitmap.Load(memtex->file)) {
+			throw content_error("Could not load texture from file " + memtex->file);
+		}
+
+		if (bitmap.type != CBitmap::BitmapTypeStandardRGBA) {
+			// only suport RGBA for now
+			throw content_error("Unsupported bitmap format in file " + memtex->file);
+		}
+
+		const size_t data_size = bitmap.xsize * bitmap.ysize * GetBPP(RGBA32) / 8;
+
+		memtex->xsize = bitmap.xsize;
+		memtex->ysize = bitmap.ysize;
+		memtex->data = new char[data_size];
+		memtex->file.clear();
 
-	const int ret = AddTexFromMem(name, bitmap.xsize, bitmap.ysize, RGBA32, bitmap.mem);
-	if (ret == 1) {
-		files[lcFile] = memtextures.back();
+		std::memcpy(memtex->data, bitmap.mem, data_size);
+		atlasAllocator->AddEntry(memtex->names[0], int2(memtex->xsize, memtex->ysize));
 	}
-	return ret;
 }
 
 bool CTextureAtlas::Finalize()
 {
-	const bool success = atlasAllocator->Allocate();
+	const std::string cacheFile = GetCacheFileName();
+
+	std::vector<unsigned char> pixels;
+	bool success = (!cacheFile.empty() && ReadCache(cacheFile, pixels));
+
+	if (!success) {
+		LoadFileTextures();
+
+		if ((success = atlasAllocator->Allocate())) {
+			FillAtlas(pixels);
+
+			if (!cacheFile.empty()) {
+				WriteCache(cacheFile, pixels);
+			}
+		}
+	}
 
 	if (success)
-		CreateTexture();
+		CreateTexture(pixels);
 
 	for (std::vector<MemTex*>::iterator it = memtextures.begin(); it != memtextures.end(); ++it) {
 		delete[] (char*)(*it)->data;
 		delete (*it);
 	}
 	memtextures.clear();
+	files.clear();
 
 	return success;
 }
 
-void CTextureAtlas::CreateTexture()
+void CTextureAtlas::FillAtlas(std::vector<unsigned char>& pixels)
 {
-	const int2 atlasSize = atlasAllocator->GetAtlasSize();
-
-	PBO pbo;
-	pbo.Bind();
-	pbo.Resize(atlasSize.x * atlasSize.y * 4);
-
-	unsigned char* data = (unsigned char*)pbo.MapBuffer(GL_WRITE_ONLY);
+	atlasSize = atlasAllocator->GetAtlasSize();
+	maxMipMaps = atlasAllocator->GetMaxMipMaps();
 
-	{
-		// make spacing between textures black transparent to avoid ugly lines with linear filtering
-		std::memset(data, 0, atlasSize.x * atlasSize.y * 4);
+	// make spacing between textures black transparent to avoid ugly lines with linear filtering
+	pixels.clear();
+	pixels.resize(atlasSize.x * atlasSize.y * 4, 0);
 
-		for (std::vector<MemTex*>::iterator it = memtextures.begin(); it != memtextures.end(); ++it) {
-			const float4 texCoords = atlasAllocator->GetTexCoords((*it)->names[0]);
-			const float4 absCoords = atlasAllocator->GetEntry((*it)->names[0]);
-			const int xpos = absCoords.x;
-			const int ypos = absCoords.y;
-
-			AtlasedTexture tex(texCoords);
-			for (size_t n = 0; n < (*it)->names.size(); ++n) {
-				textures[(*it)->names[n]] = tex;
-			}
+	for (std::vector<MemTex*>::iterator it = memtextures.begin(); it != memtextures.end(); ++it) {
+		const AtlasedTexture tex(atlasAllocator->GetTexCoords((*it)->names[0]));
 
-			for (int y = 0; y < (*it)->ysize; ++y) {
-				int* dst = ((int*)data) + xpos + (ypos + y) * atlasSize.x;
-				int* src = ((int*)(*it)->data) + y * (*it)->xsize;
-				memcpy(dst, src, (*it)->xsize * 4);
-			}
+		for (size_t n = 0; n < (*it)->names.size(); ++n) {
+			textures[(*it)->names[n]] = tex;
 		}
+	}
 
-		if (debug) {
-			CBitmap tex(data, atlasSize.x, atlasSize.y);
-			tex.Save(name + "-" + IntToString(atlasSize.x) + "x" + IntToString(atlasSize.y) + ".png");
+	// every texture covers its own rectangle of the atlas
+	for_mt(0, memtextures.size(), [&](const int i) {
+		const MemTex* memtex = memtextures[i];
+		const float4 absCoords = atlasAllocator->GetEntry(memtex->names[0]);
+		const int xpos = absCoords.x;
+		const int ypos = absCoords.y;
+
+		for (int y = 0; y < memtex->ysize; ++y) {
+			int* dst = ((int*)&pixels[0]) + xpos + (ypos + y) * atlasSize.x;
+			const int* src = ((const int*)memtex->data) + y * memtex->xsize;
+			memcpy(dst, src, memtex->xsize * 4);
 		}
+	});
+}
+
+void CTextureAtlas::CreateTexture(const std::vector<unsigned char>& pixels)
+{
+	if (debug) {
+		CBitmap tex(&pixels[0], atlasSize.x, atlasSize.y);
+		tex.Save(name + "-" + IntToString(atlasSize.x) + "x" + IntToString(atlasSize.y) + ".png");
 	}
 
+	PBO pbo;
+	pbo.Bind();
+	pbo.Resize(atlasSize.x * atlasSize.y * 4);
+
+	unsigned char* data = (unsigned char*)pbo.MapBuffer(GL_WRITE_ONLY);
+	std::memcpy(data, &pixels[0], atlasSize.x * atlasSize.y * 4);
 	pbo.UnmapBuffer();
 
-	const int maxMipMaps = atlasAllocator->GetMaxMipMaps();
 	glGenTextures(1, &atlasTexID);
 		glBindTexture(GL_TEXTURE_2D, atlasTexID);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -187,6 +251,121 @@ void CTextureAtlas::CreateTexture()
 	initialized = true;
 }
 
+
+
+std::string CTextureAtlas::GetCacheFileName() const
+{
+	// atlases made only of in-memory (generated) textures are not cached
+	if (files.empty())
+		return "";
+
+	const IAtlasAllocator* alloc = atlasAllocator;
+
+	CRC crc;
+	crc << allocType << int(globalRendering->supportNPOTs);
+	crc << alloc->GetMaxSize().x << alloc->GetMaxSize().y;
+
+	for (std::vector<MemTex*>::const_iterator it = memtextures.begin(); it != memtextures.end(); ++it) {
+		const MemTex* memtex = *it;
+
+		for (size_t n = 0; n < memtex->names.size(); ++n) {
+			crc.Update(memtex->names[n].data(), memtex->names[n].size());
+			crc << 0;
+		}
+
+		if (memtex->file.empty()) {
+			crc << memtex->xsize << memtex->ysize;
+			crc.Update(memtex->data, memtex->xsize * memtex->ysize * GetBPP(memtex->texType) / 8);
+			continue;
+		}
+
+		CFileHandler file(memtex->file);
+		std::vector<boost::uint8_t> fileData(file.FileSize());
+
+		// let LoadFileTextures report the missing file
+		if (fileData.empty() || file.Read(&fileData[0], fileData.size()) != int(fileData.size()))
+			return "";
+
+		crc.Update(&fileData[0], fileData.size());
+	}
+
+	return (GetAtlasCacheDir() + IntToString(crc.GetDigest(), "%08x") + ".atlas");
+}
+
+bool CTextureAtlas::ReadCache(const std::string& cacheFile, std::vector<unsigned char>& pixels)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(cacheFile).c_str(), std::ios::in | std::ios::binary);
+	char magic[sizeof(atlasCacheMagic)];
+	boost::uint32_t header[4]; // xsize, ysize, maxMipMaps, numNames
+
+	if (!file.read(magic, sizeof(magic)) || memcmp(magic, atlasCacheMagic, sizeof(magic)) != 0)
+		return false;
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+		return false;
+	if (header[0] == 0 || header[1] == 0 || header[0] > 16384 || header[1] > 16384)
+		return false;
+
+	std::map<std::string, AtlasedTexture> cachedTextures;
+
+	for (unsigned int n = 0; n < header[3]; n++) {
+		boost::uint32_t nameSize = 0;
+		float4 texCoords;
+
+		if (!file.read(reinterpret_cast<char*>(&nameSize), sizeof(nameSize)) || nameSize == 0 || nameSize > 1024)
+			return false;
+
+		std::string texName(nameSize, 0);
+
+		if (!file.read(&texName[0], nameSize))
+			return false;
+		if (!file.read(reinterpret_cast<char*>(&texCoords.x), sizeof(float) * 4))
+			return false;
+
+		cachedTextures[texName] = AtlasedTexture(texCoords);
+	}
+
+	pixels.resize(header[0] * header[1] * 4);
+
+	if (!file.read(reinterpret_cast<char*>(&pixels[0]), pixels.size()))
+		return false;
+
+	atlasSize = int2(header[0], header[1]);
+	maxMipMaps = header[2];
+
+	for (std::map<std::string, AtlasedTexture>::const_iterator it = cachedTextures.begin(); it != cachedTextures.end(); ++it) {
+		textures[it->first] = it->second;
+	}
+
+	return true;
+}
+
+void CTextureAtlas::WriteCache(const std::string& cacheFile, const std::vector<unsigned char>& pixels) const
+{
+	if (!FileSystem::CreateDirectory(GetAtlasCacheDir()))
+		return;
+
+	std::ofstream file(dataDirsAccess.LocateFile(cacheFile, FileQueryFlags::WRITE).c_str(), std::ios::out | std::ios::binary);
+	const boost::uint32_t header[4] = {
+		boost::uint32_t(atlasSize.x),
+		boost::uint32_t(atlasSize.y),
+		boost::uint32_t(maxMipMaps),
+		boost::uint32_t(textures.size())
+	};
+
+	file.write(atlasCacheMagic, sizeof(atlasCacheMagic));
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	for (std::map<std::string, AtlasedTexture>::const_iterator it = textures.begin(); it != textures.end(); ++it) {
+		const boost::uint32_t nameSize = it->first.size();
+
+		file.write(reinterpret_cast<const char*>(&nameSize), sizeof(nameSize));
+		file.write(it->first.data(), nameSize);
+		file.write(reinterpret_cast<const char*>(&it->second.x), sizeof(float) * 4);
+	}
+
+	file.write(reinterpret_cast<const char*>(&pixels[0]), pixels.size());
+}
+
 int CTextureAtlas::GetBPP(TextureType texType)
 {
 	switch(texType) {
@@ -224,6 +403,6 @@ AtlasedTexture& CTextureAtlas::GetTextureWithBackup(const std::string& name, con
 }
 
 int2 CTextureAtlas::GetSize() const {
-	return (atlasAllocator->GetAtlasSize());
+	return atlasSize;
 }
 
@@ -68,6 +68,9 @@ public:
 
 	/**
 	 * Creates the atlas containing all the specified textures.
+	 * Atlases with file textures are cached on disk, keyed by the
+	 * contents of all their inputs; on a cache hit no bitmap needs
+	 * to be decoded (AddTexFromFile only decodes in here).
 	 * @return true if suceeded, false if not all textures did fit
 	 *         into the specified maxsize.
 	 */
@@ -106,7 +109,13 @@ public:
 
 protected:
 	int GetBPP(TextureType tetxType);
-	void CreateTexture();
+	void LoadFileTextures();
+	void FillAtlas(std::vector<unsigned char>& pixels);
+	void CreateTexture(const std::vector<unsigned char>& pixels);
+
+	std::string GetCacheFileName() const;
+	bool ReadCache(const std::string& cacheFile, std::vector<unsigned char>& pixels);
+	void WriteCache(const std::string& cacheFile, const std::vector<unsigned char>& pixels) const;
 
 protected:
 	IAtlasAllocator* atlasAllocator;
@@ -114,6 +123,7 @@ protected:
 	struct MemTex
 	{
 		std::vector<std::string> names;
+		std::string file; //! non-empty until LoadFileTextures decoded it
 		int xsize, ysize;
 		TextureType texType;
 		void* data;
@@ -128,6 +138,10 @@ protected:
 	std::map<std::string, AtlasedTexture> textures;
 
 	unsigned int atlasTexID;
+	unsigned int allocType;
+
+	int2 atlasSize;
+	int maxMipMaps;
 
 	//! set to true to write finalized texture atlas to disk
 	static bool debug;
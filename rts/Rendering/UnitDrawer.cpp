@@ -58,6 +58,8 @@
 #include "System/TimeProfiler.h"
 #include "System/Util.h"
 
+#include <algorithm>
+
 #ifdef USE_GML
 #include "lib/gml/gmlsrv.h"
 extern gmlClientServer<void, int, CUnit*> *gmlProcessor;
@@ -109,6 +111,9 @@ CUnitDrawer::CUnitDrawer(): CEventClient("[CUnitDrawer]", 271828, false)
 {
 	eventHandler.AddClient(this);
 
+	culledOpaqueBinIdx = 0;
+	opaqueCullMode = CULL_DIRECT;
+
 	SetUnitDrawDist((float)configHandler->GetInt("UnitLodDist"));
 	SetUnitIconDist((float)configHandler->GetInt("UnitIconDist"));
 
@@ -333,16 +338,21 @@ inline bool CUnitDrawer::DrawUnitLOD(CUnit* unit)
 	return false;
 }
 
-inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction)
+/**
+ * Culls <unit> against the current pass and hands it to the far-texture
+ * queue where appropriate; returns true only if the unit is close enough
+ * to be drawn as a model (by a Lua material or the DrawUnitNow path).
+ */
+inline bool CUnitDrawer::CullOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction)
 {
 	if (unit == excludeUnit)
-		return;
+		return false;
 	if (unit->noDraw)
-		return;
+		return false;
 	if (unit->IsInVoid())
-		return;
+		return false;
 	if (!camera->InView(unit->drawMidPos, unit->drawRadius))
-		return;
+		return false;
 
 	if ((unit->losStatus[gu->myAllyTeam] & LOS_INLOS) || gu->spectatingFullView) {
 		if (drawReflection) {
@@ -357,12 +367,12 @@ inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, b
 					unit->drawMidPos * (-camera->GetPos().y / dif);
 			}
 			if (ground->GetApproximateHeight(zeroPos.x, zeroPos.z, false) > unit->drawRadius) {
-				return;
+				return false;
 			}
 		}
 		else if (drawRefraction) {
 			if (unit->pos.y > 0.0f) {
-				return;
+				return false;
 			}
 		}
 #ifdef USE_GML
@@ -374,11 +384,102 @@ inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, b
 			if ((unit->pos).SqDistance(camera->GetPos()) > (unit->sqRadius * unitDrawDistSqr)) {
 				farTextureHandler->Queue(unit);
 			} else {
-				if (!DrawUnitLOD(unit)) {
-					SetTeamColour(unit->team);
-					DrawUnitNow(unit);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Returns true only if <unit> passes CullOpaqueUnit and still has to be
+ * drawn by the standard (DrawUnitNow) path, ie. was not queued for a
+ * Lua material by DrawUnitLOD.
+ */
+inline bool CUnitDrawer::PrepareOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction)
+{
+	return (CullOpaqueUnit(unit, excludeUnit, drawReflection, drawRefraction) && !DrawUnitLOD(unit));
+}
+
+inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction)
+{
+	if (PrepareOpaqueUnit(unit, excludeUnit, drawReflection, drawRefraction)) {
+		SetTeamColour(unit->team);
+		DrawUnitNow(unit);
+	}
+}
+
+static bool UnitTeamCmp(const CUnit* a, const CUnit* b) { return (a->team < b->team); }
+
+void CUnitDrawer::DrawOpaqueUnitsByTeam(const std::set<CUnit*>& unitSet, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction)
+{
+	std::set<CUnit*>::const_iterator unitSetIt;
+
+	visibleOpaqueUnits.clear();
+	visibleOpaqueUnits.reserve(unitSet.size());
+
+	switch (opaqueCullMode) {
+		case CULL_RECORD: {
+			// deferred pass: remember which units of this bin survive
+			// culling so the forward pass of this frame can skip it
+			for (unitSetIt = unitSet.begin(); unitSetIt != unitSet.end(); ++unitSetIt) {
+				if (CullOpaqueUnit(*unitSetIt, excludeUnit, drawReflection, drawRefraction)) {
+					culledOpaqueUnits.push_back(*unitSetIt);
+
+					if (!DrawUnitLOD(*unitSetIt)) {
+						visibleOpaqueUnits.push_back(*unitSetIt);
+					}
 				}
 			}
+
+			culledOpaqueBinEnds.push_back(culledOpaqueUnits.size());
+		} break;
+
+		case CULL_REUSE: {
+			// forward pass after a deferred pass, same camera and bins;
+			// far-textures were already queued by the latter
+			assert(culledOpaqueBinIdx < culledOpaqueBinEnds.size());
+
+			const unsigned int binBeg = (culledOpaqueBinIdx > 0)? culledOpaqueBinEnds[culledOpaqueBinIdx - 1]: 0;
+			const unsigned int binEnd = culledOpaqueBinEnds[culledOpaqueBinIdx++];
+
+			for (unsigned int n = binBeg; n < binEnd; n++) {
+				if (!DrawUnitLOD(culledOpaqueUnits[n])) {
+					visibleOpaqueUnits.push_back(culledOpaqueUnits[n]);
+				}
+			}
+		} break;
+
+		default: {
+			for (unitSetIt = unitSet.begin(); unitSetIt != unitSet.end(); ++unitSetIt) {
+				if (PrepareOpaqueUnit(*unitSetIt, excludeUnit, drawReflection, drawRefraction)) {
+					visibleOpaqueUnits.push_back(*unitSetIt);
+				}
+			}
+		} break;
+	}
+
+	// group the survivors by team so the team-colour (a shader
+	// uniform or texture-combiner constant) changes at most once
+	// per team per texture bin rather than once per unit
+	std::stable_sort(visibleOpaqueUnits.begin(), visibleOpaqueUnits.end(), UnitTeamCmp);
+
+	int curTeam = -1;
+
+	for (std::vector<CUnit*>::const_iterator it = visibleOpaqueUnits.begin(); it != visibleOpaqueUnits.end(); ++it) {
+		CUnit* unit = *it;
+
+		if (unit->team != curTeam) {
+			SetTeamColour(curTeam = unit->team);
+		}
+
+		DrawUnitNow(unit);
+
+		// nano-frames toggle shaders and texture state, do not
+		// trust the previously set team-colour to have survived
+		if (unit->beingBuilt && unit->unitDef->showNanoFrame) {
+			curTeam = -1;
 		}
 	}
 }
@@ -426,6 +527,8 @@ void CUnitDrawer::Draw(bool drawReflection, bool drawRefraction)
 			DrawOpaqueUnits(modelType, excludeUnit, drawReflection, drawRefraction);
 			opaqueModelRenderers[modelType]->PopRenderState();
 		}
+
+		opaqueCullMode = CULL_DIRECT;
 	}
 
 	CleanUpUnitDrawing(false);
@@ -474,11 +577,23 @@ void CUnitDrawer::DrawDeferredPass(const CUnit* excludeUnit, bool drawReflection
 	{
 		GML_RECMUTEX_LOCK(unit); // Draw (lock on the bins)
 
+		// with GML the bins can change (and units die) between
+		// this and the forward pass, and large bins are culled
+		// by DrawOpaqueUnitMT anyway
+		opaqueCullMode = (GML::Enabled())? CULL_DIRECT: CULL_RECORD;
+		culledOpaqueUnits.clear();
+		culledOpaqueBinEnds.clear();
+		culledOpaqueBinIdx = 0;
+
 		for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_OTHER; modelType++) {
 			opaqueModelRenderers[modelType]->PushRenderState();
 			DrawOpaqueUnits(modelType, excludeUnit, drawReflection, drawRefraction);
 			opaqueModelRenderers[modelType]->PopRenderState();
 		}
+
+		if (opaqueCullMode == CULL_RECORD) {
+			opaqueCullMode = CULL_REUSE;
+		}
 	}
 
 	CleanUpUnitDrawing(true);
@@ -501,7 +616,6 @@ void CUnitDrawer::DrawOpaqueUnits(int modelType, const CUnit* excludeUnit, bool
 	const UnitBin& unitBin = opaqueModelRenderers[modelType]->GetUnitBin();
 
 	UnitBin::const_iterator unitBinIt;
-	UnitSet::const_iterator unitSetIt;
 
 	for (unitBinIt = unitBin.begin(); unitBinIt != unitBin.end(); ++unitBinIt) {
 		if (modelType != MODELTYPE_3DO) {
@@ -524,9 +638,7 @@ void CUnitDrawer::DrawOpaqueUnits(int modelType, const CUnit* excludeUnit, bool
 		else
 #endif
 		{
-			for (unitSetIt = unitSet.begin(); unitSetIt != unitSet.end(); ++unitSetIt) {
-				DrawOpaqueUnit(*unitSetIt, excludeUnit, drawReflection, drawRefraction);
-			}
+			DrawOpaqueUnitsByTeam(unitSet, excludeUnit, drawReflection, drawRefraction);
 		}
 	}
 
@@ -562,15 +674,49 @@ void CUnitDrawer::DrawUnitIcons(bool drawReflection)
 		glEnable(GL_ALPHA_TEST);
 		glAlphaFunc(GL_GREATER, 0.5f);
 
+		unitIcons.clear();
+
 		for (std::set<CUnit*>::iterator ui = drawIcon.begin(); ui != drawIcon.end(); ++ui) {
-			DrawIcon(*ui, false);
+			AddUnitIcon(*ui, false);
 		}
 		if (!gu->spectatingFullView) {
 			for (std::set<CUnit*>::const_iterator ui = unitRadarIcons[gu->myAllyTeam].begin(); ui != unitRadarIcons[gu->myAllyTeam].end(); ++ui) {
-				DrawIcon(*ui, ((*ui)->losStatus[gu->myAllyTeam] & (LOS_PREVLOS | LOS_CONTRADAR)) != (LOS_PREVLOS | LOS_CONTRADAR));
+				AddUnitIcon(*ui, ((*ui)->losStatus[gu->myAllyTeam] & (LOS_PREVLOS | LOS_CONTRADAR)) != (LOS_PREVLOS | LOS_CONTRADAR));
 			}
 		}
 
+		// icon types mostly share a handful of textures (radar blips
+		// all use the default one), so draw one batch per texture
+		std::stable_sort(unitIcons.begin(), unitIcons.end());
+
+		const float3& camUp = camera->up;
+		const float3& camRight = camera->right;
+
+		for (unsigned int i = 0, j = 0; i < unitIcons.size(); i = j) {
+			for (j = i + 1; j < unitIcons.size() && unitIcons[j].texID == unitIcons[i].texID; j++);
+
+			CVertexArray* va = GetVertexArray();
+			va->Initialize();
+			va->EnlargeArrays((j - i) * 4, 0, VA_SIZE_TC);
+
+			for (unsigned int k = i; k < j; k++) {
+				const UnitIcon& unitIcon = unitIcons[k];
+
+				const float3 dy = camUp    * unitIcon.scale;
+				const float3 dx = camRight * unitIcon.scale;
+				const float3 vn = unitIcon.pos - dx;
+				const float3 vp = unitIcon.pos + dx;
+
+				va->AddVertexQTC(vn - dy, 0.0f, 1.0f, unitIcon.color);
+				va->AddVertexQTC(vp - dy, 1.0f, 1.0f, unitIcon.color);
+				va->AddVertexQTC(vp + dy, 1.0f, 0.0f, unitIcon.color);
+				va->AddVertexQTC(vn + dy, 0.0f, 0.0f, unitIcon.color);
+			}
+
+			glBindTexture(GL_TEXTURE_2D, unitIcons[i].texID);
+			va->DrawArrayTC(GL_QUADS);
+		}
+
 		glDisable(GL_TEXTURE_2D);
 		glDisable(GL_ALPHA_TEST);
 
@@ -906,7 +1052,7 @@ void CUnitDrawer::DrawShadowPass()
 
 
 
-void CUnitDrawer::DrawIcon(CUnit* unit, bool useDefaultIcon)
+void CUnitDrawer::AddUnitIcon(CUnit* unit, bool useDefaultIcon)
 {
 	// If the icon is to be drawn as a radar blip, we want to get the default icon.
 	const icon::CIconData* iconData = NULL;
@@ -950,25 +1096,24 @@ void CUnitDrawer::DrawIcon(CUnit* unit, bool useDefaultIcon)
 
 	unit->iconRadius = scale; // store the icon size so that we don't have to calculate it again
 
+	UnitIcon unitIcon;
+	unitIcon.texID = iconData->GetTextureID();
+	unitIcon.pos = pos;
+	unitIcon.scale = scale;
+
 	// Is the unit selected? Then draw it white.
 	if (unit->isSelected) {
-		glColor3ub(255, 255, 255);
+		unitIcon.color[0] = unitIcon.color[1] = unitIcon.color[2] = 255;
 	} else {
-		glColor3ubv(teamHandler->Team(unit->team)->color);
-	}
+		const unsigned char* teamColor = teamHandler->Team(unit->team)->color;
 
-	// calculate the vertices
-	const float3 dy = camera->up    * scale;
-	const float3 dx = camera->right * scale;
-	const float3 vn = pos - dx;
-	const float3 vp = pos + dx;
-	const float3 vnn = vn - dy;
-	const float3 vpn = vp - dy;
-	const float3 vnp = vn + dy;
-	const float3 vpp = vp + dy;
+		unitIcon.color[0] = teamColor[0];
+		unitIcon.color[1] = teamColor[1];
+		unitIcon.color[2] = teamColor[2];
+	}
 
-	// Draw the icon.
-	iconData->Draw(vnn, vpn, vnp, vpp);
+	unitIcon.color[3] = 255;
+	unitIcons.push_back(unitIcon);
 }
 
 
@@ -1871,22 +2016,28 @@ inline void CUnitDrawer::UpdateUnitIconState(CUnit* unit) {
 
 inline void CUnitDrawer::UpdateUnitDrawPos(CUnit* u) {
 	const CTransportUnit* trans = u->GetTransporter();
+	const float3& speed = (trans != NULL)? trans->speed: u->speed;
 
-	if (!GML::SimEnabled()) {
-		if (trans != NULL) {
-			u->drawPos = u->pos + (trans->speed * globalRendering->timeOffset);
-		} else {
-			u->drawPos = u->pos + (u->speed * globalRendering->timeOffset);
-		}
-	} else {
+	// number of sim frames since the unit was last moved
+	float timeInterp = globalRendering->timeOffset;
+
+	if (GML::SimEnabled()) {
 		const float timeOffset = (1.0f * spring_tomsecs(globalRendering->lastFrameStart)) - (1.0f * u->lastUnitUpdate);
-		const float timeInterp = timeOffset * globalRendering->weightedSpeedFactor;
+		timeInterp = timeOffset * globalRendering->weightedSpeedFactor;
+	}
 
-		if (trans != NULL) {
-			u->drawPos = u->pos + (trans->speed * timeInterp);
+	if (globalRendering->interpolateDrawPos) {
+		const float3 frameDelta = u->pos - u->preFramePos;
+
+		// anything that moved much further than its speed allows was
+		// teleported (or not updated yet), do not smear it across the map
+		if (frameDelta.SqLength() <= (speed.SqLength() * 4.0f + 1.0f)) {
+			u->drawPos = u->preFramePos + frameDelta * Clamp(timeInterp, 0.0f, 1.0f);
 		} else {
-			u->drawPos = u->pos + (u->speed * timeInterp);
+			u->drawPos = u->pos;
 		}
+	} else {
+		u->drawPos = u->pos + (speed * timeInterp);
 	}
 
 	u->drawMidPos = u->drawPos + (u->midPos - u->pos);
@@ -2068,7 +2219,7 @@ inline float GetUnitIconScale(const CUnit* unit) {
 }
 
 
-void CUnitDrawer::DrawUnitMiniMapIcon(const CUnit* unit, CVertexArray* va) const {
+void CUnitDrawer::DrawUnitMiniMapIcon(const CUnit* unit, const unsigned char* const* teamColors, CVertexArray* va) const {
 	if (unit->noMinimap)
 		return;
 	if (unit->myIcon == NULL)
@@ -2076,22 +2227,8 @@ void CUnitDrawer::DrawUnitMiniMapIcon(const CUnit* unit, CVertexArray* va) const
 	if (unit->IsInVoid())
 		return;
 
-	const unsigned char defaultColor[4] = {255, 255, 255, 255};
-	const unsigned char* color = &defaultColor[0];
-
-	if (!unit->isSelected) {
-		if (minimap->UseSimpleColors()) {
-			if (unit->team == gu->myTeam) {
-				color = minimap->GetMyTeamIconColor();
-			} else if (teamHandler->Ally(gu->myAllyTeam, unit->allyteam)) {
-				color = minimap->GetAllyTeamIconColor();
-			} else {
-				color = minimap->GetEnemyTeamIconColor();
-			}
-		} else {
-			color = teamHandler->Team(unit->team)->color;
-		}
-	}
+	static const unsigned char defaultColor[4] = {255, 255, 255, 255};
+	const unsigned char* color = (!unit->isSelected)? teamColors[unit->team]: &defaultColor[0];
 
 	const float iconScale = GetUnitIconScale(unit);
 	const float3& iconPos = (!gu->spectatingFullView) ?
@@ -2117,24 +2254,60 @@ void CUnitDrawer::DrawUnitMiniMapIcons() const {
 	std::map<icon::CIconData*, std::set<const CUnit*> >::const_iterator iconIt;
 	std::set<const CUnit*>::const_iterator unitIt;
 
-	CVertexArray* va = GetVertexArray();
+	// the icon color only depends on the team (selected units are
+	// drawn white), so resolve it once per team instead of per unit
+	std::vector<const unsigned char*> teamColors(teamHandler->ActiveTeams(), NULL);
 
-	for (iconIt = unitsByIcon.begin(); iconIt != unitsByIcon.end(); ++iconIt) {
-		const icon::CIconData* icon = iconIt->first;
-		const std::set<const CUnit*>& units = iconIt->second;
+	for (int teamNum = 0; teamNum < teamHandler->ActiveTeams(); teamNum++) {
+		const CTeam* team = teamHandler->Team(teamNum);
 
-		if (icon == NULL)
+		if (minimap->UseSimpleColors()) {
+			if (teamNum == gu->myTeam) {
+				teamColors[teamNum] = minimap->GetMyTeamIconColor();
+			} else if (teamHandler->Ally(gu->myAllyTeam, teamHandler->AllyTeam(teamNum))) {
+				teamColors[teamNum] = minimap->GetAllyTeamIconColor();
+			} else {
+				teamColors[teamNum] = minimap->GetEnemyTeamIconColor();
+			}
+		} else {
+			teamColors[teamNum] = team->color;
+		}
+	}
+
+	// icon types without a (loadable) image of their own all share the
+	// default texture; draw every run of same-texture types as one batch
+	std::vector< std::pair<unsigned int, const icon::CIconData*> > iconTypes;
+	iconTypes.reserve(unitsByIcon.size());
+
+	for (iconIt = unitsByIcon.begin(); iconIt != unitsByIcon.end(); ++iconIt) {
+		if (iconIt->first == NULL)
 			continue;
-		if (units.empty())
+		if (iconIt->second.empty())
 			continue;
 
+		iconTypes.push_back(std::make_pair(iconIt->first->GetTextureID(), iconIt->first));
+	}
+
+	std::sort(iconTypes.begin(), iconTypes.end());
+
+	CVertexArray* va = GetVertexArray();
+
+	for (size_t n = 0; n < iconTypes.size(); ) {
+		const unsigned int texID = iconTypes[n].first;
+
 		va->Initialize();
-		va->EnlargeArrays(units.size() * 4, 0, VA_SIZE_2DTC);
-		icon->BindTexture();
+		iconTypes[n].second->BindTexture();
 
-		for (unitIt = units.begin(); unitIt != units.end(); ++unitIt) {
-			assert((*unitIt)->myIcon == icon);
-			DrawUnitMiniMapIcon(*unitIt, va);
+		for (; n < iconTypes.size() && iconTypes[n].first == texID; n++) {
+			const icon::CIconData* icon = iconTypes[n].second;
+			const std::set<const CUnit*>& units = unitsByIcon.find(const_cast<icon::CIconData*>(icon))->second;
+
+			va->EnlargeArrays(units.size() * 4, 0, VA_SIZE_2DTC);
+
+			for (unitIt = units.begin(); unitIt != units.end(); ++unitIt) {
+				assert((*unitIt)->myIcon == icon);
+				DrawUnitMiniMapIcon(*unitIt, &teamColors[0], va);
+			}
 		}
 
 		va->DrawArray2dTC(GL_QUADS);
@@ -149,7 +149,10 @@ public:
 
 private:
 	bool DrawUnitLOD(CUnit* unit);
+	bool CullOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction);
+	bool PrepareOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction);
 	void DrawOpaqueUnit(CUnit* unit, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction);
+	void DrawOpaqueUnitsByTeam(const std::set<CUnit*>& unitSet, const CUnit* excludeUnit, bool drawReflection, bool drawRefraction);
 	void DrawOpaqueUnitShadow(CUnit* unit);
 	void DrawOpaqueUnitsShadow(int modelType);
 
@@ -163,7 +166,7 @@ private:
 	void DrawGhostedBuildings(int modelType);
 
 	void DrawUnitIcons(bool drawReflection);
-	void DrawUnitMiniMapIcon(const CUnit* unit, CVertexArray* va) const;
+	void DrawUnitMiniMapIcon(const CUnit* unit, const unsigned char* const* teamColors, CVertexArray* va) const;
 	void UpdateUnitMiniMapIcon(const CUnit* unit, bool forced, bool killed);
 
 	bool UpdateGeometryBuffer(bool init);
@@ -176,7 +179,7 @@ private:
 	void UpdateUnitIconState(CUnit* unit);
 	static void UpdateUnitDrawPos(CUnit* unit);
 
-	static void DrawIcon(CUnit* unit, bool asRadarBlip);
+	void AddUnitIcon(CUnit* unit, bool asRadarBlip);
 	void DrawCloakedUnitsHelper(int modelType);
 	void DrawCloakedUnit(CUnit* unit, int modelType, bool drawGhostBuildingsPass);
 
@@ -250,6 +253,33 @@ private:
 	std::vector<std::set<CUnit*> > liveGhostBuildings;
 
 	std::set<CUnit*> drawIcon;
+
+	struct UnitIcon {
+		bool operator < (const UnitIcon& i) const { return (texID < i.texID); }
+
+		unsigned int texID;
+		unsigned char color[4];
+		float3 pos;
+		float scale;
+	};
+
+	/// icons gathered by DrawUnitIcons, drawn in one batch per texture
+	std::vector<UnitIcon> unitIcons;
+	/// scratch-buffer for DrawOpaqueUnitsByTeam, reused across bins
+	std::vector<CUnit*> visibleOpaqueUnits;
+
+	enum {
+		CULL_DIRECT = 0, ///< cull every unit of every bin
+		CULL_RECORD = 1, ///< deferred pass, cull and fill culledOpaque*
+		CULL_REUSE  = 2, ///< forward pass, take the deferred pass' results
+	};
+
+	/// units of all opaque bins that passed CullOpaqueUnit in the deferred
+	/// pass, stored back to back; bin i ends at culledOpaqueBinEnds[i]
+	std::vector<CUnit*> culledOpaqueUnits;
+	std::vector<unsigned int> culledOpaqueBinEnds;
+	unsigned int culledOpaqueBinIdx;
+	int opaqueCullMode;
 #ifdef USE_GML
 	std::set<CUnit*> drawStat;
 #endif
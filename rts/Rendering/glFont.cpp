@@ -48,6 +48,7 @@ CglFont* smallFont;
 #define GLYPH_MARGIN 2 //! margin between glyphs in texture-atlas
 
 static const unsigned char nullChar = 0;
+static const size_t MAX_CACHED_LAYOUTS = 512; //! per font and decoration
 static const float4        white(1.00f, 1.00f, 1.00f, 0.95f);
 static const float4  darkOutline(0.05f, 0.05f, 0.05f, 0.95f);
 static const float4 lightOutline(0.95f, 0.95f, 0.95f, 0.8f);
@@ -1682,7 +1683,26 @@ void CglFont::End()
 }
 
 
-void CglFont::RenderString(float x, float y, const float& scaleX, const float& scaleY, const std::string& str)
+const CglFont::TextLayout& CglFont::GetTextLayout(const std::string& str, TextDecoration decoration)
+{
+	TextLayoutCache& cache = layoutCaches[decoration];
+	TextLayoutCache::iterator it = cache.find(str);
+
+	if (it != cache.end())
+		return it->second;
+
+	// texts that change every frame (clocks, counters) would make the cache
+	// grow without bound; just start over, the static ones come back quickly
+	if (cache.size() >= MAX_CACHED_LAYOUTS)
+		cache.clear();
+
+	TextLayout& layout = cache[str];
+	BuildTextLayout(str, decoration, &layout);
+	return layout;
+}
+
+
+void CglFont::BuildTextLayout(const std::string& str, TextDecoration decoration, TextLayout* layout) const
 {
 	/**
 	 * NOTE:
@@ -1694,76 +1714,48 @@ void CglFont::RenderString(float x, float y, const float& scaleX, const float& s
 	 * 2. We can now eliminate all glPushMatrix/PopMatrix pairs related to font rendering
 	 *    because the transformations are calculated on the fly. These are just a couple of
 	 *    floating point multiplications and shouldn't be too expensive.
+	 *
+	 * The glyphs are laid out at size 1 here, RenderTextLayout scales and
+	 * translates them per glPrint call.
 	 */
 
-	const float startx = x;
-	const float lineHeight_ = scaleY * lineHeight;
-	unsigned int length = (unsigned int)str.length();
+	layout->width = GetTextWidth(str);
+	layout->height = GetTextHeight(str, &layout->descender);
 
-	va->EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
-
-	int skippedLines;
-	bool endOfString, colorChanged;
-	const GlyphInfo* g = NULL;
-	const unsigned char* c;
-	float4 newColor; newColor[3] = 1.0f;
-	unsigned int i = 0;
-
-	do {
-		endOfString = SkipColorCodesAndNewLines(str, &i, &newColor, &colorChanged, &skippedLines, &baseTextColor);
-
-		if (endOfString)
-			return;
-
-		c  = reinterpret_cast<const unsigned char*>(&str[i]);
-		++i;
-
-		if (colorChanged) {
-			if (autoOutlineColor) {
-				SetColors(&newColor,NULL);
-			} else {
-				SetTextColor(&newColor);
-			}
-		}
-
-		if (skippedLines>0) {
-			x  = startx;
-			y -= skippedLines * lineHeight_;
-		} else if (g) {
-			x += scaleX * g->kerning[*c];
-		}
-
-		g = &glyphs[*c];
-
-		va->AddVertex2dQT(x+scaleX*g->x0, y+scaleY*g->y1, g->u0, g->v1);
-		va->AddVertex2dQT(x+scaleX*g->x0, y+scaleY*g->y0, g->u0, g->v0);
-		va->AddVertex2dQT(x+scaleX*g->x1, y+scaleY*g->y0, g->u1, g->v0);
-		va->AddVertex2dQT(x+scaleX*g->x1, y+scaleY*g->y1, g->u1, g->v1);
-	} while(true);
-}
+	//! offsets of the shadow / outline quads
+	float shiftX = 0.0f, shiftY = 0.0f;
+	float ssX = 0.0f, ssY = 0.0f;
 
+	if (decoration == DECORATION_SHADOW) {
+		shiftX = 0.1f; shiftY = 0.1f;
+		ssX = outlineWidth / fontSize; ssY = outlineWidth / fontSize;
+	} else if (decoration == DECORATION_OUTLINE) {
+		ssX = outlineWidth / fontSize; ssY = outlineWidth / fontSize;
+	}
 
-void CglFont::RenderStringShadow(float x, float y, const float& scaleX, const float& scaleY, const std::string& str)
-{
-	const float shiftX = scaleX*0.1, shiftY = scaleY*0.1;
-	const float ssX = (scaleX/fontSize)*outlineWidth, ssY = (scaleY/fontSize)*outlineWidth;
+	layout->textVerts.reserve(str.length() * 4 * 4);
+	if (decoration != DECORATION_NONE)
+		layout->outlineVerts.reserve(str.length() * 4 * 4);
 
-	const float startx = x;
-	const float lineHeight_ = scaleY * lineHeight;
-	unsigned int length = (unsigned int)str.length();
+	//! the sentinel color is only used to track which components are
+	//! still taken from the base color after a ::ColorResetIndicator
+	static const float4 baseColorSentinel(-1.0f, -1.0f, -1.0f, -1.0f);
 
-	va->EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
-	va2->EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
+	float x = 0.0f;
+	float y = 0.0f;
 
 	int skippedLines;
 	bool endOfString, colorChanged;
 	const GlyphInfo* g = NULL;
 	const unsigned char* c;
 	float4 newColor; newColor[3] = 1.0f;
+	float4 baseColor = baseColorSentinel;
+	bool baseRGB = false;
+	bool baseAlpha = false;
 	unsigned int i = 0;
 
 	do {
-		endOfString = SkipColorCodesAndNewLines(str, &i, &newColor, &colorChanged, &skippedLines, &baseTextColor);
+		endOfString = SkipColorCodesAndNewLines(str, &i, &newColor, &colorChanged, &skippedLines, &baseColor);
 
 		if (endOfString)
 			return;
@@ -1772,99 +1764,104 @@ void CglFont::RenderStringShadow(float x, float y, const float& scaleX, const fl
 		++i;
 
 		if (colorChanged) {
-			if (autoOutlineColor) {
-				SetColors(&newColor,NULL);
-			} else {
-				SetTextColor(&newColor);
-			}
+			// a reset copies the sentinel into all four components,
+			// a colorcode then overwrites only the rgb ones
+			baseRGB = (newColor[0] == baseColorSentinel[0]);
+			baseAlpha = (newColor[3] == baseColorSentinel[3]);
+
+			LayoutColorChange cc;
+				cc.numTextVerts = layout->textVerts.size() / 4;
+				cc.numOutlineVerts = layout->outlineVerts.size() / 4;
+				cc.color = newColor;
+				cc.baseRGB = baseRGB;
+				cc.baseAlpha = baseAlpha;
+			layout->colorChanges.push_back(cc);
 		}
 
 		if (skippedLines>0) {
-			x  = startx;
-			y -= skippedLines * lineHeight_;
+			x  = 0.0f;
+			y -= skippedLines * lineHeight;
 		} else if (g) {
-			x += scaleX * g->kerning[*c];
+			x += g->kerning[*c];
 		}
 
 		g = &glyphs[*c];
 
-		const float dx0 = x + scaleX * g->x0, dy0 = y + scaleY * g->y0;
-		const float dx1 = x + scaleX * g->x1, dy1 = y + scaleY * g->y1;
-
-		//! draw shadow
-		va2->AddVertex2dQT(dx0+shiftX-ssX, dy1-shiftY-ssY, g->us0, g->vs1);
-		va2->AddVertex2dQT(dx0+shiftX-ssX, dy0-shiftY+ssY, g->us0, g->vs0);
-		va2->AddVertex2dQT(dx1+shiftX+ssX, dy0-shiftY+ssY, g->us1, g->vs0);
-		va2->AddVertex2dQT(dx1+shiftX+ssX, dy1-shiftY-ssY, g->us1, g->vs1);
+		const float dx0 = x + g->x0, dy0 = y + g->y0;
+		const float dx1 = x + g->x1, dy1 = y + g->y1;
+
+		if (decoration != DECORATION_NONE) {
+			//! shadow or outline
+			const float verts[] = {
+				dx0+shiftX-ssX, dy1-shiftY-ssY, g->us0, g->vs1,
+				dx0+shiftX-ssX, dy0-shiftY+ssY, g->us0, g->vs0,
+				dx1+shiftX+ssX, dy0-shiftY+ssY, g->us1, g->vs0,
+				dx1+shiftX+ssX, dy1-shiftY-ssY, g->us1, g->vs1,
+			};
+			layout->outlineVerts.insert(layout->outlineVerts.end(), verts, verts + 16);
+		}
 
-		//! draw the actual character
-		va->AddVertex2dQT(dx0, dy1, g->u0, g->v1);
-		va->AddVertex2dQT(dx0, dy0, g->u0, g->v0);
-		va->AddVertex2dQT(dx1, dy0, g->u1, g->v0);
-		va->AddVertex2dQT(dx1, dy1, g->u1, g->v1);
+		//! the actual character
+		const float verts[] = {
+			dx0, dy1, g->u0, g->v1,
+			dx0, dy0, g->u0, g->v0,
+			dx1, dy0, g->u1, g->v0,
+			dx1, dy1, g->u1, g->v1,
+		};
+		layout->textVerts.insert(layout->textVerts.end(), verts, verts + 16);
 	} while(true);
 }
 
 
-void CglFont::RenderStringOutlined(float x, float y, const float& scaleX, const float& scaleY, const std::string& str)
+void CglFont::RenderTextLayout(const TextLayout& layout, float x, float y, const float& scaleX, const float& scaleY)
 {
-	const float shiftX = (scaleX/fontSize)*outlineWidth, shiftY = (scaleY/fontSize)*outlineWidth;
-
-	const float startx = x;
-	const float lineHeight_ = scaleY * lineHeight;
-	unsigned int length = (unsigned int)str.length();
+	const unsigned int numTextVerts = layout.textVerts.size() / 4;
+	const unsigned int numOutlineVerts = layout.outlineVerts.size() / 4;
 
-	va->EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
-	va2->EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
-
-	int skippedLines;
-	bool endOfString, colorChanged;
-	const GlyphInfo* g = NULL;
-	const unsigned char* c;
-	float4 newColor; newColor[3] = 1.0f;
-	unsigned int i = 0;
+	va->EnlargeArrays(numTextVerts, 0, VA_SIZE_2DT);
+	va2->EnlargeArrays(numOutlineVerts, 0, VA_SIZE_2DT);
 
-	do {
-		endOfString = SkipColorCodesAndNewLines(str, &i, &newColor, &colorChanged, &skippedLines, &baseTextColor);
+	const float* tv = (layout.textVerts.empty())? NULL: &layout.textVerts[0];
+	const float* ov = (layout.outlineVerts.empty())? NULL: &layout.outlineVerts[0];
 
-		if (endOfString)
-			return;
+	unsigned int t = 0;
+	unsigned int o = 0;
 
-		c  = reinterpret_cast<const unsigned char*>(&str[i]);
-		++i;
+	for (unsigned int n = 0; n <= layout.colorChanges.size(); n++) {
+		const bool last = (n == layout.colorChanges.size());
+		const unsigned int tEnd = (last)? numTextVerts: layout.colorChanges[n].numTextVerts;
+		const unsigned int oEnd = (last)? numOutlineVerts: layout.colorChanges[n].numOutlineVerts;
 
-		if (colorChanged) {
-			if (autoOutlineColor) {
-				SetColors(&newColor,NULL);
-			} else {
-				SetTextColor(&newColor);
-			}
+		for (; o < oEnd; o++) {
+			const float* v = ov + o * 4;
+			va2->AddVertex2dQT(x + scaleX * v[0], y + scaleY * v[1], v[2], v[3]);
 		}
-
-		if (skippedLines>0) {
-			x  = startx;
-			y -= skippedLines * lineHeight_;
-		} else if (g) {
-			x += scaleX * g->kerning[*c];
+		for (; t < tEnd; t++) {
+			const float* v = tv + t * 4;
+			va->AddVertex2dQT(x + scaleX * v[0], y + scaleY * v[1], v[2], v[3]);
 		}
 
-		g = &glyphs[*c];
+		if (last)
+			break;
 
-		const float dx0 = x + scaleX * g->x0, dy0 = y + scaleY * g->y0;
-		const float dx1 = x + scaleX * g->x1, dy1 = y + scaleY * g->y1;
+		const LayoutColorChange& cc = layout.colorChanges[n];
 
-		//! draw outline
-		va2->AddVertex2dQT(dx0-shiftX, dy1-shiftY, g->us0, g->vs1);
-		va2->AddVertex2dQT(dx0-shiftX, dy0+shiftY, g->us0, g->vs0);
-		va2->AddVertex2dQT(dx1+shiftX, dy0+shiftY, g->us1, g->vs0);
-		va2->AddVertex2dQT(dx1+shiftX, dy1-shiftY, g->us1, g->vs1);
+		float4 newColor = cc.color;
+		if (cc.baseRGB) {
+			newColor[0] = baseTextColor[0];
+			newColor[1] = baseTextColor[1];
+			newColor[2] = baseTextColor[2];
+		}
+		if (cc.baseAlpha) {
+			newColor[3] = baseTextColor[3];
+		}
 
-		//! draw the actual character
-		va->AddVertex2dQT(dx0, dy1, g->u0, g->v1);
-		va->AddVertex2dQT(dx0, dy0, g->u0, g->v0);
-		va->AddVertex2dQT(dx1, dy0, g->u1, g->v0);
-		va->AddVertex2dQT(dx1, dy1, g->u1, g->v1);
-	} while(true);
+		if (autoOutlineColor) {
+			SetColors(&newColor,NULL);
+		} else {
+			SetTextColor(&newColor);
+		}
+	}
 }
 
 
@@ -1896,11 +1893,21 @@ void CglFont::glPrint(float x, float y, float s, const int options, const std::s
 		sizeY *= globalRendering->pixelY;
 	}
 
+	TextDecoration decoration = DECORATION_NONE;
+	if (options & FONT_OUTLINE) {
+		decoration = DECORATION_OUTLINE;
+	} else if (options & FONT_SHADOW) {
+		decoration = DECORATION_SHADOW;
+	}
+
+	//! unchanged texts (tooltips, console) are not laid out again every frame
+	const TextLayout& layout = GetTextLayout(text, decoration);
+
 	//! horizontal alignment (FONT_LEFT is default)
 	if (options & FONT_CENTER) {
-		x -= sizeX * 0.5f * GetTextWidth(text);
+		x -= sizeX * 0.5f * layout.width;
 	} else if (options & FONT_RIGHT) {
-		x -= sizeX * GetTextWidth(text);
+		x -= sizeX * layout.width;
 	}
 
 
@@ -1911,18 +1918,15 @@ void CglFont::glPrint(float x, float y, float s, const int options, const std::s
 	} else if (options & FONT_DESCENDER) {
 		y -= sizeY * fontDescender;
 	} else if (options & FONT_VCENTER) {
-		float textDescender;
-		y -= sizeY * 0.5f * GetTextHeight(text,&textDescender);
-		y -= sizeY * 0.5f * textDescender;
+		y -= sizeY * 0.5f * layout.height;
+		y -= sizeY * 0.5f * layout.descender;
 	} else if (options & FONT_TOP) {
-		y -= sizeY * GetTextHeight(text);
+		y -= sizeY * layout.height;
 	} else if (options & FONT_ASCENDER) {
 		y -= sizeY * fontDescender;
 		y -= sizeY;
 	} else if (options & FONT_BOTTOM) {
-		float textDescender;
-		GetTextHeight(text,&textDescender);
-		y -= sizeY * textDescender;
+		y -= sizeY * layout.descender;
 	}
 
 	if (options & FONT_NEAREST) {
@@ -1941,14 +1945,7 @@ void CglFont::glPrint(float x, float y, float s, const int options, const std::s
 	}
 
 
-	//! select correct decoration RenderString function
-	if (options & FONT_OUTLINE) {
-		RenderStringOutlined(x, y, sizeX, sizeY, text);
-	} else if (options & FONT_SHADOW) {
-		RenderStringShadow(x, y, sizeX, sizeY, text);
-	} else {
-		RenderString(x, y, sizeX, sizeY, text);
-	}
+	RenderTextLayout(layout, x, y, sizeX, sizeY);
 
 
 	//! immediate mode?
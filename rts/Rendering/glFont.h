@@ -5,6 +5,8 @@
 
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
 #include <limits.h> // for INT_MAX
 
 #include "System/float4.h"
@@ -120,9 +122,49 @@ public:
 private:
 	static const float4* ChooseOutlineColor(const float4& textColor);
 
-	void RenderString(float x, float y, const float& scaleX, const float& scaleY, const std::string& str);
-	void RenderStringShadow(float x, float y, const float& scaleX, const float& scaleY, const std::string& str);
-	void RenderStringOutlined(float x, float y, const float& scaleX, const float& scaleY, const std::string& str);
+	enum TextDecoration {
+		DECORATION_NONE    = 0,
+		DECORATION_SHADOW  = 1,
+		DECORATION_OUTLINE = 2,
+		DECORATION_COUNT   = 3
+	};
+
+	/**
+	 * In-text colorcode change, applied before the glyph following
+	 * <numTextVerts> (and <numOutlineVerts>) vertices is emitted.
+	 * The color can partially come from the color glPrint was called
+	 * with (because of ::ColorResetIndicator), so that is resolved only
+	 * when rendering.
+	 */
+	struct LayoutColorChange {
+		unsigned int numTextVerts;
+		unsigned int numOutlineVerts;
+		float4 color;
+		bool baseRGB;   //! take rgb from the base text color
+		bool baseAlpha; //! take alpha from the base text color
+	};
+
+	/**
+	 * Glyph quads of a string at size 1 with the pen at the origin, plus
+	 * its metrics; independent of position, size and colors, so cached.
+	 */
+	struct TextLayout {
+		TextLayout(): width(0.0f), height(0.0f), descender(0.0f) {}
+
+		std::vector<float> textVerts;    //! (x, y, s, t) per vertex
+		std::vector<float> outlineVerts; //! shadow or outline quads
+		std::vector<LayoutColorChange> colorChanges;
+
+		float width;
+		float height;
+		float descender;
+	};
+
+	typedef std::map<std::string, TextLayout> TextLayoutCache;
+
+	const TextLayout& GetTextLayout(const std::string& str, TextDecoration decoration);
+	void BuildTextLayout(const std::string& str, TextDecoration decoration, TextLayout* layout) const;
+	void RenderTextLayout(const TextLayout& layout, float x, float y, const float& scaleX, const float& scaleY);
 
 private:
 	struct colorcode {
@@ -184,6 +226,8 @@ private:
 	CVertexArray* va;
 	CVertexArray* va2;
 
+	TextLayoutCache layoutCaches[DECORATION_COUNT];
+
 	bool autoOutlineColor; //! auto select outline color for in-text-colorcodes
 
 	bool setColor; //! used for backward compability (so you can call glPrint (w/o BeginEnd and no shadow/outline!) and set the color yourself via glColor)
@@ -8,7 +8,6 @@
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Units/CommandAI/BuilderCAI.h"
-#include "System/creg/STL_List.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
 #include "System/myMath.h"
@@ -16,6 +15,8 @@
 #include "System/TimeProfiler.h"
 #include "System/creg/STL_Set.h"
 
+#include <algorithm>
+
 CFeatureHandler* featureHandler = NULL;
 
 /******************************************************************************/
@@ -437,18 +438,23 @@ void CFeatureHandler::Update()
 	SCOPED_TIMER("FeatureHandler::Update");
 
 	if ((gs->frameNum & 31) == 0) {
-		for (std::list<int>::iterator it = toBeFreedFeatureIDs.begin(); it != toBeFreedFeatureIDs.end(); ) {
-			if (CBuilderCAI::IsFeatureBeingReclaimed(*it)) {
+		unsigned int numKept = 0;
+
+		for (unsigned int n = 0; n < toBeFreedFeatureIDs.size(); n++) {
+			const int featureID = toBeFreedFeatureIDs[n];
+
+			if (CBuilderCAI::IsFeatureBeingReclaimed(featureID)) {
 				// postpone putting this ID back into the free pool
 				// (this gives area-reclaimers time to choose a new
 				// target with a different ID)
-				++it;
+				toBeFreedFeatureIDs[numKept++] = featureID;
 			} else {
-				assert(features[*it] == NULL);
-				idPool.FreeID(*it, true);
-				it = toBeFreedFeatureIDs.erase(it);
+				assert(features[featureID] == NULL);
+				idPool.FreeID(featureID, true);
 			}
 		}
+
+		toBeFreedFeatureIDs.resize(numKept);
 	}
 
 	{
@@ -484,19 +490,25 @@ void CFeatureHandler::Update()
 		eventHandler.UpdateFeatures();
 	}
 
-	CFeatureSet::iterator fi = updateFeatures.begin();
+	// features that finish updating drop out of the queue in place (keeping
+	// the order of the rest); any that get woken up from inside the loop
+	// (e.g. by Lua in FeatureMoved) are appended and still updated this frame
+	unsigned int numAwake = 0;
 
-	while (fi != updateFeatures.end()) {
-		CFeature* feature = *fi;
-		++fi;
+	for (unsigned int n = 0; n < updateFeatures.size(); n++) {
+		CFeature* feature = updateFeatures[n];
 
 		assert(feature->inUpdateQue);
 
-		if (!feature->Update()) {
-			// feature is done updating itself, remove from queue
-			SetFeatureUpdateable(feature, false);
+		if (feature->Update()) {
+			updateFeatures[numAwake++] = feature;
+		} else {
+			// feature is done updating itself, put it to sleep
+			feature->inUpdateQue = false;
 		}
 	}
+
+	updateFeatures.resize(numAwake);
 }
 
 
@@ -504,18 +516,19 @@ void CFeatureHandler::SetFeatureUpdateable(CFeature* feature, bool updateable)
 {
 	if (updateable) {
 		if (feature->inUpdateQue) {
-			assert(updateFeatures.find(feature) != updateFeatures.end());
+			assert(std::find(updateFeatures.begin(), updateFeatures.end(), feature) != updateFeatures.end());
 			return;
 		}
 
-		updateFeatures.insert(feature);
+		updateFeatures.push_back(feature);
 	} else {
 		if (!feature->inUpdateQue) {
-			assert(updateFeatures.find(feature) == updateFeatures.end());
+			assert(std::find(updateFeatures.begin(), updateFeatures.end(), feature) == updateFeatures.end());
 			return;
 		}
 
-		updateFeatures.erase(feature);
+		// only reached from ~CFeature, never while Update iterates the queue
+		updateFeatures.erase(std::find(updateFeatures.begin(), updateFeatures.end(), feature));
 	}
 
 	feature->inUpdateQue = updateable;
@@ -529,12 +542,20 @@ void CFeatureHandler::TerrainChanged(int x1, int y1, int x2, int y2)
 		float3(x2 * SQUARE_SIZE, 0, y2 * SQUARE_SIZE)
 	);
 
+	// features overlapping several quads only need to be visited once
+	const int tempNum = gs->tempNum++;
+
 	for (std::vector<int>::const_iterator qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CFeature*>::const_iterator fi;
-		const std::list<CFeature*>& features = quadField->GetQuad(*qi).features;
+		std::vector<CFeature*>::const_iterator fi;
+		const std::vector<CFeature*>& features = quadField->GetQuad(*qi).features;
 
 		for (fi = features.begin(); fi != features.end(); ++fi) {
 			CFeature* feature = *fi;
+
+			if (feature->tempNum == tempNum)
+				continue;
+
+			feature->tempNum = tempNum;
 			feature->UpdateFinalHeight(true);
 
 			// put this feature back in the update-queue
@@ -91,12 +91,13 @@ private:
 	std::map<std::string, const FeatureDef*> featureDefs;
 	std::vector<const FeatureDef*> featureDefsVector;
 
-	std::list<int> toBeFreedFeatureIDs;
+	std::vector<int> toBeFreedFeatureIDs;
 	CFeatureSet activeFeatures;
 	std::vector<CFeature*> features;
 
-	std::list<int> toBeRemoved;
-	CFeatureSet updateFeatures;
+	std::vector<int> toBeRemoved;
+	/// features that are not asleep (moving, burning, smoking, ...)
+	std::vector<CFeature*> updateFeatures;
 };
 
 extern CFeatureHandler* featureHandler;
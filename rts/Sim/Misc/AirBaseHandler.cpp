@@ -18,7 +18,9 @@ CR_BIND(CAirBaseHandler, )
 CR_REG_METADATA(CAirBaseHandler,(
 	CR_MEMBER(bases),
 	CR_MEMBER(airBaseIDs),
-	CR_RESERVED(16)
+	CR_IGNORED(numFreePads),
+	CR_RESERVED(16),
+	CR_POSTLOAD(PostLoad)
 ));
 
 CR_BIND_DERIVED(CAirBaseHandler::LandingPad, CObject, (0, 0, NULL));
@@ -38,10 +40,24 @@ CR_REG_METADATA_SUB(CAirBaseHandler, AirBase, (
 ));
 
 
-CAirBaseHandler::CAirBaseHandler() : bases(teamHandler->ActiveAllyTeams())
+CAirBaseHandler::CAirBaseHandler()
+	: bases(teamHandler->ActiveAllyTeams())
+	, numFreePads(teamHandler->ActiveAllyTeams(), 0)
 {
 }
 
+void CAirBaseHandler::PostLoad()
+{
+	numFreePads.clear();
+	numFreePads.resize(bases.size(), 0);
+
+	for (unsigned int a = 0; a < bases.size(); ++a) {
+		for (AirBaseLstIt bi = bases[a].begin(); bi != bases[a].end(); ++bi) {
+			numFreePads[a] += (*bi)->freePads.size();
+		}
+	}
+}
+
 
 CAirBaseHandler::~CAirBaseHandler()
 {
@@ -86,6 +102,7 @@ void CAirBaseHandler::RegisterAirBase(CUnit* owner)
 	}
 
 	bases[owner->allyteam].push_back(ab);
+	numFreePads[owner->allyteam] += ab->freePads.size();
 	airBaseIDs.insert(owner->id);
 }
 
@@ -102,6 +119,7 @@ void CAirBaseHandler::DeregisterAirBase(CUnit* base)
 				// the unit that has reserved a pad is responsible to see if the pad is gone so just delete it
 				delete *pi;
 			}
+			numFreePads[base->allyteam] -= (*bi)->freePads.size();
 			delete *bi;
 			bases[base->allyteam].erase(bi);
 			break;
@@ -114,12 +132,18 @@ void CAirBaseHandler::DeregisterAirBase(CUnit* base)
 void CAirBaseHandler::LeaveLandingPad(LandingPad* pad)
 {
 	pad->GetBase()->freePads.push_back(pad);
+	numFreePads[pad->GetBase()->unit->allyteam] += 1;
 }
 
 
 
 CAirBaseHandler::LandingPad* CAirBaseHandler::FindAirBase(CUnit* unit, float minPower, bool wantFreePad)
 {
+	if (wantFreePad && numFreePads[unit->allyteam] == 0) {
+		// every pad of our allyteam is taken (or there are no bases)
+		return NULL;
+	}
+
 	float minDist = std::numeric_limits<float>::max();
 
 	AirBaseLstIt foundBaseIt = bases[unit->allyteam].end();
@@ -132,15 +156,14 @@ CAirBaseHandler::LandingPad* CAirBaseHandler::FindAirBase(CUnit* unit, float min
 			// do not pick ourselves as a landing pad
 			continue;
 		}
-		if (baseUnit->beingBuilt || baseUnit->IsStunned()) {
+		if (wantFreePad && base->freePads.empty()) {
 			continue;
 		}
-
-		if (baseUnit->pos.SqDistance(unit->pos) >= minDist || baseUnit->unitDef->buildSpeed < minPower) {
+		if (baseUnit->beingBuilt || baseUnit->IsStunned()) {
 			continue;
 		}
 
-		if (wantFreePad && base->freePads.empty()) {
+		if (baseUnit->pos.SqDistance(unit->pos) >= minDist || baseUnit->unitDef->buildSpeed < minPower) {
 			continue;
 		}
 
@@ -154,6 +177,7 @@ CAirBaseHandler::LandingPad* CAirBaseHandler::FindAirBase(CUnit* unit, float min
 		if (wantFreePad) {
 			LandingPad* foundPad = foundBase->freePads.front();
 			foundBase->freePads.pop_front();
+			numFreePads[unit->allyteam] -= 1;
 			return foundPad;
 		} else {
 			if (!foundBase->pads.empty())
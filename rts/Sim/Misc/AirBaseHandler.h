@@ -72,6 +72,7 @@ public:
 	float3 FindClosestAirBasePos(CUnit* unit, float minPower);
 
 	bool HaveAirBase(int allyTeam) const { return (!bases[allyTeam].empty()); }
+	bool HaveFreePad(int allyTeam) const { return (numFreePads[allyTeam] > 0); }
 
 private:
 	typedef std::list<AirBase*> AirBaseLst;
@@ -79,8 +80,14 @@ private:
 	typedef std::list<LandingPad*> PadLst;
 	typedef std::list<LandingPad*>::iterator PadLstIt;
 
+	void PostLoad();
+
 	std::vector<AirBaseLst> bases;
 
+	/// total size of the freePads lists per allyteam, lets aircraft that
+	/// poll for a pad while all are taken skip walking the bases
+	std::vector<int> numFreePads;
+
 	// IDs of units registered as airbases
 	std::set<int> airBaseIDs;
 };
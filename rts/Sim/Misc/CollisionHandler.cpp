@@ -11,16 +11,18 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "System/FastMath.h"
 #include "System/Matrix44f.h"
+#include "System/myMath.h"
 #include "System/Log/ILog.h"
 
 unsigned int CCollisionHandler::numDiscTests = 0;
 unsigned int CCollisionHandler::numContTests = 0;
+unsigned int CCollisionHandler::numNodeTests = 0;
 
 
 
 void CCollisionHandler::PrintStats()
 {
-	LOG("[CCollisionHandler] dis-/continuous tests: %i/%i", numDiscTests, numContTests);
+	LOG("[CCollisionHandler] dis-/continuous tests: %i/%i, piece-tree node tests: %i", numDiscTests, numContTests, numNodeTests);
 }
 
 
@@ -215,38 +217,61 @@ bool CCollisionHandler::MouseHit(const CUnit* u, const float3& p0, const float3&
 }
 
 
-/*
-bool CCollisionHandler::IntersectPieceTreeHelper(
-	LocalModelPiece* lmp,
-	const CMatrix44f& mat,
+// true iff the segment <p0, p1> passes within <r> of <c>
+static inline bool SegmentHitsSphere(const float3& p0, const float3& p1, const float3& c, float r)
+{
+	const float3 pv = p1 - p0;
+	const float3 cv = c - p0;
+
+	const float pvSqLen = pv.SqLength();
+	const float t = (pvSqLen > 0.0f)? Clamp(cv.dot(pv) / pvSqLen, 0.0f, 1.0f): 0.0f;
+
+	return ((cv - pv * t).SqLength() <= (r * r));
+}
+
+void CCollisionHandler::IntersectPieceTreeHelper(
+	const LocalModelPiece* lmp,
+	const CMatrix44f& unitMat,
 	const float3& p0,
 	const float3& p1,
+	const float3& mp0,
+	const float3& mp1,
 	std::list<CollisionQuery>* cqs
 ) {
-	bool ret = false;
+	// extra margin so that rounding in the inverse unit transform
+	// can never reject a volume the exact test below would accept
+	static const float BOUNDS_SLACK = 1.0f;
 
-	CollisionVolume* lmpVol = lmp->GetCollisionVolume();
-	CMatrix44f volMat = lmp->GetModelSpaceMatrix() * mat;
+	// negative radius means the bounds are stale, visit everything
+	const bool haveBounds = (lmp->GetTreeBoundsRadius() >= 0.0f);
+
+	numNodeTests += 1;
+
+	if (haveBounds && !SegmentHitsSphere(mp0, mp1, lmp->GetTreeBoundsCenter(), lmp->GetTreeBoundsRadius() + BOUNDS_SLACK))
+		return;
+
+	const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
 
 	if (lmp->scriptSetVisible && !lmpVol->IgnoreHits()) {
-		volMat.Translate(lmpVol->GetOffsets());
+		if (!haveBounds || SegmentHitsSphere(mp0, mp1, lmp->GetVolumeBoundsCenter(), lmp->GetVolumeBoundsRadius() + BOUNDS_SLACK)) {
+			CMatrix44f volMat = unitMat * lmp->GetModelSpaceMatrix();
+			CollisionQuery cq;
 
-		CollisionQuery cq;
+			volMat.Translate(lmpVol->GetOffsets());
 
-		if ((ret = CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cq))) {
-			cq.SetHitPiece(lmp); cqs->push_back(cq);
+			// skip if neither an ingress nor an egress hit
+			if (CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cq) && cq.GetHitPos() != ZeroVector) {
+				cq.SetHitPiece(const_cast<LocalModelPiece*>(lmp));
+				cqs->push_back(cq);
+			}
 		}
-
-		volMat.Translate(-lmpVol->GetOffsets());
 	}
 
+	// pre-order, so hits are collected in LocalModel::pieces order
 	for (unsigned int i = 0; i < lmp->children.size(); i++) {
-		ret |= IntersectPieceTreeHelper(lmp->children[i], mat, p0, p1, cqs);
+		IntersectPieceTreeHelper(lmp->children[i], unitMat, p0, p1, mp0, mp1, cqs);
 	}
-
-	return ret;
 }
-*/
 
 bool CCollisionHandler::IntersectPiecesHelper(
 	const CUnit* u,
@@ -254,32 +279,14 @@ bool CCollisionHandler::IntersectPiecesHelper(
 	const float3& p1,
 	std::list<CollisionQuery>* cqs
 ) {
-	CMatrix44f unitMat = u->GetTransformMatrix(true);
-	CMatrix44f volMat;
-	CollisionQuery cq;
-
-	for (unsigned int n = 0; n < u->localModel->pieces.size(); n++) {
-		const LocalModelPiece* lmp = u->localModel->GetPiece(n);
-		const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
-
-		if (!lmp->scriptSetVisible || lmpVol->IgnoreHits())
-			continue;
+	const CMatrix44f unitMat = u->GetTransformMatrix(true);
+	const CMatrix44f unitMatInv = unitMat.InvertAffine();
 
-		volMat = unitMat * lmp->GetModelSpaceMatrix();
-		volMat.Translate(lmpVol->GetOffsets());
-
-		if (!CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cq))
-			continue;
-		// skip if neither an ingress nor an egress hit
-		if (cq.GetHitPos() == ZeroVector)
-			continue;
-
-		cq.SetHitPiece(const_cast<LocalModelPiece*>(lmp));
-		cqs->push_back(cq);
-	}
+	// the piece bounds live in model-space, so bring the ray there once
+	IntersectPieceTreeHelper(u->localModel->GetRoot(), unitMat, p0, p1, unitMatInv.Mul(p0), unitMatInv.Mul(p1), cqs);
 
 	// true iff at least one piece was intersected
-	return (cq.GetHitPiece() != NULL);
+	return (!cqs->empty());
 }
 
 
@@ -288,9 +295,7 @@ bool CCollisionHandler::IntersectPieceTree(const CUnit* u, const float3& p0, con
 	std::list<CollisionQuery> cqs;
 	std::list<CollisionQuery>::const_iterator cqsIt;
 
-	// TODO:
-	//   needs an early-out test, but gets complicated because
-	//   pieces can move --> no clearly defined bounding volume
+	// the root's tree bounds double as early-out test
 	if (!IntersectPiecesHelper(u, p0, p1, &cqs))
 		return false;
 
@@ -111,7 +111,15 @@ class CCollisionHandler {
 		static bool Intersect(const CollisionVolume* v, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cq);
 		static bool IntersectPieceTree(const CUnit* u, const float3& p0, const float3& p1, CollisionQuery* cq);
 
-		static bool IntersectPieceTreeHelper(LocalModelPiece* lmp, const CMatrix44f& mat, const float3& p0, const float3& p1, std::list<CollisionQuery>* cqs);
+		static void IntersectPieceTreeHelper(
+			const LocalModelPiece* lmp,
+			const CMatrix44f& unitMat,
+			const float3& p0,
+			const float3& p1,
+			const float3& mp0,
+			const float3& mp1,
+			std::list<CollisionQuery>* cqs
+		);
 		static bool IntersectPiecesHelper(const CUnit* u, const float3& p0, const float3& p1, std::list<CollisionQuery>* cqs);
 
 	public:
@@ -122,6 +130,7 @@ class CCollisionHandler {
 	private:
 		static unsigned int numDiscTests; // number of discrete hit-tests executed
 		static unsigned int numContTests; // number of continuous hit-tests executed (inc. unsynced)
+		static unsigned int numNodeTests; // number of piece-tree bounding spheres tested
 };
 
 #endif // COLLISION_HANDLER_H
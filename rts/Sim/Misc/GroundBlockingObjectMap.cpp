@@ -16,7 +16,8 @@ CGroundBlockingObjectMap* groundBlockingObjectMap;
 
 CR_BIND(CGroundBlockingObjectMap, (1))
 CR_REG_METADATA(CGroundBlockingObjectMap, (
-	CR_MEMBER(groundBlockingMap)
+	CR_MEMBER(groundBlockingMap),
+	CR_MEMBER(occupancyMap)
 ));
 
 
@@ -30,6 +31,19 @@ inline static const int GetObjectID(CSolidObject* obj)
 }
 
 
+inline void CGroundBlockingObjectMap::UpdateCellOccupancy(int mapSquare)
+{
+	const BlockingMapCell& cell = groundBlockingMap[mapSquare];
+	unsigned char bits = 0;
+
+	for (BlockingMapCellIt it = cell.begin(); it != cell.end(); ++it) {
+		bits |= ((it->second->immobile)? OCCUPANCY_IMMOBILE: OCCUPANCY_MOBILE);
+	}
+
+	occupancyMap[mapSquare] = bits;
+}
+
+
 void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 {
 	if (object->blockMap != NULL) {
@@ -62,6 +76,7 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 		for (int xSqr = minXSqr; xSqr < maxXSqr; xSqr++) {
 			BlockingMapCell& cell = groundBlockingMap[xSqr + zSqr * gs->mapx];
 			cell[objID] = object;
+			UpdateCellOccupancy(xSqr + zSqr * gs->mapx);
 		}
 	}
 
@@ -100,6 +115,7 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object, con
 			if (object->GetGroundBlockingMaskAtPos(testPos) & mask) {
 				BlockingMapCell& cell = groundBlockingMap[x + (z) * gs->mapx];
 				cell[objID] = object;
+				UpdateCellOccupancy(x + z * gs->mapx);
 			}
 		}
 	}
@@ -130,6 +146,7 @@ void CGroundBlockingObjectMap::RemoveGroundBlockingObject(CSolidObject* object)
 
 			BlockingMapCell& cell = groundBlockingMap[idx];
 			cell.erase(objID);
+			UpdateCellOccupancy(idx);
 		}
 	}
 
@@ -148,11 +165,11 @@ void CGroundBlockingObjectMap::RemoveGroundBlockingObject(CSolidObject* object)
 CSolidObject* CGroundBlockingObjectMap::GroundBlockedUnsafe(int mapSquare) const {
 	GML_STDMUTEX_LOCK(block); // GroundBlockedUnsafe
 
-	const BlockingMapCell& cell = groundBlockingMap[mapSquare];
-
-	if (cell.empty())
+	if (occupancyMap[mapSquare] == 0)
 		return NULL;
 
+	const BlockingMapCell& cell = groundBlockingMap[mapSquare];
+
 	return ((cell.begin())->second);
 }
 
@@ -181,7 +198,7 @@ bool CGroundBlockingObjectMap::GroundBlocked(int x, int z, CSolidObject* ignoreO
 
 	GML_STDMUTEX_LOCK(block); // GroundBlockedUnsafe
 
-	if (groundBlockingMap[mapSquare].empty())
+	if (occupancyMap[mapSquare] == 0)
 		return false;
 
 	const int objID = GetObjectID(ignoreObj);
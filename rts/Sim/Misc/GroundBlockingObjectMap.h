@@ -20,8 +20,15 @@ class CGroundBlockingObjectMap
 	CR_DECLARE_STRUCT(CGroundBlockingObjectMap);
 
 public:
+	// per-square occupancy bits, kept in sync with the cell contents
+	enum {
+		OCCUPANCY_MOBILE   = 1, ///< cell contains at least one mobile object
+		OCCUPANCY_IMMOBILE = 2, ///< cell contains at least one immobile object
+	};
+
 	CGroundBlockingObjectMap(int numSquares) {
 		groundBlockingMap.resize(numSquares);
+		occupancyMap.resize(numSquares, 0);
 	}
 
 	void AddGroundBlockingObject(CSolidObject* object);
@@ -49,11 +56,22 @@ public:
 		return groundBlockingMap[mapSquare];
 	}
 
+	// packed OCCUPANCY_* bits of a cell (one byte per square); zero
+	// means GetCell(mapSquare) is empty and nothing can block there
+	unsigned char GetCellOccupancy(int mapSquare) const {
+		return occupancyMap[mapSquare];
+	}
+	const unsigned char* GetOccupancyMap() const {
+		return &occupancyMap[0];
+	}
+
 private:
 	bool CheckYard(CSolidObject* yardUnit, const YardMapStatus& mask) const;
+	void UpdateCellOccupancy(int mapSquare);
 
 private:
 	BlockingMap groundBlockingMap;
+	std::vector<unsigned char> occupancyMap;
 };
 
 extern CGroundBlockingObjectMap* groundBlockingObjectMap;
@@ -1,8 +1,5 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
-#include <limits>
-
-
 #include "InterceptHandler.h"
 
 #include "Lua/LuaRules.h"
@@ -15,119 +12,287 @@
 #include "Sim/Misc/TeamHandler.h"
 #include "System/float3.h"
 #include "System/myMath.h"
-#include "System/creg/STL_List.h"
 
+#include <algorithm>
 #include <limits>
 
 CR_BIND_DERIVED(CInterceptHandler, CObject, )
 CR_REG_METADATA(CInterceptHandler, (
 	CR_MEMBER(interceptors),
-	CR_MEMBER(repulsors)//,
+	CR_MEMBER(repulsors),
 	//CR_MEMBER(interceptables) FIXME
+	CR_IGNORED(interceptorCells),
+	CR_IGNORED(repulsorCells),
+	CR_IGNORED(candidates),
+	CR_IGNORED(repulsorCandidates),
+	CR_IGNORED(gridFrame),
+	CR_IGNORED(gridsDirty)
 ));
 
 CInterceptHandler interceptHandler;
 
 
+// side of a grid cell in elmos
+static const float GRID_CELL_SIZE = 1024.0f;
+// weapons can move (or be moved by Lua) after the grids were built in
+// the same frame, so cells are tested with some additional tolerance
+static const float GRID_CELL_SLACK = 64.0f;
+
+
+static inline float SqDistanceToRay2D(const float3& c, const float3& start, const float3& dir)
+{
+	const float dx = c.x - start.x;
+	const float dz = c.z - start.z;
+	const float sqLen = dir.x * dir.x + dir.z * dir.z;
+	const float t = (sqLen > 0.0f)? std::max(0.0f, (dx * dir.x + dz * dir.z) / sqLen): 0.0f;
+
+	return (Square(dx - dir.x * t) + Square(dz - dir.z * t));
+}
+
+static inline float SqDistanceToSegment2D(const float3& c, const float3& start, const float3& end)
+{
+	const float3 d = end - start;
+	const float dx = c.x - start.x;
+	const float dz = c.z - start.z;
+	const float sqLen = d.x * d.x + d.z * d.z;
+	const float t = (sqLen > 0.0f)? Clamp((dx * d.x + dz * d.z) / sqLen, 0.0f, 1.0f): 0.0f;
+
+	return (Square(dx - d.x * t) + Square(dz - d.z * t));
+}
+
+static bool CandidateInterceptorCmp(const std::pair<unsigned int, CWeaponProjectile*>& a, const std::pair<unsigned int, CWeaponProjectile*>& b)
+{
+	return (a.first < b.first);
+}
+
+
+
+CInterceptHandler::CInterceptHandler()
+	: gridFrame(-1)
+	, gridsDirty(true)
+{
+}
+
+
+void CInterceptHandler::AddInterceptorWeapon(CWeapon* weapon)
+{
+	interceptors.push_back(weapon);
+	gridsDirty = true;
+}
+
+void CInterceptHandler::RemoveInterceptorWeapon(CWeapon* weapon)
+{
+	interceptors.erase(std::remove(interceptors.begin(), interceptors.end(), weapon), interceptors.end());
+	gridsDirty = true;
+}
+
+void CInterceptHandler::AddPlasmaRepulser(CPlasmaRepulser* r)
+{
+	repulsors.push_back(r);
+	gridsDirty = true;
+}
+
+void CInterceptHandler::RemovePlasmaRepulser(CPlasmaRepulser* r)
+{
+	repulsors.erase(std::remove(repulsors.begin(), repulsors.end(), r), repulsors.end());
+	gridsDirty = true;
+}
+
+
+
+template<typename T>
+void CInterceptHandler::BuildGrid(std::vector<GridCell>& cells, const std::vector<T*>& weapons, bool repulsorGrid)
+{
+	std::vector< std::pair<int, unsigned int> > keys(weapons.size());
+
+	for (unsigned int i = 0; i < weapons.size(); i++) {
+		const float3& pos = weapons[i]->owner->pos;
+		const int cx = Clamp(int(pos.x / GRID_CELL_SIZE), 0, 0xFFFF);
+		const int cz = Clamp(int(pos.z / GRID_CELL_SIZE), 0, 0x7FFF);
+
+		keys[i] = std::make_pair(cz * 0x10000 + cx, i);
+	}
+
+	// groups by cell, and keeps each cell's members in list order
+	std::sort(keys.begin(), keys.end());
+	cells.clear();
+
+	for (unsigned int i = 0; i < keys.size(); i++) {
+		if (i == 0 || keys[i].first != keys[i - 1].first) {
+			cells.push_back(GridCell());
+
+			GridCell& cell = cells.back();
+			cell.center.x = ((keys[i].first & 0xFFFF) + 0.5f) * GRID_CELL_SIZE;
+			cell.center.z = ((keys[i].first >> 16) + 0.5f) * GRID_CELL_SIZE;
+			cell.reach[0] = 0.0f;
+			cell.reach[1] = 0.0f;
+		}
+
+		GridCell& cell = cells.back();
+		const CWeapon* w = weapons[keys[i].second];
+		const WeaponDef* wDef = w->weaponDef;
+
+		// these mirror the range tests in CheckInterceptor and in
+		// CPlasmaRepulser::NewProjectile and CPlasmaRepulser::NewBeam
+		if (repulsorGrid) {
+			cell.reach[0] = std::max(cell.reach[0], cell.center.distance2D(w->owner->pos) + wDef->shieldRadius * 1.5f);
+			cell.reach[1] = std::max(cell.reach[1], cell.center.distance2D(w->weaponPos) + wDef->shieldRadius);
+		} else {
+			cell.reach[0] = std::max(cell.reach[0], cell.center.distance2D(w->weaponPos) + wDef->coverageRange);
+			cell.reach[1] = cell.reach[0];
+		}
+
+		cell.members.push_back(keys[i].second);
+	}
+}
+
+void CInterceptHandler::UpdateGrids()
+{
+	if (!gridsDirty && gridFrame == gs->frameNum)
+		return;
+
+	BuildGrid(interceptorCells, interceptors, false);
+	BuildGrid(repulsorCells, repulsors, true);
+
+	gridFrame = gs->frameNum;
+	gridsDirty = false;
+}
+
+
 
 void CInterceptHandler::Update(bool forced) {
 	if (((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0) && !forced)
 		return;
 
-	std::list<CWeapon*>::iterator wit;
+	UpdateGrids();
+	candidates.clear();
+
 	std::map<int, CWeaponProjectile*>::const_iterator pit;
 
-	for (wit = interceptors.begin(); wit != interceptors.end(); ++wit) {
-		CWeapon* w = *wit;
-		const WeaponDef* wDef = w->weaponDef;
-		const CUnit* wOwner = w->owner;
-		// const float3& wOwnerPos = wOwner->pos;
-		const float3& wPos = w->weaponPos;
-
-		assert(wDef->interceptor || wDef->isShield);
-
-		for (pit = interceptables.begin(); pit != interceptables.end(); ++pit) {
-			CWeaponProjectile* p = pit->second;
-			const WeaponDef* pDef = p->GetWeaponDef();
-
-			if ((pDef->targetable & wDef->interceptor) == 0)
-				continue;
-			if (w->incomingProjectiles.find(p->id) != w->incomingProjectiles.end())
-				continue;
-
-			const CUnit* pOwner = p->owner();
-			const int pAllyTeam = (pOwner != NULL)? pOwner->allyteam: -1;
-
-			if (pAllyTeam != -1 && teamHandler->Ally(wOwner->allyteam, pAllyTeam))
-				continue;
-
-			// note: will be called every Update so long as gadget does not return true
-			if (luaRules != NULL && !luaRules->AllowWeaponInterceptTarget(wOwner, w, p))
-				continue;
-
-			// there are four cases when an interceptor <w> should fire at a projectile <p>:
-			//     1. p's target position inside w's interception circle (w's owner can move!)
-			//     2. p's current position inside w's interception circle
-			//     3. p's projected impact position inside w's interception circle
-			//     4. p's trajectory intersects w's interception circle
-			//
-			// these checks all need to be evaluated periodically, not just
-			// when a projectile is created and handed to AddInterceptTarget
-			const float interceptDist = w->weaponPos.distance(p->pos);
-			const float impactDist = ground->LineGroundCol(p->pos, p->pos + p->dir * interceptDist);
-
-			const float3& pFlightPos = p->pos;
-			const float3& pImpactPos = p->pos + p->dir * impactDist;
-			const float3& pTargetPos = p->GetTargetPos();
-
-			if ((pTargetPos - wPos).SqLength2D() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->incomingProjectiles[p->id] = p;
-				continue; // 1
-			}
-
-			if (wDef->interceptor == 1) {
-				// <w> is just a static interceptor and fires only at projectiles
-				// TARGETED within its current interception area; any projectiles
-				// CROSSING its interception area are fired at only if interceptor
-				// is >= 2
-				//// continue;
-			}
-
-			if ((pFlightPos - wPos).SqLength2D() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->incomingProjectiles[p->id] = p;
-				continue; // 2
-			}
-
-			if ((pImpactPos - wPos).SqLength2D() < Square(wDef->coverageRange)) {
-				const float3 pTargetDir = (pTargetPos - pFlightPos).SafeNormalize();
-				const float3 pImpactDir = (pImpactPos - pFlightPos).SafeNormalize();
-
-				// the projected impact position can briefly shift into the covered
-				// area during transition from vertical to horizontal flight, so we
-				// perform an extra test (NOTE: assumes non-parabolic trajectory)
-				if (pTargetDir.dot(pImpactDir) >= 0.999f) {
-					w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-					w->incomingProjectiles[p->id] = p;
-					continue; // 3
-				}
-			}
-
-			const float3 pCurSeparationVec = wPos - pFlightPos;
-			const float pMinSeparationDist = std::max(pCurSeparationVec.dot(p->dir), 0.0f);
-			const float3 pMinSeparationPos = pFlightPos + (p->dir * pMinSeparationDist);
-			const float3 pMinSeparationVec = wPos - pMinSeparationPos;
-
-			if (pMinSeparationVec.SqLength() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->incomingProjectiles[p->id] = p;
-				continue; // 4
-			}
+	for (pit = interceptables.begin(); pit != interceptables.end(); ++pit) {
+		GetInterceptorCandidates(pit->second, candidates);
+	}
+
+	// process the pairs in the same order as a plain loop over
+	// all interceptors and (nested) all interceptables would
+	std::stable_sort(candidates.begin(), candidates.end(), CandidateInterceptorCmp);
+
+	for (unsigned int i = 0; i < candidates.size(); i++) {
+		CheckInterceptor(interceptors[candidates[i].first], candidates[i].second);
+	}
+}
+
+
+
+void CInterceptHandler::GetInterceptorCandidates(CWeaponProjectile* p, std::vector< std::pair<unsigned int, CWeaponProjectile*> >& pairs) const
+{
+	// every test in CheckInterceptor measures the distance between the
+	// interceptor and either p's target position or some point on p's
+	// (extended) trajectory, which is never less than the xz-distance
+	// to the projected ray from p's position (one elmo back included)
+	const float3 rayStart = p->pos - p->dir;
+	const float3& targetPos = p->GetTargetPos();
+
+	for (unsigned int n = 0; n < interceptorCells.size(); n++) {
+		const GridCell& cell = interceptorCells[n];
+		const float sqReach = Square(cell.reach[0] + GRID_CELL_SLACK);
+
+		if (cell.center.SqDistance2D(targetPos) >= sqReach && SqDistanceToRay2D(cell.center, rayStart, p->dir) >= sqReach)
+			continue;
+
+		for (unsigned int m = 0; m < cell.members.size(); m++) {
+			pairs.push_back(std::make_pair(cell.members[m], p));
 		}
 	}
 }
 
+void CInterceptHandler::CheckInterceptor(CWeapon* w, CWeaponProjectile* p)
+{
+	const WeaponDef* wDef = w->weaponDef;
+	const CUnit* wOwner = w->owner;
+	// const float3& wOwnerPos = wOwner->pos;
+	const float3& wPos = w->weaponPos;
+
+	assert(wDef->interceptor || wDef->isShield);
+
+	const WeaponDef* pDef = p->GetWeaponDef();
+
+	if ((pDef->targetable & wDef->interceptor) == 0)
+		return;
+	if (w->incomingProjectiles.find(p->id) != w->incomingProjectiles.end())
+		return;
+
+	const CUnit* pOwner = p->owner();
+	const int pAllyTeam = (pOwner != NULL)? pOwner->allyteam: -1;
+
+	if (pAllyTeam != -1 && teamHandler->Ally(wOwner->allyteam, pAllyTeam))
+		return;
+
+	// note: will be called every Update so long as gadget does not return true
+	if (luaRules != NULL && !luaRules->AllowWeaponInterceptTarget(wOwner, w, p))
+		return;
+
+	// there are four cases when an interceptor <w> should fire at a projectile <p>:
+	//     1. p's target position inside w's interception circle (w's owner can move!)
+	//     2. p's current position inside w's interception circle
+	//     3. p's projected impact position inside w's interception circle
+	//     4. p's trajectory intersects w's interception circle
+	//
+	// these checks all need to be evaluated periodically, not just
+	// when a projectile is created and handed to AddInterceptTarget
+	const float interceptDist = w->weaponPos.distance(p->pos);
+	const float impactDist = ground->LineGroundCol(p->pos, p->pos + p->dir * interceptDist);
+
+	const float3& pFlightPos = p->pos;
+	const float3& pImpactPos = p->pos + p->dir * impactDist;
+	const float3& pTargetPos = p->GetTargetPos();
+
+	if ((pTargetPos - wPos).SqLength2D() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->incomingProjectiles[p->id] = p;
+		return; // 1
+	}
+
+	if (wDef->interceptor == 1) {
+		// <w> is just a static interceptor and fires only at projectiles
+		// TARGETED within its current interception area; any projectiles
+		// CROSSING its interception area are fired at only if interceptor
+		// is >= 2
+		//// return;
+	}
+
+	if ((pFlightPos - wPos).SqLength2D() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->incomingProjectiles[p->id] = p;
+		return; // 2
+	}
+
+	if ((pImpactPos - wPos).SqLength2D() < Square(wDef->coverageRange)) {
+		const float3 pTargetDir = (pTargetPos - pFlightPos).SafeNormalize();
+		const float3 pImpactDir = (pImpactPos - pFlightPos).SafeNormalize();
+
+		// the projected impact position can briefly shift into the covered
+		// area during transition from vertical to horizontal flight, so we
+		// perform an extra test (NOTE: assumes non-parabolic trajectory)
+		if (pTargetDir.dot(pImpactDir) >= 0.999f) {
+			w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+			w->incomingProjectiles[p->id] = p;
+			return; // 3
+		}
+	}
+
+	const float3 pCurSeparationVec = wPos - pFlightPos;
+	const float pMinSeparationDist = std::max(pCurSeparationVec.dot(p->dir), 0.0f);
+	const float3 pMinSeparationPos = pFlightPos + (p->dir * pMinSeparationDist);
+	const float3 pMinSeparationVec = wPos - pMinSeparationPos;
+
+	if (pMinSeparationVec.SqLength() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->incomingProjectiles[p->id] = p;
+		return; // 4
+	}
+}
+
 
 
 void CInterceptHandler::AddInterceptTarget(CWeaponProjectile* target, const float3& destination)
@@ -140,13 +305,48 @@ void CInterceptHandler::AddInterceptTarget(CWeaponProjectile* target, const floa
 	// die before the interceptable itself does)
 	AddDeathDependence(target, DEPENDENCE_INTERCEPTABLE);
 
-	Update(true);
+	// only the new target needs to be matched now, all
+	// older ones are re-checked by the periodic Update
+	// (not using <candidates>, this might be reached via
+	// a Lua callin from within Update)
+	std::vector< std::pair<unsigned int, CWeaponProjectile*> > targetCandidates;
+
+	UpdateGrids();
+	GetInterceptorCandidates(target, targetCandidates);
+	std::stable_sort(targetCandidates.begin(), targetCandidates.end(), CandidateInterceptorCmp);
+
+	for (unsigned int i = 0; i < targetCandidates.size(); i++) {
+		CheckInterceptor(interceptors[targetCandidates[i].first], targetCandidates[i].second);
+	}
 }
 
 void CInterceptHandler::AddShieldInterceptableProjectile(CWeaponProjectile* p)
 {
-	for (std::list<CPlasmaRepulser*>::iterator wi = repulsors.begin(); wi != repulsors.end(); ++wi) {
-		CPlasmaRepulser* shield = *wi;
+	UpdateGrids();
+	repulsorCandidates.clear();
+
+	// same direction estimate as CPlasmaRepulser::NewProjectile
+	float3 dir = p->speed;
+	if (p->GetTargetPos() != ZeroVector) {
+		dir = p->GetTargetPos() - p->pos;
+	}
+
+	dir.y = 0.0f;
+	dir.SafeNormalize();
+
+	for (unsigned int n = 0; n < repulsorCells.size(); n++) {
+		const GridCell& cell = repulsorCells[n];
+
+		if (SqDistanceToRay2D(cell.center, p->pos, dir) >= Square(cell.reach[0] + GRID_CELL_SLACK))
+			continue;
+
+		repulsorCandidates.insert(repulsorCandidates.end(), cell.members.begin(), cell.members.end());
+	}
+
+	std::sort(repulsorCandidates.begin(), repulsorCandidates.end());
+
+	for (unsigned int i = 0; i < repulsorCandidates.size(); i++) {
+		CPlasmaRepulser* shield = repulsors[repulsorCandidates[i]];
 
 		if (shield->weaponDef->shieldInterceptType & p->GetWeaponDef()->interceptedByShieldType) {
 			shield->NewProjectile(p);
@@ -161,8 +361,25 @@ float CInterceptHandler::AddShieldInterceptableBeam(CWeapon* emitter, const floa
 	float minRange = std::numeric_limits<float>::max();
 	float3 tempDir;
 
-	for (std::list<CPlasmaRepulser*>::iterator wi = repulsors.begin(); wi != repulsors.end(); ++wi) {
-		CPlasmaRepulser* shield = *wi;
+	UpdateGrids();
+	repulsorCandidates.clear();
+
+	const float3 end = start + dir * length;
+
+	for (unsigned int n = 0; n < repulsorCells.size(); n++) {
+		const GridCell& cell = repulsorCells[n];
+
+		if (SqDistanceToSegment2D(cell.center, start, end) >= Square(cell.reach[1] + GRID_CELL_SLACK))
+			continue;
+
+		repulsorCandidates.insert(repulsorCandidates.end(), cell.members.begin(), cell.members.end());
+	}
+
+	// list order decides between shields at exactly the same distance
+	std::sort(repulsorCandidates.begin(), repulsorCandidates.end());
+
+	for (unsigned int i = 0; i < repulsorCandidates.size(); i++) {
+		CPlasmaRepulser* shield = repulsors[repulsorCandidates[i]];
 
 		if ((shield->weaponDef->shieldInterceptType & emitter->weaponDef->interceptedByShieldType) == 0)
 			continue;
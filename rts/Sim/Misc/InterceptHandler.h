@@ -4,9 +4,10 @@
 #define INTERCEPT_HANDLER_H
 
 #include "System/Object.h"
+#include "System/float3.h"
 
-#include <list>
 #include <map>
+#include <vector>
 #include <boost/noncopyable.hpp>
 #include "System/Object.h"
 
@@ -14,32 +15,62 @@ class CWeapon;
 class CWeaponProjectile;
 class CPlasmaRepulser;
 class CProjectile;
-class float3;
 
 class CInterceptHandler : public CObject, boost::noncopyable
 {
 	CR_DECLARE(CInterceptHandler)
 
 public:
+	CInterceptHandler();
+
 	void Update(bool forced);
 
-	void AddInterceptorWeapon(CWeapon* weapon) { interceptors.push_back(weapon); }
-	void RemoveInterceptorWeapon(CWeapon* weapon) { interceptors.remove(weapon); }
+	void AddInterceptorWeapon(CWeapon* weapon);
+	void RemoveInterceptorWeapon(CWeapon* weapon);
 
 	void AddInterceptTarget(CWeaponProjectile* target, const float3& destination);
 	void AddShieldInterceptableProjectile(CWeaponProjectile* p);
 
 	float AddShieldInterceptableBeam(CWeapon* emitter, const float3& start, const float3& dir, float length, float3& newDir, CPlasmaRepulser*& repulsedBy);
 
-	void AddPlasmaRepulser(CPlasmaRepulser* r) { repulsors.push_back(r); }
-	void RemovePlasmaRepulser(CPlasmaRepulser* r) { repulsors.remove(r); }
+	void AddPlasmaRepulser(CPlasmaRepulser* r);
+	void RemovePlasmaRepulser(CPlasmaRepulser* r);
 
 	void DependentDied(CObject* o);
 
 private:
-	std::list<CWeapon*> interceptors;
-	std::list<CPlasmaRepulser*> repulsors;
+	/**
+	 * Coarse spatial bucket of interceptors or repulsers. Only non-empty
+	 * cells are stored; a cell is skipped entirely if the query shape is
+	 * further than reach[] away from its center, where reach[] bounds the
+	 * distance (xz) from the center at which any member can still react.
+	 */
+	struct GridCell {
+		float3 center;
+		float reach[2]; // interceptors: coverage (both); repulsers: projectiles, beams
+		std::vector<unsigned int> members; // indices into interceptors or repulsors
+	};
+
+	template<typename T>
+	static void BuildGrid(std::vector<GridCell>& cells, const std::vector<T*>& weapons, bool repulsorGrid);
+
+	void UpdateGrids();
+	void GetInterceptorCandidates(CWeaponProjectile* p, std::vector< std::pair<unsigned int, CWeaponProjectile*> >& pairs) const;
+	void CheckInterceptor(CWeapon* w, CWeaponProjectile* p);
+
+private:
+	std::vector<CWeapon*> interceptors;
+	std::vector<CPlasmaRepulser*> repulsors;
 	std::map<int, CWeaponProjectile*> interceptables;
+
+	// rebuilt at most once per frame, or after a weapon was added or removed
+	std::vector<GridCell> interceptorCells;
+	std::vector<GridCell> repulsorCells;
+	std::vector< std::pair<unsigned int, CWeaponProjectile*> > candidates;
+	std::vector<unsigned int> repulsorCandidates;
+
+	int gridFrame;
+	bool gridsDirty;
 };
 
 extern CInterceptHandler interceptHandler;
@@ -1,7 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
-#include <list>
 #include <cstdlib>
 #include <cstring>
 
@@ -12,9 +11,10 @@
 #include "Sim/Misc/TeamHandler.h"
 #include "Map/ReadMap.h"
 #include "System/Log/ILog.h"
+#include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
+#include "System/Util.h"
 #include "System/creg/STL_Deque.h"
-#include "System/creg/STL_List.h"
 
 using std::min;
 using std::max;
@@ -34,23 +34,25 @@ CR_REG_METADATA(LosInstance,(
 	CR_MEMBER(baseAirPos),
 	CR_MEMBER(hashNum),
 	CR_MEMBER(baseHeight),
-	CR_MEMBER(toBeDeleted)
+	CR_MEMBER(toBeDeleted),
+	CR_IGNORED(losPending)
 ));
 
 void CLosHandler::PostLoad()
 {
-	for (int a = 0; a < LOSHANDLER_MAGIC_PRIME; ++a) {
-		for (std::list<LosInstance*>::iterator li = instanceHash[a].begin(); li != instanceHash[a].end(); ++li) {
-			if ((*li)->refCount) {
-				LosAdd(*li);
-			}
+	for (unsigned int n = 0; n < instanceTable.size(); ++n) {
+		if (instanceTable[n] != NULL && instanceTable[n]->refCount) {
+			LosAdd(instanceTable[n]);
 		}
 	}
 }
 
 CR_REG_METADATA(CLosHandler,(
-	CR_MEMBER(instanceHash),
+	CR_MEMBER(instanceTable),
+	CR_MEMBER(numInstances),
 	CR_MEMBER(toBeDeleted),
+	CR_MEMBER(toBeDeletedHead),
+	CR_MEMBER(toBeDeletedSize),
 	CR_MEMBER(delayQue),
 	CR_RESERVED(8),
 	CR_POSTLOAD(PostLoad)
@@ -84,25 +86,43 @@ CLosHandler::CLosHandler() :
 	losSizeX(std::max(1, gs->mapx >> losMipLevel)),
 	losSizeY(std::max(1, gs->mapy >> losMipLevel)),
 	requireSonarUnderWater(modInfo.requireSonarUnderWater),
-	losAlgo(int2(losSizeX, losSizeY), -1e6f, 15, readMap->GetMIPHeightMapSynced(losMipLevel))
+	losAlgo(int2(losSizeX, losSizeY), -1e6f, 15, readMap->GetMIPHeightMapSynced(losMipLevel)),
+	instanceTable(MIN_INSTANCE_TABLE_SIZE, NULL),
+	numInstances(0),
+	toBeDeleted(MAX_RECYCLED_INSTANCES + 1, NULL),
+	toBeDeletedHead(0),
+	toBeDeletedSize(0)
 {
 	for (int a = 0; a < teamHandler->ActiveAllyTeams(); ++a) {
 		losMaps[a].SetSize(losSizeX, losSizeY, true);
 		airLosMaps[a].SetSize(airSizeX, airSizeY, false);
 	}
+
+	// the maps are empty here and re-filled by PostLoad when loading,
+	// so the masks never need to be rebuilt
+	if (teamHandler->ActiveAllyTeams() <= CLosMap::MAX_MASK_ALLYTEAMS) {
+		losAllyMask.resize(losSizeX * losSizeY, 0);
+		airLosAllyMask.resize(airSizeX * airSizeY, 0);
+
+		for (int a = 0; a < teamHandler->ActiveAllyTeams(); ++a) {
+			losMaps[a].SetAllyMask(&losAllyMask, a);
+			airLosMaps[a].SetAllyMask(&airLosAllyMask, a);
+		}
+	}
 }
 
 
 CLosHandler::~CLosHandler()
 {
-	for (int a = 0; a < LOSHANDLER_MAGIC_PRIME; ++a) {
-		for (std::list<LosInstance*>::iterator li = instanceHash[a].begin(); li != instanceHash[a].end(); ++li) {
-			LosInstance* i = *li;
-			i->_DestructInstance(i);
-			mempool.Free(i, sizeof(LosInstance));
-		}
-	}
+	for (unsigned int n = 0; n < instanceTable.size(); ++n) {
+		LosInstance* i = instanceTable[n];
+
+		if (i == NULL)
+			continue;
 
+		i->_DestructInstance(i);
+		mempool.Free(i, sizeof(LosInstance));
+	}
 }
 
 
@@ -144,27 +164,28 @@ void CLosHandler::MoveUnit(CUnit* unit, bool redoCurrent)
 		instance->baseSquare = baseSquare; //this could be a problem if several units are sharing the same instance
 		instance->baseAirPos.x = baseAirX;
 		instance->baseAirPos.y = baseAirY;
+
+		// key changed, rehash
+		EraseInstance(instance);
+		instance->hashNum = GetHashNum(baseSquare, instance->losSize, instance->airLosSize, instance->baseHeight, instance->allyteam);
+		InsertInstance(instance);
 	} else {
 		if (unit->los && (unit->los->baseSquare == baseSquare)) {
 			return;
 		}
 
 		FreeInstance(unit->los);
-		const int hash = GetHashNum(unit);
-
-		std::list<LosInstance*>::iterator lii;
-		for (lii = instanceHash[hash].begin(); lii != instanceHash[hash].end(); ++lii) {
-			if ((*lii)->baseSquare == baseSquare         &&
-			    (*lii)->losSize    == unit->losRadius    &&
-			    (*lii)->airLosSize == unit->airLosRadius &&
-			    (*lii)->baseHeight == unit->losHeight    &&
-			    (*lii)->allyteam   == allyteam) {
-				AllocInstance(*lii);
-				unit->los = *lii;
-				return;
-			}
+
+		LosInstance* sharedInstance = FindInstance(baseSquare, unit->losRadius, unit->airLosRadius, unit->losHeight, allyteam);
+
+		if (sharedInstance != NULL) {
+			AllocInstance(sharedInstance);
+			unit->los = sharedInstance;
+			return;
 		}
 
+		const int hash = GetHashNum(baseSquare, unit->losRadius, unit->airLosRadius, unit->losHeight, allyteam);
+
 		instance = new(mempool.Alloc(sizeof(LosInstance))) LosInstance(
 			unit->losRadius,
 			unit->airLosRadius,
@@ -175,11 +196,11 @@ void CLosHandler::MoveUnit(CUnit* unit, bool redoCurrent)
 			hash, unit->losHeight
 		);
 
-		instanceHash[hash].push_back(instance);
+		InsertInstance(instance);
 		unit->los = instance;
 	}
 
-	LosAdd(instance);
+	QueueLosAdd(instance);
 }
 
 
@@ -189,12 +210,56 @@ void CLosHandler::LosAdd(LosInstance* instance)
 	assert(teamHandler->IsValidAllyTeam(instance->allyteam));
 
 	losAlgo.LosAdd(instance->basePos, instance->losSize, instance->baseHeight, instance->losSquares);
+	AddInstanceToMaps(instance);
+}
+
+
+void CLosHandler::QueueLosAdd(LosInstance* instance)
+{
+	assert(instance);
+	assert(teamHandler->IsValidAllyTeam(instance->allyteam));
+
+	if (instance->losPending)
+		return;
+
+	instance->losPending = true;
+	pendingInstances.push_back(instance);
+}
+
 
+void CLosHandler::AddInstanceToMaps(LosInstance* instance)
+{
 	if (instance->losSize > 0) { losMaps[instance->allyteam].AddMapSquares(instance->losSquares, instance->allyteam, 1); }
 	if (instance->airLosSize > 0) { airLosMaps[instance->allyteam].AddMapArea(instance->baseAirPos, instance->allyteam, instance->airLosSize, 1); }
 }
 
 
+void CLosHandler::UpdatePendingInstances()
+{
+	SCOPED_TIMER("LOSHandler::UpdatePendingInstances");
+
+	// raycasting only reads the heightmap and writes into the
+	// instance's own squares, so all of them can run in parallel
+	for_mt(0, pendingInstances.size(), [&](const int i) {
+		LosInstance* instance = pendingInstances[i];
+
+		// none of these squares are currently added to the maps
+		instance->losSquares.clear();
+		losAlgo.LosAdd(instance->basePos, instance->losSize, instance->baseHeight, instance->losSquares);
+	});
+
+	// the maps only count references, so the order of additions is irrelevant
+	for (unsigned int i = 0; i < pendingInstances.size(); i++) {
+		LosInstance* instance = pendingInstances[i];
+
+		AddInstanceToMaps(instance);
+		instance->losPending = false;
+	}
+
+	pendingInstances.clear();
+}
+
+
 void CLosHandler::FreeInstance(LosInstance* instance)
 {
 	if (instance == 0)
@@ -202,64 +267,148 @@ void CLosHandler::FreeInstance(LosInstance* instance)
 
 	instance->refCount--;
 
-	if (instance->refCount == 0) {
-		CleanupInstance(instance);
+	if (instance->refCount > 0)
+		return;
+
+	CleanupInstance(instance);
+
+	if (!instance->toBeDeleted) {
+		instance->toBeDeleted = true;
+		toBeDeleted[(toBeDeletedHead + toBeDeletedSize) % toBeDeleted.size()] = instance;
+		toBeDeletedSize++;
+	}
+
+	if (toBeDeletedSize > MAX_RECYCLED_INSTANCES) {
+		LosInstance* i = toBeDeleted[toBeDeletedHead];
+
+		toBeDeleted[toBeDeletedHead] = NULL;
+		toBeDeletedHead = (toBeDeletedHead + 1) % toBeDeleted.size();
+		toBeDeletedSize--;
+
+		i->toBeDeleted = false;
 
-		if (!instance->toBeDeleted) {
-			instance->toBeDeleted = true;
-			toBeDeleted.push_back(instance);
+		if (i->refCount == 0) {
+			DeleteInstance(i);
 		}
+	}
+}
+
+
+void CLosHandler::DeleteInstance(LosInstance* instance)
+{
+	EraseInstance(instance);
+
+	instance->_DestructInstance(instance);
+	mempool.Free(instance, sizeof(LosInstance));
+}
+
+
+int CLosHandler::GetHashNum(int baseSquare, int losSize, int airLosSize, float baseHeight, int allyteam)
+{
+	// hash all fields that must match for instances to be shared
+	unsigned int heightBits = 0;
+	memcpy(&heightBits, &baseHeight, sizeof(heightBits));
+
+	unsigned int t = baseSquare;
+	t = (t * 0x9E3779B1u) ^ losSize;
+	t = (t * 0x9E3779B1u) ^ airLosSize;
+	t = (t * 0x9E3779B1u) ^ allyteam;
+	t = (t * 0x9E3779B1u) ^ heightBits;
+	t ^= (t >> 16);
+
+	// stays non-negative, hashNum is an int
+	return (t & 0x7FFFFFFF);
+}
+
+
+LosInstance* CLosHandler::FindInstance(int baseSquare, int losSize, int airLosSize, float baseHeight, int allyteam) const
+{
+	const unsigned int mask = instanceTable.size() - 1;
+
+	for (unsigned int n = GetHashNum(baseSquare, losSize, airLosSize, baseHeight, allyteam) & mask; instanceTable[n] != NULL; n = (n + 1) & mask) {
+		const LosInstance* i = instanceTable[n];
+
+		if (i->baseSquare != baseSquare) continue;
+		if (i->losSize    != losSize   ) continue;
+		if (i->airLosSize != airLosSize) continue;
+		if (i->baseHeight != baseHeight) continue;
+		if (i->allyteam   != allyteam  ) continue;
+
+		return instanceTable[n];
+	}
+
+	return NULL;
+}
+
+
+void CLosHandler::InsertInstance(LosInstance* instance)
+{
+	if ((numInstances + 1) * 2 > instanceTable.size())
+		ResizeInstanceTable(instanceTable.size() * 2);
 
-		if (instance->hashNum >= LOSHANDLER_MAGIC_PRIME || instance->hashNum < 0) {
-			LOG_L(L_WARNING,
-					"[LosHandler::FreeInstance][1] bad LOS-instance hash (%d)",
-					instance->hashNum);
+	const unsigned int mask = instanceTable.size() - 1;
+
+	unsigned int n = instance->hashNum & mask;
+
+	while (instanceTable[n] != NULL)
+		n = (n + 1) & mask;
+
+	instanceTable[n] = instance;
+	numInstances++;
+}
+
+
+void CLosHandler::EraseInstance(LosInstance* instance)
+{
+	const unsigned int mask = instanceTable.size() - 1;
+
+	unsigned int i = instance->hashNum & mask;
+
+	while (instanceTable[i] != instance) {
+		if (instanceTable[i] == NULL) {
+			LOG_L(L_WARNING, "[LosHandler::%s] LOS-instance not found (hash %d)", __FUNCTION__, instance->hashNum);
+			return;
 		}
 
-		if (toBeDeleted.size() > 500) {
-			LosInstance* i = toBeDeleted.front();
-			toBeDeleted.pop_front();
-
-			if (i->hashNum >= LOSHANDLER_MAGIC_PRIME || i->hashNum < 0) {
-				LOG_L(L_WARNING,
-						"[LosHandler::FreeInstance][2] bad LOS-instance hash (%d)",
-						i->hashNum);
-				return;
-			}
-
-			i->toBeDeleted = false;
-
-			if (i->refCount == 0) {
-				std::list<LosInstance*>::iterator lii;
-
-				for (lii = instanceHash[i->hashNum].begin(); lii != instanceHash[i->hashNum].end(); ++lii) {
-					if ((*lii) == i) {
-						instanceHash[i->hashNum].erase(lii);
-						i->_DestructInstance(i);
-						mempool.Free(i, sizeof(LosInstance));
-						break;
-					}
-				}
-			}
+		i = (i + 1) & mask;
+	}
+
+	instanceTable[i] = NULL;
+	numInstances--;
+
+	// backward-shift deletion: move up every following entry of the
+	// probe-sequence whose home slot is not within (i, j], no tombstones
+	for (unsigned int j = (i + 1) & mask; instanceTable[j] != NULL; j = (j + 1) & mask) {
+		const unsigned int k = instanceTable[j]->hashNum & mask;
+
+		if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+			instanceTable[i] = instanceTable[j];
+			instanceTable[j] = NULL;
+			i = j;
 		}
 	}
 }
 
 
-int CLosHandler::GetHashNum(CUnit* unit)
+void CLosHandler::ResizeInstanceTable(unsigned int newSize)
 {
-	const unsigned int t =
-		(unit->mapSquare * unit->losRadius + unit->allyteam) ^
-		(*(unsigned int*) &unit->losHeight);
-	//! hash-value range is [0, LOSHANDLER_MAGIC_PRIME - 1]
-	return (t % LOSHANDLER_MAGIC_PRIME);
+	std::vector<LosInstance*> oldTable(newSize, NULL);
+	oldTable.swap(instanceTable);
+
+	numInstances = 0;
+
+	for (unsigned int n = 0; n < oldTable.size(); ++n) {
+		if (oldTable[n] != NULL) {
+			InsertInstance(oldTable[n]);
+		}
+	}
 }
 
 
 void CLosHandler::AllocInstance(LosInstance* instance)
 {
 	if (instance->refCount == 0) {
-		LosAdd(instance);
+		QueueLosAdd(instance);
 	}
 	instance->refCount++;
 }
@@ -267,6 +416,13 @@ void CLosHandler::AllocInstance(LosInstance* instance)
 
 void CLosHandler::CleanupInstance(LosInstance* instance)
 {
+	if (instance->losPending) {
+		// never made it into the maps, nothing to remove
+		instance->losPending = false;
+		VectorErase(pendingInstances, instance);
+		return;
+	}
+
 	if (instance->losSize > 0) { losMaps[instance->allyteam].AddMapSquares(instance->losSquares, instance->allyteam, -1); }
 	if (instance->airLosSize > 0) { airLosMaps[instance->allyteam].AddMapArea(instance->baseAirPos, instance->allyteam, instance->airLosSize, -1); }
 }
@@ -278,6 +434,8 @@ void CLosHandler::Update()
 		FreeInstance(delayQue.front().instance);
 		delayQue.pop_front();
 	}
+
+	UpdatePendingInstances();
 }
 
 
@@ -48,6 +48,7 @@ private:
 		, hashNum(-1)
 		, baseHeight(0.0f)
 		, toBeDeleted(false)
+		, losPending(false)
 	{}
 
 public:
@@ -63,6 +64,7 @@ public:
 		, hashNum(hashNum)
 		, baseHeight(baseHeight)
 		, toBeDeleted(false)
+		, losPending(false)
 	{}
 
  	std::vector<int> losSquares;
@@ -76,6 +78,8 @@ public:
 	int hashNum;
 	float baseHeight;
 	bool toBeDeleted;
+	/// losSquares are yet to be (re)calculated and added to the maps (see CLosHandler::Update)
+	bool losPending;
 };
 
 /**
@@ -90,14 +94,19 @@ public:
  * LosInstances "can see" that square. Units may share their "presence" on
  * the LOS map through sharing a single LosInstance.
  *
- * To quickly find LosInstances that can be shared CLosHandler implements a
- * hash table (instanceHash). Additionally, LosInstances that reach a refCount
- * of 0 are not immediately deleted, but up to 500 of those are stored, in case
- * they can be reused for a future unit.
+ * To quickly find LosInstances that can be shared CLosHandler implements an
+ * open-addressed hash table (instanceTable, linear probing). Additionally,
+ * LosInstances that reach a refCount of 0 are not immediately deleted, but up
+ * to 500 of those are stored (in a ring-buffer), in case they can be reused
+ * for a future unit.
  *
  * LOS is not removed immediately when a unit gets killed. Instead,
  * DelayedFreeInstance is called. This keeps the LosInstance (including the
  * actual sight) alive until 1.5 game seconds after the unit got killed.
+ *
+ * LOS is not added immediately either when a unit moves: the instances are
+ * queued and their raycasts are done in parallel once per frame in Update,
+ * after which the resulting squares are added to the maps serially.
  */
 class CLosHandler : public boost::noncopyable
 {
@@ -176,12 +185,43 @@ public:
 		return (airLosMaps[allyTeam].At(gx, gz) != 0);
 	}
 
+	/**
+	 * Allyteams whose LOS (or air-LOS if obj->useAirLos) covers obj->pos or
+	 * obj->pos + obj->speed, one bit per allyteam; a superset of the ones
+	 * for which InLos(obj, allyTeam) holds, except that alwaysVisible and
+	 * globalLOS are not taken into account. Only valid if HasAllyMasks().
+	 */
+	inline CLosMap::AllyMask GetAllyMask(const CWorldObject* obj) const {
+		if (obj->useAirLos)
+			return (GetAirLosAllyMask(obj->pos) | GetAirLosAllyMask(obj->pos + obj->speed));
+
+		return (GetLosAllyMask(obj->pos) | GetLosAllyMask(obj->pos + obj->speed));
+	}
+
+	inline CLosMap::AllyMask GetLosAllyMask(const float3& pos) const {
+		const int gx = Clamp(int(pos.x * invLosDiv), 0, losSizeX - 1);
+		const int gz = Clamp(int(pos.z * invLosDiv), 0, losSizeY - 1);
+		return losAllyMask[gz * losSizeX + gx];
+	}
+	inline CLosMap::AllyMask GetAirLosAllyMask(const float3& pos) const {
+		const int gx = Clamp(int(pos.x * invAirDiv), 0, airSizeX - 1);
+		const int gz = Clamp(int(pos.z * invAirDiv), 0, airSizeY - 1);
+		return airLosAllyMask[gz * airSizeX + gx];
+	}
+
+	/// false if there are more allyteams than bits in CLosMap::AllyMask
+	bool HasAllyMasks() const { return (!losAllyMask.empty()); }
+
 	CLosHandler();
 	~CLosHandler();
 
 	std::vector<CLosMap> losMaps;
 	std::vector<CLosMap> airLosMaps;
 
+	/// per-square bits of the allyteams with a non-zero count in losMaps / airLosMaps
+	std::vector<CLosMap::AllyMask> losAllyMask;
+	std::vector<CLosMap::AllyMask> airLosAllyMask;
+
 	const int losMipLevel;
 	const int airMipLevel;
 	const int losDiv;
@@ -196,19 +236,38 @@ public:
 	const bool requireSonarUnderWater;
 
 private:
-	static const unsigned int LOSHANDLER_MAGIC_PRIME = 2309;
+	static const unsigned int MIN_INSTANCE_TABLE_SIZE = 4096;
+	static const unsigned int MAX_RECYCLED_INSTANCES = 500;
 
 	void PostLoad();
 	void LosAdd(LosInstance* instance);
-	int GetHashNum(CUnit* unit);
+	void QueueLosAdd(LosInstance* instance);
+	void AddInstanceToMaps(LosInstance* instance);
+	void UpdatePendingInstances();
 	void AllocInstance(LosInstance* instance);
 	void CleanupInstance(LosInstance* instance);
+	void DeleteInstance(LosInstance* instance);
+
+	static int GetHashNum(int baseSquare, int losSize, int airLosSize, float baseHeight, int allyteam);
+
+	LosInstance* FindInstance(int baseSquare, int losSize, int airLosSize, float baseHeight, int allyteam) const;
+	void InsertInstance(LosInstance* instance);
+	void EraseInstance(LosInstance* instance);
+	void ResizeInstanceTable(unsigned int newSize);
 
 	CLosAlgorithm losAlgo;
 
-	std::list<LosInstance*> instanceHash[LOSHANDLER_MAGIC_PRIME];
+	/// size is a power of two, kept at most half full; NULL marks an empty slot
+	std::vector<LosInstance*> instanceTable;
+	unsigned int numInstances;
+
+	/// ring-buffer of unreferenced instances kept around for reuse
+	std::vector<LosInstance*> toBeDeleted;
+	unsigned int toBeDeletedHead;
+	unsigned int toBeDeletedSize;
 
-	std::deque<LosInstance*> toBeDeleted;
+	/// instances moved this frame, not serialized (always empty between frames)
+	std::vector<LosInstance*> pendingInstances;
 
 	struct DelayedInstance {
 		CR_DECLARE_STRUCT(DelayedInstance);
@@ -12,6 +12,7 @@
 #endif
 
 #include <algorithm>
+#include <cassert>
 #include <cstring>
 
 
@@ -20,7 +21,9 @@ CR_BIND(CLosMap, );
 CR_REG_METADATA(CLosMap, (
 	CR_MEMBER(size),
 	CR_MEMBER(map),
-	CR_MEMBER(sendReadmapEvents)
+	CR_MEMBER(sendReadmapEvents),
+	CR_IGNORED(allyMask),
+	CR_IGNORED(allyBit)
 ));
 
 
@@ -36,18 +39,47 @@ CR_REG_METADATA(CLosAlgorithm, (
 
 
 
+std::vector<unsigned short> CLosMap::zeroMap(1, 0);
+
+
+
 void CLosMap::SetSize(int2 newSize, bool newSendReadmapEvents)
 {
 	size = newSize;
 	sendReadmapEvents = newSendReadmapEvents;
-	map.clear();
-	map.resize(size.x * size.y, 0);
+
+	// allocated on first use, see Allocate
+	std::vector<unsigned short>().swap(map);
+
+	if (zeroMap.size() < size_t(size.x * size.y)) {
+		zeroMap.resize(size.x * size.y, 0);
+	}
+}
+
+void CLosMap::SetAllyMask(std::vector<AllyMask>* mask, int allyteam)
+{
+	allyMask = mask;
+	allyBit = 0;
+
+	if (allyMask == NULL)
+		return;
+
+	assert(allyteam >= 0 && allyteam < MAX_MASK_ALLYTEAMS);
+	assert(allyMask->size() == size_t(size.x * size.y));
+
+	allyBit = (AllyMask(1) << allyteam);
+
+	for (size_t n = 0; n < map.size(); ++n) {
+		(*allyMask)[n] |= (allyBit * (map[n] != 0));
+	}
 }
 
 
 
 void CLosMap::AddMapArea(int2 pos, int allyteam, int radius, int amount)
 {
+	Allocate();
+
 	#ifdef USE_UNSYNCED_HEIGHTMAP
 	static const int LOS2HEIGHT_X = gs->mapx / size.x;
 	static const int LOS2HEIGHT_Z = gs->mapy / size.y;
@@ -74,7 +106,7 @@ void CLosMap::AddMapArea(int2 pos, int allyteam, int radius, int amount)
 				continue;
 			}
 
-			map[losMapSquareIdx] += amount;
+			AddMapSquare(losMapSquareIdx, amount);
 
 			#ifdef USE_UNSYNCED_HEIGHTMAP
 			// update unsynced heightmap for all squares that
@@ -102,8 +134,70 @@ void CLosMap::AddMapArea(int2 pos, int allyteam, int radius, int amount)
 	}
 }
 
+bool CLosMap::GetCircleSpan(int2 pos, int radius, int z, int& x1, int& x2) const
+{
+	const int rrx = (radius * radius) - Square(pos.y - z);
+
+	if (rrx < 0)
+		return false;
+
+	// largest dx with dx*dx <= rrx, i.e. the same squares AddMapArea covers
+	int dx = int(math::sqrt(float(rrx)));
+
+	while (Square(dx + 1) <= rrx) { ++dx; }
+	while (Square(dx    ) >  rrx) { --dx; }
+
+	x1 = std::max(         0, pos.x - dx);
+	x2 = std::min(size.x - 1, pos.x + dx);
+
+	return (x1 <= x2);
+}
+
+void CLosMap::MoveMapArea(int2 oldPos, int2 newPos, int allyteam, int radius, int amount)
+{
+	Allocate();
+
+	if (sendReadmapEvents) {
+		// the per-square LOS-entry bookkeeping lives in AddMapArea
+		AddMapArea(oldPos, allyteam, radius, -amount);
+		AddMapArea(newPos, allyteam, radius,  amount);
+		return;
+	}
+
+	const int sy = std::max(         0, std::min(oldPos.y, newPos.y) - radius);
+	const int ey = std::min(size.y - 1, std::max(oldPos.y, newPos.y) + radius);
+
+	for (int lmz = sy; lmz <= ey; ++lmz) {
+		int ox1, ox2;
+		int nx1, nx2;
+
+		const bool inOld = GetCircleSpan(oldPos, radius, lmz, ox1, ox2);
+		const bool inNew = GetCircleSpan(newPos, radius, lmz, nx1, nx2);
+
+		if (!inOld && !inNew)
+			continue;
+
+		if (!inOld) {
+			AddMapSpan(lmz, nx1, nx2, amount);
+			continue;
+		}
+		if (!inNew) {
+			AddMapSpan(lmz, ox1, ox2, -amount);
+			continue;
+		}
+
+		// the parts of each span that stick out on either side of the other
+		AddMapSpan(lmz, ox1, std::min(ox2, nx1 - 1), -amount);
+		AddMapSpan(lmz, std::max(ox1, nx2 + 1), ox2, -amount);
+		AddMapSpan(lmz, nx1, std::min(nx2, ox1 - 1),  amount);
+		AddMapSpan(lmz, std::max(nx1, ox2 + 1), nx2,  amount);
+	}
+}
+
 void CLosMap::AddMapSquares(const std::vector<int>& squares, int allyteam, int amount)
 {
+	Allocate();
+
 	#ifdef USE_UNSYNCED_HEIGHTMAP
 	static const int LOS2HEIGHT_X = gs->mapx / size.x;
 	static const int LOS2HEIGHT_Z = gs->mapy / size.y;
@@ -119,7 +213,7 @@ void CLosMap::AddMapSquares(const std::vector<int>& squares, int allyteam, int a
 		const bool squareEnteredLOS = (map[losMapSquareIdx] == 0 && amount > 0);
 		#endif
 
-		map[losMapSquareIdx] += amount;
+		AddMapSquare(losMapSquareIdx, amount);
 
 		#ifdef USE_UNSYNCED_HEIGHTMAP
 		if (!updateUnsyncedHeightMap) { continue; }
@@ -6,40 +6,121 @@
 #define LOS_MAP_H
 
 #include <vector>
+#include <boost/cstdint.hpp>
 #include "System/type2.h"
 
-/// map containing counts of how many units have Line Of Sight (LOS) to each square
+/**
+ * map containing counts of how many units have Line Of Sight (LOS) to each square
+ *
+ * The counts are only allocated when the first unit adds itself, so the
+ * sonar, seismic and jammer maps of allyteams that never build any such
+ * unit (and most maps of the Gaia allyteam) cost no memory; until then
+ * every square reads as zero.
+ */
 class CLosMap
 {
 	CR_DECLARE_STRUCT(CLosMap);
 
 public:
-	CLosMap() : size(0, 0), sendReadmapEvents(false) {}
+	/// one bit per allyteam, see SetAllyMask
+	typedef boost::uint64_t AllyMask;
+
+	static const int MAX_MASK_ALLYTEAMS = 64;
+
+	CLosMap() : size(0, 0), sendReadmapEvents(false), allyMask(NULL), allyBit(0) {}
 
 	void SetSize(int2 size, bool sendReadmapEvents);
 	void SetSize(int w, int h, bool sendReadmapEvents) { SetSize(int2(w, h), sendReadmapEvents); }
 
+	/**
+	 * Makes this map keep bit <allyteam> of the (same-sized) mask set
+	 * exactly for the squares with a non-zero count, so the maps of all
+	 * allyteams share one mask that answers "who covers this square" with
+	 * a single load. The bits of the current counts are OR-ed in, so the
+	 * owner should zero the mask first. Pass NULL to stop updating it.
+	 */
+	void SetAllyMask(std::vector<AllyMask>* mask, int allyteam);
+
 	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
 	void AddMapArea(int2 pos, int allyteam, int radius, int amount);
 
+	/**
+	 * same as AddMapArea(oldPos, -amount) followed by AddMapArea(newPos, amount),
+	 * but only touches the squares covered by exactly one of the two circles
+	 */
+	void MoveMapArea(int2 oldPos, int2 newPos, int allyteam, int radius, int amount);
+
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void AddMapSquares(const std::vector<int>& squares, int allyteam, int amount);
 
-	int operator[] (int square) const { return map[square]; }
+	int operator[] (int square) const { return (map.empty()? 0: map[square]); }
 
 	int At(int x, int y) const {
+		if (map.empty())
+			return 0;
+
 		x = std::max(0, std::min(size.x - 1, x));
 		y = std::max(0, std::min(size.y - 1, y));
 		return map[y * size.x + x];
 	}
 
-	// FIXME temp fix for CBaseGroundDrawer and AI interface, which need raw data
-	unsigned short& front() { return map.front(); }
+	bool IsAllocated() const { return !map.empty(); }
+
+	/// raw counts for readers (CBaseGroundDrawer), all zero while unallocated
+	const unsigned short* GetData() const { return (map.empty()? &zeroMap[0]: &map[0]); }
+
+	// FIXME temp fix for the AI interface, which needs raw data it may keep;
+	// allocates the counts so the pointer stays valid (sim-thread only)
+	unsigned short& front() { Allocate(); return map.front(); }
+
+protected:
+	void Allocate() {
+		if (map.empty()) {
+			map.resize(size.x * size.y, 0);
+		}
+	}
+
+	/// clipped x-extent of the circle in row z, returns false if the row is not covered
+	bool GetCircleSpan(int2 pos, int radius, int z, int& x1, int& x2) const;
+
+	void AddMapSpan(int z, int x1, int x2, int amount) {
+		unsigned short* row = &map[z * size.x];
+
+		if (allyMask == NULL) {
+			for (int x = x1; x <= x2; ++x) {
+				row[x] += amount;
+			}
+		} else {
+			AllyMask* maskRow = &(*allyMask)[z * size.x];
+
+			for (int x = x1; x <= x2; ++x) {
+				const bool wasCovered = (row[x] != 0);
+				row[x] += amount;
+				maskRow[x] ^= (allyBit * (wasCovered != (row[x] != 0)));
+			}
+		}
+	}
+
+	void AddMapSquare(int square, int amount) {
+		const bool wasCovered = (map[square] != 0);
+		map[square] += amount;
+
+		if (allyMask != NULL && wasCovered != (map[square] != 0)) {
+			(*allyMask)[square] ^= allyBit;
+		}
+	}
 
 protected:
 	int2 size;
 	std::vector<unsigned short> map;
 	bool sendReadmapEvents;
+
+	/// not owned, shared with the maps of the other allyteams
+	std::vector<AllyMask>* allyMask;
+	AllyMask allyBit;
+
+	/// returned by GetData() for unallocated maps, as large as the largest map
+	static std::vector<unsigned short> zeroMap;
 };
 
 
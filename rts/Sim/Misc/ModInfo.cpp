@@ -59,6 +59,8 @@ void CModInfo::Init(const char* modArchive)
 		bool disableGML = (numThreads == 1);
 
 		pathFinderSystem = system.GetInt("pathFinderSystem", PFS_TYPE_DEFAULT) % PFS_NUM_TYPES;
+		pathCacheMemoryBudget = std::max(0, system.GetInt("pathCacheMemoryBudget", 1024));
+		batchExplosionDamage = system.GetBool("batchExplosionDamage", false);
 		luaThreadingModel = system.GetInt("luaThreadingModel", MT_LUA_SINGLE_BATCH);
 
 		//FIXME: remove unsave modes
@@ -101,6 +103,7 @@ void CModInfo::Init(const char* modArchive)
 		allowGroundUnitGravity = movementTbl.GetBool("allowGroundUnitGravity", true);
 		allowHoverUnitStrafing = movementTbl.GetBool("allowHoverUnitStrafing", (pathFinderSystem == PFS_TYPE_QTPFS));
 		useClassicGroundMoveType = movementTbl.GetBool("useClassicGroundMoveType", false);
+		useParallelMoveTypeUpdates = movementTbl.GetBool("useParallelMoveTypeUpdates", false);
 	}
 
 	{
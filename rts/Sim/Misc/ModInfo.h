@@ -19,6 +19,7 @@ public:
 		, allowGroundUnitGravity(true)
 		, allowHoverUnitStrafing(true)
 		, useClassicGroundMoveType(false)
+		, useParallelMoveTypeUpdates(false)
 		, constructionDecay(true)
 		, constructionDecayTime(1000)
 		, constructionDecaySpeed(1.0f)
@@ -50,6 +51,8 @@ public:
 		, featureVisibility(FEATURELOS_NONE)
 		, luaThreadingModel(2)
 		, pathFinderSystem(PFS_TYPE_DEFAULT)
+		, pathCacheMemoryBudget(1024)
+		, batchExplosionDamage(false)
 	{}
 
 
@@ -91,6 +94,7 @@ public:
 	bool allowGroundUnitGravity;     // determines if (ground-)units experience gravity during regular movement
 	bool allowHoverUnitStrafing;     // determines if (hover-)units carry their momentum sideways when turning
 	bool useClassicGroundMoveType;   // determines if (ground-)units use the CClassicGroundMoveType path-follower
+	bool useParallelMoveTypeUpdates; // determines if (ground-)units gather their obstacles concurrently from start-of-frame positions
 
 	// Build behaviour
 	/// Should constructions without builders decay?
@@ -178,6 +182,12 @@ public:
 
 	// which pathfinder system (DEFAULT/legacy or QTPFS) the mod will use
 	int pathFinderSystem;
+	// how much memory (in KB) each path-cache of the DEFAULT pathfinder may use
+	// (part of modrules because the synced caches influence simulation results)
+	int pathCacheMemoryBudget;
+	// if true, area-damage of explosions caused by projectile collisions is
+	// applied in one batch after all collisions of the frame were resolved
+	bool batchExplosionDamage;
 };
 
 extern CModInfo modInfo;
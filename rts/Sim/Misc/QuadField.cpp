@@ -12,6 +12,7 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "System/creg/STL_List.h"
+#include "System/Util.h"
 
 #define CELL_IDX_X(wpx) Clamp(int((wpx) / quadSizeX), 0, numQuadsX - 1)
 #define CELL_IDX_Z(wpz) Clamp(int((wpz) / quadSizeZ), 0, numQuadsZ - 1)
@@ -56,16 +57,16 @@ void CQuadField::Resize(unsigned int nqx, unsigned int nqz)
 			//   if a unit exists in multiple quads in the old field, it will
 			//   be removed from all of them and there is no danger of double
 			//   re-insertion (important if new grid has higher resolution)
-			const std::list<CUnit*      > units       = quad.units;
-			const std::list<CFeature*   > features    = quad.features;
+			const std::vector<CUnit*    > units       = quad.units;
+			const std::vector<CFeature* > features    = quad.features;
 			const std::list<CProjectile*> projectiles = quad.projectiles;
 
-			for (std::list<CUnit*>::const_iterator it = units.begin(); it != units.end(); ++it) {
+			for (std::vector<CUnit*>::const_iterator it = units.begin(); it != units.end(); ++it) {
 				oldQuadField->RemoveUnit(*it);
 				newQuadField->MovedUnit(*it); // handles addition
 			}
 
-			for (std::list<CFeature*>::const_iterator it = features.begin(); it != features.end(); ++it) {
+			for (std::vector<CFeature*>::const_iterator it = features.begin(); it != features.end(); ++it) {
 				oldQuadField->RemoveFeature(*it);
 				newQuadField->AddFeature(*it);
 			}
@@ -107,6 +108,7 @@ CQuadField::CQuadField(unsigned int nqx, unsigned int nqz)
 
 	baseQuads.resize(numQuadsX * numQuadsZ);
 	tempQuads.resize(std::max(numTempQuads, numQuadsX * numQuadsZ));
+	movedUnitQuads.reserve(16);
 }
 
 CQuadField::~CQuadField()
@@ -117,11 +119,18 @@ CQuadField::~CQuadField()
 
 
 std::vector<int> CQuadField::GetQuads(float3 pos, float radius) const
+{
+	std::vector<int> ret;
+	GetQuads(ret, pos, radius);
+	return ret;
+}
+
+void CQuadField::GetQuads(std::vector<int>& quads, float3 pos, float radius) const
 {
 	pos.ClampInBounds();
 	pos.AssertNaNs();
 
-	std::vector<int> ret;
+	quads.clear();
 
 	// qsx and qsz are always equal
 	const float maxSqLength = (radius + quadSizeX * 0.72f) * (radius + quadSizeZ * 0.72f);
@@ -133,20 +142,18 @@ std::vector<int> CQuadField::GetQuads(float3 pos, float radius) const
 	const int minz = std::max((int(pos.z - radius)) / quadSizeZ, 0);
 
 	if (maxz < minz || maxx < minx) {
-		return ret;
+		return;
 	}
 
-	ret.reserve((maxz - minz) * (maxx - minx));
+	quads.reserve((maxz - minz + 1) * (maxx - minx + 1));
 
 	for (int z = minz; z <= maxz; ++z) {
 		for (int x = minx; x <= maxx; ++x) {
 			if ((pos - float3(x * quadSizeX + quadSizeX * 0.5f, 0, z * quadSizeZ + quadSizeZ * 0.5f)).SqLength2D() < maxSqLength) {
-				ret.push_back(z * numQuadsX + x);
+				quads.push_back(z * numQuadsX + x);
 			}
 		}
 	}
-
-	return ret;
 }
 
 
@@ -187,6 +194,28 @@ unsigned int CQuadField::GetQuads(float3 pos, float radius, int*& begQuad, int*&
 
 
 std::vector<CUnit*> CQuadField::GetUnits(const float3& pos, float radius)
+{
+	std::vector<CUnit*> units;
+	GetUnits(units, pos, radius);
+	return units;
+}
+
+std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& pos, float radius, bool spherical)
+{
+	std::vector<CUnit*> units;
+	GetUnitsExact(units, pos, radius, spherical);
+	return units;
+}
+
+std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& mins, const float3& maxs)
+{
+	std::vector<CUnit*> units;
+	GetUnitsExact(units, mins, maxs);
+	return units;
+}
+
+
+void CQuadField::GetUnits(std::vector<CUnit*>& units, const float3& pos, float radius)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetUnits
 
@@ -197,13 +226,12 @@ std::vector<CUnit*> CQuadField::GetUnits(const float3& pos, float radius)
 
 	GetQuads(pos, radius, begQuad, endQuad);
 
-	std::vector<CUnit*> units;
-	std::list<CUnit*>::iterator ui;
+	units.clear();
 
 	for (int* a = begQuad; a != endQuad; ++a) {
-		Quad& quad = baseQuads[*a];
+		const std::vector<CUnit*>& quadUnits = baseQuads[*a].units;
 
-		for (ui = quad.units.begin(); ui != quad.units.end(); ++ui) {
+		for (std::vector<CUnit*>::const_iterator ui = quadUnits.begin(); ui != quadUnits.end(); ++ui) {
 			if ((*ui)->tempNum == tempNum)
 				continue;
 
@@ -211,11 +239,9 @@ std::vector<CUnit*> CQuadField::GetUnits(const float3& pos, float radius)
 			units.push_back(*ui);
 		}
 	}
-
-	return units;
 }
 
-std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& pos, float radius, bool spherical)
+void CQuadField::GetUnitsExact(std::vector<CUnit*>& units, const float3& pos, float radius, bool spherical)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetUnitsExact
 
@@ -226,13 +252,12 @@ std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& pos, float radius, b
 
 	GetQuads(pos, radius, begQuad, endQuad);
 
-	std::vector<CUnit*> units;
-	std::list<CUnit*>::iterator ui;
+	units.clear();
 
 	for (int* a = begQuad; a != endQuad; ++a) {
-		Quad& quad = baseQuads[*a];
+		const std::vector<CUnit*>& quadUnits = baseQuads[*a].units;
 
-		for (ui = quad.units.begin(); ui != quad.units.end(); ++ui) {
+		for (std::vector<CUnit*>::const_iterator ui = quadUnits.begin(); ui != quadUnits.end(); ++ui) {
 			if ((*ui)->tempNum == tempNum)
 				continue;
 
@@ -249,25 +274,25 @@ std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& pos, float radius, b
 			units.push_back(*ui);
 		}
 	}
-
-	return units;
 }
 
-std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& mins, const float3& maxs)
+void CQuadField::GetUnitsExact(std::vector<CUnit*>& units, const float3& mins, const float3& maxs)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetUnitsExact
 
-	const std::vector<int>& quads = GetQuadsRectangle(mins, maxs);
 	const int tempNum = gs->tempNum++;
 
-	std::vector<CUnit*> units;
-	std::vector<int>::const_iterator qi;
+	int* begQuad = &tempQuads[0];
+	int* endQuad = &tempQuads[0];
 
-	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CUnit*>& quadUnits = baseQuads[*qi].units;
-		std::list<CUnit*>::iterator ui;
+	GetQuadsRectangle(mins, maxs, begQuad, endQuad);
+
+	units.clear();
 
-		for (ui = quadUnits.begin(); ui != quadUnits.end(); ++ui) {
+	for (int* a = begQuad; a != endQuad; ++a) {
+		const std::vector<CUnit*>& quadUnits = baseQuads[*a].units;
+
+		for (std::vector<CUnit*>::const_iterator ui = quadUnits.begin(); ui != quadUnits.end(); ++ui) {
 			CUnit* unit = *ui;
 			const float3& pos = unit->midPos;
 
@@ -279,8 +304,6 @@ std::vector<CUnit*> CQuadField::GetUnitsExact(const float3& mins, const float3&
 			units.push_back(unit);
 		}
 	}
-
-	return units;
 }
 
 
@@ -445,7 +468,8 @@ unsigned int CQuadField::GetQuadsOnRay(float3 start, float3 dir, float length, i
 
 void CQuadField::MovedUnit(CUnit* unit)
 {
-	const std::vector<int>& newQuads = GetQuads(unit->pos, unit->radius);
+	std::vector<int>& newQuads = movedUnitQuads;
+	GetQuads(newQuads, unit->pos, unit->radius);
 
 	// compare if the quads have changed, if not stop here
 	if (newQuads.size() == unit->quads.size()) {
@@ -458,22 +482,13 @@ void CQuadField::MovedUnit(CUnit* unit)
 
 	std::vector<int>::const_iterator qi;
 	for (qi = unit->quads.begin(); qi != unit->quads.end(); ++qi) {
-		std::list<CUnit*>& quadUnits     = baseQuads[*qi].units;
-		std::list<CUnit*>& quadAllyUnits = baseQuads[*qi].teamUnits[unit->allyteam];
-		std::list<CUnit*>::iterator ui;
-
-		ui = std::find(quadUnits.begin(), quadUnits.end(), unit);
-		if (ui != quadUnits.end())
-			quadUnits.erase(ui);
-
-		ui = std::find(quadAllyUnits.begin(), quadAllyUnits.end(), unit);
-		if (ui != quadAllyUnits.end())
-			quadAllyUnits.erase(ui);
+		VectorErase(baseQuads[*qi].units, unit);
+		VectorErase(baseQuads[*qi].teamUnits[unit->allyteam], unit);
 	}
 
 	for (qi = newQuads.begin(); qi != newQuads.end(); ++qi) {
-		baseQuads[*qi].units.push_front(unit);
-		baseQuads[*qi].teamUnits[unit->allyteam].push_front(unit);
+		baseQuads[*qi].units.push_back(unit);
+		baseQuads[*qi].teamUnits[unit->allyteam].push_back(unit);
 	}
 	unit->quads = newQuads;
 }
@@ -484,17 +499,8 @@ void CQuadField::RemoveUnit(CUnit* unit)
 
 	std::vector<int>::const_iterator qi;
 	for (qi = unit->quads.begin(); qi != unit->quads.end(); ++qi) {
-		std::list<CUnit*>& quadUnits     = baseQuads[*qi].units;
-		std::list<CUnit*>& quadAllyUnits = baseQuads[*qi].teamUnits[unit->allyteam];
-		std::list<CUnit*>::iterator ui;
-
-		ui = std::find(quadUnits.begin(), quadUnits.end(), unit);
-		if (ui != quadUnits.end())
-			quadUnits.erase(ui);
-
-		ui = std::find(quadAllyUnits.begin(), quadAllyUnits.end(), unit);
-		if (ui != quadAllyUnits.end())
-			quadAllyUnits.erase(ui);
+		VectorErase(baseQuads[*qi].units, unit);
+		VectorErase(baseQuads[*qi].teamUnits[unit->allyteam], unit);
 	}
 	unit->quads.clear();
 }
@@ -509,7 +515,7 @@ void CQuadField::AddFeature(CFeature* feature)
 
 	std::vector<int>::const_iterator qi;
 	for (qi = newQuads.begin(); qi != newQuads.end(); ++qi) {
-		baseQuads[*qi].features.push_front(feature);
+		baseQuads[*qi].features.push_back(feature);
 	}
 }
 
@@ -521,20 +527,16 @@ void CQuadField::RemoveFeature(CFeature* feature)
 
 	std::vector<int>::const_iterator qi;
 	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		baseQuads[*qi].features.remove(feature);
+		VectorErase(baseQuads[*qi].features, feature);
 	}
 
 	#ifdef DEBUG_QUADFIELD
 	for (int x = 0; x < numQuadsX; x++) {
 		for (int z = 0; z < numQuadsZ; z++) {
 			const Quad& q = baseQuads[z * numQuadsX + x];
-			const std::list<CFeature*>& f = q.features;
+			const std::vector<CFeature*>& f = q.features;
 
-			std::list<CFeature*>::const_iterator fIt;
-
-			for (fIt = f.begin(); fIt != f.end(); ++fIt) {
-				assert((*fIt) != feature);
-			}
+			assert(std::find(f.begin(), f.end(), feature) == f.end());
 		}
 	}
 	#endif
@@ -649,18 +651,44 @@ void CQuadField::RemoveProjectile(CProjectile* p)
 
 
 std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float radius)
+{
+	std::vector<CFeature*> features;
+	GetFeaturesExact(features, pos, radius);
+	return features;
+}
+
+std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float radius, bool spherical)
+{
+	std::vector<CFeature*> features;
+	GetFeaturesExact(features, pos, radius, spherical);
+	return features;
+}
+
+std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& mins, const float3& maxs)
+{
+	std::vector<CFeature*> features;
+	GetFeaturesExact(features, mins, maxs);
+	return features;
+}
+
+
+void CQuadField::GetFeaturesExact(std::vector<CFeature*>& features, const float3& pos, float radius)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetFeaturesExact
 
-	const std::vector<int>& quads = GetQuads(pos, radius);
 	const int tempNum = gs->tempNum++;
 
-	std::vector<CFeature*> features;
-	std::vector<int>::const_iterator qi;
-	std::list<CFeature*>::iterator fi;
+	int* begQuad = &tempQuads[0];
+	int* endQuad = &tempQuads[0];
 
-	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		for (fi = baseQuads[*qi].features.begin(); fi != baseQuads[*qi].features.end(); ++fi) {
+	GetQuads(pos, radius, begQuad, endQuad);
+
+	features.clear();
+
+	for (int* a = begQuad; a != endQuad; ++a) {
+		const std::vector<CFeature*>& quadFeatures = baseQuads[*a].features;
+
+		for (std::vector<CFeature*>::const_iterator fi = quadFeatures.begin(); fi != quadFeatures.end(); ++fi) {
 			if ((*fi)->tempNum == tempNum) { continue; }
 			if (pos.SqDistance((*fi)->midPos) >= Square(radius + (*fi)->radius)) { continue; }
 
@@ -668,25 +696,26 @@ std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float rad
 			features.push_back(*fi);
 		}
 	}
-
-	return features;
 }
 
-std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float radius, bool spherical)
+void CQuadField::GetFeaturesExact(std::vector<CFeature*>& features, const float3& pos, float radius, bool spherical)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetFeaturesExact
 
-	const std::vector<int>& quads = GetQuads(pos, radius);
 	const int tempNum = gs->tempNum++;
-
-	std::vector<CFeature*> features;
-	std::vector<int>::const_iterator qi;
-	std::list<CFeature*>::iterator fi;
 	const float totRadSq = radius * radius;
 
-	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		for (fi = baseQuads[*qi].features.begin(); fi != baseQuads[*qi].features.end(); ++fi) {
+	int* begQuad = &tempQuads[0];
+	int* endQuad = &tempQuads[0];
+
+	GetQuads(pos, radius, begQuad, endQuad);
 
+	features.clear();
+
+	for (int* a = begQuad; a != endQuad; ++a) {
+		const std::vector<CFeature*>& quadFeatures = baseQuads[*a].features;
+
+		for (std::vector<CFeature*>::const_iterator fi = quadFeatures.begin(); fi != quadFeatures.end(); ++fi) {
 			if ((*fi)->tempNum == tempNum) { continue; }
 			if ((spherical ?
 				(pos - (*fi)->midPos).SqLength() :
@@ -696,25 +725,25 @@ std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& pos, float rad
 			features.push_back(*fi);
 		}
 	}
-
-	return features;
 }
 
-std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& mins, const float3& maxs)
+void CQuadField::GetFeaturesExact(std::vector<CFeature*>& features, const float3& mins, const float3& maxs)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetFeaturesExact
 
-	const std::vector<int>& quads = GetQuadsRectangle(mins, maxs);
 	const int tempNum = gs->tempNum++;
 
-	std::vector<CFeature*> features;
-	std::vector<int>::const_iterator qi;
-	std::list<CFeature*>::iterator fi;
+	int* begQuad = &tempQuads[0];
+	int* endQuad = &tempQuads[0];
 
-	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CFeature*>& quadFeatures = baseQuads[*qi].features;
+	GetQuadsRectangle(mins, maxs, begQuad, endQuad);
+
+	features.clear();
 
-		for (fi = quadFeatures.begin(); fi != quadFeatures.end(); ++fi) {
+	for (int* a = begQuad; a != endQuad; ++a) {
+		const std::vector<CFeature*>& quadFeatures = baseQuads[*a].features;
+
+		for (std::vector<CFeature*>::const_iterator fi = quadFeatures.begin(); fi != quadFeatures.end(); ++fi) {
 			CFeature* feature = *fi;
 			const float3& pos = feature->midPos;
 
@@ -726,26 +755,40 @@ std::vector<CFeature*> CQuadField::GetFeaturesExact(const float3& mins, const fl
 			features.push_back(feature);
 		}
 	}
-
-	return features;
 }
 
 
 
 std::vector<CProjectile*> CQuadField::GetProjectilesExact(const float3& pos, float radius)
+{
+	std::vector<CProjectile*> projectiles;
+	GetProjectilesExact(projectiles, pos, radius);
+	return projectiles;
+}
+
+std::vector<CProjectile*> CQuadField::GetProjectilesExact(const float3& mins, const float3& maxs)
+{
+	std::vector<CProjectile*> projectiles;
+	GetProjectilesExact(projectiles, mins, maxs);
+	return projectiles;
+}
+
+
+void CQuadField::GetProjectilesExact(std::vector<CProjectile*>& projectiles, const float3& pos, float radius)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetProjectilesExact
 
-	const std::vector<int>& quads = GetQuads(pos, radius);
+	int* begQuad = &tempQuads[0];
+	int* endQuad = &tempQuads[0];
 
-	std::vector<CProjectile*> projectiles;
-	std::vector<int>::const_iterator qi;
-	std::list<CProjectile*>::iterator pi;
+	GetQuads(pos, radius, begQuad, endQuad);
 
-	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CProjectile*>& quadProjectiles = baseQuads[*qi].projectiles;
+	projectiles.clear();
+
+	for (int* a = begQuad; a != endQuad; ++a) {
+		const std::list<CProjectile*>& quadProjectiles = baseQuads[*a].projectiles;
 
-		for (pi = quadProjectiles.begin(); pi != quadProjectiles.end(); ++pi) {
+		for (std::list<CProjectile*>::const_iterator pi = quadProjectiles.begin(); pi != quadProjectiles.end(); ++pi) {
 			if ((pos - (*pi)->pos).SqLength() >= Square(radius + (*pi)->radius)) {
 				continue;
 			}
@@ -753,24 +796,23 @@ std::vector<CProjectile*> CQuadField::GetProjectilesExact(const float3& pos, flo
 			projectiles.push_back(*pi);
 		}
 	}
-
-	return projectiles;
 }
 
-std::vector<CProjectile*> CQuadField::GetProjectilesExact(const float3& mins, const float3& maxs)
+void CQuadField::GetProjectilesExact(std::vector<CProjectile*>& projectiles, const float3& mins, const float3& maxs)
 {
 	GML_RECMUTEX_LOCK(qnum); // GetProjectilesExact
 
-	const std::vector<int>& quads = GetQuadsRectangle(mins, maxs);
+	int* begQuad = &tempQuads[0];
+	int* endQuad = &tempQuads[0];
 
-	std::vector<CProjectile*> projectiles;
-	std::vector<int>::const_iterator qi;
-	std::list<CProjectile*>::iterator pi;
+	GetQuadsRectangle(mins, maxs, begQuad, endQuad);
 
-	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		std::list<CProjectile*>& quadProjectiles = baseQuads[*qi].projectiles;
+	projectiles.clear();
 
-		for (pi = quadProjectiles.begin(); pi != quadProjectiles.end(); ++pi) {
+	for (int* a = begQuad; a != endQuad; ++a) {
+		const std::list<CProjectile*>& quadProjectiles = baseQuads[*a].projectiles;
+
+		for (std::list<CProjectile*>::const_iterator pi = quadProjectiles.begin(); pi != quadProjectiles.end(); ++pi) {
 			CProjectile* projectile = *pi;
 			const float3& pos = projectile->pos;
 
@@ -780,8 +822,6 @@ std::vector<CProjectile*> CQuadField::GetProjectilesExact(const float3& mins, co
 			projectiles.push_back(projectile);
 		}
 	}
-
-	return projectiles;
 }
 
 
@@ -791,20 +831,34 @@ std::vector<CSolidObject*> CQuadField::GetSolidsExact(
 	const float radius,
 	const unsigned int physicalStateBits,
 	const unsigned int collisionStateBits
+) {
+	std::vector<CSolidObject*> solids;
+	GetSolidsExact(solids, pos, radius, physicalStateBits, collisionStateBits);
+	return solids;
+}
+
+void CQuadField::GetSolidsExact(
+	std::vector<CSolidObject*>& solids,
+	const float3& pos,
+	const float radius,
+	const unsigned int physicalStateBits,
+	const unsigned int collisionStateBits
 ) {
 	GML_RECMUTEX_LOCK(qnum); // GetSolidsExact
 
-	const std::vector<int>& quads = GetQuads(pos, radius);
 	const int tempNum = gs->tempNum++;
 
-	std::vector<CSolidObject*> solids;
-	std::vector<int>::const_iterator qi;
+	int* begQuad = &tempQuads[0];
+	int* endQuad = &tempQuads[0];
 
-	std::list<CUnit*>::iterator ui;
-	std::list<CFeature*>::iterator fi;
+	GetQuads(pos, radius, begQuad, endQuad);
 
-	for (qi = quads.begin(); qi != quads.end(); ++qi) {
-		for (ui = baseQuads[*qi].units.begin(); ui != baseQuads[*qi].units.end(); ++ui) {
+	solids.clear();
+
+	for (int* a = begQuad; a != endQuad; ++a) {
+		const Quad& quad = baseQuads[*a];
+
+		for (std::vector<CUnit*>::const_iterator ui = quad.units.begin(); ui != quad.units.end(); ++ui) {
 			CUnit* u = *ui;
 
 			if (u->tempNum == tempNum)
@@ -820,7 +874,7 @@ std::vector<CSolidObject*> CQuadField::GetSolidsExact(
 			solids.push_back(u);
 		}
 
-		for (fi = baseQuads[*qi].features.begin(); fi != baseQuads[*qi].features.end(); ++fi) {
+		for (std::vector<CFeature*>::const_iterator fi = quad.features.begin(); fi != quad.features.end(); ++fi) {
 			CFeature* f = *fi;
 
 			if (f->tempNum == tempNum)
@@ -836,8 +890,55 @@ std::vector<CSolidObject*> CQuadField::GetSolidsExact(
 			solids.push_back(f);
 		}
 	}
+}
 
-	return solids;
+
+
+void CQuadField::GetSolidsExactMT(
+	std::vector<int>& quads,
+	std::vector<CSolidObject*>& solids,
+	const float3& pos,
+	const float radius,
+	const unsigned int physicalStateBits,
+	const unsigned int collisionStateBits
+) const {
+	GetQuads(quads, pos, radius);
+
+	solids.clear();
+
+	for (std::vector<int>::const_iterator qi = quads.begin(); qi != quads.end(); ++qi) {
+		const Quad& quad = baseQuads[*qi];
+
+		for (std::vector<CUnit*>::const_iterator ui = quad.units.begin(); ui != quad.units.end(); ++ui) {
+			CUnit* u = *ui;
+
+			if (!u->HasPhysicalStateBit(physicalStateBits))
+				continue;
+			if (!u->HasCollidableStateBit(collisionStateBits))
+				continue;
+			if ((pos - u->midPos).SqLength() >= Square(radius + u->radius))
+				continue;
+			if (std::find(solids.begin(), solids.end(), u) != solids.end())
+				continue;
+
+			solids.push_back(u);
+		}
+
+		for (std::vector<CFeature*>::const_iterator fi = quad.features.begin(); fi != quad.features.end(); ++fi) {
+			CFeature* f = *fi;
+
+			if (!f->HasPhysicalStateBit(physicalStateBits))
+				continue;
+			if (!f->HasCollidableStateBit(collisionStateBits))
+				continue;
+			if ((pos - f->midPos).SqLength() >= Square(radius + f->radius))
+				continue;
+			if (std::find(solids.begin(), solids.end(), f) != solids.end())
+				continue;
+
+			solids.push_back(f);
+		}
+	}
 }
 
 
@@ -873,6 +974,35 @@ std::vector<int> CQuadField::GetQuadsRectangle(const float3& pos1, const float3&
 	return ret;
 }
 
+unsigned int CQuadField::GetQuadsRectangle(const float3& pos1, const float3& pos2, int*& begQuad, int*& endQuad) const
+{
+	assert(!math::isnan(pos1.x));
+	assert(!math::isnan(pos1.z));
+	assert(!math::isnan(pos2.x));
+	assert(!math::isnan(pos2.z));
+
+	assert(begQuad == &tempQuads[0]);
+	assert(endQuad == &tempQuads[0]);
+
+	const int maxx = std::max(0, std::min((int(pos2.x)) / quadSizeX + 1, numQuadsX - 1));
+	const int maxz = std::max(0, std::min((int(pos2.z)) / quadSizeZ + 1, numQuadsZ - 1));
+
+	const int minx = std::max(0, std::min((int(pos1.x)) / quadSizeX, numQuadsX - 1));
+	const int minz = std::max(0, std::min((int(pos1.z)) / quadSizeZ, numQuadsZ - 1));
+
+	if (maxz < minz || maxx < minx)
+		return 0;
+
+	// tempQuads holds at least numQuadsX * numQuadsZ entries
+	for (int z = minz; z <= maxz; ++z) {
+		for (int x = minx; x <= maxx; ++x) {
+			*endQuad = z * numQuadsX + x; ++endQuad;
+		}
+	}
+
+	return (endQuad - begQuad);
+}
+
 
 // optimization specifically for projectile collisions
 void CQuadField::GetUnitsAndFeaturesColVol(
@@ -905,8 +1035,8 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 	GetQuads(pos, radius, begQuad, endQuad);
 
-	std::list<CUnit*>::const_iterator ui;
-	std::list<CFeature*>::const_iterator fi;
+	std::vector<CUnit*>::const_iterator ui;
+	std::vector<CFeature*>::const_iterator fi;
 
 	for (int* a = begQuad; a != endQuad; ++a) {
 		const Quad& quad = baseQuads[*a];
@@ -967,3 +1097,53 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 	if (numFeaturesPtr != NULL) { *numFeaturesPtr = numFeatures; }
 }
 
+
+void CQuadField::GetUnitsAndFeaturesColVolMT(
+	const float3& pos,
+	const float radius,
+	std::vector<int>& quads,
+	std::vector<CUnit*>& units,
+	std::vector<CFeature*>& features
+) const {
+	GetQuads(quads, pos, radius);
+
+	units.clear();
+	features.clear();
+
+	std::vector<int>::const_iterator qi;
+	std::vector<CUnit*>::const_iterator ui;
+	std::vector<CFeature*>::const_iterator fi;
+
+	for (qi = quads.begin(); qi != quads.end(); ++qi) {
+		const Quad& quad = baseQuads[*qi];
+
+		for (ui = quad.units.begin(); ui != quad.units.end(); ++ui) {
+			CUnit* u = *ui;
+
+			const auto* colvol = u->collisionVolume;
+			const float totRad = radius + colvol->GetBoundingRadius();
+
+			if (pos.SqDistance(colvol->GetWorldSpacePos(u)) >= (totRad * totRad))
+				continue;
+			// objects spanning multiple quads; lists are short
+			if (std::find(units.begin(), units.end(), u) != units.end())
+				continue;
+
+			units.push_back(u);
+		}
+
+		for (fi = quad.features.begin(); fi != quad.features.end(); ++fi) {
+			CFeature* f = *fi;
+
+			const auto* colvol = f->collisionVolume;
+			const float totRad = radius + colvol->GetBoundingRadius();
+
+			if (pos.SqDistance(colvol->GetWorldSpacePos(f)) >= (totRad * totRad))
+				continue;
+			if (std::find(features.begin(), features.end(), f) != features.end())
+				continue;
+
+			features.push_back(f);
+		}
+	}
+}
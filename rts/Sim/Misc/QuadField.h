@@ -30,6 +30,8 @@ public:
 	std::vector<int> GetQuads(float3 pos, float radius) const;
 	std::vector<int> GetQuadsRectangle(const float3& pos1, const float3& pos2) const;
 
+	void GetQuads(std::vector<int>& quads, float3 pos, float radius) const;
+
 	// optimized functions, somewhat less userfriendly
 	//
 	// when calling these, <begQuad> and <endQuad> are both expected
@@ -38,6 +40,7 @@ public:
 	// this by itself, for GetQuads the callers take care of it
 	//
 	unsigned int GetQuads(float3 pos, float radius, int*& begQuad, int*& endQuad) const;
+	unsigned int GetQuadsRectangle(const float3& pos1, const float3& pos2, int*& begQuad, int*& endQuad) const;
 	unsigned int GetQuadsOnRay(float3 start, float3 dir, float length, int*& begQuad, int*& endQuad);
 
 	void GetUnitsAndFeaturesColVol(
@@ -49,6 +52,21 @@ public:
 		unsigned int* numFeaturesPtr = NULL
 	);
 
+	/**
+	 * Read-only variant of GetUnitsAndFeaturesColVol which may be called
+	 * from multiple threads at once: it neither uses tempQuads nor changes
+	 * the objects' tempNum, so duplicates are filtered by searching the
+	 * results instead. Output order matches the serial version. All three
+	 * vectors are caller-owned scratch buffers and are cleared first.
+	 */
+	void GetUnitsAndFeaturesColVolMT(
+		const float3& pos,
+		const float radius,
+		std::vector<int>& quads,
+		std::vector<CUnit*>& units,
+		std::vector<CFeature*>& features
+	) const;
+
 	/**
 	 * Returns all units within @c radius of @c pos,
 	 * and treats each unit as a 3D point object
@@ -92,6 +110,39 @@ public:
 		const unsigned int collisionStateBits = 0xFFFFFFFF
 	);
 
+	// same as the above, but write into caller-owned buffers which are
+	// cleared first; callers that query every frame should keep these
+	// around so their storage gets reused instead of reallocated
+	void GetUnits(std::vector<CUnit*>& units, const float3& pos, float radius);
+	void GetUnitsExact(std::vector<CUnit*>& units, const float3& pos, float radius, bool spherical = true);
+	void GetUnitsExact(std::vector<CUnit*>& units, const float3& mins, const float3& maxs);
+	void GetFeaturesExact(std::vector<CFeature*>& features, const float3& pos, float radius);
+	void GetFeaturesExact(std::vector<CFeature*>& features, const float3& pos, float radius, bool spherical);
+	void GetFeaturesExact(std::vector<CFeature*>& features, const float3& mins, const float3& maxs);
+	void GetProjectilesExact(std::vector<CProjectile*>& projectiles, const float3& pos, float radius);
+	void GetProjectilesExact(std::vector<CProjectile*>& projectiles, const float3& mins, const float3& maxs);
+	void GetSolidsExact(
+		std::vector<CSolidObject*>& solids,
+		const float3& pos,
+		const float radius,
+		const unsigned int physicalStateBits = 0xFFFFFFFF,
+		const unsigned int collisionStateBits = 0xFFFFFFFF
+	);
+
+	/**
+	 * Read-only variant of GetSolidsExact which may be called from multiple
+	 * threads at once, see GetUnitsAndFeaturesColVolMT. Output order matches
+	 * the serial version.
+	 */
+	void GetSolidsExactMT(
+		std::vector<int>& quads,
+		std::vector<CSolidObject*>& solids,
+		const float3& pos,
+		const float radius,
+		const unsigned int physicalStateBits,
+		const unsigned int collisionStateBits
+	) const;
+
 	void MovedUnit(CUnit* unit);
 	void RemoveUnit(CUnit* unit);
 
@@ -102,12 +153,15 @@ public:
 	void AddProjectile(CProjectile* projectile);
 	void RemoveProjectile(CProjectile* projectile);
 
+	// units and features are stored contiguously per cell (and removed by
+	// swapping with the last element), projectiles keep a list since they
+	// store iterators into it for O(1) removal
 	struct Quad {
 		CR_DECLARE_STRUCT(Quad);
 		Quad();
-		std::list<CUnit*> units;
-		std::vector< std::list<CUnit*> > teamUnits;
-		std::list<CFeature*> features;
+		std::vector<CUnit*> units;
+		std::vector< std::vector<CUnit*> > teamUnits;
+		std::vector<CFeature*> features;
 		std::list<CProjectile*> projectiles;
 	};
 
@@ -133,6 +187,9 @@ private:
 	std::vector<Quad> baseQuads;
 	std::vector<int> tempQuads;
 
+	// scratch buffer for MovedUnit, not serialized
+	std::vector<int> movedUnitQuads;
+
 	int numQuadsX;
 	int numQuadsZ;
 
@@ -35,7 +35,11 @@ CR_REG_METADATA(CRadarHandler, (
 	SONAR_MAPS
 	CR_MEMBER(seismicMaps),
 	CR_MEMBER(commonJammerMap),
-	CR_MEMBER(commonSonarJammerMap)
+	CR_MEMBER(commonSonarJammerMap),
+	CR_IGNORED(radarAllyMask),
+	CR_IGNORED(airRadarAllyMask),
+	CR_IGNORED(sonarAllyMask),
+	CR_POSTLOAD(PostLoad)
 ));
 
 
@@ -67,6 +71,35 @@ CRadarHandler::CRadarHandler(bool circularRadar)
 	sonarJammerMaps.resize(teamHandler->ActiveAllyTeams(), tmp);
 #endif
 	radarErrorSizes.resize(teamHandler->ActiveAllyTeams(), baseRadarErrorSize);
+
+	InitAllyMasks();
+}
+
+
+void CRadarHandler::PostLoad()
+{
+	// the maps themselves are serialized, the masks are derived from them
+	InitAllyMasks();
+}
+
+void CRadarHandler::InitAllyMasks()
+{
+	radarAllyMask.clear();
+	airRadarAllyMask.clear();
+	sonarAllyMask.clear();
+
+	if (teamHandler->ActiveAllyTeams() > CLosMap::MAX_MASK_ALLYTEAMS)
+		return;
+
+	radarAllyMask.resize(xsize * zsize, 0);
+	airRadarAllyMask.resize(xsize * zsize, 0);
+	sonarAllyMask.resize(xsize * zsize, 0);
+
+	for (int a = 0; a < teamHandler->ActiveAllyTeams(); ++a) {
+		radarMaps[a].SetAllyMask(&radarAllyMask, a);
+		airRadarMaps[a].SetAllyMask(&airRadarAllyMask, a);
+		sonarMaps[a].SetAllyMask(&sonarAllyMask, a);
+	}
 }
 
 
@@ -95,11 +128,7 @@ void CRadarHandler::MoveUnit(CUnit* unit)
 	newPos.x = (int) (unit->pos.x * invRadarDiv);
 	newPos.y = (int) (unit->pos.z * invRadarDiv);
 
-	if (!unit->hasRadarPos ||
-		(newPos.x != unit->oldRadarPos.x) ||
-	    (newPos.y != unit->oldRadarPos.y)) {
-		RemoveUnit(unit);
-
+	if (!unit->hasRadarPos) {
 		if (unit->jammerRadius) {
 			jammerMaps[unit->allyteam].AddMapArea(newPos, -123, unit->jammerRadius, 1);
 			commonJammerMap.AddMapArea(newPos, -123, unit->jammerRadius, 1);
@@ -125,7 +154,45 @@ void CRadarHandler::MoveUnit(CUnit* unit)
 		}
 		unit->oldRadarPos = newPos;
 		unit->hasRadarPos = true;
+		return;
+	}
+
+	if ((newPos.x == unit->oldRadarPos.x) && (newPos.y == unit->oldRadarPos.y))
+		return;
+
+	// a moving unit mostly overlaps its previous coverage, so only
+	// update the squares entering or leaving the circular areas
+	// (radii and allyteam cannot change while hasRadarPos is set,
+	// ChangeSensorRadius and ChangeTeam call RemoveUnit first)
+	const int2 oldPos = unit->oldRadarPos;
+
+	if (unit->jammerRadius) {
+		jammerMaps[unit->allyteam].MoveMapArea(oldPos, newPos, -123, unit->jammerRadius, 1);
+		commonJammerMap.MoveMapArea(oldPos, newPos, -123, unit->jammerRadius, 1);
+	}
+	if (unit->sonarJamRadius) {
+#ifdef SONAR_JAMMER_MAPS
+		sonarJammerMaps[unit->allyteam].MoveMapArea(oldPos, newPos, -123, unit->sonarJamRadius, 1);
+#endif
+		commonSonarJammerMap.MoveMapArea(oldPos, newPos, -123, unit->sonarJamRadius, 1);
+	}
+	if (unit->radarRadius) {
+		airRadarMaps[unit->allyteam].MoveMapArea(oldPos, newPos, -123, unit->radarRadius, 1);
+		if (!circularRadar) {
+			// terrain-dependent, has to be recomputed from scratch
+			radarMaps[unit->allyteam].AddMapSquares(unit->radarSquares, -123, -1);
+			unit->radarSquares.clear();
+			radarAlgo.LosAdd(newPos, unit->radarRadius, unit->radarHeight, unit->radarSquares);
+			radarMaps[unit->allyteam].AddMapSquares(unit->radarSquares, -123, 1);
+		}
+	}
+	if (unit->sonarRadius) {
+		sonarMaps[unit->allyteam].MoveMapArea(oldPos, newPos, -123, unit->sonarRadius, 1);
+	}
+	if (unit->seismicRadius) {
+		seismicMaps[unit->allyteam].MoveMapArea(oldPos, newPos, -123, unit->seismicRadius, 1);
 	}
+	unit->oldRadarPos = newPos;
 }
 
 
@@ -121,6 +121,19 @@ public:
 	}
 
 
+	/**
+	 * Allyteams whose radar, air-radar or sonar covers pos, one bit per
+	 * allyteam; a superset of the ones for which InRadar holds (jamming and
+	 * stealth are not taken into account). Only valid if HasAllyMasks().
+	 */
+	CLosMap::AllyMask GetAllyMask(const float3& pos) const {
+		const int square = GetSquare(pos);
+		return (radarAllyMask[square] | airRadarAllyMask[square] | sonarAllyMask[square]);
+	}
+
+	/// false if there are more allyteams than bits in CLosMap::AllyMask
+	bool HasAllyMasks() const { return (!radarAllyMask.empty()); }
+
 	bool InSeismicDistance(const CUnit* unit, int allyTeam) const {
 		return (seismicMaps[allyTeam][GetSquare(unit->pos)] != 0);
 	}
@@ -156,10 +169,18 @@ public:
 	CLosMap commonSonarJammerMap;
 	std::vector<float> radarErrorSizes;
 
+	/// per-square bits of the allyteams with a non-zero count in radarMaps etc.
+	std::vector<CLosMap::AllyMask> radarAllyMask;
+	std::vector<CLosMap::AllyMask> airRadarAllyMask;
+	std::vector<CLosMap::AllyMask> sonarAllyMask;
+
 	int xsize;
 	int zsize;
 
 private:
+	void PostLoad();
+	void InitAllyMasks();
+
 	CLosAlgorithm radarAlgo;
 
 	float baseRadarErrorSize;
@@ -59,6 +59,9 @@ CResourceHandler::CResourceHandler()
 
 CResourceHandler::~CResourceHandler()
 {
+	for (std::map<int, CResourceMapAnalyzer*>::iterator it = resourceMapAnalyzers.begin(); it != resourceMapAnalyzers.end(); ++it) {
+		delete it->second;
+	}
 }
 
 int CResourceHandler::AddResource(const CResource& resource) {
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <string>
 #include <cstdio>
 
@@ -18,18 +19,24 @@ using std::fclose;
 #include "Game/GameSetup.h"
 #include "Map/MapInfo.h"
 #include "Map/MetalMap.h"
+#include "System/FileSystem/ArchiveScanner.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/Util.h"
+#include "lib/streflop/streflop_cond.h"
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <stdexcept>
 
 static const float3 ERRORVECTOR(-1, 0, 0);
 static std::string CACHE_BASE("");
 
 CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
-	: resourceId(resourceId)
+	: analysisThread(NULL)
+	, resourceId(resourceId)
 	, extractorRadius(-1.0f)
 	, numSpotsFound(0)
 	, vectoredSpots()
@@ -86,11 +93,21 @@ CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
 
 	tempAverage = new int[totalCells];
 
-	Init();
+	// everything the analysis reads from the engine is gathered here; the
+	// resource map is copied before Lua or AIs get a chance to change it
+	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
+
+	if (resourceMapArray != NULL)
+		std::copy(resourceMapArray, resourceMapArray + totalCells, rexArrayA);
+
+	cacheFileName = GetCacheFileName();
+	analysisThread = new boost::thread(boost::bind(&CResourceMapAnalyzer::Init, this));
 }
 
 CResourceMapAnalyzer::~CResourceMapAnalyzer() {
 
+	WaitForAnalysis();
+
 	delete[] rexArrayA;
 	delete[] rexArrayB;
 	delete[] rexArrayC;
@@ -113,6 +130,8 @@ float3 CResourceMapAnalyzer::GetNearestSpot(int builderUnitId, const UnitDef* ex
 
 float3 CResourceMapAnalyzer::GetNearestSpot(float3 fromPos, int team, const UnitDef* extractor) const {
 
+	WaitForAnalysis();
+
 	float tempScore = 0.0f;
 	float maxDivergence = 16.0f;
 	float3 spotCoords = ERRORVECTOR;
@@ -153,6 +172,9 @@ float3 CResourceMapAnalyzer::GetNearestSpot(float3 fromPos, int team, const Unit
 
 void CResourceMapAnalyzer::Init() {
 
+	// the spot worths are floats and end up in synced Lua
+	streflop::streflop_init<streflop::Simple>();
+
 	// Leave this line if you want to use this class
 	const CResource* resource = resourceHandler->GetResource(resourceId);
 	LOG("ResourceMapAnalyzer by Krogothe, initialized for resource %i(%s)",
@@ -165,11 +187,23 @@ void CResourceMapAnalyzer::Init() {
 	}
 }
 
+void CResourceMapAnalyzer::WaitForAnalysis() const {
+
+	if (analysisThread == NULL)
+		return;
+
+	analysisThread->join();
+	delete analysisThread;
+	analysisThread = NULL;
+}
+
 float CResourceMapAnalyzer::GetAverageIncome() const {
+	WaitForAnalysis();
 	return averageIncome;
 }
 
 const std::vector<float3>& CResourceMapAnalyzer::GetSpots() const {
+	WaitForAnalysis();
 	return vectoredSpots;
 }
 
@@ -182,14 +216,13 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 		xend[a] = int(math::sqrt(floatsqrradius - z * z));
 	}
 
-	// load up the resource values in each pixel
-	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
+	// the resource values in each pixel were loaded by the constructor
 	double totalResourcesDouble  = 0;
 
 	for (int i = 0; i < totalCells; i++) {
 		// count the total resources so you can work out
 		// an average of the whole map
-		totalResourcesDouble +=  rexArrayA[i] = resourceMapArray[i];
+		totalResourcesDouble += rexArrayA[i];
 	}
 
 	// do the average
@@ -555,7 +588,6 @@ static inline void writeToFile(const T& value, FILE* file) {
 
 void CResourceMapAnalyzer::SaveResourceMap() {
 
-	const std::string cacheFileName = GetCacheFileName();
 	FILE* saveFile = fopen(cacheFileName.c_str(), "wb");
 
 	try {
@@ -574,7 +606,8 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 				cacheFileName.c_str(), err.what());
 	}
 
-	fclose(saveFile);
+	if (saveFile != NULL)
+		fclose(saveFile);
 }
 
 static void fileReadChecked(void* buf, size_t size, size_t count, FILE* fstream) {
@@ -588,8 +621,6 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 
 	bool loaded = false;
 
-	const std::string cacheFileName = GetCacheFileName();
-
 	FILE* cacheFile = fopen(cacheFileName.c_str(), "rb");
 
 	if (cacheFile != NULL) {
@@ -616,7 +647,10 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 std::string CResourceMapAnalyzer::GetCacheFileName() const {
 
 	const CResource* resource = resourceHandler->GetResource(resourceId);
-	std::string absFile = CACHE_BASE + gameSetup->mapName + resource->name;
+	const unsigned int mapChecksum = archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName);
+
+	// the checksum keeps a stale analysis of an older map version from being used
+	std::string absFile = CACHE_BASE + gameSetup->mapName + "-" + IntToString(mapChecksum, "%08x") + "-" + resource->name;
 
 	return absFile;
 }
@@ -4,11 +4,21 @@
 #define _RESOURCE_MAP_ANALYZER_H
 
 #include "System/float3.h"
+#include <string>
 #include <vector>
 
 class CResource;
 struct UnitDef;
 
+namespace boost {
+	class thread;
+}
+
+/**
+ * Finds the spots for resource extractors. The analysis (or loading its
+ * result from the cache, keyed by map checksum) runs on its own thread
+ * from construction on, all getters wait for it to finish.
+ */
 class CResourceMapAnalyzer {
 	public:
 		CResourceMapAnalyzer(int resourceId);
@@ -25,15 +35,20 @@ class CResourceMapAnalyzer {
 		 * effective output from spots.
 		 */
 		const std::vector<float3>& GetSpots() const;
+		float GetExtractorRadius() const { return extractorRadius; }
 
 	private:
 		void Init();
+		void WaitForAnalysis() const;
 		void GetResourcePoints();
 		void SaveResourceMap();
 		bool LoadResourceMap();
 
 		std::string GetCacheFileName() const;
 
+		mutable boost::thread* analysisThread;
+		std::string cacheFileName;
+
 		int resourceId;
 		float extractorRadius;
 		int numSpotsFound;
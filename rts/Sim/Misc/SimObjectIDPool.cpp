@@ -3,14 +3,22 @@
 #include "SimObjectIDPool.h"
 #include "GlobalSynced.h"
 #include "Sim/Objects/SolidObject.h"
+#include "System/bitops.h"
+
+#include <algorithm>
 
 CR_BIND(SimObjectIDPool, );
 CR_REG_METADATA(SimObjectIDPool, (
-	CR_MEMBER(liveIdentIndexMap),
-	CR_MEMBER(liveIndexIdentMap),
-	CR_MEMBER(tempIndexIdentMap)
+	CR_MEMBER(indexIdentMap),
+	CR_MEMBER(identIndexMap),
+	CR_MEMBER(freeIndexBits),
+	CR_MEMBER(tempIndices),
+	CR_MEMBER(numFreeIndices),
+	CR_MEMBER(minFreeIndex)
 ));
 
+const unsigned int SimObjectIDPool::INVALID_INDEX;
+
 void SimObjectIDPool::Expand(unsigned int baseID, unsigned int numIDs) {
 	// allocate new batch of (randomly shuffled) id's
 	std::vector<int> newIDs(numIDs);
@@ -25,24 +33,49 @@ void SimObjectIDPool::Expand(unsigned int baseID, unsigned int numIDs) {
 	std::random_shuffle(newIDs.begin(), newIDs.end(), rng);
 
 	// NOTE:
-	//   any randomization would be undone by using a std::set as-is
+	//   any randomization would be undone by handing out ID's in order
 	//   instead create a bi-directional mapping from indices to ID's
 	//   (where the ID's are a random permutation of the index range)
 	//   such that ID's can be assigned and returned to the pool with
-	//   their original index
+	//   their original index, and always hand out the lowest free one
 	//
 	//     indexIdentMap = {<0, 13>, < 1, 27>, < 2, 54>, < 3, 1>, ...}
 	//     identIndexMap = {<1,  3>, <13,  0>, <27,  1>, <54, 2>, ...}
 	//
 	//   (the ID --> index map is never changed at runtime!)
+	const unsigned int newSize = std::max(MaxSize(), baseID + numIDs);
+
+	indexIdentMap.resize(newSize, INVALID_INDEX);
+	identIndexMap.resize(newSize, INVALID_INDEX);
+	freeIndexBits.resize((newSize + 31) >> 5, 0);
+
 	for (unsigned int offsetID = 0; offsetID < numIDs; offsetID++) {
-		liveIndexIdentMap.insert(IDPair(baseID + offsetID, newIDs[offsetID]));
-		liveIdentIndexMap.insert(IDPair(newIDs[offsetID], baseID + offsetID));
+		indexIdentMap[baseID + offsetID] = newIDs[offsetID];
+		identIndexMap[newIDs[offsetID]] = baseID + offsetID;
+
+		SetFreeIndex(baseID + offsetID);
 	}
 }
 
 
 
+void SimObjectIDPool::SetFreeIndex(unsigned int idx) {
+	assert(!IsFreeIndex(idx));
+
+	freeIndexBits[idx >> 5] |= (1u << (idx & 31));
+	numFreeIndices += 1;
+	minFreeIndex = std::min(minFreeIndex, idx);
+}
+
+void SimObjectIDPool::ClearFreeIndex(unsigned int idx) {
+	assert(IsFreeIndex(idx));
+
+	freeIndexBits[idx >> 5] &= ~(1u << (idx & 31));
+	numFreeIndices -= 1;
+}
+
+
+
 void SimObjectIDPool::AssignID(CSolidObject* object) {
 	if (object->id < 0) {
 		object->id = ExtractID();
@@ -58,10 +91,21 @@ unsigned int SimObjectIDPool::ExtractID() {
 	// and FeatureHandler have safeguards
 	assert(!IsEmpty());
 
-	const IDMap::iterator it = liveIndexIdentMap.begin();
-	const unsigned int id = it->second;
+	// find the lowest free index; everything below
+	// minFreeIndex is known to be taken, so this only
+	// rarely has to look at more than one word
+	unsigned int word = minFreeIndex >> 5;
+	unsigned int bits = freeIndexBits[word] & (~0u << (minFreeIndex & 31));
+
+	while (bits == 0) {
+		bits = freeIndexBits[++word];
+	}
+
+	const unsigned int idx = (word << 5) + (bits_ffs(bits) - 1);
+	const unsigned int id = indexIdentMap[idx];
 
-	liveIndexIdentMap.erase(it);
+	ClearFreeIndex(idx);
+	minFreeIndex = idx + 1;
 
 	if (IsEmpty()) {
 		RecycleIDs();
@@ -75,10 +119,7 @@ void SimObjectIDPool::ReserveID(unsigned int id) {
 	assert(HasID(id));
 	assert(!IsEmpty());
 
-	const IDMap::iterator it = liveIdentIndexMap.find(id);
-	const unsigned int idx = it->second;
-
-	liveIndexIdentMap.erase(idx);
+	ClearFreeIndex(identIndexMap[id]);
 
 	if (IsEmpty()) {
 		RecycleIDs();
@@ -93,25 +134,24 @@ void SimObjectIDPool::FreeID(unsigned int id, bool delayed) {
 	assert(!HasID(id));
 
 	if (delayed) {
-		tempIndexIdentMap.insert(IDPair(liveIdentIndexMap[id], id));
+		tempIndices.push_back(identIndexMap[id]);
 	} else {
-		liveIndexIdentMap.insert(IDPair(liveIdentIndexMap[id], id));
+		SetFreeIndex(identIndexMap[id]);
 	}
 }
 
 void SimObjectIDPool::RecycleIDs() {
 	// throw each ID recycled up until now back into the pool
-	liveIndexIdentMap.insert(tempIndexIdentMap.begin(), tempIndexIdentMap.end());
-	tempIndexIdentMap.clear();
+	for (unsigned int n = 0; n < tempIndices.size(); n++) {
+		SetFreeIndex(tempIndices[n]);
+	}
+
+	tempIndices.clear();
 }
 
 bool SimObjectIDPool::HasID(unsigned int id) const {
-	assert(liveIdentIndexMap.find(id) != liveIdentIndexMap.end());
+	assert(id < identIndexMap.size() && identIndexMap[id] != INVALID_INDEX);
 
 	// check if given ID is available in this pool
-	const IDMap::const_iterator it = liveIdentIndexMap.find(id);
-	const unsigned int idx = it->second;
-
-	return (liveIndexIdentMap.find(idx) != liveIndexIdentMap.end());
+	return (IsFreeIndex(identIndexMap[id]));
 }
-
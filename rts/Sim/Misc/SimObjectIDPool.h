@@ -3,39 +3,53 @@
 #ifndef SIMOBJECT_IDPOOL_H
 #define SIMOBJECT_IDPOOL_H
 
-// #include <map>
 #include <vector>
 
-#include "System/creg/STL_Map.h"
+#include "System/creg/creg_cond.h"
 
 class CSolidObject;
 class SimObjectIDPool {
 	CR_DECLARE_STRUCT(SimObjectIDPool)
 
 public:
+	SimObjectIDPool(): numFreeIndices(0), minFreeIndex(0) {}
+
 	void Expand(unsigned int baseID, unsigned int numIDs);
 
 	void AssignID(CSolidObject* object);
 	void FreeID(unsigned int id, bool delayed);
 
 	bool HasID(unsigned int id) const;
-	bool IsEmpty() const { return (liveIndexIdentMap.empty()); }
+	bool IsEmpty() const { return (numFreeIndices == 0); }
 
-	unsigned int GetSize() const { return (liveIndexIdentMap.size()); } // number of ID's still unused
-	unsigned int MaxSize() const { return (liveIdentIndexMap.size()); } // number of ID's this pool owns
+	unsigned int GetSize() const { return numFreeIndices; } // number of ID's still unused
+	unsigned int MaxSize() const { return (indexIdentMap.size()); } // number of ID's this pool owns
 
 private:
 	unsigned int ExtractID();
 	void ReserveID(unsigned int id);
 	void RecycleIDs();
 
+	bool IsFreeIndex(unsigned int idx) const { return ((freeIndexBits[idx >> 5] >> (idx & 31)) & 1); }
+	void SetFreeIndex(unsigned int idx);
+	void ClearFreeIndex(unsigned int idx);
+
 private:
-	typedef std::pair<unsigned int, unsigned int> IDPair;
-	typedef std::map<unsigned int, unsigned int> IDMap;
+	static const unsigned int INVALID_INDEX = -1u;
+
+	// bi-directional mapping between indices and (shuffled) ID's,
+	// both are dense and never change at runtime except by Expand
+	std::vector<unsigned int> indexIdentMap;
+	std::vector<unsigned int> identIndexMap;
+
+	// bit <idx> is set iff the ID at index <idx> is available
+	std::vector<unsigned int> freeIndexBits;
+	// indices of ID's freed with delay, see RecycleIDs
+	std::vector<unsigned int> tempIndices;
 
-	IDMap liveIdentIndexMap;
-	IDMap liveIndexIdentMap;
-	IDMap tempIndexIdentMap;
+	unsigned int numFreeIndices;
+	// no index below this one is free
+	unsigned int minFreeIndex;
 };
 
 #endif
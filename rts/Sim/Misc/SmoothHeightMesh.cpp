@@ -2,12 +2,12 @@
 
 #include <vector>
 #include <cassert>
-#include <limits>
 
 #include "SmoothHeightMesh.h"
 
 #include "Map/Ground.h"
 #include "Map/ReadMap.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "System/float3.h"
 #include "System/myMath.h"
 #include "System/TimeProfiler.h"
@@ -91,350 +91,210 @@ float SmoothHeightMesh::SetMaxHeight(int index, float h)
 
 
 
-inline static void FindMaximumColumnHeights(
-	const int maxx,
-	const int maxy,
-	const int intrad,
-	const float resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows)
-{
-	// initialize the algorithm: find the maximum
-	// height per column and the corresponding row
-	for (int y = 0; y <= std::min(maxy, intrad); ++y) {
-		for (int x = 0; x <= maxx; ++x)  {
-			const float curx = x * resolution;
-			const float cury = y * resolution;
-			const float curh = ground->GetHeightAboveWater(curx, cury);
-
-			if (curh > colsMaxima[x]) {
-				colsMaxima[x] = curh;
-				maximaRows[x] = y;
-			}
-		}
-	}
-}
-
-inline static void AdvanceMaximaRows(
-	const int y,
-	const int maxx,
-	const float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<int>& maximaRows)
-{
-	const float cury = y * resolution;
-
-	// try to advance rows if they're equal to current maximum but are further away
-	for (int x = 0; x <= maxx; ++x) {
-		if (maximaRows[x] == (y - 1)) {
-			const float curx = x * resolution;
-			const float curh = ground->GetHeightAboveWater(curx, cury);
-
-			if (curh == colsMaxima[x]) {
-				maximaRows[x] = y;
-			}
-
-			assert(curh <= colsMaxima[x]);
-		}
-	}
-}
+// number and radius (in mesh cells) of the box-blur passes per axis
+static const int NUM_BLURS = 3;
+static const int BLUR_RADIUS = 3;
 
 
 
-inline static void FindRadialMaximum(
-	int y,
-	int maxx,
-	int intrad,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<float>& mesh)
+/**
+ * out[i - outBegin] = max(in[j]) for j in [i - r, i + r] clamped to [0, n)
+ * for every i in [outBegin, outEnd]; dq is scratch space for n indices
+ */
+inline static void SlidingMax(
+	const float* in,
+	const int inStride,
+	const int n,
+	const int r,
+	const int outBegin,
+	const int outEnd,
+	float* out,
+	const int outStride,
+	int* dq)
 {
-	const float cury = y * resolution;
+	// monotonic deque of indices with decreasing values
+	int head = 0;
+	int tail = 0;
+	int next = std::max(0, outBegin - r);
 
-	for (int x = 0; x <= maxx; ++x) {
-		float maxRowHeight = -std::numeric_limits<float>::max();
+	for (int i = outBegin; i <= outEnd; ++i) {
+		for (const int end = std::min(n - 1, i + r); next <= end; ++next) {
+			const float h = in[next * inStride];
 
-		// find current maximum within radius smoothRadius
-		// (in every column stack) along the current row
-		const int startx = std::max(x - intrad, 0);
-		const int endx = std::min(maxx, x + intrad);
+			while (tail > head && in[dq[tail - 1] * inStride] <= h)
+				--tail;
 
-		for (int i = startx; i <= endx; ++i) {
-			assert(i >= 0);
-			assert(i <= maxx);
-			assert(ground->GetHeightReal(i * resolution, cury) <= colsMaxima[i]);
-
-			maxRowHeight = std::max(colsMaxima[i], maxRowHeight);
+			dq[tail++] = next;
 		}
 
-#ifndef NDEBUG
-		const float curx = x * resolution;
-		assert(maxRowHeight <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-		assert(maxRowHeight >= ground->GetHeightAboveWater(curx, cury));
-
-	#ifdef SMOOTHMESH_CORRECTNESS_CHECK
-		// naive algorithm
-		float maxRowHeightAlt = -std::numeric_limits<float>::max();
+		while (dq[head] < (i - r))
+			++head;
 
-		for (float y1 = cury - smoothRadius; y1 <= cury + smoothRadius; y1 += resolution) {
-			for (float x1 = curx - smoothRadius; x1 <= curx + smoothRadius; x1 += resolution) {
-				maxRowHeightAlt = std::max(maxRowHeightAlt, ground->GetHeightAboveWater(x1, y1));
-			}
-		}
-
-		assert(maxRowHeightAlt == maxRowHeight);
-	#endif
-#endif
-
-		mesh[x + y * maxx] = maxRowHeight;
+		out[(i - outBegin) * outStride] = in[dq[head] * inStride];
 	}
 }
 
-
-
-inline static void FixRemainingMaxima(
-	const int y,
-	const int maxx,
-	const int maxy,
-	const int intrad,
-	const float resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows)
+/**
+ * out[i] = average of in[j] for j in [i - r, i + r] clamped to [0, n),
+ * kept between the ground height <gh[i]> and <maxHeight>
+ */
+inline static void BoxBlur(
+	const float* in,
+	const int stride,
+	const int n,
+	const int r,
+	const float* gh,
+	const int ghStride,
+	const float maxHeight,
+	float* out)
 {
-	// fix remaining maximums after a pass
-	const int nextrow = y + intrad + 1;
-	const float nextrowy = nextrow * resolution;
-
-	for (int x = 0; x <= maxx; ++x) {
-#ifdef _DEBUG
-		for (int y1 = std::max(0, y - intrad); y1 <= std::min(maxy, y + intrad); ++y1) {
-			assert(ground->GetHeightReal(x * resolution, y1 * resolution) <= colsMaxima[x]);
-		}
-#endif
-		const float curx = x * resolution;
-
-		if (maximaRows[x] <= (y - intrad)) {
-			// find a new maximum if the old one left the window
-			colsMaxima[x] = -std::numeric_limits<float>::max();
-
-			for (int y1 = std::max(0, y - intrad + 1); y1 <= std::min(maxy, nextrow); ++y1) {
-				const float h = ground->GetHeightAboveWater(curx, y1 * resolution);
-
-				if (h > colsMaxima[x]) {
-					colsMaxima[x] = h;
-					maximaRows[x] = y1;
-				} else if (colsMaxima[x] == h) {
-					// if equal, move as far down as possible
-					maximaRows[x] = y1;
-				}
-			}
-		} else if (nextrow <= maxy) {
-			// else, just check if a new maximum has entered the window
-			const float h = ground->GetHeightAboveWater(curx, nextrowy);
+	float sum = 0.0f;
 
-			if (h > colsMaxima[x]) {
-				colsMaxima[x] = h;
-				maximaRows[x] = nextrow;
-			}
-		}
+	for (int j = 0; j <= std::min(r, n - 1); ++j) {
+		sum += in[j * stride];
+	}
 
-		assert(maximaRows[x] <= nextrow);
-		assert(maximaRows[x] >= y - intrad + 1);
+	for (int i = 0; i < n; ++i) {
+		const int start = std::max(i - r, 0);
+		const int end   = std::min(i + r, n - 1);
+		const float sh = sum / (end - start + 1);
 
-#ifdef _DEBUG
-		for (int y1 = std::max(0, y - intrad + 1); y1 <= std::min(maxy, y + intrad + 1); ++y1) {
-			assert(colsMaxima[x] >= ground->GetHeightReal(curx, y1 * resolution));
-		}
-#endif
+		out[i * stride] = std::min(maxHeight, std::max(gh[i * ghStride], sh));
+
+		if ((i + r + 1) < n)
+			sum += in[(i + r + 1) * stride];
+		if ((i - r) >= 0)
+			sum -= in[(i - r) * stride];
 	}
 }
 
 
 
-inline static void BlurHorizontal(
-	const int maxx,
-	const int maxy,
-	const int smoothrad,
-	const float resolution,
-	const std::vector<float>& mesh,
-	std::vector<float>& smoothed)
+void SmoothHeightMesh::MakeSmoothMesh(const CGround* ground)
 {
-	const float n = 2.0f * smoothrad + 1.0f;
-	const float recipn = 1.0f / n;
-	const int lineSize = maxx + 1;
-
-	for_mt(0, maxy+1, [&](const int y) {
-		float avg = 0.0f;
-
-		for (int x = 0; x <= 2 * smoothrad; ++x) {
-			avg += mesh[x + y * lineSize];
-		}
-
-		for (int x = 0; x <= maxx; ++x) {
-			const int idx = x + y * lineSize;
-
-			if (x <= smoothrad || x > (maxx - smoothrad)) {
-				// map-border case
-				smoothed[idx] = 0.0f;
-
-				const int xstart = std::max(x - smoothrad, 0);
-				const int xend   = std::min(x + smoothrad, maxx);
-
-				for (int x1 = xstart; x1 <= xend; ++x1) {
-					smoothed[idx] += mesh[x1 + y * lineSize];
-				}
+	ScopedOnceTimer timer("SmoothHeightMesh::MakeSmoothMesh");
 
-				const float gh = ground->GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = smoothed[idx] / (xend - xstart + 1);
+	// info:
+	//   height-value array has size <maxx + 1> * <maxy + 1>, but like
+	//   GetHeight and the Lua smooth-mesh functions only the <maxx> by
+	//   <maxy> corners at (x * resolution, y * resolution) with row-width
+	//   <maxx> are filled in; these cover the whole map
+	//
+	const size_t size = (this->maxx + 1) * (this->maxy + 1);
 
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			} else {
-				// non-border case
-				avg += mesh[idx + smoothrad] - mesh[idx - smoothrad - 1];
+	assert(mesh.empty());
+	mesh.resize(size, 0.0f);
+	origMesh.resize(size, 0.0f);
 
-				const float gh = ground->GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = recipn * avg;
+	RecalculateRegion(0, 0, maxx - 1, maxy - 1);
+}
 
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			}
 
-			assert(smoothed[idx] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(smoothed[idx] >=          readMap->GetCurrMinHeight()       );
-		}
-	});
+void SmoothHeightMesh::UpdateSmoothMesh(const SRectangle& rect)
+{
+	// every mesh corner within the max-filter and blur reach
+	// of the changed heightmap squares (inclusive coordinates)
+	const int intrad = smoothRadius / resolution;
+	const int reach = intrad + NUM_BLURS * BLUR_RADIUS + 1;
+
+	const int x1 = (rect.x1 * SQUARE_SIZE) / resolution;
+	const int z1 = (rect.z1 * SQUARE_SIZE) / resolution;
+	const int x2 = ((rect.x2 + 1) * SQUARE_SIZE) / resolution;
+	const int z2 = ((rect.z2 + 1) * SQUARE_SIZE) / resolution;
+
+	// CRectangleOptimizer works with exclusive end-coordinates
+	dirtyRects.push_back(SRectangle(
+		std::max(x1 - reach, 0), std::max(z1 - reach, 0),
+		std::min(x2 + reach, maxx - 1) + 1, std::min(z2 + reach, maxy - 1) + 1
+	));
 }
 
-inline static void BlurVertical(
-	const int maxx,
-	const int maxy,
-	const int smoothrad,
-	const float resolution,
-	const std::vector<float>& mesh,
-	std::vector<float>& smoothed)
+
+void SmoothHeightMesh::Update()
 {
-	const float n = 2.0f * smoothrad + 1.0f;
-	const float recipn = 1.0f / n;
-	const int lineSize = maxx + 1;
+	if (dirtyRects.empty())
+		return;
 
-	for_mt(0, maxx+1, [&](const int x) {
-		float avg = 0.0f;
+	SCOPED_TIMER("SmoothHeightMesh::Update");
 
-		for (int y = 0; y <= 2 * smoothrad; ++y) {
-			avg += mesh[x + y * lineSize];
-		}
+	dirtyRects.Optimize();
 
-		for (int y = 0; y <= maxy; ++y) {
-			const int idx = x + y * lineSize;
+	for (CRectangleOptimizer::iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it) {
+		RecalculateRegion(it->x1, it->z1, it->x2 - 1, it->z2 - 1);
+	}
 
-			if (y <= smoothrad || y > (maxy - smoothrad)) {
-				// map-border case
-				smoothed[idx] = 0.0f;
+	dirtyRects.clear();
+}
 
-				const int ystart = std::max(y - smoothrad, 0);
-				const int yend   = std::min(y + smoothrad, maxy);
 
-				for (int y1 = ystart; y1 <= yend; ++y1) {
-					smoothed[idx] += mesh[x + y1 * lineSize];
-				}
+void SmoothHeightMesh::RecalculateRegion(int ox1, int oz1, int ox2, int oz2)
+{
+	// the output corners [ox1, ox2] x [oz1, oz2] depend on the max-filtered
+	// heights of the blur region [bx1, bx2] x [bz1, bz2] (if it is clipped
+	// by the map edge the blur windows are too, as for a full rebuild) and
+	// those in turn on the ground heights of [hx1, hx2] x [hz1, hz2]
+	const int intrad = smoothRadius / resolution;
+	const int blurReach = NUM_BLURS * BLUR_RADIUS;
 
-				const float gh = ground->GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = smoothed[idx] / (yend - ystart + 1);
+	const int bx1 = std::max(ox1 - blurReach, 0), bx2 = std::min(ox2 + blurReach, maxx - 1);
+	const int bz1 = std::max(oz1 - blurReach, 0), bz2 = std::min(oz2 + blurReach, maxy - 1);
+	const int hx1 = std::max(bx1 - intrad, 0), hx2 = std::min(bx2 + intrad, maxx - 1);
+	const int hz1 = std::max(bz1 - intrad, 0), hz2 = std::min(bz2 + intrad, maxy - 1);
 
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			} else {
-				// non-border case
-				avg += mesh[x + (y + smoothrad) * lineSize] - mesh[x + (y - smoothrad - 1) * lineSize];
+	const int bw = bx2 - bx1 + 1, bh = bz2 - bz1 + 1;
+	const int hw = hx2 - hx1 + 1, hh = hz2 - hz1 + 1;
 
-				const float gh = ground->GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = recipn * avg;
+	const float maxHeight = readMap->GetCurrMaxHeight();
 
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			}
+	std::vector<float> heights(hw * hh);
+	std::vector<float> colsMaxima(hw * bh);
+	std::vector<float> blurred[2] = {std::vector<float>(bw * bh), std::vector<float>(bw * bh)};
 
-			assert(smoothed[idx] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(smoothed[idx] >=          readMap->GetCurrMinHeight()       );
+	for_mt(0, hh, [&](const int z) {
+		for (int x = 0; x < hw; ++x) {
+			heights[x + z * hw] = ground->GetHeightAboveWater((hx1 + x) * resolution, (hz1 + z) * resolution);
 		}
 	});
-}
 
+	// the square max-filter is separable: first the maximum over
+	// the window in every column, then over that along each row
+	for_mt(0, hw, [&](const int x) {
+		std::vector<int> dq(hh);
+		SlidingMax(&heights[x], hw, hh, intrad, bz1 - hz1, bz2 - hz1, &colsMaxima[x], hw, &dq[0]);
+	});
+	for_mt(0, bh, [&](const int z) {
+		std::vector<int> dq(hw);
+		SlidingMax(&colsMaxima[z * hw], 1, hw, intrad, bx1 - hx1, bx2 - hx1, &blurred[0][z * bw], 1, &dq[0]);
+	});
 
+	// ground heights of the blur region, for clamping
+	const float* gh = &heights[(bx1 - hx1) + (bz1 - hz1) * hw];
 
-inline static void CheckInvariants(
-	int y,
-	int maxx,
-	int maxy,
-	int intrad,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	const std::vector<int>& maximaRows)
-{
-	// check invariants
-	if (y < maxy) {
-		for (int x = 0; x <= maxx; ++x) {
-			assert(maximaRows[x] > y - intrad);
-			assert(maximaRows[x] <= maxy);
-			assert(colsMaxima[x] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(colsMaxima[x] >=          readMap->GetCurrMinHeight()       );
-		}
-	}
-	for (int y1 = std::max(0, y - intrad + 1); y1 <= std::min(maxy, y + intrad + 1); ++y1) {
-		for (int x1 = 0; x1 <= maxx; ++x1) {
-			assert(ground->GetHeightReal(x1 * resolution, y1 * resolution) <= colsMaxima[x1]);
-		}
+	// actually smooth with approximate Gaussian blur passes
+	for (int numBlurs = NUM_BLURS; numBlurs > 0; --numBlurs) {
+		for_mt(0, bh, [&](const int z) {
+			BoxBlur(&blurred[0][z * bw], 1, bw, BLUR_RADIUS, &gh[z * hw], 1, maxHeight, &blurred[1][z * bw]);
+		});
+		for_mt(0, bw, [&](const int x) {
+			BoxBlur(&blurred[1][x], bw, bh, BLUR_RADIUS, &gh[x], hw, maxHeight, &blurred[0][x]);
+		});
 	}
-}
 
+	// keep whatever Lua added on top of the previous smooth mesh
+	for (int z = oz1; z <= oz2; ++z) {
+		for (int x = ox1; x <= ox2; ++x) {
+			const int idx = x + z * maxx;
+			const float h = blurred[0][(x - bx1) + (z - bz1) * bw];
 
+			if (mesh[idx] == origMesh[idx]) {
+				mesh[idx] = h;
+			} else {
+				mesh[idx] += (h - origMesh[idx]);
+			}
 
-void SmoothHeightMesh::MakeSmoothMesh(const CGround* ground)
-{
-	ScopedOnceTimer timer("SmoothHeightMesh::MakeSmoothMesh");
-
-	// info:
-	//   height-value array has size <maxx + 1> * <maxy + 1>
-	//   and represents a grid of <maxx> cols by <maxy> rows
-	//   maximum legal index is ((maxx + 1) * (maxy + 1)) - 1
-	//
-	//   row-width (number of height-value corners per row) is (maxx + 1)
-	//   col-height (number of height-value corners per col) is (maxy + 1)
-	//
-	//   1st row has indices [maxx*(  0) + (  0), maxx*(1) + (  0)] inclusive
-	//   2nd row has indices [maxx*(  1) + (  1), maxx*(2) + (  1)] inclusive
-	//   3rd row has indices [maxx*(  2) + (  2), maxx*(3) + (  2)] inclusive
-	//   ...
-	//   Nth row has indices [maxx*(N-1) + (N-1), maxx*(N) + (N-1)] inclusive
-	//
-	const size_t size = (this->maxx + 1) * (this->maxy + 1);
-	// use sliding window of maximums to reduce computational complexity
-	const int intrad = smoothRadius / resolution;
-	const int smoothrad = 3;
-
-	assert(mesh.empty());
-	mesh.resize(size);
-
-	std::vector<float> colsMaxima(maxx + 1, -std::numeric_limits<float>::max());
-	std::vector<int> maximaRows(maxx + 1, -1);
-	std::vector<float> smoothed(size);
-
-	FindMaximumColumnHeights(maxx, maxy, intrad, resolution, colsMaxima, maximaRows);
-
-	for (int y = 0; y <= maxy; ++y) {
-		AdvanceMaximaRows(y, maxx, resolution, colsMaxima, maximaRows);
-		FindRadialMaximum(y, maxx, intrad, resolution, colsMaxima, mesh);
-		FixRemainingMaxima(y, maxx, maxy, intrad, resolution, colsMaxima, maximaRows);
-
-#ifdef _DEBUG
-		CheckInvariants(y, maxx, maxy, intrad, resolution, colsMaxima, maximaRows);
-#endif
-	}
+			origMesh[idx] = h;
 
-	// actually smooth with approximate Gaussian blur passes
-	for (int numBlurs = 3; numBlurs > 0; --numBlurs) {
-		BlurHorizontal(maxx, maxy, smoothrad, resolution, mesh, smoothed); mesh.swap(smoothed);
-		BlurVertical(maxx, maxy, smoothrad, resolution, mesh, smoothed); mesh.swap(smoothed);
+			assert(h <= std::max(maxHeight, 0.0f));
+		}
 	}
-
-	// `mesh` now contains the smoothed heightmap, save it in origMesh
-	origMesh.resize(size);
-	std::copy(mesh.begin(), mesh.end(), origMesh.begin());
 }
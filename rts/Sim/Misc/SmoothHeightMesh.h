@@ -5,10 +5,14 @@
 
 #include <vector>
 
+#include "System/Misc/RectangleOptimizer.h"
+
 class CGround;
 
 /**
  * Provides a GetHeight(x, y) of its own that smooths the mesh.
+ * Terrain changes are queued by UpdateSmoothMesh and only the
+ * affected part of the mesh is rebuilt by the next Update().
  */
 class SmoothHeightMesh
 {
@@ -22,6 +26,11 @@ public:
 	float AddHeight(int index, float h);
 	float SetMaxHeight(int index, float h);
 
+	/// queue a rebuild of the part of the mesh influenced by <rect> (heightmap squares, inclusive)
+	void UpdateSmoothMesh(const SRectangle& rect);
+	/// rebuild all queued parts
+	void Update();
+
 	int GetMaxX() const { return maxx; }
 	int GetMaxY() const { return maxy; }
 	float GetFMaxX() const { return fmaxx; }
@@ -33,6 +42,7 @@ public:
 
 private:
 	void MakeSmoothMesh(const CGround* ground);
+	void RecalculateRegion(int x1, int z1, int x2, int z2);
 
 	const int maxx, maxy;
 	const float fmaxx, fmaxy;
@@ -41,6 +51,8 @@ private:
 
 	std::vector<float> mesh;
 	std::vector<float> origMesh;
+
+	CRectangleOptimizer dirtyRects;
 };
 
 extern SmoothHeightMesh* smoothGround;
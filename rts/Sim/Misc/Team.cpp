@@ -18,7 +18,7 @@
 #include "Net/Protocol/NetProtocol.h"
 #include "System/MsgStrings.h"
 #include "System/Rectangle.h"
-#include "System/creg/STL_List.h"
+#include "System/creg/STL_Deque.h"
 #include "System/creg/STL_Map.h"
 #include "System/creg/STL_Set.h"
 
@@ -301,23 +301,22 @@ void CTeam::ResetResourceState()
 	prevEnergyReceived = energyReceived; energyReceived = 0.0f;
 }
 
-void CTeam::SlowUpdate()
+void CTeam::SlowUpdate(const std::vector<int>& allies)
 {
 	float eShare = 0.0f, mShare = 0.0f;
 
 	// calculate the total amount of resources that all
 	// (allied) teams can collectively receive through
 	// sharing
-	for (int a = 0; a < teamHandler->ActiveTeams(); ++a) {
-		CTeam* team = teamHandler->Team(a);
+	for (unsigned int n = 0; n < allies.size(); ++n) {
+		const int a = allies[n];
+		const CTeam* team = teamHandler->Team(a);
 
-		if ((a != teamNum) && (teamHandler->AllyTeam(teamNum) == teamHandler->AllyTeam(a))) {
-			if (team->isDead)
-				continue;
+		if (a == teamNum || team->isDead)
+			continue;
 
-			eShare += std::max(0.0f, (team->energyStorage * 0.99f) - team->energy);
-			mShare += std::max(0.0f, (team->metalStorage  * 0.99f) - team->metal);
-		}
+		eShare += std::max(0.0f, (team->energyStorage * 0.99f) - team->energy);
+		mShare += std::max(0.0f, (team->metalStorage  * 0.99f) - team->metal);
 	}
 
 
@@ -339,23 +338,23 @@ void CTeam::SlowUpdate()
 	if (mShare > 0.0f) { dm = std::min(1.0f, mExcess / mShare); }
 
 	// now evenly distribute our excess resources among allied teams
-	for (int a = 0; a < teamHandler->ActiveTeams(); ++a) {
-		if ((a != teamNum) && (teamHandler->AllyTeam(teamNum) == teamHandler->AllyTeam(a))) {
-			CTeam* team = teamHandler->Team(a);
-			if (team->isDead)
-				continue;
-
-			const float edif = std::max(0.0f, (team->energyStorage * 0.99f) - team->energy) * de;
-			const float mdif = std::max(0.0f, (team->metalStorage * 0.99f) - team->metal) * dm;
-
-			energy     -= edif; team->energy         += edif;
-			energySent += edif; team->energyReceived += edif;
-			metal      -= mdif; team->metal          += mdif;
-			metalSent  += mdif; team->metalReceived  += mdif;
-
-			currentStats->energySent += edif; team->currentStats->energyReceived += edif;
-			currentStats->metalSent  += mdif; team->currentStats->metalReceived  += mdif;
-		}
+	for (unsigned int n = 0; n < allies.size(); ++n) {
+		const int a = allies[n];
+		CTeam* team = teamHandler->Team(a);
+
+		if (a == teamNum || team->isDead)
+			continue;
+
+		const float edif = std::max(0.0f, (team->energyStorage * 0.99f) - team->energy) * de;
+		const float mdif = std::max(0.0f, (team->metalStorage * 0.99f) - team->metal) * dm;
+
+		energy     -= edif; team->energy         += edif;
+		energySent += edif; team->energyReceived += edif;
+		metal      -= mdif; team->metal          += mdif;
+		metalSent  += mdif; team->metalReceived  += mdif;
+
+		currentStats->energySent += edif; team->currentStats->energyReceived += edif;
+		currentStats->metalSent  += mdif; team->currentStats->metalReceived  += mdif;
 	}
 
 	// clamp resource levels to storage capacity
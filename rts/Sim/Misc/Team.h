@@ -6,7 +6,7 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <list>
+#include <deque>
 #include <boost/utility.hpp> //! boost::noncopyable
 
 #include "TeamBase.h"
@@ -24,7 +24,8 @@ public:
 	CTeam(int _teamNum);
 
 	void ResetResourceState();
-	void SlowUpdate();
+	/// @param allies indices of all teams in our allyteam (including us), ascending
+	void SlowUpdate(const std::vector<int>& allies);
 
 	void AddMetal(float amount, bool useIncomeMultiplier = true);
 	void AddEnergy(float amount, bool useIncomeMultiplier = true);
@@ -103,8 +104,9 @@ public:
 	float prevEnergyExcess;
 
 	int nextHistoryEntry;
+	/// always the last element of statHistory (a deque keeps it valid across push_back)
 	TeamStatistics* currentStats;
-	std::list<TeamStatistics> statHistory;
+	std::deque<TeamStatistics> statHistory;
 	typedef TeamStatistics Statistics; //! for easier access via CTeam::Statistics
 
 	/// mod controlled parameters
@@ -16,7 +16,8 @@ CR_REG_METADATA(CTeamHandler, (
 	CR_MEMBER(gaiaTeamID),
 	CR_MEMBER(gaiaAllyTeamID),
 	CR_MEMBER(teams),
-	CR_MEMBER(allyTeams)
+	CR_MEMBER(allyTeams),
+	CR_IGNORED(allyTeamMembers)
 ));
 
 
@@ -98,8 +99,20 @@ void CTeamHandler::GameFrame(int frameNum)
 		for (int a = 0; a < ActiveTeams(); ++a) {
 			teams[a]->ResetResourceState();
 		}
+		// resources are only ever shared within an allyteam, so each team
+		// just needs to see its own allies (in the usual ascending order);
+		// the transfers between allies are order-dependent and write synced
+		// state (which feeds the sync checksum), so this stays sequential
+		allyTeamMembers.resize(ActiveAllyTeams());
+
+		for (int a = 0; a < ActiveAllyTeams(); ++a) {
+			allyTeamMembers[a].clear();
+		}
+		for (int a = 0; a < ActiveTeams(); ++a) {
+			allyTeamMembers[AllyTeam(a)].push_back(a);
+		}
 		for (int a = 0; a < ActiveTeams(); ++a) {
-			teams[a]->SlowUpdate();
+			teams[a]->SlowUpdate(allyTeamMembers[AllyTeam(a)]);
 		}
 	}
 }
@@ -148,6 +148,9 @@ private:
 	 */
 	std::vector<CTeam *> teams;
 	std::vector< ::AllyTeam > allyTeams;
+
+	/// teams per allyteam, rebuilt on every team SlowUpdate
+	std::vector< std::vector<int> > allyTeamMembers;
 };
 
 extern CTeamHandler* teamHandler;
@@ -0,0 +1,127 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ThreatMap.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitHandler.h"
+#include "Sim/Weapons/Weapon.h"
+#include "Sim/Weapons/WeaponDef.h"
+#include "System/myMath.h"
+
+CR_BIND(CThreatMap, )
+CR_REG_METADATA(CThreatMap, (
+	CR_MEMBER(xsize),
+	CR_MEMBER(zsize),
+	CR_MEMBER(numAllyTeams),
+	CR_MEMBER(layers),
+	CR_MEMBER(unitEntries)
+))
+
+CR_BIND(CThreatMap::UnitEntry, )
+CR_REG_METADATA_SUB(CThreatMap, UnitEntry, (
+	CR_MEMBER(cell),
+	CR_MEMBER(dps),
+	CR_MEMBER(value)
+))
+
+
+CThreatMap* threatMap = NULL;
+
+
+CThreatMap::CThreatMap()
+	: xsize(std::max(1, (gs->mapx * SQUARE_SIZE + CELL_SIZE - 1) / CELL_SIZE))
+	, zsize(std::max(1, (gs->mapy * SQUARE_SIZE + CELL_SIZE - 1) / CELL_SIZE))
+	, numAllyTeams(teamHandler->ActiveAllyTeams())
+{
+	layers.resize(numAllyTeams * NUM_LAYERS * xsize * zsize, 0.0f);
+	unitEntries.resize(unitHandler->MaxUnits() * numAllyTeams);
+}
+
+
+int CThreatMap::GetCell(const float3& pos) const
+{
+	const int cx = Clamp(int(pos.x / CELL_SIZE), 0, xsize - 1);
+	const int cz = Clamp(int(pos.z / CELL_SIZE), 0, zsize - 1);
+	return (cz * xsize + cx);
+}
+
+
+float CThreatMap::GetUnitDPS(const CUnit* unit)
+{
+	float dps = 0.0f;
+
+	for (std::vector<CWeapon*>::const_iterator wi = unit->weapons.begin(); wi != unit->weapons.end(); ++wi) {
+		const CWeapon* w = *wi;
+		const float damage = w->weaponDef->damages.GetDefaultDamage() * w->salvoSize * w->projectilesPerShot;
+
+		dps += ((damage * GAME_SPEED) / std::max(1, w->reloadTime));
+	}
+
+	return dps;
+}
+
+
+void CThreatMap::AddEntry(int allyTeam, const UnitEntry& entry)
+{
+	GetLayerMutable(allyTeam, LAYER_COUNT)[entry.cell] += 1.0f;
+	GetLayerMutable(allyTeam, LAYER_DPS  )[entry.cell] += entry.dps;
+	GetLayerMutable(allyTeam, LAYER_VALUE)[entry.cell] += entry.value;
+}
+
+void CThreatMap::RemoveEntry(int allyTeam, const UnitEntry& entry)
+{
+	float& count = GetLayerMutable(allyTeam, LAYER_COUNT)[entry.cell];
+	float& dps   = GetLayerMutable(allyTeam, LAYER_DPS  )[entry.cell];
+	float& value = GetLayerMutable(allyTeam, LAYER_VALUE)[entry.cell];
+
+	if ((count -= 1.0f) <= 0.0f) {
+		// reset, so rounding errors can not accumulate in empty cells
+		count = 0.0f;
+		dps   = 0.0f;
+		value = 0.0f;
+	} else {
+		dps   -= entry.dps;
+		value -= entry.value;
+	}
+}
+
+
+void CThreatMap::UpdateUnit(const CUnit* unit)
+{
+	for (int allyTeam = 0; allyTeam < numAllyTeams; allyTeam++) {
+		UnitEntry& entry = unitEntries[unit->id * numAllyTeams + allyTeam];
+
+		const bool visible = (!teamHandler->Ally(allyTeam, unit->allyteam) && (unit->losStatus[allyTeam] & LOS_INLOS) != 0);
+		const int cell = (visible? GetCell(unit->pos): -1);
+
+		if (cell == entry.cell)
+			continue;
+
+		if (entry.cell >= 0) {
+			RemoveEntry(allyTeam, entry);
+		}
+
+		entry.cell = cell;
+
+		if (entry.cell >= 0) {
+			entry.dps = GetUnitDPS(unit);
+			entry.value = unit->metalCost;
+
+			AddEntry(allyTeam, entry);
+		}
+	}
+}
+
+void CThreatMap::RemoveUnit(const CUnit* unit)
+{
+	for (int allyTeam = 0; allyTeam < numAllyTeams; allyTeam++) {
+		UnitEntry& entry = unitEntries[unit->id * numAllyTeams + allyTeam];
+
+		if (entry.cell >= 0) {
+			RemoveEntry(allyTeam, entry);
+		}
+
+		entry = UnitEntry();
+	}
+}
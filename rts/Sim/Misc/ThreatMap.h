@@ -0,0 +1,89 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef THREAT_MAP_H
+#define THREAT_MAP_H
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/creg/creg_cond.h"
+
+class CUnit;
+class float3;
+
+/**
+ * Coarse per-allyteam influence grids of the enemy units each allyteam
+ * currently has in LOS: their number, their summed weapon DPS and their
+ * summed metal cost per cell.
+ *
+ * A unit's contribution is only touched when it enters or leaves LOS of
+ * an allyteam or moves into another cell, so reading the grids is free
+ * and they can be handed out as read-only arrays (to AIs and Lua) instead
+ * of every client rebuilding them by querying units one at a time.
+ */
+class CThreatMap : public boost::noncopyable
+{
+	CR_DECLARE_STRUCT(CThreatMap);
+	CR_DECLARE_SUB(UnitEntry);
+
+public:
+	enum {
+		LAYER_COUNT = 0, ///< number of visible enemy units
+		LAYER_DPS   = 1, ///< their summed weapon damage per second
+		LAYER_VALUE = 2, ///< their summed metal cost
+		NUM_LAYERS  = 3,
+	};
+
+	/// side length of a grid cell in elmos
+	static const int CELL_SIZE = SQUARE_SIZE * 32;
+
+	CThreatMap();
+
+	/// re-evaluates the unit's contribution for every allyteam
+	void UpdateUnit(const CUnit* unit);
+	void RemoveUnit(const CUnit* unit);
+
+	int GetSizeX() const { return xsize; }
+	int GetSizeZ() const { return zsize; }
+	int GetCell(const float3& pos) const;
+
+	/// row-major grid of GetSizeX() * GetSizeZ() values
+	const float* GetLayer(int allyTeam, int layer) const {
+		return &layers[((allyTeam * NUM_LAYERS) + layer) * (xsize * zsize)];
+	}
+
+private:
+	struct UnitEntry {
+		CR_DECLARE_STRUCT(UnitEntry);
+
+		UnitEntry(): cell(-1), dps(0.0f), value(0.0f) {}
+
+		int cell;
+		float dps;
+		float value;
+	};
+
+	void AddEntry(int allyTeam, const UnitEntry& entry);
+	void RemoveEntry(int allyTeam, const UnitEntry& entry);
+
+	float* GetLayerMutable(int allyTeam, int layer) {
+		return &layers[((allyTeam * NUM_LAYERS) + layer) * (xsize * zsize)];
+	}
+
+	static float GetUnitDPS(const CUnit* unit);
+
+private:
+	int xsize;
+	int zsize;
+	int numAllyTeams;
+
+	/// [allyTeam][layer][cell]
+	std::vector<float> layers;
+	/// [unitID * numAllyTeams + allyTeam]
+	std::vector<UnitEntry> unitEntries;
+};
+
+extern CThreatMap* threatMap;
+
+#endif // THREAT_MAP_H
@@ -4,9 +4,10 @@
 #include "Wind.h"
 #include "GlobalSynced.h"
 #include "Sim/Units/Unit.h"
-#include "System/creg/STL_Map.h"
 #include "System/myMath.h"
 
+#include <algorithm>
+
 CR_BIND(CWind, );
 
 CR_REG_METADATA(CWind, (
@@ -22,11 +23,13 @@ CR_REG_METADATA(CWind, (
 	CR_MEMBER(status),
 
 	CR_MEMBER(windGens),
+	CR_MEMBER(windGenUpdateIdx),
 	CR_RESERVED(12)
 ));
 
 
 static const int UpdateRate = 15 * GAME_SPEED; //! update all 15sec
+static const int WINDGEN_UPDATE_FRAMES = GAME_SPEED;
 
 CWind wind;
 
@@ -41,7 +44,9 @@ CWind::CWind():
 	newWind(ZeroVector),
 	oldWind(ZeroVector),
 
-	status(0)
+	status(0),
+
+	windGenUpdateIdx(0)
 {
 }
 
@@ -52,26 +57,36 @@ CWind::~CWind()
 
 
 
+static bool UnitIDLess(const CUnit* a, const CUnit* b) { return (a->id < b->id); }
+
 bool CWind::AddUnit(CUnit* u) {
-	std::map<int, CUnit*>::iterator it = windGens.find(u->id);
+	std::vector<CUnit*>::iterator it = std::lower_bound(windGens.begin(), windGens.end(), u, UnitIDLess);
 
-	if (it != windGens.end()) {
+	if (it != windGens.end() && (*it)->id == u->id) {
 		return false;
 	}
 
-	windGens[u->id] = u;
+	// keep the pending notifications pointed at the same unit
+	// (u itself is skipped, it starts out with the current wind)
+	if ((it - windGens.begin()) <= int(windGenUpdateIdx))
+		windGenUpdateIdx++;
+
+	windGens.insert(it, u);
 	// start pointing in direction of wind
 	u->UpdateWind(curDir.x, curDir.z, curStrength);
 	return true;
 }
 
 bool CWind::DelUnit(CUnit* u) {
-	std::map<int, CUnit*>::iterator it = windGens.find(u->id);
+	std::vector<CUnit*>::iterator it = std::lower_bound(windGens.begin(), windGens.end(), u, UnitIDLess);
 
-	if (it == windGens.end()) {
+	if (it == windGens.end() || (*it)->id != u->id) {
 		return false;
 	}
 
+	if ((it - windGens.begin()) < int(windGenUpdateIdx))
+		windGenUpdateIdx--;
+
 	windGens.erase(it);
 	return true;
 }
@@ -129,10 +144,19 @@ void CWind::Update()
 	}
 	
 	if (status == UpdateRate / 3) {
-		//! update units
+		//! start updating units
+		windGenUpdateIdx = 0;
+	}
+
+	if (windGenUpdateIdx < windGens.size()) {
+		// every generator runs script callbacks, so rather
+		// than doing all of them at once spread them out
 		const float newStrength = newWind.Length();
-		for (std::map<int, CUnit*>::iterator it = windGens.begin(); it != windGens.end(); ++it) {
-			(it->second)->UpdateWind(newWind.x, newWind.z, newStrength);
+		const unsigned int numUpdates = (windGens.size() + WINDGEN_UPDATE_FRAMES - 1) / WINDGEN_UPDATE_FRAMES;
+		const unsigned int endIdx = std::min(windGenUpdateIdx + numUpdates, (unsigned int) windGens.size());
+
+		for (; windGenUpdateIdx < endIdx; windGenUpdateIdx++) {
+			windGens[windGenUpdateIdx]->UpdateWind(newWind.x, newWind.z, newStrength);
 		}
 	}
 }
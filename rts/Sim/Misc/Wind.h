@@ -3,7 +3,7 @@
 #ifndef WIND_H
 #define WIND_H
 
-#include <map>
+#include <vector>
 #include <boost/noncopyable.hpp>
 
 #include "System/float3.h"
@@ -43,7 +43,12 @@ private:
 
 	int status;
 
-	std::map<int, CUnit*> windGens;
+	// sorted by unit ID
+	std::vector<CUnit*> windGens;
+	// next generator to be notified of a wind change (equals
+	// windGens.size() if none are pending), the notifications
+	// are spread out over WINDGEN_UPDATE_FRAMES
+	unsigned int windGenUpdateIdx;
 };
 
 extern CWind wind;
@@ -239,7 +239,14 @@ void AAirMoveType::CheckForCollision()
 	const SyncedFloat3& forward = owner->frontdir;
 
 	const float3 midTestPos = pos + forward * 121.0f;
-	const std::vector<CUnit*>& others = quadField->GetUnitsExact(midTestPos, 115.0f);
+
+	// every aircraft runs this each fourth frame; reuse the capacity of a
+	// shared buffer rather than allocating a new vector for each query
+	static std::vector<CUnit*> othersBuffer;
+	std::vector<CUnit*> others;
+
+	others.swap(othersBuffer);
+	quadField->GetUnitsExact(others, midTestPos, 115.0f);
 
 	float dist = 200.0f;
 
@@ -278,6 +285,7 @@ void AAirMoveType::CheckForCollision()
 	if (lastColWarning != NULL) {
 		lastColWarningType = 2;
 		AddDeathDependence(lastColWarning, DEPENDENCE_LASTCOLWARN);
+		others.swap(othersBuffer);
 		return;
 	}
 
@@ -293,6 +301,8 @@ void AAirMoveType::CheckForCollision()
 		lastColWarningType = 1;
 		AddDeathDependence(lastColWarning, DEPENDENCE_LASTCOLWARN);
 	}
+
+	others.swap(othersBuffer);
 }
 
 
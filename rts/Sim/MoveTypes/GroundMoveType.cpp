@@ -119,6 +119,10 @@ CR_REG_METADATA(CGroundMoveType, (
 	CR_MEMBER(skidRotSpeed),
 	CR_MEMBER(skidRotAccel),
 
+	CR_IGNORED(avoideeQuads),
+	CR_IGNORED(avoidees),
+	CR_IGNORED(avoideeFrame),
+
 	CR_POSTLOAD(PostLoad)
 ));
 
@@ -168,7 +172,9 @@ CGroundMoveType::CGroundMoveType(CUnit* owner):
 	numIdlingUpdates(0),
 	numIdlingSlowUpdates(0),
 
-	wantedHeading(0)
+	wantedHeading(0),
+
+	avoideeFrame(-1)
 {
 	if (owner == NULL)
 		return;
@@ -294,6 +300,25 @@ bool CGroundMoveType::Update()
 	return (OwnerMoved(heading, owner->pos - oldPos, float3(float3::CMP_EPS, float3::CMP_EPS * 1e-2f, float3::CMP_EPS)));
 }
 
+void CGroundMoveType::PreUpdateMT()
+{
+	// mirror the conditions under which Update reaches GetObstacleAvoidanceDir
+	// (FollowPath might still skip it, in which case the query goes unused)
+	if (owner->GetTransporter() != NULL)
+		return;
+	if (owner->IsSkidding() || owner->IsFalling())
+		return;
+	if (owner->IsStunned() || owner->beingBuilt || owner->fpsControlPlayer != NULL)
+		return;
+	if (pathId == 0 || gs->frameNum < nextObstacleAvoidanceFrame)
+		return;
+
+	// all units still have their start-of-frame positions here; the serial
+	// Update pass only consumes this list, so that results stay synced
+	quadField->GetSolidsExactMT(avoideeQuads, avoidees, owner->pos, GetObstacleAvoidanceRadius(), 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+	avoideeFrame = gs->frameNum;
+}
+
 void CGroundMoveType::UpdateOwnerSpeedAndHeading()
 {
 	if (owner->IsStunned() || owner->beingBuilt) {
@@ -1017,10 +1042,12 @@ float3 CGroundMoveType::GetObstacleAvoidanceDir(const float3& desiredDir) {
 
 	// now we do the obstacle avoidance proper
 	// avoider always uses its never-rotated MoveDef footprint
-	const float avoidanceRadius = std::max(currentSpeed, 1.0f) * (avoider->radius * 2.0f);
 	const float avoiderRadius = FOOTPRINT_RADIUS(avoiderMD->xsize, avoiderMD->zsize, 1.0f);
 
-	const vector<CSolidObject*>& objects = quadField->GetSolidsExact(avoider->pos, avoidanceRadius, 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+	if (avoideeFrame != gs->frameNum)
+		quadField->GetSolidsExact(avoidees, avoider->pos, GetObstacleAvoidanceRadius(), 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+
+	const vector<CSolidObject*>& objects = avoidees;
 
 	for (vector<CSolidObject*>::const_iterator oi = objects.begin(); oi != objects.end(); ++oi) {
 		const CSolidObject* avoidee = *oi;
@@ -1142,6 +1169,10 @@ float3 CGroundMoveType::GetObstacleAvoidanceDir(const float3& desiredDir) {
 
 
 
+float CGroundMoveType::GetObstacleAvoidanceRadius() const {
+	return (std::max(currentSpeed, 1.0f) * (owner->radius * 2.0f));
+}
+
 // Calculates an aproximation of the physical 2D-distance between given two objects.
 float CGroundMoveType::Distance2D(CSolidObject* object1, CSolidObject* object2, float marginal)
 {
@@ -1694,8 +1725,16 @@ void CGroundMoveType::HandleUnitCollisions(
 ) {
 	const float searchRadius = std::max(colliderSpeed, 1.0f) * (colliderRadius * 1.0f);
 
-	const std::vector<CUnit*>& nearUnits = quadField->GetUnitsExact(collider->pos, searchRadius);
-	      std::vector<CUnit*>::const_iterator uit;
+	// this runs for every moving ground unit each frame; borrow the capacity of
+	// a buffer shared by all of them instead of allocating the query result anew
+	// (a nested call, eg. via Lua from the collision events, just gets an empty
+	// one and allocates)
+	static std::vector<CUnit*> nearUnitsBuffer;
+	std::vector<CUnit*> nearUnits;
+	std::vector<CUnit*>::const_iterator uit;
+
+	nearUnits.swap(nearUnitsBuffer);
+	quadField->GetUnitsExact(nearUnits, collider->pos, searchRadius);
 
 	// NOTE: probably too large for most units (eg. causes tree falling animations to be skipped)
 	const int dirSign = Sign(int(!reversing));
@@ -1874,6 +1913,8 @@ void CGroundMoveType::HandleUnitCollisions(
 			}
 		}
 	}
+
+	nearUnits.swap(nearUnitsBuffer);
 }
 
 void CGroundMoveType::HandleFeatureCollisions(
@@ -1886,8 +1927,13 @@ void CGroundMoveType::HandleFeatureCollisions(
 ) {
 	const float searchRadius = std::max(colliderSpeed, 1.0f) * (colliderRadius * 1.0f);
 
-	const std::vector<CFeature*>& nearFeatures = quadField->GetFeaturesExact(collider->pos, searchRadius);
-	      std::vector<CFeature*>::const_iterator fit;
+	// see HandleUnitCollisions
+	static std::vector<CFeature*> nearFeaturesBuffer;
+	std::vector<CFeature*> nearFeatures;
+	std::vector<CFeature*>::const_iterator fit;
+
+	nearFeatures.swap(nearFeaturesBuffer);
+	quadField->GetFeaturesExact(nearFeatures, collider->pos, searchRadius);
 
 	const int dirSign = Sign(int(!reversing));
 	const float3 crushImpulse = collider->speed * collider->mass * dirSign;
@@ -1962,6 +2008,8 @@ void CGroundMoveType::HandleFeatureCollisions(
 		collidee->Move(-colResponseVec * collideeMassScale, true);
 		quadField->AddFeature(collidee);
 	}
+
+	nearFeatures.swap(nearFeaturesBuffer);
 }
 
 
@@ -6,6 +6,8 @@
 #include "MoveType.h"
 #include "System/Sync/SyncedFloat3.h"
 
+#include <vector>
+
 struct UnitDef;
 struct MoveDef;
 class CSolidObject;
@@ -23,6 +25,7 @@ public:
 
 	bool Update();
 	void SlowUpdate();
+	void PreUpdateMT();
 
 	void StartMoving(float3 pos, float goalRadius);
 	void StartMoving(float3 pos, float goalRadius, float speed) { StartMoving(pos, goalRadius); }
@@ -40,6 +43,7 @@ public:
 
 private:
 	float3 GetObstacleAvoidanceDir(const float3& desiredDir);
+	float GetObstacleAvoidanceRadius() const;
 	float3 GetNewSpeedVector(const float hAcc, const float vAcc) const;
 
 	#define SQUARE(x) ((x) * (x))
@@ -161,6 +165,12 @@ private:
 	unsigned int numIdlingSlowUpdates;
 
 	short wantedHeading;
+
+	/// obstacle-avoidance query results, gathered by PreUpdateMT if <avoideeFrame> is current
+	std::vector<int> avoideeQuads;
+	std::vector<CSolidObject*> avoidees;
+
+	int avoideeFrame;
 };
 
 #endif // GROUNDMOVETYPE_H
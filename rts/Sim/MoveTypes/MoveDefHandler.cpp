@@ -133,11 +133,15 @@ MoveDefHandler::MoveDefHandler(LuaParser* defsParser)
 	crc << CMoveMath::noHoverWaterMove;
 
 	checksum = crc.GetDigest();
+
+	CMoveMath::InitSpeedModTables();
 }
 
 
 MoveDefHandler::~MoveDefHandler()
 {
+	CMoveMath::FreeSpeedModTables();
+
 	while (!moveDefs.empty()) {
 		delete moveDefs.back();
 		moveDefs.pop_back();
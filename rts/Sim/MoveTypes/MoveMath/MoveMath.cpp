@@ -13,6 +13,43 @@
 bool CMoveMath::noHoverWaterMove = false;
 float CMoveMath::waterDamageCost = 0.0f;
 
+std::vector< std::vector<float> > CMoveMath::speedModTables;
+
+
+
+void CMoveMath::InitSpeedModTables()
+{
+	speedModTables.clear();
+	speedModTables.resize(moveDefHandler->GetNumMoveDefs(), std::vector<float>(gs->hmapx * gs->hmapy, 0.0f));
+
+	UpdateSpeedModTables(0, 0, gs->hmapx - 1, gs->hmapy - 1);
+}
+
+void CMoveMath::FreeSpeedModTables()
+{
+	speedModTables.clear();
+}
+
+void CMoveMath::UpdateSpeedModTables(int hx1, int hz1, int hx2, int hz2)
+{
+	if (speedModTables.empty())
+		return;
+
+	hx1 = std::max(hx1, 0); hx2 = std::min(hx2, gs->hmapx - 1);
+	hz1 = std::max(hz1, 0); hz2 = std::min(hz2, gs->hmapy - 1);
+
+	for (unsigned int pathType = 0; pathType < speedModTables.size(); pathType++) {
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(pathType);
+		std::vector<float>& table = speedModTables[pathType];
+
+		for (int hz = hz1; hz <= hz2; hz++) {
+			for (int hx = hx1; hx <= hx2; hx++) {
+				table[hx + hz * gs->hmapx] = CalcPosSpeedMod(*md, hx + hz * gs->hmapx);
+			}
+		}
+	}
+}
+
 
 
 float CMoveMath::yLevel(const MoveDef& moveDef, int xSqr, int zSqr)
@@ -48,6 +85,15 @@ float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, int xSquare, int zSquare
 		return 0.0f;
 
 	const int square = (xSquare >> 1) + ((zSquare >> 1) * gs->hmapx);
+
+	if (moveDef.pathType < speedModTables.size())
+		return speedModTables[moveDef.pathType][square];
+
+	return (CalcPosSpeedMod(moveDef, square));
+}
+
+float CMoveMath::CalcPosSpeedMod(const MoveDef& moveDef, int square)
+{
 	const int squareTerrType = readMap->GetTypeMapSynced()[square];
 
 	const float height  = readMap->GetMIPHeightMapSynced(1)[square];
@@ -260,7 +306,13 @@ CMoveMath::BlockType CMoveMath::SquareIsBlocked(const MoveDef& moveDef, int xSqu
 
 	BlockType r = BLOCK_NONE;
 
-	const BlockingMapCell& c = groundBlockingObjectMap->GetCell(xSquare + zSquare * gs->mapx);
+	const int mapSquare = xSquare + zSquare * gs->mapx;
+
+	// common case: nothing on this square, skip the cell's object-map
+	if (groundBlockingObjectMap->GetCellOccupancy(mapSquare) == 0)
+		return r;
+
+	const BlockingMapCell& c = groundBlockingObjectMap->GetCell(mapSquare);
 
 	for (BlockingMapCellIt it = c.begin(); it != c.end(); ++it) {
 		const CSolidObject* collidee = it->second;
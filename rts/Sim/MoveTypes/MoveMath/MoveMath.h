@@ -3,6 +3,8 @@
 #ifndef MOVEMATH_H
 #define MOVEMATH_H
 
+#include <vector>
+
 #include "Map/ReadMap.h"
 #include "System/float3.h"
 #include "System/Misc/BitwiseEnum.h"
@@ -37,6 +39,17 @@ public:
 	typedef Bitwise::BitwiseEnum<BlockTypes> BlockType;
 
 
+	/**
+	 * The non-directional speed-modifier only depends on the (immutable)
+	 * MoveDef and the half-resolution height, slope and type-map, so it is
+	 * kept in one table per MoveDef. UpdateSpeedModTables must be called
+	 * whenever any of those maps change within [hx1, hx2] x [hz1, hz2]
+	 * (inclusive, in half-heightmap squares).
+	 */
+	static void InitSpeedModTables();
+	static void FreeSpeedModTables();
+	static void UpdateSpeedModTables(int hx1, int hz1, int hx2, int hz2);
+
 	// returns a speed-multiplier for given position or data
 	static float GetPosSpeedMod(const MoveDef& moveDef, int xSquare, int zSquare);
 	static float GetPosSpeedMod(const MoveDef& moveDef, int xSquare, int zSquare, const float3& moveDir);
@@ -70,9 +83,16 @@ public:
 		return (SquareIsBlocked(moveDef, pos.x / SQUARE_SIZE, pos.z / SQUARE_SIZE, collider));
 	}
 
+private:
+	static float CalcPosSpeedMod(const MoveDef& moveDef, int hmSquare);
+
 public:
 	static bool noHoverWaterMove;
 	static float waterDamageCost;
+
+private:
+	/// [pathType][hmSquare], see InitSpeedModTables
+	static std::vector< std::vector<float> > speedModTables;
 };
 
 
@@ -42,6 +42,11 @@ public:
 	virtual bool Update() = 0;
 	virtual void SlowUpdate();
 
+	// called concurrently for all active units before any Update when the
+	// useParallelMoveTypeUpdates modrule is enabled; may only read shared
+	// state and write to the movetype's own scratch buffers
+	virtual void PreUpdateMT() {}
+
 	virtual bool IsSkidding() const { return false; }
 	virtual bool IsFlying() const { return false; }
 	virtual bool IsReversing() const { return false; }
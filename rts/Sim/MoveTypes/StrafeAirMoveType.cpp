@@ -559,7 +559,13 @@ bool CStrafeAirMoveType::HandleCollisions(bool checkCollisions) {
 
 		// check for collisions if not on a pad, not being built, or not taking off
 		if (checkCollisions) {
-			const vector<CUnit*>& nearUnits = quadField->GetUnitsExact(pos, owner->radius + 6);
+			// see AAirMoveType::CheckForCollision (a nested call, eg. from
+			// a Lua damage call-in, just gets an empty buffer and allocates)
+			static vector<CUnit*> nearUnitsBuffer;
+			vector<CUnit*> nearUnits;
+
+			nearUnits.swap(nearUnitsBuffer);
+			quadField->GetUnitsExact(nearUnits, pos, owner->radius + 6);
 
 			for (vector<CUnit*>::const_iterator ui = nearUnits.begin(); ui != nearUnits.end(); ++ui) {
 				CUnit* unit = *ui;
@@ -597,6 +603,7 @@ bool CStrafeAirMoveType::HandleCollisions(bool checkCollisions) {
 				}
 			}
 
+			nearUnits.swap(nearUnitsBuffer);
 			owner->SetSpeed(owner->speed);
 		}
 
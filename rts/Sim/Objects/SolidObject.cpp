@@ -64,6 +64,7 @@ CR_REG_METADATA(CSolidObject,
 
 	CR_MEMBER(drawPos),
 	CR_MEMBER(drawMidPos),
+	CR_MEMBER(preFramePos),
 	// CR_MEMBER(blockMap), //FIXME add bitwiseenum to creg
 
 	CR_MEMBER(buildFacing)
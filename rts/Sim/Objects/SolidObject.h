@@ -273,6 +273,7 @@ public:
 
 	float3 drawPos;                             ///< = pos + speed * timeOffset (unsynced)
 	float3 drawMidPos;                          ///< = drawPos + relMidPos (unsynced)
+	float3 preFramePos;                         ///< pos before the last MoveType update, see CUnitDrawer::UpdateUnitDrawPos
 
 	const YardMapStatus* blockMap;              ///< Current (unrotated!) blockmap/yardmap of this object. 0 means no active yardmap => all blocked.
 	short int buildFacing;                      ///< Orientation of footprint, 4 different states
@@ -2,15 +2,18 @@
 
 #include <cstring>
 #include "PathAllocator.h"
+#include "System/MemPool.h"
+
+static CMemPool pathMemPool("paths");
 
 void* PathAllocator::Alloc(unsigned int n)
 {
-	char* ret = new char[n];
+	void* ret = pathMemPool.Alloc(n);
 	memset(ret, 0, n);
 	return ret;
 }
 
-void PathAllocator::Free(void* p, unsigned int)
+void PathAllocator::Free(void* p, unsigned int n)
 {
-	delete[] ((char*) p);
+	pathMemPool.Free(p, n);
 }
@@ -4,14 +4,17 @@
 
 #include "PathCache.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Path/IPathManager.h"
 #include "System/Log/ILog.h"
 
-#define MAX_CACHE_QUEUE_SIZE   200
 #define MAX_PATH_LIFETIME_SECS   7
 #define USE_NONCOLLIDABLE_HASH   1
 
-CPathCache::CPathCache(int blocksX, int blocksZ)
-	: numBlocksX(blocksX)
+CPathCache::CPathCache(int blocksX, int blocksZ, unsigned int budget)
+	: lruHead(NULL)
+	, lruTail(NULL)
+
+	, numBlocksX(blocksX)
 	, numBlocksZ(blocksZ)
 	, numBlocks(numBlocksX * numBlocksZ)
 
@@ -19,12 +22,17 @@ CPathCache::CPathCache(int blocksX, int blocksZ)
 	, numCacheHits(0)
 	, numCacheMisses(0)
 	, numHashCollisions(0)
+	, numEvictions(0)
+	, numExpirations(0)
+
+	, memUsage(0)
+	, memBudget(budget)
 {}
 
 CPathCache::~CPathCache()
 {
-	LOG("[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu",
-		__FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
+	LOG("[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u numEvictions=%u maxCacheSize=%lu",
+		__FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, numEvictions, maxCacheSize);
 
 	for (CachedPathConstIter iter = cachedPaths.begin(); iter != cachedPaths.end(); ++iter)
 		delete (iter->second);
@@ -38,9 +46,6 @@ bool CPathCache::AddPath(
 	float goalRadius,
 	int pathType
 ) {
-	if (cacheQue.size() > MAX_CACHE_QUEUE_SIZE)
-		RemoveFrontQueItem();
-
 	const boost::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 	const boost::uint32_t cols = numHashCollisions;
 	const CachedPathConstIter iter = cachedPaths.find(hash);
@@ -57,15 +62,28 @@ bool CPathCache::AddPath(
 	ci->goalBlock  = goalBlock;
 	ci->goalRadius = goalRadius;
 	ci->pathType   = pathType;
+	ci->hash       = hash;
+	ci->timeout    = gs->frameNum + GAME_SPEED * MAX_PATH_LIFETIME_SECS;
+	ci->memSize    = sizeof(CacheItem) + ci->path.path.size() * sizeof(float3) + ci->path.squares.size() * sizeof(int2);
 
 	cachedPaths[hash] = ci;
+	memUsage += ci->memSize;
+	LinkItem(ci);
 
 	CacheQue cq;
 	cq.hash = hash;
-	cq.timeout = gs->frameNum + GAME_SPEED * MAX_PATH_LIFETIME_SECS;
+	cq.timeout = ci->timeout;
 
 	cacheQue.push_back(cq);
-	maxCacheSize = std::max<boost::uint64_t>(maxCacheSize, cacheQue.size());
+
+	// drop the least recently used paths until we fit the budget again
+	// (the new path itself stays even if it alone exceeds the budget)
+	while (memUsage > memBudget && lruHead != ci) {
+		RemoveItem(lruHead);
+		numEvictions++;
+	}
+
+	maxCacheSize = std::max<boost::uint64_t>(maxCacheSize, cachedPaths.size());
 	return false;
 }
 
@@ -81,35 +99,97 @@ const CPathCache::CacheItem* CPathCache::GetCachedPath(
 	if (iter == cachedPaths.end()) {
 		++numCacheMisses; return NULL;
 	}
-	if (iter->second->strtBlock != strtBlock) {
+
+	CacheItem* ci = iter->second;
+
+	if (ci->strtBlock != strtBlock) {
 		++numCacheMisses; return NULL;
 	}
-	if (iter->second->goalBlock != goalBlock) {
+	if (ci->goalBlock != goalBlock) {
 		++numCacheMisses; return NULL;
 	}
-	if (iter->second->pathType != pathType) {
+	if (ci->pathType != pathType) {
 		++numCacheMisses; return NULL;
 	}
 
+	// mark as most recently used
+	UnlinkItem(ci);
+	LinkItem(ci);
+
 	++numCacheHits;
-	return (iter->second);
+	return ci;
+}
+
+void CPathCache::GetStats(PathCacheStats& stats) const
+{
+	stats.numHits           += numCacheHits;
+	stats.numMisses         += numCacheMisses;
+	stats.numEvictions      += numEvictions;
+	stats.numExpirations    += numExpirations;
+	stats.numHashCollisions += numHashCollisions;
+	stats.numItems          += cachedPaths.size();
+	stats.memUsage          += memUsage;
+	stats.memBudget         += memBudget;
 }
 
 void CPathCache::Update()
 {
-	while (!cacheQue.empty() && (cacheQue.front().timeout) < gs->frameNum)
-		RemoveFrontQueItem();
+	while (!cacheQue.empty() && (cacheQue.front().timeout) < gs->frameNum) {
+		const CacheQue& cq = cacheQue.front();
+		const CachedPathConstIter it = cachedPaths.find(cq.hash);
+
+		// the item can already have been evicted (and a newer
+		// one with the same hash added), compare the timeouts
+		if (it != cachedPaths.end() && (it->second)->timeout == cq.timeout) {
+			RemoveItem(it->second);
+			numExpirations++;
+		}
+
+		cacheQue.pop_front();
+	}
+}
+
+void CPathCache::RemoveItem(CacheItem* ci)
+{
+	assert(cachedPaths.find(ci->hash) != cachedPaths.end());
+
+	UnlinkItem(ci);
+	cachedPaths.erase(ci->hash);
+
+	memUsage -= ci->memSize;
+	delete ci;
+}
+
+void CPathCache::LinkItem(CacheItem* ci)
+{
+	ci->lruPrev = lruTail;
+	ci->lruNext = NULL;
+
+	if (lruTail != NULL) {
+		lruTail->lruNext = ci;
+	} else {
+		lruHead = ci;
+	}
+
+	lruTail = ci;
 }
 
-void CPathCache::RemoveFrontQueItem()
+void CPathCache::UnlinkItem(CacheItem* ci)
 {
-	const CachedPathConstIter it = cachedPaths.find((cacheQue.front()).hash);
+	if (ci->lruPrev != NULL) {
+		ci->lruPrev->lruNext = ci->lruNext;
+	} else {
+		lruHead = ci->lruNext;
+	}
 
-	assert(it != cachedPaths.end());
-	delete (it->second);
+	if (ci->lruNext != NULL) {
+		ci->lruNext->lruPrev = ci->lruPrev;
+	} else {
+		lruTail = ci->lruPrev;
+	}
 
-	cachedPaths.erase(it);
-	cacheQue.pop_front();
+	ci->lruPrev = NULL;
+	ci->lruNext = NULL;
 }
 
 boost::uint64_t CPathCache::GetHash(
@@ -3,16 +3,19 @@
 #ifndef PATHCACHE_H
 #define PATHCACHE_H
 
-#include <map>
-#include <list>
+#include <deque>
+#include <boost/unordered_map.hpp>
 
 #include "IPath.h"
 #include "System/type2.h"
 
+struct PathCacheStats;
+
 class CPathCache
 {
 public:
-	CPathCache(int blocksX, int blocksZ);
+	/// @param memBudget maximum size (in bytes) of all cached paths combined
+	CPathCache(int blocksX, int blocksZ, unsigned int memBudget);
 	~CPathCache();
 
 	struct CacheItem {
@@ -22,6 +25,14 @@ public:
 		int2 goalBlock;
 		float goalRadius;
 		int pathType;
+
+		boost::uint64_t hash;
+		boost::int32_t timeout;
+		unsigned int memSize;
+
+		// intrusive LRU list, head is the least recently used item
+		CacheItem* lruPrev;
+		CacheItem* lruNext;
 	};
 
 	void Update();
@@ -41,8 +52,13 @@ public:
 		int pathType
 	);
 
+	/// adds our counters to <stats>
+	void GetStats(PathCacheStats& stats) const;
+
 private:
-	void RemoveFrontQueItem();
+	void RemoveItem(CacheItem* ci);
+	void LinkItem(CacheItem* ci);
+	void UnlinkItem(CacheItem* ci);
 
 	boost::uint64_t GetHash(
 		const int2 strtBlk,
@@ -72,10 +88,14 @@ private:
 		boost::uint64_t hash;
 	};
 
-	std::list<CacheQue> cacheQue;
-	std::map<boost::uint64_t, CacheItem*> cachedPaths;
+	/// in order of insertion (and thus timeout), may reference evicted items
+	std::deque<CacheQue> cacheQue;
+	boost::unordered_map<boost::uint64_t, CacheItem*> cachedPaths;
 
-	typedef std::map<boost::uint64_t, CacheItem*>::const_iterator CachedPathConstIter;
+	typedef boost::unordered_map<boost::uint64_t, CacheItem*>::const_iterator CachedPathConstIter;
+
+	CacheItem* lruHead;
+	CacheItem* lruTail;
 
 	boost::uint32_t numBlocksX;
 	boost::uint32_t numBlocksZ;
@@ -85,6 +105,11 @@ private:
 	boost::uint32_t numCacheHits;
 	boost::uint32_t numCacheMisses;
 	boost::uint32_t numHashCollisions;
+	boost::uint32_t numEvictions;
+	boost::uint32_t numExpirations;
+
+	unsigned int memUsage;
+	unsigned int memBudget;
 };
 
 #endif
@@ -21,7 +21,18 @@ static const float ESTIMATE_DISTANCE     = 55.0f;
 static const float MIN_ESTIMATE_DISTANCE = 40.0f;
 static const float MIN_DETAILED_DISTANCE = 12.0f;
 
-static const unsigned int PATHESTIMATOR_VERSION = 53;
+// maximum number of deferred (long-range) requests resolved per PathManager::Update
+static const unsigned int MAX_QUEUED_SEARCHES_PER_UPDATE = 32;
+
+// queued requests of at least this many units toward the same med-res goal
+// block are resolved through one shared flow-field instead of a search each
+static const unsigned int FLOWFIELD_MIN_GROUP_SIZE = 8;
+// maximum number of flow-field (follow + short max-res refine) requests per update
+static const unsigned int MAX_FLOWFIELD_PATHS_PER_UPDATE = MAX_QUEUED_SEARCHES_PER_UPDATE * 4;
+// flow-fields are dropped after this many frames (or on any terrain change)
+static const unsigned int FLOWFIELD_LIFETIME = GAME_SPEED * 4;
+
+static const unsigned int PATHESTIMATOR_VERSION = 54;
 
 static const unsigned int MEDRES_PE_BLOCKSIZE =  8;
 static const unsigned int LOWRES_PE_BLOCKSIZE = 32;
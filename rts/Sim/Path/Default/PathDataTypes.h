@@ -3,8 +3,9 @@
 #ifndef PATH_DATATYPES_H
 #define PATH_DATATYPES_H
 
-#include <queue>
+#include <algorithm>
 #include <vector>
+#include <cassert>
 #include <cstring> // for memset
 
 #include "PathConstants.h"
@@ -32,14 +33,6 @@ struct PathNode {
 };
 
 
-/// functor to define node priority
-struct lessCost: public std::binary_function<PathNode*, PathNode*, bool> {
-	inline bool operator() (const PathNode* x, const PathNode* y) const {
-		return (x->fCost > y->fCost);
-	}
-};
-
-
 struct PathNodeBuffer {
 public:
 	PathNodeBuffer(): idx(0) {
@@ -75,6 +68,7 @@ struct PathNodeStateBuffer {
 		fCost.resize(br.x * br.y, PATHCOST_INFINITY);
 		gCost.resize(br.x * br.y, PATHCOST_INFINITY);
 		nodeMask.resize(br.x * br.y, 0);
+		nodeGen.resize(br.x * br.y, 0);
 
 		// create on-demand
 		//extraCostSynced.resize(br.x * br.y, 0.0f);
@@ -89,6 +83,8 @@ struct PathNodeStateBuffer {
 		maxCosts[NODE_COST_F] = 0.0f;
 		maxCosts[NODE_COST_G] = 0.0f;
 		maxCosts[NODE_COST_H] = 0.0f;
+
+		searchGen = 0;
 	}
 
 	unsigned int GetSize() const { return fCost.size(); }
@@ -98,9 +94,37 @@ struct PathNodeStateBuffer {
 		fCost[idx] = PATHCOST_INFINITY;
 		gCost[idx] = PATHCOST_INFINITY;
 		nodeMask[idx] &= PATHOPT_OBSOLETE;
-		peParentNodePos[idx] = int2(-1, -1);
+
+		if (!peParentNodePos.empty()) {
+			peParentNodePos[idx] = int2(-1, -1);
+		}
+	}
+
+	/// starts a new search; every node not touched since is implicitly cleared
+	void NextSearch() {
+		if ((++searchGen) != 0)
+			return;
+
+		// generation counter wrapped around, do a full reset once
+		for (unsigned int idx = 0; idx < nodeGen.size(); idx++) {
+			ClearSquare(idx);
+		}
+
+		std::fill(nodeGen.begin(), nodeGen.end(), 0);
+		searchGen = 1;
+	}
+
+	/// must be called before a node is first read or written during a search
+	void TouchNode(unsigned int idx) {
+		if (nodeGen[idx] == searchGen)
+			return;
+
+		nodeGen[idx] = searchGen;
+		ClearSquare(idx);
 	}
-	
+
+	/// true if the node has been touched by the current (or most recent) search
+	bool IsNodeCurrent(unsigned int idx) const { return (nodeGen[idx] == searchGen); }
 
 	/// size of the memory-region we hold allocated (excluding sizeof(*this))
 	unsigned int GetMemFootPrint() const {
@@ -110,7 +134,8 @@ struct PathNodeStateBuffer {
 			memFootPrint += (peNodeOffsets.size() * (sizeof(std::vector<int2>) + peNodeOffsets[0].size() * sizeof(int2)));
 		}
 
-		memFootPrint += (nodeMask.size() * sizeof(unsigned int));
+		memFootPrint += (nodeMask.size() * sizeof(boost::uint16_t));
+		memFootPrint += (nodeGen.size() * sizeof(unsigned int));
 		memFootPrint += (peParentNodePos.size() * sizeof(int2));
 		memFootPrint += ((fCost.size() + gCost.size()) * sizeof(float));
 		memFootPrint += ((extraCostSynced.size() + extraCostUnsynced.size()) * sizeof(float));
@@ -187,6 +212,11 @@ public:
 	/// combination of PATHOPT_{OPEN, ..., OBSOLETE} flags
 	std::vector<boost::uint16_t> nodeMask;
 
+	/// search-generation each node was last touched in; any node whose
+	/// value differs from <searchGen> holds stale state and is reset by
+	/// TouchNode instead of clearing all dirty nodes after every search
+	std::vector<unsigned int> nodeGen;
+
 	/// needed for the PE to back-track path to goal
 	std::vector<int2> peParentNodePos;
 
@@ -218,6 +248,8 @@ private:
 private:
 	float maxCosts[3];
 
+	unsigned int searchGen;
+
 	int2 ps; ///< patch size (eg. 1 for PF, BLOCK_SIZE for PE); ignored when extraCosts != NULL
 	int2 br; ///< buffer resolution (equal to mr / ps); ignored when extraCosts != NULL
 	int2 mr; ///< heightmap resolution (equal to gs->map{x,y})
@@ -227,77 +259,92 @@ private:
 
 
 
-// looks like a std::vector, but holds a fixed-size buffer
-// used as a backing array for the PathPriorityQueue dtype
-class PathVector {
+// binary min-heap (ordered on fCost) over a fixed-size buffer
+// of node pointers; this is a plain array with manual sifting
+// rather than a std::priority_queue so push and pop touch only
+// the log(N) slots they need and Clear is O(1)
+//
+// NOTE:
+//   bucket- and radix-queues were considered as alternatives,
+//   but both require the sequence of popped keys to be monotone
+//   which does not hold here (extra-costs and heat/flow-costs
+//   make the heuristic inconsistent) and quantizing fCost would
+//   change which of several equal-cost paths gets picked
+class PathBinaryHeap {
 public:
-	typedef int size_type;
-	typedef PathNode* value_type;
-	typedef PathNode* reference;
-	typedef PathNode** iterator;
-	typedef const PathNode* const_reference;
-	typedef const PathNode* const* const_iterator;
-
-	// gcc 4.3 requires concepts, so provide them
-		value_type& operator [] (size_type idx) { return buf[idx]; }
-		const value_type& operator [] (size_type idx) const { return buf[idx]; }
-
-		typedef iterator pointer;
-		typedef const_iterator const_pointer;
-		typedef int difference_type;
-
-		typedef PathNode** reverse_iterator;
-		typedef const PathNode* const* const_reverse_iterator;
-
-		// FIXME: don't ever use these
-		reverse_iterator rbegin() { return 0; }
-		reverse_iterator rend() { return 0; }
-		const_reverse_iterator rbegin() const { return 0; }
-		const_reverse_iterator rend() const { return 0; }
-		PathVector(int, const value_type&): bufPos(-1) { memset(buf, (int)NULL, sizeof(buf)); abort(); }
-		PathVector(iterator, iterator): bufPos(-1) { memset(buf, (int)NULL, sizeof(buf)); abort(); }
-		void insert(iterator, const value_type&) { abort(); }
-		void insert(iterator, const size_type&, const value_type&) { abort(); }
-		void insert(iterator, iterator, iterator) { abort(); }
-		void erase(iterator, iterator) { abort(); }
-		void erase(iterator) { abort(); }
-		void erase(iterator, iterator, iterator) { abort(); }
-		void swap(PathVector&) { abort(); }
-	// end of concept hax
-
-	PathVector(): bufPos(-1) {
+	PathBinaryHeap(): numNodes(0) {
 #ifdef DEBUG
 		// only do this in DEBUG builds for performance reasons
 		// it could help finding logic errors
-		memset(buf, (int)NULL, sizeof(buf));
+		memset(buf, 0, sizeof(buf));
 #endif
 	}
 
-	inline void push_back(PathNode* os) { buf[++bufPos] = os; }
-	inline void pop_back() { --bufPos; }
-	inline PathNode* back() const { return buf[bufPos]; }
-	inline const value_type& front() const { return buf[0]; }
-	inline value_type& front() { return buf[0]; }
-	inline bool empty() const { return (bufPos < 0); }
-	inline size_type size() const { return bufPos + 1; }
-	inline size_type max_size() const { return (1 << 30); }
-	inline iterator begin() { return &buf[0]; }
-	inline iterator end() { return &buf[bufPos + 1]; }
-	inline const_iterator begin() const { return &buf[0]; }
-	inline const_iterator end() const { return &buf[bufPos + 1]; }
-	inline void clear() { bufPos = -1; }
+	inline void push(PathNode* n) {
+		assert(numNodes < MAX_SEARCHED_NODES);
+		buf[numNodes] = n;
+		SiftUp(numNodes++);
+	}
+	inline void pop() {
+		assert(numNodes > 0);
+		buf[0] = buf[--numNodes];
+
+		if (numNodes > 0) {
+			SiftDown(0);
+		}
+	}
+
+	inline PathNode* top() const { return buf[0]; }
+	inline bool empty() const { return (numNodes == 0); }
+	inline unsigned int size() const { return numNodes; }
+
+	/// faster than "while (!q.empty()) { q.pop(); }"
+	void Clear() { numNodes = 0; }
 
 private:
-	int bufPos;
+	inline void SiftUp(unsigned int i) {
+		PathNode* n = buf[i];
+
+		while (i > 0) {
+			const unsigned int p = (i - 1) >> 1;
+
+			if (buf[p]->fCost <= n->fCost)
+				break;
+
+			buf[i] = buf[p];
+			i = p;
+		}
+
+		buf[i] = n;
+	}
+	inline void SiftDown(unsigned int i) {
+		PathNode* n = buf[i];
+
+		const unsigned int half = numNodes >> 1;
+
+		while (i < half) {
+			unsigned int c = (i << 1) + 1;
+
+			if ((c + 1) < numNodes && buf[c + 1]->fCost < buf[c]->fCost)
+				c += 1;
+			if (n->fCost <= buf[c]->fCost)
+				break;
+
+			buf[i] = buf[c];
+			i = c;
+		}
+
+		buf[i] = n;
+	}
+
+private:
+	unsigned int numNodes;
 
 	PathNode* buf[MAX_SEARCHED_NODES];
 };
 
 
-class PathPriorityQueue: public std::priority_queue<PathNode*, PathVector, lessCost> {
-public:
-	/// faster than "while (!q.empty()) { q.pop(); }"
-	void Clear() { c.clear(); }
-};
+/// open-set implementation used by both the PF and the PE
+typedef PathBinaryHeap PathPriorityQueue;
 
 #endif // PATH_DATATYPES_H
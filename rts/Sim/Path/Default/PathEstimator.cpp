@@ -4,11 +4,15 @@
 
 #include "PathEstimator.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <queue>
 #include <boost/bind.hpp>
 #include <boost/thread/barrier.hpp>
 
-#include "minizip/zip.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include "PathAllocator.h"
 #include "PathCache.h"
@@ -18,16 +22,16 @@
 #include "PathLog.h"
 #include "Map/ReadMap.h"
 #include "Game/LoadScreen.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "System/CRC.h"
 #include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
 #include "System/Config/ConfigHandler.h"
-#include "System/FileSystem/Archives/IArchive.h"
-#include "System/FileSystem/ArchiveLoader.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -160,8 +164,8 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 		loadscreen->SetLoadMessage("PathCosts: written", true);
 	}
 
-	pathCache[0] = new CPathCache(nbrOfBlocksX, nbrOfBlocksZ);
-	pathCache[1] = new CPathCache(nbrOfBlocksX, nbrOfBlocksZ);
+	pathCache[0] = new CPathCache(nbrOfBlocksX, nbrOfBlocksZ, modInfo.pathCacheMemoryBudget * 1024);
+	pathCache[1] = new CPathCache(nbrOfBlocksX, nbrOfBlocksZ, modInfo.pathCacheMemoryBudget * 1024);
 }
 
 
@@ -629,14 +633,13 @@ IPath::SearchResult CPathEstimator::InitSearch(const MoveDef& moveDef, const CPa
 	ResetSearch();
 
 	// mark and store the start-block
+	blockStates.TouchNode(mStartBlockIdx);
 	blockStates.nodeMask[mStartBlockIdx] |= PATHOPT_OPEN;
 	blockStates.fCost[mStartBlockIdx] = 0.0f;
 	blockStates.gCost[mStartBlockIdx] = 0.0f;
 	blockStates.SetMaxCost(NODE_COST_F, 0.0f);
 	blockStates.SetMaxCost(NODE_COST_G, 0.0f);
 
-	dirtyBlocks.push_back(mStartBlockIdx);
-
 	openBlockBuffer.SetSize(0);
 	// add the starting block to the open-blocks-queue
 	PathNode* ob = openBlockBuffer.GetNode(openBlockBuffer.GetSize());
@@ -763,6 +766,8 @@ void CPathEstimator::TestBlock(
 	if (vertexCosts[vertexIdx] >= PATHCOST_INFINITY)
 		return;
 
+	blockStates.TouchNode(blockIdx);
+
 	// check if the block is unavailable
 	if (blockStates.nodeMask[blockIdx] & (PATHOPT_FORBIDDEN | PATHOPT_BLOCKED | PATHOPT_CLOSED))
 		return;
@@ -772,7 +777,6 @@ void CPathEstimator::TestBlock(
 	// check if the block is blocked or out of constraints
 	if (!peDef.WithinConstraints(square.x, square.y)) {
 		blockStates.nodeMask[blockIdx] |= PATHOPT_BLOCKED;
-		dirtyBlocks.push_back(blockIdx);
 		return;
 	}
 
@@ -819,8 +823,6 @@ void CPathEstimator::TestBlock(
 	blockStates.gCost[blockIdx] = gCost;
 	blockStates.nodeMask[blockIdx] |= (pathDir | PATHOPT_OPEN);
 	blockStates.peParentNodePos[blockIdx] = parentOpenBlock.nodePos;
-
-	dirtyBlocks.push_back(blockIdx);
 }
 
 
@@ -852,88 +854,253 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, IPath::Path& foundPath
 }
 
 
+/**
+ * Flow-field support: a single Dijkstra expansion outward from the goal
+ * block yields the cost-to-goal of every block. Vertex costs are stored
+ * bi-directionally, so expanding from the goal gives the same costs as
+ * searching toward it; the extra cost of entering a block is that of the
+ * block nearer to the goal. Flow-costs are ignored since they depend on
+ * the moment a unit actually travels through a block.
+ */
+void CPathEstimator::CalcFlowField(const MoveDef& moveDef, unsigned int goalBlockIdx, std::vector<float>& costs, bool synced) const {
+	// ties are broken by block index so the expansion order is deterministic
+	typedef std::pair<float, unsigned int> FlowNode;
+	std::priority_queue<FlowNode, std::vector<FlowNode>, std::greater<FlowNode> > openNodes;
+
+	const int vertexBase = moveDef.pathType * blockStates.GetSize() * PATH_DIRECTION_VERTICES;
+
+	costs.clear();
+	costs.resize(nbrOfBlocksX * nbrOfBlocksZ, PATHCOST_INFINITY);
+	costs[goalBlockIdx] = 0.0f;
+	openNodes.push(FlowNode(0.0f, goalBlockIdx));
+
+	while (!openNodes.empty()) {
+		const FlowNode node = openNodes.top();
+		openNodes.pop();
+
+		// stale entry, block was reached more cheaply in the meantime
+		if (node.first > costs[node.second])
+			continue;
+
+		const int2 block(node.second % nbrOfBlocksX, node.second / nbrOfBlocksX);
+		const int2 square = blockStates.peNodeOffsets[node.second][moveDef.pathType];
+		const float extraCost = blockStates.GetNodeExtraCost(square.x, square.y, synced);
+
+		for (unsigned int pathDir = 0; pathDir < PATH_DIRECTIONS; pathDir++) {
+			const int2 nbrBlock(block.x + directionVectors[pathDir].x, block.y + directionVectors[pathDir].y);
+
+			if (nbrBlock.x < 0 || nbrBlock.x >= nbrOfBlocksX || nbrBlock.y < 0 || nbrBlock.y >= nbrOfBlocksZ)
+				continue;
+
+			const int vertexIdx = vertexBase + node.second * PATH_DIRECTION_VERTICES + GetBlockVertexOffset(pathDir, nbrOfBlocksX);
+
+			if (vertexIdx < 0 || vertexIdx >= vertexCosts.size())
+				continue;
+			if (vertexCosts[vertexIdx] >= PATHCOST_INFINITY)
+				continue;
+
+			const unsigned int nbrBlockIdx = nbrBlock.y * nbrOfBlocksX + nbrBlock.x;
+			const float nbrCost = node.first + vertexCosts[vertexIdx] + extraCost;
+
+			if (nbrCost >= costs[nbrBlockIdx])
+				continue;
+
+			costs[nbrBlockIdx] = nbrCost;
+			openNodes.push(FlowNode(nbrCost, nbrBlockIdx));
+		}
+	}
+}
+
+/**
+ * Follows the gradient of a field made by CalcFlowField from <start> down
+ * to the goal block and stores the blocks passed in the same layout that
+ * FinishSearch uses (goal first, next waypoint last).
+ */
+IPath::SearchResult CPathEstimator::GetFlowFieldPath(const MoveDef& moveDef, const std::vector<float>& costs, float3 start, IPath::Path& path) const {
+	start.ClampInBounds();
+
+	path.path.clear();
+	path.pathCost = PATHCOST_INFINITY;
+
+	const int vertexBase = moveDef.pathType * blockStates.GetSize() * PATH_DIRECTION_VERTICES;
+
+	int2 block(start.x / BLOCK_PIXEL_SIZE, start.z / BLOCK_PIXEL_SIZE);
+	unsigned int blockIdx = block.y * nbrOfBlocksX + block.x;
+
+	if (costs[blockIdx] >= PATHCOST_INFINITY)
+		return IPath::Error;
+
+	path.pathCost = costs[blockIdx];
+
+	while (costs[blockIdx] > 0.0f) {
+		unsigned int nextBlockIdx = blockIdx;
+
+		for (unsigned int pathDir = 0; pathDir < PATH_DIRECTIONS; pathDir++) {
+			const int2 nbrBlock(block.x + directionVectors[pathDir].x, block.y + directionVectors[pathDir].y);
+
+			if (nbrBlock.x < 0 || nbrBlock.x >= nbrOfBlocksX || nbrBlock.y < 0 || nbrBlock.y >= nbrOfBlocksZ)
+				continue;
+
+			const int vertexIdx = vertexBase + blockIdx * PATH_DIRECTION_VERTICES + GetBlockVertexOffset(pathDir, nbrOfBlocksX);
+
+			if (vertexIdx < 0 || vertexIdx >= vertexCosts.size())
+				continue;
+			if (vertexCosts[vertexIdx] >= PATHCOST_INFINITY)
+				continue;
+
+			const unsigned int nbrBlockIdx = nbrBlock.y * nbrOfBlocksX + nbrBlock.x;
+
+			if (costs[nbrBlockIdx] < costs[nextBlockIdx])
+				nextBlockIdx = nbrBlockIdx;
+		}
+
+		// costs strictly decrease toward the goal, so this only
+		// happens if the field no longer matches the vertex costs
+		if (nextBlockIdx == blockIdx)
+			break;
+
+		blockIdx = nextBlockIdx;
+		block = int2(blockIdx % nbrOfBlocksX, blockIdx / nbrOfBlocksX);
+
+		const int2 square = blockStates.peNodeOffsets[blockIdx][moveDef.pathType];
+		path.path.push_back(SquareToFloat3(square.x, square.y));
+	}
+
+	std::reverse(path.path.begin(), path.path.end());
+
+	if (!path.path.empty()) {
+		path.pathGoal = path.path.front();
+	}
+
+	return ((costs[blockIdx] > 0.0f)? IPath::GoalOutOfRange: IPath::Ok);
+}
+
+
 /**
  * Clean lists from last search
  */
 void CPathEstimator::ResetSearch() {
 	openBlocks.Clear();
-
-	while (!dirtyBlocks.empty()) {
-		blockStates.ClearSquare(dirtyBlocks.back());
-		dirtyBlocks.pop_back();
-	}
+	blockStates.NextSearch();
 
 	testedBlocks = 0;
 }
 
 
+namespace {
+	// raw (uncompressed) cache-file layout, every section is 4-byte aligned
+	// so the file can be mapped into memory and read back without parsing:
+	//   [CacheFileHeader][numBlocks * numMoveDefs * int2][numVertices * float]
+	struct CacheFileHeader {
+		char magic[4];
+
+		boost::uint32_t version;
+		boost::uint32_t hash;
+		boost::uint32_t mapChecksum;
+		boost::uint32_t modChecksum;
+
+		boost::uint32_t blockSize;
+		boost::uint32_t numBlocks;
+		boost::uint32_t numMoveDefs;
+		boost::uint32_t numVertices;
+
+		// CRC over (hash, offsets, vertices); equals the CRC the zip-format used
+		boost::uint32_t dataChecksum;
+	};
+
+	static const char CACHE_FILE_MAGIC[4] = {'S', 'P', 'E', 'C'};
+}
+
+static std::string GetCacheFileName(const std::string& map, unsigned int hash, const std::string& cacheFileName) {
+	return (GetPathCacheDir() + map + IntToString(hash, "%u") + "." + cacheFileName + ".pecache");
+}
+
+
 /**
  * Try to read offset and vertices data from file, return false on failure
- * TODO: Read-error-check.
+ * (in which case the costs have to be recalculated)
  */
 bool CPathEstimator::ReadFile(const std::string& cacheFileName, const std::string& map)
 {
 	const unsigned int hash = Hash();
-	char hashString[50];
+	const std::string filename = GetCacheFileName(map, hash, cacheFileName);
 
-	sprintf(hashString, "%u", hash);
-	LOG("[PathEstimator::%s] hash=%s\n", __FUNCTION__, hashString);
+	LOG("[PathEstimator::%s] hash=%u\n", __FUNCTION__, hash);
 
-	std::string filename = GetPathCacheDir() + map + hashString + "." + cacheFileName + ".zip";
 	if (!FileSystem::FileExists(filename))
 		return false;
-	// open file for reading from a suitable location (where the file exists)
-	IArchive* pfile = archiveLoader.OpenArchive(dataDirsAccess.LocateFile(filename), "sdz");
 
-	if (!pfile || !pfile->IsOpen()) {
-		delete pfile;
+	const std::string filePath = dataDirsAccess.LocateFile(filename);
+
+	const unsigned int numBlocks = blockStates.GetSize();
+	const unsigned int numMoveDefs = moveDefHandler->GetNumMoveDefs();
+	const unsigned int offsetsSize = numMoveDefs * sizeof(int2);
+	const unsigned int fileSize = sizeof(CacheFileHeader) + numBlocks * offsetsSize + vertexCosts.size() * sizeof(float);
+
+	if (FileSystem::GetFileSize(filePath) != fileSize)
 		return false;
-	}
 
 	char calcMsg[512];
 	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
 	loadscreen->SetLoadMessage(calcMsg);
 
-	std::auto_ptr<IArchive> auto_pfile(pfile);
-	IArchive& file(*pfile);
-
-	const unsigned fid = file.FindFile("pathinfo");
+	try {
+		const boost::interprocess::file_mapping mapping(filePath.c_str(), boost::interprocess::read_only);
+		const boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
 
-	if (fid < file.NumFiles()) {
-		pathChecksum = file.GetCrc32(fid);
+		if (region.get_size() < fileSize)
+			return false;
 
-		std::vector<boost::uint8_t> buffer;
-		file.GetFile(fid, buffer);
+		const boost::uint8_t* data = reinterpret_cast<const boost::uint8_t*>(region.get_address());
+		const CacheFileHeader* header = reinterpret_cast<const CacheFileHeader*>(data);
 
-		if (buffer.size() < 4)
+		if (std::memcmp(header->magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0)
 			return false;
-
-		unsigned filehash = *((unsigned*)&buffer[0]);
-		if (filehash != hash)
+		if (header->version != PATHESTIMATOR_VERSION || header->hash != hash)
+			return false;
+		if (header->mapChecksum != readMap->GetMapChecksum() || header->modChecksum != moveDefHandler->GetCheckSum())
+			return false;
+		if (header->blockSize != BLOCK_SIZE || header->numBlocks != numBlocks)
+			return false;
+		if (header->numMoveDefs != numMoveDefs || header->numVertices != vertexCosts.size())
 			return false;
 
-		unsigned pos = sizeof(unsigned);
+		// copy the sections straight out of the mapping and validate
+		// them in the same pass, so every page is touched only once
+		CRC crc;
+		crc.Update(hash);
 
-		// Read block-center-offset data.
-		const unsigned blockSize = moveDefHandler->GetNumMoveDefs() * sizeof(int2);
-		if (buffer.size() < pos + blockSize * blockStates.GetSize())
-			return false;
+		unsigned int pos = sizeof(CacheFileHeader);
 
-		for (int blocknr = 0; blocknr < blockStates.GetSize(); blocknr++) {
-			std::memcpy(&blockStates.peNodeOffsets[blocknr][0], &buffer[pos], blockSize);
-			pos += blockSize;
+		for (unsigned int blockNr = 0; blockNr < numBlocks; blockNr++) {
+			crc.Update(&data[pos], offsetsSize);
+			std::memcpy(&blockStates.peNodeOffsets[blockNr][0], &data[pos], offsetsSize);
+			pos += offsetsSize;
 		}
 
-		// Read vertices data.
-		if (buffer.size() < pos + vertexCosts.size() * sizeof(float))
+		// vertex-costs are laid out per path-type (see CalculateVertex)
+		const unsigned int typeVertexCount = numBlocks * PATH_DIRECTION_VERTICES;
+		const unsigned int typeVertexSize = typeVertexCount * sizeof(float);
+
+		for (unsigned int pathType = 0; pathType < numMoveDefs; pathType++) {
+			crc.Update(&data[pos], typeVertexSize);
+			std::memcpy(&vertexCosts[pathType * typeVertexCount], &data[pos], typeVertexSize);
+			pos += typeVertexSize;
+		}
+
+		if (crc.GetDigest() != header->dataChecksum) {
+			LOG_L(L_WARNING, "[PathEstimator::%s] checksum mismatch in %s, recalculating", __FUNCTION__, filename.c_str());
 			return false;
-		std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+		}
 
-		// File read successful.
-		return true;
-	} else {
+		pathChecksum = header->dataChecksum;
+	} catch (const boost::interprocess::interprocess_exception& ex) {
+		LOG_L(L_WARNING, "[PathEstimator::%s] failed to map %s (%s)", __FUNCTION__, filename.c_str(), ex.what());
 		return false;
 	}
+
+	// File read successful.
+	return true;
 }
 
 
@@ -947,47 +1114,60 @@ void CPathEstimator::WriteFile(const std::string& cacheFileName, const std::stri
 		return;
 
 	const unsigned int hash = Hash();
-	char hashString[64] = {0};
-
-	sprintf(hashString, "%u", hash);
-	LOG("[PathEstimator::%s] hash=%s\n", __FUNCTION__, hashString);
+	const std::string filename = GetCacheFileName(map, hash, cacheFileName);
 
-	const std::string filename = GetPathCacheDir() + map + hashString + "." + cacheFileName + ".zip";
+	LOG("[PathEstimator::%s] hash=%u\n", __FUNCTION__, hash);
 
-	// open file for writing in a suitable location
-	zipFile file = zipOpen(dataDirsAccess.LocateFile(filename, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
+	const unsigned int numBlocks = blockStates.GetSize();
+	const unsigned int numMoveDefs = moveDefHandler->GetNumMoveDefs();
+	const unsigned int offsetsSize = numMoveDefs * sizeof(int2);
 
-	if (file == NULL)
-		return;
+	CacheFileHeader header;
+	std::memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
 
-	zipOpenNewFileInZip(file, "pathinfo", NULL, NULL, 0, NULL, 0, NULL, Z_DEFLATED, Z_BEST_COMPRESSION);
+	header.version     = PATHESTIMATOR_VERSION;
+	header.hash        = hash;
+	header.mapChecksum = readMap->GetMapChecksum();
+	header.modChecksum = moveDefHandler->GetCheckSum();
+	header.blockSize   = BLOCK_SIZE;
+	header.numBlocks   = numBlocks;
+	header.numMoveDefs = numMoveDefs;
+	header.numVertices = vertexCosts.size();
 
-	// Write hash. (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (void*) &hash, 4);
+	{
+		CRC crc;
+		crc.Update(hash);
 
-	// Write block-center-offsets.
-	for (int blocknr = 0; blocknr < blockStates.GetSize(); blocknr++)
-		zipWriteInFileInZip(file, (void*) &blockStates.peNodeOffsets[blocknr][0], moveDefHandler->GetNumMoveDefs() * sizeof(int2));
+		for (unsigned int blockNr = 0; blockNr < numBlocks; blockNr++)
+			crc.Update(&blockStates.peNodeOffsets[blockNr][0], offsetsSize);
 
-	// Write vertices.
-	zipWriteInFileInZip(file, &vertexCosts[0], vertexCosts.size() * sizeof(float));
+		crc.Update(&vertexCosts[0], vertexCosts.size() * sizeof(float));
 
-	zipCloseFileInZip(file);
-	zipClose(file, NULL);
+		header.dataChecksum = crc.GetDigest();
+	}
 
+	// the checksum has to be known (for sync-checking) even if writing fails
+	pathChecksum = header.dataChecksum;
 
-	// get the CRC over the written path data
-	IArchive* pfile = archiveLoader.OpenArchive(dataDirsAccess.LocateFile(filename), "sdz");
+	// open file for writing in a suitable location
+	std::ofstream file(dataDirsAccess.LocateFile(filename, FileQueryFlags::WRITE).c_str(), std::ios::out | std::ios::binary);
 
-	if (pfile == NULL)
+	if (!file.good())
 		return;
 
-	if (pfile->IsOpen()) {
-		assert(pfile->FindFile("pathinfo") < pfile->NumFiles());
-		pathChecksum = pfile->GetCrc32(pfile->FindFile("pathinfo"));
-	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (unsigned int blockNr = 0; blockNr < numBlocks; blockNr++)
+		file.write(reinterpret_cast<const char*>(&blockStates.peNodeOffsets[blockNr][0]), offsetsSize);
 
-	delete pfile;
+	file.write(reinterpret_cast<const char*>(&vertexCosts[0]), vertexCosts.size() * sizeof(float));
+	file.flush();
+
+	if (!file.good()) {
+		// do not leave a truncated file behind; ReadFile would reject it anyway
+		file.close();
+		FileSystem::Remove(dataDirsAccess.LocateFile(filename, FileQueryFlags::WRITE));
+	}
 }
 
 
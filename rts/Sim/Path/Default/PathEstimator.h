@@ -5,7 +5,6 @@
 
 #include <string>
 #include <list>
-#include <queue>
 
 #include "IPath.h"
 #include "PathConstants.h"
@@ -86,6 +85,22 @@ public:
 	);
 
 
+	/**
+	 * Fills <costs> with the cost-to-goal of every block for <moveDef>,
+	 * infinite for blocks that can not reach <goalBlockIdx>. Paths for any
+	 * number of units sharing this goal can then be read off the field by
+	 * GetFlowFieldPath without running a search per unit.
+	 */
+	void CalcFlowField(const MoveDef& moveDef, unsigned int goalBlockIdx, std::vector<float>& costs, bool synced = true) const;
+
+	/**
+	 * Generates the estimator path from <start> to the goal of <costs>
+	 * (see CalcFlowField). Returns Error if the start block can not reach
+	 * the goal at all.
+	 */
+	IPath::SearchResult GetFlowFieldPath(const MoveDef& moveDef, const std::vector<float>& costs, float3 start, IPath::Path& path) const;
+
+
 	/**
 	 * This is called whenever the ground structure of the map changes
 	 * (for example on explosions and new buildings).
@@ -158,7 +173,7 @@ private:
 	unsigned int nextOffsetMessageIdx;
 	unsigned int nextCostMessageIdx;
 
-	boost::uint32_t pathChecksum;               ///< currently crc from the zip
+	boost::uint32_t pathChecksum;               ///< crc over the cached offset and vertex data
 
 	boost::detail::atomic_count offsetBlockNum;
 	boost::detail::atomic_count costBlockNum;
@@ -175,7 +190,6 @@ private:
 	std::vector<boost::thread*> threads;
 
 	std::vector<float> vertexCosts;
-	std::list<unsigned int> dirtyBlocks;        /// List of blocks changed in last search.
 	std::list<SingleBlock> updatedBlocks;       /// Blocks that may need an update due to map changes.
 
 	int2 directionVectors[PATH_DIRECTIONS];
@@ -186,6 +186,7 @@ IPath::SearchResult CPathFinder::InitSearch(const MoveDef& moveDef, const CPathF
 	ResetSearch();
 
 	// Marks and store the start-square.
+	squareStates.TouchNode(mStartSquareIdx);
 	squareStates.nodeMask[mStartSquareIdx] = (PATHOPT_START | PATHOPT_OPEN);
 	squareStates.fCost[mStartSquareIdx] = 0.0f;
 	squareStates.gCost[mStartSquareIdx] = 0.0f;
@@ -193,8 +194,6 @@ IPath::SearchResult CPathFinder::InitSearch(const MoveDef& moveDef, const CPathF
 	squareStates.SetMaxCost(NODE_COST_F, 0.0f);
 	squareStates.SetMaxCost(NODE_COST_G, 0.0f);
 
-	dirtySquares.push_back(mStartSquareIdx);
-
 	// Make the beginning the fest square found.
 	mGoalSquareIdx = mStartSquareIdx;
 	mGoalHeuristic = pfDef.Heuristic(startxSqr, startzSqr);
@@ -316,6 +315,9 @@ bool CPathFinder::TestSquare(
 	}
 
 	const unsigned int sqrIdx = square.x + square.y * gs->mapx;
+
+	squareStates.TouchNode(sqrIdx);
+
 	const unsigned int sqrStatus = squareStates.nodeMask[sqrIdx];
 
 	// Check if the square is unaccessable or used.
@@ -331,7 +333,6 @@ bool CPathFinder::TestSquare(
 		((blockStatus & CMoveMath::BLOCK_STRUCTURE) || !pfDef.WithinConstraints(square.x, square.y))
 	) {
 		squareStates.nodeMask[sqrIdx] |= PATHOPT_BLOCKED;
-		dirtySquares.push_back(sqrIdx);
 		return false;
 	}
 
@@ -344,7 +345,6 @@ bool CPathFinder::TestSquare(
 
 	if (squareSpeedMod == 0.0f) {
 		squareStates.nodeMask[sqrIdx] |= PATHOPT_FORBIDDEN;
-		dirtySquares.push_back(sqrIdx);
 		return false;
 	}
 
@@ -403,7 +403,6 @@ bool CPathFinder::TestSquare(
 	squareStates.gCost[sqrIdx] = os->gCost;
 	squareStates.nodeMask[sqrIdx] |= (PATHOPT_OPEN | pathOptDir);
 
-	dirtySquares.push_back(sqrIdx);
 	return true;
 }
 
@@ -484,7 +483,8 @@ void CPathFinder::AdjustFoundPath(const MoveDef& moveDef, IPath::Path& foundPath
 	do {                                                                                         \
 		int testsqr = square.x + (dxtest) + (square.y + (dytest)) * gs->mapx;                    \
 		int p2sqr = previous[2].x + previous[2].y * gs->mapx;                                    \
-		if (!(squareStates.nodeMask[testsqr] & (PATHOPT_BLOCKED | PATHOPT_FORBIDDEN)) &&         \
+		if (squareStates.IsNodeCurrent(testsqr) &&                                               \
+			!(squareStates.nodeMask[testsqr] & (PATHOPT_BLOCKED | PATHOPT_FORBIDDEN)) &&         \
 			 squareStates.fCost[testsqr] <= (COSTMOD) * squareStates.fCost[p2sqr]) {             \
 			float3& p2 = foundPath.path[foundPath.path.size() - 2];                              \
 			float3& p1 = foundPath.path.back();                                                  \
@@ -588,16 +588,7 @@ void CPathFinder::AdjustFoundPath(const MoveDef& moveDef, IPath::Path& foundPath
 void CPathFinder::ResetSearch()
 {
 	openSquares.Clear();
-
-	while (!dirtySquares.empty()) {
-		const unsigned int lsquare = dirtySquares.back();
-
-		squareStates.nodeMask[lsquare] = 0;
-		squareStates.fCost[lsquare] = PATHCOST_INFINITY;
-		squareStates.gCost[lsquare] = PATHCOST_INFINITY;
-
-		dirtySquares.pop_back();
-	}
+	squareStates.NextSearch();
 
 	testedNodes = 0;
 }
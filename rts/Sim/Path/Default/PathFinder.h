@@ -3,8 +3,8 @@
 #ifndef PATH_FINDER_H
 #define PATH_FINDER_H
 
+#include <deque>
 #include <list>
-#include <queue>
 #include <cstdlib>
 
 #include "IPath.h"
@@ -127,8 +127,6 @@ private:
 	PathNodeBuffer openSquareBuffer;
 	PathNodeStateBuffer squareStates;
 	PathPriorityQueue openSquares;
-
-	std::vector<unsigned int> dirtySquares;         ///< Squares tested by search.
 };
 
 #endif // PATH_FINDER_H
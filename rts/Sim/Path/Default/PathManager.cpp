@@ -5,10 +5,12 @@
 #include "PathConstants.h"
 #include "PathFinder.h"
 #include "PathEstimator.h"
+#include "PathCache.h"
 #include "PathFlowMap.hpp"
 #include "PathHeatMap.hpp"
 #include "Map/MapInfo.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Objects/SolidObjectDef.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "System/Log/ILog.h"
@@ -33,11 +35,9 @@ CPathManager::CPathManager(): nextPathID(0)
 	LOG("[CPathManager] pathing data checksum: %08x", GetPathCheckSum());
 
 	#ifdef SYNCDEBUG
-	// clients may have a non-writable cache directory (which causes
-	// the estimator path-file checksum to remain zero), so we can't
-	// update the sync-checker with this in normal builds
-	// NOTE: better to just checksum the in-memory data and broadcast
-	// that instead of relying on the zip-file CRC?
+	// the estimator checksums are computed over the in-memory data
+	// (also when the cache directory is not writable), but are not
+	// part of the sync-checker state in normal builds
 	{ SyncedUint tmp(GetPathCheckSum()); }
 	#endif
 }
@@ -95,17 +95,57 @@ unsigned int CPathManager::RequestPath(
 	assert(md == moveDef);
 
 	// Creates a new multipath.
-	IPath::SearchResult result = IPath::Error;
 	MultiPath* newPath = new MultiPath(startPos, pfDef, moveDef);
 	newPath->finalGoal = goalPos;
 	newPath->caller = caller;
+	newPath->synced = synced;
+
+	// long-range requests made by units are not searched right away but
+	// queued until the next Update, where they are resolved in order of
+	// arrival; until then NextWayPoint hands out temporary waypoints (as
+	// QTPFS does) so the caller does not have to stall on the estimators
+	// NOTE:
+	//   the classic GMT does not understand temporary waypoints, and
+	//   unsynced requests (eg. from AI's) expect an immediate answer
+	const float goalDist2D = pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
+	const bool queueSearch = (synced && caller != NULL && goalDist2D >= ESTIMATE_DISTANCE && !modInfo.useClassicGroundMoveType);
+
+	if (queueSearch) {
+		newPath->searchQueued = true;
+
+		const unsigned int pathID = Store(newPath);
+		queuedSearches.push_back(pathID);
+		return pathID;
+	}
+
+	if (!ExecuteSearch(newPath)) {
+		delete newPath;
+		return 0;
+	}
+
+	return (Store(newPath));
+}
+
+
+/*
+Run the searches for a multipath, returns false if no path could be found.
+*/
+bool CPathManager::ExecuteSearch(MultiPath* newPath)
+{
+	const MoveDef* moveDef = newPath->moveDef;
+	const float3& startPos = newPath->start;
+	const float3& goalPos = newPath->finalGoal;
+	const bool synced = newPath->synced;
+
+	CPathFinderDef* pfDef = newPath->peDef;
+	CSolidObject* caller = newPath->caller;
+
+	IPath::SearchResult result = IPath::Error;
 
 	if (caller != NULL) {
 		caller->UnBlock();
 	}
 
-	unsigned int pathID = 0;
-
 	// choose the PF or the PE depending on the projected 2D goal-distance
 	// NOTE: this distance can be far smaller than the actual path length!
 	// NOTE: take height difference into consideration for "special" cases
@@ -186,17 +226,65 @@ unsigned int CPathManager::RequestPath(
 			}
 		}
 
-		newPath->searchResult = result;
-		pathID = Store(newPath);
+	}
+
+	newPath->searchResult = result;
+
+	if (caller != NULL) {
+		caller->Block();
+	}
+
+	return (result != IPath::Error);
+}
+
+
+/*
+Resolve a queued request via the flow-field of its goal block (computed on first use),
+falls back to a regular search if the field does not reach the start position.
+*/
+bool CPathManager::ExecuteFlowFieldSearch(MultiPath* newPath, const FlowFieldKey& key)
+{
+	FlowField& flowField = flowFields[key];
+
+	if (flowField.frameNum < 0) {
+		SCOPED_TIMER("PathManager::CalcFlowField");
+
+		medResPE->CalcFlowField(*newPath->moveDef, key.second, flowField.costs, newPath->synced);
+		flowField.frameNum = gs->frameNum;
+	}
+
+	CSolidObject* caller = newPath->caller;
+
+	if (caller != NULL) {
+		caller->UnBlock();
+	}
+
+	IPath::SearchResult result = medResPE->GetFlowFieldPath(*newPath->moveDef, flowField.costs, newPath->start, newPath->medResPath);
+
+	if (result != IPath::Error && !newPath->medResPath.path.empty()) {
+		MedRes2MaxRes(*newPath, newPath->start, caller, newPath->synced);
 	} else {
-		delete newPath;
+		result = IPath::Error;
 	}
 
 	if (caller != NULL) {
 		caller->Block();
 	}
 
-	return pathID;
+	if (result == IPath::Error)
+		return (ExecuteSearch(newPath));
+
+	newPath->searchResult = result;
+	return true;
+}
+
+CPathManager::FlowFieldKey CPathManager::GetFlowFieldKey(const MultiPath* path) const
+{
+	const unsigned int blockSize = medResPE->GetBlockSize();
+	const unsigned int goalBlockX = path->peDef->goalSquareX / blockSize;
+	const unsigned int goalBlockZ = path->peDef->goalSquareZ / blockSize;
+
+	return (FlowFieldKey(path->moveDef->pathType, goalBlockZ * medResPE->GetNumBlocksX() + goalBlockX));
 }
 
 
@@ -330,6 +418,14 @@ float3 CPathManager::NextWayPoint(
 	if (multiPath == NULL)
 		return noPathPoint;
 
+	if (multiPath->searchQueued) {
+		// request has not been searched yet; keep the caller heading
+		// toward its goal a fixed small distance ahead (y=-1 indicates
+		// a temporary waypoint to GMT)
+		const float3 goalDir = (multiPath->finalGoal - callerPos).SafeNormalize2D() * SQUARE_SIZE;
+		return float3(callerPos.x + goalDir.x, -1.0f, callerPos.z + goalDir.z);
+	}
+
 	if (callerPos == ZeroVector) {
 		if (!multiPath->maxResPath.path.empty())
 			callerPos = multiPath->maxResPath.path.back();
@@ -386,7 +482,6 @@ float3 CPathManager::NextWayPoint(
 	} while (callerPos.SqDistance2D(waypoint) < Square(radius) && waypoint != multiPath->maxResPath.pathGoal);
 
 	// indicate this is not a temporary waypoint
-	// (the default PFS does not queue requests)
 	waypoint.y = 0.0f;
 
 	return waypoint;
@@ -413,6 +508,8 @@ void CPathManager::DeletePath(unsigned int pathID) {
 void CPathManager::TerrainChange(unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2, unsigned int /*type*/) {
 	medResPE->MapChanged(x1, z1, x2, z2);
 	lowResPE->MapChanged(x1, z1, x2, z2);
+
+	flowFields.clear();
 }
 
 
@@ -426,6 +523,67 @@ void CPathManager::Update()
 
 	medResPE->Update();
 	lowResPE->Update();
+
+	// estimator costs are now current for this frame
+	ExecuteQueuedSearches();
+}
+
+
+// resolve deferred requests at a fixed point in the frame (deterministic order)
+void CPathManager::ExecuteQueuedSearches()
+{
+	SCOPED_TIMER("PathManager::ExecuteQueuedSearches");
+
+	// expire old fields, the estimators keep refining their vertex costs
+	for (std::map<FlowFieldKey, FlowField>::iterator it = flowFields.begin(); it != flowFields.end(); ) {
+		if ((gs->frameNum - it->second.frameNum) >= FLOWFIELD_LIFETIME) {
+			flowFields.erase(it++);
+		} else {
+			++it;
+		}
+	}
+
+	if (queuedSearches.empty())
+		return;
+
+	// count how many queued requests share each goal block; a large group
+	// (typically a mass move order) is served by a single Dijkstra pass
+	std::map<FlowFieldKey, unsigned int> groupSizes;
+
+	for (std::deque<unsigned int>::const_iterator it = queuedSearches.begin(); it != queuedSearches.end(); ++it) {
+		const MultiPath* multiPath = GetMultiPath(*it);
+
+		if (multiPath == NULL)
+			continue;
+
+		groupSizes[GetFlowFieldKey(multiPath)] += 1;
+	}
+
+	unsigned int numSearches = 0;
+	unsigned int numFlowFieldPaths = 0;
+
+	while (!queuedSearches.empty() && numSearches < MAX_QUEUED_SEARCHES_PER_UPDATE && numFlowFieldPaths < MAX_FLOWFIELD_PATHS_PER_UPDATE) {
+		MultiPath* multiPath = GetMultiPath(queuedSearches.front());
+		queuedSearches.pop_front();
+
+		// path was deleted before its search ran
+		if (multiPath == NULL)
+			continue;
+
+		const FlowFieldKey key = GetFlowFieldKey(multiPath);
+
+		// on failure the path stays with an Error result
+		// and NextWayPoint will make the caller give up
+		if (groupSizes[key] >= FLOWFIELD_MIN_GROUP_SIZE || flowFields.find(key) != flowFields.end()) {
+			ExecuteFlowFieldSearch(multiPath, key);
+			numFlowFieldPaths++;
+		} else {
+			ExecuteSearch(multiPath);
+			numSearches++;
+		}
+
+		multiPath->searchQueued = false;
+	}
 }
 
 
@@ -538,6 +696,10 @@ bool CPathManager::SetNodeExtraCost(unsigned int x, unsigned int z, float cost,
 	maxResBuf.SetNodeExtraCost(x, z, cost, synced);
 	medResBuf.SetNodeExtraCost(x, z, cost, synced);
 	lowResBuf.SetNodeExtraCost(x, z, cost, synced);
+
+	if (synced)
+		flowFields.clear();
+
 	return true;
 }
 
@@ -553,6 +715,10 @@ bool CPathManager::SetNodeExtraCosts(const float* costs, unsigned int sizex, uns
 	maxResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	medResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	lowResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
+
+	if (synced)
+		flowFields.clear();
+
 	return true;
 }
 
@@ -571,6 +737,14 @@ const float* CPathManager::GetNodeExtraCosts(bool synced) const {
 	return costs;
 }
 
+PathCacheStats CPathManager::GetPathCacheStats(bool synced) const {
+	PathCacheStats stats;
+
+	medResPE->pathCache[synced]->GetStats(stats);
+	lowResPE->pathCache[synced]->GetStats(stats);
+	return stats;
+}
+
 int2 CPathManager::GetNumQueuedUpdates() const {
 	int2 data;
 	data.x = medResPE->updatedBlocks.size();
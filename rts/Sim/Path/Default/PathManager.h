@@ -4,6 +4,8 @@
 #define PATHMANAGER_H
 
 #include <map>
+#include <deque>
+#include <vector>
 #include <boost/cstdint.hpp> /* Replace with <stdint.h> if appropriate */
 
 #include "Sim/Path/IPathManager.h"
@@ -79,6 +81,7 @@ public:
 	const float* GetNodeExtraCosts(bool) const;
 
 	int2 GetNumQueuedUpdates() const;
+	PathCacheStats GetPathCacheStats(bool synced) const;
 
 private:
 	unsigned int RequestPath(
@@ -91,13 +94,15 @@ private:
 	);
 
 	struct MultiPath {
-		MultiPath(const float3& pos, const CPathFinderDef* def, const MoveDef* moveDef)
+		MultiPath(const float3& pos, CPathFinderDef* def, const MoveDef* moveDef)
 			: searchResult(IPath::Error)
 			, start(pos)
 			, peDef(def)
 			, moveDef(moveDef)
 			, finalGoal(ZeroVector)
 			, caller(NULL)
+			, synced(true)
+			, searchQueued(false)
 		{}
 
 		~MultiPath() { delete peDef; }
@@ -110,16 +115,37 @@ private:
 
 		// Request definition
 		const float3 start;
-		const CPathFinderDef* peDef;
+		CPathFinderDef* peDef;
 		const MoveDef* moveDef;
 
 		// Additional information.
 		float3 finalGoal;
 		CSolidObject* caller;
+
+		bool synced;
+		/// true while the request waits in queuedSearches
+		bool searchQueued;
 	};
 
 	inline MultiPath* GetMultiPath(int pathID) const;
 	unsigned int Store(MultiPath* path);
+
+	/// (pathType, med-res goal block index)
+	typedef std::pair<unsigned int, unsigned int> FlowFieldKey;
+
+	struct FlowField {
+		FlowField(): frameNum(-1) {}
+
+		/// cost-to-goal per med-res block, see CPathEstimator::CalcFlowField
+		std::vector<float> costs;
+		int frameNum;
+	};
+
+	FlowFieldKey GetFlowFieldKey(const MultiPath* path) const;
+
+	bool ExecuteSearch(MultiPath* path);
+	bool ExecuteFlowFieldSearch(MultiPath* path, const FlowFieldKey& key);
+	void ExecuteQueuedSearches();
 	void LowRes2MedRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
 	void MedRes2MaxRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
 
@@ -132,6 +158,12 @@ private:
 
 	std::map<unsigned int, MultiPath*> pathMap;
 	unsigned int nextPathID;
+
+	/// ID's of long-range requests not yet searched, in order of arrival
+	std::deque<unsigned int> queuedSearches;
+
+	/// shared fields for groups of queued requests with the same goal
+	std::map<FlowFieldKey, FlowField> flowFields;
 };
 
 inline CPathManager::MultiPath* CPathManager::GetMultiPath(int pathID) const {
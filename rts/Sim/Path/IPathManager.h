@@ -12,6 +12,30 @@
 struct MoveDef;
 class CSolidObject;
 
+/// aggregated counters of a path-manager's result caches
+struct PathCacheStats {
+	PathCacheStats()
+		: numHits(0)
+		, numMisses(0)
+		, numEvictions(0)
+		, numExpirations(0)
+		, numHashCollisions(0)
+		, numItems(0)
+		, memUsage(0)
+		, memBudget(0)
+	{}
+
+	unsigned int numHits;
+	unsigned int numMisses;
+	unsigned int numEvictions;    ///< items dropped to stay within the memory budget
+	unsigned int numExpirations;  ///< items dropped because they became too old
+	unsigned int numHashCollisions;
+	unsigned int numItems;
+
+	unsigned int memUsage;        ///< in bytes
+	unsigned int memBudget;       ///< in bytes
+};
+
 class IPathManager {
 public:
 	static IPathManager* GetInstance(unsigned int type);
@@ -161,6 +185,12 @@ public:
 	virtual const float* GetNodeExtraCosts(bool synced) const { return NULL; }
 
 	virtual int2 GetNumQueuedUpdates() const { return (int2(0, 0)); }
+
+	/**
+	 * Returns the counters of the synced or unsynced path-caches
+	 * (all zero if the implementation does not cache paths).
+	 */
+	virtual PathCacheStats GetPathCacheStats(bool synced) const { return PathCacheStats(); }
 };
 
 extern IPathManager* pathManager;
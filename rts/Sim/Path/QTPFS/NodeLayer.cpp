@@ -78,9 +78,28 @@ void QTPFS::NodeLayer::Clear() {
 
 #ifdef QTPFS_STAGGERED_LAYER_UPDATES
 void QTPFS::NodeLayer::QueueUpdate(const SRectangle& r, const MoveDef* md) {
+	if (!layerUpdates.empty()) {
+		const SRectangle& lr = layerUpdates.back().rectangle;
+		const SRectangle mr(std::min(r.x1, lr.x1), std::min(r.z1, lr.z1), std::max(r.x2, lr.x2), std::max(r.z2, lr.z2));
+
+		// coalesce with the most recently queued (so still pending) update
+		// if the union does not cover more squares than both separately;
+		// nothing is queued behind it so re-snapshotting the terrain state
+		// cannot be overwritten by an older snapshot later on
+		//
+		// this catches eg. the two TerrainChange calls (height-map, then
+		// blocking-map) issued for every placed or destroyed structure
+		if (mr.GetArea() <= (r.GetArea() + lr.GetArea())) {
+			SnapshotUpdate(&layerUpdates.back(), mr, md);
+			return;
+		}
+	}
+
 	layerUpdates.push_back(LayerUpdate());
-	LayerUpdate* layerUpdate = &(layerUpdates.back());
+	SnapshotUpdate(&layerUpdates.back(), r, md);
+}
 
+void QTPFS::NodeLayer::SnapshotUpdate(LayerUpdate* layerUpdate, const SRectangle& r, const MoveDef* md) {
 	// the first update MUST have a non-zero counter
 	// since all nodes are at 0 after initialization
 	layerUpdate->rectangle = r;
@@ -101,6 +101,8 @@ namespace QTPFS {
 		std::vector<SpeedBinType> oldSpeedBins;
 
 		#ifdef QTPFS_STAGGERED_LAYER_UPDATES
+		void SnapshotUpdate(LayerUpdate* layerUpdate, const SRectangle& r, const MoveDef* md);
+
 		std::list<LayerUpdate> layerUpdates;
 		#endif
 
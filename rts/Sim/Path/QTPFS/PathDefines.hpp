@@ -27,6 +27,8 @@
 
 #define QTPFS_CACHE_VERSION 13
 #define QTPFS_CACHE_XACCESS
+// tree cache-files are (de)serialized one node at a time, read them in large chunks
+#define QTPFS_CACHE_STREAM_BUFFER_SIZE (1024 * 1024)
 
 #define QTPFS_POSITIVE_INFINITY (std::numeric_limits<float>::infinity())
 #define QTPFS_CLOSED_NODE_COST (1 << 24)
@@ -133,13 +133,14 @@ QTPFS::PathManager::~PathManager() {
 	nodeLayers.clear();
 	pathCaches.clear();
 	pathSearches.clear();
+	searchBatches.clear();
 	pathTypes.clear();
 	pathTraces.clear();
 
 	numCurrExecutedSearches.clear();
 	numPrevExecutedSearches.clear();
 
-	PathSearch::FreeGlobalQueue();
+	PathSearch::FreeGlobalQueues();
 
 	#ifdef QTPFS_ENABLE_THREADED_UPDATE
 	// at this point the thread is waiting, so notify it
@@ -173,6 +174,7 @@ void QTPFS::PathManager::Load() {
 	nodeLayers.resize(moveDefHandler->GetNumMoveDefs());
 	pathCaches.resize(moveDefHandler->GetNumMoveDefs());
 	pathSearches.resize(moveDefHandler->GetNumMoveDefs());
+	searchBatches.resize(moveDefHandler->GetNumMoveDefs());
 
 	// add one extra element for object-less requests
 	numCurrExecutedSearches.resize(teamHandler->ActiveTeams() + 1, 0);
@@ -220,7 +222,7 @@ void QTPFS::PathManager::Load() {
 		{ SyncedUint tmp(pfsCheckSum); }
 		#endif
 
-		PathSearch::InitGlobalQueue(maxNumLeafNodes);
+		PathSearch::InitGlobalQueues(ThreadPool::GetNumThreads(), maxNumLeafNodes);
 	}
 
 	{
@@ -464,7 +466,11 @@ void QTPFS::PathManager::QueueNodeLayerUpdates(const SRectangle& r) {
 	}
 }
 
+// NOTE: runs concurrently for different layers, must not touch anything outside this layer
 void QTPFS::PathManager::ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool flushQueue) {
+	// reset FPU state for synced computations (we may be on a worker)
+	streflop::streflop_init<streflop::Simple>();
+
 	// flush this layer's entire update-queue if necessary
 	// (otherwise eat through 5 percent of it s.t. updates
 	// do not pile up faster than we consume them)
@@ -529,6 +535,7 @@ void QTPFS::PathManager::Serialize(const std::string& cacheFileDir) {
 	std::vector<std::string> fileNames(nodeTrees.size(), "");
 	std::vector<std::fstream*> fileStreams(nodeTrees.size(), NULL);
 	std::vector<unsigned int> fileSizes(nodeTrees.size(), 0);
+	std::vector<char> streamBuffer(QTPFS_CACHE_STREAM_BUFFER_SIZE);
 
 	if (!haveCacheDir) {
 		FileSystem::CreateDirectory(cacheFileDir);
@@ -549,6 +556,8 @@ void QTPFS::PathManager::Serialize(const std::string& cacheFileDir) {
 
 		fileNames[i] = cacheFileDir + "tree" + IntToString(i, "%02x") + "-" + md->name;
 		fileStreams[i] = new std::fstream();
+		// must precede open() to take effect
+		fileStreams[i]->rdbuf()->pubsetbuf(&streamBuffer[0], streamBuffer.size());
 
 		if (haveCacheDir) {
 			#ifdef QTPFS_CACHE_XACCESS
@@ -704,20 +713,27 @@ void QTPFS::PathManager::ThreadUpdate() {
 		static unsigned int minPathTypeUpdate = 0;
 		static unsigned int maxPathTypeUpdate = numPathTypeUpdates;
 
-		sharedPaths.clear();
-
+		#ifndef QTPFS_IGNORE_DEAD_PATHS
 		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
-			#ifndef QTPFS_IGNORE_DEAD_PATHS
 			QueueDeadPathSearches(pathTypeUpdate);
-			#endif
+		}
+		#endif
 
-			#ifdef QTPFS_STAGGERED_LAYER_UPDATES
-			// NOTE: *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
-			ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
-			#endif
+		#ifdef QTPFS_STAGGERED_LAYER_UPDATES
+		{
+			SCOPED_TIMER("PathManager::ExecQueuedNodeLayerUpdates");
 
-			ExecuteQueuedSearches(pathTypeUpdate);
+			// NOTE:
+			//   *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
+			//   every layer owns its tree, cache and update-queue, so they can be processed
+			//   concurrently (as UpdateNodeLayersThreaded does for non-staggered updates)
+			for_mt(minPathTypeUpdate, maxPathTypeUpdate, [&](const int pathTypeUpdate) {
+				ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
+			});
 		}
+		#endif
+
+		ExecuteQueuedSearches(minPathTypeUpdate, maxPathTypeUpdate);
 
 		std::copy(numCurrExecutedSearches.begin(), numCurrExecutedSearches.end(), numPrevExecutedSearches.begin());
 
@@ -741,65 +757,75 @@ void QTPFS::PathManager::ThreadUpdate() {
 
 
 
-void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
-	NodeLayer& nodeLayer = nodeLayers[pathType];
-	PathCache& pathCache = pathCaches[pathType];
+void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int minPathType, unsigned int maxPathType) {
+	// execute pending searches collected via RequestPath and
+	// QueueDeadPathSearches; layers do not share any nodes so
+	// their searches can run concurrently, everything touching
+	// state shared between layers (team limits, pathTypes, etc)
+	// happens before or after that in queue order
+	for (unsigned int pathType = minPathType; pathType < maxPathType; pathType++) {
+		SelectSearchBatch(pathType);
+	}
 
-	std::list<IPathSearch*>& searches = pathSearches[pathType];
-	std::list<IPathSearch*>::iterator searchesIt = searches.begin();
+	// make sure every worker has its own open-node queue
+	PathSearch::InitGlobalQueues(ThreadPool::GetNumThreads(), maxNumLeafNodes);
 
-	if (!searches.empty()) {
-		// execute pending searches collected via
-		// RequestPath and QueueDeadPathSearches
-		while (searchesIt != searches.end()) {
-			if (ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType)) {
-				searchStateOffset += NODE_STATE_OFFSET;
-			}
-		}
+	for_mt(minPathType, maxPathType, [&](const int pathType) {
+		ExecuteSearchBatch(pathType);
+	});
+
+	for (unsigned int pathType = minPathType; pathType < maxPathType; pathType++) {
+		FinalizeSearchBatch(pathType);
 	}
 }
 
-bool QTPFS::PathManager::ExecuteSearch(
-	PathSearchList& searches,
-	PathSearchListIt& searchesIt,
-	NodeLayer& nodeLayer,
-	PathCache& pathCache,
-	unsigned int pathType
-) {
-	IPathSearch* search = *searchesIt;
-	IPath* path = pathCache.GetTempPath(search->GetID());
+void QTPFS::PathManager::SelectSearchBatch(unsigned int pathType) {
+	NodeLayer& nodeLayer = nodeLayers[pathType];
+	PathCache& pathCache = pathCaches[pathType];
 
-	assert(search != NULL);
-	assert(path != NULL);
+	PathSearchList& searches = pathSearches[pathType];
+	PathSearchListIt searchesIt = searches.begin();
 
-	#define DeleteSearch(s, it) { \
-		*it = NULL;               \
-		it = searches.erase(it);  \
-		delete s;                 \
-	}
+	std::vector<SearchBatchItem>& batch = searchBatches[pathType];
 
-	// temp-path might have been removed already via
-	// DeletePath before we got a chance to process it
-	if (path->GetID() == 0) {
-		DeleteSearch(search, searchesIt);
-		return false;
-	}
+	// maps "hashes" of selected searches to their batch index
+	SharedPathMap sharedPaths;
 
-	assert(search->GetID() != 0);
-	assert(path->GetID() == search->GetID());
+	assert(batch.empty());
 
-	search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
-	path->SetHash(search->GetHash(gs->mapx * gs->mapy, pathType));
+	while (searchesIt != searches.end()) {
+		IPathSearch* search = *searchesIt;
+		IPath* path = pathCache.GetTempPath(search->GetID());
+
+		assert(search != NULL);
+		assert(path != NULL);
+
+		// temp-path might have been removed already via
+		// DeletePath before we got a chance to process it
+		if (path->GetID() == 0) {
+			searchesIt = searches.erase(searchesIt);
+			delete search;
+			continue;
+		}
+
+		assert(search->GetID() != 0);
+		assert(path->GetID() == search->GetID());
+
+		search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
+		path->SetHash(search->GetHash(gs->mapx * gs->mapy, pathType));
+
+		SearchBatchItem item(search, path);
 
-	{
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
+		const SharedPathMapIt sharedPathsIt = sharedPaths.find(path->GetHash());
 
 		if (sharedPathsIt != sharedPaths.end()) {
-			if (search->SharedFinalize(sharedPathsIt->second, path)) {
-				DeleteSearch(search, searchesIt);
-				return false;
-			}
+			// resolved from the earlier search's path after it ran
+			item.sharedItemIdx = sharedPathsIt->second;
+
+			batch.push_back(item);
+			searchesIt = searches.erase(searchesIt);
+			continue;
 		}
 		#endif
 
@@ -808,30 +834,79 @@ bool QTPFS::PathManager::ExecuteSearch(
 		const unsigned int numPrevSearches = numPrevExecutedSearches[search->GetTeam()];
 
 		if ((numCurrSearches - numPrevSearches) >= MAX_TEAM_SEARCHES) {
-			++searchesIt; return false;
+			++searchesIt; continue;
 		}
 
 		numCurrExecutedSearches[search->GetTeam()] += 1;
 		#endif
+
+		item.stateOffset = searchStateOffset;
+		searchStateOffset += NODE_STATE_OFFSET;
+
+		sharedPaths[path->GetHash()] = batch.size();
+
+		batch.push_back(item);
+		searchesIt = searches.erase(searchesIt);
 	}
+}
 
-	// removes path from temp-paths, adds it to live-paths
-	if (search->Execute(searchStateOffset, numTerrainChanges)) {
-		search->Finalize(path);
+// NOTE: runs concurrently for different path-types, must not touch anything outside this layer
+void QTPFS::PathManager::ExecuteSearchBatch(unsigned int pathType) {
+	std::vector<SearchBatchItem>& batch = searchBatches[pathType];
 
-		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		sharedPaths[path->GetHash()] = path;
-		#endif
+	if (batch.empty())
+		return;
 
-		#ifdef QTPFS_TRACE_PATH_SEARCHES
-		pathTraces[path->GetID()] = search->GetExecutionTrace();
-		#endif
-	} else {
-		DeletePath(path->GetID());
+	// reset FPU state for synced computations (we may be on a worker)
+	streflop::streflop_init<streflop::Simple>();
+
+	for (unsigned int n = 0; n < batch.size(); n++) {
+		SearchBatchItem& item = batch[n];
+
+		if (item.sharedItemIdx != -1u)
+			continue;
+
+		// removes path from temp-paths, adds it to live-paths
+		if ((item.result = item.search->Execute(item.stateOffset, numTerrainChanges))) {
+			item.search->Finalize(item.path);
+		}
+	}
+}
+
+void QTPFS::PathManager::FinalizeSearchBatch(unsigned int pathType) {
+	std::vector<SearchBatchItem>& batch = searchBatches[pathType];
+
+	for (unsigned int n = 0; n < batch.size(); n++) {
+		SearchBatchItem& item = batch[n];
+
+		if (item.sharedItemIdx != -1u) {
+			const SearchBatchItem& sharedItem = batch[item.sharedItemIdx];
+
+			item.result = (sharedItem.result && item.search->SharedFinalize(sharedItem.path, item.path));
+
+			if (!item.result) {
+				// path could not be shared (rare), search for it here
+				item.stateOffset = searchStateOffset;
+				searchStateOffset += NODE_STATE_OFFSET;
+
+				if ((item.result = item.search->Execute(item.stateOffset, numTerrainChanges))) {
+					item.search->Finalize(item.path);
+				}
+			}
+		}
+
+		if (item.result) {
+			#ifdef QTPFS_TRACE_PATH_SEARCHES
+			pathTraces[item.path->GetID()] = item.search->GetExecutionTrace();
+			#endif
+		} else {
+			DeletePath(item.path->GetID());
+		}
+
+		delete item.search;
 	}
 
-	DeleteSearch(search, searchesIt);
-	return true;
+	batch.clear();
 }
 
 void QTPFS::PathManager::QueueDeadPathSearches(unsigned int pathType) {
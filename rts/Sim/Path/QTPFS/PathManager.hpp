@@ -85,8 +85,8 @@ namespace QTPFS {
 		typedef std::map<unsigned int, unsigned int>::iterator PathTypeMapIt;
 		typedef std::map<unsigned int, PathSearchTrace::Execution*> PathTraceMap;
 		typedef std::map<unsigned int, PathSearchTrace::Execution*>::iterator PathTraceMapIt;
-		typedef std::map<boost::uint64_t, IPath*> SharedPathMap;
-		typedef std::map<boost::uint64_t, IPath*>::iterator SharedPathMapIt;
+		typedef std::map<boost::uint64_t, unsigned int> SharedPathMap;
+		typedef std::map<boost::uint64_t, unsigned int>::iterator SharedPathMapIt;
 		typedef std::list<IPathSearch*> PathSearchList;
 		typedef std::list<IPathSearch*>::iterator PathSearchListIt;
 
@@ -112,7 +112,27 @@ namespace QTPFS {
 		void ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool flushQueue);
 		#endif
 
-		void ExecuteQueuedSearches(unsigned int pathType);
+		// a search selected for execution during the current update
+		struct SearchBatchItem {
+			SearchBatchItem(IPathSearch* s, IPath* p)
+				: search(s)
+				, path(p)
+				, stateOffset(0)
+				, sharedItemIdx(-1u)
+				, result(false)
+			{}
+
+			IPathSearch* search;
+			IPath* path;
+
+			unsigned int stateOffset;
+			// index of the (earlier) item whose path this one tries to share
+			unsigned int sharedItemIdx;
+
+			bool result;
+		};
+
+		void ExecuteQueuedSearches(unsigned int minPathType, unsigned int maxPathType);
 		void QueueDeadPathSearches(unsigned int pathType);
 
 		unsigned int QueueSearch(
@@ -125,13 +145,9 @@ namespace QTPFS {
 			const bool synced
 		);
 
-		bool ExecuteSearch(
-			PathSearchList& searches,
-			PathSearchListIt& searchesIt,
-			NodeLayer& nodeLayer,
-			PathCache& pathCache,
-			unsigned int pathType
-		);
+		void SelectSearchBatch(unsigned int pathType);
+		void ExecuteSearchBatch(unsigned int pathType);
+		void FinalizeSearchBatch(unsigned int pathType);
 
 
 		std::string GetCacheDirName(boost::uint32_t mapCheckSum, boost::uint32_t modCheckSum) const;
@@ -144,8 +160,8 @@ namespace QTPFS {
 		std::map<unsigned int, unsigned int> pathTypes;
 		std::map<unsigned int, PathSearchTrace::Execution*> pathTraces;
 
-		// maps "hashes" of executed searches to the found paths
-		std::map<boost::uint64_t, IPath*> sharedPaths;
+		// per layer, searches selected by the current update (in queue order)
+		std::vector< std::vector<SearchBatchItem> > searchBatches;
 
 		std::vector<unsigned int> numCurrExecutedSearches;
 		std::vector<unsigned int> numPrevExecutedSearches;
@@ -116,11 +116,11 @@ namespace QTPFS {
 			, curNode(NULL)
 			, nxtNode(NULL)
 			, minNode(NULL)
+			, openNodes(NULL)
 			, hCostMult(0.0f)
 			, haveFullPath(false)
 			, havePartPath(false)
 			{}
-		~PathSearch() { openNodes.reset(); }
 
 		void Initialize(
 			NodeLayer* layer,
@@ -139,8 +139,13 @@ namespace QTPFS {
 
 		const boost::uint64_t GetHash(boost::uint64_t N, boost::uint32_t k) const;
 
-		static void InitGlobalQueue(unsigned int n) { openNodes.reserve(n); }
-		static void FreeGlobalQueue() { openNodes.clear(); }
+		// NOTE: must not be called while any search is executing
+		static void InitGlobalQueues(unsigned int numQueues, unsigned int n) {
+			for (unsigned int i = openNodeQueues.size(); i < numQueues; i++) {
+				openNodeQueues.push_back(binary_heap<INode*>(n));
+			}
+		}
+		static void FreeGlobalQueues() { openNodeQueues.clear(); }
 
 	private:
 		void ResetState(INode* node);
@@ -152,9 +157,10 @@ namespace QTPFS {
 		void TracePath(IPath* path);
 		void SmoothPath(IPath* path);
 
-		// global queue: allocated once, re-used by all searches without clear()'s
+		// global queues (one per thread): allocated once, re-used by all searches
+		// executed on that thread without clear()'s
 		// this relies on INode::operator< to sort the INode*'s by increasing f-cost
-		static binary_heap<INode*> openNodes;
+		static std::vector< binary_heap<INode*> > openNodeQueues;
 
 		NodeLayer* nodeLayer;
 		PathCache* pathCache;
@@ -169,6 +175,9 @@ namespace QTPFS {
 		INode *curNode, *nxtNode;
 		INode *minNode;
 
+		// queue of the thread we are executing on (set by Execute)
+		binary_heap<INode*>* openNodes;
+
 		float3 srcPoint;
 		float3 tgtPoint;
 
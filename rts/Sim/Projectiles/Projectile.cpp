@@ -29,10 +29,12 @@ CR_REG_METADATA(CProjectile,
 		CR_MEMBER(dir),
 	CR_MEMBER_ENDFLAG(CM_Config),
 	CR_MEMBER(drawPos),
+	CR_MEMBER(preFramePos),
 
 	CR_MEMBER(lastProjUpdate),
 	CR_MEMBER(mygravity),
 	CR_IGNORED(tempdist),
+	CR_IGNORED(drawBinIndex),
 
 	CR_MEMBER(ownerID),
 	CR_MEMBER(teamID),
@@ -68,6 +70,7 @@ CProjectile::CProjectile()
 	, castShadow(false)
 
 	, mygravity(mapInfo? mapInfo->map.gravity: 0.0f)
+	, drawBinIndex(-1u)
 
 	, ownerID(-1u)
 	, teamID(-1u)
@@ -102,6 +105,7 @@ CProjectile::CProjectile(
 
 	, dir(ZeroVector) // set via Init()
 	, mygravity(mapInfo? mapInfo->map.gravity: 0.0f)
+	, drawBinIndex(-1u)
 
 	, ownerID(-1u)
 	, teamID(-1u)
@@ -139,6 +143,7 @@ void CProjectile::Init(CUnit* owner, const float3& offset)
 		SetPosition(pos + offset);
 		SetVelocityAndSpeed(speed);
 	}
+	preFramePos = pos;
 	if (!weapon && !piece) {
 		// NOTE:
 		//   new CWeapon- and CPieceProjectile*'s add themselves
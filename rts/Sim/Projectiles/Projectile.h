@@ -126,12 +126,15 @@ public:
 
 	float3 dir;
 	float3 drawPos;
+	float3 preFramePos; ///< pos before the last Update, see CProjectileDrawer::DrawProjectile
 
 	unsigned lastProjUpdate;
 
 	float mygravity;
 	float tempdist; ///< temp distance used for sorting when rendering
 
+	unsigned int drawBinIndex; ///< position in its render bin (unsynced, see IWorldObjectModelRenderer)
+
 protected:
 	unsigned int ownerID;
 	unsigned int teamID;
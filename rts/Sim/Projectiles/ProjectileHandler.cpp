@@ -4,6 +4,7 @@
 
 #include "Projectile.h"
 #include "ProjectileHandler.h"
+#include "Game/GameHelper.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/TraceRay.h"
 #include "Map/Ground.h"
@@ -13,16 +14,18 @@
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Projectiles/Unsynced/FlyingPiece.h"
-#include "Sim/Projectiles/Unsynced/GfxProjectile.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
+#include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
+#include "System/creg/STL_Deque.h"
 #include "System/creg/STL_Map.h"
 #include "System/creg/STL_List.h"
 #include "lib/gml/gmlmut.h"
@@ -103,6 +106,9 @@ CProjectileHandler::CProjectileHandler()
 
 	maxUsedSyncedID = freeSyncedIDs.size();
 	maxUsedUnsyncedID = freeUnsyncedIDs.size();
+
+	syncedProjectileIDs.resize(maxUsedSyncedID + 1, ProjectileMapValPair(NULL, -1));
+	unsyncedProjectileIDs.resize(maxUsedUnsyncedID + 1, ProjectileMapValPair(NULL, -1));
 }
 
 CProjectileHandler::~CProjectileHandler()
@@ -187,15 +193,14 @@ void CProjectileHandler::UpdateProjectileContainer(ProjectileContainer& pc, bool
 		assert(p->synced == !!(p->GetClass()->binder->flags & creg::CF_Synced));
 
 		if (p->deleteMe) {
-			ProjectileMap::iterator pIt;
-
 			if (synced) {
-				//! iterator is always valid
-				pIt = syncedProjectileIDs.find(p->id);
+				//! slot is always valid
+				//! copy, the callin can add projectiles and grow the vector
+				const ProjectileMapValPair pp = syncedProjectileIDs[p->id];
 
-				eventHandler.ProjectileDestroyed((pIt->second).first, (pIt->second).second);
+				eventHandler.ProjectileDestroyed(pp.first, pp.second);
 				syncedRenderProjectileIDs.erase_delete(p);
-				syncedProjectileIDs.erase(pIt);
+				syncedProjectileIDs[p->id] = ProjectileMapValPair(NULL, -1);
 
 				freeSyncedIDs.push_back(p->id);
 
@@ -205,11 +210,12 @@ void CProjectileHandler::UpdateProjectileContainer(ProjectileContainer& pc, bool
 #if UNSYNCED_PROJ_NOEVENT
 				eventHandler.UnsyncedProjectileDestroyed(p);
 #else
-				pIt = unsyncedProjectileIDs.find(p->id);
+				//! copy, the callin can add projectiles and grow the vector
+				const ProjectileMapValPair pp = unsyncedProjectileIDs[p->id];
 
-				eventHandler.ProjectileDestroyed((pIt->second).first, (pIt->second).second);
+				eventHandler.ProjectileDestroyed(pp.first, pp.second);
 				unsyncedRenderProjectileIDs.erase_delete(p);
-				unsyncedProjectileIDs.erase(pIt);
+				unsyncedProjectileIDs[p->id] = ProjectileMapValPair(NULL, -1);
 
 				freeUnsyncedIDs.push_back(p->id);
 #endif
@@ -218,6 +224,7 @@ void CProjectileHandler::UpdateProjectileContainer(ProjectileContainer& pc, bool
 		} else {
 			PROJECTILE_SANITY_CHECK(p);
 
+			p->preFramePos = p->pos;
 			p->Update();
 			quadField->MovedProjectile(p);
 
@@ -282,21 +289,9 @@ void CProjectileHandler::Update()
 			groundFlashes.delay_add();
 		}
 
-		#define UPDATE_FLYING_PIECES(fpContainer)                      \
-			FlyingPieceContainer::iterator pti = fpContainer.begin();  \
-                                                                       \
-			while (pti != fpContainer.end()) {                         \
-				FlyingPiece* p = *pti;                                 \
-				if (!p->Update()) {                                    \
-					pti = fpContainer.erase_delete_set(pti);           \
-				} else {                                               \
-					++pti;                                             \
-				}                                                      \
-			}
-
-		{ UPDATE_FLYING_PIECES(flyingPieces3DO); }
-		{ UPDATE_FLYING_PIECES(flyingPiecesS3O); }
-		#undef UPDATE_FLYING_PIECES
+		UpdateFlyingPieces(flyingPieces3DO);
+		UpdateFlyingPieces(flyingPiecesS3O);
+		UpdateNanoParticles();
 
 		{
 			GML_STDMUTEX_LOCK(rpiece); // Update
@@ -316,8 +311,8 @@ void CProjectileHandler::AddProjectile(CProjectile* p)
 	// already initialized?
 	assert(p->id < 0);
 
-	std::list<int>* freeIDs = NULL;
-	ProjectileMap* proIDs = NULL;
+	std::deque<int>* freeIDs = NULL;
+	ProjectileIDVector* proIDs = NULL;
 	ProjectileRenderMap* newProIDs = NULL;
 
 	int* maxUsedID = NULL;
@@ -363,9 +358,11 @@ void CProjectileHandler::AddProjectile(CProjectile* p)
 	p->id = newUsedID;
 
 	const ProjectileMapValPair vp(p, p->owner() ? p->owner()->allyteam : -1);
-	const ProjectileMapKeyPair kp(p->id, vp);
 
-	proIDs->insert(kp);
+	if (p->id >= int(proIDs->size()))
+		proIDs->resize(p->id + 1, ProjectileMapValPair(NULL, -1));
+
+	(*proIDs)[p->id] = vp;
 	newProIDs->push(p, vp);
 
 	eventHandler.ProjectileCreated(vp.first, vp.second);
@@ -463,8 +460,8 @@ void CProjectileHandler::CheckFeatureCollisions(
 }
 
 void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc) {
-	static std::vector<CUnit*> tempUnits(unitHandler->MaxUnits(), NULL);
-	static std::vector<CFeature*> tempFeatures(unitHandler->MaxUnits(), NULL);
+	colProjectiles.clear();
+	colGroundPositions.clear();
 
 	for (ProjectileContainer::iterator pci = pc.begin(); pci != pc.end(); ++pci) {
 		CProjectile* p = *pci;
@@ -472,20 +469,43 @@ void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc) {
 		if (!p->checkCol) continue;
 		if ( p->deleteMe) continue;
 
+		colProjectiles.push_back(p);
+	}
+
+	if (colCandidates.size() < colProjectiles.size())
+		colCandidates.resize(colProjectiles.size());
+
+	// broad-phase does not modify anything, so gather the candidate
+	// objects for all projectiles in parallel (object positions only
+	// change in the unit/feature updates, not during this pass)
+	for_mt(0, colProjectiles.size(), [&](const int i) {
+		const CProjectile* p = colProjectiles[i];
+		CollisionCandidates& cc = colCandidates[i];
+
+		quadField->GetUnitsAndFeaturesColVolMT(p->pos, p->radius + p->speed.w, cc.quads, cc.units, cc.features);
+	});
+
+	// narrow-phase and collision responses stay serial and in container
+	// order, exactly as before, so the outcome remains synced
+	for (unsigned int i = 0; i < colProjectiles.size(); i++) {
+		CProjectile* p = colProjectiles[i];
+		CollisionCandidates& cc = colCandidates[i];
+
+		if (!p->checkCol) continue;
+		if ( p->deleteMe) continue;
+
 		const float3 ppos0 = p->pos;
 		const float3 ppos1 = p->pos + p->speed;
 
-		quadField->GetUnitsAndFeaturesColVol(p->pos, p->radius + p->speed.w, tempUnits, tempFeatures);
-
-		CheckUnitCollisions(p, tempUnits, ppos0, ppos1);
-		CheckFeatureCollisions(p, tempFeatures, ppos0, ppos1);
+		CheckUnitCollisions(p, cc.units, ppos0, ppos1);
+		CheckFeatureCollisions(p, cc.features, ppos0, ppos1);
 	}
 }
 
 void CProjectileHandler::CheckGroundCollisions(ProjectileContainer& pc) {
-	ProjectileContainer::iterator pci;
+	colProjectiles.clear();
 
-	for (pci = pc.begin(); pci != pc.end(); ++pci) {
+	for (ProjectileContainer::iterator pci = pc.begin(); pci != pc.end(); ++pci) {
 		CProjectile* p = *pci;
 
 		if (!p->checkCol)
@@ -496,9 +516,27 @@ void CProjectileHandler::CheckGroundCollisions(ProjectileContainer& pc) {
 		if (p->GetCollisionFlags() & Collision::NOGROUND)
 			continue;
 
+		colProjectiles.push_back(p);
+		colGroundPositions.push_back(p->pos);
+	}
+
+	colGroundHeights.resize(colProjectiles.size());
+
+	// terrain changes from explosions are deferred to CBasicMapDamage::Update
+	// heights are sampled in blocks so each thread runs the batch sampler
+	static const int blockSize = 256;
+	const int numPositions = colGroundPositions.size();
+
+	for_mt(0, numPositions, blockSize, [&](const int i) {
+		ground->GetHeightsReal(&colGroundPositions[i], std::min(blockSize, numPositions - i), &colGroundHeights[i]);
+	});
+
+	for (unsigned int i = 0; i < colProjectiles.size(); i++) {
+		CProjectile* p = colProjectiles[i];
+
 		// NOTE: don't add p->radius to groundHeight, or most
 		// projectiles will collide with the ground too early
-		const float groundHeight = ground->GetHeightReal(p->pos.x, p->pos.z);
+		const float groundHeight = colGroundHeights[i];
 		const bool belowGround = (p->pos.y < groundHeight);
 		const bool insideWater = (p->pos.y <= 0.0f && !belowGround);
 		const bool ignoreWater = p->ignoreWater;
@@ -518,15 +556,74 @@ void CProjectileHandler::CheckCollisions()
 {
 	SCOPED_TIMER("ProjectileHandler::CheckCollisions");
 
+	if (modInfo.batchExplosionDamage)
+		helper->BeginExplosionBatch();
+
 	CheckUnitFeatureCollisions(syncedProjectiles); //! changes simulation state
 	CheckUnitFeatureCollisions(unsyncedProjectiles); //! does not change simulation state
 
 	CheckGroundCollisions(syncedProjectiles); //! changes simulation state
 	CheckGroundCollisions(unsyncedProjectiles); //! does not change simulation state
+
+	//! no-op unless batching
+	helper->FlushExplosionBatch();
 }
 
 
 
+void CProjectileHandler::UpdateFlyingPieces(FlyingPieceContainer& fpContainer)
+{
+	fpUpdatePieces.clear();
+	fpUpdatePieces.insert(fpUpdatePieces.end(), fpContainer.begin(), fpContainer.end());
+	fpUpdateAlive.resize(fpUpdatePieces.size());
+
+	// pieces are unsynced and independent of each other (they only read
+	// the heightmap), so a mass of them after big explosions is moved in
+	// parallel; dead ones are then erased here in container order
+	static const int blockSize = 128;
+	const int numPieces = fpUpdatePieces.size();
+
+	for_mt(0, numPieces, blockSize, [&](const int i) {
+		const int j = std::min(i + blockSize, numPieces);
+
+		for (int k = i; k < j; k++) {
+			fpUpdateAlive[k] = fpUpdatePieces[k]->Update();
+		}
+	});
+
+	FlyingPieceContainer::iterator pti = fpContainer.begin();
+
+	for (unsigned int i = 0; pti != fpContainer.end(); i++) {
+		assert(*pti == fpUpdatePieces[i]);
+
+		if (!fpUpdateAlive[i]) {
+			pti = fpContainer.erase_delete_set(pti);
+		} else {
+			++pti;
+		}
+	}
+}
+
+
+void CProjectileHandler::UpdateNanoParticles()
+{
+	GML_STDMUTEX_LOCK(rpiece); // UpdateNanoParticles
+
+	// order does not matter (particles are not z-sorted among
+	// themselves), so dead ones are swapped out with the last
+	for (size_t n = 0; n < nanoParticles.size(); ) {
+		if (gs->frameNum >= nanoParticles[n].deathFrame) {
+			nanoParticles[n] = nanoParticles.back();
+			nanoParticles.pop_back();
+		} else {
+			++n;
+		}
+	}
+
+	currentNanoParticles = nanoParticles.size();
+}
+
+
 void CProjectileHandler::AddGroundFlash(CGroundFlash* flash)
 {
 	groundFlashes.push(flash);
@@ -586,7 +683,7 @@ void CProjectileHandler::AddNanoParticle(
 		color = float3(tcol[0] / 255.0f, tcol[1] / 255.0f, tcol[2] / 255.0f);
 	}
 
-	new CGfxProjectile(startPos, dif, int(l), color);
+	CreateNanoParticle(startPos, dif, int(l), color);
 }
 
 void CProjectileHandler::AddNanoParticle(
@@ -619,12 +716,30 @@ void CProjectileHandler::AddNanoParticle(
 	}
 
 	if (inverse) {
-		new CGfxProjectile(startPos + (dif + error) * l, -(dif + error) * 3, int(l / 3), color);
+		CreateNanoParticle(startPos + (dif + error) * l, -(dif + error) * 3, int(l / 3), color);
 	} else {
-		new CGfxProjectile(startPos, (dif + error) * 3, int(l / 3), color);
+		CreateNanoParticle(startPos, (dif + error) * 3, int(l / 3), color);
 	}
 }
 
+void CProjectileHandler::CreateNanoParticle(const float3& pos, const float3& speed, int lifeTime, const float3& color)
+{
+	NanoParticle p;
+	p.startPos = pos;
+	p.speed = speed;
+	p.creationFrame = gs->frameNum;
+	p.deathFrame = gs->frameNum + lifeTime;
+	p.color[0] = (unsigned char) (color[0] * 255);
+	p.color[1] = (unsigned char) (color[1] * 255);
+	p.color[2] = (unsigned char) (color[2] * 255);
+	p.color[3] = 20;
+
+	GML_STDMUTEX_LOCK(rpiece); // CreateNanoParticle
+
+	nanoParticles.push_back(p);
+	currentNanoParticles = nanoParticles.size();
+}
+
 bool CProjectileHandler::RenderAccess(const CProjectile* p) const {
 	const ProjectileMap* pmap = NULL;
 
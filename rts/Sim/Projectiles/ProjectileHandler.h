@@ -3,6 +3,7 @@
 #ifndef PROJECTILE_HANDLER_H
 #define PROJECTILE_HANDLER_H
 
+#include <deque>
 #include <list>
 #include <set>
 #include <vector>
@@ -30,9 +31,27 @@ struct SS3OVertex;
 
 
 
+/**
+ * Nano-spray particle; these only fly in a straight line and are never
+ * referenced by anything else, so (unlike other unsynced projectiles)
+ * they are kept by value and their position is derived from the frame
+ * when drawn instead of being stepped every update.
+ */
+struct NanoParticle {
+	float3 startPos;
+	float3 speed;
+
+	int creationFrame;
+	int deathFrame;
+
+	unsigned char color[4];
+};
+
+
 typedef std::pair<CProjectile*, int> ProjectileMapValPair;
 typedef std::pair<int, ProjectileMapValPair> ProjectileMapKeyPair;
 typedef std::map<int, ProjectileMapValPair> ProjectileMap;
+typedef std::vector<ProjectileMapValPair> ProjectileIDVector;
 
 typedef ThreadListSim<std::list<CProjectile*>, std::set<CProjectile*>, CProjectile*, ProjectileDetacher> ProjectileContainer;
 typedef ThreadListSimRender<std::list<CGroundFlash*>, std::set<CGroundFlash*>, CGroundFlash*> GroundFlashContainer;
@@ -57,28 +76,20 @@ public:
 	void PostLoad();
 
 	inline const ProjectileMapValPair* GetMapPairBySyncedID(int id) const {
-		const bool renderAccess = (GML::SimEnabled() && !Threading::IsSimThread());
-		const ProjectileMap& projectileIDs = renderAccess ? syncedRenderProjectileIDs.get_render_map() : syncedProjectileIDs;
-		const ProjectileMap::const_iterator it = projectileIDs.find(id);
+		if (GML::SimEnabled() && !Threading::IsSimThread())
+			return GetRenderMapPair(syncedRenderProjectileIDs.get_render_map(), id);
 
-		if (it == projectileIDs.end())
-			return NULL;
-
-		return &(it->second);
+		return GetMapPair(syncedProjectileIDs, id);
 	}
 
 	inline const ProjectileMapValPair* GetMapPairByUnsyncedID(int id) const {
 		if (UNSYNCED_PROJ_NOEVENT)
 			return NULL; // unsynced projectiles have no IDs if UNSYNCED_PROJ_NOEVENT
 
-		const bool renderAccess = (GML::SimEnabled() && !Threading::IsSimThread());
-		const ProjectileMap& projectileIDs = renderAccess ? unsyncedRenderProjectileIDs.get_render_map() : unsyncedProjectileIDs;
-		const ProjectileMap::const_iterator it = projectileIDs.find(id);
+		if (GML::SimEnabled() && !Threading::IsSimThread())
+			return GetRenderMapPair(unsyncedRenderProjectileIDs.get_render_map(), id);
 
-		if (it == projectileIDs.end())
-			return NULL;
-
-		return &(it->second);
+		return GetMapPair(unsyncedProjectileIDs, id);
 	}
 
 	ProjectileRenderMap& GetSyncedRenderProjectileIDs() { return syncedRenderProjectileIDs; }
@@ -112,6 +123,7 @@ public:
 	FlyingPieceContainer flyingPieces3DO;     // unsynced
 	FlyingPieceContainer flyingPiecesS3O;     // unsynced
 	GroundFlashContainer groundFlashes;       // unsynced
+	std::vector<NanoParticle> nanoParticles;  // unsynced, access guarded by rpiece mutex
 
 	int maxParticles;              // different effects should start to cut down on unnececary(unsynced) particles when this number is reached
 	int maxNanoParticles;
@@ -121,16 +133,53 @@ public:
 
 private:
 	void UpdateProjectileContainer(ProjectileContainer&, bool);
+	void UpdateFlyingPieces(FlyingPieceContainer&);
+	void UpdateNanoParticles();
+	void CreateNanoParticle(const float3& pos, const float3& speed, int lifeTime, const float3& color);
+
+	static const ProjectileMapValPair* GetMapPair(const ProjectileIDVector& projectileIDs, int id) {
+		if (id < 0 || id >= int(projectileIDs.size()))
+			return NULL;
+		if (projectileIDs[id].first == NULL)
+			return NULL;
+
+		return &projectileIDs[id];
+	}
+	static const ProjectileMapValPair* GetRenderMapPair(const ProjectileMap& projectileIDs, int id) {
+		const ProjectileMap::const_iterator it = projectileIDs.find(id);
+
+		if (it == projectileIDs.end())
+			return NULL;
+
+		return &(it->second);
+	}
+
+	// per-projectile broad-phase results, computed in parallel
+	struct CollisionCandidates {
+		std::vector<int> quads;
+		std::vector<CUnit*> units;
+		std::vector<CFeature*> features;
+	};
+
+	// scratch buffers for CheckCollisions, reused between frames
+	std::vector<CProjectile*> colProjectiles;
+	std::vector<CollisionCandidates> colCandidates;
+	std::vector<float3> colGroundPositions;
+	std::vector<float> colGroundHeights;
+
+	// scratch buffers for UpdateFlyingPieces
+	std::vector<FlyingPiece*> fpUpdatePieces;
+	std::vector<unsigned char> fpUpdateAlive;
 
 	ProjectileRenderMap syncedRenderProjectileIDs;        // same as syncedProjectileIDs, used by render thread
 	ProjectileRenderMap unsyncedRenderProjectileIDs;      // same as unsyncedProjectileIDs, used by render thread
 
 	int maxUsedSyncedID;
 	int maxUsedUnsyncedID;
-	std::list<int> freeSyncedIDs;             // available synced (weapon, piece) projectile ID's
-	std::list<int> freeUnsyncedIDs;           // available unsynced projectile ID's
-	ProjectileMap syncedProjectileIDs;        // ID ==> <projectile, allyteam> map for living synced projectiles
-	ProjectileMap unsyncedProjectileIDs;      // ID ==> <projectile, allyteam> map for living unsynced projectiles
+	std::deque<int> freeSyncedIDs;            // available synced (weapon, piece) projectile ID's
+	std::deque<int> freeUnsyncedIDs;          // available unsynced projectile ID's
+	ProjectileIDVector syncedProjectileIDs;   // ID ==> <projectile, allyteam> for living synced projectiles (<NULL, -1> if unused)
+	ProjectileIDVector unsyncedProjectileIDs; // ID ==> <projectile, allyteam> for living unsynced projectiles (<NULL, -1> if unused)
 };
 
 
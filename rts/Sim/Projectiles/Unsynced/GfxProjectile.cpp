@@ -8,7 +8,6 @@
 #include "Rendering/Textures/TextureAtlas.h"
 #include "Rendering/Colors.h"
 #include "Sim/Misc/GlobalSynced.h"
-#include "Sim/Projectiles/ProjectileHandler.h"
 
 CR_BIND_DERIVED(CGfxProjectile, CProjectile, );
 
@@ -44,17 +43,10 @@ CGfxProjectile::CGfxProjectile(const float3& pos, const float3& speed, int lifeT
 	this->color[2] = (unsigned char) (color[2] * 255);
 	this->color[3] = 20;
 	drawRadius = 3;
-
-	if (projectileHandler != NULL) {
-		projectileHandler->currentNanoParticles += 1;
-	}
 }
 
 CGfxProjectile::~CGfxProjectile()
 {
-	if (projectileHandler != NULL) {
-		projectileHandler->currentNanoParticles -= 1;
-	}
 }
 
 
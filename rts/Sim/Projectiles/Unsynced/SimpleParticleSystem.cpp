@@ -36,24 +36,14 @@ CR_REG_METADATA(CSimpleParticleSystem,
 		CR_MEMBER(sizeGrowth),
 		CR_MEMBER(sizeMod),
 	CR_MEMBER_ENDFLAG(CM_Config),
-	CR_MEMBER(particles),
+	CR_MEMBER(particlePositions),
+	CR_MEMBER(particleSpeeds),
+	CR_MEMBER(particleLifes),
+	CR_MEMBER(particleDecayRates),
+	CR_MEMBER(particleSizes),
 	CR_RESERVED(16)
 ));
 
-CR_BIND(CSimpleParticleSystem::Particle, );
-
-CR_REG_METADATA_SUB(CSimpleParticleSystem, Particle,
-(
-	CR_MEMBER(pos),
-	CR_MEMBER(life),
-	CR_MEMBER(speed),
-	CR_MEMBER(decayrate),
-	CR_MEMBER(size),
-	CR_MEMBER(sizeGrowth),
-	CR_MEMBER(sizeMod),
-	CR_RESERVED(8)
-));
-
 CSimpleParticleSystem::CSimpleParticleSystem()
 	: CProjectile()
 	, emitVector(ZeroVector)
@@ -83,80 +73,105 @@ void CSimpleParticleSystem::Draw()
 {
 	inArray = true;
 
-	va->EnlargeArrays(numParticles * 4, 0, VA_SIZE_TC);
+	const unsigned int numLiveParticles = particlePositions.size();
+
+	va->EnlargeArrays(numLiveParticles * 4, 0, VA_SIZE_TC);
 
 	if (directional) {
-		for (int i = 0; i < numParticles; i++) {
-			const Particle* p = &particles[i];
-
-			if (p->life < 1.0f) {
-				const float3 zdir = (p->pos - camera->GetPos()).SafeANormalize();
-				const float3 ydir = (zdir.cross(p->speed)).SafeANormalize();
-				const float3 xdir = (zdir.cross(ydir));
-
-				const float3 interPos = p->pos + p->speed * globalRendering->timeOffset;
-				const float size = p->size;
-
-				unsigned char color[4];
-				colorMap->GetColor(color, p->life);
-
-				if (p->speed.SqLength() > 0.001f) {
-					va->AddVertexQTC(interPos - ydir * size - xdir * size, texture->xstart, texture->ystart, color);
-					va->AddVertexQTC(interPos - ydir * size + xdir * size, texture->xend,   texture->ystart, color);
-					va->AddVertexQTC(interPos + ydir * size + xdir * size, texture->xend,   texture->yend,   color);
-					va->AddVertexQTC(interPos + ydir * size - xdir * size, texture->xstart, texture->yend,   color);
-				} else {
-					// in this case the particle's coor-system is degenerate
-					va->AddVertexQTC(interPos - camera->up * size - camera->right * size, texture->xstart, texture->ystart, color);
-					va->AddVertexQTC(interPos - camera->up * size + camera->right * size, texture->xend,   texture->ystart, color);
-					va->AddVertexQTC(interPos + camera->up * size + camera->right * size, texture->xend,   texture->yend,   color);
-					va->AddVertexQTC(interPos + camera->up * size - camera->right * size, texture->xstart, texture->yend,   color);
-				}
+		for (unsigned int i = 0; i < numLiveParticles; i++) {
+			const float3& pPos = particlePositions[i];
+			const float3& pSpeed = particleSpeeds[i];
+
+			const float3 zdir = (pPos - camera->GetPos()).SafeANormalize();
+			const float3 ydir = (zdir.cross(pSpeed)).SafeANormalize();
+			const float3 xdir = (zdir.cross(ydir));
+
+			const float3 interPos = pPos + pSpeed * globalRendering->timeOffset;
+			const float size = particleSizes[i];
+
+			unsigned char color[4];
+			colorMap->GetColor(color, particleLifes[i]);
+
+			if (pSpeed.SqLength() > 0.001f) {
+				va->AddVertexQTC(interPos - ydir * size - xdir * size, texture->xstart, texture->ystart, color);
+				va->AddVertexQTC(interPos - ydir * size + xdir * size, texture->xend,   texture->ystart, color);
+				va->AddVertexQTC(interPos + ydir * size + xdir * size, texture->xend,   texture->yend,   color);
+				va->AddVertexQTC(interPos + ydir * size - xdir * size, texture->xstart, texture->yend,   color);
+			} else {
+				// in this case the particle's coor-system is degenerate
+				va->AddVertexQTC(interPos - camera->up * size - camera->right * size, texture->xstart, texture->ystart, color);
+				va->AddVertexQTC(interPos - camera->up * size + camera->right * size, texture->xend,   texture->ystart, color);
+				va->AddVertexQTC(interPos + camera->up * size + camera->right * size, texture->xend,   texture->yend,   color);
+				va->AddVertexQTC(interPos + camera->up * size - camera->right * size, texture->xstart, texture->yend,   color);
 			}
 		}
 	} else {
-		for (int i = 0; i < numParticles; i++) {
-			const Particle* p = &particles[i];
-
-			if (p->life < 1.0f) {
-				unsigned char color[4];
-				colorMap->GetColor(color, p->life);
-
-				const float3 interPos = p->pos + p->speed * globalRendering->timeOffset;
-				const float3 cameraRight = camera->right * p->size;
-				const float3 cameraUp    = camera->up * p->size;
-
-				va->AddVertexQTC(interPos - cameraRight - cameraUp, texture->xstart, texture->ystart, color);
-				va->AddVertexQTC(interPos + cameraRight - cameraUp, texture->xend,   texture->ystart, color);
-				va->AddVertexQTC(interPos + cameraRight + cameraUp, texture->xend,   texture->yend,   color);
-				va->AddVertexQTC(interPos - cameraRight + cameraUp, texture->xstart, texture->yend,   color);
-			}
+		for (unsigned int i = 0; i < numLiveParticles; i++) {
+			unsigned char color[4];
+			colorMap->GetColor(color, particleLifes[i]);
+
+			const float3 interPos = particlePositions[i] + particleSpeeds[i] * globalRendering->timeOffset;
+			const float3 cameraRight = camera->right * particleSizes[i];
+			const float3 cameraUp    = camera->up * particleSizes[i];
+
+			va->AddVertexQTC(interPos - cameraRight - cameraUp, texture->xstart, texture->ystart, color);
+			va->AddVertexQTC(interPos + cameraRight - cameraUp, texture->xend,   texture->ystart, color);
+			va->AddVertexQTC(interPos + cameraRight + cameraUp, texture->xend,   texture->yend,   color);
+			va->AddVertexQTC(interPos - cameraRight + cameraUp, texture->xstart, texture->yend,   color);
 		}
 	}
 }
 
 void CSimpleParticleSystem::Update()
 {
-	deleteMe = true;
+	const unsigned int numLiveParticles = particlePositions.size();
 
-	for (int i = 0; i < numParticles; i++) {
-		if (particles[i].life < 1.0f) {
-			particles[i].pos += particles[i].speed;
-			particles[i].speed += gravity;
-			particles[i].speed *= airdrag;
-			particles[i].life += particles[i].decayrate;
-			particles[i].size = particles[i].size * sizeMod + sizeGrowth;
-
-			deleteMe = false;
+	// every particle in the arrays is alive, so no per-element branches here
+	for (unsigned int i = 0; i < numLiveParticles; i++) {
+		particlePositions[i] += particleSpeeds[i];
+		particleSpeeds[i] = (particleSpeeds[i] + gravity) * airdrag;
+	}
+	for (unsigned int i = 0; i < numLiveParticles; i++) {
+		particleLifes[i] += particleDecayRates[i];
+		particleSizes[i] = particleSizes[i] * sizeMod + sizeGrowth;
+	}
+
+	// drop the particles that just expired, keeping the draw-order
+	unsigned int numKeptParticles = 0;
+
+	for (unsigned int i = 0; i < numLiveParticles; i++) {
+		if (particleLifes[i] >= 1.0f)
+			continue;
+
+		if (i != numKeptParticles) {
+			particlePositions[numKeptParticles] = particlePositions[i];
+			particleSpeeds[numKeptParticles] = particleSpeeds[i];
+			particleLifes[numKeptParticles] = particleLifes[i];
+			particleDecayRates[numKeptParticles] = particleDecayRates[i];
+			particleSizes[numKeptParticles] = particleSizes[i];
 		}
+
+		numKeptParticles++;
 	}
+
+	particlePositions.resize(numKeptParticles);
+	particleSpeeds.resize(numKeptParticles);
+	particleLifes.resize(numKeptParticles);
+	particleDecayRates.resize(numKeptParticles);
+	particleSizes.resize(numKeptParticles);
+
+	deleteMe = (numKeptParticles == 0);
 }
 
 void CSimpleParticleSystem::Init(CUnit* owner, const float3& offset)
 {
 	CProjectile::Init(owner, offset);
 
-	particles.resize(numParticles);
+	particlePositions.resize(numParticles, offset);
+	particleSpeeds.resize(numParticles);
+	particleLifes.resize(numParticles, 0.0f);
+	particleDecayRates.resize(numParticles);
+	particleSizes.resize(numParticles);
 
 	const float3 up = emitVector;
 	const float3 right = up.cross(float3(up.y, up.z, -up.x));
@@ -176,11 +191,9 @@ void CSimpleParticleSystem::Init(CUnit* owner, const float3& offset)
 		float az = gu->RandFloat() * 2 * PI;
 		float ay = (emitRot + (emitRotSpread * gu->RandFloat())) * (PI / 180.0);
 
-		particles[i].pos = offset;
-		particles[i].speed = ((up * emitMul.y) * math::cos(ay) - ((right * emitMul.x) * math::cos(az) - (forward * emitMul.z) * math::sin(az)) * math::sin(ay)) * (particleSpeed + (gu->RandFloat() * particleSpeedSpread));
-		particles[i].life = 0;
-		particles[i].decayrate = 1.0f / (particleLife + (gu->RandFloat() * particleLifeSpread));
-		particles[i].size = particleSize + gu->RandFloat()*particleSizeSpread;
+		particleSpeeds[i] = ((up * emitMul.y) * math::cos(ay) - ((right * emitMul.x) * math::cos(az) - (forward * emitMul.z) * math::sin(az)) * math::sin(ay)) * (particleSpeed + (gu->RandFloat() * particleSpeedSpread));
+		particleDecayRates[i] = 1.0f / (particleLife + (gu->RandFloat() * particleLifeSpread));
+		particleSizes[i] = particleSize + gu->RandFloat()*particleSizeSpread;
 	}
 
 	drawRadius = (particleSpeed + particleSpeedSpread) * (particleLife * particleLifeSpread);
@@ -13,11 +13,10 @@ class CColorMap;
 class CSimpleParticleSystem : public CProjectile
 {
 	CR_DECLARE(CSimpleParticleSystem);
-	CR_DECLARE_SUB(Particle);
 
 public:
 	CSimpleParticleSystem();
-	virtual ~CSimpleParticleSystem() { particles.clear(); }
+	virtual ~CSimpleParticleSystem() {}
 
 	virtual void Draw();
 	virtual void Update();
@@ -47,22 +46,14 @@ protected:
 
 	int numParticles;
 
-	struct Particle
-	{
-		CR_DECLARE_STRUCT(Particle);
-
-		float3 pos;
-		float3 speed;
-
-		float life;
-		float decayrate;
-		float size;
-		float sizeGrowth;
-		float sizeMod;
-	};
-
 protected:
-	 std::vector<Particle> particles;
+	// live particles only, one array per attribute (dead ones are compacted
+	// away in Update) so the update loop streams through contiguous floats
+	std::vector<float3> particlePositions;
+	std::vector<float3> particleSpeeds;
+	std::vector<float> particleLifes;
+	std::vector<float> particleDecayRates;
+	std::vector<float> particleSizes;
 };
 
 /**
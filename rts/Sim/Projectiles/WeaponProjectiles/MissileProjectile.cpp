@@ -154,12 +154,11 @@ void CMissileProjectile::Update()
 				speed.w += weaponDef->weaponacceleration;
 
 			if (weaponDef->tracks && target != NULL) {
-				const CSolidObject* so = dynamic_cast<const CSolidObject*>(target);
-				const CWeaponProjectile* po = dynamic_cast<const CWeaponProjectile*>(target);
-
 				targetPos = target->pos;
 
-				if (so != NULL) {
+				if ((targetType & TARGET_TYPE_SOLID) != 0) {
+					const CSolidObject* so = static_cast<const CSolidObject*>(target);
+
 					targetPos = so->aimPos;
 					targetVel = so->speed;
 
@@ -167,15 +166,13 @@ void CMissileProjectile::Update()
 						// if we have an owner and our target is a unit,
 						// set target-position to its error-position for
 						// our owner's allyteam
-						const CUnit* u = dynamic_cast<const CUnit*>(so);
-
-						if (u != NULL) {
-							targetPos = u->GetErrorPos(owner()->allyteam, true);
+						if ((targetType & TARGET_TYPE_UNIT) != 0) {
+							targetPos = static_cast<const CUnit*>(so)->GetErrorPos(owner()->allyteam, true);
 						}
 					}
 				}
-				if (po != NULL) {
-					targetVel = po->speed;
+				if ((targetType & TARGET_TYPE_PROJECTILE) != 0) {
+					targetVel = static_cast<const CWeaponProjectile*>(target)->speed;
 				}
 			}
 
@@ -186,10 +186,9 @@ void CStarburstProjectile::Update()
 
 	if (target != NULL && owner() != NULL && weaponDef->tracks) {
 		targetPos = target->pos;
-		CUnit* u = dynamic_cast<CUnit*>(target);
 
-		if (u != NULL) {
-			targetPos = u->GetErrorPos(owner()->allyteam, true);
+		if ((targetType & TARGET_TYPE_UNIT) != 0) {
+			targetPos = static_cast<const CUnit*>(target)->GetErrorPos(owner()->allyteam, true);
 		}
 	}
 
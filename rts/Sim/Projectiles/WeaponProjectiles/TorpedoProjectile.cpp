@@ -77,25 +77,22 @@ void CTorpedoProjectile::Update()
 					speed.w += std::max(0.2f, tracking);
 
 				if (target != NULL) {
-					const CSolidObject* so = dynamic_cast<const CSolidObject*>(target);
-					const CWeaponProjectile* po = dynamic_cast<const CWeaponProjectile*>(target);
-
 					targetPos = target->pos;
 
-					if (so != NULL) {
+					if ((targetType & TARGET_TYPE_SOLID) != 0) {
+						const CSolidObject* so = static_cast<const CSolidObject*>(target);
+
 						targetPos = so->aimPos;
 						targetVel = so->speed;
 
 						if (owner() != NULL && pos.SqDistance(so->aimPos) > Square(150.0f)) {
-							const CUnit* u = dynamic_cast<const CUnit*>(so);
-
-							if (u != NULL) {
-								targetPos = u->GetErrorPos(owner()->allyteam, true);
+							if ((targetType & TARGET_TYPE_UNIT) != 0) {
+								targetPos = static_cast<const CUnit*>(so)->GetErrorPos(owner()->allyteam, true);
 							}
 						}
 					}
-					if (po != NULL) {
-						targetVel = po->speed;
+					if ((targetType & TARGET_TYPE_PROJECTILE) != 0) {
+						targetVel = static_cast<const CWeaponProjectile*>(target)->speed;
 					}
 				}
 
@@ -12,7 +12,10 @@
 #include "Sim/Misc/QuadField.h"
 #include "Map/Ground.h"
 #include "System/Matrix44f.h"
+#include "System/MemPool.h"
 
+// larger than any of the CWeaponProjectile subclasses
+#define MAX_WEAPON_PROJECTILE_SIZE 1024
 
 
 CR_BIND_DERIVED(CWeaponProjectile, CProjectile, );
@@ -22,6 +25,7 @@ CR_REG_METADATA(CWeaponProjectile,(
 	CR_MEMBER(targeted),
 	CR_IGNORED(weaponDef), //PostLoad
 	CR_MEMBER(target),
+	CR_MEMBER(targetType),
 	CR_MEMBER(targetPos),
 	CR_MEMBER(startPos),
 	CR_MEMBER(ttl),
@@ -32,10 +36,23 @@ CR_REG_METADATA(CWeaponProjectile,(
 
 
 
+#if !(defined(USE_GML) && GML_ENABLE_SIM)
+static CMemPool weaponProjectileMemPool("projectiles", MAX_WEAPON_PROJECTILE_SIZE);
+
+void* CWeaponProjectile::operator new(size_t size) { return weaponProjectileMemPool.Alloc(size); }
+// NOTE:
+//   instances created by creg on load come from ::operator new, but have
+//   the exact size of their class and so are simply adopted by the pool
+void CWeaponProjectile::operator delete(void* p, size_t size) { weaponProjectileMemPool.Free(p, size); }
+#endif
+
+
+
 CWeaponProjectile::CWeaponProjectile(): CProjectile()
 	, weaponDef(NULL)
 	, target(NULL)
 
+	, targetType(0)
 	, weaponDefID(0)
 
 	, ttl(0)
@@ -51,6 +68,7 @@ CWeaponProjectile::CWeaponProjectile(const ProjectileParams& params)
 	, weaponDef(params.weaponDef)
 	, target(params.target)
 
+	, targetType(GetTargetType(params.target))
 	, weaponDefID(-1u)
 
 	, ttl(params.ttl)
@@ -94,13 +112,11 @@ CWeaponProjectile::CWeaponProjectile(const ProjectileParams& params)
 	alwaysVisible = weaponDef->visuals.alwaysVisible;
 	ignoreWater = weaponDef->waterweapon;
 
-	CSolidObject* so = NULL;
-	CWeaponProjectile* po = NULL;
-
-	if ((so = dynamic_cast<CSolidObject*>(target)) != NULL) {
-		AddDeathDependence(so, DEPENDENCE_WEAPONTARGET);
+	if ((targetType & TARGET_TYPE_SOLID) != 0) {
+		AddDeathDependence(static_cast<CSolidObject*>(target), DEPENDENCE_WEAPONTARGET);
 	}
-	if ((po = dynamic_cast<CWeaponProjectile*>(target)) != NULL) {
+	if ((targetType & TARGET_TYPE_PROJECTILE) != 0) {
+		CWeaponProjectile* po = static_cast<CWeaponProjectile*>(target);
 		po->SetBeingIntercepted(po->IsBeingIntercepted() || weaponDef->interceptSolo);
 		AddDeathDependence(po, DEPENDENCE_INTERCEPTTARGET);
 	}
@@ -245,13 +261,10 @@ void CWeaponProjectile::Update()
 
 void CWeaponProjectile::UpdateInterception()
 {
-	if (target == NULL)
+	if ((targetType & TARGET_TYPE_PROJECTILE) == 0)
 		return;
 
-	CWeaponProjectile* po = dynamic_cast<CWeaponProjectile*>(target);
-
-	if (po == NULL)
-		return;
+	CWeaponProjectile* po = static_cast<CWeaponProjectile*>(target);
 
 	if (hitscan) {
 		if (ClosestPointOnLine(startPos, targetPos, po->pos).SqDistance(po->pos) < Square(weaponDef->collisionSize)) {
@@ -304,6 +317,23 @@ void CWeaponProjectile::UpdateGroundBounce()
 
 
 
+unsigned int CWeaponProjectile::GetTargetType(const CWorldObject* obj)
+{
+	unsigned int type = 0;
+
+	if (obj == NULL)
+		return type;
+
+	if (dynamic_cast<const CSolidObject*>(obj) != NULL)
+		type |= TARGET_TYPE_SOLID;
+	if (dynamic_cast<const CUnit*>(obj) != NULL)
+		type |= TARGET_TYPE_UNIT;
+	if (dynamic_cast<const CWeaponProjectile*>(obj) != NULL)
+		type |= TARGET_TYPE_PROJECTILE;
+
+	return type;
+}
+
 bool CWeaponProjectile::TraveledRange() const
 {
 	return ((pos - startPos).SqLength() > (weaponDef->range * weaponDef->range));
@@ -320,6 +350,7 @@ void CWeaponProjectile::DependentDied(CObject* o)
 {
 	if (o == target) {
 		target = NULL;
+		targetType = 0;
 	}
 }
 
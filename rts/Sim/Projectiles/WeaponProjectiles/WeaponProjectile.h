@@ -69,6 +69,16 @@ class CWeaponProjectile : public CProjectile
 {
 	CR_DECLARE(CWeaponProjectile);
 public:
+	#if !(defined(USE_GML) && GML_ENABLE_SIM)
+	// weapon projectiles are created and destroyed in large numbers, keep
+	// them in per-size (and so in practice per-class) recycled free-lists
+	void* operator new(size_t size);
+	void operator delete(void* p, size_t size);
+	// class-scope operator new hides the placement form creg constructs with
+	void* operator new(size_t size, void* p) { return p; }
+	void operator delete(void* p, void* q) {}
+	#endif
+
 	CWeaponProjectile();
 	CWeaponProjectile(const ProjectileParams& params);
 	virtual ~CWeaponProjectile() {}
@@ -92,6 +102,7 @@ public:
 		}
 
 		target = newTarget;
+		targetType = GetTargetType(newTarget);
 	}
 
 	const CWorldObject* GetTargetObject() const { return target; }
@@ -111,6 +122,15 @@ public:
 	bool TraveledRange() const;
 
 protected:
+	enum {
+		TARGET_TYPE_SOLID      = 1,
+		TARGET_TYPE_UNIT       = 2,
+		TARGET_TYPE_PROJECTILE = 4,
+	};
+
+	/// TARGET_TYPE_* bits of <obj>, so Update() can static_cast <target>
+	static unsigned int GetTargetType(const CWorldObject* obj);
+
 	void UpdateInterception();
 	virtual void UpdateGroundBounce();
 
@@ -119,6 +139,7 @@ protected:
 
 	CWorldObject* target;
 
+	unsigned int targetType;
 	unsigned int weaponDefID;
 
 	int ttl;
@@ -59,9 +59,52 @@ CR_REG_METADATA(CBuilderCAI , (
 				));
 
 // not adding to members, should repopulate itself
-CUnitSet CBuilderCAI::reclaimers;
-CUnitSet CBuilderCAI::featureReclaimers;
-CUnitSet CBuilderCAI::resurrecters;
+CBuilderCAI::CTargetingUnits CBuilderCAI::reclaimers;
+CBuilderCAI::CTargetingUnits CBuilderCAI::featureReclaimers;
+CBuilderCAI::CTargetingUnits CBuilderCAI::resurrecters;
+
+
+void CBuilderCAI::CTargetingUnits::Add(CUnit* unit, int targetID)
+{
+	const std::map<int, int>::iterator it = targetByUnit.find(unit->id);
+
+	if (it != targetByUnit.end()) {
+		if (it->second == targetID)
+			return;
+
+		Remove(unit);
+	}
+
+	unitsByTarget[targetID].insert(unit);
+	targetByUnit[unit->id] = targetID;
+}
+
+void CBuilderCAI::CTargetingUnits::Remove(CUnit* unit)
+{
+	const std::map<int, int>::iterator it = targetByUnit.find(unit->id);
+
+	if (it == targetByUnit.end())
+		return;
+
+	const std::map<int, CUnitSet>::iterator tit = unitsByTarget.find(it->second);
+
+	tit->second.erase(unit);
+
+	if (tit->second.empty())
+		unitsByTarget.erase(tit);
+
+	targetByUnit.erase(it);
+}
+
+const CUnitSet* CBuilderCAI::CTargetingUnits::Get(int targetID) const
+{
+	const std::map<int, CUnitSet>::const_iterator it = unitsByTarget.find(targetID);
+
+	if (it == unitsByTarget.end())
+		return NULL;
+
+	return &(it->second);
+}
 
 
 CBuilderCAI::CBuilderCAI():
@@ -1309,56 +1352,68 @@ int CBuilderCAI::GetDefaultCmd(const CUnit* pointed, const CFeature* feature)
 }
 
 
+static int GetFrontCommandTarget(const CUnit* unit)
+{
+	const CCommandQueue& queue = unit->commandAI->commandQue;
+
+	if (queue.empty() || queue.front().params.empty())
+		return -1;
+
+	return (int)queue.front().params[0];
+}
+
+
 void CBuilderCAI::AddUnitToReclaimers(CUnit* unit)
 {
-	reclaimers.insert(unit);
+	reclaimers.Add(unit, GetFrontCommandTarget(unit));
 }
 
 
 void CBuilderCAI::RemoveUnitFromReclaimers(CUnit* unit)
 {
-	reclaimers.erase(unit);
+	reclaimers.Remove(unit);
 }
 
 
 void CBuilderCAI::AddUnitToFeatureReclaimers(CUnit* unit)
 {
-	featureReclaimers.insert(unit);
+	featureReclaimers.Add(unit, GetFrontCommandTarget(unit));
 }
 
 void CBuilderCAI::RemoveUnitFromFeatureReclaimers(CUnit* unit)
 {
-	featureReclaimers.erase(unit);
+	featureReclaimers.Remove(unit);
 }
 
 void CBuilderCAI::AddUnitToResurrecters(CUnit* unit)
 {
-	resurrecters.insert(unit);
+	resurrecters.Add(unit, GetFrontCommandTarget(unit));
 }
 
 void CBuilderCAI::RemoveUnitFromResurrecters(CUnit* unit)
 {
-	resurrecters.erase(unit);
+	resurrecters.Remove(unit);
 }
 
 
 /**
  * Checks if a unit is being reclaimed by a friendly con.
  *
- * We assume that there will not be a lot of reclaimers, because performance
- * would suck if there were. Ideally, reclaimers should be assigned on a
- * per-unit basis, but this requires tracking of deaths, which albeit
- * already done, is not exactly simple to follow.
- *
- * TODO easy: store reclaiming units per allyteam
- * TODO harder: update reclaimers as they start/finish reclaims and/or die
+ * Only the cons that were registered for this target are checked, and
+ * those whose current command no longer is a matching reclaim (they get
+ * re-registered by ExecuteReclaim every SlowUpdate) are removed.
  */
 bool CBuilderCAI::IsUnitBeingReclaimed(const CUnit* unit, CUnit *friendUnit)
 {
+	const CUnitSet* units = reclaimers.Get(unit->id);
+
+	if (units == NULL)
+		return false;
+
 	bool retval = false;
 	std::list<CUnit*> rm;
 
-	for (CUnitSet::iterator it = reclaimers.begin(); it != reclaimers.end(); ++it) {
+	for (CUnitSet::const_iterator it = units->begin(); it != units->end(); ++it) {
 		if ((*it)->commandAI->commandQue.empty()) {
 			rm.push_back(*it);
 			continue;
@@ -1369,7 +1424,11 @@ bool CBuilderCAI::IsUnitBeingReclaimed(const CUnit* unit, CUnit *friendUnit)
 			continue;
 		}
 		const int cmdUnitId = (int)c.params[0];
-		if (cmdUnitId == unit->id && (!friendUnit || teamHandler->Ally(friendUnit->allyteam, (*it)->allyteam))) {
+		if (cmdUnitId != unit->id) {
+			rm.push_back(*it);
+			continue;
+		}
+		if (!friendUnit || teamHandler->Ally(friendUnit->allyteam, (*it)->allyteam)) {
 			retval = true;
 			break;
 		}
@@ -1382,10 +1441,15 @@ bool CBuilderCAI::IsUnitBeingReclaimed(const CUnit* unit, CUnit *friendUnit)
 
 bool CBuilderCAI::IsFeatureBeingReclaimed(int featureId, CUnit *friendUnit)
 {
+	const CUnitSet* units = featureReclaimers.Get(unitHandler->MaxUnits() + featureId);
+
+	if (units == NULL)
+		return false;
+
 	bool retval = false;
 	std::list<CUnit*> rm;
 
-	for (CUnitSet::iterator it = featureReclaimers.begin(); it != featureReclaimers.end(); ++it) {
+	for (CUnitSet::const_iterator it = units->begin(); it != units->end(); ++it) {
 		if ((*it)->commandAI->commandQue.empty()) {
 			rm.push_back(*it);
 			continue;
@@ -1396,7 +1460,11 @@ bool CBuilderCAI::IsFeatureBeingReclaimed(int featureId, CUnit *friendUnit)
 			continue;
 		}
 		const int cmdFeatureId = (int)c.params[0];
-		if (cmdFeatureId-unitHandler->MaxUnits() == featureId && (!friendUnit || teamHandler->Ally(friendUnit->allyteam, (*it)->allyteam))) {
+		if (cmdFeatureId-unitHandler->MaxUnits() != featureId) {
+			rm.push_back(*it);
+			continue;
+		}
+		if (!friendUnit || teamHandler->Ally(friendUnit->allyteam, (*it)->allyteam)) {
 			retval = true;
 			break;
 		}
@@ -1409,10 +1477,15 @@ bool CBuilderCAI::IsFeatureBeingReclaimed(int featureId, CUnit *friendUnit)
 
 bool CBuilderCAI::IsFeatureBeingResurrected(int featureId, CUnit *friendUnit)
 {
+	const CUnitSet* units = resurrecters.Get(unitHandler->MaxUnits() + featureId);
+
+	if (units == NULL)
+		return false;
+
 	bool retval = false;
 	std::list<CUnit*> rm;
 
-	for (CUnitSet::iterator it = resurrecters.begin(); it != resurrecters.end(); ++it) {
+	for (CUnitSet::const_iterator it = units->begin(); it != units->end(); ++it) {
 		if ((*it)->commandAI->commandQue.empty()) {
 			rm.push_back(*it);
 			continue;
@@ -1423,7 +1496,11 @@ bool CBuilderCAI::IsFeatureBeingResurrected(int featureId, CUnit *friendUnit)
 			continue;
 		}
 		const int cmdFeatureId = (int)c.params[0];
-		if (cmdFeatureId-unitHandler->MaxUnits() == featureId && (!friendUnit || teamHandler->Ally(friendUnit->allyteam, (*it)->allyteam))) {
+		if (cmdFeatureId-unitHandler->MaxUnits() != featureId) {
+			rm.push_back(*it);
+			continue;
+		}
+		if (!friendUnit || teamHandler->Ally(friendUnit->allyteam, (*it)->allyteam)) {
 			retval = true;
 			break;
 		}
@@ -61,12 +61,32 @@ public:
 	bool IsInBuildRange(const CWorldObject* obj) const;
 	bool IsInBuildRange(const float3& pos, const float radius) const;
 
+public:
+	/**
+	 * Builders indexed by the target (params[0]) of the reclaim or resurrect
+	 * command they were executing when last registered, so that the checks
+	 * for a single target do not have to walk every reclaimer in the game.
+	 * Entries are only hints: the builder's current command is re-checked.
+	 */
+	class CTargetingUnits {
+	public:
+		void Add(CUnit* unit, int targetID);
+		void Remove(CUnit* unit);
+
+		/// @return the units registered for targetID, or NULL if there are none
+		const CUnitSet* Get(int targetID) const;
+
+	private:
+		std::map<int, CUnitSet> unitsByTarget;
+		std::map<int, int> targetByUnit; // unit id -> target id
+	};
+
 public:
 	std::map<int, std::string> buildOptions;
 
-	static CUnitSet reclaimers;
-	static CUnitSet featureReclaimers;
-	static CUnitSet resurrecters;
+	static CTargetingUnits reclaimers;
+	static CTargetingUnits featureReclaimers;
+	static CTargetingUnits resurrecters;
 
 private:
 	enum ReclaimOptions {
@@ -6,12 +6,26 @@ CR_BIND(Command, );
 CR_REG_METADATA(Command, (
 	CR_MEMBER(aiCommandId),
 	CR_MEMBER(options),
-	CR_MEMBER(params),
+	CR_IGNORED(params),
 	CR_MEMBER(tag),
 	CR_MEMBER(timeOut),
-	CR_MEMBER(id)
+	CR_MEMBER(id),
+	CR_SERIALIZER(Serialize)
 ));
 
+void Command::Serialize(creg::ISerializer& s)
+{
+	int numParams = params.size();
+
+	s.SerializeInt(&numParams, sizeof(numParams));
+
+	if (!s.IsWriting())
+		params.resize(numParams);
+
+	if (numParams > 0)
+		s.Serialize(params.data(), numParams * sizeof(float));
+}
+
 CR_BIND(CommandDescription, );
 CR_REG_METADATA(CommandDescription, (
 	CR_MEMBER(id),
@@ -9,6 +9,7 @@
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
 #include "System/SafeVector.h"
+#include "System/SmallVector.h"
 #include "lib/gml/gmlcnf.h"
 
 // ID's lower than 0 are reserved for build options (cmd -x = unitdefs[x])
@@ -135,6 +136,9 @@ public:
 	Command(const Command& c) {
 		*this = c;
 	}
+	Command(Command&& c) {
+		*this = std::move(c);
+	}
 
 	Command& operator = (const Command& c) {
 		id = c.id;
@@ -145,6 +149,15 @@ public:
 		params = c.params;
 		return *this;
 	}
+	Command& operator = (Command&& c) {
+		id = c.id;
+		aiCommandId = c.aiCommandId;
+		options = c.options;
+		tag = c.tag;
+		timeOut = c.timeOut;
+		params = std::move(c.params);
+		return *this;
+	}
 
 	Command(const float3& pos)
 		: aiCommandId(-1)
@@ -213,7 +226,7 @@ public:
 		PushPos(pos);
 	}
 
-	~Command() { params.clear(); }
+	~Command() {}
 
 	// returns true if the command references another object and
 	// in this case also returns the param index of the object in cpos
@@ -280,7 +293,7 @@ public:
 	void PushParam(float par) { params.push_back(par); }
 	const float& GetParam(size_t idx) const { return params[idx]; }
 
-	/// const safe_vector<float>& GetParams() const { return params; }
+	/// const Params& GetParams() const { return params; }
 	const size_t GetParamsCount() const { return params.size(); }
 
 	void SetID(int id) 
@@ -318,7 +331,18 @@ public:
 		params[idx + 2] = p.z;
 	}
 
+	/// creg serialize callback
+	void Serialize(creg::ISerializer& s);
+
 public:
+	/**
+	 * enough for positions, area orders and CMD_INSERT'ed position orders,
+	 * so (almost) no Command needs a heap allocation for its parameters
+	 */
+	static const unsigned int NUM_INLINE_PARAMS = 6;
+
+	typedef small_vector<float, NUM_INLINE_PARAMS> Params;
+
 	/**
 	 * AI Command callback id (passed in on handleCommand, returned
 	 * in CommandFinished event)
@@ -329,7 +353,7 @@ public:
 	unsigned char options;
 
 	/// command parameters
-	safe_vector<float> params;
+	Params params;
 
 	/// unique id within a CCommandQueue
 	unsigned int tag;
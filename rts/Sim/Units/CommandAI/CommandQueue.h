@@ -43,6 +43,7 @@ class CCommandQueue {
 		inline size_type size() const { return queue.size(); }
 
 		inline void push_back(const Command& cmd);
+		inline void push_back(Command&& cmd);
 		inline void push_front(const Command& cmd);
 
 		inline iterator insert(iterator pos, const Command& cmd);
@@ -135,6 +136,15 @@ inline void CCommandQueue::push_back(const Command& cmd)
 }
 
 
+inline void CCommandQueue::push_back(Command&& cmd)
+{
+	GML_STDMUTEX_LOCK(cai); // push_back
+
+	queue.push_back(std::move(cmd));
+	queue.back().tag = GetNextTag();
+}
+
+
 inline void CCommandQueue::push_front(const Command& cmd)
 {
 	GML_STDMUTEX_LOCK(cai); // push_front
@@ -150,7 +160,7 @@ inline CCommandQueue::iterator CCommandQueue::insert(iterator pos,
 	Command tmpCmd = cmd;
 	tmpCmd.tag = GetNextTag();
 	GML_STDMUTEX_LOCK(cai); // insert
-	return queue.insert(pos, tmpCmd);
+	return queue.insert(pos, std::move(tmpCmd));
 }
 
 
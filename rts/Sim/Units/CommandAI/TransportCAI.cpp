@@ -6,6 +6,8 @@
 #include "Game/GameHelper.h"
 #include "Game/GlobalUnsynced.h"
 #include "Map/Ground.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
@@ -24,6 +26,28 @@
 #define AIRTRANSPORT_DOCKING_RADIUS 16
 #define AIRTRANSPORT_DOCKING_ANGLE 50
 
+/**
+ * Units found in the circle of an area-load order. All transports that got
+ * the same order search the same circle, usually in the same frame (when
+ * the order is given), so the quadfield is only queried by the first one.
+ * IDs rather than pointers, the list is never used after its frame.
+ */
+struct AreaLoadCandidates {
+	AreaLoadCandidates(): frame(-1), radius(0.0f) {}
+
+	bool Matches(const float3& c, float r) const {
+		return (frame == gs->frameNum && center == c && radius == r);
+	}
+
+	int frame;
+	float3 center;
+	float radius;
+	std::vector<int> unitIDs;
+};
+
+static AreaLoadCandidates areaLoadCandidates;
+
+
 CR_BIND_DERIVED(CTransportCAI,CMobileCAI , );
 
 CR_REG_METADATA(CTransportCAI, (
@@ -360,6 +384,11 @@ bool CTransportCAI::FindEmptySpot(const float3& center, float radius, float spre
 		if (!pos.IsInBounds())
 			continue;
 
+		// the blocking map is a plain array lookup, a square covered by
+		// some other object's footprint would fail the quadfield test too
+		if (groundBlockingObjectMap->GroundBlocked(pos, isAirTrans? owner: NULL))
+			continue;
+
 		if (!ownerTrans->CanLoadUnloadAtPos(pos, unitToUnload, &pos.y)) // returns loading height in pos.y
 			continue;
 
@@ -876,10 +905,27 @@ CUnit* CTransportCAI::FindUnitToTransport(float3 center, float radius)
 	CUnit* bestUnit = NULL;
 	float bestDist = std::numeric_limits<float>::max();
 
-	const std::vector<CUnit*>& units = quadField->GetUnitsExact(center, radius);
+	if (!areaLoadCandidates.Matches(center, radius)) {
+		const std::vector<CUnit*>& units = quadField->GetUnitsExact(center, radius);
+
+		areaLoadCandidates.frame = gs->frameNum;
+		areaLoadCandidates.center = center;
+		areaLoadCandidates.radius = radius;
+		areaLoadCandidates.unitIDs.clear();
+
+		for (std::vector<CUnit*>::const_iterator ui = units.begin(); ui != units.end(); ++ui) {
+			areaLoadCandidates.unitIDs.push_back((*ui)->id);
+		}
+	}
+
+	const std::vector<int>& unitIDs = areaLoadCandidates.unitIDs;
+
+	for (std::vector<int>::const_iterator ui = unitIDs.begin(); ui != unitIDs.end(); ++ui) {
+		CUnit* unit = unitHandler->GetUnit(*ui);
+
+		if (unit == NULL)
+			continue;
 
-	for (std::vector<CUnit*>::const_iterator ui = units.begin(); ui != units.end(); ++ui) {
-		CUnit* unit = (*ui);
 		float dist = unit->pos.SqDistance2D(owner->pos);
 
 		if (unit->loadingTransportId != -1 && unit->loadingTransportId != owner->id) {
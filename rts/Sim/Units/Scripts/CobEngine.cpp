@@ -17,6 +17,13 @@
 #define SCOPED_TIMER(a) {}
 #endif
 
+#include <algorithm>
+
+// 256 slots of 32ms each cover sleeps of up to ~8 seconds
+// per revolution, longer ones are just skipped over again
+#define COB_SLEEP_WHEEL_SLOTS 256
+#define COB_SLEEP_SLOT_TIME    32
+
 
 CCobEngine GCobEngine;
 CCobFileHandler GCobFileHandler;
@@ -28,7 +35,10 @@ int GCurrentTime;
 
 
 CCobEngine::CCobEngine()
-	: curThread(NULL)
+	: sleepWheel(COB_SLEEP_WHEEL_SLOTS)
+	, sleepCursor(0)
+	, sleepOrder(0)
+	, curThread(NULL)
 {
 	GCurrentTime = 0;
 }
@@ -37,24 +47,34 @@ CCobEngine::CCobEngine()
 CCobEngine::~CCobEngine()
 {
 	//Should delete all things that the scheduler knows
+	bool haveThreads = false;
+
 	do {
-		while (!running.empty()) {
-			CCobThread* tmp = running.front();
-			running.pop_front();
-			delete tmp;
-		}
-		while (!wantToRun.empty()) {
-			CCobThread* tmp = wantToRun.front();
-			wantToRun.pop_front();
-			delete tmp;
+		std::vector<CCobThread*> threads;
+
+		threads.swap(running);
+		threads.insert(threads.end(), wantToRun.begin(), wantToRun.end());
+		wantToRun.clear();
+
+		for (unsigned int n = 0; n < sleepWheel.size(); n++) {
+			for (unsigned int k = 0; k < sleepWheel[n].size(); k++) {
+				threads.push_back(sleepWheel[n][k].thread);
+			}
+
+			sleepWheel[n].clear();
 		}
-		while (!sleeping.empty()) {
-			CCobThread* tmp = sleeping.top();
-			sleeping.pop();
-			delete tmp;
+
+		for (unsigned int n = 0; n < threads.size(); n++) {
+			delete threads[n];
 		}
+
 		// callbacks may add new threads
-	} while (!running.empty() || !wantToRun.empty() || !sleeping.empty());
+		haveThreads = (!running.empty() || !wantToRun.empty());
+
+		for (unsigned int n = 0; n < sleepWheel.size(); n++) {
+			haveThreads |= !sleepWheel[n].empty();
+		}
+	} while (haveThreads);
 }
 
 
@@ -72,10 +92,10 @@ void CCobEngine::AddThread(CCobThread *thread)
 {
 	switch (thread->state) {
 		case CCobThread::Run:
-			wantToRun.push_front(thread);
+			wantToRun.push_back(thread);
 			break;
 		case CCobThread::Sleep:
-			sleeping.push(thread);
+			AddSleepingThread(thread);
 			break;
 		default:
 			LOG_L(L_ERROR, "thread added to scheduler with unknown state (%d)", thread->state);
@@ -84,6 +104,50 @@ void CCobEngine::AddThread(CCobThread *thread)
 }
 
 
+void CCobEngine::AddSleepingThread(CCobThread* thread)
+{
+	SleepingThread st;
+	st.thread = thread;
+	st.wakeTime = thread->GetWakeTime();
+	st.order = sleepOrder++;
+
+	// never insert behind the cursor, those slots are not looked at again
+	const int slot = std::max(st.wakeTime / COB_SLEEP_SLOT_TIME, sleepCursor);
+
+	sleepWheel[slot % COB_SLEEP_WHEEL_SLOTS].push_back(st);
+}
+
+
+void CCobEngine::GetWakingThreads()
+{
+	// a thread is due once its wake-time lies in the past
+	const int lastSlot = std::max((GCurrentTime - 1) / COB_SLEEP_SLOT_TIME, sleepCursor);
+	const int numSlots = std::min(lastSlot - sleepCursor + 1, COB_SLEEP_WHEEL_SLOTS);
+
+	for (int n = 0; n < numSlots; n++) {
+		std::vector<SleepingThread>& slot = sleepWheel[(sleepCursor + n) % COB_SLEEP_WHEEL_SLOTS];
+		std::vector<SleepingThread>::iterator it = slot.begin();
+
+		// keep threads from later revolutions (and those at the
+		// end of the last slot that are not due yet) in place
+		for (std::vector<SleepingThread>::iterator jt = slot.begin(); jt != slot.end(); ++jt) {
+			if (jt->wakeTime < GCurrentTime) {
+				wakingThreads.push_back(*jt);
+			} else {
+				*(it++) = *jt;
+			}
+		}
+
+		slot.erase(it, slot.end());
+	}
+
+	// the last slot can still contain threads for the next tick
+	sleepCursor = lastSlot;
+
+	std::sort(wakingThreads.begin(), wakingThreads.end());
+}
+
+
 void CCobEngine::TickThread(CCobThread* thread)
 {
 	curThread = thread; // for error messages originating in CUnitScript
@@ -104,12 +168,13 @@ void CCobEngine::Tick(int deltaTime)
 	LOG_L(L_DEBUG, "----");
 
 	// Advance all running threads
-	for (std::list<CCobThread*>::iterator i = running.begin(); i != running.end(); ++i) {
-		//LOG_L(L_DEBUG, "Now 1running %d: %s", GCurrentTime, (*i)->GetName().c_str());
+	// NOTE: index-based, but ticking a thread only ever adds to wantToRun
+	for (unsigned int n = 0; n < running.size(); n++) {
+		//LOG_L(L_DEBUG, "Now 1running %d: %s", GCurrentTime, running[n]->GetName().c_str());
 #ifdef _CONSOLE
 		printf("----\n");
 #endif
-		TickThread(*i);
+		TickThread(running[n]);
 	}
 
 	// A thread can never go from running->running, so clear the list
@@ -119,19 +184,14 @@ void CCobEngine::Tick(int deltaTime)
 	running.clear();
 
 	// The threads that just ran may have added new threads that should run next tick
-	for (std::list<CCobThread *>::iterator i = wantToRun.begin(); i != wantToRun.end(); ++i) {
-		running.push_front(*i);
-	}
-
-	wantToRun.clear();
+	running.swap(wantToRun);
 
 	//Check on the sleeping threads
-	if (!sleeping.empty()) {
-		CCobThread* cur = sleeping.top();
-
-		while ((cur != NULL) && (cur->GetWakeTime() < GCurrentTime)) {
-			// Start with removing the executing thread from the queue
-			sleeping.pop();
+	// (the threads woken here can go back to sleep or start new ones, which
+	// is why this repeats until no thread with a past wake-time remains)
+	for (GetWakingThreads(); !wakingThreads.empty(); GetWakingThreads()) {
+		for (unsigned int n = 0; n < wakingThreads.size(); n++) {
+			CCobThread* cur = wakingThreads[n].thread;
 
 			//Run forward again. This can quite possibly readd the thread to the sleeping array again
 			//But it will not interfere since it is guaranteed to sleep > 0 ms
@@ -147,12 +207,9 @@ void CCobEngine::Tick(int deltaTime)
 			} else {
 				LOG_L(L_ERROR, "Sleeping thread strange state %d", cur->state);
 			}
-
-			if (!sleeping.empty())
-				cur = sleeping.top();
-			else
-				cur = NULL;
 		}
+
+		wakingThreads.clear();
 	}
 }
 
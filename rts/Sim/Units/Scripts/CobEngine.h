@@ -11,8 +11,7 @@
 
 #include "CobThread.h"
 
-#include <list>
-#include <queue>
+#include <vector>
 #include <map>
 
 class CCobThread;
@@ -20,26 +19,43 @@ class CCobInstance;
 class CCobFile;
 
 
-class CCobThreadPtr_less : public std::binary_function<CCobThread*, CCobThread*, bool> {
-public:
-	bool operator() (const CCobThread* const& a, const CCobThread* const& b) const {
-		return a->GetWakeTime() > b->GetWakeTime();
-	}
-};
-
-
 class CCobEngine
 {
 protected:
-	std::list<CCobThread*> running;
+	struct SleepingThread {
+		// wake in wakeTime order, ties in the order the threads went to sleep
+		bool operator < (const SleepingThread& t) const {
+			return ((wakeTime < t.wakeTime) || (wakeTime == t.wakeTime && order < t.order));
+		}
+
+		CCobThread* thread;
+		int wakeTime;
+		unsigned int order;
+	};
+
+	std::vector<CCobThread*> running;
 	/**
 	 * Threads are added here if they are in Running.
 	 * And moved to real running after running is empty.
 	 */
-	std::list<CCobThread*> wantToRun;
-	std::priority_queue<CCobThread*, std::vector<CCobThread*>, CCobThreadPtr_less> sleeping;
+	std::vector<CCobThread*> wantToRun;
+
+	/**
+	 * Timer-wheel of sleeping threads; slot <n> (modulo the wheel size)
+	 * holds every thread whose wake-time falls into [n, n + 1) * slot-size
+	 * so a tick only has to look at the slots that passed since the last.
+	 */
+	std::vector< std::vector<SleepingThread> > sleepWheel;
+	std::vector<SleepingThread> wakingThreads;
+
+	/// first absolute slot that can still hold threads due to wake
+	int sleepCursor;
+	unsigned int sleepOrder;
+
 	CCobThread* curThread;
 	void TickThread(CCobThread* thread);
+	void AddSleepingThread(CCobThread* thread);
+	void GetWakingThreads();
 public:
 	CCobEngine();
 	~CCobEngine();
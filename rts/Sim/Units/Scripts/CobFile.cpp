@@ -155,6 +155,8 @@ CCobFile::CCobFile(CFileHandler &in, string name)
 		swabDWordInPlace(code[i]);
 	}
 
+	opcodes.resize(code_ints, 0);
+
 	numStaticVars = ch.NumberOfStaticVars;
 
 	// If this is a TA:K script, read the sound names
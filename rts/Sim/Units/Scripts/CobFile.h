@@ -31,6 +31,8 @@ public:
 	std::map<std::string, int> scriptMap;
 	std::vector<LuaHashString> luaScripts;
 	int* code;
+	/// interpreter-internal form of each opcode in <code>, filled in lazily (0 = not yet decoded)
+	std::vector<unsigned char> opcodes;
 	int numStaticVars;
 	std::string name;
 };
@@ -77,14 +77,15 @@ CCobInstance::~CCobInstance()
 
 	do {
 		for (int animType = ATurn; animType <= AMove; animType++) {
-			for (std::list<AnimInfo *>::iterator i = anims[animType].begin(); i != anims[animType].end(); ++i) {
+			// index-based, deleting a listener can add new anims
+			for (unsigned int n = 0; n < anims[animType].size(); n++) {
 				// All threads blocking on animations can be killed safely from here since the scheduler does not
 				// know about them
-				std::list<IAnimListener *>& listeners = (*i)->listeners;
-				while (!listeners.empty()) {
-					IAnimListener* al = listeners.front();
-					listeners.pop_front();
-					delete al;
+				std::vector<IAnimListener*> listeners;
+				listeners.swap(anims[animType][n].listeners);
+
+				for (unsigned int i = 0; i < listeners.size(); i++) {
+					delete listeners[i];
 				}
 				// the anims are deleted in ~CUnitScript
 			}
@@ -200,6 +200,140 @@ const int DROP   = 0x10084000;
 #define LUA9 119
 
 
+// dense opcode indices; the interpreter switches on these instead of the
+// sparse raw values so it compiles to a jump-table (see CCobFile::opcodes)
+enum {
+	OP_UNDECODED = 0,
+	OP_UNKNOWN,
+	OP_MOVE,
+	OP_TURN,
+	OP_SPIN,
+	OP_STOP_SPIN,
+	OP_SHOW,
+	OP_HIDE,
+	OP_CACHE,
+	OP_DONT_CACHE,
+	OP_MOVE_NOW,
+	OP_TURN_NOW,
+	OP_SHADE,
+	OP_DONT_SHADE,
+	OP_EMIT_SFX,
+	OP_WAIT_TURN,
+	OP_WAIT_MOVE,
+	OP_SLEEP,
+	OP_PUSH_CONSTANT,
+	OP_PUSH_LOCAL_VAR,
+	OP_PUSH_STATIC,
+	OP_CREATE_LOCAL_VAR,
+	OP_POP_LOCAL_VAR,
+	OP_POP_STATIC,
+	OP_POP_STACK,
+	OP_ADD,
+	OP_SUB,
+	OP_MUL,
+	OP_DIV,
+	OP_MOD,
+	OP_BITWISE_AND,
+	OP_BITWISE_OR,
+	OP_BITWISE_XOR,
+	OP_BITWISE_NOT,
+	OP_RAND,
+	OP_GET_UNIT_VALUE,
+	OP_GET,
+	OP_SET_LESS,
+	OP_SET_LESS_OR_EQUAL,
+	OP_SET_GREATER,
+	OP_SET_GREATER_OR_EQUAL,
+	OP_SET_EQUAL,
+	OP_SET_NOT_EQUAL,
+	OP_LOGICAL_AND,
+	OP_LOGICAL_OR,
+	OP_LOGICAL_XOR,
+	OP_LOGICAL_NOT,
+	OP_START,
+	OP_CALL,
+	OP_REAL_CALL,
+	OP_LUA_CALL,
+	OP_JUMP,
+	OP_RETURN,
+	OP_JUMP_NOT_EQUAL,
+	OP_SIGNAL,
+	OP_SET_SIGNAL_MASK,
+	OP_EXPLODE,
+	OP_PLAY_SOUND,
+	OP_SET,
+	OP_ATTACH,
+	OP_DROP,
+};
+
+static unsigned char DecodeOpcode(int opcode)
+{
+	switch (opcode) {
+		case MOVE: return OP_MOVE;
+		case TURN: return OP_TURN;
+		case SPIN: return OP_SPIN;
+		case STOP_SPIN: return OP_STOP_SPIN;
+		case SHOW: return OP_SHOW;
+		case HIDE: return OP_HIDE;
+		case CACHE: return OP_CACHE;
+		case DONT_CACHE: return OP_DONT_CACHE;
+		case MOVE_NOW: return OP_MOVE_NOW;
+		case TURN_NOW: return OP_TURN_NOW;
+		case SHADE: return OP_SHADE;
+		case DONT_SHADE: return OP_DONT_SHADE;
+		case EMIT_SFX: return OP_EMIT_SFX;
+		case WAIT_TURN: return OP_WAIT_TURN;
+		case WAIT_MOVE: return OP_WAIT_MOVE;
+		case SLEEP: return OP_SLEEP;
+		case PUSH_CONSTANT: return OP_PUSH_CONSTANT;
+		case PUSH_LOCAL_VAR: return OP_PUSH_LOCAL_VAR;
+		case PUSH_STATIC: return OP_PUSH_STATIC;
+		case CREATE_LOCAL_VAR: return OP_CREATE_LOCAL_VAR;
+		case POP_LOCAL_VAR: return OP_POP_LOCAL_VAR;
+		case POP_STATIC: return OP_POP_STATIC;
+		case POP_STACK: return OP_POP_STACK;
+		case ADD: return OP_ADD;
+		case SUB: return OP_SUB;
+		case MUL: return OP_MUL;
+		case DIV: return OP_DIV;
+		case MOD: return OP_MOD;
+		case BITWISE_AND: return OP_BITWISE_AND;
+		case BITWISE_OR: return OP_BITWISE_OR;
+		case BITWISE_XOR: return OP_BITWISE_XOR;
+		case BITWISE_NOT: return OP_BITWISE_NOT;
+		case RAND: return OP_RAND;
+		case GET_UNIT_VALUE: return OP_GET_UNIT_VALUE;
+		case GET: return OP_GET;
+		case SET_LESS: return OP_SET_LESS;
+		case SET_LESS_OR_EQUAL: return OP_SET_LESS_OR_EQUAL;
+		case SET_GREATER: return OP_SET_GREATER;
+		case SET_GREATER_OR_EQUAL: return OP_SET_GREATER_OR_EQUAL;
+		case SET_EQUAL: return OP_SET_EQUAL;
+		case SET_NOT_EQUAL: return OP_SET_NOT_EQUAL;
+		case LOGICAL_AND: return OP_LOGICAL_AND;
+		case LOGICAL_OR: return OP_LOGICAL_OR;
+		case LOGICAL_XOR: return OP_LOGICAL_XOR;
+		case LOGICAL_NOT: return OP_LOGICAL_NOT;
+		case START: return OP_START;
+		case CALL: return OP_CALL;
+		case REAL_CALL: return OP_REAL_CALL;
+		case LUA_CALL: return OP_LUA_CALL;
+		case JUMP: return OP_JUMP;
+		case RETURN: return OP_RETURN;
+		case JUMP_NOT_EQUAL: return OP_JUMP_NOT_EQUAL;
+		case SIGNAL: return OP_SIGNAL;
+		case SET_SIGNAL_MASK: return OP_SET_SIGNAL_MASK;
+		case EXPLODE: return OP_EXPLODE;
+		case PLAY_SOUND: return OP_PLAY_SOUND;
+		case SET: return OP_SET;
+		case ATTACH: return OP_ATTACH;
+		case DROP: return OP_DROP;
+	}
+
+	return OP_UNKNOWN;
+}
+
+
 // Handy macros
 #define GET_LONG_PC() (script.code[PC++])
 // #define POP() (stack.size() > 0) ? stack.back(), stack.pop_back(); : 0
@@ -243,35 +377,39 @@ bool CCobThread::Tick()
 
 		int opcode = GET_LONG_PC();
 
+		// translate every code position only once, the CCobFile is shared
+		if (script.opcodes[PC - 1] == OP_UNDECODED)
+			script.opcodes[PC - 1] = DecodeOpcode(opcode);
+
 		LOG_L(L_DEBUG, "PC: %x opcode: %x (%s)", PC - 1, opcode, GetOpcodeName(opcode).c_str());
 
-		switch(opcode) {
-			case PUSH_CONSTANT:
+		switch (script.opcodes[PC - 1]) {
+			case OP_PUSH_CONSTANT:
 				r1 = GET_LONG_PC();
 				stack.push_back(r1);
 				break;
-			case SLEEP:
+			case OP_SLEEP:
 				r1 = POP();
 				wakeTime = GCurrentTime + r1;
 				state = Sleep;
 				GCobEngine.AddThread(this);
 				LOG_L(L_DEBUG, "%s sleeping for %d ms", script.scriptNames[callStack.back().functionId].c_str(), r1);
 				return true;
-			case SPIN:
+			case OP_SPIN:
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 				r3 = POP();         // speed
 				r4 = POP();         // accel
 				owner->Spin(r1, r2, r3, r4);
 				break;
-			case STOP_SPIN:
+			case OP_STOP_SPIN:
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 				r3 = POP();         // decel
 				//LOG_L(L_DEBUG, "Stop spin of %s around %d", script.pieceNames[r1].c_str(), r2);
 				owner->StopSpin(r1, r2, r3);
 				break;
-			case RETURN:
+			case OP_RETURN:
 				retCode = POP();
 				if (callStack.back().returnAddr == -1) {
 					LOG_L(L_DEBUG, "%s returned %d", script.scriptNames[callStack.back().functionId].c_str(), retCode);
@@ -288,32 +426,34 @@ bool CCobThread::Tick()
 				callStack.pop_back();
 				LOG_L(L_DEBUG, "Returning to %s", script.scriptNames[callStack.back().functionId].c_str());
 				break;
-			case SHADE:
+			case OP_SHADE:
 				r1 = GET_LONG_PC();
 				break;
-			case DONT_SHADE:
+			case OP_DONT_SHADE:
 				r1 = GET_LONG_PC();
 				break;
-			case CACHE:
+			case OP_CACHE:
 				r1 = GET_LONG_PC();
 				break;
-			case DONT_CACHE:
+			case OP_DONT_CACHE:
 				r1 = GET_LONG_PC();
 				break;
-			case CALL: {
+			case OP_CALL: {
 				r1 = GET_LONG_PC();
 				PC--;
 				const string& name = script.scriptNames[r1];
 				if (name.find("lua_") == 0) {
 					script.code[PC - 1] = LUA_CALL;
+					script.opcodes[PC - 1] = OP_LUA_CALL;
 					LuaCall();
 					break;
 				}
 				script.code[PC - 1] = REAL_CALL;
+				script.opcodes[PC - 1] = OP_REAL_CALL;
 
 				// fall through //
 			}
-			case REAL_CALL:
+			case OP_REAL_CALL:
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 
@@ -332,19 +472,19 @@ bool CCobThread::Tick()
 				PC = script.scriptOffsets[r1];
 				//LOG_L(L_DEBUG, "Calling %s", script.scriptNames[r1].c_str());
 				break;
-			case LUA_CALL:
+			case OP_LUA_CALL:
 				LuaCall();
 				break;
-			case POP_STATIC:
+			case OP_POP_STATIC:
 				r1 = GET_LONG_PC();
 				r2 = POP();
 				owner->staticVars[r1] = r2;
 				//LOG_L(L_DEBUG, "Pop static var %d val %d", r1, r2);
 				break;
-			case POP_STACK:
+			case OP_POP_STACK:
 				POP();
 				break;
-			case START: {
+			case OP_START: {
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 
@@ -367,14 +507,14 @@ bool CCobThread::Tick()
 				thread->signalMask = signalMask;
 				LOG_L(L_DEBUG, "Starting %s %d", script.scriptNames[r1].c_str(), signalMask);
 			} break;
-			case CREATE_LOCAL_VAR:
+			case OP_CREATE_LOCAL_VAR:
 				if (paramCount == 0) {
 					stack.push_back(0);
 				} else {
 					paramCount--;
 				}
 				break;
-			case GET_UNIT_VALUE:
+			case OP_GET_UNIT_VALUE:
 				r1 = POP();
 				if ((r1 >= LUA0) && (r1 <= LUA9)) {
 					stack.push_back(luaArgs[r1 - LUA0]);
@@ -383,30 +523,30 @@ bool CCobThread::Tick()
 				r1 = owner->GetUnitVal(r1, 0, 0, 0, 0);
 				stack.push_back(r1);
 				break;
-			case JUMP_NOT_EQUAL:
+			case OP_JUMP_NOT_EQUAL:
 				r1 = GET_LONG_PC();
 				r2 = POP();
 				if (r2 == 0) {
 					PC = r1;
 				}
 				break;
-			case JUMP:
+			case OP_JUMP:
 				r1 = GET_LONG_PC();
 				// this seem to be an error in the docs..
 				//r2 = script.scriptOffsets[callStack.back().functionId] + r1;
 				PC = r1;
 				break;
-			case POP_LOCAL_VAR:
+			case OP_POP_LOCAL_VAR:
 				r1 = GET_LONG_PC();
 				r2 = POP();
 				stack[callStack.back().stackTop + r1] = r2;
 				break;
-			case PUSH_LOCAL_VAR:
+			case OP_PUSH_LOCAL_VAR:
 				r1 = GET_LONG_PC();
 				r2 = stack[callStack.back().stackTop + r1];
 				stack.push_back(r2);
 				break;
-			case SET_LESS_OR_EQUAL:
+			case OP_SET_LESS_OR_EQUAL:
 				r2 = POP();
 				r1 = POP();
 				if (r1 <= r2)
@@ -414,41 +554,41 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case BITWISE_AND:
+			case OP_BITWISE_AND:
 				r1 = POP();
 				r2 = POP();
 				stack.push_back(r1 & r2);
 				break;
-			case BITWISE_OR: // seems to want stack contents or'd, result places on stack
+			case OP_BITWISE_OR: // seems to want stack contents or'd, result places on stack
 				r1 = POP();
 				r2 = POP();
 				stack.push_back(r1 | r2);
 				break;
-			case BITWISE_XOR:
+			case OP_BITWISE_XOR:
 				r1 = POP();
 				r2 = POP();
 				stack.push_back(r1 ^ r2);
 				break;
-			case BITWISE_NOT:
+			case OP_BITWISE_NOT:
 				r1 = POP();
 				stack.push_back(~r1);
 				break;
-			case EXPLODE:
+			case OP_EXPLODE:
 				r1 = GET_LONG_PC();
 				r2 = POP();
 				owner->Explode(r1, r2);
 				break;
-			case PLAY_SOUND:
+			case OP_PLAY_SOUND:
 				r1 = GET_LONG_PC();
 				r2 = POP();
 				owner->PlayUnitSound(r1, r2);
 				break;
-			case PUSH_STATIC:
+			case OP_PUSH_STATIC:
 				r1 = GET_LONG_PC();
 				stack.push_back(owner->staticVars[r1]);
 				//LOG_L(L_DEBUG, "Push static %d val %d", r1, owner->staticVars[r1]);
 				break;
-			case SET_NOT_EQUAL:
+			case OP_SET_NOT_EQUAL:
 				r1 = POP();
 				r2 = POP();
 				if (r1 != r2)
@@ -456,7 +596,7 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case SET_EQUAL:
+			case OP_SET_EQUAL:
 				r1 = POP();
 				r2 = POP();
 				if (r1 == r2)
@@ -464,7 +604,7 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case SET_LESS:
+			case OP_SET_LESS:
 				r2 = POP();
 				r1 = POP();
 				if (r1 < r2)
@@ -472,7 +612,7 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case SET_GREATER:
+			case OP_SET_GREATER:
 				r2 = POP();
 				r1 = POP();
 				if (r1 > r2)
@@ -480,7 +620,7 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case SET_GREATER_OR_EQUAL:
+			case OP_SET_GREATER_OR_EQUAL:
 				r2 = POP();
 				r1 = POP();
 				if (r1 >= r2)
@@ -488,31 +628,31 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case RAND:
+			case OP_RAND:
 				r2 = POP();
 				r1 = POP();
 				r3 = gs->randInt() % (r2 - r1 + 1) + r1;
 				stack.push_back(r3);
 				break;
-			case EMIT_SFX:
+			case OP_EMIT_SFX:
 				r1 = POP();
 				r2 = GET_LONG_PC();
 				owner->EmitSfx(r1, r2);
 				break;
-			case MUL:
+			case OP_MUL:
 				r1 = POP();
 				r2 = POP();
 				stack.push_back(r1 * r2);
 				break;
-			case SIGNAL:
+			case OP_SIGNAL:
 				r1 = POP();
 				owner->Signal(r1);
 				break;
-			case SET_SIGNAL_MASK:
+			case OP_SET_SIGNAL_MASK:
 				r1 = POP();
 				signalMask = r1;
 				break;
-			case TURN:
+			case OP_TURN:
 				r2 = POP();
 				r1 = POP();
 				r3 = GET_LONG_PC();
@@ -520,7 +660,7 @@ bool CCobThread::Tick()
 				//LOG_L(L_DEBUG, "Turning piece %s axis %d to %d speed %d", script.pieceNames[r3].c_str(), r4, r2, r1);
 				owner->Turn(r3, r4, r1, r2);
 				break;
-			case GET:
+			case OP_GET:
 				r5 = POP();
 				r4 = POP();
 				r3 = POP();
@@ -533,18 +673,18 @@ bool CCobThread::Tick()
 				r6 = owner->GetUnitVal(r1, r2, r3, r4, r5);
 				stack.push_back(r6);
 				break;
-			case ADD:
+			case OP_ADD:
 				r2 = POP();
 				r1 = POP();
 				stack.push_back(r1 + r2);
 				break;
-			case SUB:
+			case OP_SUB:
 				r2 = POP();
 				r1 = POP();
 				r3 = r1 - r2;
 				stack.push_back(r3);
 				break;
-			case DIV:
+			case OP_DIV:
 				r2 = POP();
 				r1 = POP();
 				if (r2 != 0)
@@ -555,7 +695,7 @@ bool CCobThread::Tick()
 				}
 				stack.push_back(r3);
 				break;
-			case MOD:
+			case OP_MOD:
 				r2 = POP();
 				r1 = POP();
 				if (r2 != 0)
@@ -565,26 +705,26 @@ bool CCobThread::Tick()
 					LOG_L(L_ERROR, "modulo division by zero");
 				}
 				break;
-			case MOVE:
+			case OP_MOVE:
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 				r4 = POP();
 				r3 = POP();
 				owner->Move(r1, r2, r3, r4);
 				break;
-			case MOVE_NOW:{
+			case OP_MOVE_NOW:{
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 				r3 = POP();
 				owner->MoveNow(r1, r2, r3);
 				break;}
-			case TURN_NOW:{
+			case OP_TURN_NOW:{
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 				r3 = POP();
 				owner->TurnNow(r1, r2, r3);
 				break;}
-			case WAIT_TURN:
+			case OP_WAIT_TURN:
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 				//LOG_L(L_DEBUG, "Waiting for turn on piece %s around axis %d", script.pieceNames[r1].c_str(), r2);
@@ -594,7 +734,7 @@ bool CCobThread::Tick()
 				}
 				else
 					break;
-			case WAIT_MOVE:
+			case OP_WAIT_MOVE:
 				r1 = GET_LONG_PC();
 				r2 = GET_LONG_PC();
 				//LOG_L(L_DEBUG, "Waiting for move on piece %s on axis %d", script.pieceNames[r1].c_str(), r2);
@@ -603,7 +743,7 @@ bool CCobThread::Tick()
 					return true;
 				}
 				break;
-			case SET:
+			case OP_SET:
 				r2 = POP();
 				r1 = POP();
 				//LOG_L(L_DEBUG, "Setting unit value %d to %d", r1, r2);
@@ -613,24 +753,24 @@ bool CCobThread::Tick()
 				}
 				owner->SetUnitVal(r1, r2);
 				break;
-			case ATTACH:
+			case OP_ATTACH:
 				r3 = POP();
 				r2 = POP();
 				r1 = POP();
 				owner->AttachUnit(r2, r1);
 				break;
-			case DROP:
+			case OP_DROP:
 				r1 = POP();
 				owner->DropUnit(r1);
 				break;
-			case LOGICAL_NOT: // Like bitwise, but only on values 1 and 0.
+			case OP_LOGICAL_NOT: // Like bitwise, but only on values 1 and 0.
 				r1 = POP();
 				if (r1 == 0)
 					stack.push_back(1);
 				else
 					stack.push_back(0);
 				break;
-			case LOGICAL_AND:
+			case OP_LOGICAL_AND:
 				r1 = POP();
 				r2 = POP();
 				if (r1 && r2)
@@ -638,7 +778,7 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case LOGICAL_OR:
+			case OP_LOGICAL_OR:
 				r1 = POP();
 				r2 = POP();
 				if (r1 || r2)
@@ -646,7 +786,7 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case LOGICAL_XOR:
+			case OP_LOGICAL_XOR:
 				r1 = POP();
 				r2 = POP();
 				if ( (!!r1) ^ (!!r2))
@@ -654,12 +794,12 @@ bool CCobThread::Tick()
 				else
 					stack.push_back(0);
 				break;
-			case HIDE:
+			case OP_HIDE:
 				r1 = GET_LONG_PC();
 				owner->SetVisibility(r1, false);
 				//LOG_L(L_DEBUG, "Hiding %d", r1);
 				break;
-			case SHOW:{
+			case OP_SHOW:{
 				r1 = GET_LONG_PC();
 				int i;
 				for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
@@ -12,6 +12,7 @@
 #include "Lua/LuaConfig.h"
 #include "Lua/LuaCallInCheck.h"
 #include "Lua/LuaHandleSynced.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Weapons/PlasmaRepulser.h"
@@ -217,7 +218,7 @@ CLuaUnitScript::~CLuaUnitScript()
 
 void CLuaUnitScript::HandleFreed(CLuaHandle* handle)
 {
-	std::list<CUnit*>::iterator ui;
+	std::vector<CUnit*>::iterator ui;
 	for (ui = unitHandler->activeUnits.begin(); ui != unitHandler->activeUnits.end(); ++ui) {
 		CLuaUnitScript* script = dynamic_cast<CLuaUnitScript*>((*ui)->script);
 
@@ -743,9 +744,40 @@ int CLuaUnitScript::QueryBuildInfo()
 }
 
 
+int CLuaUnitScript::RunWeaponQueryCallIn(int fn, int weaponNum)
+{
+	std::vector<WeaponQueryResult>& results = weaponQueryResults[fn == LUAFN_AimFromWeapon];
+
+	if (weaponNum < 0)
+		return RunQueryCallIn(fn, weaponNum + LUA_WEAPON_BASE_INDEX);
+
+	if (weaponNum >= int(results.size()))
+		results.resize(weaponNum + 1);
+
+	WeaponQueryResult& result = results[weaponNum];
+
+	// weapons ask for their pieces several times per frame
+	if (result.frameNum == gs->frameNum && result.callInCount == handle->callInCount)
+		return result.piece;
+
+	const unsigned int callInCount = handle->callInCount;
+
+	result.piece = RunQueryCallIn(fn, weaponNum + LUA_WEAPON_BASE_INDEX);
+	result.frameNum = gs->frameNum;
+
+	// the query itself does not invalidate the cached results of
+	// other weapons, unless it caused further call-ins to be run
+	if (handle->callInCount == (callInCount + 1))
+		handle->callInCount = callInCount;
+
+	result.callInCount = handle->callInCount;
+	return result.piece;
+}
+
+
 int CLuaUnitScript::QueryWeapon(int weaponNum)
 {
-	return RunQueryCallIn(LUAFN_QueryWeapon, weaponNum + LUA_WEAPON_BASE_INDEX);
+	return RunWeaponQueryCallIn(LUAFN_QueryWeapon, weaponNum);
 }
 
 
@@ -763,7 +795,7 @@ void  CLuaUnitScript::AimShieldWeapon(CPlasmaRepulser* weapon)
 
 int CLuaUnitScript::AimFromWeapon(int weaponNum)
 {
-	return RunQueryCallIn(LUAFN_AimFromWeapon, weaponNum + LUA_WEAPON_BASE_INDEX);
+	return RunWeaponQueryCallIn(LUAFN_AimFromWeapon, weaponNum);
 }
 
 
@@ -30,6 +30,19 @@ private:
 	// used to enforce SetDeathScriptFinished can only be used inside Killed
 	bool inKilled;
 
+	// QueryWeapon / AimFromWeapon results are reused while no other Lua
+	// code has run in <handle> during the same frame (these two call-ins
+	// are assumed to be side-effect free)
+	struct WeaponQueryResult {
+		WeaponQueryResult(): frameNum(-1), callInCount(0), piece(-1) {}
+
+		int frameNum;
+		unsigned int callInCount;
+		int piece;
+	};
+
+	std::vector<WeaponQueryResult> weaponQueryResults[2];
+
 protected:
 	virtual void ShowScriptError(const std::string& msg);
 
@@ -46,6 +59,7 @@ protected:
 
 	int  RunQueryCallIn(int fn);
 	int  RunQueryCallIn(int fn, float arg1);
+	int  RunWeaponQueryCallIn(int fn, int weaponNum);
 	void Call(int fn) { RawCall(scriptIndex[fn]); }
 	void Call(int fn, float arg1);
 	void Call(int fn, float arg1, float arg2);
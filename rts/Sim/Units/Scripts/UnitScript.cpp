@@ -84,12 +84,8 @@ CUnitScript::~CUnitScript()
 {
 	bool haveAnimations = false;
 
+	// anim listeners are not owned by the anim in general, so don't delete them here
 	for (int animType = ATurn; animType <= AMove; animType++) {
-		for (std::list<AnimInfo*>::iterator i = anims[animType].begin(); i != anims[animType].end(); ++i) {
-			// anim listeners are not owned by the anim in general, so don't delete them here
-			delete *i;
-		}
-
 		haveAnimations = (haveAnimations || !anims[animType].empty());
 	}
 
@@ -106,12 +102,12 @@ CUnitScript::~CUnitScript()
  * @brief Unblocks all threads waiting on an animation
  * @param anim AnimInfo the corresponding animation
  */
-void CUnitScript::UnblockAll(AnimInfo* anim)
+void CUnitScript::UnblockAll(const AnimInfo& anim)
 {
-	std::list<IAnimListener *>::iterator li;
+	std::vector<IAnimListener*>::const_iterator li;
 
-	for (li = anim->listeners.begin(); li != anim->listeners.end(); ++li) {
-		(*li)->AnimFinished(anim->type, anim->piece, anim->axis);
+	for (li = anim.listeners.begin(); li != anim.listeners.end(); ++li) {
+		(*li)->AnimFinished(anim.type, anim.piece, anim.axis);
 	}
 }
 
@@ -213,50 +209,52 @@ bool CUnitScript::DoSpin(float& cur, float dest, float &speed, float accel, int
 
 
 
-void CUnitScript::TickAnims(int deltaTime, AnimType type, std::list< std::list<AnimInfo*>::iterator >& doneAnims) {
+void CUnitScript::TickAnims(int deltaTime, AnimType type) {
+	std::vector<AnimInfo>& typeAnims = anims[type];
+
 	switch (type) {
 		case AMove: {
-			for (std::list<AnimInfo*>::iterator it = anims[type].begin(); it != anims[type].end(); ++it) {
-				AnimInfo* ai = *it;
+			for (std::vector<AnimInfo>::iterator it = typeAnims.begin(); it != typeAnims.end(); ++it) {
+				AnimInfo& ai = *it;
 
 				// NOTE: we should not need to copy-and-set here, because
 				// MoveToward/TurnToward/DoSpin modify pos/rot by reference
-				float3 pos = pieces[ai->piece]->GetPosition();
+				float3 pos = pieces[ai.piece]->GetPosition();
 
-				if (MoveToward(pos[ai->axis], ai->dest, ai->speed / (1000 / deltaTime))) {
-					ai->done = true; doneAnims.push_back(it);
+				if (MoveToward(pos[ai.axis], ai.dest, ai.speed / (1000 / deltaTime))) {
+					ai.done = true;
 				}
 
-				pieces[ai->piece]->SetPosition(pos);
-				unit->localModel->PieceUpdated(ai->piece);
+				pieces[ai.piece]->SetPosition(pos);
+				unit->localModel->PieceUpdated(ai.piece);
 			}
 		} break;
 
 		case ATurn: {
-			for (std::list<AnimInfo*>::iterator it = anims[type].begin(); it != anims[type].end(); ++it) {
-				AnimInfo* ai = *it;
-				float3 rot = pieces[ai->piece]->GetRotation();
+			for (std::vector<AnimInfo>::iterator it = typeAnims.begin(); it != typeAnims.end(); ++it) {
+				AnimInfo& ai = *it;
+				float3 rot = pieces[ai.piece]->GetRotation();
 
-				if (TurnToward(rot[ai->axis], ai->dest, ai->speed / (1000 / deltaTime))) {
-					ai->done = true; doneAnims.push_back(it);
+				if (TurnToward(rot[ai.axis], ai.dest, ai.speed / (1000 / deltaTime))) {
+					ai.done = true;
 				}
 
-				pieces[ai->piece]->SetRotation(rot);
-				unit->localModel->PieceUpdated(ai->piece);
+				pieces[ai.piece]->SetRotation(rot);
+				unit->localModel->PieceUpdated(ai.piece);
 			}
 		} break;
 
 		case ASpin: {
-			for (std::list<AnimInfo*>::iterator it = anims[type].begin(); it != anims[type].end(); ++it) {
-				AnimInfo* ai = *it;
-				float3 rot = pieces[ai->piece]->GetRotation();
+			for (std::vector<AnimInfo>::iterator it = typeAnims.begin(); it != typeAnims.end(); ++it) {
+				AnimInfo& ai = *it;
+				float3 rot = pieces[ai.piece]->GetRotation();
 
-				if (DoSpin(rot[ai->axis], ai->dest, ai->speed, ai->accel, 1000 / deltaTime)) {
-					ai->done = true; doneAnims.push_back(it);
+				if (DoSpin(rot[ai.axis], ai.dest, ai.speed, ai.accel, 1000 / deltaTime)) {
+					ai.done = true;
 				}
 
-				pieces[ai->piece]->SetRotation(rot);
-				unit->localModel->PieceUpdated(ai->piece);
+				pieces[ai.piece]->SetRotation(rot);
+				unit->localModel->PieceUpdated(ai.piece);
 			}
 		} break;
 
@@ -273,51 +271,67 @@ void CUnitScript::TickAnims(int deltaTime, AnimType type, std::list< std::list<A
  */
 bool CUnitScript::Tick(int deltaTime)
 {
-	typedef std::list<AnimInfo*>::iterator AnimInfoIt;
+	for (int animType = ATurn; animType <= AMove; animType++) {
+		std::vector<AnimInfo>& typeAnims = anims[animType];
 
-	// list of _iterators_ to finished animations,
-	// so we can get rid of them in constant time
-	std::list<AnimInfoIt> doneAnims;
+		TickAnims(deltaTime, AnimType(animType));
 
-	for (int animType = ATurn; animType <= AMove; animType++) {
-		TickAnims(deltaTime, AnimType(animType), doneAnims);
+		// move the finished animations out, keeping the others in order
+		unsigned int numActive = 0;
+
+		for (unsigned int n = 0; n < typeAnims.size(); n++) {
+			if (typeAnims[n].done) {
+				doneAnims.push_back(std::move(typeAnims[n]));
+			} else {
+				if (numActive != n)
+					typeAnims[numActive] = std::move(typeAnims[n]);
+
+				numActive++;
+			}
+		}
+
+		typeAnims.resize(numActive);
 	}
 
-	//! Tell listeners to unblock, and remove finished animations from the unit/script.
+	//! Tell listeners to unblock; finished animations are already removed from the unit/script.
 	//! NOTE:
 	//!     removing a finished animation _must_ happen before notifying its listeners,
 	//!     otherwise the callback function (AnimFinished()) can call AddAnimListener()
 	//!     and append it to the listeners-list again (causing an endless loop)!
 	//! NOTE: UnblockAll might result in new anims being added
-	for (std::list<AnimInfoIt>::const_iterator it = doneAnims.begin(); it != doneAnims.end(); ++it) {
-		AnimInfoIt animInfoIt = *it;
-		AnimInfo* animInfo = *animInfoIt;
+	//! NOTE: UnblockAll runs script code, so work on a local (swapped) copy of the buffer
+	std::vector<AnimInfo> finishedAnims;
+	finishedAnims.swap(doneAnims);
 
-		anims[animInfo->type].erase(animInfoIt);
-		UnblockAll(animInfo);
-		delete animInfo;
+	for (unsigned int n = 0; n < finishedAnims.size(); n++) {
+		UnblockAll(finishedAnims[n]);
 	}
 
+	finishedAnims.clear();
+	finishedAnims.swap(doneAnims);
+
 	return (HaveAnimations());
 }
 
 
 
-std::list<CUnitScript::AnimInfo*>::iterator CUnitScript::FindAnim(AnimType type, int piece, int axis)
+int CUnitScript::FindAnim(AnimType type, int piece, int axis) const
 {
-	for (std::list<AnimInfo*>::iterator i = anims[type].begin(); i != anims[type].end(); ++i) {
-		if (((*i)->piece == piece) && ((*i)->axis == axis))
-			return i;
+	const std::vector<AnimInfo>& typeAnims = anims[type];
+
+	for (unsigned int n = 0; n < typeAnims.size(); n++) {
+		if ((typeAnims[n].piece == piece) && (typeAnims[n].axis == axis))
+			return n;
 	}
 
-	return anims[type].end();
+	return -1;
 }
 
-void CUnitScript::RemoveAnim(AnimType type, const std::list<AnimInfo*>::iterator& animInfoIt)
+void CUnitScript::RemoveAnim(AnimType type, int animIdx)
 {
-	if (animInfoIt != anims[type].end()) {
-		AnimInfo* ai = *animInfoIt;
-		anims[type].erase(animInfoIt);
+	if (animIdx != -1) {
+		const AnimInfo ai = std::move(anims[type][animIdx]);
+		anims[type].erase(anims[type].begin() + animIdx);
 
 		// If this was the last animation, remove from currently animating list
 		// FIXME: this could be done in a cleaner way
@@ -328,8 +342,6 @@ void CUnitScript::RemoveAnim(AnimType type, const std::list<AnimInfo*>::iterator
 		//! We need to unblock threads waiting on this animation, otherwise they will be lost in the void
 		//! NOTE: UnblockAll might result in new anims being added
 		UnblockAll(ai);
-
-		delete ai;
 	}
 }
 
@@ -355,8 +367,7 @@ void CUnitScript::AddAnim(AnimType type, int piece, int axis, float speed, float
 		}
 	}
 
-	std::list<AnimInfo*>::iterator animInfoIt;
-	AnimInfo* ai = NULL;
+	int animIdx = -1;
 	AnimType overrideType = ANone;
 
 	// first find an animation of a type we override
@@ -366,65 +377,65 @@ void CUnitScript::AddAnim(AnimType type, int piece, int axis, float speed, float
 	switch (type) {
 		case ATurn: {
 			overrideType = ASpin;
-			animInfoIt = FindAnim(overrideType, piece, axis);
+			animIdx = FindAnim(overrideType, piece, axis);
 		} break;
 		case ASpin: {
 			overrideType = ATurn;
-			animInfoIt = FindAnim(overrideType, piece, axis);
+			animIdx = FindAnim(overrideType, piece, axis);
 		} break;
 		case AMove: {
 			// ensure we never remove an animation of this type
 			overrideType = AMove;
-			animInfoIt = anims[overrideType].end();
+			animIdx = -1;
 		} break;
 		default: {
 		} break;
 	}
 
-	if (animInfoIt != anims[overrideType].end())
-		RemoveAnim(overrideType, animInfoIt);
+	if (animIdx != -1)
+		RemoveAnim(overrideType, animIdx);
 
 	// now find an animation of our own type
-	animInfoIt = FindAnim(type, piece, axis);
+	animIdx = FindAnim(type, piece, axis);
 
-	if (animInfoIt == anims[type].end()) {
+	if (animIdx == -1) {
 		// If we were not animating before, inform the engine of this so it can schedule us
 		// FIXME: this could be done in a cleaner way
 		if (!HaveAnimations()) {
 			GUnitScriptEngine.AddInstance(this);
 		}
 
-		ai = new AnimInfo();
-		ai->type = type;
-		ai->piece = piece;
-		ai->axis = axis;
-		anims[type].push_back(ai);
-	} else {
-		ai = *animInfoIt;
+		animIdx = anims[type].size();
+		anims[type].push_back(AnimInfo());
+		anims[type].back().type = type;
+		anims[type].back().piece = piece;
+		anims[type].back().axis = axis;
 	}
 
-	ai->dest  = destf;
-	ai->speed = speed;
-	ai->accel = accel;
-	ai->done = false;
+	AnimInfo& ai = anims[type][animIdx];
+
+	ai.dest  = destf;
+	ai.speed = speed;
+	ai.accel = accel;
+	ai.done = false;
 }
 
 
 void CUnitScript::Spin(int piece, int axis, float speed, float accel)
 {
-	std::list<AnimInfo*>::iterator animInfoIt = FindAnim(ASpin, piece, axis);
+	const int animIdx = FindAnim(ASpin, piece, axis);
 
 	//If we are already spinning, we may have to decelerate to the new speed
-	if (animInfoIt != anims[ASpin].end()) {
-		AnimInfo* ai = *animInfoIt;
-		ai->dest = speed;
+	if (animIdx != -1) {
+		AnimInfo& ai = anims[ASpin][animIdx];
+		ai.dest = speed;
 
 		if (accel > 0) {
-			ai->accel = accel;
+			ai.accel = accel;
 		} else {
 			//Go there instantly. Or have a defaul accel?
-			ai->speed = speed;
-			ai->accel = 0;
+			ai.speed = speed;
+			ai.accel = 0;
 		}
 	} else {
 		//No accel means we start at desired speed instantly
@@ -438,17 +449,17 @@ void CUnitScript::Spin(int piece, int axis, float speed, float accel)
 
 void CUnitScript::StopSpin(int piece, int axis, float decel)
 {
-	std::list<AnimInfo*>::iterator animInfoIt = FindAnim(ASpin, piece, axis);
+	const int animIdx = FindAnim(ASpin, piece, axis);
 
 	if (decel <= 0) {
-		RemoveAnim(ASpin, animInfoIt);
+		RemoveAnim(ASpin, animIdx);
 	} else {
-		if (animInfoIt == anims[ASpin].end())
+		if (animIdx == -1)
 			return;
 
-		AnimInfo* ai = *animInfoIt;
-		ai->dest = 0;
-		ai->accel = decel;
+		AnimInfo& ai = anims[ASpin][animIdx];
+		ai.dest = 0;
+		ai.accel = decel;
 	}
 }
 
@@ -721,13 +732,13 @@ void CUnitScript::DropUnit(int u)
 //Returns true if there was an animation to listen to
 bool CUnitScript::AddAnimListener(AnimType type, int piece, int axis, IAnimListener *listener)
 {
-	std::list<AnimInfo*>::iterator animInfoIt = FindAnim(type, piece, axis);
+	const int animIdx = FindAnim(type, piece, axis);
 
-	if (animInfoIt != anims[type].end()) {
-		AnimInfo* ai = *animInfoIt;
+	if (animIdx != -1) {
+		AnimInfo& ai = anims[type][animIdx];
 
-		if (!ai->done) {
-			ai->listeners.push_back(listener);
+		if (!ai.done) {
+			ai.listeners.push_back(listener);
 			return true;
 		}
 
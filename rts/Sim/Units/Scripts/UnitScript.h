@@ -71,23 +71,27 @@ protected:
 		float dest;     // means final position when turning or moving, final speed when spinning
 		float accel;    // used for spinning, can be negative
 		bool done;
-		std::list<IAnimListener*> listeners;
+		std::vector<IAnimListener*> listeners;
 	};
 
-	std::list<AnimInfo*> anims[AMove + 1];
+	// active animations per type, stored by value (order of creation)
+	std::vector<AnimInfo> anims[AMove + 1];
+	// scratch buffer for Tick, keeps its capacity between ticks
+	std::vector<AnimInfo> doneAnims;
 
 	bool hasSetSFXOccupy;
 	bool hasRockUnit;
 	bool hasStartBuilding;
 
-	void UnblockAll(AnimInfo* anim);
+	void UnblockAll(const AnimInfo& anim);
 
 	bool MoveToward(float& cur, float dest, float speed);
 	bool TurnToward(float& cur, float dest, float speed);
 	bool DoSpin(float& cur, float dest, float& speed, float accel, int divisor);
 
-	std::list<AnimInfo*>::iterator FindAnim(AnimType anim, int piece, int axis);
-	void RemoveAnim(AnimType type, const std::list<AnimInfo*>::iterator& animInfoIt);
+	/// index of the animation into anims[type], or -1 if there is none
+	int FindAnim(AnimType type, int piece, int axis) const;
+	void RemoveAnim(AnimType type, int animIdx);
 	void AddAnim(AnimType type, int piece, int axis, float speed, float dest, float accel);
 
 	virtual void ShowScriptError(const std::string& msg) = 0;
@@ -139,7 +143,7 @@ public:
 	const CUnit* GetUnit() const { return unit; }
 
 	bool Tick(int deltaTime);
-	void TickAnims(int deltaTime, AnimType type, std::list< std::list<AnimInfo*>::iterator >& doneAnims);
+	void TickAnims(int deltaTime, AnimType type);
 
 	// animation, used by CCobThread
 	void Spin(int piece, int axis, float speed, float accel);
@@ -163,7 +167,7 @@ public:
 	void SetUnitVal(int val, int param);
 
 	bool IsInAnimation(AnimType type, int piece, int axis) {
-		return (FindAnim(type, piece, axis) != anims[type].end());
+		return (FindAnim(type, piece, axis) != -1);
 	}
 	bool HaveAnimations() const {
 		return (!anims[ATurn].empty() || !anims[ASpin].empty() || !anims[AMove].empty());
@@ -226,8 +230,8 @@ public:
 
 inline bool CUnitScript::HaveListeners() const {
 	for (int animType = ATurn; animType <= AMove; animType++) {
-		for (std::list<AnimInfo *>::const_iterator i = anims[animType].begin(); i != anims[animType].end(); ++i) {
-			if (!(*i)->listeners.empty()) {
+		for (std::vector<AnimInfo>::const_iterator i = anims[animType].begin(); i != anims[animType].end(); ++i) {
+			if (!i->listeners.empty()) {
 				return true;
 			}
 		}
@@ -46,6 +46,7 @@
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/RadarHandler.h"
 #include "Sim/Misc/TeamHandler.h"
+#include "Sim/Misc/ThreatMap.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -109,7 +110,7 @@ CUnit::CUnit() : CSolidObject(),
 	myTrack(NULL),
 	myIcon(NULL),
 
-	losStatus(teamHandler->ActiveAllyTeams(), 0),
+	losStatus(NULL),
 
 	attackPos(ZeroVector),
 	deathSpeed(ZeroVector),
@@ -310,6 +311,7 @@ CUnit::~CUnit()
 	losHandler->DelayedFreeInstance(los);
 	los = NULL;
 	radarHandler->RemoveUnit(this);
+	threatMap->RemoveUnit(this);
 
 	modelParser->DeleteLocalModel(localModel);
 }
@@ -765,6 +767,10 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 
 	// remove from the state after running the callins
 	losStatus[at] &= newStatus;
+
+	if (diffBits & LOS_INLOS) {
+		threatMap->UpdateUnit(this);
+	}
 }
 
 
@@ -807,6 +813,40 @@ inline void CUnit::UpdateLosStatus(int at)
 	SetLosStatus(at, CalcLosStatus(at));
 }
 
+void CUnit::UpdateLosStatus()
+{
+	const int numAllyTeams = teamHandler->ActiveAllyTeams();
+
+	// allyteams outside LOS and radar coverage that hold no LOS or
+	// radar bits for us would not change our status, skip them
+	const bool useMasks = (losHandler->HasAllyMasks() && radarHandler->HasAllyMasks() && !alwaysVisible);
+	const CLosMap::AllyMask coveredBy = useMasks? (losHandler->GetAllyMask(this) | radarHandler->GetAllyMask(pos)): CLosMap::AllyMask(0);
+
+	// compute the status for every allyteam first, then only
+	// call SetLosStatus (and thereby fire events) on changes
+	unsigned short newStatus[MAX_TEAMS];
+
+	for (int at = 0; at < numAllyTeams; ++at) {
+		const unsigned short currStatus = losStatus[at];
+
+		newStatus[at] = currStatus;
+
+		if ((currStatus & LOS_ALL_MASK_BITS) == LOS_ALL_MASK_BITS)
+			continue;
+		if (useMasks && ((coveredBy >> at) & 1) == 0 && !gs->globalLOS[at] && (currStatus & (LOS_INLOS | LOS_INRADAR | LOS_CONTRADAR)) == 0)
+			continue;
+
+		newStatus[at] = CalcLosStatus(at);
+	}
+
+	for (int at = 0; at < numAllyTeams; ++at) {
+		if (newStatus[at] == losStatus[at])
+			continue;
+
+		SetLosStatus(at, newStatus[at]);
+	}
+}
+
 
 void CUnit::SetStunned(bool stun) {
 	stunned = stun;
@@ -825,9 +865,10 @@ void CUnit::SlowUpdate()
 {
 	UpdatePosErrorParams(false, true);
 
-	for (int at = 0; at < teamHandler->ActiveAllyTeams(); ++at) {
-		UpdateLosStatus(at);
-	}
+	UpdateLosStatus();
+
+	// picks up cell changes of units that stay in LOS
+	threatMap->UpdateUnit(this);
 
 	DoWaterDamage();
 
@@ -1449,6 +1490,7 @@ bool CUnit::ChangeTeam(int newteam, ChangeType type)
 	losHandler->MoveUnit(this, false);
 	quadField->MovedUnit(this);
 	radarHandler->MoveUnit(this);
+	threatMap->UpdateUnit(this);
 
 	if (unitDef->isAirBase) {
 		airBaseHandler->RegisterAirBase(this);
@@ -1468,14 +1510,12 @@ bool CUnit::ChangeTeam(int newteam, ChangeType type)
 void CUnit::ChangeTeamReset()
 {
 	// stop friendly units shooting at us
-	const CObject::TDependenceMap& listeners = GetAllListeners();
+	const CObject::TDependenceList& listeners = GetAllListeners();
 	std::vector<CUnit *> alliedunits;
-	for (CObject::TDependenceMap::const_iterator li = listeners.begin(); li != listeners.end(); ++li) {
-		for (CObject::TSyncSafeSet::const_iterator di = li->second.begin(); di != li->second.end(); ++di) {
-			CUnit* u = dynamic_cast<CUnit*>(*di);
-			if (u != NULL && teamHandler->AlliedTeams(team, u->team))
-				alliedunits.push_back(u);
-		}
+	for (CObject::TDependenceList::const_iterator li = listeners.begin(); li != listeners.end(); ++li) {
+		CUnit* u = dynamic_cast<CUnit*>(li->obj);
+		if (u != NULL && teamHandler->AlliedTeams(team, u->team))
+			alliedunits.push_back(u);
 	}
 	for (std::vector<CUnit*>::const_iterator ui = alliedunits.begin(); ui != alliedunits.end(); ++ui) {
 		(*ui)->StopAttackingAllyTeam(allyteam);
@@ -2323,7 +2363,7 @@ CR_REG_METADATA(CUnit, (
 	CR_MEMBER(realLosRadius),
 	CR_MEMBER(realAirLosRadius),
 
-	CR_MEMBER(losStatus),
+	CR_IGNORED(losStatus), // serialized by CUnitHandler
 
 	CR_MEMBER(inBuildStance),
 	CR_MEMBER(useHighTrajectory),
@@ -198,6 +198,7 @@ protected:
 	void ChangeTeamReset();
 	void UpdateResources();
 	void UpdateLosStatus(int allyTeam);
+	void UpdateLosStatus();
 	float GetFlankingDamageBonus(const float3& attackDir);
 
 public:
@@ -260,7 +261,8 @@ public:
 	std::vector<int> radarSquares;
 
 	/// indicate the los/radar status the allyteam has on this unit
-	std::vector<unsigned short> losStatus;
+	/// (one entry per allyteam, this unit's row of CUnitHandler::losStatusTable)
+	unsigned short* losStatus;
 
 	/// length-per-pixel (UNSYNCED)
 	std::vector<float> lodLengths;
@@ -16,6 +16,7 @@
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
+#include "System/ThreadPool.h"
 #include "System/Util.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Sound/ISound.h"
@@ -53,6 +54,8 @@ CUnitDefHandler::CUnitDefHandler(LuaParser* defsParser) : noCost(false)
 		PushNewUnitDef(StringToLower(unitName), udTable);
 	}
 
+	LoadSoundFiles();
+
 	CleanBuildOptions();
 	FindStartUnits();
 	ProcessDecoys();
@@ -80,6 +83,7 @@ int CUnitDefHandler::PushNewUnitDef(const std::string& unitName, const LuaTable&
 
 	UnitDef* newDef = NULL;
 	int defid = unitDefs.size();
+	const size_t numSoundLoads = soundLoads.size();
 
 	try {
 		newDef = new UnitDef(udTable, unitName, defid);
@@ -93,6 +97,7 @@ int CUnitDefHandler::PushNewUnitDef(const std::string& unitName, const LuaTable&
 		newDef->SetNoCost(true);
 		newDef->SetNoCost(noCost);
 	} catch (const content_error&) {
+		soundLoads.resize(numSoundLoads);
 		delete newDef;
 		return 0;
 	}
@@ -219,12 +224,30 @@ void CUnitDefHandler::LoadSounds(const LuaTable& soundsTable, GuiSoundSet& gsoun
 
 void CUnitDefHandler::LoadSound(GuiSoundSet& gsound, const string& fileName, const float volume)
 {
-	const int id = LoadSoundFile(fileName);
-	if (id > 0)
-	{
-		GuiSoundSet::Data soundData(fileName, id, volume);
-		gsound.sounds.push_back(soundData);
+	// the file itself is loaded by LoadSoundFiles
+	const SoundLoad soundLoad = {&gsound, fileName, volume, 0};
+	soundLoads.push_back(soundLoad);
+}
+
+
+void CUnitDefHandler::LoadSoundFiles()
+{
+	// extracting the tables has to be serial (one Lua state), the sounds
+	// they name are independent of each other and can be decoded concurrently
+	for_mt(0, soundLoads.size(), [&](const int n) {
+		soundLoads[n].id = LoadSoundFile(soundLoads[n].fileName);
+	});
+
+	// keep the order in which the tables listed them
+	for (size_t n = 0; n < soundLoads.size(); n++) {
+		const SoundLoad& soundLoad = soundLoads[n];
+
+		if (soundLoad.id > 0) {
+			soundLoad.soundSet->sounds.push_back(GuiSoundSet::Data(soundLoad.fileName, soundLoad.id, soundLoad.volume));
+		}
 	}
+
+	soundLoads.clear();
 }
 
 
@@ -53,6 +53,8 @@ protected:
 	void UnitDefLoadSounds(UnitDef*, const LuaTable&);
 	void LoadSounds(const LuaTable&, GuiSoundSet&, const std::string& soundName);
 	void LoadSound(GuiSoundSet&, const std::string& fileName, const float volume);
+	/// loads the sounds queued by LoadSound (in parallel) and adds them to their sets
+	void LoadSoundFiles();
 
 	void CleanBuildOptions();
 
@@ -63,6 +65,14 @@ protected:
 private:
 	std::map<std::string, std::string> decoyNameMap;
 
+	struct SoundLoad {
+		GuiSoundSet* soundSet;
+		std::string fileName;
+		float volume;
+		int id;
+	};
+	std::vector<SoundLoad> soundLoads;
+
 	bool noCost;
 };
 
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 
 #include "lib/gml/gmlmut.h"
@@ -10,11 +11,13 @@
 #include "CommandAI/BuilderCAI.h"
 #include "Rendering/Models/3DModel.h"
 #include "Sim/Misc/AirBaseHandler.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "System/EventHandler.h"
 #include "System/EventBatchHandler.h"
 #include "System/Log/ILog.h"
+#include "System/ThreadPool.h"
 #include "System/TimeProfiler.h"
 #include "System/myMath.h"
 #include "System/Sync/SyncTracer.h"
@@ -34,9 +37,11 @@ CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(units),
 	CR_MEMBER(unitsByDefs),
 	CR_MEMBER(activeUnits),
+	CR_MEMBER(losStatusTable),
 	CR_MEMBER(builderCAIs),
 	CR_MEMBER(idPool),
 	CR_MEMBER(unitsToBeRemoved),
+	CR_MEMBER(newActiveUnitIDs),
 	CR_MEMBER(maxUnits),
 	CR_MEMBER(maxUnitRadius),
 	CR_POSTLOAD(PostLoad)
@@ -47,12 +52,26 @@ CR_REG_METADATA(CUnitHandler, (
 void CUnitHandler::PostLoad()
 {
 	// reset any synced stuff that is not saved
-	activeSlowUpdateUnit = activeUnits.end();
+	activeSlowUpdateUnit = activeUnits.size();
+	activeSlots.clear();
+	activeSlots.resize(units.size(), -1u);
+
+	for (unsigned int n = 0; n < activeUnits.size(); n++) {
+		activeSlots[activeUnits[n]->id] = n;
+	}
+
+	for (unsigned int n = 0; n < units.size(); n++) {
+		if (units[n] == NULL)
+			continue;
+
+		units[n]->losStatus = &losStatusTable[n * teamHandler->ActiveAllyTeams()];
+	}
 }
 
 
 CUnitHandler::CUnitHandler()
 :
+	activeSlowUpdateUnit(0),
 	maxUnits(0),
 	maxUnitRadius(0.0f)
 {
@@ -68,20 +87,22 @@ CUnitHandler::CUnitHandler()
 	}
 
 	units.resize(maxUnits, NULL);
+	losStatusTable.resize(maxUnits * teamHandler->ActiveAllyTeams(), 0);
+	activeSlots.resize(maxUnits, -1u);
+	activeUnits.reserve(maxUnits);
 	unitsByDefs.resize(teamHandler->ActiveTeams(), std::vector<CUnitSet>(unitDefHandler->unitDefs.size()));
 
 	// id's are used as indices, so they must lie in [0, units.size() - 1]
 	// (furthermore all id's are treated equally, none have special status)
 	idPool.Expand(0, units.size());
 
-	activeSlowUpdateUnit = activeUnits.end();
 	airBaseHandler = new CAirBaseHandler();
 }
 
 
 CUnitHandler::~CUnitHandler()
 {
-	for (std::list<CUnit*>::iterator usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
+	for (std::vector<CUnit*>::iterator usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
 		// ~CUnit dereferences featureHandler which is destroyed already
 		(*usi)->delayedWreckLevel = -1;
 		delete (*usi);
@@ -92,27 +113,73 @@ CUnitHandler::~CUnitHandler()
 
 void CUnitHandler::InsertActiveUnit(CUnit* unit)
 {
-	std::list<CUnit*>::iterator ui = activeUnits.begin();
-
-	if (ui != activeUnits.end()) {
-		// randomize this to make the slow-update order random (good if one
-		// builds say many buildings at once and then many mobile ones etc)
-		const unsigned int insertionPos = gs->randFloat() * activeUnits.size();
-
-		for (unsigned int n = 0; n < insertionPos; ++n) {
-			++ui;
-		}
-	}
-
 	idPool.AssignID(unit);
 
 	assert(unit->id < units.size());
 	assert(units[unit->id] == NULL);
 
-	activeUnits.insert(ui, unit);
+	// IDs are recycled, so clear what the previous owner left behind
+	unit->losStatus = &losStatusTable[unit->id * teamHandler->ActiveAllyTeams()];
+	std::fill(unit->losStatus, unit->losStatus + teamHandler->ActiveAllyTeams(), 0);
+
+	// new units are appended (this can happen while any of the
+	// update loops is running) and moved to a random position
+	// at the start of the next SlowUpdate cycle, see Update
+	activeSlots[unit->id] = activeUnits.size();
+	activeUnits.push_back(unit);
+	newActiveUnitIDs.push_back(unit->id);
+
 	units[unit->id] = unit;
 }
 
+void CUnitHandler::RemoveActiveUnit(CUnit* unit)
+{
+	unsigned int slot = activeSlots[unit->id];
+
+	assert(slot < activeUnits.size());
+	assert(activeUnits[slot] == unit);
+
+	// units in front of the SlowUpdate cursor were already visited
+	// this cycle; move the slot behind it before swap-removing so the
+	// unit taking its place does not miss its SlowUpdate
+	if (slot < activeSlowUpdateUnit) {
+		SwapActiveUnits(slot, --activeSlowUpdateUnit);
+		slot = activeSlowUpdateUnit;
+	}
+
+	SwapActiveUnits(slot, activeUnits.size() - 1);
+	activeUnits.pop_back();
+	activeSlots[unit->id] = -1u;
+}
+
+void CUnitHandler::SwapActiveUnits(unsigned int i, unsigned int j)
+{
+	std::swap(activeUnits[i], activeUnits[j]);
+
+	activeSlots[activeUnits[i]->id] = i;
+	activeSlots[activeUnits[j]->id] = j;
+}
+
+void CUnitHandler::ShuffleNewActiveUnits()
+{
+	// randomize this to make the slow-update order random (good if one
+	// builds say many buildings at once and then many mobile ones etc)
+	for (unsigned int n = 0; n < newActiveUnitIDs.size(); n++) {
+		const unsigned int unitID = newActiveUnitIDs[n];
+
+		// already deleted again
+		if (activeSlots[unitID] == -1u)
+			continue;
+
+		// randFloat can return 1, clamp to the last slot
+		const unsigned int swapSlot = gs->randFloat() * activeUnits.size();
+
+		SwapActiveUnits(activeSlots[unitID], std::min(swapSlot, unsigned(activeUnits.size() - 1)));
+	}
+
+	newActiveUnitIDs.clear();
+}
+
 
 bool CUnitHandler::AddUnit(CUnit* unit)
 {
@@ -137,47 +204,22 @@ void CUnitHandler::DeleteUnit(CUnit* unit)
 
 void CUnitHandler::DeleteUnitNow(CUnit* delUnit)
 {
-	int delTeam = 0;
-	int delType = 0;
+	const int delTeam = delUnit->team;
+	const int delType = delUnit->unitDef->id;
 
-	std::list<CUnit*>::iterator usi;
+	GML_STDMUTEX_LOCK(dque); // DeleteUnitNow
 
-	for (usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
-		if (*usi == delUnit) {
-			if (activeSlowUpdateUnit != activeUnits.end() && *usi == *activeSlowUpdateUnit) {
-				++activeSlowUpdateUnit;
-			}
-			delTeam = delUnit->team;
-			delType = delUnit->unitDef->id;
+	teamHandler->Team(delTeam)->RemoveUnit(delUnit, CTeam::RemoveDied);
 
-			GML_STDMUTEX_LOCK(dque); // DeleteUnitNow
+	RemoveActiveUnit(delUnit);
+	unitsByDefs[delTeam][delType].erase(delUnit);
+	idPool.FreeID(delUnit->id, true);
 
-			teamHandler->Team(delTeam)->RemoveUnit(delUnit, CTeam::RemoveDied);
-
-			activeUnits.erase(usi);
-			unitsByDefs[delTeam][delType].erase(delUnit);
-			idPool.FreeID(delUnit->id, true);
-
-			units[delUnit->id] = NULL;
-
-			CSolidObject::SetDeletingRefID(delUnit->id);
-			delete delUnit;
-			CSolidObject::SetDeletingRefID(-1);
-
-			break;
-		}
-	}
+	units[delUnit->id] = NULL;
 
-#ifdef _DEBUG
-	for (usi = activeUnits.begin(); usi != activeUnits.end(); /* no post-op */) {
-		if (*usi == delUnit) {
-			LOG_L(L_ERROR, "Duplicated unit found in active units on erase");
-			usi = activeUnits.erase(usi);
-		} else {
-			++usi;
-		}
-	}
-#endif
+	CSolidObject::SetDeletingRefID(delUnit->id);
+	delete delUnit;
+	CSolidObject::SetDeletingRefID(-1);
 }
 
 
@@ -230,15 +272,30 @@ void CUnitHandler::Update()
 		unit->frontdir.AssertNaNs();        \
 		MAPPOS_SANITY_CHECK(unit);
 
+	if (modInfo.useParallelMoveTypeUpdates) {
+		SCOPED_TIMER("Unit::MoveType::PreUpdateMT");
+
+		// read-only queries against start-of-frame state; every
+		// side-effect is still applied by the serial pass below,
+		// in activeUnits order
+		for_mt(0, activeUnits.size(), [&](const int i) {
+			streflop::streflop_init<streflop::Simple>();
+			activeUnits[i]->moveType->PreUpdateMT();
+		});
+	}
+
 	{
 		SCOPED_TIMER("Unit::MoveType::Update");
-		std::list<CUnit*>::iterator usi;
-		for (usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
-			CUnit* unit = *usi;
+
+		// NOTE: index-based, units can be added while iterating
+		for (unsigned int n = 0; n < activeUnits.size(); n++) {
+			CUnit* unit = activeUnits[n];
 			AMoveType* moveType = unit->moveType;
 
 			UNIT_SANITY_CHECK(unit);
 
+			unit->preFramePos = unit->pos;
+
 			if (moveType->Update()) {
 				eventHandler.UnitMoved(unit);
 			}
@@ -255,9 +312,8 @@ void CUnitHandler::Update()
 
 	{
 		// Delete dead units
-		std::list<CUnit*>::iterator usi;
-		for (usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
-			CUnit* unit = *usi;
+		for (unsigned int n = 0; n < activeUnits.size(); n++) {
+			CUnit* unit = activeUnits[n];
 			if (unit->deathScriptFinished) {
 				// there are many ways to fiddle with "deathScriptFinished", so a unit may
 				// arrive here without having been properly killed (and isDead still false),
@@ -271,21 +327,30 @@ void CUnitHandler::Update()
 
 	{
 		SCOPED_TIMER("Unit::UpdatePieceMatrices");
-		std::list<CUnit*>::iterator usi;
-		for (usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
-			// UnitScript only applies piece-space transforms so
-			// we apply the forward kinematics update separately
-			// (only if we have any dirty pieces)
-			CUnit* unit = *usi;
-			unit->localModel->UpdatePieceMatrices();
+
+		// UnitScript only applies piece-space transforms so
+		// we apply the forward kinematics update separately
+		// (only for models that have any dirty pieces)
+		dirtyModelUnits.clear();
+
+		for (std::vector<CUnit*>::const_iterator usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
+			if ((*usi)->localModel->dirtyPieces > 0) {
+				dirtyModelUnits.push_back(*usi);
+			}
 		}
+
+		// every unit owns its LocalModel, so the updates are independent
+		for_mt(0, dirtyModelUnits.size(), [&](const int i) {
+			streflop::streflop_init<streflop::Simple>();
+			dirtyModelUnits[i]->localModel->UpdatePieceMatrices();
+		});
 	}
 
 	{
 		SCOPED_TIMER("Unit::Update");
-		std::list<CUnit*>::iterator usi;
-		for (usi = activeUnits.begin(); usi != activeUnits.end(); ++usi) {
-			CUnit* unit = *usi;
+
+		for (unsigned int n = 0; n < activeUnits.size(); n++) {
+			CUnit* unit = activeUnits[n];
 			UNIT_SANITY_CHECK(unit);
 			unit->Update();
 			UNIT_SANITY_CHECK(unit);
@@ -295,16 +360,19 @@ void CUnitHandler::Update()
 	{
 		SCOPED_TIMER("Unit::SlowUpdate");
 
-		// reset the iterator every <UNIT_SLOWUPDATE_RATE> frames
+		// reset the cursor every <UNIT_SLOWUPDATE_RATE> frames
+		// (no unit has been visited in the new cycle yet, so this
+		// is where units added since the last one can be spread)
 		if ((gs->frameNum & (UNIT_SLOWUPDATE_RATE - 1)) == 0) {
-			activeSlowUpdateUnit = activeUnits.begin();
+			ShuffleNewActiveUnits();
+			activeSlowUpdateUnit = 0;
 		}
 
 		// stagger the SlowUpdate's
 		int n = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1;
 
-		for (; activeSlowUpdateUnit != activeUnits.end() && n != 0; ++activeSlowUpdateUnit) {
-			CUnit* unit = *activeSlowUpdateUnit;
+		for (; activeSlowUpdateUnit < activeUnits.size() && n != 0; ++activeSlowUpdateUnit) {
+			CUnit* unit = activeUnits[activeSlowUpdateUnit];
 
 			UNIT_SANITY_CHECK(unit);
 			unit->SlowUpdate();
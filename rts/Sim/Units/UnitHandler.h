@@ -54,18 +54,29 @@ public:
 
 	std::vector<CUnit*> units;                        ///< used to get units from IDs (0 if not created)
 	std::vector< std::vector<CUnitSet> > unitsByDefs; ///< units sorted by team and unitDef
-	std::list<CUnit*> activeUnits;                    ///< used to get all active units
+	std::vector<CUnit*> activeUnits;                  ///< used to get all active units (dense, in update order)
+
+	///< CUnit::losStatus of all units in one block, ActiveAllyTeams() entries per unit ID
+	std::vector<unsigned short> losStatusTable;
 
 	std::map<unsigned int, CBuilderCAI*> builderCAIs;
 
 private:
 	void InsertActiveUnit(CUnit* unit);
+	void RemoveActiveUnit(CUnit* unit);
+	void SwapActiveUnits(unsigned int i, unsigned int j);
+	void ShuffleNewActiveUnits();
 
 private:
 	SimObjectIDPool idPool;
 
 	std::vector<CUnit*> unitsToBeRemoved;              ///< units that will be removed at start of next update
-	std::list<CUnit*>::iterator activeSlowUpdateUnit;  ///< first unit of batch that will be SlowUpdate'd this frame
+	std::vector<unsigned int> activeSlots;             ///< index into activeUnits for each unit ID (-1u if not active)
+	std::vector<unsigned int> newActiveUnitIDs;        ///< units added since the last SlowUpdate cycle started
+
+	unsigned int activeSlowUpdateUnit;                 ///< index of first unit of batch that will be SlowUpdate'd this frame
+
+	std::vector<CUnit*> dirtyModelUnits;               ///< units whose piece matrices need an update this frame
 
 	///< global unit-limit (derived from the per-team limit)
 	///< units.size() is equal to this and constant at runtime
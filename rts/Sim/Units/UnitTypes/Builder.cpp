@@ -401,7 +401,13 @@ void CBuilder::Update()
 								// TODO: make configurable if this should happen
 								resurrectee->health *= 0.05f;
 
-								for (CUnitSet::iterator it = cai->resurrecters.begin(); it != cai->resurrecters.end(); ++it) {
+								const CUnitSet* rezzers = CBuilderCAI::resurrecters.Get(unitHandler->MaxUnits() + curResurrect->id);
+								const CUnitSet noRezzers;
+
+								if (rezzers == NULL)
+									rezzers = &noRezzers;
+
+								for (CUnitSet::const_iterator it = rezzers->begin(); it != rezzers->end(); ++it) {
 									CBuilder* bld = static_cast<CBuilder*>(*it);
 									CCommandAI* bldCAI = bld->commandAI;
 
@@ -3,6 +3,7 @@
 // Used for all metal-extractors.
 // Handles the metal-make-process.
 
+#include <limits>
 #include <typeinfo>
 #include "ExtractorBuilding.h"
 #include "Sim/Units/Scripts/UnitScript.h"
@@ -59,9 +60,16 @@ void CExtractorBuilding::PostLoad()
 /* resets the metalMap and notifies the neighbours */
 void CExtractorBuilding::ResetExtraction()
 {
+	// bounds of the squares given back, only these can change hands
+	int x1 = std::numeric_limits<int>::max(), x2 = -1;
+	int z1 = std::numeric_limits<int>::max(), z2 = -1;
+
 	// undo the extraction-area
 	for(std::vector<MetalSquareOfControl>::iterator si = metalAreaOfControl.begin(); si != metalAreaOfControl.end(); ++si) {
 		readMap->metalMap->RemoveExtraction(si->x, si->z, si->extractionDepth);
+
+		x1 = std::min(x1, si->x); x2 = std::max(x2, si->x);
+		z1 = std::min(z1, si->z); z2 = std::max(z2, si->z);
 	}
 
 	metalAreaOfControl.clear();
@@ -69,7 +77,7 @@ void CExtractorBuilding::ResetExtraction()
 	// tell the neighbours (if any) to take it over
 	for (std::list<CExtractorBuilding*>::iterator ei = neighbours.begin(); ei != neighbours.end(); ++ei) {
 		(*ei)->RemoveNeighbour(this);
-		(*ei)->ReCalculateMetalExtraction();
+		(*ei)->ReCalculateMetalExtraction(x1, z1, x2, z2);
 	}
 	neighbours.clear();
 }
@@ -158,16 +166,23 @@ void CExtractorBuilding::RemoveNeighbour(CExtractorBuilding* neighboor)
 }
 
 
-/* recalculate metalExtract for this extractor (eg. when a neighbour dies) */
-void CExtractorBuilding::ReCalculateMetalExtraction()
+/*
+ * recalculate metalExtract for this extractor (eg. when a neighbour dies),
+ * only the squares within [x1, x2] x [z1, z2] are requested again
+ */
+void CExtractorBuilding::ReCalculateMetalExtraction(int x1, int z1, int x2, int z2)
 {
 	metalExtract = 0;
 	for (std::vector<MetalSquareOfControl>::iterator si = metalAreaOfControl.begin(); si != metalAreaOfControl.end(); ++si) {
 		MetalSquareOfControl& msqr = *si;
-		readMap->metalMap->RemoveExtraction(msqr.x, msqr.z, msqr.extractionDepth);
 
-		// extraction is done in a cylinder
-		msqr.extractionDepth = readMap->metalMap->RequestExtraction(msqr.x, msqr.z, extractionDepth);
+		if (msqr.x >= x1 && msqr.x <= x2 && msqr.z >= z1 && msqr.z <= z2) {
+			readMap->metalMap->RemoveExtraction(msqr.x, msqr.z, msqr.extractionDepth);
+
+			// extraction is done in a cylinder
+			msqr.extractionDepth = readMap->metalMap->RequestExtraction(msqr.x, msqr.z, extractionDepth);
+		}
+
 		metalExtract += msqr.extractionDepth * readMap->metalMap->GetMetalAmount(msqr.x, msqr.z);
 	}
 
@@ -16,7 +16,7 @@ public:
 
 	void ResetExtraction();
 	void SetExtractionRangeAndDepth(float range, float depth);
-	void ReCalculateMetalExtraction();
+	void ReCalculateMetalExtraction(int x1, int z1, int x2, int z2);
 	bool IsNeighbour(CExtractorBuilding* neighbour);
 	void AddNeighbour(CExtractorBuilding* neighbour);
 	void RemoveNeighbour(CExtractorBuilding* neighbour);
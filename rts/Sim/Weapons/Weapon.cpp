@@ -27,6 +27,9 @@
 #include "System/Sound/SoundChannels.h"
 #include "System/Log/ILog.h"
 
+#include <algorithm>
+#include <functional>
+
 CR_BIND_DERIVED(CWeapon, CObject, (NULL, NULL));
 
 CR_REG_METADATA(CWeapon, (
@@ -101,7 +104,14 @@ CR_REG_METADATA(CWeapon, (
 	CR_MEMBER(errorVector),
 	CR_MEMBER(errorVectorAdd),
 	CR_MEMBER(targetPos),
-	CR_MEMBER(targetBorderPos)
+	CR_MEMBER(targetBorderPos),
+
+	CR_IGNORED(lofCacheFrame),
+	CR_IGNORED(lofCacheUserTarget),
+	CR_IGNORED(lofCacheResult),
+	CR_IGNORED(lofCacheUnit),
+	CR_IGNORED(lofCacheMuzzlePos),
+	CR_IGNORED(lofCacheTargetPos)
 ));
 
 //////////////////////////////////////////////////////////////////////
@@ -178,7 +188,14 @@ CWeapon::CWeapon(CUnit* owner, const WeaponDef* def):
 	salvoError(ZeroVector),
 	errorVector(ZeroVector),
 	errorVectorAdd(ZeroVector),
-	targetPos(OnesVector)
+	targetPos(OnesVector),
+
+	lofCacheFrame(-1),
+	lofCacheUserTarget(false),
+	lofCacheResult(false),
+	lofCacheUnit(NULL),
+	lofCacheMuzzlePos(ZeroVector),
+	lofCacheTargetPos(ZeroVector)
 {
 }
 
@@ -728,15 +745,18 @@ bool CWeapon::AllowWeaponTargetCheck()
 void CWeapon::AutoTarget() {
 	lastTargetRetry = gs->frameNum;
 
-	std::multimap<float, CUnit*> targets;
-	std::multimap<float, CUnit*>::const_iterator targetsIt;
+	CGameHelper::WeaponTargetVec targets;
 
 	// NOTE:
-	//   sorts by INCREASING order of priority, so lower equals better
+	//   visited by INCREASING order of priority, so lower equals better
 	//   <targets> can contain duplicates if a unit covers multiple quads
-	//   <targets> is normally sorted such that all bad TC units are at the
+	//   <targets> is normally ordered such that all bad TC units are at the
 	//   end, but Lua can mess with the ordering arbitrarily
+	//
+	//   the candidates are only heapified, most searches stop at one of
+	//   the first few so fully sorting them would mostly be wasted work
 	CGameHelper::GenerateWeaponTargets(this, targetUnit, targets);
+	std::make_heap(targets.begin(), targets.end(), std::greater<CGameHelper::WeaponTarget>());
 
 	CUnit* prevTargetUnit = NULL;
 	CUnit* goodTargetUnit = NULL;
@@ -744,8 +764,11 @@ void CWeapon::AutoTarget() {
 
 	float3 nextTargetPos = ZeroVector;
 
-	for (targetsIt = targets.begin(); targetsIt != targets.end(); ++targetsIt) {
-		CUnit* nextTargetUnit = targetsIt->second;
+	while (!targets.empty()) {
+		std::pop_heap(targets.begin(), targets.end(), std::greater<CGameHelper::WeaponTarget>());
+
+		CUnit* nextTargetUnit = targets.back().unit;
+		targets.pop_back();
 
 		if (nextTargetUnit == prevTargetUnit)
 			continue; // filter consecutive duplicates
@@ -1081,7 +1104,32 @@ bool CWeapon::TryTarget(const float3& tgtPos, bool userTarget, const CUnit* targ
 		return false;
 
 	//FIXME add a forcedUserTarget (a forced fire mode enabled with ctrl key or something) and skip the tests below then
-	return (HaveFreeLineOfFire(tgtPos, userTarget, targetUnit));
+	return (HaveCachedFreeLineOfFire(tgtPos, userTarget, targetUnit));
+}
+
+bool CWeapon::HaveCachedFreeLineOfFire(const float3& tgtPos, bool userTarget, const CUnit* targetUnit) const
+{
+	// SlowUpdate, UpdateFire and the CAI tend to TryTarget the same target
+	// several times per frame; the ray and cone traces are what dominate in
+	// large battles, so repeat the previous answer if nothing has changed
+	if (lofCacheFrame == gs->frameNum && lofCacheUnit == targetUnit && lofCacheUserTarget == userTarget) {
+		// exact comparisons, float3::operator== has a tolerance
+		const bool sameMuzzlePos = (lofCacheMuzzlePos.x == weaponMuzzlePos.x && lofCacheMuzzlePos.y == weaponMuzzlePos.y && lofCacheMuzzlePos.z == weaponMuzzlePos.z);
+		const bool sameTargetPos = (lofCacheTargetPos.x == tgtPos.x && lofCacheTargetPos.y == tgtPos.y && lofCacheTargetPos.z == tgtPos.z);
+
+		if (sameMuzzlePos && sameTargetPos) {
+			return lofCacheResult;
+		}
+	}
+
+	lofCacheFrame = gs->frameNum;
+	lofCacheUnit = targetUnit;
+	lofCacheUserTarget = userTarget;
+	lofCacheMuzzlePos = weaponMuzzlePos;
+	lofCacheTargetPos = tgtPos;
+	lofCacheResult = HaveFreeLineOfFire(tgtPos, userTarget, targetUnit);
+
+	return lofCacheResult;
 }
 
 
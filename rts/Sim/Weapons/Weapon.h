@@ -98,6 +98,7 @@ protected:
 
 private:
 	inline bool AllowWeaponTargetCheck();
+	bool HaveCachedFreeLineOfFire(const float3& pos, bool userTarget, const CUnit* unit) const;
 
 	void UpdateRelWeaponPos();
 
@@ -197,6 +198,16 @@ public:
 
 	float3 targetPos;             // the position of the target (even if targettype=unit)
 	float3 targetBorderPos;       // <targetPos> adjusted for target-border factor
+
+private:
+	// result of the last HaveFreeLineOfFire test done by TryTarget, reused when
+	// the exact same query (muzzle, target, unit) is repeated in the same frame
+	mutable int lofCacheFrame;
+	mutable bool lofCacheUserTarget;
+	mutable bool lofCacheResult;
+	mutable const CUnit* lofCacheUnit;
+	mutable float3 lofCacheMuzzlePos;
+	mutable float3 lofCacheTargetPos;
 };
 
 #endif /* WEAPON_H */
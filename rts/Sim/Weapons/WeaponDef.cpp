@@ -491,6 +491,21 @@ void WeaponDef::ParseWeaponSounds(const LuaTable& wdTable) {
 	LoadSound(wdTable, "soundStart",  0, fireSound.sounds);
 	LoadSound(wdTable, "soundHitDry", 0, hitSound.sounds);
 	LoadSound(wdTable, "soundHitWet", 1, hitSound.sounds);
+}
+
+static void LoadWeaponSound(GuiSoundSet::Data& soundData)
+{
+	if (soundData.name.empty())
+		return;
+
+	if ((soundData.id = CommonDefHandler::LoadSoundFile(soundData.name)) <= 0)
+		soundData = GuiSoundSet::Data("", -1, -1.0f);
+}
+
+void WeaponDef::LoadSoundFiles() {
+	LoadWeaponSound(fireSound.sounds[0]);
+	LoadWeaponSound(hitSound.sounds[0]);
+	LoadWeaponSound(hitSound.sounds[1]);
 
 	// FIXME: do we still want or need any of this?
 	const bool forceSetVolume =
@@ -560,9 +575,7 @@ void WeaponDef::LoadSound(
 	if (name.empty())
 		return;
 
-	if ((id = CommonDefHandler::LoadSoundFile(name)) <= 0)
-		return;
-
+	// the file itself is loaded by LoadSoundFiles
 	soundData[soundIdx] = GuiSoundSet::Data(name, id, volume);
 }
 
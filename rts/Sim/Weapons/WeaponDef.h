@@ -277,6 +277,13 @@ public:
 	};
 	Visuals visuals;
 
+	/**
+	 * Loads the sound files named by the weapon's table and derives the
+	 * default volumes; only touches this def, so CWeaponDefHandler runs
+	 * it for all defs in parallel once their tables were parsed.
+	 */
+	void LoadSoundFiles();
+
 private:
 	void ParseWeaponSounds(const LuaTable& wdTable);
 	void LoadSound(const LuaTable& wdTable, const std::string& soundKey, const unsigned int soundIdx, std::vector<GuiSoundSet::Data>& soundData);
@@ -10,6 +10,7 @@
 #include "Lua/LuaParser.h"
 #include "Sim/Misc/DamageArrayHandler.h"
 #include "System/Exceptions.h"
+#include "System/ThreadPool.h"
 #include "System/Util.h"
 #include "System/Log/ILog.h"
 
@@ -35,6 +36,12 @@ CWeaponDefHandler::CWeaponDefHandler(LuaParser* defsParser)
 		weaponDefs[wid] = WeaponDef(wdTable, name, wid);
 		weaponID[name] = wid;
 	}
+
+	// extracting the tables has to be serial (one Lua state), the sounds
+	// they name are independent per def and can be decoded concurrently
+	for_mt(0, weaponDefs.size(), [&](const int wid) {
+		weaponDefs[wid].LoadSoundFiles();
+	});
 }
 
 
@@ -1,6 +1,10 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "CRC.h"
+#include "System/ThreadPool.h"
+
+#include <algorithm>
+#include <vector>
 
 extern "C" {
 #include "lib/7z/7zCrc.h"
@@ -40,3 +44,89 @@ CRC& CRC::Update(unsigned int data)
 	crc = CrcUpdate(crc, &data, sizeof(unsigned));
 	return *this;
 }
+
+
+// GF(2) matrix helpers for Combine, see zlib's crc32_combine
+static unsigned int gf2_matrix_times(const unsigned int* mat, unsigned int vec)
+{
+	unsigned int sum = 0;
+
+	for (; vec != 0; vec >>= 1, mat++) {
+		if (vec & 1)
+			sum ^= *mat;
+	}
+
+	return sum;
+}
+
+static void gf2_matrix_square(unsigned int* square, const unsigned int* mat)
+{
+	for (unsigned int n = 0; n < 32; n++) {
+		square[n] = gf2_matrix_times(mat, mat[n]);
+	}
+}
+
+unsigned int CRC::Combine(unsigned int digestA, unsigned int digestB, size_t sizeB)
+{
+	if (sizeB == 0)
+		return digestA;
+
+	unsigned int even[32]; // even-power-of-two zeros operator
+	unsigned int odd[32];  // odd-power-of-two zeros operator
+
+	// operator for one zero bit
+	odd[0] = 0xEDB88320;
+	for (unsigned int n = 1, row = 1; n < 32; n++, row <<= 1) {
+		odd[n] = row;
+	}
+
+	gf2_matrix_square(even, odd); // two zero bits
+	gf2_matrix_square(odd, even); // four zero bits
+
+	// apply sizeB zero bytes to digestA (the first
+	// square puts the operator for one zero byte in even)
+	do {
+		gf2_matrix_square(even, odd);
+
+		if (sizeB & 1)
+			digestA = gf2_matrix_times(even, digestA);
+
+		if ((sizeB >>= 1) == 0)
+			break;
+
+		gf2_matrix_square(odd, even);
+
+		if (sizeB & 1)
+			digestA = gf2_matrix_times(odd, digestA);
+	} while ((sizeB >>= 1) != 0);
+
+	return (digestA ^ digestB);
+}
+
+unsigned int CRC::CalcParallel(const void* data, size_t size, size_t chunkSize)
+{
+	const size_t numChunks = (size + chunkSize - 1) / chunkSize;
+
+	if (numChunks <= 1)
+		return (CRC().Update(data, size).GetDigest());
+
+	std::vector<unsigned int> digests(numChunks);
+
+	// generate the table before going wide
+	CRC();
+
+	for_mt(0, numChunks, [&](const int i) {
+		const size_t offset = i * chunkSize;
+		const size_t length = std::min(chunkSize, size - offset);
+
+		digests[i] = CRC().Update(static_cast<const char*>(data) + offset, length).GetDigest();
+	});
+
+	unsigned int digest = digests[0];
+
+	for (size_t i = 1; i < numChunks; i++) {
+		digest = Combine(digest, digests[i], std::min(chunkSize, size - i * chunkSize));
+	}
+
+	return digest;
+}
@@ -3,6 +3,7 @@
 #ifndef CRC_H
 #define CRC_H
 
+#include <cstddef>
 #include <string>
 
 /** @brief An updateable CRC-32 checksum. */
@@ -27,6 +28,22 @@ public:
 	/** @brief Update CRC over the 4 bytes of data. */
 	CRC& Update(unsigned int data);
 
+	/**
+	 * @brief Digest of the concatenation of two blocks of data
+	 *
+	 * Given the digests of blocks A and B and the length of B, returns
+	 * the digest CRC().Update(A).Update(B) would give; lets large data
+	 * be hashed in independent (parallel) chunks.
+	 */
+	static unsigned int Combine(unsigned int digestA, unsigned int digestB, size_t sizeB);
+
+	/**
+	 * @brief Digest of data, hashed by the thread-pool in chunks of chunkSize
+	 *
+	 * Same result as CRC().Update(data, size).GetDigest().
+	 */
+	static unsigned int CalcParallel(const void* data, size_t size, size_t chunkSize = 4 * 1024 * 1024);
+
 	CRC& operator<<(int data)      { return Up(data); }
 	CRC& operator<<(unsigned data) { return Up(data); }
 	CRC& operator<<(float data)    { return Up(data); }
@@ -49,8 +49,12 @@ public:
 protected:
 	void AddObserver(ConfigNotifyCallback observer);
 
+	CachedValueBase* FindCachedValue(const string& key, const std::type_info& type) const;
+	CachedValueBase* AddCachedValue(CachedValueBase* cv) const;
+
 private:
 	void RemoveDefaults();
+	void RefreshCachedValues();
 
 	OverlayConfigSource* overlay;
 	FileConfigSource* writableSource;
@@ -62,6 +66,11 @@ private:
 	boost::mutex observerMutex;
 	StringMap changedValues;
 	bool writingEnabled;
+
+	// typed handles, see ConfigHandler::GetCachedValue
+	typedef map<string, vector<CachedValueBase*> > CachedValueMap;
+	mutable CachedValueMap cachedValues;
+	mutable boost::mutex cachedValuesMutex;
 };
 
 /******************************************************************************/
@@ -117,6 +126,12 @@ ConfigHandlerImpl::~ConfigHandlerImpl()
 	for_each_source(it) {
 		delete (*it);
 	}
+
+	for (CachedValueMap::iterator it = cachedValues.begin(); it != cachedValues.end(); ++it) {
+		for (vector<CachedValueBase*>::iterator cvi = it->second.begin(); cvi != it->second.end(); ++cvi) {
+			delete (*cvi);
+		}
+	}
 }
 
 /**
@@ -167,6 +182,8 @@ void ConfigHandlerImpl::Delete(const string& key)
 			rwcs->Delete(key);
 		}
 	}
+
+	RefreshCachedValues();
 }
 
 bool ConfigHandlerImpl::IsSet(const string& key) const
@@ -230,6 +247,8 @@ void ConfigHandlerImpl::SetString(const string& key, const string& value, bool u
 
 	// Don't do anything if value didn't change.
 	if (IsSet(key) && GetString(key) == value) {
+		// (but the overlay value might just have been deleted)
+		RefreshCachedValues();
 		return;
 	}
 
@@ -261,6 +280,9 @@ void ConfigHandlerImpl::SetString(const string& key, const string& value, bool u
 		}
 	}
 
+	// writableSource also re-read the file, which might have changed any key
+	RefreshCachedValues();
+
 	boost::mutex::scoped_lock lck(observerMutex);
 	changedValues[key] = value;
 }
@@ -297,6 +319,57 @@ void ConfigHandlerImpl::AddObserver(ConfigNotifyCallback observer) {
 	observers.push_back(observer);
 }
 
+ConfigHandler::CachedValueBase* ConfigHandlerImpl::FindCachedValue(const string& key, const std::type_info& type) const
+{
+	boost::mutex::scoped_lock lck(cachedValuesMutex);
+
+	const CachedValueMap::const_iterator it = cachedValues.find(key);
+	if (it == cachedValues.end()) {
+		return NULL;
+	}
+
+	for (vector<CachedValueBase*>::const_iterator cvi = it->second.begin(); cvi != it->second.end(); ++cvi) {
+		if ((*cvi)->GetType() == type) {
+			return *cvi;
+		}
+	}
+	return NULL;
+}
+
+ConfigHandler::CachedValueBase* ConfigHandlerImpl::AddCachedValue(CachedValueBase* cv) const
+{
+	boost::mutex::scoped_lock lck(cachedValuesMutex);
+
+	vector<CachedValueBase*>& keyValues = cachedValues[cv->GetKey()];
+
+	for (vector<CachedValueBase*>::const_iterator cvi = keyValues.begin(); cvi != keyValues.end(); ++cvi) {
+		if ((*cvi)->GetType() == cv->GetType()) {
+			delete cv;
+			return *cvi;
+		}
+	}
+
+	keyValues.push_back(cv);
+	return cv;
+}
+
+/**
+ * @brief Re-parses all typed handles
+ *
+ * Done right away (the observers only get notified in Update()), so a Get
+ * directly after a Set already returns the new value.
+ */
+void ConfigHandlerImpl::RefreshCachedValues()
+{
+	boost::mutex::scoped_lock lck(cachedValuesMutex);
+
+	for (CachedValueMap::iterator it = cachedValues.begin(); it != cachedValues.end(); ++it) {
+		for (vector<CachedValueBase*>::iterator cvi = it->second.begin(); cvi != it->second.end(); ++cvi) {
+			(*cvi)->Refresh();
+		}
+	}
+}
+
 /******************************************************************************/
 
 void ConfigHandler::Instantiate(const std::string configSource, const bool safemode)
@@ -6,6 +6,8 @@
 #include <string>
 #include <sstream>
 #include <map>
+#include <stdexcept>
+#include <typeinfo>
 
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
@@ -64,13 +66,89 @@ public:
 	}
 
 	/// @brief Get bool, throw if key not present
-	bool  GetBool(const std::string& key)     const { return Get(key); }
+	bool  GetBool(const std::string& key)     const { return GetCached<bool>(key); }
 	/// @brief Get int, throw if key not present
-	int   GetInt(const std::string& key)      const { return Get<int>(key); }
+	int   GetInt(const std::string& key)      const { return GetCached<int>(key); }
 	/// @brief Get int, throw if key not present
-	int   GetUnsigned(const std::string& key) const { return Get<unsigned>(key); }
+	int   GetUnsigned(const std::string& key) const { return GetCached<unsigned>(key); }
 	/// @brief Get float, throw if key not present
-	float GetFloat(const std::string& key)    const { return Get<float>(key); }
+	float GetFloat(const std::string& key)    const { return GetCached<float>(key); }
+
+public:
+	class CachedValueBase
+	{
+	public:
+		CachedValueBase(const std::string& key) : key(key), valid(false) {}
+		virtual ~CachedValueBase() {}
+
+		virtual const std::type_info& GetType() const = 0;
+		/// re-parses the value, marks it as invalid if the key went missing
+		virtual void Refresh() = 0;
+
+		const std::string& GetKey() const { return key; }
+		bool IsValid() const { return valid; }
+
+	protected:
+		std::string key;
+		bool valid;
+	};
+
+	/**
+	 * @brief Parsed value of a config variable
+	 *
+	 * Get() is a plain read, the value is parsed again by the ConfigHandler
+	 * whenever it (or any other variable) is changed through SetString or
+	 * Delete, which also re-reads the config file.
+	 * There is no locking on reads, so only use it for trivial types when
+	 * accessed from multiple threads.
+	 */
+	template<typename T>
+	class CachedValue : public CachedValueBase
+	{
+	public:
+		/// throws if key is not present
+		CachedValue(const ConfigHandler* handler, const std::string& key)
+			: CachedValueBase(key)
+			, handler(handler)
+		{
+			handler->GetValue(key, value);
+			valid = true;
+		}
+
+		const std::type_info& GetType() const { return typeid(T); }
+
+		void Refresh() {
+			try {
+				handler->GetValue(key, value);
+				valid = true;
+			} catch (const std::runtime_error&) {
+				valid = false;
+			}
+		}
+
+		const T& Get() const { return value; }
+
+	private:
+		const ConfigHandler* handler;
+		T value;
+	};
+
+	/**
+	 * @brief Get a cached typed handle for a config variable, throw if key not present
+	 *
+	 * The handle is owned by the ConfigHandler and stays valid until it is
+	 * deallocated, so callers reading a value every frame can keep it.
+	 */
+	template<typename T>
+	const CachedValue<T>& GetCachedValue(const std::string& key) const
+	{
+		CachedValueBase* cv = FindCachedValue(key, typeid(T));
+
+		if (cv == NULL)
+			cv = AddCachedValue(new CachedValue<T>(this, key));
+
+		return *static_cast<const CachedValue<T>*>(cv);
+	}
 
 public:
 	virtual ~ConfigHandler() {}
@@ -139,7 +217,30 @@ protected:
 
 	virtual void AddObserver(ConfigNotifyCallback observer) = 0;
 
+	/// @return NULL if no handle exists yet for this key and type
+	virtual CachedValueBase* FindCachedValue(const std::string& key, const std::type_info& type) const = 0;
+	/// takes ownership, returns the already existing handle instead if another thread was faster
+	virtual CachedValueBase* AddCachedValue(CachedValueBase* cv) const = 0;
+
 private:
+	/// uses the cached value unless the key went missing (then this throws)
+	template<typename T>
+	T GetCached(const std::string& key) const
+	{
+		const CachedValue<T>& cv = GetCachedValue<T>(key);
+
+		if (cv.IsValid())
+			return cv.Get();
+
+		T value;
+		GetValue(key, value);
+		return value;
+	}
+
+	template<typename T>
+	void GetValue(const std::string& key, T& value) const { value = Get<T>(key); }
+	void GetValue(const std::string& key, bool& value) const { value = Get(key); }
+
 	/// @see GetString
 	template<typename T>
 	T Get(const std::string& key) const
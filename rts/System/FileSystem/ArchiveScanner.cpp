@@ -394,8 +394,6 @@ void CArchiveScanner::ScanDirs(const std::vector<std::string>& scanDirs, bool do
 
 void CArchiveScanner::Scan(const std::string& curPath, bool doChecksum)
 {
-	isDirty = true;
-
 	const int flags = (FileQueryFlags::INCLUDE_DIRS | FileQueryFlags::RECURSE);
 	const std::vector<std::string> &found = dataDirsAccess.FindFiles(curPath, "*", flags);
 
@@ -427,10 +425,12 @@ void CArchiveScanner::Scan(const std::string& curPath, bool doChecksum)
 #endif // !defined(DEDICATED) && !defined(UNITSYNC)
 		// Is this an archive we should look into?
 		if (archiveLoader.IsArchiveFile(fullName)) {
-			ScanArchive(fullName, doChecksum);
+			ScanArchiveInfo(fullName, doChecksum);
 		}
 	}
 
+	ComputePendingChecksums();
+
 	// Now we'll have to parse the replaces-stuff found in the mods
 	for (std::map<std::string, ArchiveInfo>::iterator aii = archiveInfos.begin(); aii != archiveInfos.end(); ++aii) {
 		for (std::vector<std::string>::const_iterator i = aii->second.archiveData.GetReplaces().begin(); i != aii->second.archiveData.GetReplaces().end(); ++i) {
@@ -443,6 +443,7 @@ void CArchiveScanner::Scan(const std::string& curPath, bool doChecksum)
 				ArchiveInfo tmp;
 				archiveInfos[lcname] = tmp;
 				ar = archiveInfos.find(lcname);
+				isDirty = true;
 			}
 
 			// Overwrite the info for this archive with a replaced pointer
@@ -470,6 +471,49 @@ static void AddDependency(std::vector<std::string>& deps, const std::string& dep
 }
 
 void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
+{
+	ScanArchiveInfo(fullName, doChecksum);
+	ComputePendingChecksums();
+}
+
+void CArchiveScanner::ComputePendingChecksums()
+{
+	if (pendingChecksums.empty())
+		return;
+
+	std::vector<unsigned int> checksums(pendingChecksums.size(), 0);
+
+	if (pendingChecksums.size() == 1) {
+		checksums[0] = GetCRC(pendingChecksums[0].second);
+	} else {
+		// archives are independent of each other, so hash whole archives
+		// concurrently; a first scan of a large (rapid) pool is dominated
+		// by opening thousands of small archives one after another
+		// (the CRC table is generated lazily, do that before going wide)
+		CRC();
+
+		for_mt(0, pendingChecksums.size(), [&](const int i) {
+			checksums[i] = GetCRC(pendingChecksums[i].second, false);
+		});
+	}
+
+	for (unsigned int i = 0; i < pendingChecksums.size(); i++) {
+		const std::map<std::string, ArchiveInfo>::iterator aii = archiveInfos.find(pendingChecksums[i].first);
+
+		if (aii == archiveInfos.end())
+			continue;
+		// the entry might have been superseded by a same-named archive elsewhere
+		if (aii->second.path != FileSystem::GetDirectory(pendingChecksums[i].second))
+			continue;
+
+		aii->second.checksum = checksums[i];
+		isDirty = true;
+	}
+
+	pendingChecksums.clear();
+}
+
+void CArchiveScanner::ScanArchiveInfo(const std::string& fullName, bool doChecksum)
 {
 	const std::string fn    = FileSystem::GetFilename(fullName);
 	const std::string fpath = FileSystem::GetDirectory(fullName);
@@ -513,6 +557,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 			// not the contents.
 			if (!cached) {
 				archiveInfos.erase(aii);
+				isDirty = true;
 			}
 		}
 	}
@@ -521,8 +566,11 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	if (cached) {
 		// If cached is true, aii will point to the archive
 		if (doChecksum && (aii->second.checksum == 0))
-			aii->second.checksum = GetCRC(fullName);
+			pendingChecksums.push_back(std::make_pair(lcfn, fullName));
 	} else {
+		// new or changed archive, the cache has to be rewritten
+		isDirty = true;
+
 		IArchive* ar = archiveLoader.OpenArchive(fullName);
 		if (!ar || !ar->IsOpen()) {
 			LOG("Unable to open archive: %s", fullName.c_str());
@@ -634,13 +682,12 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		// To prevent reading all files in all directory (.sdd) archives
 		// every time this function is called, directory archive checksums
 		// are calculated on the fly.
+		ai.checksum = 0;
+		archiveInfos[lcfn] = ai;
+
 		if (doChecksum) {
-			ai.checksum = GetCRC(fullName);
-		} else {
-			ai.checksum = 0;
+			pendingChecksums.push_back(std::make_pair(lcfn, fullName));
 		}
-
-		archiveInfos[lcfn] = ai;
 	}
 }
 
@@ -704,7 +751,7 @@ struct CRCPair {
  * Get CRC of the data in the specified archive.
  * Returns 0 if file could not be opened.
  */
-unsigned int CArchiveScanner::GetCRC(const std::string& arcName)
+unsigned int CArchiveScanner::GetCRC(const std::string& arcName, bool parallelFiles)
 {
 	CRC crc;
 	IArchive* ar;
@@ -750,7 +797,7 @@ unsigned int CArchiveScanner::GetCRC(const std::string& arcName)
 	//       it has to load the full file to calc it! For the other formats (sd7, sdz, sdp) the CRC is saved
 	//       in the metainformation of the container and so the loading is much faster. Neither does any of our
 	//       current (2011) packing libraries support multithreading :/
-	for_mt(0, crcs.size(), [&](const int i) {
+	const auto calcFileCRC = [&](const int i) {
 		CRCPair& crcp = crcs[i];
 		const unsigned int nameCRC = CRC().Update(crcp.filename->data(), crcp.filename->size()).GetDigest();
 		const unsigned fid = ar->FindFile(*crcp.filename);
@@ -760,15 +807,21 @@ unsigned int CArchiveScanner::GetCRC(const std::string& arcName)
 	#if !defined(DEDICATED) && !defined(UNITSYNC)
 		Watchdog::ClearTimer(WDT_MAIN);
 	#endif
-	});
+	};
+
+	if (parallelFiles) {
+		for_mt(0, crcs.size(), calcFileCRC);
+	} else {
+		for (unsigned int i = 0; i < crcs.size(); i++) {
+			calcFileCRC(i);
+		}
+	}
 
 	// Add file CRCs to the main archive CRC
+	// (no watchdog poke here, this may run on a worker thread)
 	for (std::vector<CRCPair>::iterator it = crcs.begin(); it != crcs.end(); ++it) {
 		crc.Update(it->nameCRC);
 		crc.Update(it->dataCRC);
-	#if !defined(DEDICATED) && !defined(UNITSYNC)
-		Watchdog::ClearTimer();
-	#endif
 	}
 
 	delete ignore;
@@ -882,21 +935,12 @@ void FilterDep(std::vector<std::string>& deps, const std::string& exclude)
 
 void CArchiveScanner::WriteCacheData(const std::string& filename)
 {
-	if (!isDirty) {
-		return;
-	}
-
-	FILE* out = fopen(filename.c_str(), "wt");
-	if (!out) {
-		LOG_L(L_ERROR, "Failed to write to \"%s\"!", filename.c_str());
-		return;
-	}
-
 	// First delete all outdated information
 	// TODO: this pattern should be moved into an utility function..
 	for (std::map<std::string, ArchiveInfo>::iterator i = archiveInfos.begin(); i != archiveInfos.end(); ) {
 		if (!i->second.updated) {
 			i = set_erase(archiveInfos, i);
+			isDirty = true;
 		} else {
 			++i;
 		}
@@ -904,11 +948,23 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 	for (std::map<std::string, BrokenArchive>::iterator i = brokenArchives.begin(); i != brokenArchives.end(); ) {
 		if (!i->second.updated) {
 			i = set_erase(brokenArchives, i);
+			isDirty = true;
 		} else {
 			++i;
 		}
 	}
 
+	// nothing was added, changed or removed since the cache was read
+	if (!isDirty) {
+		return;
+	}
+
+	FILE* out = fopen(filename.c_str(), "wt");
+	if (!out) {
+		LOG_L(L_ERROR, "Failed to write to \"%s\"!", filename.c_str());
+		return;
+	}
+
 	fprintf(out, "local archiveCache = {\n\n");
 	fprintf(out, "\tinternalver = %i,\n\n", INTERNAL_VER);
 	fprintf(out, "\tarchives = {  -- count = " _STPF_ "\n", archiveInfos.size());
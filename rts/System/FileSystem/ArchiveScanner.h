@@ -179,6 +179,10 @@ private:
 private:
 	void ScanDirs(const std::vector<std::string>& dirs, bool checksum = false);
 	void Scan(const std::string& curPath, bool doChecksum);
+	/// like ScanArchive, but only queues the checksum computation
+	void ScanArchiveInfo(const std::string& fullName, bool doChecksum);
+	/// computes all queued checksums, concurrently across archives
+	void ComputePendingChecksums();
 
 	/// scan mapinfo / modinfo lua files
 	bool ScanArchiveLua(IArchive* ar, const std::string& fileName, ArchiveInfo& ai, std::string& err);
@@ -191,13 +195,18 @@ private:
 	/**
 	 * Get CRC of the data in the specified archive.
 	 * Returns 0 if file could not be opened.
+	 * @param parallelFiles hash the archive's files concurrently; false when
+	 *   the caller already runs several GetCRC calls in parallel
 	 */
-	unsigned int GetCRC(const std::string& filename);
+	unsigned int GetCRC(const std::string& filename, bool parallelFiles = true);
 
 private:
 	std::map<std::string, ArchiveInfo> archiveInfos;
 	std::map<std::string, BrokenArchive> brokenArchives;
 
+	/// (lower-case archive name, full path) of archives awaiting a checksum
+	std::vector< std::pair<std::string, std::string> > pendingChecksums;
+
 	bool isDirty;
 	std::string cachefile;
 };
@@ -3,9 +3,21 @@
 
 #include "BufferedArchive.h"
 
+#include <algorithm>
+#include <cassert>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+// files above this size (in bytes) bypass the per-archive cache
+static const int MAX_CACHED_FILE_SIZE = 1024 * 1024;
+// upper bound on the data an archive keeps parked for prefetched files
+static const size_t MAX_PREFETCH_SIZE = 128 * 1024 * 1024;
+// upper bound on the worker threads used for concurrent prefetching
+static const unsigned int MAX_PREFETCH_THREADS = 8;
 
 CBufferedArchive::CBufferedArchive(const std::string& name, bool cache)
 	: IArchive(name)
+	, prefetchedSize(0)
 {
 	caching = cache;
 }
@@ -19,10 +31,38 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<boost::uint8_t>& bu
 	boost::mutex::scoped_lock lck(archiveLock);
 	assert(IsFileId(fid));
 
+	if (!prefetched.empty()) {
+		std::map<unsigned int, FileBuffer>::iterator it = prefetched.find(fid);
+
+		if (it != prefetched.end()) {
+			const bool exists = it->second.exists;
+
+			prefetchedSize -= it->second.data.size();
+			buffer.swap(it->second.data);
+			prefetched.erase(it);
+			return exists;
+		}
+	}
+
 	if (!caching) {
 		return GetFileImpl(fid,buffer);
 	}
 
+	{
+		// large files (map textures, sound banks) are typically read
+		// just once during loading; keeping a cached copy would hold
+		// a second full buffer for the archive's lifetime, so these
+		// are decompressed straight into the caller's buffer instead
+		std::string name;
+		int size = 0;
+
+		FileInfo(fid, name, size);
+
+		if (size > MAX_CACHED_FILE_SIZE) {
+			return GetFileImpl(fid, buffer);
+		}
+	}
+
 	if (fid >= cache.size()) {
 		cache.resize(fid + 1);
 	}
@@ -35,3 +75,118 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<boost::uint8_t>& bu
 	buffer = cache[fid].data;
 	return cache[fid].exists;
 }
+
+
+void CBufferedArchive::SortPrefetchOrder(std::vector<unsigned int>& fids) const
+{
+	std::sort(fids.begin(), fids.end());
+}
+
+void CBufferedArchive::PrefetchFiles(const std::vector<unsigned int>& fids)
+{
+	std::vector<unsigned int> order;
+	order.reserve(fids.size());
+
+	{
+		boost::mutex::scoped_lock lck(archiveLock);
+
+		size_t budget = (prefetchedSize < MAX_PREFETCH_SIZE)? (MAX_PREFETCH_SIZE - prefetchedSize): 0;
+
+		for (unsigned int n = 0; n < fids.size(); n++) {
+			const unsigned int fid = fids[n];
+
+			if (!IsFileId(fid))
+				continue;
+			if (prefetched.find(fid) != prefetched.end())
+				continue;
+			if (fid < cache.size() && cache[fid].populated)
+				continue;
+
+			std::string name;
+			int size = 0;
+
+			FileInfo(fid, name, size);
+
+			if (size_t(size) > budget)
+				continue;
+
+			budget -= size;
+			order.push_back(fid);
+		}
+	}
+
+	if (order.empty())
+		return;
+
+	SortPrefetchOrder(order);
+	order.erase(std::unique(order.begin(), order.end()), order.end());
+
+	std::vector<FileBuffer> buffers(order.size());
+
+	if (HasConcurrentGetFileImpl()) {
+		// archives are also used by unitsync and the dedicated server,
+		// so this does not depend on the engine's ThreadPool
+		const unsigned int numThreads = std::max(1u, std::min(std::min(boost::thread::hardware_concurrency(), MAX_PREFETCH_THREADS), unsigned(order.size())));
+
+		boost::mutex indexMutex;
+		boost::thread_group workers;
+		unsigned int nextIndex = 0;
+
+		for (unsigned int t = 0; t < numThreads; t++) {
+			workers.create_thread(boost::bind(&CBufferedArchive::PrefetchWorker, this, boost::cref(order), boost::ref(buffers), boost::ref(nextIndex), boost::ref(indexMutex)));
+		}
+
+		workers.join_all();
+	} else {
+		// single decompressor state; sequential, but in the order that
+		// lets consecutive files share already-decoded (solid) blocks
+		boost::mutex::scoped_lock lck(archiveLock);
+
+		for (unsigned int i = 0; i < order.size(); i++) {
+			buffers[i].exists = GetFileImpl(order[i], buffers[i].data);
+			buffers[i].populated = true;
+		}
+	}
+
+	boost::mutex::scoped_lock lck(archiveLock);
+
+	for (unsigned int i = 0; i < order.size(); i++) {
+		FileBuffer& fb = prefetched[order[i]];
+
+		prefetchedSize -= fb.data.size();
+		prefetchedSize += buffers[i].data.size();
+
+		fb.populated = true;
+		fb.exists = buffers[i].exists;
+		fb.data.swap(buffers[i].data);
+	}
+}
+
+void CBufferedArchive::PrefetchWorker(
+	const std::vector<unsigned int>& order,
+	std::vector<FileBuffer>& buffers,
+	unsigned int& nextIndex,
+	boost::mutex& indexMutex
+) {
+	while (true) {
+		unsigned int i;
+
+		{
+			boost::mutex::scoped_lock lck(indexMutex);
+
+			if ((i = nextIndex++) >= order.size())
+				return;
+		}
+
+		buffers[i].exists = GetFileImpl(order[i], buffers[i].data);
+		buffers[i].populated = true;
+	}
+}
+
+void CBufferedArchive::DropPrefetchedFiles()
+{
+	boost::mutex::scoped_lock lck(archiveLock);
+
+	prefetched.clear();
+	prefetchedSize = 0;
+}
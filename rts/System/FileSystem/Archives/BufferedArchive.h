@@ -11,6 +11,10 @@
 /**
  * Provides a helper implementation for archive types that can only uncompress
  * one file to memory at a time.
+ * Small files are cached after their first read; files larger than 1MB are
+ * always decompressed directly into the caller's buffer.
+ * Prefetched files are parked until their first GetFile call, which takes
+ * ownership of the data.
  */
 class CBufferedArchive : public IArchive
 {
@@ -20,9 +24,23 @@ public:
 
 	virtual bool GetFile(unsigned int fid, std::vector<boost::uint8_t>& buffer);
 
+	virtual void PrefetchFiles(const std::vector<unsigned int>& fids);
+	virtual void DropPrefetchedFiles();
+
 protected:
 	virtual bool GetFileImpl(unsigned int fid, std::vector<boost::uint8_t>& buffer) = 0;
 
+	/**
+	 * Returns true if GetFileImpl may be called concurrently for different
+	 * files without holding archiveLock, so prefetching can use workers.
+	 */
+	virtual bool HasConcurrentGetFileImpl() const { return false; }
+	/**
+	 * Orders the files of a prefetch request for the cheapest sequential
+	 * decompression; by default ascending file ID (archive order).
+	 */
+	virtual void SortPrefetchOrder(std::vector<unsigned int>& fids) const;
+
 	boost::mutex archiveLock; // neither 7zip nor zlib are threadsafe
 	struct FileBuffer
 	{
@@ -32,8 +50,18 @@ protected:
 		std::vector<boost::uint8_t> data;
 	};
 	std::vector<FileBuffer> cache; // cache[fileId]
+	std::map<unsigned int, FileBuffer> prefetched;
+private:
+	void PrefetchWorker(
+		const std::vector<unsigned int>& order,
+		std::vector<FileBuffer>& buffers,
+		unsigned int& nextIndex,
+		boost::mutex& indexMutex
+	);
+
 private:
 	bool caching;
+	size_t prefetchedSize; // bytes held in prefetched
 };
 
 #endif // _BUFFERED_ARCHIVE_H
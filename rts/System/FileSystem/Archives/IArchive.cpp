@@ -42,13 +42,13 @@ bool IArchive::HasLowReadingCost(unsigned int fid) const
 
 unsigned int IArchive::GetCrc32(unsigned int fid)
 {
-	CRC crc;
 	std::vector<boost::uint8_t> buffer;
 	if (GetFile(fid, buffer) && !buffer.empty()) {
-		crc.Update(&buffer[0], buffer.size());
+		// large files (e.g. the .smf of a map) are hashed in chunks
+		return CRC::CalcParallel(&buffer[0], buffer.size());
 	}
 
-	return crc.GetDigest();
+	return CRC().GetDigest();
 }
 
 bool IArchive::GetFile(const std::string& name, std::vector<boost::uint8_t>& buffer)
@@ -93,6 +93,18 @@ public:
 	 */
 	virtual unsigned int GetCrc32(unsigned int fid);
 
+	/**
+	 * Hints that the given files are about to be read.
+	 * Archive types that benefit from it may decompress them ahead of
+	 * time; the default implementation does nothing.
+	 * @param fids file IDs in [0, NumFiles())
+	 */
+	virtual void PrefetchFiles(const std::vector<unsigned int>& fids) {}
+	/**
+	 * Releases the data of prefetched files that have not been read yet.
+	 */
+	virtual void DropPrefetchedFiles() {}
+
 
 protected:
 	/// must be populated by the subclass
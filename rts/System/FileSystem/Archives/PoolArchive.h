@@ -85,6 +85,8 @@ public:
 
 protected:
 	virtual bool GetFileImpl(unsigned int fid, std::vector<boost::uint8_t>& buffer);
+	/// every pool file is a separate gzip stream
+	virtual bool HasConcurrentGetFileImpl() const { return true; }
 
 	struct FileData {
 		std::string name;
@@ -138,7 +138,10 @@ CSevenZipArchive::CSevenZipArchive(const std::string& name):
 	lookStream.realStream = &archiveStream.s;
 	LookToRead_Init(&lookStream);
 
-	CrcGenerateTable();
+	// the table is global; archives may be opened concurrently (see
+	// CArchiveScanner::ComputePendingChecksums), so generate it once
+	static const bool crcTableGenerated = (CrcGenerateTable(), true);
+	(void) crcTableGenerated;
 
 	SRes res = SzArEx_Open(&db, &lookStream.s, &allocImp, &allocTempImp);
 	if (res == SZ_OK) {
@@ -241,6 +244,22 @@ bool CSevenZipArchive::GetFileImpl(unsigned int fid, std::vector<boost::uint8_t>
 	}
 }
 
+void CSevenZipArchive::SortPrefetchOrder(std::vector<unsigned int>& fids) const
+{
+	std::vector< std::pair<UInt32, unsigned int> > keys(fids.size());
+
+	for (unsigned int i = 0; i < fids.size(); i++) {
+		keys[i].first = db.FileIndexToFolderIndexMap[fileData[fids[i]].fp];
+		keys[i].second = fids[i];
+	}
+
+	std::sort(keys.begin(), keys.end());
+
+	for (unsigned int i = 0; i < fids.size(); i++) {
+		fids[i] = keys[i].second;
+	}
+}
+
 void CSevenZipArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
@@ -43,6 +43,10 @@ public:
 	virtual bool HasLowReadingCost(unsigned int fid) const;
 	virtual unsigned GetCrc32(unsigned int fid);
 
+protected:
+	/// groups files by solid block, so each block is decoded only once
+	virtual void SortPrefetchOrder(std::vector<unsigned int>& fids) const;
+
 private:
 	UInt32 blockIndex;
 	Byte* outBuffer;
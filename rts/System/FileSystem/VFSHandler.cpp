@@ -73,7 +73,14 @@ bool CVFSHandler::AddArchive(const std::string& archiveName, bool override, cons
 		FileData d;
 		d.ar = ar;
 		d.size = size;
-		files[name] = d;
+
+		std::pair<boost::unordered_map<std::string, FileData>::iterator, bool> ins = files.insert(std::make_pair(name, d));
+
+		if (ins.second) {
+			AddToDirIndex(name);
+		} else {
+			ins.first->second = d;
+		}
 	}
 	return true;
 }
@@ -103,10 +110,11 @@ bool CVFSHandler::RemoveArchive(const std::string& archiveName)
 	}
 	
 	// remove the files loaded from the archive-to-remove
-	for (std::map<std::string, FileData>::iterator f = files.begin(); f != files.end();) {
+	for (boost::unordered_map<std::string, FileData>::iterator f = files.begin(); f != files.end();) {
 		if (f->second.ar == ar) {
 			LOG_L(L_DEBUG, "%s (removing)", f->first.c_str());
-			f = set_erase(files, f);
+			RemoveFromDirIndex(f->first);
+			f = files.erase(f);
 		} else {
 			 ++f;
 		}
@@ -133,11 +141,23 @@ std::string CVFSHandler::GetNormalizedPath(const std::string& rawPath)
 	return path;
 }
 
+std::string CVFSHandler::GetNormalizedDirPath(const std::string& rawDir)
+{
+	std::string dir = GetNormalizedPath(rawDir);
+
+	// non-empty directories are indexed with a trailing slash
+	if (!dir.empty() && dir[dir.length() - 1] != '/') {
+		dir += "/";
+	}
+
+	return dir;
+}
+
 const CVFSHandler::FileData* CVFSHandler::GetFileData(const std::string& normalizedFilePath)
 {
 	const FileData* fileData = NULL;
 
-	const std::map<std::string, FileData>::const_iterator fi = files.find(normalizedFilePath);
+	const boost::unordered_map<std::string, FileData>::const_iterator fi = files.find(normalizedFilePath);
 	if (fi != files.end()) {
 		fileData = &(fi->second);
 	}
@@ -145,6 +165,75 @@ const CVFSHandler::FileData* CVFSHandler::GetFileData(const std::string& normali
 	return fileData;
 }
 
+
+/// returns the parent of a (non-empty) directory path, "" for top-level ones
+static std::string GetParentDir(const std::string& dir)
+{
+	const std::string::size_type s = (dir.length() > 1)? dir.find_last_of("\\/", dir.length() - 2): std::string::npos;
+
+	if (s == std::string::npos)
+		return "";
+
+	return dir.substr(0, s + 1);
+}
+
+void CVFSHandler::AddToDirIndex(const std::string& normalizedFilePath)
+{
+	std::string dir = FileSystem::GetDirectory(normalizedFilePath);
+
+	dirs[dir].files.insert(normalizedFilePath.substr(dir.length()));
+
+	// link the directory into its ancestors; stop at the first one that
+	// already knows it, since everything above is linked as well
+	while (!dir.empty()) {
+		const std::string parent = GetParentDir(dir);
+
+		if (!dirs[parent].dirs.insert(dir.substr(parent.length())).second)
+			break;
+
+		dir = parent;
+	}
+}
+
+void CVFSHandler::RemoveFromDirIndex(const std::string& normalizedFilePath)
+{
+	std::string dir = FileSystem::GetDirectory(normalizedFilePath);
+	boost::unordered_map<std::string, DirData>::iterator di = dirs.find(dir);
+
+	if (di == dirs.end())
+		return;
+
+	di->second.files.erase(normalizedFilePath.substr(dir.length()));
+
+	// prune directories that became empty
+	while (!dir.empty() && di->second.files.empty() && di->second.dirs.empty()) {
+		const std::string parent = GetParentDir(dir);
+
+		dirs.erase(di);
+
+		if ((di = dirs.find(parent)) == dirs.end())
+			break;
+
+		di->second.dirs.erase(dir.substr(parent.length()));
+		dir = parent;
+	}
+}
+
+void CVFSHandler::GetFilesInDirRecursive(const std::string& normalizedDir, std::vector<std::string>& filePaths) const
+{
+	const boost::unordered_map<std::string, DirData>::const_iterator di = dirs.find(normalizedDir);
+
+	if (di == dirs.end())
+		return;
+
+	for (std::set<std::string>::const_iterator it = di->second.files.begin(); it != di->second.files.end(); ++it) {
+		filePaths.push_back(normalizedDir + *it);
+	}
+	for (std::set<std::string>::const_iterator it = di->second.dirs.begin(); it != di->second.dirs.end(); ++it) {
+		GetFilesInDirRecursive(normalizedDir + *it, filePaths);
+	}
+}
+
 bool CVFSHandler::LoadFile(const std::string& filePath, std::vector<boost::uint8_t>& buffer)
 {
 	LOG_L(L_DEBUG, "LoadFile(filePath = \"%s\", )", filePath.c_str());
@@ -165,6 +254,49 @@ bool CVFSHandler::LoadFile(const std::string& filePath, std::vector<boost::uint8
 	return true;
 }
 
+void CVFSHandler::PrefetchFiles(const std::vector<std::string>& filePaths)
+{
+	std::map<IArchive*, std::vector<unsigned int> > archiveFiles;
+
+	for (std::vector<std::string>::const_iterator it = filePaths.begin(); it != filePaths.end(); ++it) {
+		const std::string normalizedPath = GetNormalizedPath(*it);
+		const FileData* fileData = GetFileData(normalizedPath);
+
+		if (fileData == NULL)
+			continue;
+
+		const unsigned int fid = fileData->ar->FindFile(normalizedPath);
+
+		if (!fileData->ar->IsFileId(fid))
+			continue;
+
+		archiveFiles[fileData->ar].push_back(fid);
+	}
+
+	for (std::map<IArchive*, std::vector<unsigned int> >::const_iterator it = archiveFiles.begin(); it != archiveFiles.end(); ++it) {
+		it->first->PrefetchFiles(it->second);
+	}
+}
+
+void CVFSHandler::PrefetchDir(const std::string& rawDir)
+{
+	LOG_L(L_DEBUG, "PrefetchDir(rawDir = \"%s\")", rawDir.c_str());
+
+	std::vector<std::string> filePaths;
+	GetFilesInDirRecursive(GetNormalizedDirPath(rawDir), filePaths);
+
+	PrefetchFiles(filePaths);
+}
+
+void CVFSHandler::DropPrefetchedFiles()
+{
+	for (std::map<std::string, IArchive*>::const_iterator it = archives.begin(); it != archives.end(); ++it) {
+		if (it->second != NULL) {
+			it->second->DropPrefetchedFiles();
+		}
+	}
+}
+
 bool CVFSHandler::FileExists(const std::string& filePath)
 {
 	LOG_L(L_DEBUG, "FileExists(filePath = \"%s\", )", filePath.c_str());
@@ -190,43 +322,11 @@ std::vector<std::string> CVFSHandler::GetFilesInDir(const std::string& rawDir)
 	LOG_L(L_DEBUG, "GetFilesInDir(rawDir = \"%s\")", rawDir.c_str());
 
 	std::vector<std::string> ret;
-	std::string dir = GetNormalizedPath(rawDir);
-
-	std::map<std::string, FileData>::const_iterator filesStart = files.begin();
-	std::map<std::string, FileData>::const_iterator filesEnd   = files.end();
-
-	// Non-empty directories to look in should have a trailing backslash
-	if (!dir.empty()) {
-		std::string::size_type dirLast = (dir.length() - 1);
-		if (dir[dirLast] != '/') {
-			dir += "/";
-			dirLast++;
-		}
-		// limit the iterator range
-		std::string dirEnd = dir;
-		dirEnd[dirLast] = dirEnd[dirLast] + 1;
-		filesStart = files.lower_bound(dir);
-		filesEnd   = files.upper_bound(dirEnd);
-	}
-
-	while (filesStart != filesEnd) {
-		const std::string path = FileSystem::GetDirectory(filesStart->first);
-
-		// Check if this file starts with the dir path
-		if (path.compare(0, dir.length(), dir) == 0) {
 
-			// Strip pathname
-			const std::string name = filesStart->first.substr(dir.length());
+	const boost::unordered_map<std::string, DirData>::const_iterator di = dirs.find(GetNormalizedDirPath(rawDir));
 
-			// Do not return files in subfolders
-			if ((name.find('/') == std::string::npos)
-					&& (name.find('\\') == std::string::npos))
-			{
-				ret.push_back(name);
-				LOG_L(L_DEBUG, "%s", name.c_str());
-			}
-		}
-		++filesStart;
+	if (di != dirs.end()) {
+		ret.assign(di->second.files.begin(), di->second.files.end());
 	}
 
 	return ret;
@@ -238,44 +338,11 @@ std::vector<std::string> CVFSHandler::GetDirsInDir(const std::string& rawDir)
 	LOG_L(L_DEBUG, "GetDirsInDir(rawDir = \"%s\")", rawDir.c_str());
 
 	std::vector<std::string> ret;
-	std::string dir = GetNormalizedPath(rawDir);
-
-	std::map<std::string, FileData>::const_iterator filesStart = files.begin();
-	std::map<std::string, FileData>::const_iterator filesEnd   = files.end();
-
-	// Non-empty directories to look in should have a trailing backslash
-	if (!dir.empty()) {
-		std::string::size_type dirLast = (dir.length() - 1);
-		if (dir[dirLast] != '/') {
-			dir += "/";
-			++dirLast;
-		}
-		// limit the iterator range
-		std::string dirEnd = dir;
-		dirEnd[dirLast] = dirEnd[dirLast] + 1;
-		filesStart = files.lower_bound(dir);
-		filesEnd   = files.upper_bound(dirEnd);
-	}
 
-	std::set<std::string> dirs;
-
-	while (filesStart != filesEnd) {
-		const std::string path = FileSystem::GetDirectory(filesStart->first);
-		// Test to see if this file start with the dir path
-		if (path.compare(0, dir.length(), dir) == 0) {
-			// Strip pathname
-			const std::string name = filesStart->first.substr(dir.length());
-			const std::string::size_type slash = name.find_first_of("/\\");
-			if (slash != std::string::npos) {
-				dirs.insert(name.substr(0, slash + 1));
-			}
-		}
-		++filesStart;
-	}
+	const boost::unordered_map<std::string, DirData>::const_iterator di = dirs.find(GetNormalizedDirPath(rawDir));
 
-	for (std::set<std::string>::const_iterator it = dirs.begin(); it != dirs.end(); ++it) {
-		ret.push_back(*it);
-		LOG_L(L_DEBUG, "%s", it->c_str());
+	if (di != dirs.end()) {
+		ret.assign(di->second.dirs.begin(), di->second.dirs.end());
 	}
 
 	return ret;
@@ -4,9 +4,11 @@
 #define _VFS_HANDLER_H
 
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
 
 class IArchive;
 
@@ -53,6 +55,23 @@ public:
 	 */
 	std::vector<std::string> GetDirsInDir(const std::string& dir);
 
+	/**
+	 * Hints that the given files are about to be loaded, so archives may
+	 * decompress them ahead of time (see IArchive::PrefetchFiles).
+	 * @param filePaths raw file paths, case-insensitive
+	 */
+	void PrefetchFiles(const std::vector<std::string>& filePaths);
+	/**
+	 * Prefetches every file in the given (virtual) directory, recursively.
+	 * @param dir raw directory path, for example "objects3d/",
+	 *   case-insensitive
+	 */
+	void PrefetchDir(const std::string& dir);
+	/**
+	 * Releases all prefetched file data that has not been loaded yet.
+	 */
+	void DropPrefetchedFiles();
+
 	/**
 	 * Adds an archive to the VFS.
 	 * @param override determines whether in case of a  conflict, the existing
@@ -78,12 +97,24 @@ protected:
 		IArchive* ar;
 		int size;
 	};
-	std::map<std::string, FileData> files; 
+	/// entries of one (virtual) directory, kept sorted for listing
+	struct DirData {
+		std::set<std::string> files; ///< plain file names
+		std::set<std::string> dirs;  ///< sub-directory names, with trailing slash
+	};
+	boost::unordered_map<std::string, FileData> files;
+	/// key is the normalized directory path with trailing slash, "" for the root
+	boost::unordered_map<std::string, DirData> dirs;
 	std::map<std::string, IArchive*> archives;
 
 private:
 	std::string GetNormalizedPath(const std::string& rawPath);
+	std::string GetNormalizedDirPath(const std::string& rawDir);
 	const FileData* GetFileData(const std::string& normalizedFilePath);
+
+	void AddToDirIndex(const std::string& normalizedFilePath);
+	void RemoveFromDirIndex(const std::string& normalizedFilePath);
+	void GetFilesInDirRecursive(const std::string& normalizedDir, std::vector<std::string>& filePaths) const;
 };
 
 extern CVFSHandler* vfsHandler;
@@ -0,0 +1,157 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/FrameArena.h"
+#include "System/ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+
+CFrameArena::CFrameArena(size_t _blockSize)
+	: blockSize(_blockSize)
+	, curBlock(0)
+	, curOffset(0)
+	, usedBytes(0)
+	, peakBytes(0)
+	, numAllocs(0)
+{
+}
+
+CFrameArena::~CFrameArena()
+{
+	for (size_t n = 0; n < blocks.size(); n++) {
+		delete[] blocks[n].mem;
+	}
+}
+
+
+void* CFrameArena::Alloc(size_t numBytes, size_t alignment)
+{
+	assert((alignment & (alignment - 1)) == 0);
+
+	// try the current block first, then any (larger) ones after it
+	for (; curBlock < blocks.size(); curBlock++, curOffset = 0) {
+		const Block& b = blocks[curBlock];
+
+		const size_t addr = reinterpret_cast<size_t>(b.mem + curOffset);
+		const size_t padding = (alignment - (addr & (alignment - 1))) & (alignment - 1);
+
+		if ((curOffset + padding + numBytes) > b.size)
+			continue;
+
+		char* mem = b.mem + curOffset + padding;
+
+		curOffset += (padding + numBytes);
+		usedBytes += (padding + numBytes);
+		numAllocs += 1;
+		return mem;
+	}
+
+	Block b;
+	b.size = std::max(blockSize, numBytes + alignment);
+	b.mem = new char[b.size];
+
+	blocks.push_back(b);
+
+	curBlock = blocks.size() - 1;
+	curOffset = 0;
+
+	return (Alloc(numBytes, alignment));
+}
+
+void CFrameArena::Reset()
+{
+	peakBytes = std::max(peakBytes, usedBytes);
+
+	// if the frame spilled into more blocks, merge them so
+	// later frames of the same size fit into a single one
+	if (blocks.size() > 1) {
+		const size_t totalSize = GetReservedBytes();
+
+		for (size_t n = 0; n < blocks.size(); n++) {
+			delete[] blocks[n].mem;
+		}
+
+		blocks.resize(1);
+		blocks[0].size = totalSize;
+		blocks[0].mem = new char[totalSize];
+	}
+
+	curBlock = 0;
+	curOffset = 0;
+	usedBytes = 0;
+	numAllocs = 0;
+}
+
+size_t CFrameArena::GetReservedBytes() const
+{
+	size_t size = 0;
+
+	for (size_t n = 0; n < blocks.size(); n++) {
+		size += blocks[n].size;
+	}
+
+	return size;
+}
+
+
+static std::vector<CFrameArena>& GetArenas()
+{
+	// NOTE: with GML the sim- and draw-threads share slot 0
+	static std::vector<CFrameArena> arenas(ThreadPool::GetMaxThreads());
+	return arenas;
+}
+
+CFrameArena& CFrameArena::GetThreadArena()
+{
+	return (GetArenas()[ThreadPool::GetThreadNum()]);
+}
+
+void CFrameArena::ResetAll()
+{
+	std::vector<CFrameArena>& arenas = GetArenas();
+
+	for (size_t n = 0; n < arenas.size(); n++) {
+		arenas[n].Reset();
+	}
+}
+
+size_t CFrameArena::GetMaxPeakBytes()
+{
+	const std::vector<CFrameArena>& arenas = GetArenas();
+	size_t peak = 0;
+
+	for (size_t n = 0; n < arenas.size(); n++) {
+		peak = std::max(peak, arenas[n].GetPeakBytes());
+	}
+
+	return peak;
+}
+
+
+
+#ifdef COUNT_ALLOCATIONS
+// replaces the global allocation functions to count calls per thread;
+// only meant for finding allocation hot spots, see SCOPED_TIMER
+static __thread size_t threadAllocCount = 0;
+
+size_t GetThreadAllocCount() { return threadAllocCount; }
+
+static void* CountedAlloc(size_t numBytes)
+{
+	threadAllocCount += 1;
+
+	void* mem = malloc(std::max(numBytes, size_t(1)));
+
+	if (mem == NULL)
+		throw std::bad_alloc();
+
+	return mem;
+}
+
+void* operator new  (size_t numBytes) { return (CountedAlloc(numBytes)); }
+void* operator new[](size_t numBytes) { return (CountedAlloc(numBytes)); }
+void operator delete  (void* mem) throw() { free(mem); }
+void operator delete[](void* mem) throw() { free(mem); }
+#endif
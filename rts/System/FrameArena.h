@@ -0,0 +1,115 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _FRAME_ARENA_H_
+#define _FRAME_ARENA_H_
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+/**
+ * @brief linear allocator for short-lived sim-frame temporaries
+ *
+ * Allocating only bumps an offset and freeing is a no-op; all memory is
+ * handed back at once by Reset(), which CGame::SimFrame calls (through
+ * ResetAll) after every simulated frame. Blocks are kept between frames,
+ * so once the high-water mark is reached a frame makes no heap calls.
+ *
+ * Every (pool-)thread gets its own arena, see GetThreadArena(); nothing
+ * allocated from one may be used after the end of the frame.
+ */
+class CFrameArena
+{
+public:
+	static const size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+	CFrameArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+	~CFrameArena();
+
+	/// alignment must be a power of two; the default suits SSE types
+	void* Alloc(size_t numBytes, size_t alignment = 16);
+	void Reset();
+
+	size_t GetUsedBytes() const { return usedBytes; }
+	size_t GetPeakBytes() const { return peakBytes; }
+	size_t GetReservedBytes() const;
+	size_t GetNumAllocs() const { return numAllocs; }
+
+	/// arena of the calling thread
+	static CFrameArena& GetThreadArena();
+	/// resets the arenas of all threads, must not run concurrently with Alloc
+	static void ResetAll();
+	/// largest GetPeakBytes() over all threads
+	static size_t GetMaxPeakBytes();
+
+private:
+	CFrameArena(const CFrameArena&);
+	CFrameArena& operator = (const CFrameArena&);
+
+	struct Block {
+		char* mem;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+
+	const size_t blockSize;
+
+	size_t curBlock;
+	size_t curOffset;
+
+	size_t usedBytes;
+	size_t peakBytes;
+	size_t numAllocs;
+};
+
+
+/**
+ * @brief STL allocator adapter for CFrameArena
+ *
+ * Stateless (always uses the arena of the calling thread), so containers
+ * can be swapped and copied freely, e.g.
+ *   std::vector<int, frame_allocator<int> > tmp;
+ */
+template<typename T>
+class frame_allocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<typename U> struct rebind { typedef frame_allocator<U> other; };
+
+	frame_allocator() {}
+	template<typename U> frame_allocator(const frame_allocator<U>&) {}
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+
+	pointer allocate(size_type n, const void* hint = NULL) {
+		return static_cast<pointer>(CFrameArena::GetThreadArena().Alloc(n * sizeof(T)));
+	}
+	void deallocate(pointer p, size_type n) {}
+
+	size_type max_size() const { return (std::numeric_limits<size_type>::max() / sizeof(T)); }
+
+	void construct(pointer p, const T& val) { new (p) T(val); }
+	void destroy(pointer p) { p->~T(); }
+
+	bool operator == (const frame_allocator&) const { return true; }
+	bool operator != (const frame_allocator&) const { return false; }
+};
+
+
+#ifdef COUNT_ALLOCATIONS
+/// number of global operator new calls made by the calling thread so far
+size_t GetThreadAllocCount();
+#endif
+
+#endif // _FRAME_ARENA_H_
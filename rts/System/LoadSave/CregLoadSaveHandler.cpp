@@ -1,6 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <cstdio>
 #include <fstream>
+#include <sstream>
 
 #include "ExternalAI/EngineOutHandler.h"
 #include "CregLoadSaveHandler.h"
@@ -112,30 +114,45 @@ static void PrintSize(const char* txt, int size)
 void CCregLoadSaveHandler::SaveGame(const std::string& file)
 {
 	LOG("Saving game");
+
+	std::string data;
+
+	if (!SaveGameToBuffer(data))
+		return;
+
+	if (!WriteSaveFile(dataDirsAccess.LocateFile(file, FileQueryFlags::WRITE), data)) {
+		LOG_L(L_ERROR, "Save failed: unable to write game to file \"%s\"", file.c_str());
+	}
+}
+
+bool CCregLoadSaveHandler::SaveGameToBuffer(std::string& data)
+{
 	try {
-		std::ofstream ofs(dataDirsAccess.LocateFile(file, FileQueryFlags::WRITE).c_str(), std::ios::out|std::ios::binary);
-		if (ofs.bad() || !ofs.is_open()) {
-			throw content_error("Unable to save game to file \"" + file + "\"");
-		}
+		// serialize into memory first: creg queries the stream position
+		// for every member, which is a syscall each on a file stream
+		std::ostringstream oss(std::ios::out | std::ios::binary);
 
 		// write our own header. SavePackage() will add its own
-		WriteString(ofs, gameSetup->gameSetupText);
-		WriteString(ofs, modName);
-		WriteString(ofs, mapName);
+		WriteString(oss, gameSetup->gameSetupText);
+		WriteString(oss, modName);
+		WriteString(oss, mapName);
 
 		CGameStateCollector gsc = CGameStateCollector();
 
 		// save creg state
 		creg::COutputStreamSerializer os;
-		os.SavePackage(&ofs, &gsc, gsc.GetClass());
-		PrintSize("Game", ofs.tellp());
+		os.SavePackage(&oss, &gsc, gsc.GetClass());
+		PrintSize("Game", oss.tellp());
 
 		// save ai state
-		int aistart = ofs.tellp();
-		eoh->Save(&ofs);
-		PrintSize("AIs", ((int)ofs.tellp()) - aistart);
+		int aistart = oss.tellp();
+		eoh->Save(&oss);
+		PrintSize("AIs", ((int)oss.tellp()) - aistart);
 
 		//FIXME add lua state
+
+		data = oss.str();
+		return true;
 	} catch (const content_error& ex) {
 		LOG_L(L_ERROR, "Save failed(content error): %s", ex.what());
 	} catch (const std::exception& ex) {
@@ -147,6 +164,30 @@ void CCregLoadSaveHandler::SaveGame(const std::string& file)
 	} catch (...) {
 		LOG_L(L_ERROR, "Save failed(unknown error)");
 	}
+
+	return false;
+}
+
+bool CCregLoadSaveHandler::WriteSaveFile(const std::string& filePath, const std::string& data)
+{
+	// write next to the old file and swap afterwards, so a crash
+	// while writing never leaves a truncated savegame behind
+	const std::string tmpFilePath = filePath + ".tmp";
+
+	{
+		std::ofstream ofs(tmpFilePath.c_str(), std::ios::out | std::ios::binary);
+
+		if (ofs.bad() || !ofs.is_open())
+			return false;
+
+		ofs.write(data.data(), data.size());
+
+		if (ofs.bad())
+			return false;
+	}
+
+	std::remove(filePath.c_str());
+	return (std::rename(tmpFilePath.c_str(), filePath.c_str()) == 0);
 }
 
 /// this just loads the mapname and some other early stuff
@@ -13,6 +13,10 @@ public:
 	CCregLoadSaveHandler();
 	~CCregLoadSaveHandler();
 	void SaveGame(const std::string& file);
+	/// serializes the complete game state, i.e. the contents of a savegame file
+	bool SaveGameToBuffer(std::string& data);
+	/// does not touch any engine state, so it may run on another thread
+	static bool WriteSaveFile(const std::string& filePath, const std::string& data);
 	/// load things such as map and mod, needed to fire up the engine
 	void LoadGameStartInfo(const std::string& file);
 	void LoadGame();
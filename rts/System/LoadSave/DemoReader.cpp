@@ -10,6 +10,7 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
+#include "Net/Protocol/BaseNetProtocol.h"
 #include "Game/GameVersion.h"
 
 #include <limits.h>
@@ -20,6 +21,7 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 
 CDemoReader::CDemoReader(const std::string& filename, float curTime)
 	: playbackDemo(NULL)
+	, numFrames(-1)
 {
 	playbackDemo = new CFileHandler(filename, SPRING_VFS_PWD_ALL);
 
@@ -163,9 +165,11 @@ void CDemoReader::LoadStats()
 		teamStats.resize(fileHeader.numTeams);
 		// Read the array containing the number of team stats for each team.
 		std::vector<int> numStatsPerTeam(fileHeader.numTeams, 0);
-		playbackDemo->Read((char*) (&numStatsPerTeam[0]), numStatsPerTeam.size());
+		playbackDemo->Read((char*) (&numStatsPerTeam[0]), numStatsPerTeam.size() * sizeof(int));
 
 		for (int teamNum = 0; teamNum < fileHeader.numTeams; ++teamNum) {
+			swabDWordInPlace(numStatsPerTeam[teamNum]);
+
 			for (int i = 0; i < numStatsPerTeam[teamNum]; ++i) {
 				TeamStatistics buf;
 				playbackDemo->Read(reinterpret_cast<char*>(&buf), sizeof(TeamStatistics));
@@ -177,3 +181,66 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+
+const std::vector<CDemoReader::FrameIndexEntry>& CDemoReader::GetFrameIndex()
+{
+	if (numFrames < 0)
+		BuildFrameIndex();
+
+	return frameIndex;
+}
+
+int CDemoReader::GetNumFrames()
+{
+	if (numFrames < 0)
+		BuildFrameIndex();
+
+	return numFrames;
+}
+
+void CDemoReader::BuildFrameIndex()
+{
+	const int curPos = playbackDemo->GetPos();
+	const int streamStart = fileHeader.headerSize + fileHeader.scriptSize;
+	// see the constructor, a crashed recording has no stream size
+	const int streamEnd = (fileHeader.demoStreamSize != 0)? (streamStart + fileHeader.demoStreamSize): playbackDemoSize;
+
+	frameIndex.clear();
+	numFrames = 0;
+
+	for (int pos = streamStart; (pos + int(sizeof(DemoStreamChunkHeader))) <= streamEnd; ) {
+		DemoStreamChunkHeader header;
+		unsigned char msgID;
+
+		playbackDemo->Seek(pos);
+
+		if (playbackDemo->Read((char*)&header, sizeof(header)) < int(sizeof(header)))
+			break;
+
+		header.swab();
+
+		if (header.length == 0) {
+			pos += sizeof(header);
+			continue;
+		}
+		if (playbackDemo->Read((char*)&msgID, sizeof(msgID)) < int(sizeof(msgID)))
+			break;
+
+		switch (msgID) {
+			case NETMSG_KEYFRAME: {
+				const FrameIndexEntry entry = {++numFrames, header.modGameTime, pos};
+				frameIndex.push_back(entry);
+			} break;
+			case NETMSG_NEWFRAME: {
+				++numFrames;
+			} break;
+			default: {
+			} break;
+		}
+
+		pos += (sizeof(header) + header.length);
+	}
+
+	playbackDemo->Seek(curPos);
+}
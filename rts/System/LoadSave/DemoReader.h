@@ -55,7 +55,24 @@ public:
 	/// Not needed for normal demo watching
 	void LoadStats();
 
+	struct FrameIndexEntry {
+		int frameNum;
+		float modGameTime;
+		int filePos; ///< of the chunk-header holding the frame message
+	};
+
+	/**
+	@brief Frame -> stream-position index of all keyframes in the demo
+	Built by a (header-only) scan on first use, the read position is
+	restored afterwards. Not needed for normal demo watching.
+	*/
+	const std::vector<FrameIndexEntry>& GetFrameIndex();
+	/// number of (new- and key-) frames in the demo
+	int GetNumFrames();
+
 private:
+	void BuildFrameIndex();
+
 	CFileHandler* playbackDemo;
 
 	float demoTimeOffset;
@@ -70,6 +87,9 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+
+	std::vector<FrameIndexEntry> frameIndex;
+	int numFrames; ///< -1 until BuildFrameIndex has run
 };
 
 #endif
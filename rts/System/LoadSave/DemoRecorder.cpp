@@ -16,11 +16,17 @@
 #include <cerrno>
 #include <cstring>
 #include <fstream>
+#include <sstream>
 
-CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo):
-demoStream(std::ios::binary | std::ios::out)
+CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo)
 {
 	SetName(mapName, modName, serverDemo);
+
+	demoStream.open(dataDirsAccess.LocateFile(demoName, FileQueryFlags::WRITE).c_str(), std::ios::binary | std::ios::out);
+
+	if (!demoStream.is_open())
+		LOG_L(L_ERROR, "Could not open demo file for writing: %s", demoName.c_str());
+
 	SetFileHeader();
 }
 
@@ -31,7 +37,7 @@ CDemoRecorder::~CDemoRecorder()
 	WritePlayerStats();
 	WriteTeamStats();
 	WriteFileHeader(true);
-	WriteDemoFile(dataDirsAccess.LocateFile(demoName, FileQueryFlags::WRITE), demoStream.str());
+	demoStream.close();
 }
 
 void CDemoRecorder::SetFileHeader()
@@ -50,21 +56,6 @@ void CDemoRecorder::SetFileHeader()
 	demoStream.seekp(WriteFileHeader(false) + sizeof(DemoFileHeader));
 }
 
-void CDemoRecorder::WriteDemoFile(const std::string& name, const std::string& data)
-{
-	std::ofstream file;
-
-	// using operator<<(basic_stringbuf*) requires the stream to be opened with std::ios::in
-	// stringbuf::{eback(), egptr(), gptr()} are protected so we cannot access them directly
-	// (plus data is not guaranteed to be stored contiguously) ==> the only clean OO solution
-	// that avoids str()'s copy would be to supply our own stringbuffer backend to demoStream
-	// which is slightly overdoing it
-	file.open(name.c_str(), std::ios::binary | std::ios::out);
-	file.write(data.c_str(), data.size());
-	file.flush();
-	file.close();
-}
-
 void CDemoRecorder::WriteSetupText(const std::string& text)
 {
 	int length = text.length();
@@ -74,6 +65,10 @@ void CDemoRecorder::WriteSetupText(const std::string& text)
 
 	fileHeader.scriptSize = length;
 	demoStream.write(text.c_str(), length);
+
+	// the reader needs the script size to find the
+	// stream, even if we never get to finish the file
+	WriteFileHeader(false);
 }
 
 void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime)
@@ -150,15 +145,11 @@ void CDemoRecorder::SetPlayerStats(int playerNum, const PlayerStatistics& stats)
 }
 
 /** @brief Set (overwrite) the TeamStatistics history for team teamNum */
-void CDemoRecorder::SetTeamStats(int teamNum, const std::list< TeamStatistics >& stats)
+void CDemoRecorder::SetTeamStats(int teamNum, const std::deque< TeamStatistics >& stats)
 {
 	assert((unsigned)teamNum < teamStats.size());
 
-	teamStats[teamNum].clear();
-	teamStats[teamNum].reserve(stats.size());
-
-	for (std::list< TeamStatistics >::const_iterator it = stats.begin(); it != stats.end(); ++it)
-		teamStats[teamNum].push_back(*it);
+	teamStats[teamNum].assign(stats.begin(), stats.end());
 }
 
 
@@ -174,12 +165,7 @@ Write the DemoFileHeader at the start of the file and restores the original
 position in the file afterwards. */
 unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 {
-#ifdef _MSC_VER // MSVC8 behaves strange if tell/seek is called before anything has been written
-	const bool empty = (demoStream.str() == "");
-	const unsigned int pos = empty? 0 : demoStream.tellp();
-#else
 	const unsigned int pos = demoStream.tellp();
-#endif
 
 	DemoFileHeader tmpHeader;
 	memcpy(&tmpHeader, &fileHeader, sizeof(fileHeader));
@@ -187,13 +173,7 @@ unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 		tmpHeader.demoStreamSize = 0;
 	tmpHeader.swab(); // to little endian
 
-#ifdef _MSC_VER
-	if (!empty)
-#endif
-	{
-		demoStream.seekp(0);
-	}
-
+	demoStream.seekp(0);
 
 	demoStream.write((char*) &tmpHeader, sizeof(tmpHeader));
 	demoStream.seekp(pos);
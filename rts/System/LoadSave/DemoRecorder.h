@@ -4,8 +4,8 @@
 #define DEMO_RECORDER
 
 #include <vector>
-#include <sstream>
-#include <list>
+#include <fstream>
+#include <deque>
 
 #include "Demo.h"
 #include "Game/Players/PlayerStatistics.h"
@@ -13,6 +13,11 @@
 
 /**
  * @brief Used to record demos
+ *
+ * The demo is streamed to disk while it is being recorded. The header is
+ * rewritten with the final stream-size (and the statistics are appended)
+ * on destruction; until then the stream-size stays 0, which tells the
+ * reader to replay up to EOF, so a crash still leaves a playable demo.
  */
 class CDemoRecorder : public CDemo
 {
@@ -34,7 +39,7 @@ public:
 
 	void InitializeStats(int numPlayers, int numTeams );
 	void SetPlayerStats(int playerNum, const PlayerStatistics& stats);
-	void SetTeamStats(int teamNum, const std::list< TeamStatistics >& stats);
+	void SetTeamStats(int teamNum, const std::deque< TeamStatistics >& stats);
 	void SetWinningAllyTeams(const std::vector<unsigned char>& winningAllyTeams);
 
 private:
@@ -43,9 +48,8 @@ private:
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
-	void WriteDemoFile(const std::string& name, const std::string& data);
 
-	std::stringstream demoStream;
+	std::ofstream demoStream;
 	std::vector<PlayerStatistics> playerStats;
 	std::vector< std::vector<TeamStatistics> > teamStats;
 	std::vector<unsigned char> winningAllyTeams;
@@ -9,6 +9,7 @@
 #include <cstdio>
 #include <cstdarg>
 #include <cassert>
+#include <algorithm>
 #include <map>
 #include <set>
 #include <stack>
@@ -42,6 +43,17 @@ namespace {
 
 	int minLevel = LOG_LEVEL_ALL;
 
+	// lowest and highest min-level over all sections (including the
+	// default ones), lets log_frontend_isEnabled decide most records
+	// without looking up the section
+#ifdef DEBUG
+	int sectionMinLevelFloor = LOG_LEVEL_DEBUG;
+	int sectionMinLevelCeil  = LOG_LEVEL_INFO;
+#else
+	int sectionMinLevelFloor = LOG_LEVEL_INFO;
+	int sectionMinLevelCeil  = LOG_LEVEL_WARNING;
+#endif
+
 	secIntMap_t& log_filter_getSectionMinLevels() {
 		static secIntMap_t sectionMinLevels;
 		return sectionMinLevels;
@@ -121,6 +133,20 @@ void log_filter_section_setMinLevel(const char* section, int level) {
 	} else {
 		sectionMinLevels[section] = level;
 	}
+
+	const int defaultLevel = log_filter_section_getDefaultMinLevel(LOG_SECTION_DEFAULT);
+	const int otherLevel = log_filter_section_getDefaultMinLevel("_");
+	int levelFloor = std::min(defaultLevel, otherLevel);
+	int levelCeil  = std::max(defaultLevel, otherLevel);
+
+	secIntMap_t::const_iterator si;
+	for (si = sectionMinLevels.begin(); si != sectionMinLevels.end(); ++si) {
+		levelFloor = std::min(levelFloor, si->second);
+		levelCeil  = std::max(levelCeil, si->second);
+	}
+
+	sectionMinLevelFloor = levelFloor;
+	sectionMinLevelCeil  = levelCeil;
 }
 
 
@@ -184,8 +210,14 @@ static void log_filter_record(const char* section, int level, const char* fmt,
 
 bool log_frontend_isEnabled(const char* section, int level) {
 
-	return ((level >= log_filter_global_getMinLevel())
-			&& (level >= log_filter_section_getMinLevel(section)));
+	if (level < log_filter_global_getMinLevel())
+		return false;
+	if (level < sectionMinLevelFloor)
+		return false;
+	if (level >= sectionMinLevelCeil)
+		return true;
+
+	return (level >= log_filter_section_getMinLevel(section));
 }
 
 void log_frontend_registerSection(const char* section) {
@@ -12,8 +12,11 @@
 #include <cassert>
 #include <cstdio>
 #include <string>
-#include <list>
 #include <map>
+#include <vector>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 
 namespace {
@@ -48,81 +51,113 @@ namespace {
 	};
 	typedef std::map<std::string, LogFileDetails> logFiles_t;
 
+	struct LogRecord {
+		LogRecord(const std::string& section, int level,
+				const std::string& record)
+			: section(section)
+			, level(level)
+			, record(record)
+		{}
+
+		const std::string& GetSection() const { return section; }
+		int GetLevel() const { return level; }
+		const std::string& GetRecord() const { return record; }
+
+	private:
+		std::string section;
+		int level;
+		std::string record; ///< includes the frame prefix
+	};
+	typedef std::vector<LogRecord> logRecords_t;
+
 	/**
 	 * This is only used to check whether some code tries to access the
 	 * log-files contianer after it got deleted.
 	 */
 	bool logFilesValidTracker = true;
 
+	void log_file_writerThread();
+
 	/**
+	 * Records are only queued by the logging thread; a writer thread
+	 * (started with the first log file) does the actual file IO, so
+	 * slow disks or flushing do not stall the callers.
+	 * Until a log file is ready for output, the queue doubles as buffer.
+	 *
 	 * This class allows us to stop logging cleanly, when the application exits,
 	 * and while the container is still valid (not deleted yet).
 	 */
 	struct LogFilesContainer {
+		LogFilesContainer()
+			: writerThread(NULL)
+			, writerQuit(false)
+			, haveFiles(false)
+		{}
 		~LogFilesContainer() {
 			log_file_removeAllLogFiles();
+			StopWriter();
 			logFilesValidTracker = false;
 		}
+
+		void StartWriter() {
+			if (writerThread == NULL)
+				writerThread = new boost::thread(&log_file_writerThread);
+		}
+		void StopWriter() {
+			if (writerThread == NULL)
+				return;
+
+			{
+				boost::mutex::scoped_lock lock(queueMutex);
+				writerQuit = true;
+				queueCond.notify_one();
+			}
+
+			writerThread->join();
+			delete writerThread;
+			writerThread = NULL;
+		}
+
 		logFiles_t& GetLogFiles() {
 			return logFiles;
 		}
 
+	public:
+		/// guards logFiles and serializes writing, always locked before queueMutex
+		boost::mutex filesMutex;
+		/// guards queue, writerQuit and haveFiles
+		boost::mutex queueMutex;
+		boost::condition_variable queueCond;
+
+		logRecords_t queue;
+
+		boost::thread* writerThread;
+		bool writerQuit;
+		/// mirrors !logFiles.empty() for the writer thread
+		bool haveFiles;
+
 	private:
 		logFiles_t logFiles;
 	};
 
-	inline logFiles_t& log_file_getLogFiles() {
+	inline LogFilesContainer& log_file_getContainer() {
 		static LogFilesContainer logFilesContainer;
 
 		assert(logFilesValidTracker);
-		return logFilesContainer.GetLogFiles();
+		return logFilesContainer;
 	}
 
-	/**
-	 * This class allows us to stop logging cleanly, when the application exits,
-	 * and while the container is still valid (not deleted yet).
-	 */
-	struct LogRecord {
-		LogRecord(const std::string& section, int level,
-				const std::string& record)
-			: section(section)
-			, level(level)
-			, record(record)
-		{}
-
-		const std::string& GetSection() const { return section; }
-		int GetLevel() const { return level; }
-		const std::string& GetRecord() const { return record; }
-
-	private:
-		std::string section;
-		int level;
-		std::string record;
-	};
-	typedef std::list<LogRecord> logRecords_t;
-
-	inline logRecords_t& log_file_getRecordBuffer() {
-		static logRecords_t buffer;
-		return buffer;
+	inline logFiles_t& log_file_getLogFiles() {
+		return log_file_getContainer().GetLogFiles();
 	}
 
 	inline bool log_file_isActivelyLogging() {
 		return (!log_file_getLogFiles().empty());
 	}
 
-	void log_file_writeToFile(FILE* outStream, const char* record, bool flush) {
-
-		char framePrefix[128] = {'\0'};
-		log_framePrefixer_createPrefix(framePrefix, sizeof(framePrefix));
-
-		FPRINTF(outStream, "%s%s\n", framePrefix, record);
-
-		if (flush)
-			fflush(outStream);
-	}
-
 	/**
 	 * Writes to the individual log files, if they do want to log the section.
+	 * Expects filesMutex to be locked.
 	 */
 	void log_file_writeToFiles(const char* section, int level,
 			const char* record)
@@ -133,50 +168,93 @@ namespace {
 			if (lfi->second.IsLogging(section, level)
 					&& (lfi->second.GetOutStream() != NULL))
 			{
-				log_file_writeToFile(lfi->second.GetOutStream(), record, lfi->second.FlushOnWrite());
+				FPRINTF(lfi->second.GetOutStream(), "%s\n", record);
 			}
 		}
 	}
 
-	/**
-	 * Flushes the buffer of a single log file.
-	 */
-	void log_file_flushFile(FILE* outStream) {
-		fflush(outStream);
-	}
-
 	/**
 	 * Flushes the buffers of the individual log files.
+	 * Expects filesMutex to be locked.
+	 * @param all also flush files that do not want to be flushed on write
 	 */
-	void log_file_flushFiles() {
+	void log_file_flushFiles(bool all) {
 		const logFiles_t& logFiles = log_file_getLogFiles();
 		logFiles_t::const_iterator lfi;
 		for (lfi = logFiles.begin(); lfi != logFiles.end(); ++lfi) {
-			if (lfi->second.GetOutStream() != NULL) {
-				log_file_flushFile(lfi->second.GetOutStream());
+			if ((lfi->second.GetOutStream() != NULL) && (all || lfi->second.FlushOnWrite())) {
+				fflush(lfi->second.GetOutStream());
 			}
 		}
 	}
 
 	/**
-	 * Writes the content of the buffer to all the currently registered log
-	 * files.
+	 * Writes the queued records to all the currently registered log files,
+	 * flush-on-write files are flushed once per batch.
+	 * Expects filesMutex to be locked, returns false if nothing was written.
 	 */
-	void log_file_writeBufferToFiles() {
+	bool log_file_writeQueueToFiles(logRecords_t& batch) {
+
+		LogFilesContainer& container = log_file_getContainer();
 
-		while (!log_file_getRecordBuffer().empty()) {
-			logRecords_t& logRecords = log_file_getRecordBuffer();
-			const logRecords_t::iterator lri = logRecords.begin();
+		// buffer until a log file is ready for output
+		if (!log_file_isActivelyLogging())
+			return false;
+
+		{
+			boost::mutex::scoped_lock lock(container.queueMutex);
+			batch.swap(container.queue);
+		}
+
+		if (batch.empty())
+			return false;
+
+		logRecords_t::const_iterator lri;
+		for (lri = batch.begin(); lri != batch.end(); ++lri) {
 			log_file_writeToFiles(lri->GetSection().c_str(), lri->GetLevel(),
 					lri->GetRecord().c_str());
-			logRecords.erase(lri);
 		}
+		batch.clear();
+
+		log_file_flushFiles(false);
+		return true;
 	}
 
-	inline void log_file_writeToBuffer(const std::string& section, int level,
-			const std::string& record)
+	void log_file_writerThread() {
+		LogFilesContainer& container = log_file_getContainer();
+		logRecords_t batch;
+
+		while (true) {
+			{
+				boost::mutex::scoped_lock lock(container.queueMutex);
+
+				// without files, the queue is kept as buffer
+				while ((container.queue.empty() || !container.haveFiles) && !container.writerQuit)
+					container.queueCond.wait(lock);
+
+				// the remaining records were written by log_file_removeLogFile
+				if (container.writerQuit)
+					break;
+			}
+
+			boost::mutex::scoped_lock lock(container.filesMutex);
+			log_file_writeQueueToFiles(batch);
+		}
+	}
+
+	inline void log_file_writeToQueue(const char* section, int level,
+			const char* record)
 	{
-		log_file_getRecordBuffer().push_back(LogRecord(section, level, record));
+		char framePrefix[128] = {'\0'};
+		log_framePrefixer_createPrefix(framePrefix, sizeof(framePrefix));
+
+		LogFilesContainer& container = log_file_getContainer();
+
+		boost::mutex::scoped_lock lock(container.queueMutex);
+		container.queue.push_back(LogRecord(section, level, std::string(framePrefix) + record));
+
+		if (container.writerThread != NULL)
+			container.queueCond.notify_one();
 	}
 }
 
@@ -206,13 +284,31 @@ void log_file_addLogFile(const char* filePath, const char* sections, int minLeve
 	setvbuf(tmpStream, NULL, _IOFBF, (BUFSIZ < 8192) ? BUFSIZ : 8192); // limit buffer to 8kB
 
 	const std::string sectionsStr = (sections == NULL) ? "" : sections;
-	logFiles[filePathStr] = LogFileDetails(tmpStream, sectionsStr, minLevel, flush);
+
+	LogFilesContainer& container = log_file_getContainer();
+
+	{
+		boost::mutex::scoped_lock lock(container.filesMutex);
+		logFiles[filePathStr] = LogFileDetails(tmpStream, sectionsStr, minLevel, flush);
+
+		boost::mutex::scoped_lock queueLock(container.queueMutex);
+		container.haveFiles = true;
+	}
+
+	// also writes out what was buffered so far
+	container.StartWriter();
+	container.queueCond.notify_one();
 }
 
 void log_file_removeLogFile(const char* filePath) {
 
 	assert(filePath != NULL);
 
+	LogFilesContainer& container = log_file_getContainer();
+	logRecords_t batch;
+
+	boost::mutex::scoped_lock lock(container.filesMutex);
+
 	logFiles_t& logFiles = log_file_getLogFiles();
 	const std::string filePathStr = filePath;
 	const logFiles_t::iterator lfi = logFiles.find(filePathStr);
@@ -221,9 +317,18 @@ void log_file_removeLogFile(const char* filePath) {
 		return;
 	}
 
+	// do not lose what is still queued for it
+	log_file_writeQueueToFiles(batch);
+
 	// turn off logging to this file
 	FILE* tmpStream = lfi->second.GetOutStream();
 	logFiles.erase(lfi);
+
+	{
+		boost::mutex::scoped_lock queueLock(container.queueMutex);
+		container.haveFiles = !logFiles.empty();
+	}
+
 	fclose(tmpStream);
 	tmpStream = NULL;
 }
@@ -231,8 +336,8 @@ void log_file_removeLogFile(const char* filePath) {
 void log_file_removeAllLogFiles() {
 
 	while (!log_file_getLogFiles().empty()) {
-		const logFiles_t::const_iterator lfi = log_file_getLogFiles().begin();
-		log_file_removeLogFile(lfi->first.c_str());
+		const std::string filePath = log_file_getLogFiles().begin()->first;
+		log_file_removeLogFile(filePath.c_str());
 	}
 }
 
@@ -246,23 +351,33 @@ void log_file_removeAllLogFiles() {
 static void log_sink_record_file(const char* section, int level,
 		const char* record)
 {
-	if (logFilesValidTracker && log_file_isActivelyLogging()) {
-		// write buffer to log file
-		log_file_writeBufferToFiles();
+	if (!logFilesValidTracker)
+		return;
 
-		// write current record to log file
-		log_file_writeToFiles(section, level, record);
-	} else {
-		// buffer until a log file is ready for output
-		log_file_writeToBuffer(section, level, record);
-	}
+	// the writer thread picks it up, or it stays buffered
+	// until a log file is ready for output
+	log_file_writeToQueue(section, level, record);
 }
 
-/// Cleans up all log streams, by flushing them.
+/// Cleans up all log streams, by writing out the queue and flushing them.
 static void log_sink_cleanup_file() {
+	if (!logFilesValidTracker)
+		return;
+
+	LogFilesContainer& container = log_file_getContainer();
+
+	// called in exceptional situations (crash handling), so do not wait
+	// for a writer that might never return
+	boost::mutex::scoped_try_lock lock(container.filesMutex);
+
+	if (!lock.owns_lock())
+		return;
+
 	if (log_file_isActivelyLogging()) {
+		logRecords_t batch;
+		log_file_writeQueueToFiles(batch);
 		// flush the log buffers to files
-		log_file_flushFiles();
+		log_file_flushFiles(true);
 	}
 }
 
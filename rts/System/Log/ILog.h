@@ -70,9 +70,9 @@ extern void log_frontend_registerSection(const char* section);
 /**
  * Where all log messages get directed to after having passed the frontend.
  * The main connection to the backend/sink.
- * This will receive all log messages that are not disabled at compile-time
- * already, so it has to check internally, whether the criteria for logging
- * are really met, so it will have to call log_frontend_isEnabled() internally.
+ * The LOG*() macros only call this if log_frontend_isEnabled() returned true,
+ * but as it may also be called directly, it has to check internally, whether
+ * the criteria for logging are really met.
  */
 extern void log_frontend_record(const char* section, int level, const char* fmt,
 		...) FORMAT_STRING(3);
@@ -180,8 +180,11 @@ extern void log_frontend_cleanup();
  */
 
 /// Redirect to runtime processing
+// the arguments are not evaluated at all for filtered out records
 #define _LOG_RECORD(section, level, fmt, ...) \
-	log_frontend_record(section, LOG_LEVE##level, fmt, ##__VA_ARGS__)
+	(log_frontend_isEnabled(section, LOG_LEVE##level) \
+		? log_frontend_record(section, LOG_LEVE##level, fmt, ##__VA_ARGS__) \
+		: (void)0)
 
 // per level compile-time filters
 #if _LOG_IS_ENABLED_LEVEL_STATIC(L_DEBUG)
@@ -1,39 +1,72 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "System/MemPool.h"
+#include "System/Log/ILog.h"
+#include "System/ThreadPool.h"
 //#include "System/mmgr.h"
 
+#include <algorithm>
+
 CMemPool mempool;
 
-CMemPool::CMemPool()
+
+
+static std::vector<CMemPool*>& GetPools()
+{
+	static std::vector<CMemPool*> pools;
+	return pools;
+}
+
+
+CMemPool::CMemPool(const char* _name, size_t _maxMemSize)
+	: name(_name)
+	, maxMemSize(_maxMemSize)
+	, caches(std::max(1, ThreadPool::GetMaxThreads()))
+	, usedBytes(0)
 {
-	for (size_t a = 0; a < (MAX_MEM_SIZE + 1); a++) {
-		nextFree[a] = NULL;
-		poolSize[a] = 10;
+	for (size_t n = 0; n < caches.size(); n++) {
+		caches[n].nextFree.resize(maxMemSize + 1, NULL);
+		caches[n].poolSize.resize(maxMemSize + 1, 10);
+		caches[n].reservedBytes = 0;
 	}
+
+	GetPools().push_back(this);
+}
+
+CMemPool::ThreadCache& CMemPool::GetThreadCache()
+{
+	// NOTE: with GML the sim- and draw-threads share slot 0
+	return caches[ThreadPool::GetThreadNum()];
 }
 
 void* CMemPool::Alloc(size_t numBytes)
 {
+	usedBytes += numBytes;
+
 	if (UseExternalMemory(numBytes)) {
 		return ::operator new(numBytes);
 	} else {
-		void* pnt = nextFree[numBytes];
+		ThreadCache& tc = GetThreadCache();
+
+		void* pnt = tc.nextFree[numBytes];
 
 		if (pnt) {
-			nextFree[numBytes] = (*(void**)pnt);
+			tc.nextFree[numBytes] = (*(void**)pnt);
 		} else {
-			void* newBlock = ::operator new(numBytes * poolSize[numBytes]);
-			allocated.push_back(newBlock);
-			for (int i = 0; i < (poolSize[numBytes] - 1); ++i) {
+			const int poolSize = tc.poolSize[numBytes];
+
+			void* newBlock = ::operator new(numBytes * poolSize);
+			tc.allocated.push_back(newBlock);
+			tc.reservedBytes += (numBytes * poolSize);
+			for (int i = 0; i < (poolSize - 1); ++i) {
 				*(void**)&((char*)newBlock)[(i) * numBytes] = (void*)&((char*)newBlock)[(i + 1) * numBytes];
 			}
 
-			*(void**)&((char*)newBlock)[(poolSize[numBytes] - 1) * numBytes] = 0;
+			*(void**)&((char*)newBlock)[(poolSize - 1) * numBytes] = 0;
 
 			pnt = newBlock;
-			nextFree[numBytes] = (*(void**)pnt);
-			poolSize[numBytes] *= 2;
+			tc.nextFree[numBytes] = (*(void**)pnt);
+			tc.poolSize[numBytes] *= 2;
 		}
 		return pnt;
 	}
@@ -45,16 +78,49 @@ void CMemPool::Free(void* pnt, size_t numBytes)
 		return;
 	}
 
+	usedBytes -= numBytes;
+
 	if (UseExternalMemory(numBytes)) {
 		::operator delete(pnt);
 	} else {
-		*(void**)pnt = nextFree[numBytes];
-		nextFree[numBytes] = pnt;
+		ThreadCache& tc = GetThreadCache();
+
+		*(void**)pnt = tc.nextFree[numBytes];
+		tc.nextFree[numBytes] = pnt;
+	}
+}
+
+size_t CMemPool::GetReservedBytes() const
+{
+	size_t bytes = 0;
+
+	for (size_t n = 0; n < caches.size(); n++) {
+		bytes += caches[n].reservedBytes;
+	}
+
+	return bytes;
+}
+
+void CMemPool::PrintStats()
+{
+	const std::vector<CMemPool*>& pools = GetPools();
+
+	LOG("%20s|%14s|%14s", "Pool", "Used", "Reserved");
+
+	for (size_t n = 0; n < pools.size(); n++) {
+		const CMemPool* pool = pools[n];
+
+		LOG("%20s %12luKB %12luKB", pool->GetName(), (unsigned long) (pool->GetUsedBytes() / 1024), (unsigned long) (pool->GetReservedBytes() / 1024));
 	}
 }
 
 CMemPool::~CMemPool()
 {
-	for(std::vector<void *>::iterator i = allocated.begin(); i != allocated.end(); ++i)
-		::operator delete(*i);
+	std::vector<CMemPool*>& pools = GetPools();
+	pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+
+	for (size_t n = 0; n < caches.size(); n++) {
+		for (std::vector<void*>::iterator i = caches[n].allocated.begin(); i != caches[n].allocated.end(); ++i)
+			::operator delete(*i);
+	}
 }
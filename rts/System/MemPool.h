@@ -7,6 +7,8 @@
 #include <cstring> // for size_t
 #include <vector>
 
+#include "System/Platform/Threading.h"
+
 static const size_t MAX_MEM_SIZE = 200;
 
 /**
@@ -15,28 +17,58 @@ static const size_t MAX_MEM_SIZE = 200;
  * You may think of this as something like a very primitive garbage collector.
  * Instead of actually freeing memory, it is kept allocated, and is just
  * reassigned next time an alloc of the same size is performed.
- * The maximum memory held by this class is approximately MAX_MEM_SIZE^2 bytes.
+ * The maximum memory held by this class is approximately MAX_MEM_SIZE^2 bytes
+ * per thread.
+ *
+ * Every (pool-)thread has its own free-lists, so Alloc and Free never lock;
+ * a block freed by another thread than the one that allocated it simply
+ * moves over to the free-list of the freeing thread.
+ * Each pool is named after the subsystem it serves and keeps count of the
+ * bytes it hands out (including the ones it passes on to ::operator new),
+ * see PrintStats.
  */
 class CMemPool
 {
 public:
-	CMemPool();
+	CMemPool(const char* name = "misc", size_t maxMemSize = MAX_MEM_SIZE);
 	~CMemPool();
 
 	void* Alloc(size_t numBytes);
 	void Free(void* pnt, size_t numBytes);
 
+	const char* GetName() const { return name; }
+
+	/// bytes currently handed out by this pool
+	size_t GetUsedBytes() const { return usedBytes; }
+	/// bytes held in pooled blocks (excludes the external allocations)
+	size_t GetReservedBytes() const;
+
+	/// logs the accounting of every pool
+	static void PrintStats();
+
 private:
-	static bool UseExternalMemory(size_t numBytes) {
-		return (numBytes > MAX_MEM_SIZE) || (numBytes < 4);
+	bool UseExternalMemory(size_t numBytes) const {
+		return (numBytes > maxMemSize) || (numBytes < sizeof(void*));
 	}
 
-	void* nextFree[MAX_MEM_SIZE + 1];
-	int poolSize[MAX_MEM_SIZE + 1];
-	std::vector<void *> allocated;
+	struct ThreadCache {
+		std::vector<void*> nextFree;
+		std::vector<int> poolSize;
+		std::vector<void*> allocated;
+
+		size_t reservedBytes;
+	};
+
+	ThreadCache& GetThreadCache();
+
+	const char* name;
+	const size_t maxMemSize;
+
+	std::vector<ThreadCache> caches;
+
+	Threading::AtomicCounterInt64 usedBytes;
 };
 
 extern CMemPool mempool;
 
 #endif // _MEM_POOL_H_
-
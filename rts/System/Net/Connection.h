@@ -27,6 +27,12 @@ public:
 	 */
 	virtual void SendData(boost::shared_ptr<const RawPacket> data) = 0;
 
+	/**
+	 * @brief Whether SendData() accepts a packet holding several
+	 *   concatenated messages, which the receiver splits up again
+	 */
+	virtual bool AcceptsMessageStreams() const { return false; }
+
 	virtual bool HasIncomingData() const = 0;
 
 	/**
@@ -63,6 +69,7 @@ public:
 	virtual bool NeedsReconnect() = 0;
 
 	unsigned int GetDataReceived() const { return dataRecv; }
+	unsigned int GetDataSent() const { return dataSent; }
 	virtual unsigned int GetPacketQueueSize() const { return 0; }
 
 	virtual std::string Statistics() const = 0;
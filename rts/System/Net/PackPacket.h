@@ -5,6 +5,7 @@
 
 #include "RawPacket.h"
 #include "System/SafeVector.h"
+#include "System/SmallVector.h"
 
 #include <string>
 #include <vector>
@@ -62,6 +63,17 @@ public:
 	}
 #endif
 
+	template <typename element, unsigned int N>
+	PackPacket& operator<<(const small_vector<element, N>& vec) {
+		const size_t size = vec.size() * sizeof(element);
+		assert((size + pos) <= length);
+		if (size > 0) {
+			std::memcpy((data+pos), (void*)(vec.data()), size);
+			pos += size;
+		}
+		return *this;
+	}
+
 	unsigned char* GetWritingPos() {
 		return data + pos;
 	}
@@ -2,6 +2,9 @@
 
 #include <string.h>
 #include <stdexcept>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
 
 #include "RawPacket.h"
 
@@ -10,11 +13,80 @@
 namespace netcode
 {
 
+/**
+ * Recycles the buffers of small packets (new-frame, keyframe, sync
+ * responses, most received UDP packets), which would otherwise make up
+ * the bulk of all allocations in the network code. Blocks are carved out
+ * of slabs and never returned to the heap; packets are created and freed
+ * by the net and the main thread, hence the lock.
+ */
+class SmallPacketPool
+{
+public:
+	static const unsigned BLOCK_SIZE = 64;
+	static const unsigned SLAB_BLOCKS = 256;
+
+	static SmallPacketPool& GetInstance() {
+		// intentionally leaked so that packets freed during static
+		// destruction (eg. by a lingering connection) remain valid
+		static SmallPacketPool* pool = new SmallPacketPool();
+		return *pool;
+	}
+
+	unsigned char* Alloc() {
+		boost::mutex::scoped_lock lock(mutex);
+
+		if (freeBlocks.empty()) {
+			unsigned char* slab = new unsigned char[BLOCK_SIZE * SLAB_BLOCKS];
+
+			freeBlocks.reserve(freeBlocks.capacity() + SLAB_BLOCKS);
+
+			for (unsigned n = 0; n < SLAB_BLOCKS; n++) {
+				freeBlocks.push_back(slab + (SLAB_BLOCKS - n - 1) * BLOCK_SIZE);
+			}
+		}
+
+		unsigned char* block = freeBlocks.back();
+		freeBlocks.pop_back();
+		return block;
+	}
+
+	void Free(unsigned char* block) {
+		boost::mutex::scoped_lock lock(mutex);
+		freeBlocks.push_back(block);
+	}
+
+private:
+	std::vector<unsigned char*> freeBlocks;
+	boost::mutex mutex;
+};
+
+
+static unsigned char* AllocPacketData(const unsigned length)
+{
+	if (length <= SmallPacketPool::BLOCK_SIZE)
+		return (SmallPacketPool::GetInstance().Alloc());
+
+	return (new unsigned char[length]);
+}
+
+static void FreePacketData(unsigned char* data, const unsigned length)
+{
+	if (length <= SmallPacketPool::BLOCK_SIZE) {
+		SmallPacketPool::GetInstance().Free(data);
+	} else {
+		delete[] data;
+	}
+}
+
+
+
 RawPacket::RawPacket(const unsigned char* const tdata, const unsigned newLength)
-	: length(newLength)
+	: data(NULL)
+	, length(newLength)
 {
 	if (length > 0) {
-		data = new unsigned char[length];
+		data = AllocPacketData(length);
 		memcpy(data, tdata, length);
 	} else {
 		LOG_L(L_ERROR, "Tried to pack a zero lengh packet");
@@ -23,17 +95,18 @@ RawPacket::RawPacket(const unsigned char* const tdata, const unsigned newLength)
 }
 
 RawPacket::RawPacket(const unsigned newLength)
-	: length(newLength)
+	: data(NULL)
+	, length(newLength)
 {
 	if (length > 0) {
-		data = new unsigned char[length];
+		data = AllocPacketData(length);
 	}
 }
 
 RawPacket::~RawPacket()
 {
 	if (length > 0) {
-		delete[] data;
+		FreePacketData(data, length);
 	}
 }
 
@@ -2,9 +2,18 @@
 
 #include "Socket.h"
 
+#include <algorithm>
+#include <cassert>
 #include <boost/system/error_code.hpp>
 #include "lib/streflop/streflop_cond.h"
 
+#if defined(__linux__)
+	#include <cerrno>
+	#include <cstring>
+	#include <sys/socket.h>
+	#define HAVE_MMSG_SOCKET_CALLS
+#endif
+
 #include "System/Log/ILog.h"
 
 namespace netcode
@@ -100,5 +109,136 @@ boost::asio::ip::tcp::resolver::iterator WrapResolve(
 	return resolveIt;
 }
 
+
+
+UDPReceiveBatch::UDPReceiveBatch()
+	: buffer(MAX_DATAGRAMS * MAX_DATAGRAM_SIZE)
+{
+	for (unsigned int i = 0; i < MAX_DATAGRAMS; i++) {
+		sizes[i] = 0;
+	}
+}
+
+unsigned int UDPReceiveBatch::Receive(boost::asio::ip::udp::socket& socket, boost::system::error_code& err)
+{
+	err.clear();
+
+#ifdef HAVE_MMSG_SOCKET_CALLS
+	mmsghdr msgs[MAX_DATAGRAMS];
+	iovec iovs[MAX_DATAGRAMS];
+
+	memset(msgs, 0, sizeof(msgs));
+
+	for (unsigned int i = 0; i < MAX_DATAGRAMS; i++) {
+		iovs[i].iov_base = &buffer[i * MAX_DATAGRAM_SIZE];
+		iovs[i].iov_len = MAX_DATAGRAM_SIZE;
+
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = senders[i].data();
+		msgs[i].msg_hdr.msg_namelen = senders[i].capacity();
+	}
+
+	const int numReceived = recvmmsg(socket.native_handle(), msgs, MAX_DATAGRAMS, MSG_DONTWAIT, NULL);
+
+	if (numReceived < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			err.assign(errno, boost::system::system_category());
+		}
+		return 0;
+	}
+
+	for (int i = 0; i < numReceived; i++) {
+		senders[i].resize(msgs[i].msg_hdr.msg_namelen);
+		sizes[i] = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)? 0: msgs[i].msg_len;
+	}
+
+	return numReceived;
+#else
+	unsigned int numReceived = 0;
+	size_t bytesAvailable = 0;
+
+	while ((numReceived < MAX_DATAGRAMS) && ((bytesAvailable = socket.available(err)) > 0) && !err) {
+		if (bytesAvailable > MAX_DATAGRAM_SIZE) {
+			// too large, receive it only to discard it
+			std::vector<boost::uint8_t> discard(bytesAvailable);
+			socket.receive_from(boost::asio::buffer(discard), senders[numReceived], 0, err);
+			sizes[numReceived] = 0;
+		} else {
+			sizes[numReceived] = socket.receive_from(boost::asio::buffer(&buffer[numReceived * MAX_DATAGRAM_SIZE], MAX_DATAGRAM_SIZE), senders[numReceived], 0, err);
+		}
+
+		if (err)
+			break;
+
+		numReceived++;
+	}
+
+	return numReceived;
+#endif
+}
+
+
+unsigned int SendDatagrams(
+		boost::asio::ip::udp::socket& socket,
+		const boost::asio::ip::udp::endpoint& dest,
+		const std::vector< std::vector<boost::uint8_t> >& datagrams,
+		unsigned int numDatagrams,
+		boost::system::error_code& err)
+{
+	assert(numDatagrams <= datagrams.size());
+	err.clear();
+
+	unsigned int numSent = 0;
+
+#ifdef HAVE_MMSG_SOCKET_CALLS
+	mmsghdr msgs[UDPReceiveBatch::MAX_DATAGRAMS];
+	iovec iovs[UDPReceiveBatch::MAX_DATAGRAMS];
+
+	while (numSent < numDatagrams) {
+		const unsigned int batchSize = std::min(numDatagrams - numSent, (unsigned int) UDPReceiveBatch::MAX_DATAGRAMS);
+
+		memset(msgs, 0, sizeof(msgs));
+
+		for (unsigned int i = 0; i < batchSize; i++) {
+			const std::vector<boost::uint8_t>& datagram = datagrams[numSent + i];
+
+			iovs[i].iov_base = const_cast<boost::uint8_t*>(datagram.empty()? NULL: &datagram[0]);
+			iovs[i].iov_len = datagram.size();
+
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_name = const_cast<sockaddr*>(dest.data());
+			msgs[i].msg_hdr.msg_namelen = dest.size();
+		}
+
+		const int batchSent = sendmmsg(socket.native_handle(), msgs, batchSize, 0);
+
+		if (batchSent < 0) {
+			err.assign(errno, boost::system::system_category());
+			break;
+		}
+
+		numSent += batchSent;
+
+		// partial batch: the socket buffer is full, drop the rest like
+		// a failing send_to would
+		if (unsigned(batchSent) < batchSize) {
+			err.assign(EAGAIN, boost::system::system_category());
+			break;
+		}
+	}
+#else
+	for (; numSent < numDatagrams; numSent++) {
+		socket.send_to(boost::asio::buffer(datagrams[numSent]), dest, 0, err);
+
+		if (err)
+			break;
+	}
+#endif
+
+	return numSent;
+}
+
 } // namespace netcode
 
@@ -7,6 +7,8 @@
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/cstdint.hpp>
+#include <vector>
 
 
 namespace netcode
@@ -49,6 +51,51 @@ boost::asio::ip::tcp::resolver::iterator WrapResolve(
 		boost::asio::ip::tcp::resolver::query& query,
 		boost::system::error_code* err = NULL);
 
+/**
+ * @brief Receives datagrams from a UDP socket in batches.
+ * On Linux a single recvmmsg call fetches up to MAX_DATAGRAMS datagrams,
+ * elsewhere this falls back to one receive_from per pending datagram.
+ * The buffers are reused, received data is only valid until the next call.
+ */
+class UDPReceiveBatch
+{
+public:
+	static const unsigned int MAX_DATAGRAMS = 32;
+	/// larger (truncated) datagrams are reported with size 0
+	static const unsigned int MAX_DATAGRAM_SIZE = 8192;
+
+	UDPReceiveBatch();
+
+	/**
+	 * Receives whatever is pending without blocking.
+	 * @return number of datagrams received before the socket ran dry or
+	 *   an error occured (in which case err is set)
+	 */
+	unsigned int Receive(boost::asio::ip::udp::socket& socket, boost::system::error_code& err);
+
+	const boost::uint8_t* GetData(unsigned int i) const { return &buffer[i * MAX_DATAGRAM_SIZE]; }
+	size_t GetSize(unsigned int i) const { return sizes[i]; }
+	const boost::asio::ip::udp::endpoint& GetSender(unsigned int i) const { return senders[i]; }
+
+private:
+	std::vector<boost::uint8_t> buffer;
+	size_t sizes[MAX_DATAGRAMS];
+	boost::asio::ip::udp::endpoint senders[MAX_DATAGRAMS];
+};
+
+/**
+ * Sends the first numDatagrams datagrams of a list to one end-point, with
+ * one sendmmsg call per UDPReceiveBatch::MAX_DATAGRAMS datagrams on Linux
+ * and one send_to per datagram elsewhere.
+ * @return number of datagrams sent before the first error (err is set)
+ */
+unsigned int SendDatagrams(
+		boost::asio::ip::udp::socket& socket,
+		const boost::asio::ip::udp::endpoint& dest,
+		const std::vector< std::vector<boost::uint8_t> >& datagrams,
+		unsigned int numDatagrams,
+		boost::system::error_code& err);
+
 } // namespace netcode
 
 #endif // SOCKET_H
@@ -5,6 +5,7 @@
 #include <boost/format.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
 
 
 #include "Socket.h"
@@ -70,11 +71,50 @@ void Chunk::UpdateChecksum(CRC& crc) const {
 
 	crc << chunkNumber;
 	crc << (unsigned int)chunkSize;
-	if (!data.empty()) {
-		crc.Update(&data[0], data.size());
+	if (chunkSize > 0) {
+		crc.Update(&data[0], chunkSize);
 	}
 }
 
+// memory of released chunks, reused by Chunk::operator new; both are
+// intentionally never destroyed, so chunks may be released at shutdown
+static std::vector<void*>* chunkFreeList = new std::vector<void*>();
+static boost::mutex* chunkFreeListMutex = new boost::mutex();
+static const size_t maxFreeChunks = 4096;
+
+void* Chunk::operator new(size_t size)
+{
+	assert(size == sizeof(Chunk));
+	{
+		boost::mutex::scoped_lock lock(*chunkFreeListMutex);
+
+		if (!chunkFreeList->empty()) {
+			void* p = chunkFreeList->back();
+			chunkFreeList->pop_back();
+			return p;
+		}
+	}
+
+	return ::operator new(size);
+}
+
+void Chunk::operator delete(void* p)
+{
+	if (p == NULL)
+		return;
+
+	{
+		boost::mutex::scoped_lock lock(*chunkFreeListMutex);
+
+		if (chunkFreeList->size() < maxFreeChunks) {
+			chunkFreeList->push_back(p);
+			return;
+		}
+	}
+
+	::operator delete(p);
+}
+
 unsigned Packet::GetSize() const {
 
 	unsigned size = headerSize + naks.size();
@@ -117,8 +157,8 @@ public:
 		pos += sizeof(t);
 	}
 
-	void Unpack(std::vector<boost::uint8_t>& t, unsigned unpackLength) {
-		std::copy(data + pos, data + pos + unpackLength, std::back_inserter(t));
+	void Unpack(boost::uint8_t* t, unsigned unpackLength) {
+		std::copy(data + pos, data + pos + unpackLength, t);
 		pos += unpackLength;
 	}
 
@@ -147,8 +187,12 @@ public:
 		*reinterpret_cast<T*>(&data[pos]) = t;
 	}
 
-	void Pack(std::vector<boost::uint8_t>& _data) {
-		std::copy(_data.begin(), _data.end(), std::back_inserter(data));
+	void Pack(const std::vector<boost::uint8_t>& _data) {
+		data.insert(data.end(), _data.begin(), _data.end());
+	}
+
+	void Pack(const boost::uint8_t* _data, unsigned length) {
+		data.insert(data.end(), _data, _data + length);
 	}
 
 private:
@@ -180,7 +224,7 @@ Packet::Packet(const unsigned char* data, unsigned length)
 		ChunkPtr temp(new Chunk);
 		buf.Unpack(temp->chunkNumber);
 		buf.Unpack(temp->chunkSize);
-		if (buf.Remaining() >= temp->chunkSize) {
+		if (buf.Remaining() >= temp->chunkSize && temp->chunkSize <= Chunk::maxSize) {
 			buf.Unpack(temp->data, temp->chunkSize);
 			chunks.push_back(temp);
 		} else {
@@ -208,7 +252,7 @@ void Packet::Serialize(std::vector<boost::uint8_t>& data)
 	for (ci = chunks.begin(); ci != chunks.end(); ++ci) {
 		buf.Pack((*ci)->chunkNumber);
 		buf.Pack((*ci)->chunkSize);
-		buf.Pack((*ci)->data);
+		buf.Pack((*ci)->data, (*ci)->chunkSize);
 	}
 }
 
@@ -308,31 +352,34 @@ void UDPConnection::Update()
 	if (!sharedSocket && !closed) {
 		// duplicated code with UDPListener
 		netservice.poll();
-		size_t bytes_avail = 0;
-		while ((bytes_avail = mySocket->available()) > 0) {
-			std::vector<boost::uint8_t> buffer(bytes_avail);
-			ip::udp::endpoint sender_endpoint;
-			size_t bytesReceived;
-			ip::udp::socket::message_flags flags = 0;
-			boost::system::error_code err;
-			bytesReceived = mySocket->receive_from(boost::asio::buffer(buffer), sender_endpoint, flags, err);
-
-			if (CheckErrorCode(err)) {
-				break;
-			}
 
-			if (bytesReceived < Packet::headerSize) {
-				continue;
-			}
-			Packet data(&buffer[0], bytesReceived);
-			if (IsUsingAddress(sender_endpoint)) {
-				ProcessRawPacket(data);
+		if (recvBatch.get() == NULL) {
+			recvBatch.reset(new UDPReceiveBatch());
+		}
+
+		boost::system::error_code err;
+		unsigned int numReceived = 0;
+
+		do {
+			numReceived = recvBatch->Receive(*mySocket, err);
+
+			for (unsigned int n = 0; n < numReceived; ++n) {
+				if (recvBatch->GetSize(n) < Packet::headerSize) {
+					continue;
+				}
+				Packet data(recvBatch->GetData(n), recvBatch->GetSize(n));
+				if (IsUsingAddress(recvBatch->GetSender(n))) {
+					ProcessRawPacket(data);
+				}
 			}
+
 			// not likely, but make sure we do not get stuck here
 			if ((spring_gettime() - curTime) > spring_msecs(10)) {
 				break;
 			}
-		}
+		} while ((numReceived == UDPReceiveBatch::MAX_DATAGRAMS) && !err);
+
+		CheckErrorCode(err);
 	}
 
 	Flush(false);
@@ -403,7 +450,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 			++droppedChunks;
 			continue;
 		}
-		waitingPackets.insert((*ci)->chunkNumber, new RawPacket(&(*ci)->data[0], (*ci)->data.size()));
+		waitingPackets.insert((*ci)->chunkNumber, new RawPacket(&(*ci)->data[0], (*ci)->chunkSize));
 	}
 
 	packetMap::iterator wpi;
@@ -474,6 +521,9 @@ void UDPConnection::Flush(const bool forced)
 		// someone in the game gives a large order.
 		bool partialPacket = false;
 		bool sendMore = true;
+		// sent bytes of the front packet, a packet is always
+		// completed by the same Flush call that started it
+		unsigned packetPos = 0;
 
 		do {
 			sendMore = (outgoing.GetAverage(true) <= globalConfig->linkOutgoingBandwidth)
@@ -489,17 +539,16 @@ void UDPConnection::Flush(const bool forced)
 							packet->length);
 					outgoingData.pop_front();
 				} else {
-					unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length);
+					unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length - packetPos);
 					assert(packet->length > 0);
-					memcpy(buffer+pos, packet->data, numBytes);
+					memcpy(buffer+pos, packet->data + packetPos, numBytes);
 					pos+= numBytes;
+					packetPos += numBytes;
 					outgoing.DataSent(numBytes, true);
-					partialPacket = (numBytes != packet->length);
-					if (partialPacket) {
-						// partially transfered
-						packet.reset(new RawPacket(packet->data + numBytes, packet->length - numBytes));
-					} else { // full packet copied
+					partialPacket = (packetPos != packet->length);
+					if (!partialPacket) { // full packet copied
 						outgoingData.pop_front();
+						packetPos = 0;
 					}
 				}
 			}
@@ -590,6 +639,7 @@ void UDPConnection::Init()
 	lastReceiveTime = spring_gettime();
 	lastInOrder = -1;
 	waitingPackets.clear();
+	numQueuedPackets = 0;
 	currentNum = 0;
 	lastNak = -1;
 	sentOverhead = 0;
@@ -617,7 +667,7 @@ void UDPConnection::CreateChunk(const unsigned char* data, const unsigned length
 	ChunkPtr buf(new Chunk);
 	buf->chunkNumber = packetNum;
 	buf->chunkSize = length;
-	std::copy(data, data+length, std::back_inserter(buf->data));
+	std::copy(data, data+length, buf->data);
 	newChunks.push_back(buf);
 	lastChunkCreated = spring_gettime();
 }
@@ -782,28 +832,51 @@ void UDPConnection::SendIfNecessary(bool flushed)
 				RequestResend(unackedChunks[i]);
 		}
 	}
+
+	FlushSendQueue();
 }
 
 void UDPConnection::SendPacket(Packet& pkt)
 {
-	std::vector<boost::uint8_t> data;
+	// serialize in place into a (capacity-retaining) send-queue slot
+	if (numQueuedPackets == sendQueue.size()) {
+		sendQueue.push_back(std::vector<boost::uint8_t>());
+	}
+
+	std::vector<boost::uint8_t>& data = sendQueue[numQueuedPackets];
+	data.clear();
 	pkt.Serialize(data);
 
 	outgoing.DataSent(data.size());
 	lastSendTime = spring_gettime();
-	ip::udp::socket::message_flags flags = 0;
+	ip::udp::socket::message_flags flags = 0; // only used by EMULATE_LATENCY
 	boost::system::error_code err;
+	(void) flags;
 
 	EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
-		mySocket->send_to(buffer(data), addr, flags, err);
+		// sent together with the others of this flush, see FlushSendQueue
+		++numQueuedPackets;
 	}
 
-	if (CheckErrorCode(err)) {
+	CheckErrorCode(err);
+}
+
+void UDPConnection::FlushSendQueue()
+{
+	if (numQueuedPackets == 0)
 		return;
+
+	boost::system::error_code err;
+	const unsigned int numSent = SendDatagrams(*mySocket, addr, sendQueue, numQueuedPackets, err);
+
+	for (unsigned int i = 0; i < numSent; ++i) {
+		dataSent += sendQueue[i].size();
 	}
 
-	dataSent += data.size();
-	++sentPackets;
+	sentPackets += numSent;
+	numQueuedPackets = 0;
+
+	CheckErrorCode(err);
 }
 
 void UDPConnection::AckChunks(int lastAck)
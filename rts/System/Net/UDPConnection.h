@@ -4,7 +4,9 @@
 #define _UDP_CONNECTION_H
 
 #include <boost/ptr_container/ptr_map.hpp>
+#include <boost/intrusive_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/asio/ip/udp.hpp>
 #include <deque>
 #include <list>
@@ -26,20 +28,44 @@ namespace netcode {
 #define PACKET_MIN_LATENCY 750                // in [milliseconds] minimum latency
 #define PACKET_MAX_LATENCY 1250               // in [milliseconds] maximum latency
 
+class UDPReceiveBatch;
+
+/**
+ * A chunk stores its payload inline and is reference-counted intrusively;
+ * the memory of released chunks is recycled (see Chunk::operator new), so
+ * creating one normally does not touch the heap.
+ * Like UDPConnection itself, chunks are not meant to be shared between
+ * threads, hence the plain reference-counter.
+ */
 class Chunk
 {
 public:
+	Chunk(): chunkNumber(0), chunkSize(0), refCount(0) {}
+
 	unsigned GetSize() const {
-		return data.size() + headerSize;
+		return chunkSize + headerSize;
 	}
 	void UpdateChecksum(CRC& crc) const;
+
+	static void* operator new(size_t size);
+	static void operator delete(void* p);
+
 	static const unsigned maxSize = 254;
 	static const unsigned headerSize = 5;
 	boost::int32_t chunkNumber;
 	boost::uint8_t chunkSize;
-	std::vector<boost::uint8_t> data;
+	boost::uint8_t data[maxSize];
+
+private:
+	friend void intrusive_ptr_add_ref(Chunk* chunk);
+	friend void intrusive_ptr_release(Chunk* chunk);
+
+	unsigned int refCount;
 };
-typedef boost::shared_ptr<Chunk> ChunkPtr;
+inline void intrusive_ptr_add_ref(Chunk* chunk) { ++chunk->refCount; }
+inline void intrusive_ptr_release(Chunk* chunk) { if (--chunk->refCount == 0) delete chunk; }
+
+typedef boost::intrusive_ptr<Chunk> ChunkPtr;
 
 class Packet
 {
@@ -120,6 +146,8 @@ public:
 	bool IsUsingAddress(const boost::asio::ip::udp::endpoint& from) const;
 	/// Connections are stealth by default, this allow them to send data
 	void Unmute() { muted = false; }
+	/// outgoing data is re-chunked and parsed by message length on arrival
+	bool AcceptsMessageStreams() const { return true; }
 	void Close(bool flush);
 	void SetLossFactor(int factor);
 
@@ -142,7 +170,10 @@ private:
 	void AckChunks(int lastAck);
 
 	void RequestResend(ChunkPtr ptr);
+	/// serialize a packet and queue it for FlushSendQueue
 	void SendPacket(Packet& pkt);
+	/// send all queued packets (batched where the platform supports it)
+	void FlushSendQueue();
 
 	spring_time lastChunkCreated;
 	spring_time lastReceiveTime;
@@ -167,6 +198,14 @@ private:
 
 	/// outgoing stuff (pure data without header) waiting to be sended
 	packetList outgoingData;
+	/**
+	 * serialized packets of the current SendIfNecessary call; only the
+	 * first numQueuedPackets are valid, the rest keep their capacity
+	 */
+	std::vector< std::vector<boost::uint8_t> > sendQueue;
+	unsigned int numQueuedPackets;
+	/// receive buffers, only allocated for connections owning their socket
+	boost::scoped_ptr<UDPReceiveBatch> recvBatch;
 
 	/// Newly created and not yet sent
 	std::deque<ChunkPtr> newChunks;
@@ -116,56 +116,58 @@ bool UDPListener::TryBindSocket(int port, SocketPtr* socket, const std::string&
 void UDPListener::Update() {
 	netservice.poll();
 
-	size_t bytes_avail = 0;
+	boost::system::error_code err;
+	unsigned int numReceived = 0;
 
-	while ((bytes_avail = mySocket->available()) > 0) {
-		std::vector<boost::uint8_t> buffer(bytes_avail);
-		ip::udp::endpoint sender_endpoint;
-		boost::asio::ip::udp::socket::message_flags flags = 0;
-		boost::system::error_code err;
-		size_t bytesReceived = mySocket->receive_from(boost::asio::buffer(buffer), sender_endpoint, flags, err);
+	// drain the socket batch-wise (one recvmmsg per batch where available)
+	do {
+		numReceived = recvBatch.Receive(*mySocket, err);
 
-		ConnMap::iterator ci = conn.find(sender_endpoint);
-		bool knownConnection = (ci != conn.end());
+		for (unsigned int n = 0; n < numReceived; n++) {
+			const ip::udp::endpoint& sender_endpoint = recvBatch.GetSender(n);
+			const size_t bytesReceived = recvBatch.GetSize(n);
 
-		if (knownConnection && ci->second.expired())
-			continue;
+			ConnMap::iterator ci = conn.find(sender_endpoint);
+			bool knownConnection = (ci != conn.end());
 
-		if (CheckErrorCode(err))
-			break;
+			if (knownConnection && ci->second.expired())
+				continue;
 
-		if (bytesReceived < Packet::headerSize)
-			continue;
+			if (bytesReceived < Packet::headerSize)
+				continue;
 
-		Packet data(&buffer[0], bytesReceived);
+			Packet data(recvBatch.GetData(n), bytesReceived);
 
-		if (knownConnection) {
-			ci->second.lock()->ProcessRawPacket(data);
-		}
-		else { // still have the packet (means no connection with the sender's address found)
-			if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
-				if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
-					// new client wants to connect
-					boost::shared_ptr<UDPConnection> incoming(new UDPConnection(mySocket, sender_endpoint));
-					waiting.push(incoming);
-					conn[sender_endpoint] = incoming;
-					incoming->ProcessRawPacket(data);
-				}
+			if (knownConnection) {
+				ci->second.lock()->ProcessRawPacket(data);
 			}
-			else {
-				LOG_L(L_WARNING, "Dropping packet from unknown IP: [%s]:%i",
-						sender_endpoint.address().to_string().c_str(),
-						sender_endpoint.port());
-			#ifdef DEBUG
-				std::string conns;
-				for (ConnMap::iterator it = conn.begin(); it != conn.end(); ++it) {
-					conns += str(boost::format(" [%s]:%i;") %it->first.address().to_string().c_str() %it->first.port());
+			else { // still have the packet (means no connection with the sender's address found)
+				if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
+					if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
+						// new client wants to connect
+						boost::shared_ptr<UDPConnection> incoming(new UDPConnection(mySocket, sender_endpoint));
+						waiting.push(incoming);
+						conn[sender_endpoint] = incoming;
+						incoming->ProcessRawPacket(data);
+					}
+				}
+				else {
+					LOG_L(L_WARNING, "Dropping packet from unknown IP: [%s]:%i",
+							sender_endpoint.address().to_string().c_str(),
+							sender_endpoint.port());
+				#ifdef DEBUG
+					std::string conns;
+					for (ConnMap::iterator it = conn.begin(); it != conn.end(); ++it) {
+						conns += str(boost::format(" [%s]:%i;") %it->first.address().to_string().c_str() %it->first.port());
+					}
+					LOG_L(L_DEBUG, "Open connections: %s", conns.c_str());
+				#endif
 				}
-				LOG_L(L_DEBUG, "Open connections: %s", conns.c_str());
-			#endif
 			}
 		}
-	}
+	} while ((numReceived == UDPReceiveBatch::MAX_DATAGRAMS) && !err);
+
+	CheckErrorCode(err);
 
 	for (ConnMap::iterator i = conn.begin(); i != conn.end(); ) {
 		if (i->second.expired()) {
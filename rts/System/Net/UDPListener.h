@@ -12,6 +12,8 @@
 #include <queue>
 #include <string>
 
+#include "Socket.h"
+
 namespace netcode
 {
 class UDPConnection;
@@ -96,6 +98,9 @@ private:
 	ConnMap conn;
 
 	std::queue< boost::shared_ptr<UDPConnection> > waiting;
+
+	/// reused receive buffers for Update
+	UDPReceiveBatch recvBatch;
 };
 
 }
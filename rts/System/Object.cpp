@@ -2,10 +2,11 @@
 
 
 #include "System/Object.h"
-#include "System/creg/STL_Set.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/CrashHandler.h"
 
+#include <algorithm>
+
 
 CR_BIND(CObject, )
 
@@ -39,34 +40,53 @@ CObject::CObject() : detached(false)
 	assert(sync_id + 1 > sync_id); // check for overflow
 }
 
+bool CObject::InsertDependence(TDependenceList& deps, const Dependence& d)
+{
+	const TDependenceList::iterator it = std::lower_bound(deps.begin(), deps.end(), d, syncsafe_compare());
+
+	if (it != deps.end() && it->type == d.type && it->obj == d.obj)
+		return false;
+
+	deps.insert(it, d);
+	return true;
+}
+
+bool CObject::EraseDependence(TDependenceList& deps, const Dependence& d)
+{
+	const TDependenceList::iterator it = std::lower_bound(deps.begin(), deps.end(), d, syncsafe_compare());
+
+	if (it == deps.end() || it->type != d.type || it->obj != d.obj)
+		return false;
+
+	deps.erase(it);
+	return true;
+}
+
+
 void CObject::Detach()
 {
 	// SYNCED
 	assert(!detached);
 	detached = true;
-	for (TDependenceMap::iterator i = listeners.begin(); i != listeners.end(); ++i) {
-		const DependenceType& depType = i->first;
-		TSyncSafeSet& objs = i->second;
 
-		for (TSyncSafeSet::iterator di = objs.begin(); di != objs.end(); ++di) {
-			CObject* const& obj = (*di);
+	// DependentDied may add or remove other dependences on us, so
+	// re-locate the successor of each entry after notifying it (as
+	// iterating a std::set would)
+	for (unsigned int n = 0; n < listeners.size(); ) {
+		const Dependence d = listeners[n];
 
-			obj->DependentDied(this);
+		d.obj->DependentDied(this);
 
-			assert(obj->listening.find(depType) != obj->listening.end());
-			obj->listening[depType].erase(this);
-		}
+		// might already be gone if <d.obj> deleted it in DependentDied
+		EraseDependence(d.obj->listening, Dependence(d.type, this));
+
+		n = std::upper_bound(listeners.begin(), listeners.end(), d, syncsafe_compare()) - listeners.begin();
 	}
-	for (TDependenceMap::iterator i = listening.begin(); i != listening.end(); ++i) {
-		const DependenceType& depType = i->first;
-		TSyncSafeSet& objs = i->second;
 
-		for (TSyncSafeSet::iterator di = objs.begin(); di != objs.end(); ++di) {
-			CObject* const& obj = (*di);
+	for (unsigned int n = 0; n < listening.size(); n++) {
+		const Dependence& d = listening[n];
 
-			assert(obj->listeners.find(depType) != obj->listeners.end());
-			obj->listeners[depType].erase(this);
-		}
+		EraseDependence(d.obj->listeners, Dependence(d.type, this));
 	}
 }
 
@@ -80,24 +100,34 @@ CObject::~CObject()
 
 void CObject::Serialize(creg::ISerializer* ser)
 {
+	// same layout as the former map<type, set<obj>>: the number of
+	// types, then per type its value, object count and the objects
 	if (ser->IsWriting()) {
-		int num = listening.size();
+		int num = 0;
+
+		for (unsigned int n = 0; n < listening.size(); n++) {
+			num += (n == 0 || listening[n].type != listening[n - 1].type);
+		}
+
 		ser->Serialize(&num, sizeof(int));
-		for (std::map<DependenceType, TSyncSafeSet >::iterator i = listening.begin(); i != listening.end(); ++i) {
-			int dt = i->first;
-			ser->Serialize(&dt, sizeof(int));
-			TSyncSafeSet& dl = i->second;
+
+		for (unsigned int n = 0; n < listening.size(); ) {
+			int dt = listening[n].type;
 			int size = 0;
-			TSyncSafeSet::const_iterator oi;
-			for (oi = dl.begin(); oi != dl.end(); ++oi) {
-				if ((*oi)->GetClass() != CObject::StaticClass()) {
+			unsigned int end = n;
+
+			for (; end < listening.size() && listening[end].type == dt; end++) {
+				if (listening[end].obj->GetClass() != CObject::StaticClass()) {
 					size++;
 				}
 			}
+
+			ser->Serialize(&dt, sizeof(int));
 			ser->Serialize(&size, sizeof(int));
-			for (oi = dl.begin(); oi != dl.end(); ++oi) {
-				if ((*oi)->GetClass() != CObject::StaticClass()) {
-					ser->SerializeObjectPtr((void**)&*oi, (*oi)->GetClass());
+
+			for (; n < end; n++) {
+				if (listening[n].obj->GetClass() != CObject::StaticClass()) {
+					ser->SerializeObjectPtr((void**)&listening[n].obj, listening[n].obj->GetClass());
 				} else {
 					LOG("Death dependance not serialized in %s", GetClass()->name.c_str());
 				}
@@ -111,11 +141,11 @@ void CObject::Serialize(creg::ISerializer* ser)
 			ser->Serialize(&dt, sizeof(int));
 			int size;
 			ser->Serialize(&size, sizeof(int));
-			TSyncSafeSet& dl = listening[(DependenceType)dt];
 			for (int o = 0; o < size; o++) {
 				CObject* obj = NULL;
 				ser->SerializeObjectPtr((void**)&*obj, NULL);
-				dl.insert(obj);
+				// written in sorted order, so appending keeps it sorted
+				listening.push_back(Dependence((DependenceType)dt, obj));
 			}
 		}
 	}
@@ -123,11 +153,8 @@ void CObject::Serialize(creg::ISerializer* ser)
 
 void CObject::PostLoad()
 {
-	for (std::map<DependenceType, TSyncSafeSet >::iterator i = listening.begin(); i != listening.end(); ++i) {
-		for (TSyncSafeSet::iterator oi = i->second.begin(); oi != i->second.end(); ++oi) {
-			TSyncSafeSet& dl = (*oi)->listeners[i->first];
-			dl.insert(this);
-		}
+	for (unsigned int n = 0; n < listening.size(); n++) {
+		InsertDependence(listening[n].obj->listeners, Dependence(listening[n].type, this));
 	}
 }
 
@@ -141,16 +168,16 @@ void CObject::DependentDied(CObject* obj)
 void CObject::AddDeathDependence(CObject* obj, DependenceType dep)
 {
 	assert(!detached);
-	listening[dep].insert(obj);
+	InsertDependence(listening, Dependence(dep, obj));
 
-	obj->listeners[dep].insert(this);
+	InsertDependence(obj->listeners, Dependence(dep, this));
 }
 
 
 void CObject::DeleteDeathDependence(CObject* obj, DependenceType dep)
 {
 	assert(!detached);
-	obj->listeners[dep].erase(this);
+	EraseDependence(obj->listeners, Dependence(dep, this));
 
-	listening[dep].erase(obj);
+	EraseDependence(listening, Dependence(dep, obj));
 }
@@ -3,9 +3,8 @@
 #ifndef OBJECT_H
 #define OBJECT_H
 
-#include <map>
-#include <set>
 #include "ObjectDependenceTypes.h"
+#include "System/SmallVector.h"
 #include "System/Platform/Threading.h"
 #include "System/creg/creg_cond.h"
 
@@ -66,35 +65,50 @@ public:
 
 private:
 	// Note, this has nothing to do with the UnitID, FeatureID, ...
-	// It's only purpose is to make the sorting in TSyncSafeSet syncsafe
+	// It's only purpose is to make the sorting of TDependenceList syncsafe
 	boost::int64_t sync_id;
 	static Threading::AtomicCounterInt64 cur_sync_id;
 
-	// makes std::set<T*> syncsafe (else iteration order depends on the pointer's address, which is not syncsafe)
+public:
+	struct Dependence {
+		Dependence(DependenceType t = DEPENDENCE_NONE, CObject* o = NULL): type(t), obj(o) {}
+
+		DependenceType type;
+		CObject* obj;
+	};
+
+	// orders by type first, then by creation (iteration order must not depend
+	// on the pointer's address, which is not syncsafe)
 	struct syncsafe_compare
 	{
-		bool operator() (const CObject* const& a1, const CObject* const& a2) const
+		bool operator() (const Dependence& a, const Dependence& b) const
 		{
-			// I don't think the default less-op is sync-safe
-			//return a1 < a2;
-			return a1->sync_id < a2->sync_id;
+			if (a.type != b.type)
+				return (a.type < b.type);
+
+			return (a.obj->sync_id < b.obj->sync_id);
 		}
 	};
 
-public:
-	typedef std::set<CObject*, syncsafe_compare> TSyncSafeSet;
-	typedef std::map<DependenceType, TSyncSafeSet> TDependenceMap;
+	/**
+	 * Flat replacement for a map<DependenceType, set<CObject*>>, kept sorted by
+	 * syncsafe_compare; most objects only have a couple of dependences, which
+	 * then fit into the inline storage without any heap allocation.
+	 */
+	typedef small_vector<Dependence, 2> TDependenceList;
 
 protected:
-	const TSyncSafeSet& GetListeners(const DependenceType dep) { return listeners[dep]; }
-	const TDependenceMap& GetAllListeners() const { return listeners; }
-	const TSyncSafeSet& GetListening(const DependenceType dep)  { return listening[dep]; }
-	const TDependenceMap& GetAllListening() const { return listening; }
+	const TDependenceList& GetAllListeners() const { return listeners; }
+	const TDependenceList& GetAllListening() const { return listening; }
+
+private:
+	static bool InsertDependence(TDependenceList& deps, const Dependence& d);
+	static bool EraseDependence(TDependenceList& deps, const Dependence& d);
 
 protected:
 	bool detached;
-	TDependenceMap listeners;
-	TDependenceMap listening;
+	TDependenceList listeners;
+	TDependenceList listening;
 };
 
 
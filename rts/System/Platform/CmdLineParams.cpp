@@ -26,12 +26,22 @@ CmdLineParams::~CmdLineParams()
 
 std::string CmdLineParams::GetInputFile() const
 {
-	if (vm.count("input-file"))
-		return vm["input-file"].as<std::string>();
+	const std::vector<std::string>& inputFiles = GetInputFiles();
+
+	if (!inputFiles.empty())
+		return inputFiles.front();
 	else
 		return "";
 }
 
+std::vector<std::string> CmdLineParams::GetInputFiles() const
+{
+	if (vm.count("input-file"))
+		return vm["input-file"].as< std::vector<std::string> >();
+	else
+		return std::vector<std::string>();
+}
+
 void CmdLineParams::AddSwitch(const char shortopt, std::string longopt, std::string desc)
 {
 	if (shortopt) {
@@ -59,9 +69,9 @@ void CmdLineParams::AddInt(const char shortopt, std::string longopt, std::string
 void CmdLineParams::Parse()
 {
 	desc.add(all);
-	all.add_options()("input-file", po::value<std::string>(), "input file");
+	all.add_options()("input-file", po::value< std::vector<std::string> >(), "input file(s)");
 	po::positional_options_description p;
-	p.add("input-file", 1);
+	p.add("input-file", -1);
 
 	po::parsed_options parsed = po::command_line_parser(argc, argv).options(all).positional(p).allow_unregistered().run();
 	po::store(parsed, vm);
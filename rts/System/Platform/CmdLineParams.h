@@ -50,6 +50,12 @@ public:
 	 */
 	std::string GetInputFile() const;
 
+	/**
+	 * @return all scripts or demofiles given on the command-line,
+	 *   in the order they were given.
+	 */
+	std::vector<std::string> GetInputFiles() const;
+
 	/**
 	 * @brief add options
 	 * @param shortopt the short (single character) to use (0 for none)
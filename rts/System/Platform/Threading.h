@@ -158,7 +158,7 @@ namespace Threading {
 	#endif
 		}
 
-		operator boost::int64_t() {
+		operator boost::int64_t() const {
 			return num;
 		}
 
@@ -12,6 +12,16 @@
 	#include <valgrind/valgrind.h>
 #endif
 
+#if defined(__linux__)
+	#define WATCHDOG_STACK_SAMPLING
+	#include <cerrno>
+	#include <cxxabi.h>
+	#include <execinfo.h>
+	#include <semaphore.h>
+	#include <signal.h>
+	#include <time.h>
+#endif
+
 #include <algorithm>
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
@@ -21,6 +31,7 @@
 #include "Game/GameVersion.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
+#include "System/LogOutput.h"
 #include "System/maindefines.h"
 #include "System/Misc/SpringTime.h"
 #include "System/Platform/CrashHandler.h"
@@ -28,6 +39,8 @@
 
 CONFIG(int, HangTimeout).defaultValue(10).minimumValue(-1).maximumValue(600)
 		.description("Number of seconds that, if spent in the same code segment, indicate a hang; -1 to disable.");
+CONFIG(int, HangSampleThreshold).defaultValue(0).minimumValue(0).maximumValue(60000)
+		.description("Number of milliseconds after which a watched thread that did not clear its timer (e.g. a long frame) gets its stack sampled until it does, the result is appended to stacksamples.folded next to infolog.txt (Linux only); 0 to disable.");
 
 namespace Watchdog
 {
@@ -68,6 +81,231 @@ namespace Watchdog
 	static spring_time hangTimeout = spring_msecs(0);
 	static volatile bool hangDetectorThreadInterrupted = false;
 
+	static boost::thread* samplerThread = NULL;
+	static spring_time sampleThreshold = spring_msecs(0);
+
+
+#ifdef WATCHDOG_STACK_SAMPLING
+	// the sampled thread is interrupted with this signal and unwinds itself
+	static const int SAMPLE_SIGNAL = SIGUSR2;
+	static const int MAX_SAMPLE_DEPTH = 64;
+	// frames of the signal handler and the kernel trampoline
+	static const int SAMPLE_SKIP_FRAMES = 2;
+	static const spring_time SAMPLE_INTERVAL = spring_msecs(2);
+	static const spring_time SAMPLE_WAIT_TIMEOUT = spring_msecs(50);
+
+	static void* sampleFrames[MAX_SAMPLE_DEPTH];
+	static volatile int sampleDepth = 0;
+	static sem_t sampleDone;
+
+	/// samples taken while one thread spent too long between two ClearTimer calls
+	struct StackSpike {
+		StackSpike(): sampling(false), timer(spring_notime), numSamples(0) {}
+
+		bool sampling;
+		spring_time timer; ///< watchdog timer value the spike belongs to
+		unsigned int numSamples;
+		std::map<std::vector<void*>, unsigned int> stacks;
+	};
+	static StackSpike stackSpikes[WDT_LAST];
+	static std::map<void*, std::string> frameNames;
+
+	static void SampleSignalHandler(int)
+	{
+		// backtrace and sem_post are the only calls made here; the former
+		// was warmed up by InstallSampler so it does not malloc anymore
+		sampleDepth = backtrace(sampleFrames, MAX_SAMPLE_DEPTH);
+		sem_post(&sampleDone);
+	}
+
+	static bool InstallSampler()
+	{
+		void* warmup[2];
+		backtrace(warmup, 2);
+
+		if (sem_init(&sampleDone, 0, 0) != 0)
+			return false;
+
+		struct sigaction sa;
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_handler = SampleSignalHandler;
+		sa.sa_flags = SA_RESTART;
+		sigemptyset(&sa.sa_mask);
+
+		return (sigaction(SAMPLE_SIGNAL, &sa, NULL) == 0);
+	}
+
+	static void UninstallSampler()
+	{
+		signal(SAMPLE_SIGNAL, SIG_DFL);
+		sem_destroy(&sampleDone);
+	}
+
+	static bool TakeSample(Threading::NativeThreadHandle thread, std::vector<void*>& frames)
+	{
+		// a reply that arrived after an earlier timeout would be mistaken for this one
+		while (sem_trywait(&sampleDone) == 0) {}
+
+		if (pthread_kill(thread, SAMPLE_SIGNAL) != 0)
+			return false;
+
+		timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += SAMPLE_WAIT_TIMEOUT.toNanoSecsi();
+		ts.tv_sec += ts.tv_nsec / 1000000000;
+		ts.tv_nsec %= 1000000000;
+
+		while (sem_timedwait(&sampleDone, &ts) != 0) {
+			if (errno != EINTR)
+				return false;
+		}
+
+		if (sampleDepth <= SAMPLE_SKIP_FRAMES)
+			return false;
+
+		frames.assign(sampleFrames + SAMPLE_SKIP_FRAMES, sampleFrames + sampleDepth);
+		return true;
+	}
+
+	/// demangled function name of a backtrace_symbols() line, "module(symbol+offset) [address]"
+	static std::string GetFrameName(void* frame)
+	{
+		std::map<void*, std::string>::const_iterator it = frameNames.find(frame);
+
+		if (it != frameNames.end())
+			return it->second;
+
+		char** symbols = backtrace_symbols(&frame, 1);
+		std::string name;
+
+		if (symbols != NULL) {
+			const std::string line(symbols[0]);
+			const size_t begin = line.find('(');
+			const size_t end = line.find_first_of("+)", begin);
+
+			if (begin != std::string::npos && end != std::string::npos && end > (begin + 1)) {
+				const std::string mangled = line.substr(begin + 1, end - begin - 1);
+
+				int status = 0;
+				char* demangled = abi::__cxa_demangle(mangled.c_str(), NULL, NULL, &status);
+
+				name = (status == 0 && demangled != NULL)? demangled: mangled;
+				free(demangled);
+			}
+
+			free(symbols);
+		}
+
+		if (name.empty()) {
+			char buf[32];
+			SNPRINTF(buf, sizeof(buf), "%p", frame);
+			name = buf;
+		}
+
+		// ';' separates the frames in the folded format
+		std::replace(name.begin(), name.end(), ';', ':');
+
+		return (frameNames[frame] = name);
+	}
+
+	/// appends the spike in folded form ("thread;root;...;leaf count"), e.g. for flamegraph.pl
+	static void FlushSpike(unsigned int num, spring_time curtime)
+	{
+		StackSpike& spike = stackSpikes[num];
+
+		if (!spike.sampling)
+			return;
+
+		spike.sampling = false;
+
+		if (spike.numSamples == 0)
+			return;
+
+		const std::string& logPath = logOutput.GetFilePath();
+		const std::string outPath = logPath.substr(0, logPath.find_last_of("/\\") + 1) + "stacksamples.folded";
+
+		std::ofstream out(outPath.c_str(), std::ios::out | std::ios::app);
+
+		std::map<std::vector<void*>, unsigned int>::const_iterator it;
+		std::map<std::vector<void*>, unsigned int>::const_iterator hottest = spike.stacks.begin();
+
+		for (it = spike.stacks.begin(); it != spike.stacks.end(); ++it) {
+			out << threadNames[num];
+
+			for (std::vector<void*>::const_reverse_iterator fit = it->first.rbegin(); fit != it->first.rend(); ++fit) {
+				out << ';' << GetFrameName(*fit);
+			}
+
+			out << ' ' << it->second << '\n';
+
+			if (it->second > hottest->second)
+				hottest = it;
+		}
+
+		LOG_L(L_WARNING, "[Watchdog] %s-thread spent %ims in one frame, %u stack samples written to %s (hottest: %s)",
+			threadNames[num], int((curtime - spike.timer).toMilliSecsi()), spike.numSamples, outPath.c_str(),
+			GetFrameName(hottest->first[0]).c_str());
+
+		spike.stacks.clear();
+		spike.numSamples = 0;
+	}
+
+
+	__FORCE_ALIGN_STACK__
+	static void SamplerLoop()
+	{
+		Threading::SetThreadName("watchdog-smpl");
+
+		std::vector<void*> frames;
+		frames.reserve(MAX_SAMPLE_DEPTH);
+
+		while (!hangDetectorThreadInterrupted) {
+			const spring_time curtime = spring_gettime();
+			bool sampling = false;
+
+			for (unsigned int i = 0; i < WDT_LAST; ++i) {
+				StackSpike& spike = stackSpikes[i];
+
+				if (!threadSlots[i].active) {
+					FlushSpike(i, curtime);
+					continue;
+				}
+
+				WatchDogThreadInfo* th_info = registeredThreads[i];
+				const spring_time curwdt = th_info->timer;
+
+				// timer was cleared (or reset by the hang detector): the spike is over
+				if (spike.sampling && curwdt.toNanoSecsi() != spike.timer.toNanoSecsi())
+					FlushSpike(i, curtime);
+
+				if (!spring_istime(curwdt) || (curtime - curwdt) < sampleThreshold)
+					continue;
+
+				if (!spike.sampling) {
+					spike.sampling = true;
+					spike.timer = curwdt;
+				}
+
+				if (TakeSample(th_info->thread, frames)) {
+					spike.stacks[frames] += 1;
+					spike.numSamples += 1;
+				}
+
+				sampling = true;
+			}
+
+			// poll often enough to catch a spike shortly after it crossed the threshold
+			const spring_time sleepTime = sampling? SAMPLE_INTERVAL: std::max(SAMPLE_INTERVAL, spring_msecs(sampleThreshold.toMilliSecsi() / 4));
+			boost::this_thread::sleep(boost::posix_time::milliseconds(sleepTime.toMilliSecsi()));
+		}
+
+		for (unsigned int i = 0; i < WDT_LAST; ++i) {
+			FlushSpike(i, spring_gettime());
+		}
+	}
+#endif
+
+
 	static inline void UpdateActiveThreads(Threading::NativeThreadId num) {
 		unsigned int active = WDT_LAST;
 		for (unsigned int i = 0; i < WDT_LAST; ++i) {
@@ -308,6 +546,23 @@ namespace Watchdog
 		hangDetectorThread = new boost::thread(&HangDetectorLoop);
 
 		LOG("[Watchdog] Installed (HangTimeout: %isec)", hangTimeoutSecs);
+
+		const int sampleThresholdMSecs = configHandler->GetInt("HangSampleThreshold");
+
+		if (sampleThresholdMSecs > 0) {
+		#ifdef WATCHDOG_STACK_SAMPLING
+			if (InstallSampler()) {
+				sampleThreshold = spring_msecs(sampleThresholdMSecs);
+				samplerThread = new boost::thread(&SamplerLoop);
+
+				LOG("[Watchdog] Stack sampling enabled (HangSampleThreshold: %ims)", sampleThresholdMSecs);
+			} else {
+				LOG_L(L_WARNING, "[Watchdog] Stack sampling could not be enabled");
+			}
+		#else
+			LOG_L(L_WARNING, "[Watchdog] Stack sampling is not supported on this platform");
+		#endif
+		}
 	}
 
 
@@ -324,6 +579,16 @@ namespace Watchdog
 		delete hangDetectorThread;
 		hangDetectorThread = NULL;
 
+		if (samplerThread != NULL) {
+			samplerThread->join();
+			delete samplerThread;
+			samplerThread = NULL;
+
+		#ifdef WATCHDOG_STACK_SAMPLING
+			UninstallSampler();
+		#endif
+		}
+
 		memset(registeredThreadsData, 0, sizeof(registeredThreadsData));
 		for (unsigned int i = 0; i < WDT_LAST; ++i)
 			registeredThreads[i] = &registeredThreadsData[WDT_LAST];
@@ -9,6 +9,13 @@
 
 CR_BIND_TEMPLATE(safe_vector<float>, );
 
+void safe_vector_index_error(const char* func, size_t idx, size_t size) {
+	LOG_L(L_ERROR, "[%s] index " _STPF_ " out of bounds! (size " _STPF_ ")", func, idx, size);
+#ifndef UNITSYNC
+	CrashHandler::OutputStacktrace();
+#endif
+}
+
 template <> const float& safe_vector<float>::safe_element(size_type idx) const {
 	static const float def = 0.0f;
 
@@ -10,6 +10,9 @@
 #ifdef USE_SAFE_VECTOR
 #include "System/creg/creg_cond.h"
 
+/// logs an out-of-bounds access (plus stacktrace), used by small_vector
+void safe_vector_index_error(const char* func, size_t idx, size_t size);
+
 template<class T>
 class safe_vector : public std::vector<T>
 {
@@ -0,0 +1,184 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SMALL_VECTOR_H
+#define _SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "System/SafeVector.h" // USE_SAFE_VECTOR
+
+/**
+ * @brief vector with inline storage for its first N elements
+ *
+ * Only meant for trivially copyable types (elements are moved around with
+ * memcpy); once more than N elements are stored they all go to the heap.
+ * Out-of-bounds access behaves like safe_vector's if USE_SAFE_VECTOR is
+ * defined: an error is logged (once) and a dummy element is returned.
+ */
+template<class T, unsigned int N>
+class small_vector
+{
+public:
+	typedef T value_type;
+	typedef size_t size_type;
+	typedef T* iterator;
+	typedef const T* const_iterator;
+
+	small_vector(): heap(NULL), count(0), capacity(N), showError(true) {}
+	small_vector(const small_vector& v): heap(NULL), count(0), capacity(N), showError(true) { *this = v; }
+	small_vector(small_vector&& v): heap(NULL), count(0), capacity(N), showError(true) { *this = std::move(v); }
+	~small_vector() { delete[] heap; }
+
+	small_vector& operator = (const small_vector& v) {
+		if (this != &v) {
+			count = 0;
+			reserve(v.count);
+			std::memcpy(data(), v.data(), v.count * sizeof(T));
+			count = v.count;
+		}
+		return *this;
+	}
+
+	small_vector& operator = (small_vector&& v) {
+		if (this == &v)
+			return *this;
+
+		if (v.heap != NULL) {
+			// steal the other buffer
+			delete[] heap;
+
+			heap = v.heap;
+			count = v.count;
+			capacity = v.capacity;
+
+			v.heap = NULL;
+			v.count = 0;
+			v.capacity = N;
+		} else {
+			*this = static_cast<const small_vector&>(v);
+			v.count = 0;
+		}
+
+		return *this;
+	}
+
+	bool empty() const { return (count == 0); }
+	size_type size() const { return count; }
+
+	void clear() { count = 0; }
+
+	void reserve(size_type n) {
+		if (n <= capacity)
+			return;
+
+		T* mem = new T[n];
+		std::memcpy(mem, data(), count * sizeof(T));
+		delete[] heap;
+
+		heap = mem;
+		capacity = n;
+	}
+
+	void resize(size_type n, const T& value = T()) {
+		reserve(n);
+
+		for (size_type i = count; i < n; i++)
+			data()[i] = value;
+
+		count = n;
+	}
+
+	void push_back(const T& value) {
+		if (count == capacity)
+			reserve(capacity * 2);
+
+		data()[count++] = value;
+	}
+
+	iterator insert(iterator pos, const T& value) {
+		const size_type idx = pos - begin();
+		const T tmp = value; // <value> might live in our own storage
+
+
+		assert(idx <= count);
+
+		if (count == capacity)
+			reserve(capacity * 2);
+
+		T* mem = data();
+		std::memmove(&mem[idx + 1], &mem[idx], (count - idx) * sizeof(T));
+		mem[idx] = tmp;
+		count++;
+
+		return (begin() + idx);
+	}
+
+	iterator erase(iterator pos) {
+		const size_type idx = pos - begin();
+
+		assert(idx < count);
+
+		T* mem = data();
+		std::memmove(&mem[idx], &mem[idx + 1], (count - idx - 1) * sizeof(T));
+		count--;
+
+		return (begin() + idx);
+	}
+
+	      T* data()       { return ((heap != NULL)? heap: &inlineData[0]); }
+	const T* data() const { return ((heap != NULL)? heap: &inlineData[0]); }
+
+	iterator       begin()       { return data(); }
+	const_iterator begin() const { return data(); }
+	iterator       end()         { return (data() + count); }
+	const_iterator end()   const { return (data() + count); }
+
+	const T& operator[] (const size_type i) const {
+#ifdef USE_SAFE_VECTOR
+		if (i >= count)
+			return safe_element(i);
+#endif
+		assert(i < count);
+		return data()[i];
+	}
+	T& operator[] (const size_type i) {
+#ifdef USE_SAFE_VECTOR
+		if (i >= count)
+			return safe_element(i);
+#endif
+		assert(i < count);
+		return data()[i];
+	}
+
+	const T& at(const size_type i) const { return (*this)[i]; }
+	      T& at(const size_type i)       { return (*this)[i]; }
+
+private:
+#ifdef USE_SAFE_VECTOR
+	T& safe_element(size_type idx) const {
+		static T def;
+
+		if (showError) {
+			showError = false;
+			safe_vector_index_error(__FUNCTION__, idx, count);
+		}
+
+		def = T();
+		return def;
+	}
+#endif
+
+private:
+	T* heap;
+	T inlineData[N];
+
+	unsigned int count;
+	unsigned int capacity;
+
+	mutable bool showError;
+};
+
+#endif // _SMALL_VECTOR_H
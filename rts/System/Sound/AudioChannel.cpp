@@ -10,11 +10,18 @@
 #include "Sim/Misc/GuiSoundSet.h"
 #include "Sim/Objects/WorldObject.h"
 
+#include <algorithm>
 #include <climits>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 
 extern boost::recursive_mutex soundMutex;
+extern boost::mutex playRequestMutex;
+extern boost::condition_variable playRequestCond;
+extern bool playRequestsPending;
 
 const size_t AudioChannel::MAX_STREAM_QUEUESIZE = 10;
+const size_t AudioChannel::MAX_PLAY_REQUESTS = 256;
 
 
 AudioChannel::AudioChannel()
@@ -69,33 +76,107 @@ void AudioChannel::SoundSourceFinished(CSoundSource* sndSource)
 
 void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3& velocity, float volume, bool relative)
 {
-	boost::recursive_mutex::scoped_lock lck(soundMutex);
-
+	// only queue the request here, the sound thread submits it (see
+	// FlushPlayRequests) so callers never wait on soundMutex
 	if (!enabled)
 		return;
 
 	if (volume <= 0.0f)
 		return;
 
-	SoundItem* sndItem = sound->GetSoundItem(id);
-	if (!sndItem) {
-		sound->numEmptyPlayRequests++;
+	boost::mutex::scoped_lock lck(playRequestMutex);
+
+	if (emmitsThisFrame >= emmitsPerFrame)
+		return;
+	if (playRequests.size() >= MAX_PLAY_REQUESTS) {
+		LOG_L(L_DEBUG, "CSound::PlaySample: Too many queued sounds! Dropping playback!");
 		return;
 	}
+	emmitsThisFrame++;
 
-	if (pos.distance(sound->GetListenerPos()) > sndItem->MaxDistance()) {
-		if (!relative) {
-			return;
-		} else {
-			LOG("CSound::PlaySample: maxdist ignored for relative playback: %s",
-					sndItem->Name().c_str());
+	PlayRequest req;
+	req.id       = id;
+	req.pos      = pos;
+	req.velocity = velocity;
+	req.volume   = volume;
+	req.relative = relative;
+	playRequests.push_back(req);
+
+	if (!playRequestsPending) {
+		playRequestsPending = true;
+		playRequestCond.notify_one();
+	}
+}
+
+
+namespace {
+	struct ResolvedPlayRequest {
+		SoundItem* item;
+		float dist;
+		size_t idx;
+
+		bool operator < (const ResolvedPlayRequest& r) const {
+			if (item->GetPriority() != r.item->GetPriority())
+				return (item->GetPriority() > r.item->GetPriority());
+			if (dist != r.dist)
+				return (dist < r.dist);
+			return (idx < r.idx);
 		}
+	};
+}
+
+void AudioChannel::FlushPlayRequests()
+{
+	{
+		boost::mutex::scoped_lock lck(playRequestMutex);
+		flushRequests.swap(playRequests);
 	}
 
-	if (emmitsThisFrame >= emmitsPerFrame)
+	if (flushRequests.empty())
 		return;
-	emmitsThisFrame++;
 
+	std::vector<ResolvedPlayRequest> resolved;
+	resolved.reserve(flushRequests.size());
+
+	for (size_t n = 0; n < flushRequests.size(); n++) {
+		const PlayRequest& req = flushRequests[n];
+
+		SoundItem* sndItem = sound->GetSoundItem(req.id);
+		if (!sndItem) {
+			sound->numEmptyPlayRequests++;
+			continue;
+		}
+
+		const float dist = req.pos.distance(sound->GetListenerPos());
+
+		if (dist > sndItem->MaxDistance()) {
+			if (!req.relative) {
+				continue;
+			} else {
+				LOG("CSound::PlaySample: maxdist ignored for relative playback: %s",
+						sndItem->Name().c_str());
+			}
+		}
+
+		ResolvedPlayRequest r;
+		r.item = sndItem;
+		r.dist = (req.relative)? 0.0f: dist;
+		r.idx  = n;
+		resolved.push_back(r);
+	}
+
+	std::sort(resolved.begin(), resolved.end());
+
+	for (size_t n = 0; n < resolved.size(); n++) {
+		const PlayRequest& req = flushRequests[resolved[n].idx];
+		PlayNow(resolved[n].item, req.pos, req.velocity, req.volume, req.relative);
+	}
+
+	flushRequests.clear();
+}
+
+void AudioChannel::PlayNow(SoundItem* sndItem, const float3& pos, const float3& velocity, float volume, bool relative)
+{
 	if (cur_sources.size() >= maxConcurrentSources) {
 		CSoundSource* src = NULL;
 		int prio = INT_MAX;
@@ -114,7 +195,7 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 		}
 	}
 
-	CSoundSource* sndSource = sound->GetNextBestSource();
+	CSoundSource* sndSource = sound->GetNextBestSource(false);
 	if (!sndSource) {
 		LOG_L(L_DEBUG, "CSound::PlaySample: Max sounds reached! Dropping playback!");
 		return;
@@ -8,10 +8,12 @@
 #include <string.h>
 
 #include "IAudioChannel.h"
+#include "System/float3.h"
 #include <boost/thread/recursive_mutex.hpp>
 
 struct GuiSoundSet;
 class CSoundSource;
+class SoundItem;
 class CWorldObject;
 
 /**
@@ -48,14 +50,39 @@ public:
 	float StreamGetTime();
 	float StreamGetPlayTime();
 
+	/**
+	 * @brief Submit all queued PlaySample requests
+	 *
+	 * Called by the sound thread with soundMutex held, the requests are
+	 * handed to the sources in order of priority (nearest first for equal
+	 * priorities) after dropping those out of range.
+	 */
+	void FlushPlayRequests();
+
 protected:
 	void FindSourceAndPlay(size_t id, const float3& pos, const float3& velocity, float volume, bool relative);
 
 	void SoundSourceFinished(CSoundSource* sndSource);
 
+private:
+	void PlayNow(SoundItem* sndItem, const float3& pos, const float3& velocity, float volume, bool relative);
+
 private:
 	std::map<CSoundSource*, bool> cur_sources;
 
+	struct PlayRequest {
+		size_t id;
+		float3 pos;
+		float3 velocity;
+		float volume;
+		bool relative;
+	};
+
+	/// filled by PlaySample from any thread, guarded by playRequestMutex
+	std::vector<PlayRequest> playRequests;
+	std::vector<PlayRequest> flushRequests;
+	static const size_t MAX_PLAY_REQUESTS;
+
 	//! streams
 	struct StreamQueueItem {
 		StreamQueueItem() : volume(0.f) {}
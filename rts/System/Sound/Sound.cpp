@@ -6,6 +6,8 @@
 #include <cmath>
 #include <alc.h>
 #include <boost/cstdint.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 
 #include "SoundChannels.h"
@@ -42,11 +44,21 @@ CONFIG(std::string, snd_device).defaultValue("").description("Sets the used outp
 
 boost::recursive_mutex soundMutex;
 
+// AudioChannel::PlaySample only queues its requests, the sound thread
+// is woken through these and submits them in one batch
+boost::mutex playRequestMutex;
+boost::condition_variable playRequestCond;
+bool playRequestsPending = false;
+
+static boost::mutex preloadMutex;
+static boost::condition_variable preloadCond;
+
 
 CSound::CSound()
 	: myPos(ZeroVector)
 	, prevVelocity(ZeroVector)
 	, soundThread(NULL)
+	, preloadThread(NULL)
 	, soundThreadQuit(false)
 {
 	boost::recursive_mutex::scoped_lock lck(soundMutex);
@@ -80,7 +92,11 @@ CSound::CSound()
 
 CSound::~CSound()
 {
-	soundThreadQuit = true;
+	{
+		boost::mutex::scoped_lock lck(preloadMutex);
+		soundThreadQuit = true;
+		preloadCond.notify_all();
+	}
 
 	if (soundThread) {
 		soundThread->join();
@@ -96,6 +112,9 @@ CSound::~CSound()
 
 bool CSound::HasSoundItem(const std::string& name) const
 {
+	// called concurrently by the def handlers
+	boost::recursive_mutex::scoped_lock lck(soundMutex);
+
 	soundMapT::const_iterator it = soundMap.find(name);
 	if (it != soundMap.end())
 	{
@@ -113,31 +132,51 @@ bool CSound::HasSoundItem(const std::string& name) const
 
 size_t CSound::GetSoundId(const std::string& name)
 {
-	boost::recursive_mutex::scoped_lock lck(soundMutex);
+	soundItemDef itemDef;
+	bool rawFile = false;
 
-	if (sources.empty())
-		return 0;
+	{
+		boost::recursive_mutex::scoped_lock lck(soundMutex);
+
+		if (sources.empty())
+			return 0;
+
+		soundMapT::const_iterator it = soundMap.find(name);
+		if (it != soundMap.end()) {
+			// sounditem found
+			return it->second;
+		}
 
-	soundMapT::const_iterator it = soundMap.find(name);
-	if (it != soundMap.end()) {
-		// sounditem found
-		return it->second;
-	} else {
 		soundItemDefMap::const_iterator itemDefIt = soundItemDefs.find(StringToLower(name));
 		if (itemDefIt != soundItemDefs.end()) {
-			return MakeItemFromDef(itemDefIt->second);
+			itemDef = itemDefIt->second;
 		} else {
-			if (LoadSoundBuffer(name) > 0) // maybe raw filename?
-			{
-				soundItemDef temp = defaultItem;
-				temp["file"] = name;
-				return MakeItemFromDef(temp);
-			} else {
-				LOG_L(L_ERROR, "CSound::GetSoundId: could not find sound: %s", name.c_str());
-				return 0;
-			}
+			// maybe raw filename?
+			itemDef = defaultItem;
+			itemDef["file"] = name;
+			rawFile = true;
 		}
 	}
+
+	soundItemDef::const_iterator fileIt = itemDef.find("file");
+	if (fileIt == itemDef.end())
+		return 0;
+
+	// decodes without holding soundMutex
+	if (LoadSoundBuffer(fileIt->second) == 0) {
+		if (rawFile)
+			LOG_L(L_ERROR, "CSound::GetSoundId: could not find sound: %s", name.c_str());
+		return 0;
+	}
+
+	boost::recursive_mutex::scoped_lock lck(soundMutex);
+
+	// the preload thread may have created it meanwhile
+	soundMapT::const_iterator it = soundMap.find(name);
+	if (it != soundMap.end())
+		return it->second;
+
+	return MakeItemFromDef(itemDef);
 }
 
 SoundItem* CSound::GetSoundItem(size_t id) const {
@@ -156,6 +195,14 @@ CSoundSource* CSound::GetNextBestSource(bool lock)
 	if (sources.empty())
 		return NULL;
 
+	// prefer sources that have nothing assigned at all, this needs no
+	// AL state queries (unlike IsPlaying for the ones still assigned)
+	for (sourceVecT::iterator it = sources.begin(); it != sources.end(); ++it)
+	{
+		if (it->GetCurrentPriority() == INT_MIN)
+			return &(*it);
+	}
+
 	CSoundSource* bestPos = NULL;
 	for (sourceVecT::iterator it = sources.begin(); it != sources.end(); ++it)
 	{
@@ -371,12 +418,43 @@ void CSound::StartThread(int maxSounds)
 	Threading::SetThreadName("audio");
 	Watchdog::RegisterThread(WDT_AUDIO);
 
+	preloadThread = new boost::thread(boost::bind(&CSound::PreloadThread, this));
+
+	spring_time nextUpdate = spring_gettime();
+
 	while (!soundThreadQuit) {
-		boost::this_thread::sleep(boost::posix_time::millisec(50)); //! 20Hz
+		{
+			// wake up early for queued PlaySample requests
+			boost::mutex::scoped_lock lck(playRequestMutex);
+
+			if (!playRequestsPending) {
+				playRequestCond.timed_wait(lck, boost::posix_time::millisec(std::max(0, int(spring_tomsecs(nextUpdate - spring_gettime())))));
+			}
+			playRequestsPending = false;
+		}
+
 		Watchdog::ClearTimer(WDT_AUDIO);
-		Update();
+
+		{
+			boost::recursive_mutex::scoped_lock lck(soundMutex);
+
+			Channels::General.FlushPlayRequests();
+			Channels::Battle.FlushPlayRequests();
+			Channels::UnitReply.FlushPlayRequests();
+			Channels::UserInterface.FlushPlayRequests();
+			Channels::BGMusic.FlushPlayRequests();
+		}
+
+		if (spring_gettime() >= nextUpdate) {
+			nextUpdate = spring_gettime() + spring_msecs(50); //! 20Hz
+			Update();
+		}
 	}
 
+	preloadThread->join();
+	delete preloadThread;
+	preloadThread = NULL;
+
 	Watchdog::DeregisterThread(WDT_AUDIO);
 
 	sources.clear(); // delete all sources
@@ -398,7 +476,7 @@ void CSound::Update()
 
 size_t CSound::MakeItemFromDef(const soundItemDef& itemDef)
 {
-	//! MakeItemFromDef is private. Only caller is LoadSoundDefs and it sets the mutex itself.
+	//! MakeItemFromDef is private, all callers hold soundMutex
 	//boost::recursive_mutex::scoped_lock lck(soundMutex);
 	const size_t newid = sounds.size();
 	soundItemDef::const_iterator it = itemDef.find("file");
@@ -525,7 +603,7 @@ bool CSound::LoadSoundDefs(const std::string& fileName)
 				}
 
 				if (buf.KeyExists("preload")) {
-					MakeItemFromDef(bufmap);
+					QueuePreload(name);
 				}
 			}
 			LOG(" parsed %i sounds from %s", (int)keys.size(), fileName.c_str());
@@ -546,14 +624,22 @@ bool CSound::LoadSoundDefs(const std::string& fileName)
 	return true;
 }
 
-//! only used internally, locked in caller's scope
+//! only used internally, the decoding happens without holding soundMutex
+//! unless the caller does (so the sound thread can keep updating streams)
 size_t CSound::LoadSoundBuffer(const std::string& path)
 {
-	const size_t id = SoundBuffer::GetId(path);
+	{
+		boost::recursive_mutex::scoped_lock lck(soundMutex);
 
-	if (id > 0) {
-		return id; // file is loaded already
-	} else {
+		const size_t id = SoundBuffer::GetId(path);
+
+		if (id > 0)
+			return id; // file is loaded already
+	}
+
+	boost::shared_ptr<SoundBuffer> buffer(new SoundBuffer());
+
+	{
 		CFileHandler file(path);
 
 		if (!file.FileExists()) {
@@ -564,25 +650,67 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 		std::vector<boost::uint8_t> buf(file.FileSize());
 		file.Read(&buf[0], file.FileSize());
 
-		boost::shared_ptr<SoundBuffer> buffer(new SoundBuffer());
 		bool success = false;
 		const std::string ending = file.GetFileExt();
 		if (ending == "wav") {
-			success = buffer->LoadWAV(path, buf);
+			success = buffer->DecodeWAV(path, buf);
 		} else if (ending == "ogg") {
-			success = buffer->LoadVorbis(path, buf);
+			success = buffer->DecodeVorbis(path, buf);
 		} else {
 			LOG_L(L_WARNING, "CSound::LoadALBuffer: unknown audio format: %s",
 					ending.c_str());
 		}
 
-		CheckError("CSound::LoadALBuffer");
 		if (!success) {
 			LOG_L(L_WARNING, "Failed to load file: %s", path.c_str());
 			return 0;
 		}
+	}
+
+	boost::recursive_mutex::scoped_lock lck(soundMutex);
+
+	// another thread may have loaded the same file meanwhile
+	const size_t id = SoundBuffer::GetId(path);
+
+	if (id > 0)
+		return id;
+
+	buffer->Upload();
+	CheckError("CSound::LoadALBuffer");
+
+	return SoundBuffer::Insert(buffer);
+}
+
+void CSound::QueuePreload(const std::string& name)
+{
+	boost::mutex::scoped_lock lck(preloadMutex);
+
+	preloadQueue.push_back(name);
+	preloadCond.notify_one();
+}
+
+__FORCE_ALIGN_STACK__
+void CSound::PreloadThread()
+{
+	Threading::SetThreadName("audiopreload");
+
+	while (true) {
+		std::string name;
+
+		{
+			boost::mutex::scoped_lock lck(preloadMutex);
+
+			while (preloadQueue.empty() && !soundThreadQuit)
+				preloadCond.wait(lck);
+
+			if (soundThreadQuit)
+				break;
+
+			name = preloadQueue.front();
+			preloadQueue.pop_front();
+		}
 
-		return SoundBuffer::Insert(buffer);
+		GetSoundId(name);
 	}
 }
 
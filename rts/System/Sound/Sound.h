@@ -5,6 +5,7 @@
 
 #include "ISound.h"
 
+#include <deque>
 #include <set>
 #include <string>
 #include <map>
@@ -65,12 +66,14 @@ private:
 
 private:
 	void StartThread(int maxSounds);
+	void PreloadThread();
 	void Update();
 	int GetMaxMonoSources(ALCdevice* device, int maxSounds);
 
 	size_t MakeItemFromDef(const soundItemDef& itemDef);
 
 	size_t LoadSoundBuffer(const std::string& filename);
+	void QueuePreload(const std::string& name);
 
 private:
 	float masterVolume;
@@ -95,6 +98,11 @@ private:
 	soundItemDefMap soundItemDefs;
 
 	boost::thread* soundThread;
+	/// decodes the sounds marked for preloading in the background
+	boost::thread* preloadThread;
+
+	/// item names waiting for preloadThread, guarded by preloadMutex
+	std::deque<std::string> preloadQueue;
 
 	volatile bool soundThreadQuit;
 };
@@ -39,7 +39,7 @@ int	VorbisClose(void* datasource)
 SoundBuffer::bufferMapT SoundBuffer::bufferMap; // filename, index into Buffers
 SoundBuffer::bufferVecT SoundBuffer::buffers;
 
-SoundBuffer::SoundBuffer() : id(0), channels(0), length(0.0f)
+SoundBuffer::SoundBuffer() : id(0), channels(0), length(0.0f), pcmFormat(AL_NONE), pcmRate(0)
 {
 }
 
@@ -66,7 +66,7 @@ struct WAVHeader
 };
 #pragma pack(pop)
 
-bool SoundBuffer::LoadWAV(const std::string& file, std::vector<boost::uint8_t> buffer)
+bool SoundBuffer::DecodeWAV(const std::string& file, std::vector<boost::uint8_t>& buffer)
 {
 	WAVHeader* header = (WAVHeader*)(&buffer[0]);
 
@@ -137,9 +137,9 @@ bool SoundBuffer::LoadWAV(const std::string& file, std::vector<boost::uint8_t> b
 		header->datalen = boost::uint32_t(buffer.size() - sizeof(WAVHeader))&(~boost::uint32_t((header->BitsPerSample*header->channels)/8 -1));
 	}
 
-	if (!AlGenBuffer(file, format, &buffer[sizeof(WAVHeader)], header->datalen, header->SamplesPerSec)) {
-		LOG_L(L_WARNING, "Loading audio failed for %s", file.c_str());
-	}
+	pcmData.assign(buffer.begin() + sizeof(WAVHeader), buffer.begin() + sizeof(WAVHeader) + header->datalen);
+	pcmFormat = format;
+	pcmRate   = header->SamplesPerSec;
 
 	filename = file;
 	channels = header->channels;
@@ -148,7 +148,7 @@ bool SoundBuffer::LoadWAV(const std::string& file, std::vector<boost::uint8_t> b
 	return true;
 }
 
-bool SoundBuffer::LoadVorbis(const std::string& file, std::vector<boost::uint8_t> buffer)
+bool SoundBuffer::DecodeVorbis(const std::string& file, std::vector<boost::uint8_t>& buffer)
 {
 	VorbisInputBuffer buf;
 	buf.data = &buffer[0];
@@ -216,13 +216,29 @@ bool SoundBuffer::LoadVorbis(const std::string& file, std::vector<boost::uint8_t
 		pos += read;
 	} while (read > 0); // read == 0 indicated EOF, read < 0 is error
 
-	AlGenBuffer(file, format, &decodeBuffer[0], pos, vorbisInfo->rate);
+	decodeBuffer.resize(pos);
+	pcmData.swap(decodeBuffer);
+	pcmFormat = format;
+	pcmRate   = vorbisInfo->rate;
+
 	filename = file;
 	channels = vorbisInfo->channels;
 	length   = ov_time_total(&oggStream, -1);
 	return true;
 }
 
+bool SoundBuffer::Upload()
+{
+	const bool success = AlGenBuffer(filename, pcmFormat, (pcmData.empty()? NULL: &pcmData[0]), pcmData.size(), pcmRate);
+
+	if (!success) {
+		LOG_L(L_WARNING, "Loading audio failed for %s", filename.c_str());
+	}
+
+	std::vector<boost::uint8_t>().swap(pcmData);
+	return success;
+}
+
 int SoundBuffer::BufferSize() const
 {
 	ALint size;
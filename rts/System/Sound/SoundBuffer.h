@@ -26,8 +26,12 @@ public:
 	SoundBuffer();
 	~SoundBuffer();
 
-	bool LoadWAV(const std::string& file, std::vector<boost::uint8_t> buffer);
-	bool LoadVorbis(const std::string& file, std::vector<boost::uint8_t> buffer);
+	/// decoding only, does not touch OpenAL and can run on any thread
+	bool DecodeWAV(const std::string& file, std::vector<boost::uint8_t>& buffer);
+	bool DecodeVorbis(const std::string& file, std::vector<boost::uint8_t>& buffer);
+
+	/// creates the AL buffer from the decoded samples and frees them
+	bool Upload();
 
 	const std::string& GetFilename() const
 	{
@@ -68,6 +72,11 @@ private:
 	ALuint id;
 	ALuint channels;
 	ALfloat length;
+
+	/// decoded samples, only kept between Decode*() and Upload()
+	std::vector<boost::uint8_t> pcmData;
+	ALenum pcmFormat;
+	int pcmRate;
 	
 	typedef std::map<std::string, size_t> bufferMapT;
 	typedef std::vector< boost::shared_ptr<SoundBuffer> > bufferVecT;
@@ -716,7 +716,7 @@ void SpringApp::ParseCmdLine(const std::string& binaryName)
 	cmdline->AddSwitch('c', "client",             "Run as a client");
 
 	cmdline->AddSwitch('t', "textureatlas",       "Dump each finalized textureatlas in textureatlasN.tga");
-	cmdline->AddInt(   0,   "benchmark",          "Enable benchmark mode (writes a benchmark.data file). The given number specifies the timespan to test.");
+	cmdline->AddInt(   0,   "benchmark",          "Enable benchmark mode (writes benchmark.data and benchmark.json files). The given number specifies the timespan to test.");
 	cmdline->AddInt(   0,   "benchmarkstart",     "Benchmark start time in minutes.");
 
 	cmdline->AddSwitch(0,   "list-ai-interfaces", "Dump a list of available AI Interfaces to stdout");
@@ -83,11 +83,11 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod)
 	if ((gs->frameNum % gFramePeriod) != 0) { return; }
 
 	// we only care about the synced projectile data here
-	const std::list<CUnit*>& units = unitHandler->activeUnits;
+	const std::vector<CUnit*>& units = unitHandler->activeUnits;
 	const CFeatureSet& features = featureHandler->GetActiveFeatures();
 	      ProjectileContainer& projectiles = projectileHandler->syncedProjectiles;
 
-	std::list<CUnit*>::const_iterator unitsIt;
+	std::vector<CUnit*>::const_iterator unitsIt;
 	CFeatureSet::const_iterator featuresIt;
 	ProjectileContainer::iterator projectilesIt;
 	std::vector<LocalModelPiece*>::const_iterator piecesIt;
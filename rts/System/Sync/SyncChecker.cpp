@@ -6,8 +6,28 @@
 #include "SyncChecker.h"
 
 
-unsigned CSyncChecker::g_checksum;
+unsigned CSyncChecker::g_checksums[SUBSYSTEM_COUNT];
+unsigned* CSyncChecker::g_curChecksum = &CSyncChecker::g_checksums[SUBSYSTEM_OTHER];
+CSyncChecker::Subsystem CSyncChecker::curSubsystem = SUBSYSTEM_OTHER;
 int CSyncChecker::inSyncedCode;
+CSyncChecker::HistoryFrame CSyncChecker::history[HISTORY_SIZE];
+
+
+const char* CSyncChecker::GetSubsystemName(unsigned s)
+{
+	static const char* names[SUBSYSTEM_COUNT] = {
+		"other",
+		"lua",
+		"units",
+		"projectiles",
+		"features",
+		"path",
+		"los",
+		"teams",
+	};
+
+	return (s < SUBSYSTEM_COUNT)? names[s]: "unknown";
+}
 
 
 #endif // SYNCDEBUG
@@ -20,10 +20,42 @@
  *
  * A Lightweight sync debugger that just keeps a running checksum over all
  * assignments to synced variables.
+ *
+ * The checksum is kept per subsystem (whichever one is marked active by
+ * SCOPED_SYNC_SUBSYSTEM while the assignment happens), so that a desync
+ * can be attributed to the part of the simulation where it first showed
+ * up by comparing the few subsystem checksums between clients.
+ *
+ * The subsystem checksums of the last HISTORY_SIZE frames are also kept in
+ * a ring, so the server can ask for them for the exact frame at which the
+ * (per-frame) total checksums diverged.
  */
 class CSyncChecker {
 
 	public:
+		enum Subsystem {
+			SUBSYSTEM_OTHER       = 0, ///< everything outside of a more specific scope
+			SUBSYSTEM_LUA         = 1, ///< synced gadget callins via GameFrame
+			SUBSYSTEM_UNITS       = 2,
+			SUBSYSTEM_PROJECTILES = 3,
+			SUBSYSTEM_FEATURES    = 4,
+			SUBSYSTEM_PATH        = 5,
+			SUBSYSTEM_LOS         = 6,
+			SUBSYSTEM_TEAMS       = 7,
+			SUBSYSTEM_COUNT       = 8,
+		};
+
+		/// must cover the server's sync response timeout plus some lag
+		static const unsigned HISTORY_SIZE = 512;
+
+		class ScopedSubsystem {
+			public:
+				ScopedSubsystem(Subsystem s): prevSubsystem(curSubsystem) { SetSubsystem(s); }
+				~ScopedSubsystem() { SetSubsystem(prevSubsystem); }
+			private:
+				Subsystem prevSubsystem;
+		};
+
 		/**
 		 * Whether one thread (doesn't have to be the current thread!!!) is currently processing a SimFrame.
 		 */
@@ -34,10 +66,56 @@ class CSyncChecker {
 		/**
 		 * Keeps a running checksum over all assignments to synced variables.
 		 */
-		static unsigned GetChecksum() { return g_checksum; }
-		static void NewFrame() { g_checksum = 0xfade1eaf; }
+		static unsigned GetChecksum() {
+			unsigned checksum = 0xfade1eaf;
+
+			for (unsigned i = 0; i < SUBSYSTEM_COUNT; ++i) {
+				checksum += g_checksums[i];
+				checksum ^= checksum << 16;
+				checksum += checksum >> 11;
+			}
+
+			return checksum;
+		}
+		static unsigned GetSubsystemChecksum(unsigned s) { return g_checksums[s]; }
+		static const char* GetSubsystemName(unsigned s);
+
+		/// stores the current subsystem checksums as those of <frameNum>
+		static void RecordFrame(int frameNum) {
+			HistoryFrame& hf = history[frameNum % HISTORY_SIZE];
+			hf.frameNum = frameNum;
+
+			for (unsigned i = 0; i < SUBSYSTEM_COUNT; ++i) {
+				hf.checksums[i] = g_checksums[i];
+			}
+		}
+		/// false if <frameNum> has already left (or never entered) the history
+		static bool GetFrameChecksums(int frameNum, unsigned* checksums) {
+			// frame 0 is never simulated, unused slots look like it
+			if (frameNum <= 0)
+				return false;
+
+			const HistoryFrame& hf = history[frameNum % HISTORY_SIZE];
+
+			if (hf.frameNum != frameNum)
+				return false;
+
+			for (unsigned i = 0; i < SUBSYSTEM_COUNT; ++i) {
+				checksums[i] = hf.checksums[i];
+			}
+
+			return true;
+		}
+
+		static void NewFrame() {
+			for (unsigned i = 0; i < SUBSYSTEM_COUNT; ++i) {
+				g_checksums[i] = 0xfade1eaf;
+			}
+		}
 
 		static void Sync(const void* p, unsigned size) {
+			unsigned& g_checksum = *g_curChecksum;
+
 			// most common cases first, make it easy for compiler to optimize for it
 			// simple xor is not enough to detect multiple zeroes, e.g.
 #ifdef TRACE_SYNC_HEAVY
@@ -87,11 +165,24 @@ class CSyncChecker {
 		}
 
 	private:
+		static void SetSubsystem(Subsystem s) {
+			curSubsystem = s;
+			g_curChecksum = &g_checksums[s];
+		}
 
 		/**
-		 * The sync checksum
+		 * The sync checksums, one per subsystem
 		 */
-		static unsigned g_checksum;
+		static unsigned g_checksums[SUBSYSTEM_COUNT];
+		static unsigned* g_curChecksum;
+		static Subsystem curSubsystem;
+
+		struct HistoryFrame {
+			int frameNum;
+			unsigned checksums[SUBSYSTEM_COUNT];
+		};
+
+		static HistoryFrame history[HISTORY_SIZE];
 
 		/**
 		 * @brief in synced code
@@ -101,6 +192,12 @@ class CSyncChecker {
 		static int inSyncedCode;
 };
 
+	#define SCOPED_SYNC_SUBSYSTEM(s) CSyncChecker::ScopedSubsystem scopedSyncSubsystem(CSyncChecker::s)
+
+#else
+
+	#define SCOPED_SYNC_SUBSYSTEM(s)
+
 #endif // SYNCDEBUG
 
 #endif // SYNCDEBUGGER_H
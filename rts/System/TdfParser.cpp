@@ -8,7 +8,6 @@
 
 #include <boost/scoped_array.hpp>
 
-#include "tdf_grammar.h"
 #include "System/TdfParser.h"
 #include "System/Util.h"
 #include "System/FileSystem/FileHandler.h"
@@ -124,67 +123,235 @@ void TdfParser::print(std::ostream & out) const {
 }
 
 
-void TdfParser::parse_buffer(char const* buf, size_t size) {
+/**
+ * Single-pass reader over the raw buffer; accepts the same syntax as the
+ * old boost::spirit grammar did (including its quirks, e.g. names may span
+ * whitespace and line-breaks), but only creates strings for the names and
+ * values that go into the section tree.
+ */
+class TdfReader
+{
+public:
+	TdfReader(const char* buf, size_t size, const std::string& filename)
+		: beg(buf), end(buf + size), cur(buf), filename(filename)
+	{}
+
+	void ParseFile(TdfParser::TdfSection* root) {
+		for (SkipSpace(); cur < end; SkipSpace()) {
+			if (ParseSection(root))
+				continue;
+			if (ParseJunk())
+				continue;
+
+			// stray '}' at top-level
+			throw Error(NULL);
+		}
+	}
+
+private:
+	static bool IsNameChar(char c) {
+		switch (c) {
+			case ';': case '{': case '[': case ']': case '}': case '=': case '\n':
+				return false;
+			default:
+				return true;
+		}
+	}
+	static bool IsJunkChar(char c) { return (c != '}' && c != '[' && c != '\n'); }
 
-	std::list<std::string> junk_data;
-	tdf_grammar grammar(&root_section, &junk_data);
-	parse_info<char const*> info;
-	std::string message;
-	typedef position_iterator2<char const*> iterator_t;
-	iterator_t error_it(buf, buf + size);
-
-	try {
-		info = parse(
-			buf
-			, buf + size
-			, grammar
-			, space_p
-				| comment_p("/*", "*/") // rule for C-comments
-				| comment_p("//")
-			);
-	} catch (const parser_error<tdf_grammar::Errors, char const*>& ex) { // thrown by assertion parsers in tdf_grammar
-
-		switch(ex.descriptor) {
-			case tdf_grammar::semicolon_expected: message = "semicolon expected"; break;
-			case tdf_grammar::equals_sign_expected: message = "equals sign in name value pair expected"; break;
-			case tdf_grammar::square_bracket_expected: message = "square bracket to close section name expected"; break;
-			case tdf_grammar::brace_expected: message = "brace or further name value pairs expected"; break;
-			default: message = "unknown boost::spirit::parser_error exception"; break;
-		};
-
-		std::ptrdiff_t target_pos = ex.where - buf;
-		for (int i = 1; i < target_pos; ++i) {
-			++error_it;
-			if (error_it != (iterator_t(buf + i, buf + size))) {
-				++i;
+	/// returns the position after any whitespace and C/C++ comments at <p>
+	const char* SkipSpace(const char* p) const {
+		while (p < end) {
+			if (isspace(static_cast<unsigned char>(*p))) {
+				++p; continue;
 			}
+			if (*p != '/' || (p + 1) >= end)
+				break;
+
+			if (p[1] == '/') {
+				for (p += 2; p < end && *(p++) != '\n'; );
+				continue;
+			}
+			if (p[1] == '*') {
+				const char* q = p + 2;
+
+				for (; (q + 1) < end && (q[0] != '*' || q[1] != '/'); ++q);
+
+				// unterminated comments are not skipped
+				if ((q + 1) >= end)
+					break;
+
+				p = q + 2;
+				continue;
+			}
+
+			break;
 		}
+
+		return p;
+	}
+	void SkipSpace() { cur = SkipSpace(cur); }
+
+	void Expect(char c, const char* message) {
+		const char* p = SkipSpace(cur);
+
+		// report the position right after the last token, not the next one
+		if (p >= end || *p != c)
+			throw Error(message);
+
+		cur = p + 1;
 	}
 
-	for (std::list<std::string>::const_iterator it = junk_data.begin(), e = junk_data.end(); it !=e ; ++it) {
-		std::string temp = StringTrim(*it);
-		if (!temp.empty()) {
-			LOG_L(L_WARNING, "TdfParser: Junk in %s: %s",
-					filename.c_str(), temp.c_str());
+	/// name-token starting at the current position (after skipping), empty if none
+	bool ParseName(const char*& nameBeg, const char*& nameEnd) {
+		const char* p = SkipSpace(cur);
+
+		if (p >= end || !IsNameChar(*p))
+			return false;
+
+		nameBeg = p;
+		nameEnd = ++p;
+
+		// whitespace counts as a name character, but is skipped (like
+		// comments) before every one so it never ends up trailing a name
+		while ((p = SkipSpace(p)) < end && IsNameChar(*p)) {
+			nameEnd = ++p;
 		}
+
+		cur = nameEnd;
+		return true;
 	}
 
-	if (!message.empty()) {
-		throw parse_error(message, error_it.get_currentline(), error_it.get_position().line, error_it.get_position().column, filename);
+	bool ParseJunk() {
+		const char* p = SkipSpace(cur);
+		const char* q = p;
+
+		while (q < end && IsJunkChar(*q))
+			++q;
+
+		if (q == p)
+			return false;
+
+		cur = q;
+
+		const std::string junk = StringTrim(std::string(p, q));
+
+		if (!junk.empty()) {
+			LOG_L(L_WARNING, "TdfParser: Junk in %s: %s", filename.c_str(), junk.c_str());
+		}
+
+		return true;
 	}
 
-	// a different error might have happened:
-	if (!info.full) {
-		std::ptrdiff_t target_pos = info.stop - buf;
-		for (int i = 1; i < target_pos; ++i) {
-			++error_it;
-			if (error_it != (iterator_t(buf + i, buf + size))) {
-				++i;
+	/// name=value; pair, the value runs up to the next semicolon
+	bool ParseValue(TdfParser::TdfSection* section) {
+		const char* pairBeg = cur;
+		const char* nameBeg;
+		const char* nameEnd;
+
+		if (!ParseName(nameBeg, nameEnd))
+			return false;
+
+		SkipSpace();
+
+		if (cur >= end || *cur != '=') {
+			cur = pairBeg;
+			return false;
+		}
+
+		const char* valueBeg = SkipSpace(cur + 1);
+		const char* valueEnd = valueBeg;
+
+		while (valueEnd < end && *valueEnd != ';')
+			++valueEnd;
+
+		cur = valueEnd;
+		Expect(';', "semicolon expected");
+
+		section->add_name_value(std::string(nameBeg, nameEnd), std::string(valueBeg, valueEnd));
+		return true;
+	}
+
+	bool ParseSection(TdfParser::TdfSection* parent) {
+		const char* sectionBeg = cur;
+		const char* nameBeg;
+		const char* nameEnd;
+
+		SkipSpace();
+
+		if (cur >= end || *cur != '[')
+			return false;
+
+		++cur;
+
+		if (!ParseName(nameBeg, nameEnd)) {
+			cur = sectionBeg;
+			return false;
+		}
+
+		TdfParser::TdfSection* section = parent->construct_subsection(std::string(nameBeg, nameEnd));
+
+		Expect(']', "square bracket to close section name expected");
+		Expect('{', "brace or further name value pairs expected");
+
+		for (SkipSpace(); cur < end && *cur != '}'; SkipSpace()) {
+			if (ParseValue(section))
+				continue;
+			if (ParseSection(section))
+				continue;
+			if (ParseJunk())
+				continue;
+
+			break;
+		}
+
+		Expect('}', "brace or further name value pairs expected");
+		return true;
+	}
+
+	TdfParser::parse_error Error(const char* message) const {
+		// position_iterator-style coordinates: 1-based, tabs advance to the next multiple of 4
+		const char* lineBeg = beg;
+		size_t line = 1;
+		size_t column = 1;
+
+		for (const char* p = beg; p < cur; ++p) {
+			if (*p == '\n') {
+				lineBeg = p + 1;
+				line += 1;
+				column = 1;
+			} else if (*p == '\t') {
+				column = ((column - 1) / 4 + 1) * 4 + 1;
+			} else {
+				column += 1;
 			}
 		}
 
-		throw parse_error(error_it.get_currentline(), error_it.get_position().line, error_it.get_position().column, filename);
+		const char* lineEnd = lineBeg;
+
+		while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r')
+			++lineEnd;
+
+		const std::string lineStr(lineBeg, lineEnd);
+
+		if (message == NULL)
+			return TdfParser::parse_error(lineStr, line, column, filename);
+
+		return TdfParser::parse_error(message, lineStr, line, column, filename);
 	}
+
+private:
+	const char* beg;
+	const char* end;
+	const char* cur;
+
+	const std::string& filename;
+};
+
+
+void TdfParser::parse_buffer(char const* buf, size_t size) {
+	TdfReader reader(buf, size, filename);
+	reader.ParseFile(&root_section);
 }
 
 void TdfParser::LoadBuffer(char const* buf, size_t size)
@@ -9,19 +9,30 @@
 	#include "OffscreenGLContext.h"
 #endif
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 #include <utility>
 #include <boost/optional.hpp>
 #include <boost/thread.hpp>
-#include <boost/thread/shared_mutex.hpp>
 
-static std::deque<std::shared_ptr<ITaskGroup>> taskGroups;
+// every thread (incl. the main thread at index 0) owns a deque of taskgroups,
+// it pops from the back of its own and steals from the front of the others
+struct TaskQueue {
+	TaskQueue() : numGroups(0) {}
+
+	boost::mutex mutex;
+	std::deque<std::shared_ptr<ITaskGroup>> groups;
+	std::atomic<int> numGroups; // checked without lock to skip empty queues
+};
+
+static const int MAX_THREADS = 128;
+
+static TaskQueue taskQueues[MAX_THREADS];
 static std::deque<void*> thread_group;
+static std::atomic<int> numThreads(1);
 
-static boost::shared_mutex taskMutex;
 static boost::condition_variable newTasks;
-static std::atomic<bool> waitForLock(false);
 
 #if !defined(UNITSYNC) && !defined(UNIT_TEST)
 static bool hasOGLthreads = true; // disable for now (not used atm)
@@ -72,82 +83,74 @@ int GetMaxThreads()
 
 int GetNumThreads()
 {
-	//FIXME mutex/atomic?
-	return thread_group.size() + 1; // +1 cause we also count mainthread
+	return numThreads; // includes the mainthread
 }
 
 
 bool HasThreads()
 {
-	return !thread_group.empty() + 1;
+	return (GetNumThreads() > 1);
 }
 
 
-/// returns false, when no further tasks were found
-static bool DoTask(boost::shared_lock<boost::shared_mutex>& lk_)
+/// grabs a single task from the queue, returns the taskgroup it belongs to
+static std::shared_ptr<ITaskGroup> GrabTask(TaskQueue& q, const bool lifo, boost::optional<std::function<void()>>& task)
 {
-	if (waitForLock)
-		return true;
+	if (q.numGroups == 0)
+		return nullptr;
 
-#ifndef __MINGW32__
-	auto& lk = lk_;
-#else
-	boost::unique_lock<boost::shared_mutex> lk(taskMutex, boost::defer_lock);
-#endif
+	boost::lock_guard<boost::mutex> lk(q.mutex);
 
-	if (!taskGroups.empty()) {
-		if (lk.try_lock()) {
-			bool foundEmpty = false;
-
-			for (auto tg: taskGroups) {
-				if (tg->IsEmpty()) {
-					foundEmpty = true;
-					break;
-				} else {
-					lk.unlock();
-					auto p = tg->GetTask();
-					do {
-						if (p) {
-							SCOPED_MT_TIMER("::ThreadWorkers (accumulated)");
-							(*p)();
-						}
-					} while (bool(p = tg->GetTask()));
-					break;
-				}
-			}
-			if (lk.owns_lock()) lk.unlock();
-
-			if (foundEmpty) {
-				//FIXME this could be made lock-free too, but is it worth it?
-				waitForLock = true;
-				boost::unique_lock<boost::shared_mutex> ulk(taskMutex, boost::defer_lock);
-				while (!ulk.try_lock()) {}
-				for(auto it = taskGroups.begin(); it != taskGroups.end();) {
-					if ((*it)->IsEmpty()) {
-						it = taskGroups.erase(it);
-					} else {
-						++it;
-					}
-				}
-				waitForLock = false;
-				ulk.unlock();
-			}
+	// drop groups that have no further tasks to hand out (they may still be running)
+	q.groups.erase(std::remove_if(q.groups.begin(), q.groups.end(), [](const std::shared_ptr<ITaskGroup>& tg) { return tg->IsEmpty(); }), q.groups.end());
+	q.numGroups = q.groups.size();
 
-			return false;
+	// GetTask() is cheap and threadsafe, so do it under lock;
+	// a group may contain tasks only certain threads can run (ParallelTaskGroup)
+	if (lifo) {
+		for (auto it = q.groups.rbegin(); it != q.groups.rend(); ++it) {
+			if ((task = (*it)->GetTask()))
+				return *it;
 		}
+	} else {
+		for (auto it = q.groups.begin(); it != q.groups.end(); ++it) {
+			if ((task = (*it)->GetTask()))
+				return *it;
+		}
+	}
 
-		// we didn't got a lock, so we couldn't see if there are further tasks
-		return true;
+	return nullptr;
+}
+
+
+/// returns false, when no further tasks were found
+static bool DoTask(const int threadNum)
+{
+	boost::optional<std::function<void()>> p;
+	std::shared_ptr<ITaskGroup> tg = GrabTask(taskQueues[threadNum], true, p);
+
+	// nothing in our own queue, try to steal from the other threads
+	for (int n = 1, num = GetNumThreads(); (tg == nullptr) && (n < num); ++n) {
+		tg = GrabTask(taskQueues[(threadNum + n) % num], false, p);
 	}
 
-	return false;
+	if (tg == nullptr)
+		return false;
+
+	// keep working on the same group while it has tasks left (cache locality)
+	do {
+		SCOPED_MT_TIMER("::ThreadWorkers (accumulated)");
+		(*p)();
+	} while (bool(p = tg->GetTask()));
+
+	return true;
 }
 
 
 static bool DoTask(std::shared_ptr<ITaskGroup> tg)
 {
 	auto p = tg->GetTask();
-	const bool f = p;
+	const bool f = bool(p);
 	if (f) {
 		SCOPED_MT_TIMER("::ThreadWorkers (accumulated)");
 		(*p)();
@@ -161,14 +164,13 @@ static void WorkerLoop(int id)
 {
 	SetThreadNum(id);
 	Threading::SetThreadName(IntToString(id, "worker%i"));
-	boost::shared_lock<boost::shared_mutex> lk(taskMutex, boost::defer_lock);
 	boost::mutex m;
 	boost::unique_lock<boost::mutex> lk2(m);
 
 	while (!exitThread) {
 		const auto spinlockStart = boost::chrono::high_resolution_clock::now() + boost::chrono::milliseconds(spinlockMs);
 
-		while (!DoTask(lk) && !exitThread) {
+		while (!DoTask(id) && !exitThread) {
 			if (spinlockStart < boost::chrono::high_resolution_clock::now()) {
 			#ifndef BOOST_THREAD_USES_CHRONO
 				const boost::system_time timeout = boost::get_system_time() + boost::posix_time::microseconds(1);
@@ -187,8 +189,18 @@ void WaitForFinished(std::shared_ptr<ITaskGroup> taskgroup)
 	while (DoTask(taskgroup)) {
 	}
 
-	while (!taskgroup->wait_for(boost::chrono::seconds(5))) {
-		LOG_L(L_WARNING, "Hang in ThreadPool");
+	// while other threads still work on our group, help out with whatever
+	// is queued (this is what makes nested taskgroups not deadlock)
+	auto hangCheck = boost::chrono::high_resolution_clock::now() + boost::chrono::seconds(5);
+
+	while (!taskgroup->IsFinished()) {
+		if (DoTask(GetThreadNum()))
+			continue;
+
+		if (hangCheck < boost::chrono::high_resolution_clock::now()) {
+			LOG_L(L_WARNING, "Hang in ThreadPool");
+			hangCheck = boost::chrono::high_resolution_clock::now() + boost::chrono::seconds(5);
+		}
 	}
 
 	//LOG("WaitForFinished %i", taskgroup->GetExceptions().size());
@@ -199,12 +211,13 @@ void WaitForFinished(std::shared_ptr<ITaskGroup> taskgroup)
 
 void PushTaskGroup(std::shared_ptr<ITaskGroup> taskgroup)
 {
-	waitForLock = true;
-	boost::unique_lock<boost::shared_mutex> lk(taskMutex, boost::defer_lock);
-	while (!lk.try_lock()) {}
-	taskGroups.emplace_back(taskgroup);
-	waitForLock = false;
-	lk.unlock();
+	// push into the queue of the calling thread, idle ones will steal from it
+	TaskQueue& q = taskQueues[GetThreadNum()];
+	{
+		boost::lock_guard<boost::mutex> lk(q.mutex);
+		q.groups.emplace_back(taskgroup);
+		q.numGroups = q.groups.size();
+	}
 	newTasks.notify_all();
 }
 
@@ -219,12 +232,15 @@ void SetThreadCount(int num)
 {
 	int curThreads = GetNumThreads();
 
+	num = std::min(num, MAX_THREADS);
+
 	if (curThreads < num) {
 #ifndef UNITSYNC
 		if (hasOGLthreads) {
 			try {
 				for (int i = curThreads; i<num; ++i) {
 					thread_group.push_back(new COffscreenGLThread(boost::bind(&WorkerLoop, i)));
+					numThreads = thread_group.size() + 1;
 				}
 			} catch (const opengl_error& gle) {
 				// shared gl context creation failed :<
@@ -237,6 +253,7 @@ void SetThreadCount(int num)
 		if (!hasOGLthreads) {
 			for (int i = curThreads; i<num; ++i) {
 				thread_group.push_back(new boost::thread(boost::bind(&WorkerLoop, i)));
+				numThreads = thread_group.size() + 1;
 			}
 		}
 	} else {
@@ -259,6 +276,7 @@ void SetThreadCount(int num)
 				delete th;
 			}
 			thread_group.pop_back();
+			numThreads = thread_group.size() + 1;
 		}
 		if (num == 0) assert(thread_group.empty());
 	}
@@ -54,6 +54,7 @@ static inline auto parallel_reduce(F&& f, G&& g) -> typename std::result_of<F()>
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 #include <list>
@@ -235,7 +236,7 @@ template<class F, class... Args>
 class ParallelTaskGroup : public TaskGroup<F,Args...>
 {
 public:
-	ParallelTaskGroup(const int num = 0) : TaskGroup<F,Args...>(num) {
+	ParallelTaskGroup(const int num = 0) : TaskGroup<F,Args...>(num), remainingUniqueTasks(0) {
 		uniqueTasks.resize(ThreadPool::GetNumThreads());
 	}
 
@@ -249,6 +250,7 @@ public:
 		this->results.emplace_back(task->get_future());
 		uniqueTasks[threadNum].emplace_back([&,task]{ (*task)(); (this->remainingTasks)--; });
 		this->remainingTasks++;
+		remainingUniqueTasks++;
 	}
 
 	void enqueue_unique(const int threadNum, F&& f, Args&&... args)
@@ -259,29 +261,35 @@ public:
 		this->results.emplace_back(task->get_future());
 		uniqueTasks[threadNum].emplace_back([&,task]{ (*task)(); (this->remainingTasks)--; });
 		this->remainingTasks++;
+		remainingUniqueTasks++;
 	}
 
 
 	boost::optional<std::function<void()>> GetTask()
 	{
-		auto& ut = uniqueTasks[ThreadPool::GetThreadNum()];
-		if (!ut.empty()) {
-			// no need to make threadsafe cause each thread got its own container
-			auto t = ut.front();
-			ut.pop_front();
-			return t;
+		const int threadNum = ThreadPool::GetThreadNum();
+		if (threadNum < uniqueTasks.size()) {
+			auto& ut = uniqueTasks[threadNum];
+			if (!ut.empty()) {
+				// no need to make threadsafe cause each thread got its own container
+				auto t = ut.front();
+				ut.pop_front();
+				remainingUniqueTasks--;
+				return t;
+			}
 		}
 
 		return TaskGroup<F,Args...>::GetTask();
 	}
 
 	bool IsEmpty() const {
-		for(auto& ut: uniqueTasks) { if (!ut.empty()) return false; }
-		return TaskGroup<F,Args...>::IsEmpty();
+		// other threads' containers are not safe to inspect, use the counter
+		return (remainingUniqueTasks == 0) && TaskGroup<F,Args...>::IsEmpty();
 	}
 
 public:
 	std::vector<std::deque<std::function<void()>>> uniqueTasks;
+	std::atomic<int> remainingUniqueTasks;
 };
 
 
@@ -304,9 +312,23 @@ static inline void for_mt(int start, int end, int step, const std::function<void
 
 		ThreadPool::NotifyWorkerThreads();
 		SCOPED_MT_TIMER("::ThreadWorkers (real)");
-		auto taskgroup = std::make_shared<TaskGroup<const std::function<void(const int)>, const int>>((end-start)/step);
-		for (int i = start; i < end; i+=step) { //FIXME optimize worksize (group tasks in bigger ones than 1-steps)
-			taskgroup->enqueue(f, i);
+
+		// split the range into a few chunks per thread, one task per iteration
+		// has too much overhead; idle threads steal the remaining chunks
+		const int numIters = (end - start + step - 1) / step;
+		const int numChunks = std::min(numIters, ThreadPool::GetNumThreads() * 4);
+		const int chunkSize = ((numIters + numChunks - 1) / numChunks) * step;
+
+		auto taskgroup = std::make_shared<TaskGroup<const std::function<void()>>>(numChunks);
+		for (int c = start; c < end; c += chunkSize) {
+			const int chunkEnd = std::min(end, c + chunkSize);
+
+			std::function<void()> chunk = [&f, c, chunkEnd, step] {
+				for (int i = c; i < chunkEnd; i += step) {
+					f(i);
+				}
+			};
+			taskgroup->enqueue(std::move(chunk));
 		}
 		ThreadPool::PushTaskGroup(taskgroup);
 		ThreadPool::WaitForFinished(taskgroup);
@@ -3,6 +3,7 @@
 #include "System/TimeProfiler.h"
 
 #include <cstring>
+#include <fstream>
 #include <boost/unordered_map.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/locks.hpp>
@@ -13,6 +14,12 @@
 #ifdef THREADPOOL
 	#include "System/ThreadPool.h"
 #endif
+#ifdef COUNT_ALLOCATIONS
+	#include "System/FrameArena.h"
+#endif
+
+// per thread, must be a power of two
+#define TRACE_EVENTS_PER_THREAD 16384
 
 static boost::mutex m;
 static std::map<int, std::string> hashToName;
@@ -78,6 +85,9 @@ const std::string& BasicTimer::GetName() const
 ScopedTimer::ScopedTimer(const std::string& name, bool autoShow)
 	: BasicTimer(name)
 	, autoShowGraph(autoShow)
+#ifdef COUNT_ALLOCATIONS
+	, startAllocs(GetThreadAllocCount())
+#endif
 
 {
 	it = refs.find(hash);
@@ -91,6 +101,9 @@ ScopedTimer::ScopedTimer(const std::string& name, bool autoShow)
 ScopedTimer::ScopedTimer(const char* name, bool autoShow)
 	: BasicTimer(name)
 	, autoShowGraph(autoShow)
+#ifdef COUNT_ALLOCATIONS
+	, startAllocs(GetThreadAllocCount())
+#endif
 
 {
 	it = refs.find(hash);
@@ -104,8 +117,20 @@ ScopedTimer::ScopedTimer(const char* name, bool autoShow)
 ScopedTimer::~ScopedTimer()
 {
 	int& ref = it->second;
-	if (--ref == 0)
-		profiler.AddTime(GetName(), spring_difftime(spring_gettime(), starttime), autoShowGraph);
+	if (--ref == 0) {
+		const spring_time endtime = spring_gettime();
+
+		profiler.AddTime(GetName(), spring_difftime(endtime, starttime), autoShowGraph);
+		profiler.AddTraceEvent(hash, starttime, endtime);
+	#ifdef COUNT_ALLOCATIONS
+		profiler.AddAllocs(GetName(), GetThreadAllocCount() - startAllocs);
+	#endif
+	}
+}
+
+ScopedTraceTimer::~ScopedTraceTimer()
+{
+	profiler.AddTraceEvent(hash, starttime, spring_gettime());
 }
 
 ScopedOnceTimer::~ScopedOnceTimer()
@@ -131,10 +156,13 @@ ScopedMtTimer::ScopedMtTimer(const char* name, bool autoShow)
 
 ScopedMtTimer::~ScopedMtTimer()
 {
-	profiler.AddTime(GetName(), spring_difftime(spring_gettime(), starttime), autoShowGraph);
+	const spring_time endtime = spring_gettime();
+
+	profiler.AddTime(GetName(), spring_difftime(endtime, starttime), autoShowGraph);
+	profiler.AddTraceEvent(hash, starttime, endtime);
 #ifdef THREADPOOL
 	auto& list = profiler.profileCore[ThreadPool::GetThreadNum()];
-	list.emplace_back(starttime, spring_gettime());
+	list.emplace_back(starttime, endtime);
 #endif
 }
 
@@ -150,7 +178,16 @@ CTimeProfiler::CTimeProfiler():
 {
 #ifdef THREADPOOL
 	profileCore.resize(ThreadPool::GetMaxThreads());
+	traceEvents.resize(ThreadPool::GetMaxThreads());
+#else
+	traceEvents.resize(1);
 #endif
+
+	for (unsigned int n = 0; n < traceEvents.size(); n++) {
+		traceEvents[n].resize(TRACE_EVENTS_PER_THREAD);
+	}
+
+	traceEventPositions.resize(traceEvents.size(), 0);
 }
 
 CTimeProfiler::~CTimeProfiler()
@@ -207,6 +244,24 @@ float CTimeProfiler::GetPercent(const char* name)
 	return profile[name].percent;
 }
 
+void CTimeProfiler::GetTimerStats(std::vector<TimerStats>& stats)
+{
+	boost::unique_lock<boost::mutex> ulk(m, boost::defer_lock);
+	while (!ulk.try_lock()) {}
+
+	stats.clear();
+	stats.reserve(profile.size());
+
+	for (std::map<std::string,TimeRecord>::const_iterator pi = profile.begin(); pi != profile.end(); ++pi) {
+		TimerStats ts;
+		ts.name = pi->first;
+		ts.total = pi->second.total.toSecsf();
+		ts.percent = pi->second.percent;
+		ts.peak = pi->second.peak;
+		stats.push_back(ts);
+	}
+}
+
 void CTimeProfiler::AddTime(const std::string& name, const spring_time time, const bool showGraph)
 {
 	std::map<std::string, TimeRecord>::iterator pi;
@@ -235,8 +290,29 @@ void CTimeProfiler::AddTime(const std::string& name, const spring_time time, con
 	}
 }
 
+void CTimeProfiler::AddAllocs(const std::string& name, const size_t count)
+{
+	std::map<std::string, TimeRecord>::iterator pi;
+
+	if ((pi = profile.find(name)) != profile.end()) {
+		pi->second.allocs += count;
+	}
+}
+
 void CTimeProfiler::PrintProfilingInfo() const
 {
+#ifdef COUNT_ALLOCATIONS
+	LOG("%35s|%18s|%s|%s", "Part", "Total Time", "Time of the last 0.5s", "Allocations");
+
+	for (auto pi = profile.begin(); pi != profile.end(); ++pi) {
+		const std::string& name = pi->first;
+		const TimeRecord& tr = pi->second;
+
+		LOG("%35s %16.2fms %5.2f%% %12lu", name.c_str(), tr.total.toMilliSecsf(), tr.percent * 100, (unsigned long) tr.allocs);
+	}
+
+	LOG("frame arena peak: %lu KiB", (unsigned long) (CFrameArena::GetMaxPeakBytes() / 1024));
+#else
 	LOG("%35s|%18s|%s", "Part", "Total Time", "Time of the last 0.5s");
 
 	for (auto pi = profile.begin(); pi != profile.end(); ++pi) {
@@ -245,4 +321,72 @@ void CTimeProfiler::PrintProfilingInfo() const
 
 		LOG("%35s %16.2fms %5.2f%%", name.c_str(), tr.total.toMilliSecsf(), tr.percent * 100);
 	}
+#endif
+}
+
+void CTimeProfiler::AddTraceEvent(unsigned nameHash, const spring_time start, const spring_time end)
+{
+#ifdef THREADPOOL
+	const int threadNum = ThreadPool::GetThreadNum();
+#else
+	const int threadNum = 0;
+#endif
+
+	// NOTE: with GML the sim- and draw-threads share slot 0 (as for <profile>)
+	unsigned& pos = traceEventPositions[threadNum];
+	TraceEvent& e = traceEvents[threadNum][(pos++) & (TRACE_EVENTS_PER_THREAD - 1)];
+
+	e.nameHash = nameHash;
+	e.start = start;
+	e.end = end;
+}
+
+bool CTimeProfiler::DumpTrace(const std::string& fileName, float msecs) const
+{
+	std::ofstream file(fileName.c_str(), std::ios::out);
+
+	if (!file.is_open()) {
+		LOG_L(L_ERROR, "[%s] could not open \"%s\"", __FUNCTION__, fileName.c_str());
+		return false;
+	}
+
+	const spring_time minTime = spring_gettime() - spring_msecs(msecs);
+
+	unsigned int numEvents = 0;
+
+	file << "{\"traceEvents\":[\n";
+
+	for (unsigned int threadNum = 0; threadNum < traceEvents.size(); threadNum++) {
+		const std::vector<TraceEvent>& events = traceEvents[threadNum];
+		const unsigned pos = traceEventPositions[threadNum];
+		const unsigned num = std::min(pos, unsigned(TRACE_EVENTS_PER_THREAD));
+
+		// oldest to newest
+		for (unsigned int n = pos - num; n != pos; n++) {
+			const TraceEvent& e = events[n & (TRACE_EVENTS_PER_THREAD - 1)];
+
+			if (e.end < minTime)
+				continue;
+
+			const std::map<int, std::string>::const_iterator nameIt = hashToName.find(e.nameHash);
+			const std::string& name = (nameIt != hashToName.end())? nameIt->second: "unknown";
+
+			// timer names are plain identifiers, only guard against quotes
+			std::string escName = name;
+			for (size_t k = 0; (k = escName.find_first_of("\"\\", k)) != std::string::npos; k += 2) {
+				escName.insert(k, 1, '\\');
+			}
+
+			if (numEvents++ > 0)
+				file << ",\n";
+
+			file << "{\"name\":\"" << escName << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadNum;
+			file << ",\"ts\":" << e.start.toMicroSecsi() << ",\"dur\":" << (e.end - e.start).toMicroSecsi() << "}";
+		}
+	}
+
+	file << "\n]}\n";
+
+	LOG("[%s] wrote %u events of the last %.0fms to \"%s\"", __FUNCTION__, numEvents, msecs, fileName.c_str());
+	return true;
 }
@@ -50,6 +50,10 @@ public:
 private:
 	const bool autoShowGraph;
 	std::map<int, int>::iterator it;
+
+#ifdef COUNT_ALLOCATIONS
+	const size_t startAllocs;
+#endif
 };
 
 
@@ -67,6 +71,19 @@ private:
 
 
 
+/**
+ * @brief only records its scope as trace-event (see CTimeProfiler::DumpTrace)
+ *
+ * For fine-grained scopes that would clutter the profiler's timer list.
+ */
+class ScopedTraceTimer : public BasicTimer
+{
+public:
+	ScopedTraceTimer(const std::string& name): BasicTimer(name) {}
+	ScopedTraceTimer(const char* name): BasicTimer(name) {}
+	~ScopedTraceTimer();
+};
+
 /**
  * @brief print passed time to infolog
  */
@@ -91,13 +108,33 @@ public:
 	float GetPercent(const char *name);
 	void Update();
 
+	struct TimerStats {
+		std::string name;
+		float total;   ///< seconds since start
+		float percent; ///< share of the last half second
+		float peak;    ///< highest such share so far
+	};
+
+	/// copies the current figures of all timers (the map may grow from other threads)
+	void GetTimerStats(std::vector<TimerStats>& stats);
+
 	void PrintProfilingInfo() const;
 
 	void AddTime(const std::string& name, const spring_time time, const bool showGraph = false);
+	/// only fed with COUNT_ALLOCATIONS, by ScopedTimer
+	void AddAllocs(const std::string& name, const size_t count);
+
+	/// records a finished timer-scope in the ring-buffer of the calling thread
+	void AddTraceEvent(unsigned nameHash, const spring_time start, const spring_time end);
+	/**
+	 * @brief writes the events of the last <msecs> milliseconds to <fileName>
+	 * in Chrome trace-event format (loadable by chrome://tracing and Perfetto)
+	 */
+	bool DumpTrace(const std::string& fileName, float msecs) const;
 
 public:
 	struct TimeRecord {
-		TimeRecord() : total(0), current(0), percent(0), color(0,0,0), showGraph(false), peak(0), newpeak(false) {
+		TimeRecord() : total(0), current(0), percent(0), color(0,0,0), showGraph(false), peak(0), newpeak(false), allocs(0) {
 			memset(frames, 0, sizeof(frames));
 		}
 		spring_time total;
@@ -109,6 +146,8 @@ public:
 		bool showGraph;
 		float peak;
 		bool newpeak;
+		/// heap allocations made inside the scope (COUNT_ALLOCATIONS only)
+		size_t allocs;
 	};
 
 	std::map<std::string,TimeRecord> profile;
@@ -116,6 +155,16 @@ public:
 	std::vector<std::deque<std::pair<spring_time,spring_time>>> profileCore;
 
 private:
+	struct TraceEvent {
+		unsigned nameHash;
+		spring_time start;
+		spring_time end;
+	};
+
+	/// one fixed-size ring per (pool-)thread, so recording never allocates or locks
+	std::vector< std::vector<TraceEvent> > traceEvents;
+	std::vector<unsigned> traceEventPositions;
+
 	spring_time lastBigUpdate;
 	/// increases each update, from 0 to (frames_size-1)
 	unsigned currentPosition;
@@ -5,6 +5,7 @@
 
 #include <string>
 #include <sstream>
+#include <vector>
 #include <algorithm>
 #include <boost/utility.hpp>
 
@@ -195,6 +196,24 @@ inline I set_erase(S &s, I i) {
 #endif
 }
 
+/**
+ * @brief Removes the first occurrence of e from v in O(1) after the search
+ * by swapping it with the last element, so the order is NOT preserved.
+ * @return true if e was found
+ */
+template<typename T>
+static inline bool VectorErase(std::vector<T>& v, const T& e)
+{
+	typename std::vector<T>::iterator it = std::find(v.begin(), v.end(), e);
+
+	if (it == v.end())
+		return false;
+
+	*it = v.back();
+	v.pop_back();
+	return true;
+}
+
 
 
 
@@ -9,6 +9,7 @@
 
 #include "creg_cond.h"
 #include "Serializer.h"
+#include "VarTypes.h"
 
 #include "System/Log/ILog.h"
 #include "System/Platform/byteorder.h"
@@ -69,6 +70,87 @@ struct PackageHeader
 
 
 
+/**
+ * Consecutive serialized members of one class. Runs of basic-typed members
+ * that are also adjacent in memory are written and read with one stream
+ * call instead of a virtual IType::Serialize (and stream seek) per member;
+ * the bytes in the file are the same.
+ */
+struct MemberSpan {
+	uint first; ///< index into Class::members
+	uint count; ///< number of members, > 1 only for basic runs
+	int size;   ///< bytes of a basic run, 0 otherwise
+};
+
+static const std::vector<MemberSpan>& GetMemberSpans(Class* c)
+{
+	// built once per class on first use; creg classes never change after
+	// registration and (de)serialization only runs on one thread at a time
+	static std::map<Class*, std::vector<MemberSpan> > classSpans;
+	static std::vector<MemberSpan> noSpans;
+
+	std::map<Class*, std::vector<MemberSpan> >::iterator it = classSpans.find(c);
+
+	if (it != classSpans.end())
+		return it->second;
+
+	std::vector<MemberSpan>& spans = classSpans[c];
+
+	for (uint a = 0; a < c->members.size(); a++) {
+		const Class::Member* m = c->members[a];
+
+		if (m->flags & CM_NoSerialize)
+			continue;
+
+		BasicType* bt = dynamic_cast<BasicType*>(m->type.get());
+		const int size = (bt != NULL)? int(bt->GetSize()): 0;
+
+		if (size > 0 && !spans.empty() && spans.back().size > 0) {
+			MemberSpan& span = spans.back();
+
+			// extend only across members that are next to each other both
+			// in the member list and in memory (no skipped member between)
+			if ((span.first + span.count) == a && (c->members[span.first]->offset + span.size) == m->offset) {
+				span.count += 1;
+				span.size += size;
+				continue;
+			}
+		}
+
+		MemberSpan span = {a, 1, size};
+		spans.push_back(span);
+	}
+
+	return spans;
+}
+
+static void SwabIntInPlace(void* data, int byteSize)
+{
+	switch (byteSize) {
+		case 1: {
+			*(char*)data = *(char*) data;
+			break;
+		}
+		case 2: {
+			swabWordInPlace(*(boost::int64_t*)data);
+			break;
+		}
+		case 4: {
+			swabDWordInPlace(*(int*)data);
+			break;
+		}
+		case 8: {
+			swab64InPlace(*(boost::int64_t*)data);
+			break;
+		}
+		default: {
+			throw "Unknown int type";
+		}
+	}
+}
+
+
+
 static std::string ReadZStr(std::istream& file)
 {
 	char cstr[1024];
@@ -151,12 +233,31 @@ void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* ob
 
 	ObjectMemberGroup omg;
 	omg.membersClass = c;
+	omg.size = 0;
 
-	for (uint a = 0; a < c->members.size(); a++)
+	const std::vector<MemberSpan>& spans = GetMemberSpans(c);
+
+	for (uint s = 0; s < spans.size(); s++)
 	{
+		const MemberSpan& span = spans[s];
+		const uint a = span.first;
 		creg::Class::Member* m = c->members[a];
-		if (m->flags & CM_NoSerialize)
+
+		if (span.size > 0) {
+			// basic-typed run, raw bytes like BasicType::Serialize
+			stream->write(((char*)ptr) + m->offset, span.size);
+
+			for (uint n = a; n < (a + span.count); n++) {
+				ObjectMember om;
+				om.member = c->members[n];
+				om.memberId = n;
+				om.size = static_cast<BasicType*>(om.member->type.get())->GetSize();
+				omg.members.push_back(om);
+			}
+
+			omg.size += span.size;
 			continue;
+		}
 
 		ObjectMember om;
 		om.member = m;
@@ -199,13 +300,11 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 		ptrToId[inst].push_back(obj);
 	} else if (obj->isEmbedded) {
 		throw "Reserialization of embedded object (" + objClass->name + ")";
+	} else if (!obj->isPending) {
+		throw "Object pointer was serialized (" + objClass->name + ")";
 	} else {
-		std::vector<ObjectRef*>::iterator it = std::find(pendingObjects.begin(), pendingObjects.end(), obj);
-		if (it == pendingObjects.end()) {
-			throw "Object pointer was serialized (" + objClass->name + ")";
-		} else {
-			pendingObjects.erase(it);
-		}
+		// still queued in pendingObjects, SavePackage will skip it
+		obj->isPending = false;
 	}
 	obj->class_ = objClass;
 	obj->isEmbedded = true;
@@ -228,6 +327,7 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 			obj = &objects.back();
 			ptrToId[*ptr].push_back(obj);
 			pendingObjects.push_back(obj);
+			obj->isPending = true;
 		}
 		id = obj->id;
 
@@ -298,6 +398,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	obj = &objects.back();
 	ptrToId[rootObj].push_back(obj);
 	pendingObjects.push_back(obj);
+	obj->isPending = true;
 
 	std::map<creg::Class*, int> classSizes;
 	// Save until all the referenced objects have been stored
@@ -309,6 +410,13 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 		for (std::vector<ObjectRef*>::const_iterator i = po.begin(); i != po.end(); ++i)
 		{
 			ObjectRef* obj = *i;
+
+			// serialized as an embedded instance in the meantime
+			if (!obj->isPending)
+				continue;
+
+			obj->isPending = false;
+
 			const unsigned objstart = stream->tellp();
 			SerializeObject(obj->class_, obj->ptr, obj);
 			const unsigned objend = stream->tellp();
@@ -322,7 +430,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	std::map<creg::Class*, ClassRef> classMap;
 	std::vector<ClassRef*> classRefs;
 	std::map<int, int> classObjects;
-	for (std::list<ObjectRef>::iterator i = objects.begin(); i != objects.end(); ++i) {
+	for (std::deque<ObjectRef>::iterator i = objects.begin(); i != objects.end(); ++i) {
 		if (i->ptr == NULL) continue;
 
 		creg::Class* c = i->class_;
@@ -364,7 +472,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	// Write object info
 	ph.objTableOffset = (int)stream->tellp();
 	ph.numObjects = objects.size();
-	for (std::list<ObjectRef>::iterator i = objects.begin(); i != objects.end(); ++i) {
+	for (std::deque<ObjectRef>::iterator i = objects.begin(); i != objects.end(); ++i) {
 		int classRefIndex = i->classIndex;
 		char isEmbedded = i->isEmbedded ? 1 : 0;
 		WriteVarSizeUInt(stream, classRefIndex);
@@ -455,11 +563,24 @@ void CInputStreamSerializer::SerializeObject(Class* c, void* ptr)
 	if (c->base)
 		SerializeObject(c->base, ptr);
 
-	for (uint a = 0; a < c->members.size(); a++)
+	const std::vector<MemberSpan>& spans = GetMemberSpans(c);
+
+	for (uint s = 0; s < spans.size(); s++)
 	{
-		creg::Class::Member* m = c->members [a];
-		if (m->flags & CM_NoSerialize)
+		const MemberSpan& span = spans[s];
+		creg::Class::Member* m = c->members[span.first];
+
+		if (span.size > 0) {
+			char* runAddr = ((char*)ptr) + m->offset;
+			stream->read(runAddr, span.size);
+
+			for (uint n = span.first; n < (span.first + span.count); n++) {
+				creg::Class::Member* rm = c->members[n];
+				SwabIntInPlace(((char*)ptr) + rm->offset, static_cast<BasicType*>(rm->type.get())->GetSize());
+			}
+
 			continue;
+		}
 
 		const unsigned oldPos = stream->tellg();
 		void* memberAddr = ((char*)ptr) + m->offset;
@@ -482,27 +603,7 @@ void CInputStreamSerializer::SerializeInt(void* data, int byteSize)
 {
 	//FIXME transform to template?
 	stream->read((char*)data, byteSize);
-	switch (byteSize) {
-		case 1: {
-			*(char*)data = *(char*) data;
-			break;
-		}
-		case 2: {
-			swabWordInPlace(*(boost::int64_t*)data);
-			break;
-		}
-		case 4: {
-			swabDWordInPlace(*(int*)data);
-			break;
-		}
-		case 8: {
-			swab64InPlace(*(boost::int64_t*)data);
-			break;
-		}
-		default: {
-			throw "Unknown int type";
-		}
-	}
+	SwabIntInPlace(data, byteSize);
 }
 
 void CInputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* cls)
@@ -7,8 +7,9 @@
 #include "creg_cond.h"
 #include <map>
 #include <vector>
-#include <list>
+#include <deque>
 #include <istream>
+#include <boost/unordered_map.hpp>
 
 namespace creg {
 
@@ -36,6 +37,7 @@ namespace creg {
 				id=0;
 				classIndex=0;
 				isEmbedded=false;
+				isPending=false;
 				class_=0;
 			}
 			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_) {
@@ -43,6 +45,7 @@ namespace creg {
 				this->id=id;
 				classIndex=0;
 				this->isEmbedded=isEmbedded;
+				isPending=false;
 				this->class_=class_;
 			}
 			ObjectRef(const ObjectRef&src) :memberGroups(src.memberGroups){
@@ -50,11 +53,13 @@ namespace creg {
 				id=src.id;
 				classIndex=src.classIndex;
 				isEmbedded=src.isEmbedded;
+				isPending=src.isPending;
 				class_=src.class_;
 			}
 			void* ptr;
 			int id, classIndex;
 			bool isEmbedded;
+			bool isPending; // referenced by pointer, but not saved yet
 			Class* class_;
 			std::vector<COutputStreamSerializer::ObjectMemberGroup> memberGroups;
 			bool isThisObject(void* objPtr, Class* objClass, bool objEmbedded) const
@@ -78,8 +83,8 @@ namespace creg {
 		struct ClassRef;
 
 		std::ostream* stream;
-		std::map<void*,std::vector<ObjectRef*> > ptrToId;
-		std::list<ObjectRef> objects;
+		boost::unordered_map<void*,std::vector<ObjectRef*> > ptrToId;
+		std::deque<ObjectRef> objects; // deque: references stay valid on push_back
 		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved
 
 		// Serialize all class names
@@ -0,0 +1,145 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef FLOAT3_BATCH_H
+#define FLOAT3_BATCH_H
+
+#include <algorithm>
+
+#include "System/float3.h"
+
+// the packed kernels are only used when synced math runs on the SSE unit
+// anyway; with x87 or soft-float streflop the scalar loops must be taken
+// or results would differ from float3's own member functions
+#if !defined(DEDICATED_NOSSE) && !defined(STREFLOP_X87) && !defined(STREFLOP_SOFT)
+	#define FLOAT3_BATCH_SSE
+	#include <xmmintrin.h>
+#endif
+
+/**
+ * @brief Batch versions of the float3 hot-path functions
+ *
+ * Every kernel processes arrays of contiguous float3's four at a time and
+ * evaluates exactly the same sequence of single-precision IEEE operations
+ * (one rounding per mul/add/sub, same association) as the corresponding
+ * float3 member function, so out[i] is bit-identical to the scalar result
+ * under the streflop SSE settings and safe to use from synced code.
+ * No sqrt is involved; callers compare squared values or take the root of
+ * the winner only.
+ */
+namespace float3batch {
+#ifdef FLOAT3_BATCH_SSE
+	/// loads v[0..3] and transposes them into one register per component
+	inline void LoadSoA(const float3* v, __m128& xs, __m128& ys, __m128& zs) {
+		// a = {x0 y0 z0 x1}, b = {y1 z1 x2 y2}, c = {z2 x3 y3 z3}
+		const __m128 a = _mm_loadu_ps(&v[0].x);
+		const __m128 b = _mm_loadu_ps(&v[0].x + 4);
+		const __m128 c = _mm_loadu_ps(&v[0].x + 8);
+
+		xs = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		ys = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		zs = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	}
+#endif
+
+	/// out[i] = v[i].SqDistance(p)
+	inline void SqDistances(const float3& p, const float3* v, unsigned int n, float* out) {
+		unsigned int i = 0;
+
+	#ifdef FLOAT3_BATCH_SSE
+		const __m128 px = _mm_set1_ps(p.x);
+		const __m128 py = _mm_set1_ps(p.y);
+		const __m128 pz = _mm_set1_ps(p.z);
+
+		for (; (i + 4) <= n; i += 4) {
+			__m128 xs, ys, zs;
+			LoadSoA(&v[i], xs, ys, zs);
+
+			const __m128 dx = _mm_sub_ps(xs, px);
+			const __m128 dy = _mm_sub_ps(ys, py);
+			const __m128 dz = _mm_sub_ps(zs, pz);
+
+			// (dx*dx + dy*dy) + dz*dz
+			_mm_storeu_ps(&out[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+		}
+	#endif
+
+		for (; i < n; i++) {
+			out[i] = v[i].SqDistance(p);
+		}
+	}
+
+	/// out[i] = v[i].SqDistance2D(p)
+	inline void SqDistances2D(const float3& p, const float3* v, unsigned int n, float* out) {
+		unsigned int i = 0;
+
+	#ifdef FLOAT3_BATCH_SSE
+		const __m128 px = _mm_set1_ps(p.x);
+		const __m128 pz = _mm_set1_ps(p.z);
+
+		for (; (i + 4) <= n; i += 4) {
+			__m128 xs, ys, zs;
+			LoadSoA(&v[i], xs, ys, zs);
+
+			const __m128 dx = _mm_sub_ps(xs, px);
+			const __m128 dz = _mm_sub_ps(zs, pz);
+
+			_mm_storeu_ps(&out[i], _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)));
+		}
+	#endif
+
+		for (; i < n; i++) {
+			out[i] = v[i].SqDistance2D(p);
+		}
+	}
+
+	/// out[i] = d.dot(v[i])
+	inline void Dots(const float3& d, const float3* v, unsigned int n, float* out) {
+		unsigned int i = 0;
+
+	#ifdef FLOAT3_BATCH_SSE
+		const __m128 dx = _mm_set1_ps(d.x);
+		const __m128 dy = _mm_set1_ps(d.y);
+		const __m128 dz = _mm_set1_ps(d.z);
+
+		for (; (i + 4) <= n; i += 4) {
+			__m128 xs, ys, zs;
+			LoadSoA(&v[i], xs, ys, zs);
+
+			// (x*v.x + y*v.y) + z*v.z
+			_mm_storeu_ps(&out[i], _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, xs), _mm_mul_ps(dy, ys)), _mm_mul_ps(dz, zs)));
+		}
+	#endif
+
+		for (; i < n; i++) {
+			out[i] = d.dot(v[i]);
+		}
+	}
+
+	/// index of the element of v closest to p (-1 if n is 0), ties go to the lowest index
+	inline int Nearest(const float3& p, const float3* v, unsigned int n, float* sqDist = NULL) {
+		float bestSqDist = 0.0f;
+		int bestIdx = -1;
+
+		float tmp[64];
+
+		for (unsigned int i = 0; i < n; i += 64) {
+			const unsigned int m = std::min(n - i, 64u);
+
+			SqDistances(p, &v[i], m, tmp);
+
+			for (unsigned int j = 0; j < m; j++) {
+				if (bestIdx < 0 || tmp[j] < bestSqDist) {
+					bestSqDist = tmp[j];
+					bestIdx = i + j;
+				}
+			}
+		}
+
+		if (sqDist != NULL)
+			*sqDist = bestSqDist;
+
+		return bestIdx;
+	}
+}
+
+#endif // FLOAT3_BATCH_H
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <string>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -47,7 +48,7 @@ extern "C"
 {
 #endif
 
-void ParseCmdLine(int argc, char* argv[], std::string* script_txt)
+void ParseCmdLine(int argc, char* argv[], std::vector<std::string>* scriptNames)
 {
 	#undef  LOG_SECTION_CURRENT
 	#define LOG_SECTION_CURRENT LOG_SECTION_DEFAULT
@@ -55,7 +56,7 @@ void ParseCmdLine(int argc, char* argv[], std::string* script_txt)
 	std::string binaryname = argv[0];
 
 	CmdLineParams cmdline(argc, argv);
-	cmdline.SetUsageDescription("Usage: " + binaryname + " [options] path_to_script.txt");
+	cmdline.SetUsageDescription("Usage: " + binaryname + " [options] path_to_script.txt [path_to_script2.txt ...]");
 	cmdline.AddSwitch(0,   "sync-version",       "Display program sync version (for online gaming)");
 	cmdline.AddString('C', "config",             "Exclusive configuration file");
 	cmdline.AddSwitch(0,   "list-config-vars",   "Dump a list of config vars and meta data to stdout");
@@ -96,8 +97,8 @@ void ParseCmdLine(int argc, char* argv[], std::string* script_txt)
 	}
 
 
-	*script_txt = cmdline.GetInputFile();
-	if (script_txt->empty() && !cmdline.IsSet("list-config-vars")) {
+	*scriptNames = cmdline.GetInputFiles();
+	if (scriptNames->empty() && !cmdline.IsSet("list-config-vars")) {
 		cmdline.PrintUsage();
 		exit(1);
 	}
@@ -131,6 +132,80 @@ void ParseCmdLine(int argc, char* argv[], std::string* script_txt)
 
 
 
+static CGameServer* CreateGameServer(const std::string& scriptName)
+{
+	LOG("loading script from file: %s", scriptName.c_str());
+
+	ClientSetup settings;
+	CFileHandler fh(scriptName);
+	std::string scriptText;
+
+	if (!fh.FileExists())
+		throw content_error("script does not exist in given location: " + scriptName);
+
+	if (!fh.LoadStringData(scriptText))
+		throw content_error("script cannot be read: " + scriptName);
+
+	settings.Init(scriptText);
+
+	// owned by the server once it is constructed
+	CGameSetup* setup = new CGameSetup();
+
+	if (!setup->Init(scriptText)) {
+		// read the script provided by cmdline
+		LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
+		delete setup;
+		return NULL;
+	}
+
+	// Create the server, it will run in a separate thread
+	GameData data;
+	UnsyncedRNG rng;
+
+	const unsigned seed = time(NULL) % ((spring_gettime().toNanoSecsi() + 1) * 9007);
+	rng.Seed(seed);
+	data.SetRandomSeed(rng.RandInt());
+
+	//  Use script provided hashes if they exist
+	if (setup->mapHash != 0) {
+		data.SetMapChecksum(setup->mapHash);
+		setup->LoadStartPositions(false); // reduced mode
+	} else {
+		data.SetMapChecksum(archiveScanner->GetArchiveCompleteChecksum(setup->mapName));
+
+		CFileHandler f("maps/" + setup->mapName);
+		if (!f.FileExists()) {
+			vfsHandler->AddArchiveWithDeps(setup->mapName, false);
+			setup->LoadStartPositions(); // full mode
+
+			// the map is not needed after this, and leaving it in
+			// the VFS would shadow the mapinfo of later scripts
+			const std::vector<std::string>& mapArchives = archiveScanner->GetArchives(setup->mapName);
+
+			for (std::vector<std::string>::const_iterator it = mapArchives.begin(); it != mapArchives.end(); ++it) {
+				vfsHandler->RemoveArchive(*it);
+			}
+		} else {
+			setup->LoadStartPositions(); // full mode
+		}
+	}
+
+	if (setup->modHash != 0) {
+		data.SetModChecksum(setup->modHash);
+	} else {
+		const std::string& modArchive = archiveScanner->ArchiveFromName(setup->modName);
+		const unsigned int modCheckSum = archiveScanner->GetArchiveCompleteChecksum(modArchive);
+		data.SetModChecksum(modCheckSum);
+	}
+
+	LOG("starting server...");
+
+	data.SetSetup(setup->gameSetupText);
+	return (new CGameServer(settings.hostIP, settings.hostPort, &data, setup));
+}
+
+
+
 int main(int argc, char* argv[])
 {
 	try {
@@ -141,10 +216,9 @@ int main(int argc, char* argv[])
 
 		CLogOutput::LogSystemInfo();
 
-		std::string scriptName;
-		std::string scriptText;
+		std::vector<std::string> scriptNames;
 
-		ParseCmdLine(argc, argv, &scriptName);
+		ParseCmdLine(argc, argv, &scriptNames);
 
 		GlobalConfig::Instantiate();
 		FileSystemInitializer::InitializeLogOutput();
@@ -154,94 +228,66 @@ int main(int argc, char* argv[])
 		CrashHandler::Install();
 
 		LOG("report any errors to Mantis or the forums.");
-		LOG("loading script from file: %s", scriptName.c_str());
 
-		CGameServer* server = NULL;
-		ClientSetup settings;
-		CFileHandler fh(scriptName);
+		// every script gets its own server (and port), but all of
+		// them share this process' archive-scanner, VFS and config
+		std::vector<CGameServer*> servers;
+		servers.reserve(scriptNames.size());
 
-		if (!fh.FileExists())
-			throw content_error("script does not exist in given location: " + scriptName);
+		for (size_t n = 0; n < scriptNames.size(); ++n) {
+			CGameServer* server = CreateGameServer(scriptNames[n]);
 
-		if (!fh.LoadStringData(scriptText))
-			throw content_error("script cannot be read: " + scriptName);
-
-		settings.Init(scriptText);
-		gameSetup = new CGameSetup(); // to store the gamedata inside
-
-		if (!gameSetup->Init(scriptText)) {
-			// read the script provided by cmdline
-			LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
-			return 1;
-		}
-
-		// Create the server, it will run in a separate thread
-		GameData data;
-		UnsyncedRNG rng;
-
-		const unsigned seed = time(NULL) % ((spring_gettime().toNanoSecsi() + 1) * 9007);
-		rng.Seed(seed);
-		data.SetRandomSeed(rng.RandInt());
-
-		//  Use script provided hashes if they exist
-		if (gameSetup->mapHash != 0) {
-			data.SetMapChecksum(gameSetup->mapHash);
-			gameSetup->LoadStartPositions(false); // reduced mode
-		} else {
-			data.SetMapChecksum(archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName));
+			if (server == NULL)
+				break;
 
-			CFileHandler f("maps/" + gameSetup->mapName);
-			if (!f.FileExists()) {
-				vfsHandler->AddArchiveWithDeps(gameSetup->mapName, false);
-			}
-			gameSetup->LoadStartPositions(); // full mode
+			servers.push_back(server);
 		}
 
-		if (gameSetup->modHash != 0) {
-			data.SetModChecksum(gameSetup->modHash);
-		} else {
-			const std::string& modArchive = archiveScanner->ArchiveFromName(gameSetup->modName);
-			const unsigned int modCheckSum = archiveScanner->GetArchiveCompleteChecksum(modArchive);
-			data.SetModChecksum(modCheckSum);
-		}
+		if (servers.size() == scriptNames.size()) {
+			std::vector<bool> printedData(servers.size(), false);
+			size_t numFinished = 0;
 
-		LOG("starting server...");
+			while (numFinished < servers.size()) {
+				numFinished = 0;
 
-		data.SetSetup(gameSetup->gameSetupText);
-		server = new CGameServer(settings.hostIP, settings.hostPort, &data, gameSetup);
+				for (size_t n = 0; n < servers.size(); ++n) {
+					const CGameServer* server = servers[n];
 
-		while (!server->HasGameID()) {
-			// wait until gameID has been generated or
-			// a timeout occurs (if no clients connect)
-			if (server->HasFinished()) {
-				break;
-			}
+					if (server->HasFinished()) {
+						numFinished++;
+						continue;
+					}
 
-			spring_secs(1).sleep();
-		}
+					// the recorder only becomes available once the
+					// gameID has been generated (or never if demo
+					// recording is disabled)
+					if (printedData[n] || !server->HasGameID() || server->GetDemoRecorder() == NULL)
+						continue;
 
-		while (!server->HasFinished()) {
-			static bool printData = (server->GetDemoRecorder() != NULL);
+					printedData[n] = true;
 
-			if (printData) {
-				printData = false;
+					const boost::scoped_ptr<CDemoRecorder>& demoRec = server->GetDemoRecorder();
+					const boost::uint8_t* gameID = (demoRec->GetFileHeader()).gameID;
 
-				const boost::scoped_ptr<CDemoRecorder>& demoRec = server->GetDemoRecorder();
-				const boost::uint8_t* gameID = (demoRec->GetFileHeader()).gameID;
+					LOG("[%s] recording demo: %s", scriptNames[n].c_str(), (demoRec->GetName()).c_str());
+					LOG("[%s] using mod: %s", scriptNames[n].c_str(), (server->GetGameSetup()->modName).c_str());
+					LOG("[%s] using map: %s", scriptNames[n].c_str(), (server->GetGameSetup()->mapName).c_str());
+					LOG("[%s] GameID: %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", scriptNames[n].c_str(), gameID[0], gameID[1], gameID[2], gameID[3], gameID[4], gameID[5], gameID[6], gameID[7], gameID[8], gameID[9], gameID[10], gameID[11], gameID[12], gameID[13], gameID[14], gameID[15]);
+				}
 
-				LOG("recording demo: %s", (demoRec->GetName()).c_str());
-				LOG("using mod: %s", (gameSetup->modName).c_str());
-				LOG("using map: %s", (gameSetup->mapName).c_str());
-				LOG("GameID: %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", gameID[0], gameID[1], gameID[2], gameID[3], gameID[4], gameID[5], gameID[6], gameID[7], gameID[8], gameID[9], gameID[10], gameID[11], gameID[12], gameID[13], gameID[14], gameID[15]);
+				// wait 1 second between checks
+				spring_secs(1).sleep();
 			}
-
-			// wait 1 second between checks
-			spring_secs(1).sleep();
 		}
 
 		LOG("exiting");
 
-		delete server;
+		for (size_t n = 0; n < servers.size(); ++n) {
+			delete servers[n];
+		}
+
+		if (servers.size() != scriptNames.size())
+			return 1;
 
 		FileSystemInitializer::Cleanup();
 		GlobalConfig::Deallocate();
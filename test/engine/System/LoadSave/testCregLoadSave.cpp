@@ -15,6 +15,7 @@
 
 class EmbeddedObj {
 	CR_DECLARE(EmbeddedObj);
+public:
 	int value;
 };
 
@@ -65,6 +66,54 @@ CR_REG_METADATA(TestObj, (
 	//CR_MEMBER(embeddedPtrs)
 ));
 
+// pointer member registered before the embedded object it references
+struct PtrFirstObj {
+	CR_DECLARE(PtrFirstObj);
+
+	PtrFirstObj() {
+		embeddedPtr = &embedded;
+		embedded.value = 0;
+	}
+
+	EmbeddedObj* embeddedPtr;
+	EmbeddedObj embedded;
+};
+
+CR_BIND(PtrFirstObj, );
+CR_REG_METADATA(PtrFirstObj, (
+	CR_MEMBER(embeddedPtr),
+	CR_MEMBER(embedded)
+));
+
+// runs of adjacent basic members are (de)serialized in one block
+struct PodRunObj {
+	CR_DECLARE(PodRunObj);
+
+	PodRunObj(): a(0), b(0), c(0.0f), d(0), e(0), name(""), f(0), g(false) {}
+
+	int a;
+	int b;
+	float c;
+	short d;
+	short e;
+	std::string name;
+	int f;
+	bool g;
+};
+
+CR_BIND(PodRunObj, );
+CR_REG_METADATA(PodRunObj, (
+	CR_MEMBER(a),
+	CR_MEMBER(b),
+	CR_MEMBER(c),
+	CR_MEMBER(e), // out of order, starts a new run
+	CR_MEMBER(d),
+	CR_MEMBER(name),
+	CR_MEMBER(f),
+	CR_MEMBER(g)
+));
+
+
 
 static void savetest(std::ostream* os)
 {
@@ -155,3 +204,60 @@ BOOST_AUTO_TEST_CASE( BOOST_TEST_MODULE )
 
 	delete root;
 }
+
+
+BOOST_AUTO_TEST_CASE( PointerBeforeEmbedded )
+{
+	creg::System::InitializeClasses();
+
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+
+	{
+		PtrFirstObj* o = new PtrFirstObj;
+		o->embedded.value = 42;
+
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&ss, o, o->GetClass());
+		delete o;
+	}
+
+	PtrFirstObj* root = (PtrFirstObj*)loadtest(&ss);
+
+	BOOST_CHECK_MESSAGE(root->embedded.value == 42,           "test embedded member");
+	BOOST_CHECK_MESSAGE(root->embeddedPtr == &root->embedded, "test pointer to embedded member");
+
+	delete root;
+}
+
+
+BOOST_AUTO_TEST_CASE( BasicMemberRuns )
+{
+	creg::System::InitializeClasses();
+
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+
+	{
+		PodRunObj* o = new PodRunObj;
+		o->a = 1;
+		o->b = -2;
+		o->c = 3.5f;
+		o->d = 4;
+		o->e = 5;
+		o->name = "run";
+		o->f = 6;
+		o->g = true;
+
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&ss, o, o->GetClass());
+		delete o;
+	}
+
+	PodRunObj* root = (PodRunObj*)loadtest(&ss);
+
+	BOOST_CHECK_MESSAGE(root->a == 1 && root->b == -2 && root->c == 3.5f, "test adjacent members");
+	BOOST_CHECK_MESSAGE(root->d == 4 && root->e == 5,                     "test reordered members");
+	BOOST_CHECK_MESSAGE(root->name == "run",                              "test non-basic member");
+	BOOST_CHECK_MESSAGE(root->f == 6 && root->g,                          "test members after it");
+
+	delete root;
+}
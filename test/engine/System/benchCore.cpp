@@ -0,0 +1,224 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+// micro-benchmarks for self-contained core data structures; not a unit test
+// (timings are machine dependent), build with "make benchmarks" and run
+// bench_Core, which prints one CSV line per benchmark:
+//   benchmark,iterations,ns_per_op,allocs_per_op
+// allocs_per_op counts global operator new calls (see COUNT_ALLOCATIONS)
+
+#include "System/CRC.h"
+#include "System/FrameArena.h"
+#include "System/Matrix44f.h"
+#include "System/SmallVector.h"
+#include "System/float3.h"
+#include "System/float3batch.h"
+#include "System/Misc/SpringTime.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// keeps the optimizer from dropping the benchmarked work
+static volatile unsigned int sink = 0;
+
+
+struct Benchmark {
+	const char* name;
+	unsigned int iterations;
+	void (*func)(unsigned int iterations);
+};
+
+
+static void Run(const Benchmark& b, const char* filter)
+{
+	if (filter != NULL && std::strstr(b.name, filter) == NULL)
+		return;
+
+	// warm up caches and lazily initialized tables
+	b.func(std::max(1u, b.iterations / 10));
+
+	const size_t startAllocs = GetThreadAllocCount();
+	const spring_time startTime = spring_gettime();
+
+	b.func(b.iterations);
+
+	const spring_time endTime = spring_gettime();
+	const size_t endAllocs = GetThreadAllocCount();
+
+	const double nsPerOp = (endTime - startTime).toNanoSecsi() / double(b.iterations);
+	const double allocsPerOp = (endAllocs - startAllocs) / double(b.iterations);
+
+	printf("%s,%u,%.2f,%.3f\n", b.name, b.iterations, nsPerOp, allocsPerOp);
+}
+
+
+static std::vector<float3> MakePositions(unsigned int n)
+{
+	std::vector<float3> v(n);
+
+	for (unsigned int i = 0; i < n; i++) {
+		v[i] = float3((i * 7919) % 8192, (i * 104729) % 512, (i * 1299709) % 8192);
+	}
+
+	return v;
+}
+
+
+static void Float3NearestScalar(unsigned int iterations)
+{
+	const std::vector<float3> v = MakePositions(256);
+
+	for (unsigned int n = 0; n < iterations; n++) {
+		const float3 p(n % 8192, 0.0f, (n * 31) % 8192);
+
+		float bestSqDist = v[0].SqDistance(p);
+		unsigned int bestIdx = 0;
+
+		for (unsigned int i = 1; i < v.size(); i++) {
+			const float sqDist = v[i].SqDistance(p);
+
+			if (sqDist < bestSqDist) {
+				bestSqDist = sqDist;
+				bestIdx = i;
+			}
+		}
+
+		sink += bestIdx;
+	}
+}
+
+static void Float3NearestBatch(unsigned int iterations)
+{
+	const std::vector<float3> v = MakePositions(256);
+
+	for (unsigned int n = 0; n < iterations; n++) {
+		const float3 p(n % 8192, 0.0f, (n * 31) % 8192);
+
+		sink += float3batch::Nearest(p, &v[0], v.size());
+	}
+}
+
+
+static void Matrix44fVectorMul(unsigned int iterations)
+{
+	CMatrix44f m;
+	m.RotateY(0.5f);
+	m.Translate(float3(1.0f, 2.0f, 3.0f));
+
+	float3 v(1.0f, 1.0f, 1.0f);
+
+	for (unsigned int n = 0; n < iterations; n++) {
+		v = m.Mul(v) * 0.5f;
+	}
+
+	sink += (v.x > 0.0f);
+}
+
+static void Matrix44fMatrixMul(unsigned int iterations)
+{
+	CMatrix44f a;
+	CMatrix44f b;
+	b.RotateX(0.25f);
+
+	for (unsigned int n = 0; n < iterations; n++) {
+		a = a * b;
+	}
+
+	sink += (a[0] > 0.0f);
+}
+
+
+static void VectorPushBack(unsigned int iterations)
+{
+	for (unsigned int n = 0; n < iterations; n++) {
+		std::vector<int> v;
+
+		for (int i = 0; i < 8; i++) {
+			v.push_back(i);
+		}
+
+		sink += v.size();
+	}
+}
+
+static void SmallVectorPushBack(unsigned int iterations)
+{
+	for (unsigned int n = 0; n < iterations; n++) {
+		small_vector<int, 8> v;
+
+		for (int i = 0; i < 8; i++) {
+			v.push_back(i);
+		}
+
+		sink += v.size();
+	}
+}
+
+static void FrameVectorPushBack(unsigned int iterations)
+{
+	for (unsigned int n = 0; n < iterations; n++) {
+		std::vector<int, frame_allocator<int> > v;
+
+		for (int i = 0; i < 8; i++) {
+			v.push_back(i);
+		}
+
+		sink += v.size();
+
+		// one "frame" per 1024 containers
+		if ((n & 1023) == 0) {
+			CFrameArena::ResetAll();
+		}
+	}
+
+	CFrameArena::ResetAll();
+}
+
+
+static void CRCUpdate64K(unsigned int iterations)
+{
+	const std::vector<unsigned char> data(64 * 1024, 0x5a);
+
+	for (unsigned int n = 0; n < iterations; n++) {
+		sink += CRC().Update(&data[0], data.size()).GetDigest();
+	}
+}
+
+static void CRCCombine(unsigned int iterations)
+{
+	for (unsigned int n = 0; n < iterations; n++) {
+		sink += CRC::Combine(n, n * 3, 4 * 1024 * 1024 + n);
+	}
+}
+
+
+static const Benchmark benchmarks[] = {
+	{"float3/NearestScalar256",    100000, Float3NearestScalar},
+	{"float3/NearestBatch256",     100000, Float3NearestBatch},
+	{"Matrix44f/VectorMul",      10000000, Matrix44fVectorMul},
+	{"Matrix44f/MatrixMul",       1000000, Matrix44fMatrixMul},
+	{"containers/VectorPush8",    1000000, VectorPushBack},
+	{"containers/SmallVectorPush8", 1000000, SmallVectorPushBack},
+	{"containers/FrameVectorPush8", 1000000, FrameVectorPushBack},
+	{"CRC/Update64K",               10000, CRCUpdate64K},
+	{"CRC/Combine4M",              100000, CRCCombine},
+};
+
+
+int main(int argc, char** argv)
+{
+	// optional substring filter, e.g. "bench_Core CRC/"
+	const char* filter = (argc > 1)? argv[1]: NULL;
+
+	spring_clock::PushTickRate(true);
+	spring_time::setstarttime(spring_time::gettime(true));
+
+	printf("benchmark,iterations,ns_per_op,allocs_per_op\n");
+
+	for (size_t i = 0; i < (sizeof(benchmarks) / sizeof(benchmarks[0])); i++) {
+		Run(benchmarks[i], filter);
+	}
+
+	spring_clock::PopTickRate();
+	return 0;
+}
@@ -0,0 +1,51 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/CRC.h"
+
+#include <vector>
+
+#define BOOST_TEST_MODULE CRC
+#include <boost/test/unit_test.hpp>
+
+static std::vector<unsigned char> MakeData(size_t size)
+{
+	std::vector<unsigned char> data(size);
+	unsigned int seed = 12345;
+
+	for (size_t i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 16;
+	}
+
+	return data;
+}
+
+BOOST_AUTO_TEST_CASE( KnownValue )
+{
+	BOOST_CHECK(CRC().Update("123456789", 9).GetDigest() == 0xCBF43926);
+	BOOST_CHECK(CRC().GetDigest() == 0);
+}
+
+BOOST_AUTO_TEST_CASE( Combine )
+{
+	const std::vector<unsigned char> data = MakeData(1000);
+	const unsigned int digest = CRC().Update(&data[0], data.size()).GetDigest();
+
+	for (size_t split = 0; split <= data.size(); split += 37) {
+		const unsigned int digestA = CRC().Update(&data[0], split).GetDigest();
+		const unsigned int digestB = CRC().Update(&data[split], data.size() - split).GetDigest();
+
+		BOOST_CHECK(CRC::Combine(digestA, digestB, data.size() - split) == digest);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( CalcParallel )
+{
+	const std::vector<unsigned char> data = MakeData(100000);
+	const unsigned int digest = CRC().Update(&data[0], data.size()).GetDigest();
+
+	BOOST_CHECK(CRC::CalcParallel(&data[0], data.size()) == digest);
+	BOOST_CHECK(CRC::CalcParallel(&data[0], data.size(), 1000) == digest);
+	BOOST_CHECK(CRC::CalcParallel(&data[0], data.size(), 999) == digest);
+	BOOST_CHECK(CRC::CalcParallel(&data[0], 1, 1) == CRC().Update(&data[0], 1).GetDigest());
+}
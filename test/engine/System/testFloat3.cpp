@@ -1,6 +1,10 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "System/float3.h"
+#include "System/float3batch.h"
+
+#include <cstring>
+#include <vector>
 
 #define BOOST_TEST_MODULE Float3
 #include <boost/test/unit_test.hpp>
@@ -11,3 +15,67 @@ BOOST_AUTO_TEST_CASE( Float3 )
 	BOOST_CHECK_MESSAGE(offsetof(float3, y) == sizeof(float), "offsetof(float3, y) == sizeof(float)");
 	BOOST_CHECK_MESSAGE(sizeof(float3) == 3 * sizeof(float),  "sizeof(float3) == 3 * sizeof(float)");
 }
+
+
+static float RandFloat(unsigned int& seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return ((seed >> 8) / float(1 << 24) - 0.5f) * 16384.0f;
+}
+
+static bool BitEqual(const float a, const float b)
+{
+	return (std::memcmp(&a, &b, sizeof(float)) == 0);
+}
+
+BOOST_AUTO_TEST_CASE( Float3Batch )
+{
+	// odd count so the scalar tail is exercised too
+	static const unsigned int N = 1003;
+
+	unsigned int seed = 1;
+	std::vector<float3> v(N);
+	std::vector<float> out(N);
+
+	for (unsigned int i = 0; i < N; i++) {
+		v[i].x = RandFloat(seed);
+		v[i].y = RandFloat(seed);
+		v[i].z = RandFloat(seed);
+	}
+
+	const float3 p(RandFloat(seed), RandFloat(seed), RandFloat(seed));
+	const float3 d = float3(RandFloat(seed), RandFloat(seed), RandFloat(seed)).ANormalize();
+
+	unsigned int numErrors = 0;
+
+	float3batch::SqDistances(p, &v[0], N, &out[0]);
+	for (unsigned int i = 0; i < N; i++) {
+		numErrors += !BitEqual(out[i], v[i].SqDistance(p));
+	}
+	BOOST_CHECK_MESSAGE(numErrors == 0, "SqDistances differs from float3::SqDistance");
+
+	numErrors = 0;
+	float3batch::SqDistances2D(p, &v[0], N, &out[0]);
+	for (unsigned int i = 0; i < N; i++) {
+		numErrors += !BitEqual(out[i], v[i].SqDistance2D(p));
+	}
+	BOOST_CHECK_MESSAGE(numErrors == 0, "SqDistances2D differs from float3::SqDistance2D");
+
+	numErrors = 0;
+	float3batch::Dots(d, &v[0], N, &out[0]);
+	for (unsigned int i = 0; i < N; i++) {
+		numErrors += !BitEqual(out[i], d.dot(v[i]));
+	}
+	BOOST_CHECK_MESSAGE(numErrors == 0, "Dots differs from float3::dot");
+
+	int nearestIdx = -1;
+	float nearestSqDist = 0.0f;
+	for (unsigned int i = 0; i < N; i++) {
+		if (nearestIdx < 0 || v[i].SqDistance(p) < nearestSqDist) {
+			nearestSqDist = v[i].SqDistance(p);
+			nearestIdx = i;
+		}
+	}
+	BOOST_CHECK(float3batch::Nearest(p, &v[0], N) == nearestIdx);
+	BOOST_CHECK(float3batch::Nearest(p, &v[0], 0) == -1);
+}
@@ -0,0 +1,79 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/FrameArena.h"
+
+#include <vector>
+
+#define BOOST_TEST_MODULE FrameArena
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE( Alignment )
+{
+	CFrameArena arena(64);
+
+	for (size_t n = 1; n < 100; n++) {
+		const size_t alignment = (size_t(1) << (n % 6));
+		const size_t addr = reinterpret_cast<size_t>(arena.Alloc(n, alignment));
+
+		BOOST_CHECK((addr & (alignment - 1)) == 0);
+	}
+
+	BOOST_CHECK(arena.GetNumAllocs() == 99);
+}
+
+BOOST_AUTO_TEST_CASE( ResetReusesMemory )
+{
+	CFrameArena arena(1024);
+
+	// spill over into several blocks, Reset has to merge them
+	for (int n = 0; n < 10; n++) {
+		arena.Alloc(500);
+	}
+
+	const size_t reserved = arena.GetReservedBytes();
+	const size_t used = arena.GetUsedBytes();
+
+	BOOST_CHECK(used >= 5000);
+	BOOST_CHECK(reserved >= used);
+
+	arena.Reset();
+
+	BOOST_CHECK(arena.GetUsedBytes() == 0);
+	BOOST_CHECK(arena.GetPeakBytes() == used);
+	BOOST_CHECK(arena.GetReservedBytes() == reserved);
+
+	// the same frame again must fit without growing
+	void* first = arena.Alloc(500);
+
+	for (int n = 1; n < 10; n++) {
+		arena.Alloc(500);
+	}
+
+	BOOST_CHECK(arena.GetReservedBytes() == reserved);
+
+	arena.Reset();
+	BOOST_CHECK(arena.Alloc(500) == first);
+}
+
+BOOST_AUTO_TEST_CASE( Allocator )
+{
+	std::vector<int, frame_allocator<int> > v;
+
+	for (int n = 0; n < 10000; n++) {
+		v.push_back(n);
+	}
+
+	bool ok = true;
+	for (int n = 0; n < 10000; n++) {
+		ok = ok && (v[n] == n);
+	}
+
+	BOOST_CHECK(ok);
+	BOOST_CHECK(CFrameArena::GetThreadArena().GetUsedBytes() >= 10000 * sizeof(int));
+
+	v.clear();
+	CFrameArena::ResetAll();
+
+	BOOST_CHECK(CFrameArena::GetThreadArena().GetUsedBytes() == 0);
+	BOOST_CHECK(CFrameArena::GetMaxPeakBytes() >= 10000 * sizeof(int));
+}
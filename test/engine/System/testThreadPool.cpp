@@ -91,13 +91,18 @@ BOOST_AUTO_TEST_CASE( testThreadPool4 )
 
 BOOST_AUTO_TEST_CASE( testThreadPool5 )
 {
-	/*parallel([&]{
+	LOG_L(L_WARNING, "testThreadPool5");
+
+	std::atomic<int> cnt(0);
+	parallel([&]{
 		parallel([&]{
 			const int threadnum = ThreadPool::GetThreadNum();
 			SAFE_BOOST_CHECK(threadnum >= 0);
 			SAFE_BOOST_CHECK(threadnum < NUM_THREADS);
+			++cnt;
 		});
-	});*/
+	});
+	BOOST_CHECK(cnt == NUM_THREADS * NUM_THREADS);
 }
 
 BOOST_AUTO_TEST_CASE( testThreadPool6 )
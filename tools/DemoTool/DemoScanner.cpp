@@ -0,0 +1,413 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoScanner.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/LoadSave/demofile.h"
+
+// see DemoTool.cpp
+void InitCommandNames();
+const std::string& GetCommandName(int commandId);
+
+namespace fs = boost::filesystem;
+
+
+namespace {
+
+struct PlayerSummary {
+	PlayerSummary(): numCommands(0), numAICommands(0), numChatMsgs(0) {}
+
+	std::string name;
+	unsigned numCommands;
+	unsigned numAICommands;
+	unsigned numChatMsgs;
+};
+
+struct StreamSummary {
+	StreamSummary(): numFrames(0), numBytes(0), msgCounts(256, 0) {}
+
+	PlayerSummary& GetPlayer(unsigned playerNum) {
+		if (playerNum >= players.size())
+			players.resize(playerNum + 1);
+
+		return players[playerNum];
+	}
+
+	int numFrames;
+	size_t numBytes;
+
+	std::vector<unsigned> msgCounts;
+	std::vector<PlayerSummary> players;
+	std::map<std::string, unsigned> cmdCounts;
+};
+
+
+std::string JsonString(const std::string& s)
+{
+	std::string r = "\"";
+
+	for (size_t n = 0; n < s.size(); n++) {
+		const unsigned char c = s[n];
+
+		switch (c) {
+			case '"':  { r += "\\\""; } break;
+			case '\\': { r += "\\\\"; } break;
+			case '\n': { r += "\\n";  } break;
+			case '\r': { r += "\\r";  } break;
+			case '\t': { r += "\\t";  } break;
+			default: {
+				if (c < 0x20) {
+					char buf[8];
+					std::sprintf(buf, "\\u%04x", c);
+					r += buf;
+				} else {
+					r += c;
+				}
+			} break;
+		}
+	}
+
+	return (r + "\"");
+}
+
+std::string JsonError(const std::string& file, const std::string& error)
+{
+	return ("{\"file\":" + JsonString(file) + ",\"error\":" + JsonString(error) + "}");
+}
+
+
+/**
+ * Walks the chunks of the demo stream; for each message only as many bytes
+ * as are needed to attribute it are read, the rest is seeked over.
+ */
+bool ScanStream(std::ifstream& ifs, const DemoFileHeader& header, StreamSummary& summary)
+{
+	// biggest prefix any of the cases below looks at (AICOMMAND: cmd-id at [7..10])
+	static const unsigned PEEK_SIZE = 11;
+
+	ifs.seekg(header.headerSize + header.scriptSize, std::ios::beg);
+
+	// a crashed recording has no stream size, read up to EOF then
+	const bool haveStreamSize = (header.demoStreamSize != 0);
+	size_t bytesRemaining = header.demoStreamSize;
+
+	unsigned char buf[256];
+
+	while (!haveStreamSize || bytesRemaining >= sizeof(DemoStreamChunkHeader)) {
+		DemoStreamChunkHeader chunkHeader;
+
+		if (!ifs.read(reinterpret_cast<char*>(&chunkHeader), sizeof(chunkHeader)))
+			break;
+
+		chunkHeader.swab();
+
+		if (haveStreamSize) {
+			if ((sizeof(chunkHeader) + chunkHeader.length) > bytesRemaining)
+				return false;
+
+			bytesRemaining -= (sizeof(chunkHeader) + chunkHeader.length);
+		}
+
+		if (chunkHeader.length == 0)
+			continue;
+
+		const unsigned char msgID = ifs.peek();
+
+		// names are the only payload read as a whole (and are short)
+		const unsigned readSize = (msgID == NETMSG_PLAYERNAME)?
+			std::min(chunkHeader.length, boost::uint32_t(sizeof(buf))):
+			std::min(chunkHeader.length, boost::uint32_t(PEEK_SIZE));
+
+		if (!ifs.read(reinterpret_cast<char*>(buf), readSize))
+			return !haveStreamSize;
+		if (chunkHeader.length > readSize)
+			ifs.seekg(chunkHeader.length - readSize, std::ios::cur);
+
+		summary.msgCounts[msgID] += 1;
+		summary.numBytes += chunkHeader.length;
+
+		switch (msgID) {
+			case NETMSG_KEYFRAME:
+			case NETMSG_NEWFRAME: {
+				summary.numFrames += 1;
+			} break;
+
+			case NETMSG_PLAYERNAME: {
+				// uchar size; uchar playerNum; std::string name
+				if (readSize > 3) {
+					const char* name = reinterpret_cast<const char*>(&buf[3]);
+					summary.GetPlayer(buf[2]).name.assign(name, strnlen(name, readSize - 3));
+				}
+			} break;
+			case NETMSG_CHAT: {
+				// uchar size; uchar from, dest; std::string message
+				if (readSize > 2)
+					summary.GetPlayer(buf[2]).numChatMsgs += 1;
+			} break;
+
+			case NETMSG_COMMAND: {
+				// ushort size; uchar playerNum; int id; ...
+				if (readSize >= 8) {
+					int cmdID;
+					std::memcpy(&cmdID, &buf[4], sizeof(cmdID));
+
+					summary.GetPlayer(buf[3]).numCommands += 1;
+					summary.cmdCounts[GetCommandName(cmdID)] += 1;
+				}
+			} break;
+			case NETMSG_AICOMMAND:
+			case NETMSG_AICOMMAND_TRACKED: {
+				// ushort size; uchar playerNum; uchar aiID; short unitID; int id; ...
+				if (readSize >= 11) {
+					int cmdID;
+					std::memcpy(&cmdID, &buf[7], sizeof(cmdID));
+
+					summary.GetPlayer(buf[3]).numAICommands += 1;
+					summary.cmdCounts[GetCommandName(cmdID)] += 1;
+				}
+			} break;
+			case NETMSG_AICOMMANDS: {
+				// the contained commands are not decoded
+				if (readSize > 3)
+					summary.GetPlayer(buf[3]).numAICommands += 1;
+			} break;
+
+			default: {
+			} break;
+		}
+	}
+
+	return true;
+}
+
+}
+
+
+std::vector<std::string> DemoScanner::FindDemos(const std::string& dir)
+{
+	std::vector<std::string> files;
+
+	for (fs::recursive_directory_iterator it(dir), end; it != end; ++it) {
+		if (!fs::is_regular_file(it->status()))
+			continue;
+		if (it->path().extension() != ".sdf")
+			continue;
+
+		files.push_back(it->path().string());
+	}
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+
+std::string DemoScanner::ScanDemo(const std::string& file)
+{
+	// most reads are a few bytes followed by a short seek, which a larger
+	// buffer turns into plain memcpy's
+	std::vector<char> fileBuffer(64 * 1024);
+	std::ifstream ifs;
+	ifs.rdbuf()->pubsetbuf(&fileBuffer[0], fileBuffer.size());
+	ifs.open(file.c_str(), std::ios::in | std::ios::binary);
+
+	if (!ifs.is_open())
+		return (JsonError(file, "cannot open file"));
+
+	DemoFileHeader header;
+
+	if (!ifs.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return (JsonError(file, "truncated header"));
+
+	header.swab();
+
+	if (memcmp(header.magic, DEMOFILE_MAGIC, sizeof(header.magic)) != 0)
+		return (JsonError(file, "not a demo file"));
+	if (header.version != DEMOFILE_VERSION || header.headerSize != sizeof(header))
+		return (JsonError(file, "unsupported demo version"));
+	if (header.scriptSize < 0 || header.demoStreamSize < 0)
+		return (JsonError(file, "corrupt header"));
+
+	StreamSummary summary;
+
+	if (!ScanStream(ifs, header, summary))
+		return (JsonError(file, "corrupt demo stream"));
+
+	ifs.close();
+
+	// stats live behind the stream, LoadStats only seeks there
+	std::vector<PlayerStatistics> playerStats;
+	std::vector< std::vector<TeamStatistics> > teamStats;
+	std::vector<unsigned char> winningAllyTeams;
+
+	if (header.demoStreamSize != 0 &&
+		header.playerStatElemSize == sizeof(PlayerStatistics) &&
+		header.teamStatElemSize == sizeof(TeamStatistics)) {
+		try {
+			CDemoReader reader(file, 0.0f);
+			reader.LoadStats();
+
+			playerStats = reader.GetPlayerStats();
+			teamStats = reader.GetTeamStats();
+			winningAllyTeams = reader.GetWinningAllyTeams();
+		} catch (const std::exception& ex) {
+			return (JsonError(file, ex.what()));
+		}
+	}
+
+	char gameID[33];
+	for (int n = 0; n < 16; n++) {
+		std::sprintf(&gameID[n * 2], "%02x", header.gameID[n]);
+	}
+
+	std::ostringstream out;
+
+	out << "{\"file\":" << JsonString(file);
+	out << ",\"version\":" << JsonString(std::string(header.versionString, strnlen(header.versionString, sizeof(header.versionString))));
+	out << ",\"gameID\":\"" << gameID << "\"";
+	out << ",\"unixTime\":" << header.unixTime;
+	out << ",\"gameTime\":" << header.gameTime;
+	out << ",\"wallclockTime\":" << header.wallclockTime;
+	out << ",\"frames\":" << summary.numFrames;
+	out << ",\"streamBytes\":" << summary.numBytes;
+	out << ",\"crashed\":" << ((header.demoStreamSize == 0)? "true": "false");
+
+	out << ",\"winningAllyTeams\":[";
+	for (size_t n = 0; n < winningAllyTeams.size(); n++) {
+		out << ((n > 0)? ",": "") << unsigned(winningAllyTeams[n]);
+	}
+	out << "]";
+
+	out << ",\"players\":[";
+	for (size_t n = 0; n < std::max(summary.players.size(), playerStats.size()); n++) {
+		const PlayerSummary& p = (n < summary.players.size())? summary.players[n]: PlayerSummary();
+
+		out << ((n > 0)? ",": "") << "{\"num\":" << n;
+		out << ",\"name\":" << JsonString(p.name);
+		out << ",\"commands\":" << p.numCommands;
+		out << ",\"aiCommands\":" << p.numAICommands;
+		out << ",\"chatMessages\":" << p.numChatMsgs;
+
+		if (n < playerStats.size()) {
+			const PlayerStatistics& s = playerStats[n];
+
+			out << ",\"stats\":{\"mousePixels\":" << s.mousePixels;
+			out << ",\"mouseClicks\":" << s.mouseClicks;
+			out << ",\"keyPresses\":" << s.keyPresses;
+			out << ",\"numCommands\":" << s.numCommands;
+			out << ",\"unitCommands\":" << s.unitCommands << "}";
+		}
+
+		out << "}";
+	}
+	out << "]";
+
+	// only the last (cumulative) stats sample of each team
+	out << ",\"teams\":[";
+	for (size_t n = 0; n < teamStats.size(); n++) {
+		out << ((n > 0)? ",": "") << "{\"num\":" << n;
+
+		if (!teamStats[n].empty()) {
+			const TeamStatistics& s = teamStats[n].back();
+
+			out << ",\"frame\":" << s.frame;
+			out << ",\"metalUsed\":" << s.metalUsed;
+			out << ",\"energyUsed\":" << s.energyUsed;
+			out << ",\"metalProduced\":" << s.metalProduced;
+			out << ",\"energyProduced\":" << s.energyProduced;
+			out << ",\"damageDealt\":" << s.damageDealt;
+			out << ",\"damageReceived\":" << s.damageReceived;
+			out << ",\"unitsProduced\":" << s.unitsProduced;
+			out << ",\"unitsDied\":" << s.unitsDied;
+			out << ",\"unitsKilled\":" << s.unitsKilled;
+		}
+
+		out << "}";
+	}
+	out << "]";
+
+	out << ",\"commandCounts\":{";
+	for (std::map<std::string, unsigned>::const_iterator it = summary.cmdCounts.begin(); it != summary.cmdCounts.end(); ++it) {
+		out << ((it != summary.cmdCounts.begin())? ",": "") << JsonString(it->first) << ":" << it->second;
+	}
+	out << "}";
+
+	out << ",\"messageCounts\":{";
+	for (unsigned n = 0, i = 0; n < summary.msgCounts.size(); n++) {
+		if (summary.msgCounts[n] == 0)
+			continue;
+
+		out << ((i++ > 0)? ",": "") << "\"" << n << "\":" << summary.msgCounts[n];
+	}
+	out << "}}";
+
+	return out.str();
+}
+
+
+namespace {
+
+struct ScanQueue {
+	ScanQueue(const std::vector<std::string>& _files, std::ostream& _out)
+		: files(_files)
+		, out(_out)
+		, nextFile(0)
+	{}
+
+	void Work() {
+		for (;;) {
+			size_t n;
+			{
+				boost::mutex::scoped_lock lock(mutex);
+				if (nextFile >= files.size())
+					return;
+				n = nextFile++;
+			}
+
+			const std::string line = DemoScanner::ScanDemo(files[n]);
+
+			boost::mutex::scoped_lock lock(mutex);
+			out << line << std::endl;
+		}
+	}
+
+	const std::vector<std::string>& files;
+	std::ostream& out;
+
+	boost::mutex mutex;
+	size_t nextFile;
+};
+
+}
+
+
+void DemoScanner::ScanDemos(const std::vector<std::string>& files, unsigned numThreads, std::ostream& out)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, boost::thread::hardware_concurrency());
+
+	numThreads = std::min(numThreads, unsigned(std::max(files.size(), size_t(1))));
+
+	// fills the (static) command-name table before the workers read it
+	InitCommandNames();
+
+	ScanQueue queue(files, out);
+	boost::thread_group threads;
+
+	for (unsigned n = 1; n < numThreads; n++) {
+		threads.create_thread(boost::bind(&ScanQueue::Work, &queue));
+	}
+
+	queue.Work();
+	threads.join_all();
+}
@@ -0,0 +1,33 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_SCANNER_H
+#define DEMO_SCANNER_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+/**
+ * @brief Summarizes many demos without decoding their streams
+ *
+ * Only the chunk headers and the first few bytes of the messages counted
+ * per player (names, commands, chat) are read, everything else is skipped
+ * by its length. Stats come from the end of the file, so a demo is never
+ * loaded as a whole.
+ */
+namespace DemoScanner
+{
+	/// all *.sdf files below dir (recursively), sorted
+	std::vector<std::string> FindDemos(const std::string& dir);
+
+	/// one JSON object (without trailing newline) describing the demo
+	std::string ScanDemo(const std::string& file);
+
+	/**
+	 * Runs ScanDemo on numThreads (0 = one per core) threads and writes one
+	 * line per demo to out, in order of completion.
+	 */
+	void ScanDemos(const std::vector<std::string>& files, unsigned numThreads, std::ostream& out);
+}
+
+#endif // DEMO_SCANNER_H
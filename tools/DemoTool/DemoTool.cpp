@@ -4,6 +4,7 @@
 #include <iostream>
 #include <boost/program_options.hpp>
 
+#include "DemoScanner.h"
 #include "StringSerializer.h"
 
 #include "Net/Protocol/BaseNetProtocol.h"
@@ -44,6 +45,8 @@ int main (int argc, char* argv[])
 	all.add_options()("teamstats,t", "Print teamstats");
 	all.add_options()("team", po::value<unsigned>(), "Select team");
 	all.add_options()("teamsstatcsv", po::value<std::string>(), "Write teamstats in a csv file");
+	all.add_options()("scan", po::value<std::string>(), "Summarize all demos below a directory as JSON lines");
+	all.add_options()("jobs,j", po::value<unsigned>()->default_value(0), "Number of demos to scan in parallel (0: one per core)");
 
 	po::store(po::command_line_parser(argc, argv).options(all).positional(p).run(), vm);
 	po::notify(vm);
@@ -53,6 +56,13 @@ int main (int argc, char* argv[])
 		std::cout << "demotool Usage: " << std::endl;
 		all.print(std::cout);
 		std::cout << "example: demotool myReplay.sdf -d > myReplay_sdf_demotool.txt" << std::endl;
+		std::cout << "example: demotool --scan demos/ -j 8 > demos.jsonl" << std::endl;
+		return 0;
+	}
+	if (vm.count("scan"))
+	{
+		const std::vector<std::string> files = DemoScanner::FindDemos(vm["scan"].as<std::string>());
+		DemoScanner::ScanDemos(files, vm["jobs"].as<unsigned>(), std::cout);
 		return 0;
 	}
 	if (vm.count("demofile"))
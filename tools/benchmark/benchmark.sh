@@ -28,6 +28,7 @@ if ! [ -s "$DEMOFILE" ]; then
 	echo demo file: $DEMOFILE
 	cp -v "$DEMOFILE" "$PREFIX/benchmark.sdf"
 	mv benchmark.data "$PREFIX/data-0-cmd1.data"
+	mv benchmark.json "$PREFIX/data-0-cmd1.json"
 fi
 
 
@@ -38,8 +39,10 @@ for (( i=1; i <= TESTRUNS; i++ )); do
 		echo Running CMD $(($k+1))/$CMDCOUNT
 		${CMD[$k]} "$DEMOFILE" >/dev/null 2>&1
 		mv benchmark.data "$PREFIX/data-${i}-cmd${k}.data"
+		mv benchmark.json "$PREFIX/data-${i}-cmd${k}.json"
 	done
 done
 
 #./plot
 #./plot_mass.sh $TESTRUNS
+#./compare.py "$PREFIX/data-1-cmd0.json" "$PREFIX/data-1-cmd1.json"
@@ -0,0 +1,83 @@
+#!/usr/bin/python
+#
+# Compares two benchmark.json files (written by spring --benchmark) and
+# flags every subsystem timing that got slower by more than a threshold.
+#
+# usage: compare.py [--threshold PERCENT] baseline.json candidate.json
+#
+# Exits with status 1 if any regression was found, so it can be used to
+# gate builds, e.g. after running benchmark.sh with a demo for each build.
+
+import json
+import sys
+from optparse import OptionParser
+
+STATS = ('mean_ms', 'p50_ms', 'p99_ms')
+
+
+def load(fileName):
+    with open(fileName) as f:
+        return json.load(f)
+
+
+def change(old, new):
+    if old <= 0.0:
+        return 0.0
+    return (new - old) * 100.0 / old
+
+
+def main():
+    parser = OptionParser(usage='%prog [--threshold PERCENT] baseline.json candidate.json')
+    parser.add_option('-t', '--threshold', type='float', default=5.0,
+                      help='regression threshold in percent (default: %default)')
+    (options, args) = parser.parse_args()
+
+    if len(args) != 2:
+        parser.print_help()
+        return 2
+
+    base = load(args[0])
+    cand = load(args[1])
+    regressions = 0
+
+    if base.get('numFrames') != cand.get('numFrames'):
+        print('warning: frame counts differ (%s vs %s), was the same demo used?' % (base.get('numFrames'), cand.get('numFrames')))
+
+    print('%-12s %-8s %12s %12s %9s' % ('subsystem', 'stat', 'baseline', 'candidate', 'change'))
+
+    for name in sorted(base['subsystems']):
+        if name not in cand['subsystems']:
+            continue
+
+        for stat in STATS:
+            old = base['subsystems'][name][stat]
+            new = cand['subsystems'][name][stat]
+            diff = change(old, new)
+            flag = ''
+
+            if diff > options.threshold:
+                flag = '  REGRESSION'
+                regressions += 1
+
+            print('%-12s %-8s %12.3f %12.3f %+8.1f%%%s' % (name, stat, old, new, diff, flag))
+
+    oldRSS = base.get('peakRSS_KiB', 0)
+    newRSS = cand.get('peakRSS_KiB', 0)
+    diff = change(oldRSS, newRSS)
+    flag = ''
+
+    if diff > options.threshold:
+        flag = '  REGRESSION'
+        regressions += 1
+
+    print('%-12s %-8s %12d %12d %+8.1f%%%s' % ('memory', 'peakRSS', oldRSS, newRSS, diff, flag))
+
+    if regressions > 0:
+        print('%d regression(s) above %.1f%%' % (regressions, options.threshold))
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -4,10 +4,16 @@
 #include "unitsync_api.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <string>
 #include <vector>
 #include <set>
 
+#include <boost/cstdint.hpp>
+
 // shared with spring:
 #include "lib/lua/include/LuaInclude.h"
 #include "Game/GameVersion.h"
@@ -26,6 +32,7 @@
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/DataDirLocater.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/VFSHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileSystemInitializer.h"
@@ -1071,6 +1078,92 @@ EXPORT(unsigned int) GetMapChecksumFromName(const char* mapName)
 // Used to return the image
 static unsigned short imgbuf[1024*1024];
 
+
+/*
+ * Decoded minimaps and info maps are kept in the cache dir, keyed on the
+ * checksum of the map archive, so that every process on a host (lobbies,
+ * autohosts) after the first one reads a flat file instead of mounting the
+ * archive and decoding the SMF again.
+ */
+static const char mapCacheMagic[] = "UnitsyncMapCache1";
+
+static std::string GetMapCacheFile(const std::string& mapName, const std::string& tag)
+{
+	const unsigned int checksum = archiveScanner->GetSingleArchiveChecksum(archiveScanner->ArchiveFromName(mapName));
+
+	if (checksum == 0)
+		return "";
+
+	return (FileSystem::GetCacheDir() + "/unitsync/" + IntToString(checksum, "%08x") + "-" + tag + ".bin");
+}
+
+/// reads the header and (if data is not NULL) up to maxSize bytes of payload
+static bool ReadMapCache(const std::string& cacheFile, int* width, int* height, void* data, size_t maxSize)
+{
+	if (cacheFile.empty())
+		return false;
+
+	std::ifstream file(dataDirsAccess.LocateFile(cacheFile).c_str(), std::ios::in | std::ios::binary);
+	char magic[sizeof(mapCacheMagic)];
+	boost::uint32_t header[3]; // width, height, payload size
+
+	if (!file.read(magic, sizeof(magic)) || memcmp(magic, mapCacheMagic, sizeof(magic)) != 0)
+		return false;
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+		return false;
+
+	if (data != NULL) {
+		if (header[2] > maxSize)
+			return false;
+		// a short read means the file is truncated, ignore it
+		if (!file.read(reinterpret_cast<char*>(data), header[2]))
+			return false;
+	}
+
+	if (width  != NULL) *width  = header[0];
+	if (height != NULL) *height = header[1];
+	return true;
+}
+
+static void WriteMapCache(const std::string& cacheFile, int width, int height, const void* data, size_t size)
+{
+	if (cacheFile.empty())
+		return;
+	if (!FileSystem::CreateDirectory(FileSystem::GetCacheDir() + "/unitsync/"))
+		return;
+
+	const std::string fileName = dataDirsAccess.LocateFile(cacheFile, FileQueryFlags::WRITE);
+	const std::string tempName = fileName + ".tmp";
+
+	{
+		std::ofstream file(tempName.c_str(), std::ios::out | std::ios::binary);
+		const boost::uint32_t header[3] = {boost::uint32_t(width), boost::uint32_t(height), boost::uint32_t(size)};
+
+		file.write(mapCacheMagic, sizeof(mapCacheMagic));
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(data), size);
+
+		if (!file.good())
+			return;
+	}
+
+	// other processes only ever see complete files
+	FileSystem::Remove(fileName);
+	if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+		FileSystem::Remove(tempName);
+	}
+}
+
+static bool IsCacheableInfoMapName(const std::string& name)
+{
+	for (size_t n = 0; n < name.size(); n++) {
+		if (!isalnum(name[n]) && name[n] != '_')
+			return false;
+	}
+
+	return !name.empty();
+}
+
 static unsigned short* GetMinimapSM3(std::string mapFileName, int mipLevel)
 {
 	throw content_error("SM3 maps are no longer supported as of Spring 95.0");
@@ -1183,6 +1276,13 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 			throw std::out_of_range("Miplevel must be between 0 and 8 (inclusive) in GetMinimap.");
 
 		const std::string mapFile = GetMapFile(mapName);
+		const std::string cacheFile = GetMapCacheFile(mapName, "minimap" + IntToString(mipLevel));
+
+		const int mipsize = 1024 >> mipLevel;
+
+		if (ReadMapCache(cacheFile, NULL, NULL, imgbuf, sizeof(imgbuf)))
+			return imgbuf;
+
 		ScopedMapLoader mapLoader(mapName, mapFile);
 
 		unsigned short* ret = NULL;
@@ -1193,6 +1293,10 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 			ret = GetMinimapSM3(mapFile, mipLevel);
 		}
 
+		if (ret != NULL) {
+			WriteMapCache(cacheFile, mipsize, mipsize, ret, mipsize * mipsize * sizeof(unsigned short));
+		}
+
 		return ret;
 	}
 	UNITSYNC_CATCH_BLOCKS;
@@ -1210,6 +1314,17 @@ EXPORT(int) GetInfoMapSize(const char* mapName, const char* name, int* width, in
 		CheckNull(height);
 
 		const std::string mapFile = GetMapFile(mapName);
+
+		if (IsCacheableInfoMapName(name)) {
+			// either cached variant carries the dimensions
+			const std::string n = name;
+
+			if (ReadMapCache(GetMapCacheFile(mapName, "info_" + n + "_" + IntToString(bm_grayscale_8)), width, height, NULL, 0) ||
+			    ReadMapCache(GetMapCacheFile(mapName, "info_" + n + "_" + IntToString(bm_grayscale_16)), width, height, NULL, 0)) {
+				return (*width) * (*height);
+			}
+		}
+
 		ScopedMapLoader mapLoader(mapName, mapFile);
 		CSMFMapFile file(mapFile);
 		MapBitmapInfo bmInfo;
@@ -1241,10 +1356,23 @@ EXPORT(int) GetInfoMap(const char* mapName, const char* name, unsigned char* dat
 		CheckNull(data);
 
 		const std::string mapFile = GetMapFile(mapName);
+		const std::string n = name;
+		const std::string cacheFile = IsCacheableInfoMapName(n)? GetMapCacheFile(mapName, "info_" + n + "_" + IntToString(typeHint)): "";
+
+		// the caller's buffer is sized by GetInfoMapSize, which reads the same header
+		int cachedWidth = 0;
+		int cachedHeight = 0;
+
+		if (ReadMapCache(cacheFile, &cachedWidth, &cachedHeight, NULL, 0)) {
+			const size_t size = cachedWidth * cachedHeight * ((typeHint == bm_grayscale_16)? 2: 1);
+
+			if (ReadMapCache(cacheFile, NULL, NULL, data, size))
+				return 1;
+		}
+
 		ScopedMapLoader mapLoader(mapName, mapFile);
 		CSMFMapFile file(mapFile);
 
-		const std::string n = name;
 		int actualType = (n == "height" ? bm_grayscale_16 : bm_grayscale_8);
 
 		if (actualType == typeHint) {
@@ -1271,6 +1399,14 @@ EXPORT(int) GetInfoMap(const char* mapName, const char* name, unsigned char* dat
 		} else if (actualType == bm_grayscale_8 && typeHint == bm_grayscale_16) {
 			throw content_error("converting from 8 bits per pixel to 16 bits per pixel is unsupported");
 		}
+
+		if (ret > 0 && !cacheFile.empty()) {
+			MapBitmapInfo bmInfo;
+			file.GetInfoMapSize(name, &bmInfo);
+
+			const size_t size = bmInfo.width * bmInfo.height * ((typeHint == bm_grayscale_16)? 2: 1);
+			WriteMapCache(cacheFile, bmInfo.width, bmInfo.height, data, size);
+		}
 	}
 	UNITSYNC_CATCH_BLOCKS;
 